@@ -407,7 +407,7 @@ inline void ngl_atomic_dec(nglAtomic64 &value)
 inline uint32 InterlockedExchangeAdd(int32* Addend, uint32 Increment)
 {
   uint32 ret;
-  __asm__ (
+  __asm__ __volatile__ ( // Volatile: the result is often unused, the asm must not be optimized away
     /* lock for SMP systems */
     "lock\n\t"
     "xaddl %0,(%1)"
@@ -546,3 +546,13 @@ typedef volatile nglAtomic64 nglAtomic;
 typedef volatile nglAtomic32 nglAtomic;
 #endif
 
+// full memory barrier: the reads and writes issued before the barrier are visible before the ones issued after it
+inline void ngl_atomic_barrier()
+{
+#ifdef _MSC_VER
+  MemoryBarrier();
+#else
+  __sync_synchronize();
+#endif
+}
+
@@ -18,6 +18,15 @@
 
 typedef void (*nglCopyLineFn)(void* pDst, void* pSrc, int32 PixelCount, bool Invert);
 
+//! Resampling filters used by nglScaleImage() and nglImage::Resize()
+enum nglImageFilter
+{
+  eImageFilterDefault,  ///< Historical bresenham scaler averaging two neighbour lines, fast but rough
+  eImageFilterBox,      ///< Box filter, averages all the source pixels covered by a destination pixel
+  eImageFilterBilinear, ///< Triangle filter, widened when down scaling
+  eImageFilterLanczos   ///< Lanczos (a = 3) windowed sinc, sharpest but slowest
+};
+
 NGL_API nglCopyLineFn nglGetCopyLineFn(int32 DstBPP, int32 SrcBPP); ///< Retreive a pointer to a function that can copy any BPP to any BPP.
 NGL_API void nglCopyImage(void* pDst, int32 dstwidth, int32 dstheight, int32 dstbpp, void* pSrc, int32 srcwidth, int32 srcheight, int32 srcbpp, bool vmirror, bool hmirror);
 NGL_API void nglCopyImage(void* pDst, int32 x, int32 y, int32 dstwidth, int32 dstheight, int32 dstbpp, void* pSrc, int32 srcwidth, int32 srcheight, int32 srcbpp, bool vmirror, bool hmirror);
@@ -47,5 +56,12 @@ NGL_API void nglUnPreMultLine16ALum(void* pDst, void* pSrc, int32 PixelCount);
 NGL_API void nglUnPreMultLine32ARGB(void* pDst, void* pSrc, int32 PixelCount);
 NGL_API void nglUnPreMultLine32RGBA(void* pDst, void* pSrc, int32 PixelCount);
 
+NGL_API bool nglScaleImage(void* pDst, int32 DstWidth, int32 DstHeight, const void* pSrc, int32 SrcWidth, int32 SrcHeight, int32 BytesPerPixel, nglImageFilter Filter);
+/*!< Resample a tightly packed image of 8 bit channels (1 to 4 bytes per pixel) with a separable filter.
+     Returns false if the parameters are not supported. eImageFilterDefault is not handled here, see nglImage::Resize(). */
+
+NGL_API void nglEnableBitmapSIMD(bool Enable); ///< Allow (default) or forbid the use of the SSE2/SSSE3/AVX2 code paths. The results are the same either way, this is only meant for testing and benchmarking.
+NGL_API bool nglIsBitmapSIMDEnabled();
+
 #endif // __nglBitmapTools_h__
 
@@ -42,6 +42,8 @@ public:
   static bool   HasMMX();      ///< return true if MMX extensions are available
   static bool   HasSSE();      ///< return true if SSE extensions are available
   static bool   HasSSE2();     ///< return true if SSE2 extensions are available
+  static bool   HasSSSE3();    ///< return true if SSSE3 extensions are available
+  static bool   HasAVX2();     ///< return true if AVX2 extensions are available and enabled by the OS
   static bool   Has3DNow();    ///< return true if 3DNow extensions are available
   static bool   HasAltivec();  ///< return true if Altivec extensions are available
 
@@ -54,6 +56,8 @@ private:
   static bool mMMX;
   static bool mSSE;
   static bool mSSE2;
+  static bool mSSSE3;
+  static bool mAVX2;
   static bool m3DNow;
   static bool mAltivec;
 
@@ -39,6 +39,18 @@ enum nglFileWhence
 	eFileFromEnd     ///< Move backwards from the end of the file.
 };
 
+//! Access pattern hint
+/*!
+Expected access pattern, given to the system to tune read-ahead and caching. See File::Map() and File::SetAccessHint().
+*/
+enum nglFileAccess
+{
+	eFileAccessNormal,      ///< No particular pattern, system defaults.
+	eFileAccessSequential,  ///< The data will be read from start to end, aggressive read-ahead is welcome.
+	eFileAccessRandom,      ///< The data will be accessed in random order, read-ahead is wasted.
+	eFileAccessWillNeed     ///< All the data will be needed soon, start loading it right away.
+};
+
 
 //! Portable file class
 /*!
@@ -160,6 +172,27 @@ public:
 	If auto-flush is set, all write operations will return only once the data is
 	effectively written on the storage medium
 	*/
+	void SetAccessHint(nglFileAccess Access);
+	/*!<
+	\param Access expected access pattern
+
+	Tell the system how the file is going to be read. This is only a hint, it is ignored on platforms
+	that don't support it.
+	*/
+	const void* Map(nglFileSize& rSize, nglFileAccess Access = eFileAccessSequential);
+	/*!< Map the whole file in memory (read only)
+	\param rSize on output, size of the mapped data in bytes
+	\param Access expected access pattern, given to the system as a hint
+	\return the file data, or NULL if the file can't be mapped (empty file, special file, unsupported platform)
+
+	The mapping stays valid until Unmap() is called, even if the file is closed in between. The read/write
+	position is not affected.
+	*/
+	static void Unmap(const void* pData, nglFileSize Size);
+	/*!< Release a mapping obtained with Map()
+	\param pData mapped data
+	\param Size mapped size as returned by Map()
+	*/
 	//@}
 
 	/** @name Data reading */
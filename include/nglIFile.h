@@ -18,10 +18,22 @@
 #include "nglFile.h"
 
 
+//! Input file stream read strategy
+enum nglIFileMode
+{
+  eIFileDirect,   ///< Every read is forwarded to the file (one system call per Read()).
+  eIFileBuffered, ///< Reads are served from a large internal buffer, refilled with big sequential reads.
+  eIFileMapped    ///< The whole file is memory mapped, reads are plain copies and GetMappedData() gives a zero-copy view. Falls back to eIFileBuffered when the file can't be mapped.
+};
+
 //! Input file stream
 /*!
 This input stream is based on the nglFile API, and can be used by all objects
 based on generic input streams.
+
+The read strategy (see nglIFileMode) is transparent to stream users. When the
+stream is buffered or mapped, the position of the underlying nglFile (see GetFile())
+doesn't follow the stream position.
 */
 class NGL_API nglIFile : public nglIStream
 {
@@ -44,12 +56,41 @@ public:
 
     See nglFile::nglFile().
   */
+  nglIFile(const nglPath& rPath, nglIFileMode Mode, nglFileAccess Access = eFileAccessSequential);
+  /*!<
+    \param rPath file's path
+    \param Mode read strategy
+    \param Access expected access pattern, given to the system as a hint
+
+    Open the file immediately with the given read strategy. See SetMode().
+  */
   virtual ~nglIFile();
   //@}
 	
 	/** Retrieve the file handle of the stream */
 	nglFile* GetFile() const;
 
+  /** @name Read strategy */
+  //@{
+  bool SetMode(nglIFileMode Mode, nglFileAccess Access = eFileAccessSequential);
+  /*!< Change the read strategy
+    \param Mode new read strategy
+    \param Access expected access pattern, given to the system as a hint
+    \return true if the requested mode is in use, false if a fallback mode was chosen
+
+    The stream position is preserved.
+  */
+  nglIFileMode GetMode() const; ///< Read strategy in use (may differ from the requested one, see SetMode())
+  const char* GetMappedData() const;
+  /*!< Zero-copy view of the file
+    \return the whole file content if the stream is mapped, NULL otherwise
+
+    The data is valid as long as the stream is open and its mode unchanged. Use GetPos() and
+    GetMappedSize() to know what is left to read, and SetPos() to consume it.
+  */
+  nglFileSize GetMappedSize() const; ///< Size of the data returned by GetMappedData()
+  //@}
+
   /** @name State/error methods */
   //@{
   bool Open();
@@ -90,13 +131,31 @@ public:
   /** @name Input methods */
   //@{
   virtual int64 Read (void* pData, int64 WordCount, uint WordSize = 1);
+  virtual int64 PeekBuffer (const void*& rpData); ///< Only supported in eIFileBuffered and eIFileMapped modes
   //@}
 
   virtual void SetEndian(nglEndian Endian);  
   
 private:
+  void Release(); ///< Drop the map/buffer, syncing the file position with the stream position
+  int64 ReadBuffered(void* pData, int64 Size);
+
   nglFile* mpFile;
   bool     mOwnFile;
+
+  nglIFileMode  mMode;
+  nglFileAccess mAccess;
+  nglFileSize   mSize;        ///< File size, cached when mapped or buffered
+
+  const char*   mpMap;
+  nglFileSize   mMapSize;
+  nglFileOffset mMapPos;
+
+  char*         mpBuffer;
+  int64         mBufferSize;  ///< Allocated size
+  int64         mBufferFill;  ///< Valid bytes in the buffer
+  int64         mBufferPos;   ///< Read position in the buffer
+  nglFileOffset mBufferStart; ///< File offset of mpBuffer[0]
 };
 
 #endif // __nglIFile_h__
@@ -53,6 +53,7 @@ public:
   /** @name Input methods */
   //@{
   virtual int64 Read (void* pData, int64 WordCount, uint WordSize = 1);
+  virtual int64 PeekBuffer (const void*& rpData);
   //@}
 
 protected:
@@ -127,6 +127,16 @@ nglSize ReadText (nglString& rText, nglTextFormat* pFormat);
 
     This method works as Read() but does not change the stream current position.
   */
+  virtual int64 PeekBuffer (const void*& rpData);
+  /*!< Zero-copy access to the bytes immediately available
+    \param rpData on output, points to the next bytes of the stream
+    \return number of bytes readable at \a rpData, 0 if there is nothing left or if the stream doesn't support direct access
+
+    The bytes are not consumed: use SetPos(Count, eStreamForward) once they have been processed.
+    The pointer is only valid until the next call to an input or navigation method. Byte swapping
+    is never applied to this data. Memory and buffered/mapped file streams implement it, the
+    default implementation returns 0.
+  */
   //@}
 
   /** @name Input methods (alternate) */
@@ -168,6 +178,8 @@ nglSize ReadText (nglString& rText, nglTextFormat* pFormat);
   
   //@}
 
+protected:
+  int64 ReadLineFromBuffer(nglString& rLine, nglTextFormat* pFormat); ///< ReadLine() implementation for streams that support PeekBuffer()
 };
 
 #endif // __nglIStream_h__
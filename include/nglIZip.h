@@ -17,8 +17,43 @@
 
 //#include "nui.h"
 #include "nglIStream.h"
+#include "nglCriticalSection.h"
 
 class nglZipFS;
+class nglZipInflater;
+
+
+//! Inflate checkpoints of a deflated zip entry
+/*!
+A checkpoint holds everything needed to resume the decompression in the middle of the
+entry: the position of a deflate block boundary in the compressed data and the last 32 KB
+of output preceding it. The checkpoints are added as the entry gets decompressed, at most
+one per span of uncompressed bytes, and are shared by all the streams opened on the entry.
+*/
+class nglZipSeekIndex
+{
+public:
+  nglZipSeekIndex(uint32 Span);
+  ~nglZipSeekIndex();
+
+  class Checkpoint
+  {
+  public:
+    nglFileOffset mOut;  ///< Position in the uncompressed data
+    nglFileOffset mIn;   ///< Offset of the first compressed byte after the block boundary
+    uint8 mBits;         ///< Number of bits of the byte before mIn that still belong to the next block
+    std::vector<uint8> mWindow; ///< Uncompressed bytes preceding mOut (up to 32 KB)
+  };
+
+  const Checkpoint* Find(nglFileOffset Position); ///< Return the last checkpoint at or before Position, NULL if there is none
+  bool IsNeeded(nglFileOffset Position); ///< Return true if a checkpoint at Position would be more than a span away from the last one
+  void Add(Checkpoint* pCheckpoint); ///< Take ownership of the checkpoint, dropping it if another stream added one in the meantime
+
+private:
+  uint32 mSpan;
+  std::vector<Checkpoint*> mCheckpoints; ///< Sorted by position, never removed so the pointers stay valid
+  nglCriticalSection mLock;
+};
 
 
 //! Input Zip stream
@@ -49,20 +84,30 @@ public:
   /** @name Input methods */
   //@{
   virtual int64 Read (void* pData, int64 WordCount, uint WordSize = 1);
+  virtual int64 PeekBuffer (const void*& rpData);
+  /*!< Only stored entries of an archive held in memory (or mapped) can be peeked, directly from the archive data */
   //@}
 
+  bool IsCompressed() const; ///< Returns false if the entry is stored: reads and seeks then go straight to the archive data
+
 private:
   friend class nglZipFS;
 
-  nglZipFS* mpZip;
-  void*     mpUnzip;
-  nglSize   mSize;
-  int       mNumOfFile;
-  int       mPosInZipDirectory;
-
-  nglIZip(nglZipFS* pZip, void* pUnzip, nglSize size, int NumOfFile,int PosInZipDirectory);
-
-  void SetRef(void* pUnzip);
+  nglZipFS*        mpZip;
+  nglSize          mSize;
+  nglFileOffset    mDataOffset;     ///< Offset of the entry data in the archive
+  nglSize          mCompressedSize;
+  nglFileOffset    mPosition;       ///< Position in the uncompressed data
+  bool             mError;
+  nglZipInflater*  mpInflater;      ///< Decompression state, NULL for stored entries
+  nglZipSeekIndex* mpSeekIndex;     ///< Checkpoints of the entry, owned by the zip FS. NULL if disabled
+
+  nglIZip(nglZipFS* pZip, nglSize Size, nglFileOffset DataOffset, nglSize CompressedSize, bool Compressed, nglZipSeekIndex* pSeekIndex);
+
+  nglFileOffset Seek(nglFileOffset Where); ///< Move to the given uncompressed position, returns the new position
+  nglSize Inflate(uint8* pData, nglSize Size); ///< Decompress Size bytes to pData, or skip them if pData is NULL
+  bool Restart(const nglZipSeekIndex::Checkpoint* pCheckpoint); ///< Resume the decompression at the checkpoint, or at the start of the entry if NULL
+  void AddCheckpoint();
 };
 
 #endif // __nglIZip_h__
@@ -16,6 +16,7 @@
 //#include "nui.h"
 #include "nglError.h"
 #include "nuiFlags.h"
+#include "nglImageCodec.h"
 
 class nglIStream;
 class nglOStream;
@@ -219,6 +220,26 @@ public:
     and OnData() callbacks will be called (once, in this order). OnError() might be invoked
     as well if an error occurs.
   */
+  nglImage (nglIStream* pInput, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial = nglImagePartialDelegate(), nglImageCodec* pCodec = NULL);
+  /*!< Create a reduced image from a stream
+    \param pInput input stream (feeding the codec)
+    \param TargetWidth wanted width, 0 means no constraint
+    \param TargetHeight wanted height, 0 means no constraint
+    \param rPartial optional delegate receiving coarse/partial images while decoding
+    \param pCodec codec to use, NULL means auto-detection
+
+    Codecs that support it (JPEG, PNG) decode straight to the smallest size that is still at least
+    TargetWidth x TargetHeight, which is much faster and lighter than decoding the full image and
+    calling Resize(). Other codecs ignore the target size. See nglImageCodec::SetTargetSize().
+  */
+  nglImage (const nglPath& rPath, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial = nglImagePartialDelegate(), nglImageCodec* pCodec = NULL);
+  /*!< Create a reduced image from a file
+    \param rPath input file
+    \param TargetWidth wanted width, 0 means no constraint
+    \param TargetHeight wanted height, 0 means no constraint
+    \param rPartial optional delegate receiving coarse/partial images while decoding
+    \param pCodec codec to use, NULL means auto-detection
+  */
   nglImage(nglImageInfo& rInfo, nuiCopyPolicy policy = eClone);
   /*!< Create an image from a user given description
     \param rInfo image description
@@ -240,11 +261,12 @@ public:
     The image buffer data is cloned (and thus managed).
   */
   
-  nglImage(const nglImage& rImage, uint32 NewWidth, uint32 NewHeight);
+  nglImage(const nglImage& rImage, uint32 NewWidth, uint32 NewHeight, nglImageFilter Filter = eImageFilterDefault);
   /*!< Create an image copy from another image, scaling the source image to the given size
    \param rImage source image
    \param scaledWidth requested width
    \param scaledHeight requested height
+   \param Filter resampling filter, see nglImageFilter
    
    */
   
@@ -293,12 +315,14 @@ public:
   //@}
   
   
-  nglImage* Resize(uint32 width, uint32 height);
+  nglImage* Resize(uint32 width, uint32 height, nglImageFilter Filter = eImageFilterDefault);
   /*!< create a copy with a new size
    \param width new image width
    \param height new image height
+   \param Filter resampling filter, see nglImageFilter
 
-   This method uses a simple bresenham algorithm. Should be improved in the future.
+   eImageFilterDefault uses a simple bresenham algorithm. The other filters use nglScaleImage()
+   (SIMD accelerated when available), except for packed 15/16 bits pixel formats that always use the bresenham scaler.
    */
   
   nglImage* Crop(uint32 x, uint32 y, uint32 width, uint32 height);
@@ -399,6 +423,9 @@ protected:
   virtual const nglChar* OnError (uint& rError) const;
 
 private:
+  void Decode(const nglPath& rPath, nglImageCodec* pCodec, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial);
+  void Decode(nglIStream* pInput, const nglString& rFileName, nglImageCodec* pCodec, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial);
+
   static std::vector<nglImageCodecInfo*> *mpCodecInfos; ///< The list of image codec creator methods.
 };
 
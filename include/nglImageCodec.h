@@ -16,6 +16,7 @@
 //#include "nui.h"
 #include "nglError.h"
 #include "nglString.h"
+#include "nuiFastDelegate.h"
 
 class nglIStream;
 class nglOStream;
@@ -24,6 +25,17 @@ class nglImage;
 class nglImageInfo;
 class nglImageCodec;
 
+typedef nuiFastDelegate2<nglImage&, float, bool> nglImagePartialDelegate;
+/*!< Partial decode notification
+  \param rImage the image being decoded, its buffer holds the data decoded so far
+  \param Completion estimated completion, from 0 to 1 (excluded)
+  \return false to abort the decoding
+
+  Codecs that support it invoke this delegate with a coarse version of the image (progressive
+  JPEG scans, PNG Adam7 passes) or with the rows decoded so far. The buffer is not
+  premultiplied yet.
+*/
+
 //! Image codec description
 /*!
 Every image codec (loader and/or writer) registers itself to nglImage
@@ -52,6 +64,7 @@ FIXME
 class NGL_API nglImageCodec 
 {
 public:
+  nglImageCodec();
   virtual ~nglImageCodec();
   virtual bool Init(nglImage* pImage);      ///< Codec init is decoupled from construction
   virtual bool Probe(nglIStream* pIStream) = 0;  ///< Check for a known signature at stream start. Returns true if it wants to take the job
@@ -59,8 +72,27 @@ public:
   virtual bool Save(nglOStream* pOStream) = 0; 
   virtual float GetCompletion() = 0; 
 
+  void SetTargetSize(uint32 Width, uint32 Height);
+  /*!< Decode-time size hint
+    \param Width wanted width, 0 means no constraint
+    \param Height wanted height, 0 means no constraint
+
+    Codecs that can decode at a reduced resolution (JPEG DCT scaling, PNG row reduction) will
+    produce the smallest image that is still at least Width x Height. The result may thus be
+    bigger than the target, use nglImage::Resize() to get an exact size. Must be set before Feed().
+  */
+  uint32 GetTargetWidth() const;
+  uint32 GetTargetHeight() const;
+  void SetPartialDelegate(const nglImagePartialDelegate& rDelegate); ///< Set the delegate called with coarse/partial images while decoding. Must be set before Feed().
+
 protected:
   nglImage* mpImage;
+  uint32 mTargetWidth;
+  uint32 mTargetHeight;
+  nglImagePartialDelegate mPartialDelegate;
+
+  uint32 GetTargetReduction(uint32 Width, uint32 Height, uint32 MaxReduction) const; ///< Biggest integer reduction factor (<= MaxReduction) that keeps a Width x Height image at least as big as the target size.
+  bool SendPartial(float Completion);  ///< Hand the partially decoded image to the partial delegate. Returns false if the delegate wants to abort.
 
   bool SendInfo(nglImageInfo& rInfo);  ///< Send image description to image object. The image object will allocate the image buffer. Returns true if the image object is ok, false if it doesn't want the rest of the data.
   bool SendData(float Completion);  ///< Acknowledge that more data was decoded to image buffer. Returns true if the image object is ok, false if it doesn't want the rest of the data.
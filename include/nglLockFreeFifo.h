@@ -24,7 +24,9 @@ template<class T> class nglLockFreeFifo : nuiNonCopyable
       NGL_ASSERT(mReadIdx != mWriteIdx);
       //	throw runtime_error ("lock free fifo underrun");
       
+      ngl_atomic_barrier(); // Read the element after having seen the writer's index
       T result = mBuffer[mReadIdx];
+      ngl_atomic_barrier(); // Release the slot after having read the element
       
       if ((mReadIdx + 1) >= mBuffer.size())
         mReadIdx = 0;
@@ -47,6 +49,7 @@ template<class T> class nglLockFreeFifo : nuiNonCopyable
       //throw runtime_error ("lock free fifo overrun");
       
       mBuffer[mWriteIdx] = element;
+      ngl_atomic_barrier(); // Publish the element before the index
       
       mWriteIdx = newIdx;
     }
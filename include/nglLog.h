@@ -17,6 +17,7 @@
 #include "nglString.h"
 #include "nglReaderWriterLock.h"
 class nglOStream;
+class nuiString8;
 
 /* Verbosity levels
  */
@@ -145,6 +146,15 @@ public:
 
     Vararg variant of the Log() method.
   */
+  void       Log (const nglChar* pDomain, uint Level, const nuiString8& rText);
+  /*!<
+    Log an event
+    \param pDomain domain name
+    \param Level verbose level
+    \param rText UTF-8 text
+
+    The text is not a format string. It is only converted if the event is not filtered out by the domain level.
+  */
   void       Dump (uint Level = 0) const;  ///< Dumps domain usage statistics using \p Level verbosity
   //@}
 
@@ -175,6 +185,7 @@ private:
   nglLog(const nglLog&) {} // Undefined copy constructor
 
   Domain* LookupDomain (const nglChar* pName);
+  void    Output (Domain* pDomain); ///< Stamp and output the lines of mOutputBuffer
   void    Output (const nglString& rText) const;
 
   mutable nglReaderWriterLock mLock;
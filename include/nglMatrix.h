@@ -640,4 +640,129 @@ mat1 = mat1 * mat2;
 typedef nglMatrix<float> nglMatrixf;
 typedef nglMatrix<double> nglMatrixd;
 
+
+/*
+ * SSE versions of the float matrix products and inversion
+ */
+
+// SSE is part of the x64 instruction set, 32 bits builds only get these versions when they are compiled for it.
+// Define __NGL_NO_SIMD_MATRIX__ to use the generic template everywhere.
+#if ((defined __SSE__) || (defined _M_X64) || (defined _M_IX86_FP && _M_IX86_FP >= 1)) && !(defined __NGL_NO_SIMD_MATRIX__)
+#define NGL_MATRIX_SSE
+#include <xmmintrin.h>
+
+#define NGL_SHUFFLE(X, Y, Z, W) _MM_SHUFFLE(W, Z, Y, X) ///< Shuffle mask given in the order of the destination elements
+#define NGL_SWIZZLE(V, X, Y, Z, W) _mm_shuffle_ps(V, V, NGL_SHUFFLE(X, Y, Z, W))
+
+// The matrix is loaded column by column. The products add the terms in the same order as the template so they give the
+// same results.
+template <> inline void nglMatrix<float>::operator *= (const nglMatrix<float>& rMatrix)
+{
+  const __m128 c0 = _mm_loadu_ps(Array);
+  const __m128 c1 = _mm_loadu_ps(Array + 4);
+  const __m128 c2 = _mm_loadu_ps(Array + 8);
+  const __m128 c3 = _mm_loadu_ps(Array + 12);
+  __m128 result[4];
+  for (uint i = 0; i < 4; i++)
+  {
+    const __m128 column = _mm_loadu_ps(rMatrix.Array + 4 * i);
+    __m128 r = _mm_mul_ps(c0, NGL_SWIZZLE(column, 0, 0, 0, 0));
+    r = _mm_add_ps(r, _mm_mul_ps(c1, NGL_SWIZZLE(column, 1, 1, 1, 1)));
+    r = _mm_add_ps(r, _mm_mul_ps(c2, NGL_SWIZZLE(column, 2, 2, 2, 2)));
+    result[i] = _mm_add_ps(r, _mm_mul_ps(c3, NGL_SWIZZLE(column, 3, 3, 3, 3)));
+  }
+  for (uint i = 0; i < 4; i++)
+    _mm_storeu_ps(Array + 4 * i, result[i]);
+}
+
+template <> inline nglVector<float> nglMatrix<float>::operator * (const nglVector<float>& rVector) const
+{
+  nglVector<float> result;
+  __m128 r = _mm_mul_ps(_mm_loadu_ps(Array), _mm_set1_ps(rVector[0]));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(Array + 4), _mm_set1_ps(rVector[1])));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(Array + 8), _mm_set1_ps(rVector[2])));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(Array + 12), _mm_set1_ps(rVector[3])));
+  _mm_storeu_ps(result.Elt, r);
+  return result;
+}
+
+// Products of 2x2 matrixes stored as (M11, M12, M21, M22) in a register. A# is the adjugate of A.
+inline __m128 nglMatrix2Mul(__m128 A, __m128 B) ///< A * B
+{
+  return _mm_add_ps(_mm_mul_ps(A, NGL_SWIZZLE(B, 0, 3, 0, 3)), _mm_mul_ps(NGL_SWIZZLE(A, 1, 0, 3, 2), NGL_SWIZZLE(B, 2, 1, 2, 1)));
+}
+
+inline __m128 nglMatrix2AdjMul(__m128 A, __m128 B) ///< A# * B
+{
+  return _mm_sub_ps(_mm_mul_ps(NGL_SWIZZLE(A, 3, 3, 0, 0), B), _mm_mul_ps(NGL_SWIZZLE(A, 1, 1, 2, 2), NGL_SWIZZLE(B, 2, 3, 0, 1)));
+}
+
+inline __m128 nglMatrix2MulAdj(__m128 A, __m128 B) ///< A * B#
+{
+  return _mm_sub_ps(_mm_mul_ps(A, NGL_SWIZZLE(B, 3, 0, 3, 0)), _mm_mul_ps(NGL_SWIZZLE(A, 1, 0, 3, 2), NGL_SWIZZLE(B, 2, 1, 2, 1)));
+}
+
+/*! Block wise inversion: the matrix is split in four 2x2 matrixes
+\code
+  M = | A B |
+      | C D |
+\endcode
+and the blocks of the inverse are computed from their adjugates and determinants. The columns are used as the rows of
+the blocks: this inverts the transposed matrix, and the transposed result is stored column by column.
+*/
+template <> inline void nglMatrix<float>::Invert ()
+{
+  const __m128 c0 = _mm_loadu_ps(Array);
+  const __m128 c1 = _mm_loadu_ps(Array + 4);
+  const __m128 c2 = _mm_loadu_ps(Array + 8);
+  const __m128 c3 = _mm_loadu_ps(Array + 12);
+
+  const __m128 A = _mm_movelh_ps(c0, c1);
+  const __m128 B = _mm_movehl_ps(c1, c0);
+  const __m128 C = _mm_movelh_ps(c2, c3);
+  const __m128 D = _mm_movehl_ps(c3, c2);
+
+  // Determinants of A, B, C and D:
+  const __m128 det = _mm_sub_ps(
+    _mm_mul_ps(_mm_shuffle_ps(c0, c2, NGL_SHUFFLE(0, 2, 0, 2)), _mm_shuffle_ps(c1, c3, NGL_SHUFFLE(1, 3, 1, 3))),
+    _mm_mul_ps(_mm_shuffle_ps(c0, c2, NGL_SHUFFLE(1, 3, 1, 3)), _mm_shuffle_ps(c1, c3, NGL_SHUFFLE(0, 2, 0, 2))));
+  const __m128 detA = NGL_SWIZZLE(det, 0, 0, 0, 0);
+  const __m128 detB = NGL_SWIZZLE(det, 1, 1, 1, 1);
+  const __m128 detC = NGL_SWIZZLE(det, 2, 2, 2, 2);
+  const __m128 detD = NGL_SWIZZLE(det, 3, 3, 3, 3);
+
+  const __m128 D_C = nglMatrix2AdjMul(D, C);
+  const __m128 A_B = nglMatrix2AdjMul(A, B);
+
+  // Adjugates of the blocks of the inverse:
+  __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), nglMatrix2Mul(B, D_C));
+  __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), nglMatrix2Mul(C, A_B));
+  __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), nglMatrix2MulAdj(D, A_B));
+  __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), nglMatrix2MulAdj(A, D_C));
+
+  // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+  __m128 trace = _mm_mul_ps(A_B, NGL_SWIZZLE(D_C, 0, 2, 1, 3));
+  trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+  trace = _mm_add_ss(trace, NGL_SWIZZLE(trace, 1, 1, 1, 1));
+  const __m128 determinant = _mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), trace);
+  if (_mm_cvtss_f32(determinant) == 0.f)
+    return;
+
+  // Adding zero turns the -0 that the signs of the adjugates give into 0, so that inverting the identity gives the
+  // identity as far as operator== is concerned
+  const __m128 scale = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), NGL_SWIZZLE(determinant, 0, 0, 0, 0));
+  const __m128 zero = _mm_setzero_ps();
+  X = _mm_add_ps(_mm_mul_ps(X, scale), zero);
+  Y = _mm_add_ps(_mm_mul_ps(Y, scale), zero);
+  Z = _mm_add_ps(_mm_mul_ps(Z, scale), zero);
+  W = _mm_add_ps(_mm_mul_ps(W, scale), zero);
+
+  _mm_storeu_ps(Array,      _mm_shuffle_ps(X, Y, NGL_SHUFFLE(3, 1, 3, 1)));
+  _mm_storeu_ps(Array + 4,  _mm_shuffle_ps(X, Y, NGL_SHUFFLE(2, 0, 2, 0)));
+  _mm_storeu_ps(Array + 8,  _mm_shuffle_ps(Z, W, NGL_SHUFFLE(3, 1, 3, 1)));
+  _mm_storeu_ps(Array + 12, _mm_shuffle_ps(Z, W, NGL_SHUFFLE(2, 0, 2, 0)));
+}
+
+#endif // NGL_MATRIX_SSE
+
 #endif // __nglMatrix_h__
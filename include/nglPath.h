@@ -13,6 +13,7 @@
 
 class nglIStream;
 class nglIOStream;
+class nuiString8;
 
 //! nglPath base
 /*!
@@ -104,6 +105,12 @@ public:
 	/*!< nglPath constructor
 	\param rPathName path name
 
+	For portability reasons, any '\\' (anti-slash) characters are replaced by '/' (slash).
+	*/
+	nglPath(const nuiString8& rPathName);
+	/*!< nglPath constructor
+	\param rPathName path name, UTF-8 encoded
+
 	For portability reasons, any '\\' (anti-slash) characters are replaced by '/' (slash).
 	*/
 	nglPath(nglPathBase Base);
@@ -221,6 +228,7 @@ public:
 	const nglPath& operator=(const char* pSource);       ///< Initialize a path from a string using locale's encoding
 	const nglPath& operator=(const nglChar* pSource);    ///< Initialize a path from a string
 	const nglPath& operator=(const nglString& rSource);  ///< Initialize a path from a string
+	const nglPath& operator=(const nuiString8& rSource); ///< Initialize a path from a UTF-8 string
 	const nglPath& operator=(const nglPath& rSource);    ///< Copy a path
 
 	const nglPath& operator+=(const nglPath& rAppend);
@@ -16,6 +16,7 @@
 #include "nglStream.h"
 #include "nglPath.h"
 #include "nglVolume.h"
+#include "nglCriticalSection.h"
 
 class nglIStream;
 
@@ -24,6 +25,8 @@ class nglIZip;
 class nglZipFS;
 class nglZipPath;
 class nglZipPrivate;
+class nglZipCursor;
+class nglZipSeekIndex;
 
 struct zlib_filefunc_def_s;
 
@@ -77,16 +80,22 @@ public:
   int  GetChildren(const nglZipPath& rPath, std::list<nglZipPath>& rList) const; ///< Populate the list with the children of the given path node in the zip.
 
   nglIZip* GetStream(const nglZipPath& rPath); ///< Return a stream that can read the file pointed to by rPath in the Zip FS.
+  /*!< Each stream has its own decompression state: streams opened from the same archive can be read concurrently from different threads.
+       Stored (uncompressed) entries are read directly from the archive data, so seeking in them is free. */
+
+  void SetSeekIndexSpan(uint32 Span); ///< Set the distance in uncompressed bytes between two seek checkpoints of a deflated entry (1 MB by default, 0 disables the seek index).
+  /*!< The checkpoints are taken while the entries are being decompressed. SetPos() then resumes from the closest one
+       instead of decompressing the entry from its start. Each checkpoint costs 32 KB. Only the entries opened after
+       this call are affected. */
+  uint32 GetSeekIndexSpan() const;
 
 private:
   // Needed to build an index of the zip:
   class Node
   {
   public:
-    Node(const nglString& rPath, uint Size, uint Pos, uint Num, bool IsLeaf);
+    Node(const nglString& rName, const nglString& rPath, uint32 Hash, uint Size, uint Pos, uint Num, bool IsLeaf);
     virtual ~Node();
-    Node* Find(const nglPath& rPath) const;
-    Node* Find(const nglString& rNodeName) const;
     bool AddChild(Node* pPath);
 
   private:
@@ -96,6 +105,12 @@ private:
     uint      mNumOfFile;          /* # of file */
     bool      mIsLeaf;
     nglString mName;
+    nglString mPath;               /* full path in the zip, without leading or trailing slash */
+    uint32    mHash;               /* hash of mPath */
+    nglFileOffset mDataOffset;     /* offset of the entry data in the archive, -1 until the entry is first opened */
+    uint      mCompressedSize;
+    bool      mCompressed;
+    nglZipSeekIndex* mpSeekIndex;  /* created on first open of a big deflated entry */
 
     friend class nglZipFS;
   };
@@ -105,22 +120,34 @@ private:
   nglZipPrivate* mpPrivate;
   Node           mRoot; ///< The zip file's root directory
 
-  // Direct File Operations:
-  bool           Close(void* pUnzip);
-  nglStreamState GetState(void* pUnzip) const;
+  // Full path index, built once by BuildIndex(). Open addressing, the size is a power of two:
+  std::vector<Node*> mIndex;
+  uint32             mIndexCount;
+
+  static uint32 HashPath(const nglChar* pPath, uint32 Length);
+  Node* FindNode(const nglString& rPath) const; ///< Find a node from a path relative to the root of the zip
+  Node* FindNode(const nglChar* pPath, uint32 Length, uint32 Hash) const;
+  void AddToIndex(Node* pNode);
+  nglIZip* OpenNode(Node* pNode);
+  bool LocateNode(Node* pNode); ///< Read the local header of the entry to find where its data starts
 
-  nglFileOffset GetPos(void* pUnzip) const;
-  nglFileOffset SetPos (void* pUnzip, nglFileOffset Where, nglIZip* pFile);
-  nglFileSize Available (void* pUnzip, uint WordSize = 1);
+  // Raw access to the archive, shared by all the streams:
+  nglCriticalSection mStreamLock; ///< Serializes the seek + read pairs on mpStream
+  const uint8*   mpData;          ///< The whole archive when it lives in memory (nglIMemory, mapped nglIFile), read without locking
+  nglFileSize    mDataSize;
+  nglSize ReadRaw(nglFileOffset Position, void* pData, nglSize Size);
 
-  nglSize Read (void* pUnzip, void* pData, nglSize WordCount, uint WordSize, nglEndian nglEndian);
+  nglCriticalSection mNodeLock;   ///< Protects the data location and seek index of the nodes, set on first open
+  uint32         mSeekIndexSpan;
 
   bool BuildIndex(); // Build the internal ZIP directory
 
   friend class nglZipPath;
   friend class nglIZip;
+  friend class nglZipCursor;
   
   zlib_filefunc_def_s* mpFileFuncDef;
+  zlib_filefunc_def_s* mpCursorFuncDef; ///< File functions of the unzip handles used to locate the entries
 }; 
 
 class nuiZipWriter
@@ -9,6 +9,7 @@
 
 #include "nui.h"
 
+// The buffer converters use SSE2, SSSE3 or AVX2 when the CPU has them, with the same results as the scalar code.
 void nuiAudioConvert_INint16ToDEfloat(const int16* input, float* output, uint32 curChannel, uint32 nbChannels, uint32 nbSampleFrames); // interlaced int16 to de-interlaced float
 
 void nuiAudioConvert_DEfloatToINint16(const float* input, int16* output, uint32 curChannel, uint32 nbChannels, uint32 nbSampleFrames); // de-interlaced float to interlaced int16
@@ -25,6 +26,8 @@ void nuiAudioConvert_FloatBufferTo16bits(float* pFloatBuffer, int16* pInt16Buffe
 //
 float nuiAudioConvert_24bitsToFloatFromLittleEndian(uint8* pBytesBuf); ///< Convert 24 bits int Little Endian number to float number (32 bits) \param pBytesBuf pointer to a buffer of 3 unsigned 8 bits int which represent the 24 bit int number to convert \return The float converted number
 float nuiAudioConvert_24bitsToFloatFromBigEndian(uint8* pBytesBuf);  ///< Convert 24 bits int Big Endian number to float number (32 bits) \param pBytesBuf pointer to a buffer of 3 unsigned 8 bits int which represent the 24 bit int number to convert \return The float converted number
+void nuiAudioConvert_24bitsLittleEndianToFloat(const uint8* pInBuffer, float* pOutBuffer, uint64 SizeToRead); ///< Convert a buffer of 24 bits Little Endian int numbers to a float (32 bits) numbers buffer \param pInBuffer Pointer to SizeToRead * 3 bytes \param pOutBuffer Pointer to a buffer that receives converted float numbers \param SizeToRead Number of numbers to convert
+void nuiAudioConvert_24bitsBigEndianToFloat(const uint8* pInBuffer, float* pOutBuffer, uint64 SizeToRead); ///< Convert a buffer of 24 bits Big Endian int numbers to a float (32 bits) numbers buffer \param pInBuffer Pointer to SizeToRead * 3 bytes \param pOutBuffer Pointer to a buffer that receives converted float numbers \param SizeToRead Number of numbers to convert
 //
 void nuiAudioConvert_FloatTo24bitsLittleEndian(float* pInBuffer, uint8* pOutBuffer, uint64 SizeToRead);  ///< Convert a float (32 bits) numbers buffer to a 24 bits Little Endian intnumbers buffer \param pInBuffer Pointer to a buffer that contains float numbers to convert \param pOutBuffer Pointer to a buffer that receives converted 24 bits int numbers /param SizeToRead Number of numbers to convert from pInBuffer to pOutBuffer
 void nuiAudioConvert_FloatTo24bitsBigEndian(float* pInBuffer, uint8* pOutBuffer, uint64 SizeToRead); ///< Convert a float (32 bits) numbers buffer to a 24 bits Big Endian int numbers buffer \param pInBuffer Pointer to a buffer that contains float numbers to convert \param pOutBuffer Pointer to a buffer that receives converted 24 bits int numbers /param SizeToRead Number of numbers to convert from pInBuffer to pOutBuffer
@@ -33,4 +36,11 @@ void nuiAudioConvert_FloatTo32bits(float* pInBuffer, int32* pOutBuffer, uint64 S
 //
 void nuiAudioConvert_32bitsToFloat(int32* pInBuffer, float* pOutBuffer, uint64 SizeToRead);  ///< Convert a 32 bits int numbers buffer to a float (32 bits) numbers buffer \param pInBuffer Pointer to a buffer that contains 32 bits int numbers to convert \param pOutBuffer Pointer to a buffer that receives converted float numbers /param SizeToRead Number of numbers to convert from pInBuffer to pOutBuffer
 //
+void nuiAudioConvert_INfloatToDEfloat(const float* pInput, float* const* pOutputs, uint32 nbChannels, uint32 nbSampleFrames); // interlaced float to de-interlaced float
+void nuiAudioConvert_DEfloatToINfloat(const float* const* pInputs, float* pOutput, uint32 nbChannels, uint32 nbSampleFrames); // de-interlaced float to interlaced float
+//
 
+// Mixing kernels, using SSE or AVX2 when the CPU has them. They don't allocate nor lock and can be called from the audio thread.
+void nuiAudioMix_Add(float* pDst, const float* pSrc, float Gain, uint32 SampleFrames); ///< pDst[i] += pSrc[i] * Gain
+void nuiAudioMix_AddRamp(float* pDst, const float* pSrc, float Gain, float GainStep, uint32 SampleFrames); ///< pDst[i] += pSrc[i] * (Gain + i * GainStep)
+void nuiAudioMix_MultiplyRamp(float* pBuffer, float Gain, float GainStep, uint32 SampleFrames); ///< pBuffer[i] *= Gain + i * GainStep
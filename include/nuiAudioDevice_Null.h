@@ -0,0 +1,113 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiAudioDevice.h"
+#include "nglThread.h"
+
+class nuiSampleWriter;
+
+/// Audio device without hardware
+/*!
+The null device calls the process function of its client (a nuiAudioEngine for instance) the way a sound card does, but
+the audio goes nowhere or to a nuiSampleWriter such as a nuiWaveWriter. Its inputs are silent. It runs on any platform and
+is the default device on Linux.
+
+ - In real time mode a thread calls the process function every BufferSize / SampleRate seconds, from Open() to Close().
+ - In offline mode nothing happens until Render() is called: it runs the process function on the calling thread as fast
+   as possible. This renders mixes without a sound card, deterministically, and benchmarks the client.
+
+The time spent in each call of the process function is measured, see GetTimings().
+*/
+class nuiAudioDevice_Null : public nuiAudioDevice
+{
+public:
+  enum Mode
+  {
+    eRealTime = 0,
+    eOffline
+  };
+
+  nuiAudioDevice_Null(Mode mode = eRealTime, uint32 InputChannels = 2, uint32 OutputChannels = 2);
+  virtual ~nuiAudioDevice_Null();
+
+  virtual bool Open(std::vector<uint32>& rInputChannels, std::vector<uint32>& rOutputChannels, double SampleRate, uint32 BufferSize, nuiAudioProcessFn pProcessFunction);
+  virtual bool Close();
+
+  Mode GetMode() const;
+  bool IsOpen() const;
+
+  void SetWriter(nuiSampleWriter* pWriter, uint32 BitsPerSample = 16); ///< Write the output to pWriter, which is not owned by the device. Must be called before Open(), which calls pWriter->WriteInfo(). Close() calls pWriter->Finalize().
+  uint64 Render(uint64 SampleFrames); ///< Offline mode: call the process function until at least SampleFrames have been rendered. Returns the number of sample frames rendered, a multiple of the buffer size.
+  uint64 GetRenderedFrames() const; ///< Number of sample frames rendered since Open().
+
+  /// Callback timing statistics
+  class Timings
+  {
+  public:
+    Timings();
+
+    double GetAverageTime() const; ///< Average duration of a call (seconds)
+    double GetLoad() const; ///< Average duration of a call divided by the duration of a buffer. Offline, 1 / GetLoad() is the speed relative to real time.
+
+    double mBufferDuration; ///< BufferSize / SampleRate (seconds)
+    uint32 mCallbacks;
+    uint32 mOverruns; ///< Calls that took longer than the duration of a buffer
+    double mTotalTime; ///< Time spent in the process function (seconds)
+    double mMinTime;
+    double mMaxTime;
+    uint32 mLateCallbacks; ///< Real time mode: calls that started more than a buffer after their time
+    double mMaxLateness; ///< Real time mode: longest delay between the time a call was due and its start (seconds)
+  };
+
+  Timings GetTimings() const;
+  void ResetTimings();
+
+protected:
+  void Run(); ///< Real time thread
+  void Process(double Lateness);
+
+  Mode mMode;
+  nuiAudioProcessFn mProcessFunction;
+  double mSampleRate;
+  uint32 mBufferSize;
+
+  std::vector<float> mInputSamples;
+  std::vector<float> mOutputSamples;
+  std::vector<const float*> mInputBuffers;
+  std::vector<float*> mOutputBuffers;
+
+  nuiSampleWriter* mpWriter;
+  uint32 mBitsPerSample;
+  std::vector<float> mInterleaved;
+
+  nglThread* mpThread;
+  volatile bool mStop;
+  bool mOpen;
+  uint64 mRenderedFrames;
+
+  mutable nglCriticalSection mTimingsCS;
+  Timings mTimings;
+};
+
+
+class nuiAudioDeviceAPI_Null : public nuiAudioDeviceAPI
+{
+public:
+  nuiAudioDeviceAPI_Null();
+  virtual ~nuiAudioDeviceAPI_Null();
+
+  virtual uint32 GetDeviceCount() const;
+  virtual nuiAudioDevice* GetDevice(uint32 index); ///< Device 0 is the real time device, device 1 the offline one.
+  virtual nuiAudioDevice* GetDevice(const nglString& rDeviceName);
+  virtual nglString GetDeviceName(uint32 index) const;
+  virtual nuiAudioDevice* GetDefaultOutputDevice();
+  virtual nuiAudioDevice* GetDefaultInputDevice();
+};
+
+extern nuiAudioDeviceAPI_Null NullAudioAPI;
@@ -12,6 +12,7 @@
 #include "nuiAudioDevice.h"
 #include "nuiAudioDecoder.h"
 #include "nglRingBuffer.h"
+#include "nglLockFreeFifo.h"
 
 #include "nuiSound.h"
 
@@ -20,6 +21,13 @@
 class nuiVoice;
 class nuiAudioDevice;
 
+/// Mixer of nuiVoice objects played on an audio device
+/*!
+The audio callback is real time safe: it doesn't lock nor allocate. The voices are added and removed through lock free
+queues that the audio thread empties at the start of each buffer, the voices that stopped are sent back through another
+queue to be released outside of the audio thread (by the next PlaySound() or StopSound() call, or by
+ReleaseFinishedVoices()), and the mix buffers are allocated when the output device is opened.
+*/
 class nuiAudioEngine : public nuiObject
 {
 public:
@@ -34,6 +42,7 @@ public:
   };
   
   nuiAudioEngine(double SampleRate, uint32 BufferSize, ChannelConfig inputConfig = eNone);
+  nuiAudioEngine(nuiAudioDevice* pOutputDevice, double SampleRate, uint32 BufferSize); ///< Play through the given device, which is owned by the engine.
   virtual ~nuiAudioEngine();
   
   double GetSampleRate() const;
@@ -53,8 +62,9 @@ public:
 
 
   nuiVoice* PlaySound(const nglPath& path, nuiSound::Type type = nuiSound::eStream);
-  nuiVoice* PlaySound(nuiSound* pSound);
+  nuiVoice* PlaySound(nuiSound* pSound); ///< Return NULL if too many voices are waiting to be started. The voice is dropped unplayed if MaxVoices are already playing.
   void StopSound(nuiVoice* pnuiVoice);
+  void ReleaseFinishedVoices(); ///< Release the voices that the audio thread has stopped playing.
   
   float GetGain();
   void SetGain(float gain);
@@ -81,6 +91,30 @@ protected:
 
   void InitAttributes();
   
+  enum
+  {
+    MaxVoices = 1024,
+    QueueSize = 1024
+  };
+  
+  struct Command
+  {
+    enum Type
+    {
+      eAddVoice,
+      eRemoveVoice
+    };
+    
+    Type mType;
+    nuiVoice* mpVoice;
+  };
+  
+  bool PostCommand(Command::Type type, nuiVoice* pVoice);
+  void ProcessCommands();
+  void RemoveVoice(uint32 index);
+  void AllocateBuffers(uint32 Channels, uint32 SampleFrames);
+  void Mix(const std::vector<float*>& rOutput, uint32 Offset, uint32 SampleFrames);
+  
   double mSampleRate;
   uint32 mBufferSize;
 
@@ -98,9 +132,14 @@ protected:
   nuiAudioEngine::InputDelegate mInputDelegate;
   nuiAudioEngine::OutputDelegate mOutputDelegate;
   
-  nglCriticalSection mCs;
+  nglCriticalSection mCs; ///< Serializes the threads that post commands, never taken by the audio thread
+  nglLockFreeFifo<Command> mCommands; ///< To the audio thread
+  nglLockFreeFifo<nuiVoice*> mFinishedVoices; ///< From the audio thread, to be released
 
-  std::vector<nuiVoice*> mVoices;
-  std::vector<nuiVoice*> mAddVoicesQueue;
-  std::vector<nuiVoice*> mRemoveVoicesQueue;
+  std::vector<nuiVoice*> mVoices; ///< Audio thread only, MaxVoices are reserved
+  
+  uint32 mMixFrames; ///< Size of the mix buffers: the audio callback mixes larger buffers in several passes
+  std::vector<float> mMixBuffer;
+  std::vector<float*> mMixBuffers;
+  std::vector<float> mLastGains; ///< Gain applied at the end of the last buffer to each channel, ramped to the new gain over the next buffer
 };
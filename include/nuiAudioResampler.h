@@ -274,3 +274,63 @@ void nuiAudioResampler<T>::SetInterpolationMethod(nuiInterpolationMethod interpo
 {
   mInterpolationMethod = interpol;
 }
+
+
+/// Band limited sample rate converter
+/*!
+nuiAudioSincResampler converts the sample rate of a float stream with a Kaiser windowed sinc filter, which is much cleaner
+than the interpolations of nuiAudioResampler: the images and the aliases are attenuated by 80 to 120 dB depending on the
+quality. The cutoff follows the lowest of the two Nyquist frequencies.
+
+The filter is precomputed for a number of fractional positions (the phases) and the resampler interpolates linearly
+between the two closest ones. Process() works on blocks: it consumes all the input it is given and outputs every sample
+frame it has enough input for, using SSE or AVX2 when the CPU has them. The first output sample frame is aligned with
+the first input one, and the last GetLatency() input sample frames are only used after more input comes or Flush() is
+called.
+
+A resampler handles one channel, use one per channel.
+*/
+class nuiAudioSincResampler
+{
+public:
+  enum Quality
+  {
+    eSincFast = 0, ///< 32 taps, 80 dB of attenuation, passband up to 68% of the Nyquist frequency
+    eSincMedium,   ///< 64 taps, 100 dB of attenuation, passband up to 80% of the Nyquist frequency
+    eSincBest      ///< 128 taps, 120 dB of attenuation, passband up to 88% of the Nyquist frequency
+  };
+
+  nuiAudioSincResampler(double InputRate, double OutputRate, Quality quality = eSincMedium);
+  virtual ~nuiAudioSincResampler();
+
+  void SetRates(double InputRate, double OutputRate); ///< Change the conversion ratio. This resets the resampler.
+  double GetInputRate() const;
+  double GetOutputRate() const;
+  void SetQuality(Quality quality); ///< Change the filter. This resets the resampler.
+  Quality GetQuality() const;
+
+  uint32 GetLatency() const; ///< Number of input sample frames that Process() keeps until it gets the following ones.
+  uint32 GetMaxOutputFrames(uint32 InputFrames) const; ///< Size of the output buffer Process() needs for InputFrames.
+
+  uint32 Process(const float* pInput, uint32 InputFrames, float* pOutput); ///< Resample InputFrames and return the number of sample frames written to pOutput.
+  uint32 Flush(float* pOutput); ///< Output the end of the stream, as if it was followed by silence, and reset the resampler. pOutput must have room for GetMaxOutputFrames(GetLatency()) sample frames.
+  void Reset(); ///< Forget the past input to start a new stream.
+
+private:
+  void Design();
+  uint32 Resample(float* pOutput, uint64 MaxFrames);
+
+  double mInputRate;
+  double mOutputRate;
+  double mStep; ///< Input sample frames per output sample frame
+  Quality mQuality;
+
+  uint32 mTaps; ///< Length of the filter, a multiple of 8
+  uint32 mPhases;
+  std::vector<float> mFilter; ///< (mPhases + 1) rows of mTaps coefficients
+
+  std::vector<float> mHistory; ///< Input sample frames from the first one still needed
+  uint64 mHistoryStart; ///< Index in the stream of mHistory[0], counting the zeros that precede the stream
+  uint64 mInputFrames; ///< Number of input sample frames received since Reset()
+  uint64 mOutputFrames; ///< Number of output sample frames produced since Reset()
+};
@@ -0,0 +1,134 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#pragma once
+
+#include "nui.h"
+#include "nglRingBuffer.h"
+#include "nglSyncEvent.h"
+#include "nuiSampleReader.h"
+
+class nuiAudioStreamer;
+
+/// Prefetched audio file stream
+/*!
+A nuiAudioStream decodes a sample file ahead of the play cursor into a ring buffer. The decoding is done by the
+nuiAudioStreamer thread with the stream's nuiSampleReader (nuiWaveReader, nuiAiffReader or nuiAudioDecoder), and Read()
+only copies the prefetched samples, so it can be called from the audio thread.
+
+ - When looping, the end of the file is followed by its beginning in the ring buffer, so that loops don't wait for the
+   disk.
+ - Reading from another position than the one that follows the last read is a seek: the streamer thread moves the reader
+   and prefetches the new position while Read() outputs silence. The play cursor keeps moving in the mean time and the
+   samples that were missed are skipped when they arrive, so that the stream stays in time.
+ - When the prefetched samples run out (other than right after a seek) Read() outputs silence too, and counts an underrun.
+*/
+class nuiAudioStream
+{
+public:
+  nuiAudioStream(nglIStream* pStream, nuiSampleReader* pReader, const nuiSampleInfo& rInfo, uint32 PrefetchFrames); ///< The stream takes ownership of pStream and pReader.
+  virtual ~nuiAudioStream();
+
+  uint32 Read(const std::vector<float*>& rOutput, int64 Position, uint32 SampleFrames); ///< Copy SampleFrames from the given position of the file to rOutput (audio thread). Returns 0 at the end of the file.
+  void SetLoop(bool Loop); ///< Prefetch the beginning of the file after its end.
+  uint32 Preroll(uint32 SampleFrames); ///< Decode the beginning of the file on the calling thread. Must be called before the stream is added to the streamer.
+
+  uint32 GetChannels() const;
+  int64 GetSampleFrames() const;
+  uint32 GetPrefetchedFrames() const; ///< Number of sample frames ready to be read.
+  uint32 GetPrefetchSize() const;
+
+  uint32 GetUnderruns() const; ///< Number of calls to Read() that missed samples.
+  uint32 GetUnderrunFrames() const; ///< Number of sample frames replaced by silence.
+
+protected:
+  friend class nuiAudioStreamer;
+
+  uint32 Fill(uint32 MaxFrames); ///< Decode up to MaxFrames sample frames in the ring buffer (streamer thread). Returns the number of frames decoded.
+  bool NeedsData(uint32 MinFrames) const;
+  bool IsSeeking(uint32 ChunkFrames) const; ///< True if the streamer has to move the reader or hasn't decoded a chunk since it did (streamer thread).
+
+private:
+  bool HandleSeek(); ///< Streamer thread: move the reader to the requested position.
+  void Skip(); ///< Audio thread: drop the prefetched samples that were missed.
+
+  nglIStream* mpStream;
+  nuiSampleReader* mpReader;
+  uint32 mChannels;
+  int64 mSampleFrames;
+  nglRingBuffer mBuffer;
+  std::vector<void*> mWritePointers;
+
+  // Streamer thread:
+  int64 mSourcePosition; ///< Position of the reader, which is the position of the ring buffer's write index
+  uint32 mServedSeekRequests;
+  uint32 mFramesSinceSeek;
+
+  // Audio thread:
+  int64 mReadPosition; ///< Position of the ring buffer's read index in the file
+  int64 mSkipFrames; ///< Number of missed sample frames to drop when they arrive
+  int64 mSeekPosition;
+  uint32 mAppliedSeekRequests;
+  bool mSeekDone; ///< False until the first samples arrive after a seek, the silence in between is not an underrun
+
+  // Written by the audio thread like a sequence lock (odd while the position is being changed), read by the streamer
+  int64 mRequestedSeekPosition;
+  nglAtomic32 mSeekRequests;
+  // Written by the streamer thread once the reader is at mSeekPosition
+  nglAtomic32 mSeekServed;
+  nglAtomic32 mSeekWriteIndex; ///< Write index of the ring buffer when the seek was served: the samples before it are stale
+
+  volatile bool mLoop;
+  nglAtomic32 mUnderruns;
+  nglAtomic32 mUnderrunFrames;
+};
+
+/// Disk streaming thread for nuiAudioStream
+/*!
+The streamer owns a single thread that keeps the ring buffers of all the registered streams full, starting with the
+streams that have the least prefetched samples. The thread is started by the first call to Add(). The streams must be
+added and removed from a control thread (never from the audio thread); removing a stream waits until the streamer is done
+with it.
+*/
+class nuiAudioStreamer
+{
+public:
+  static nuiAudioStreamer Instance;
+
+  bool Add(nuiAudioStream* pStream); ///< Start prefetching the stream. The stream is not owned by the streamer.
+  void Remove(nuiAudioStream* pStream);
+  uint32 GetStreamCount() const;
+
+  void SetPrefetchFrames(uint32 Frames); ///< Ring buffer size of the new streams (65536 sample frames by default).
+  uint32 GetPrefetchFrames() const;
+  void SetChunkFrames(uint32 Frames); ///< Number of sample frames decoded at once for a stream (8192 by default).
+  uint32 GetChunkFrames() const;
+
+  uint32 GetUnderruns() const; ///< Total number of underruns of all the streams.
+  uint32 GetUnderrunFrames() const;
+
+private:
+  friend class nuiAudioStream;
+  nuiAudioStreamer();
+  virtual ~nuiAudioStreamer();
+
+  void Run();
+  void Stop();
+
+  std::set<nuiAudioStream*> mStreams;
+  mutable nglCriticalSection mCS; ///< Guards mStreams. Held while a stream is being filled.
+
+  nglThread* mpThread;
+  nglSyncEvent mWakeUp;
+  volatile bool mStop;
+
+  uint32 mPrefetchFrames;
+  uint32 mChunkFrames;
+  nglAtomic32 mUnderruns;
+  nglAtomic32 mUnderrunFrames;
+};
+
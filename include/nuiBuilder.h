@@ -67,7 +67,9 @@ public:
   void SetHandler(const nglString& ClassName, const nglString& ClassGroup, nuiCreateWidgetFn pHandler); ///< This method permits to add or override a widget creation function.
   void SetHandler(const nglString& ClassName, nuiWidgetCreator* pCreator); ///< This method permits to add or override a widget creation function.
   nuiCreateWidgetFn GetHandler(const nglString& ClassName) const; ///< This method retrieves thewidget creation function associated with a class name.
+  const nuiWidgetCreator* GetCreator(const nglString& rClassName) const; ///< This method retrieves the widget creator associated with a class name.
   bool GetClassList(std::list<nuiWidgetDesc>& rClassNames) const; ///< This method fills the given nuiWidgetDesc list with the description (name and group) of the classes that this map can handle. 
+  bool GetCreatorList(std::list<nglString>& rClassNames) const; ///< This method fills the given list with the names of the classes implemented by a nuiWidgetCreator.
 
   nuiWidget* CreateWidget(const nglString& rClassName) const;
   nuiWidget* CreateWidget(const nglString& rClassName, const std::map<nglString, nglString>& rParamDictionary) const;
@@ -102,7 +104,43 @@ nuiWidget* nuiCreateWidget(const nglString& rClassName);
 nuiWidget* nuiCreateWidget(const nuiXMLNode* pNode);
 
 ///////////////////////////////////////////////////////////////////
-class nuiWidgetCreatorOperation;
+class nuiWidgetCreatorOperation
+{
+public:
+  enum Type
+  {
+    eAddChild,
+    eSetCell1,
+    eSetCell2,
+    eSetProperty,
+    eSetAttribute,
+  };
+  
+  nuiWidgetCreatorOperation(Type type, nuiWidgetCreator* pCreator, uint32 index1, uint32 index2)
+  {
+    mType = type;
+    mpCreator = pCreator;
+    mIndex1 = index1;
+    mIndex2 = index2;
+  }
+  
+  nuiWidgetCreatorOperation(Type type, const nglString& rName, const nglString& rValue, uint32 index1 = -1, uint32 index2 = -1)
+  {
+    mType = type;
+    mpCreator = NULL;
+    mIndex1 = index1;
+    mIndex2 = index2;
+    mName = rName;
+    mValue = rValue;
+  }
+  
+  Type mType;
+  nuiWidgetCreator* mpCreator;
+  uint32 mIndex1;
+  uint32 mIndex2;
+  nglString mName;
+  nglString mValue;
+};
 
 class nuiWidgetCreator
 {
@@ -132,6 +170,7 @@ public:
   const std::map<nglString, nglString>& GetDefaultDictionary() const;
   std::map<nglString, nglString>& GetDefaultDictionary();
 protected:
+  friend class nuiWidgetCompiler;
   std::vector<nuiWidgetCreatorOperation> mOperations;
   nglString mClassName;
   nglString mObjectName;
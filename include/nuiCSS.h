@@ -10,6 +10,8 @@
 #include "nui.h"
 #include "nuiWidgetMatcher.h"
 
+class nuiString8;
+
 class nuiCSSAction
 {
 public:
@@ -144,6 +146,7 @@ public:
   virtual ~nuiCSS();
   
   bool Load(nglIStream& rStream, const nglPath& rSourcePath = nglPath(nglString::Null));
+  bool Load(const nuiString8& rSource, const nglPath& rSourcePath = nglPath(nglString::Null)); ///< Parse UTF-8 CSS text without copying it.
   bool Serialize(nglOStream& rStream);
   
   void AddRule(nuiCSSRule* pRule);
@@ -158,6 +161,7 @@ public:
   uint32 GetRulesCount() const;
   const std::vector<nuiCSSRule*> GetRules() const;
 private:
+  bool Parse(nglIStream& rStream, const nglPath& rSourcePath);
 
   std::vector<nuiCSSRule*> mRules;
   nglString mErrorString;
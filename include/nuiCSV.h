@@ -11,6 +11,76 @@
 #include "nglIStream.h"
 
 
+/// Streaming CSV reader (RFC 4180)
+/*!
+Rows are parsed on the fly, only the current row is kept in memory. Quoted cells may contain
+separators, doubled quotes and line breaks. CRLF, LF and CR line endings are accepted.
+
+The cells of the current row are stored unescaped, back to back, in a single buffer: GetCell()
+returns a pointer into it, which stays valid until the next ReadRow(). Convert to nglString only
+what you need with GetCellString().
+
+\code
+nuiCSVReader reader(pStream);
+while (reader.ReadRow())
+{
+  uint32 length;
+  const char* pName = reader.GetCell(0, length);
+  ...
+}
+if (!reader.GetError().IsEmpty())
+  NGL_OUT(_T("%ls\n"), reader.GetError().GetChars());
+\endcode
+*/
+class NUI_API nuiCSVReader
+{
+public:
+  typedef nuiFastDelegate1<nuiCSVReader&, bool> RowDelegate; ///< Called for each row by ReadRows(). Return false to stop.
+
+  nuiCSVReader(nglIStream* pStream, char Separator = ',', char Quote = '"');
+  ~nuiCSVReader();
+
+  void SetTrimSpaces(bool Set); ///< Ignore spaces and tabs around the cells, quoted cells may then be indented. Off by default: RFC 4180 says the spaces are part of the cell.
+  void EnableComments(bool Set, char CommentTag = '#'); ///< Rows starting with \a CommentTag are reported as comments (see IsComment())
+
+  bool ReadRow(); ///< Parse the next row. Returns false at the end of the stream or on a syntax error (see GetError()).
+  int64 ReadRows(const RowDelegate& rDelegate); ///< Parse all the remaining rows, calling \a rDelegate for each one. Returns the number of rows parsed.
+
+  uint32 GetCellCount() const; ///< Number of cells in the current row
+  const char* GetCell(uint32 Index, uint32& rLength) const; ///< Unescaped cell content, in the stream's encoding, not null terminated. Returns NULL if \a Index is out of range.
+  nglString GetCellString(uint32 Index) const; ///< Cell content converted from the stream's text encoding
+  void GetRow(std::vector<nglString>& rCells) const; ///< Convert the whole current row
+  bool IsComment() const; ///< The current row is a comment line, its text (after the tag) is cell 0
+  uint32 GetLineNumber() const; ///< Line of the stream where the current row starts (1 based)
+  const nglString& GetError() const; ///< Syntax error description, empty if everything went fine
+
+private:
+  bool Fill(); ///< Get more input, returns false at the end of the stream
+  int PeekChar(); ///< Next input byte or -1 at the end of the stream
+  void ReadLineEnding(); ///< Consume the CR, LF or CRLF at the input position
+  void TrimCell(size_t Start); ///< Remove the trailing spaces of the current cell, not before \a Start
+
+  nglIStream* mpStream;
+  nglTextEncoding mEncoding;
+  char mSeparator;
+  char mQuote;
+  char mCommentTag;
+  bool mTrimSpaces;
+  bool mCommentsEnabled;
+
+  std::vector<char> mInput;
+  size_t mInputPos;
+  size_t mInputSize;
+
+  std::vector<char> mRow;     ///< Cells of the current row, back to back
+  std::vector<uint32> mCells; ///< Offset of each cell in mRow, cell i ends where cell i+1 starts
+  bool mComment;
+  uint32 mLine;
+  uint32 mRowLine;
+  nglString mError;
+};
+
+
 /// allows to load and save data in CSV format
 class NUI_API nuiCSV
 {
@@ -18,7 +88,7 @@ public:
   nuiCSV(nglChar separationChar);
   ~nuiCSV();
   
-  bool Load(nglIStream* pStream, bool CheckNbColumns = true); ///< load the cvs contents from an input stream
+  bool Load(nglIStream* pStream, bool CheckNbColumns = true); ///< load the cvs contents from an input stream. Use nuiCSVReader directly to process big files row by row.
   bool Save(nglOStream* oStream); ///< save the formated csv contents to an output stream
   nglString Dump(); ///< return a string with the formated csv contents
 
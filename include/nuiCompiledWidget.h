@@ -0,0 +1,205 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiBuilder.h"
+
+class nuiCompiledAttributeHandler;
+
+/// Widget descriptions compiled to a compact binary form
+/*!
+A nuiCompiledWidget holds a set of named widget descriptions that were compiled offline by nuiWidgetCompiler from
+nuiWidgetCreator objects (CSS) or XML descriptions. In the compiled form:
+ - class and attribute names are interned once in tables and referenced by index,
+ - attribute values are already parsed to their native type (bool, integers, reals, strings, colors, rects, borders and
+   the common enums) so instantiating a widget never calls FromString for them,
+ - the widgets of all the descriptions are stored in a single flat node table, each node referencing a contiguous run of
+   the operation table (attributes, properties and children, in the order of the source description).
+
+Classes are resolved to their creation function and attribute ids to the nuiAttributeBase of each widget class the
+first time they are used, so creating the same description again does not perform any string lookup.
+
+The file format is little endian and starts with a version marker. Values of attribute types that have no native
+encoding are kept as text and go through FromString as in the string based path.
+*/
+class NUI_API nuiCompiledWidget
+{
+public:
+  nuiCompiledWidget();
+  virtual ~nuiCompiledWidget();
+
+  bool Load(nglIStream& rStream); ///< Replace the contents with the compiled descriptions read from the stream.
+  bool Save(nglOStream& rStream) const;
+  void Clear();
+
+  uint32 GetDescriptionCount() const;
+  const nglString& GetDescriptionName(uint32 Index) const;
+  int32 FindDescription(const nglString& rName) const; ///< Return the index of the named description or -1.
+
+  nuiWidget* Create(uint32 Index, const nuiBuilder* pBuilder = NULL); ///< Instantiate the given description. The classes are created with pBuilder, or the global builder if NULL.
+  nuiWidget* Create(const nglString& rName, const nuiBuilder* pBuilder = NULL);
+
+  size_t GetMemoryUsage() const; ///< Memory used by the tables.
+
+  enum ValueKind
+  {
+    eNoValue = 0,
+    eBool,
+    eInt,     ///< Signed integers and enums
+    eUInt,
+    eReal,
+    eVector,  ///< Four floats: colors, rects and borders
+    eString,  ///< Index of a nglString in the string table
+    eText     ///< Unparsed text (index in the string table) given to FromString at run time
+  };
+
+  struct Value
+  {
+    uint32 mKind;
+    union
+    {
+      int64 mInt;
+      uint64 mUInt;
+      double mReal;
+      float mVector[4];
+      uint32 mString;
+    };
+  };
+
+  enum OperationType
+  {
+    eAddChild = 0,
+    eSetCell1,
+    eSetCell2,
+    eSetProperty,
+    eSetAttribute
+  };
+
+  struct Operation
+  {
+    uint32 mType;
+    uint32 mTarget; ///< Node of a child, string of a property name or id of an attribute
+    int32 mIndex0;
+    int32 mIndex1;
+    Value mValue;
+  };
+
+  struct Node
+  {
+    uint32 mClass;
+    uint32 mName; ///< Object name in the string table, or InvalidIndex
+    uint32 mFirstOperation;
+    uint32 mOperationCount;
+  };
+
+  static const uint32 InvalidIndex = 0xffffffff;
+
+protected:
+  friend class nuiWidgetCompiler;
+
+  struct Binding
+  {
+    int32 mClassIndex;
+    const nuiAttributeBase* mpAttribute; ///< NULL if the class has no such writable attribute
+    const nuiCompiledAttributeHandler* mpHandler; ///< NULL for the attribute types that have no native encoding
+  };
+
+  nuiWidget* CreateNode(uint32 Index, const nuiBuilder* pBuilder);
+  void SetAttribute(nuiWidget* pWidget, const Operation& rOperation);
+  Binding GetBinding(nuiWidget* pWidget, uint32 AttributeId);
+  void ResetBindings();
+
+  std::vector<nglString> mStrings;
+  std::vector<uint32> mClasses; ///< Class names in the string table
+  std::vector<uint32> mAttributes; ///< Attribute names in the string table
+  std::vector<Node> mNodes;
+  std::vector<Operation> mOperations;
+  std::vector<std::pair<uint32, uint32> > mDescriptions; ///< Name in the string table and root node
+
+  // Run time caches:
+  const nuiBuilder* mpBuilder; ///< Builder used to resolve mHandlers
+  std::vector<nuiCreateWidgetFn> mHandlers;
+  std::vector<bool> mHandlersResolved;
+  std::vector<std::vector<Binding> > mBindings; ///< Per attribute id, one binding per widget class
+};
+
+/// Offline compiler producing nuiCompiledWidget descriptions
+/*!
+The compiler needs a builder to know the classes: attribute values are parsed with the nuiAttribute of a prototype
+instance of each class, and classes implemented by a nuiWidgetCreator are inlined in the description that uses them.
+
+XML descriptions are compiled with the generic rules of nuiObject::Load, nuiWidget::Load and
+nuiSimpleContainer::LoadChildren: XML attributes set the widget attributes of the same name, nuiPropertyBag elements
+and non creatable elements containing text set properties, and the other elements are child widgets. Classes that
+override Load to read their own XML elements are not compiled faithfully; Verify() reports them.
+*/
+class NUI_API nuiWidgetCompiler
+{
+public:
+  nuiWidgetCompiler(const nuiBuilder* pBuilder = NULL);
+  virtual ~nuiWidgetCompiler();
+
+  bool AddCreator(const nglString& rName, const nuiWidgetCreator* pCreator); ///< The creator must stay valid until Verify() is called.
+  bool AddCreators(); ///< Add all the creators registered in the builder under their class name.
+  bool AddXML(const nglString& rName, const nuiXMLNode* pNode); ///< The node must stay valid until Verify() is called.
+
+  const nuiCompiledWidget& GetCompiledWidget() const;
+  bool Save(nglOStream& rStream) const;
+
+  /// Round trip check of all the added descriptions
+  /*!
+  The compiled descriptions are saved, loaded back and instantiated, and each resulting widget tree is compared with
+  the one created from the source by the string based path (nuiWidgetCreator::Create or nuiCreateWidget + Load):
+  class, object name, readable attributes, properties and children. Returns false and describes the differences in
+  \a rReport if they do not match.
+  */
+  bool Verify(nglString& rReport);
+
+  const nglString& GetError() const; ///< Description of the last error of AddCreator() or AddXML().
+
+protected:
+  struct PendingNode
+  {
+    nglString mClass;
+    nglString mName;
+    std::vector<nuiCompiledWidget::Operation> mOperations;
+  };
+
+  typedef std::map<nglString, nglString> Dictionary;
+
+  bool CompileCreator(const nuiWidgetCreator* pCreator, const Dictionary& rParentDictionary, PendingNode& rNode, uint32 Depth);
+  bool CompileXML(const nuiXMLNode* pNode, PendingNode& rNode, uint32 Depth);
+  bool CompileClass(const nglString& rClass, const Dictionary& rDictionary, PendingNode& rNode, uint32 Depth);
+  void CompileAttribute(PendingNode& rNode, const nglString& rName, const nglString& rValue, int32 Index0, int32 Index1);
+  void CompileProperty(PendingNode& rNode, const nglString& rName, const nglString& rValue);
+  uint32 Commit(const PendingNode& rNode);
+  void AddDescription(const nglString& rName, uint32 Node);
+  bool IsCreatable(const nglString& rClass) const;
+
+  nuiWidget* GetPrototype(const nglString& rClass);
+  uint32 GetString(const nglString& rString);
+  uint32 GetClass(const nglString& rClass);
+  uint32 GetAttribute(const nglString& rName);
+
+  bool Compare(nuiWidget* pReference, nuiWidget* pCompiled, const nglString& rPath, nglString& rReport) const;
+
+  const nuiBuilder* mpBuilder;
+  nuiCompiledWidget mResult;
+  std::map<nglString, uint32, nglString::LessFunctor> mStringIndex;
+  std::map<nglString, uint32, nglString::LessFunctor> mClassIndex;
+  std::map<nglString, uint32, nglString::LessFunctor> mAttributeIndex;
+  std::map<nglString, nuiWidget*, nglString::LessFunctor> mPrototypes;
+
+  struct Source
+  {
+    const nuiWidgetCreator* mpCreator;
+    const nuiXMLNode* mpNode;
+  };
+  std::vector<Source> mSources; ///< One per description, for Verify()
+  nglString mError;
+};
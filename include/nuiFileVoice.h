@@ -9,9 +9,13 @@
 #include "nui.h"
 #include "nuiSampleReader.h"
 #include "nuiFileSound.h"
+#include "nuiAudioStreamer.h"
 
-
-class nuiFileVoice : nuiVoice
+/// Voice that streams a sound file from the disk
+/*!
+The file is decoded ahead of the play cursor by nuiAudioStreamer, the audio thread only reads the prefetched samples.
+*/
+class nuiFileVoice : public nuiVoice
 {
 public:
   friend class nuiFileSound;
@@ -24,6 +28,9 @@ public:
   
   uint32 GetSampleFrames() const;
   
+  uint32 GetUnderruns() const; ///< Number of audio buffers that missed prefetched samples.
+  uint32 GetUnderrunFrames() const;
+  
 protected:
   virtual uint32 ReadSamples(const std::vector<float*>& rOutput, int64 position, uint32 SampleFrames);
   
@@ -35,7 +42,6 @@ private:
   
   nuiFileSound* mpFileSound;
   
-  nglIStream* mpStream;
-  nuiSampleReader* mpReader;
+  nuiAudioStream* mpStream;
   nuiSampleInfo mInfo;
 };
\ No newline at end of file
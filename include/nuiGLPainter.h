@@ -48,6 +48,8 @@ public:
   virtual void CreateSurface(nuiSurface* pSurface);
   virtual void DestroySurface(nuiSurface* pSurface);
   virtual void InvalidateSurface(nuiSurface* pSurface, bool ForceReload);
+
+  void Flush(); ///< Draw the merged arrays that are still pending. Call it before sending GL commands directly.
   
 protected:
   void SetSurface(nuiSurface* pSurface);
@@ -72,6 +74,7 @@ protected:
     
     bool mReload;
     GLuint mTexture;
+    int64 mBytes; ///< Memory accounted for the texture
   };
   std::map<nuiTexture*, TextureInfo> mTextures;
 
@@ -89,6 +92,7 @@ protected:
     GLuint mRenderbuffer; ///< or a render buffer
     GLuint mDepthbuffer;
     GLuint mStencilbuffer;
+    int64 mBytes; ///< Memory accounted for the render buffers, the texture is accounted with the textures
   };
   std::map<nuiSurface*, FramebufferInfo> mFramebuffers;
   GLint mDefaultFramebuffer, mDefaultRenderbuffer;
@@ -121,6 +125,41 @@ protected:
   GLenum mTexEnvMode;
   
   uint32 mViewPort[4];
+
+  // Vertex buffers and batching:
+  class Batch
+  {
+  public:
+    GLenum mMode;
+    bool mVertexArray;
+    bool mColorArray;
+    bool mTexCoordArray;
+    bool mTranslateHack;
+    nuiColor mColor; ///< Used when there is no color array
+  };
+
+  void Draw(const Batch& rBatch, const nuiRenderArray::Vertex* pVertices, uint32 Count, nuiRenderArray* pArray); ///< pArray gives the index arrays and the static vertex buffer, it can be NULL.
+  void DrawPrimitives(GLenum Mode, uint32 Count, nuiRenderArray* pArray);
+  bool CanMerge(const nuiRenderArray* pArray) const;
+  int32 StreamVertices(const nuiRenderArray::Vertex* pVertices, uint32 Count); ///< Copy the vertices to the streaming ring, bind it and return their offset in bytes, or -1 to draw them from the client memory.
+  GLuint GetStaticBuffer(const nuiRenderArray* pArray); ///< Create or update the vertex buffer of a static array and bind it, returns 0 if it can't have one.
+
+  Batch mBatch; ///< Parameters shared by the arrays merged in mBatchVertices
+  std::vector<nuiRenderArray::Vertex> mBatchVertices;
+
+  bool mUseVertexBuffers;
+  bool mUseMapBufferRange;
+  GLuint mStreamBuffer;
+  uint32 mStreamOffset; ///< Bytes of the streaming ring written since it was last orphaned
+
+  class StaticBuffer
+  {
+  public:
+    GLuint mBuffer;
+    uint32 mCount; ///< Vertices uploaded
+    const nuiRenderArray* mpArray;
+  };
+  std::set<StaticBuffer*> mStaticBuffers; ///< Cache handles given to the static arrays
 };
 
 void nuiCheckForGLErrors();
@@ -10,8 +10,14 @@
 #include "nglThread.h"
 #include "nuiCommand.h"
 
+#if defined(_LINUX_)
+#define NUI_HTTP_IO_THREAD ///< The requests are run by a single curl multi I/O thread instead of one thread per request
+#endif
+
 class nuiHTTPResponse;
 class nuiHTTPRequest_Thread;
+class nuiHTTPCache;
+class nglOStream;
 
 typedef std::map<nglString, nglString, nglString::CaseInsensitiveLessFunctor> nuiHTTPHeaderMap;
 class nuiHTTPMessage
@@ -25,6 +31,7 @@ public:
   bool AddHeader(const nglString& rHeader); ///< Add new or replace existing header. String must be of form "<field-name>: <field-value>" as per HTTP 1.1 specification (IETF RFC 2616). Returns true in case of success.
 
   void SetBody(const char* pBuffer, nglSize ByteCnt);
+  void AppendBody(const char* pBuffer, nglSize ByteCnt);
   const std::vector<char>& GetBody() const;
   nglString GetBodyStr() const;
 
@@ -47,9 +54,21 @@ public:
 
   const nglString& GetURL() const;
   const nglString& GetMethod() const;
+
+  void SetOutputStream(nglOStream* pStream); ///< Write the body of the response to pStream as it is received instead of storing it in the response. The stream is not owned by the request.
+  nglOStream* GetOutputStream() const;
+  void SetCache(nuiHTTPCache* pCache); ///< Revalidate the response against pCache (NULL by default, which disables caching). The cache is not owned by the request.
+  nuiHTTPCache* GetCache() const;
+
 protected:
+  void QueueRequest(nuiHTTPRequest_Thread* pThread); ///< Run the request on the I/O thread (NUI_HTTP_IO_THREAD only)
+
   nglString mUrl;
   nglString mMethod;
+  nglOStream* mpOutputStream;
+  nuiHTTPCache* mpCache;
+
+  friend class nuiHTTPRequest_Thread;
 };
 
 class nuiHTTPResponse : public nuiHTTPMessage
@@ -76,6 +95,7 @@ protected:
   ~nuiHTTPRequest_Thread();
   
   void OnStart();
+  void OnResponse(nuiHTTPResponse* pResponse);
   bool SetArgs(const std::vector<nglString, std::allocator<nglString> >&);
   bool ExecuteDo();
   
@@ -88,3 +108,35 @@ private:
   friend class nuiHTTPRequest;
 };
 
+
+/// On disk cache of HTTP responses
+/*!
+The responses that carry an ETag or a Last-Modified header are stored in the cache folder, one file per URL. When a
+request that uses the cache (see nuiHTTPRequest::SetCache()) is sent again, the stored validators are sent in the
+If-None-Match and If-Modified-Since headers, and a "304 Not Modified" answer is replaced by the stored response: the
+body is only downloaded again when it has changed.
+
+Only GET requests use the cache. Responses with "Cache-Control: no-store" and requests streamed to a nglOStream are
+never stored. A cache can be shared by several requests and threads.
+*/
+class nuiHTTPCache
+{
+public:
+  nuiHTTPCache(const nglPath& rFolder); ///< The folder is created if needed.
+  virtual ~nuiHTTPCache();
+
+  const nglPath& GetFolder() const;
+
+  nuiHTTPResponse* GetResponse(const nglString& rURL) const; ///< Return a new copy of the stored response, or NULL.
+  bool Store(const nglString& rURL, const nuiHTTPResponse& rResponse); ///< Store a "200 OK" response if it has validators. Return false if the response was not stored.
+  bool Remove(const nglString& rURL);
+  void Clear();
+
+  static void AddValidators(const nuiHTTPResponse& rCached, nuiHTTPHeaderMap& rHeaders); ///< Add the conditional headers that revalidate the cached response to a request.
+
+private:
+  nglPath GetPath(const nglString& rURL) const;
+
+  nglPath mFolder;
+  mutable nglCriticalSection mCS;
+};
@@ -0,0 +1,126 @@
+#ifndef JSON_DOCUMENT_H_INCLUDED
+# define JSON_DOCUMENT_H_INCLUDED
+
+# include "features.h"
+# include "value.h"
+# include "stream_reader.h"
+# include <string>
+# include <vector>
+
+class nglIStream;
+
+namespace nuiJson {
+
+   /** \brief Immutable <a HREF="http://www.json.org">JSON</a> document stored in a memory arena.
+    *
+    * Unlike Value, the nodes of a Document are not allocated one by one: they are packed in a few
+    * big blocks released all at once with the document. When the source data is directly accessible
+    * (Document::parse(begin, end), or a stream giving access to all its data through
+    * nglIStream::PeekBuffer() like nglIMemory or a mapped nglIFile) strings without escape sequences
+    * are not copied but point into the source data, which must then outlive the document.
+    * Other strings are copied into the arena.
+    *
+    * Strings are not zero terminated: use Node::begin() / Node::end() or Node::asString().
+    */
+   class JSON_API Document
+   {
+   public:
+      class JSON_API Node
+      {
+      public:
+         ValueType type() const;
+
+         bool isNull() const;
+         bool isBool() const;
+         bool isInt() const;
+         bool isUInt() const;
+         bool isIntegral() const;
+         bool isDouble() const;
+         bool isNumeric() const;
+         bool isString() const;
+         bool isArray() const;
+         bool isObject() const;
+
+         /// Number of elements of an array or members of an object, string length in bytes, 0 otherwise.
+         UInt size() const;
+
+         /// Array element, or null node if the index is out of range or this is not an array.
+         const Node &operator[]( UInt index ) const;
+         /// Object member, or null node if not found. Members are searched linearly.
+         const Node &operator[]( const char *key ) const;
+         const Node &operator[]( const std::string &key ) const;
+         const Node *find( const char *begin, const char *end ) const;
+
+         /// Name and value of the index-th member of an object, for iteration.
+         const Node &memberName( UInt index ) const;
+         const Node &memberValue( UInt index ) const;
+
+         const char *begin() const; ///< start of the string value
+         const char *end() const;   ///< end of the string value
+         std::string asString() const;
+         Int asInt() const;
+         UInt asUInt() const;
+         double asDouble() const;
+         bool asBool() const;
+
+      private:
+         friend class Document;
+
+         ValueType type_;
+         UInt size_;
+         union
+         {
+            Int int_;
+            UInt uint_;
+            double real_;
+            bool bool_;
+            const char *string_;
+            const Node *children_; ///< array elements, or name and value pairs of an object
+         } value_;
+      };
+
+      Document( const Features &features = Features::all() );
+      ~Document();
+
+      /// Parse the document in [begin, end). The strings of the document may point into this range.
+      bool parse( const char *begin, const char *end );
+      /// Parse the document contained in the stream, which is not owned.
+      bool parse( nglIStream *stream );
+
+      /// Release all the nodes.
+      void clear();
+
+      const Node &root() const;
+
+      /// Memory allocated for the nodes and decoded strings.
+      size_t getMemoryUsage() const;
+
+      std::string getFormatedErrorMessages() const;
+
+   private:
+      Document( const Document & );
+      Document &operator =( const Document & );
+
+      bool build( StreamReader &reader );
+      void *allocate( size_t size );
+      const char *storeString( const StreamReader &reader, UInt &length );
+
+      struct Block
+      {
+         char *data_;
+         size_t size_;
+      };
+
+      Features features_;
+      Node root_;
+      std::vector<Block> blocks_;
+      char *current_;
+      size_t available_;
+      size_t usage_;
+      std::vector<Node> stack_;  ///< children of the containers being parsed
+      std::string error_;
+   };
+
+} // namespace nuiJson
+
+#endif // JSON_DOCUMENT_H_INCLUDED
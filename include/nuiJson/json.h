@@ -4,6 +4,8 @@
 # include "autolink.h"
 # include "value.h"
 # include "reader.h"
+# include "stream_reader.h"
+# include "document.h"
 # include "writer.h"
 # include "features.h"
 
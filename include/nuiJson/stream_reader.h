@@ -0,0 +1,192 @@
+#ifndef JSON_STREAM_READER_H_INCLUDED
+# define JSON_STREAM_READER_H_INCLUDED
+
+# include "features.h"
+# include "value.h"
+# include <string>
+# include <vector>
+
+class nglIStream;
+
+namespace nuiJson {
+
+   /** \brief Callbacks of StreamReader::parse().
+    *
+    * Strings are passed as [begin, end) ranges of UTF-8 text, which are only valid
+    * during the call. Returning \c false from a callback stops the parsing.
+    */
+   class JSON_API ReaderHandler
+   {
+   public:
+      virtual ~ReaderHandler();
+
+      virtual bool startObject() = 0;
+      virtual bool endObject() = 0;
+      virtual bool startArray() = 0;
+      virtual bool endArray() = 0;
+      virtual bool key( const char *begin, const char *end ) = 0;
+      virtual bool string( const char *begin, const char *end ) = 0;
+      virtual bool intValue( Int value ) = 0;
+      virtual bool uintValue( UInt value ) = 0;
+      virtual bool realValue( double value ) = 0;
+      virtual bool boolValue( bool value ) = 0;
+      virtual bool nullValue() = 0;
+   };
+
+
+   /** \brief Pull parser reading a <a HREF="http://www.json.org">JSON</a> document from an nglIStream.
+    *
+    * The document is read by chunks and never held in memory as a whole. When the stream
+    * gives direct access to its data (nglIStream::PeekBuffer(): memory streams, mapped or
+    * buffered files) no copy is made at all and strings without escape sequences are
+    * returned as ranges of the stream data.
+    *
+    * Each call to next() returns the next event of the document. Several documents may be
+    * concatenated in the stream (one JSON record per line for example): eventEndOfDocument is
+    * only returned at the end of the stream.
+    * \code
+    * nuiJson::StreamReader reader( pStream );
+    * while ( reader.next() == nuiJson::StreamReader::eventKey )
+    * ...
+    * \endcode
+    */
+   class JSON_API StreamReader
+   {
+   public:
+      typedef char Char;
+      typedef const Char *Location;
+
+      enum EventType
+      {
+         eventNone = 0,
+         eventObjectBegin,
+         eventObjectEnd,
+         eventArrayBegin,
+         eventArrayEnd,
+         eventKey,           ///< object member name, see getString()
+         eventString,        ///< see getString()
+         eventNumber,        ///< see getNumberType(), asInt(), asUInt() and asDouble()
+         eventBoolean,       ///< see asBool()
+         eventNull,
+         eventEndOfDocument,
+         eventError          ///< see getFormatedErrorMessages(). All the following calls to next() return eventError.
+      };
+
+      /** \param stream The stream to read, not owned. It should not be accessed while the reader is in use.
+       *  \param bufferSize Size of the chunks read from the stream when it doesn't support direct access.
+       */
+      StreamReader( nglIStream *stream,
+                    const Features &features = Features::all(),
+                    unsigned int bufferSize = 64 * 1024 );
+      ~StreamReader();
+
+      /// Read the next event.
+      EventType next();
+      /// Return the last event read by next().
+      EventType event() const;
+      /// Number of objects and arrays currently open.
+      unsigned int depth() const;
+
+      /** \brief Text of the last key or string event.
+       * The range is only valid until the next call to next().
+       */
+      void getString( Location &begin, Location &end ) const;
+      std::string getString() const;
+
+      /// Type of the last number event: intValue, uintValue or realValue.
+      ValueType getNumberType() const;
+      Int asInt() const;
+      UInt asUInt() const;
+      double asDouble() const;
+      bool asBool() const;
+
+      /** \brief Skip the value whose first event was just read.
+       * If the last event is eventObjectBegin or eventArrayBegin, all the events up to the matching end
+       * are skipped. If the last event is eventKey, the member value is skipped. Does nothing for other
+       * events. Returns \c false on error.
+       */
+      bool skipValue();
+
+      /** \brief Build a Value from the value whose first event was just read.
+       * This is useful to materialize the records of a big document one by one.
+       * Returns \c false on error.
+       */
+      bool readValue( Value &value );
+
+      /** \brief Read the whole stream, calling the handler for each event.
+       * \return \c true if the end of the stream was reached without error.
+       */
+      bool parse( ReaderHandler &handler );
+
+      /** \brief Returns a user friendly string describing the error, if any.
+       * An empty string is returned if no error occurred.
+       */
+      std::string getFormatedErrorMessages() const;
+
+   private:
+      enum State
+      {
+         stateStart,       ///< expecting a root value or the end of the stream
+         stateValue,       ///< expecting a value
+         stateFirstValue,  ///< expecting a value or ']'
+         stateKey,         ///< expecting a member name
+         stateFirstKey,    ///< expecting a member name or '}'
+         stateColon,       ///< expecting ':'
+         stateNext         ///< expecting ',' or the end of the current object or array
+      };
+
+      // Input:
+      bool fill();
+      int peekChar();
+      int getChar();
+      int skipSpaces();
+      bool skipComment();
+      bool match( const char *pattern, int length );
+
+      // Tokens:
+      EventType readValue( int c );
+      bool readString();
+      bool readEscape();
+      bool readNumber();
+      bool decodeNumber( Location begin, Location end );
+      EventType addError( const std::string &message );
+
+      friend class Document;
+
+      nglIStream *stream_;
+      Features features_;
+      std::vector<Char> buffer_;
+      Location window_;        ///< start of the current chunk
+      Location current_;
+      Location end_;
+      int64 windowOffset_;     ///< offset of window_ in the document
+      bool peeked_;            ///< the current chunk belongs to the stream (PeekBuffer)
+      bool inMemory_;          ///< the whole stream is directly accessible, locations stay valid
+      bool endOfStream_;
+
+      State state_;
+      EventType event_;
+      std::vector<Char> containers_;
+      unsigned int documents_;
+
+      Location stringBegin_;
+      Location stringEnd_;
+      bool stringDecoded_;     ///< the string is in decoded_ rather than in the input
+      std::string decoded_;
+
+      ValueType numberType_;
+      Int int_;
+      UInt uint_;
+      double real_;
+      bool bool_;
+
+      int line_;
+      int64 lineStart_;
+      std::string error_;
+      int errorLine_;
+      int errorColumn_;
+   };
+
+} // namespace nuiJson
+
+#endif // JSON_STREAM_READER_H_INCLUDED
@@ -10,6 +10,7 @@
 
 //#include "nui.h"
 #include "nglString.h"
+#include "nuiString8.h"
 #include "nuiFont.h"
 #include "nuiWidget.h"
 #include "nuiTheme.h"
@@ -23,6 +24,7 @@ public:
   nuiLabel(const nglString& Text = nglString::Empty, nuiTheme::FontStyle FontStyle=nuiTheme::Default);
   nuiLabel(const nglString& Text, const nglString& rObjectName, nuiTheme::FontStyle FontStyle=nuiTheme::Default);
   nuiLabel(const nglString& Text, nuiFont* pFont, bool AlreadyAcquired = false);
+  nuiLabel(const nuiString8& Text, nuiTheme::FontStyle FontStyle=nuiTheme::Default); ///< Create a label from UTF-8 text.
   virtual bool Load(const nuiXMLNode* pNode); ///< Create from an XML description.
   virtual ~nuiLabel();
 
@@ -39,6 +41,7 @@ public:
   virtual bool SetRect(const nuiRect& rRect);
 
   virtual void SetText(const nglString& Text); ///< Modify the label's text.
+  void SetUTF8Text(const nuiString8& Text); ///< Modify the label's text from UTF-8 text.
   virtual const nglString& GetText() const; ///< Retrieve the label's text.
 
   void SetThemeTextColor(const nuiColor& Color, bool Selected, bool Enabled); ///< Get the text color for the given widget state.
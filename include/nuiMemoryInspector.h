@@ -0,0 +1,38 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#pragma once
+
+#include "nui.h"
+#include "nuiSimpleContainer.h"
+
+class nuiGrid;
+class nuiLabel;
+class nuiToggleButton;
+
+/// Live view of the memory accounted by nuiMemoryTracker
+class nuiMemoryInspector : public nuiSimpleContainer
+{
+public:
+  nuiMemoryInspector();
+  virtual ~nuiMemoryInspector();
+
+protected:
+  nuiEventSink<nuiMemoryInspector> mSink;
+
+  void Build();
+  void Update(const nuiEvent& rEvent);
+  void OnResetPeaks(const nuiEvent& rEvent);
+  void OnLeakTracking(const nuiEvent& rEvent);
+  void OnPrintReport(const nuiEvent& rEvent);
+
+  nuiGrid* mpGrid;
+  std::vector<nuiLabel*> mpLabels; ///< Bytes, allocations and peak of each tag
+  nuiToggleButton* mpLeakTracking;
+  uint32 mTagCount;
+  nuiTimer* mpTimer;
+};
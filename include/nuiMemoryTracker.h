@@ -0,0 +1,95 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#pragma once
+
+#include "nui.h"
+#include "nglCriticalSection.h"
+
+/// Memory accounting tags of the subsystems of nui. Applications can add their own tags with nuiMemoryTracker::RegisterTag.
+enum nuiMemoryTag
+{
+  eMemoryTextures = 0, ///< Textures uploaded to the GPU
+  eMemorySurfaces,     ///< Off screen render targets
+  eMemoryGlyphCaches,  ///< Glyph pages of the fonts
+  eMemoryRenderCaches, ///< Operations and render arrays recorded by nuiMetaPainter
+  eMemoryXML,          ///< nuiXMLNode trees
+  eMemoryUserTag       ///< First tag returned by nuiMemoryTracker::RegisterTag
+};
+
+#define NUI_MEMORY_MAX_TAGS 32
+
+#define NUI_MEMORY_SITE2(FILE, LINE) FILE ":" #LINE
+#define NUI_MEMORY_SITE1(FILE, LINE) NUI_MEMORY_SITE2(FILE, LINE)
+#define NUI_MEMORY_SITE NUI_MEMORY_SITE1(__FILE__, __LINE__) ///< Allocation site recorded in the leak report.
+
+#define NUI_MEMORY_ADD(TAG, POINTER, BYTES) nuiMemoryTracker::Add(TAG, POINTER, BYTES, NUI_MEMORY_SITE) ///< Account an allocation made at this line.
+#define NUI_MEMORY_RESIZE(TAG, POINTER, OLDBYTES, NEWBYTES) nuiMemoryTracker::Resize(TAG, POINTER, OLDBYTES, NEWBYTES)
+#define NUI_MEMORY_REMOVE(TAG, POINTER, BYTES) nuiMemoryTracker::Remove(TAG, POINTER, BYTES)
+
+/// Tagged memory accounting
+/*!
+The subsystems that own large buffers report what they allocate and release under a tag (see nuiMemoryTag) so that the
+memory used by the textures, glyph caches, render caches, surfaces and XML trees can be inspected live, with the high
+water mark of each tag (see nuiMemoryInspector).
+
+Each thread accumulates its changes in its own counters and only merges them with the totals under a lock once they
+reach 64KB or 256 allocations, so the peaks are exact to within that much per thread.
+
+Individual allocations are only recorded when the leak tracking is enabled. The leak report lists the allocations that
+are still alive grouped by tag and allocation site. Setting the NUI_MEMORY_REPORT environment variable to a file path
+(or to "-" for the console) enables the leak tracking when the application starts and writes the report when it exits.
+*/
+class nuiMemoryTracker
+{
+public:
+  class Stats
+  {
+  public:
+    int64 mBytes; ///< Bytes currently accounted
+    int64 mCount; ///< Number of allocations currently accounted
+    int64 mPeakBytes; ///< Highest mBytes since the start or the last ResetPeaks()
+  };
+
+  static uint32 RegisterTag(const char* pName); ///< Add a tag and return it. pName must outlive the tracker. Returns NUI_MEMORY_MAX_TAGS, which is ignored, once all the tags are used.
+  static uint32 GetTagCount();
+  static const char* GetTagName(uint32 Tag);
+
+  static void Add(uint32 Tag, const void* pPointer, int64 Bytes, const char* pSite = NULL); ///< Account an allocation. pPointer identifies it in the leak report and pSite must be a literal (see NUI_MEMORY_ADD).
+  static void Resize(uint32 Tag, const void* pPointer, int64 OldBytes, int64 NewBytes); ///< Change the size of an accounted allocation.
+  static void Remove(uint32 Tag, const void* pPointer, int64 Bytes); ///< Account the release of an allocation.
+
+  static void GetStats(uint32 Tag, Stats& rStats);
+  static void ResetPeaks(); ///< Restart the high water marks from the current values.
+
+  static void EnableLeakTracking(bool Set); ///< Record the allocations that are added from now on.
+  static bool IsLeakTrackingEnabled();
+  static nglString GetLeakReport(); ///< Totals of every tag followed by the allocations that are still alive, grouped by tag and site.
+
+  static void Init(); ///< Called when the kernel starts, see NUI_MEMORY_REPORT.
+  static void Exit(); ///< Called when the kernel exits.
+
+private:
+  class Thread;
+  static Thread* GetThread();
+  static void Account(uint32 Tag, int64 Bytes, int32 Count);
+
+  class Allocation
+  {
+  public:
+    int64 mBytes;
+    const char* mpSite;
+  };
+
+  static nglCriticalSection mCS; ///< Guards everything but the pending counters of the threads
+  static std::vector<Thread*> mpThreads; ///< Never deleted: the pending counts of the threads that exited still count
+  static const char* mpTagNames[NUI_MEMORY_MAX_TAGS];
+  static uint32 mTagCount;
+  static Stats mStats[NUI_MEMORY_MAX_TAGS]; ///< Flushed totals
+  static volatile bool mLeakTracking;
+  static std::map<std::pair<uint32, const void*>, Allocation> mAllocations;
+};
@@ -152,6 +152,10 @@ protected:
   
   std::vector<nuiRenderState> mRenderStates;
   std::vector<nuiRenderArray*> mRenderArrays;
+
+  int64 mArrayBytes; ///< Vertices of the render arrays when they were recorded
+  int64 mMemoryBytes; ///< Memory accounted in eMemoryRenderCaches
+  void UpdateMemoryStats();
 };
 
 #endif // __nuiMetaPainter_h__
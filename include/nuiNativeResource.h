@@ -39,6 +39,7 @@ public:
 
   int64 Read (void* pData, int64 WordCount, uint WordSize);
   int64 Peek (void* pData, int64 WordCount, uint WordSize);
+  int64 PeekBuffer (const void*& rpData);
 
   
   
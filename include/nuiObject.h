@@ -96,6 +96,7 @@ public:
   nuiAttribBase GetAttribute(const nglString& rName) const;
   void AddInstanceAttribute(const nglString& rName, nuiAttributeBase* pProperty); ///< Add an attribute to this object (beware, only this instance of this class will have this attribute. If you wnat the attribute to be global to all instances of the class use AddAttribute instead).
   void AddInstanceAttribute(nuiAttributeBase* pAttribute); ///< Add an attribute to this object (beware, only this instance of this class will have this attribute. If you wnat the attribute to be global to all instances of the class use AddAttribute instead).
+  bool HasInstanceAttributes() const; ///< Return true if attributes were added to this instance with AddInstanceAttribute.
   //@}
   
   ///! Global Properties:
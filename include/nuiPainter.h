@@ -138,6 +138,9 @@ public:
   uint32 GetRenderOperations() const;
   uint32 GetVertices() const;
   uint32 GetBatches() const;
+  uint32 GetDrawCalls() const; ///< Draw commands sent to the GPU, several batches can be merged in one draw call
+  uint32 GetUploads() const; ///< Vertex data transfers to the GPU
+  uint32 GetUploadedBytes() const;
 
   // Display rotation
   void SetAngle(int32 Angle);
@@ -171,6 +174,9 @@ protected:
   uint32 mRenderOperations;
   uint32 mVertices;
   uint32 mBatches;
+  uint32 mDrawCalls;
+  uint32 mUploads;
+  uint32 mUploadedBytes;
 
   bool mDummyMode;
 
@@ -1,14 +1,25 @@
 /*
  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
  Copyright (C) 2002-2003 Sebastien Metrot & Vincent Caron
- 
+
  licence: see nui3/LICENCE.TXT
 */
 
+#pragma once
+
+#define NUI_PARSER_BUFFER_SIZE (64 * 1024)
+
+/// Simple UTF-8 text tokenizer
+/*!
+The source stream is read through an internal chunk buffer: once parsing has started the stream position is
+ahead of the parser's and the stream should not be read directly anymore. ASCII symbols, values, numbers and blanks
+are scanned straight from this buffer, other characters are decoded one by one.
+*/
 class nuiParser
 {
 public:
   nuiParser(nglIStream* pStream, const nglPath& rSourcePath);
+  virtual ~nuiParser();
 
   bool IsDone() const; ///< Returns true if all the source data has been consumed
   bool PeekChar(); ///< Read the next char but don't advance the read index.
@@ -31,15 +42,15 @@ public:
   bool GetInteger(int16&  rResult, uint8 Base = 10); ///< Read an integer. Returns false if there is a problem.
   bool GetInteger(int32&  rResult, uint8 Base = 10); ///< Read an integer. Returns false if there is a problem.
   bool GetInteger(int64&  rResult, uint8 Base = 10); ///< Read an integer. Returns false if there is a problem.
-  
+
   bool Expect(const nglString& rString, bool CaseSensitive = true);
   bool Expect(nglChar ch, bool CaseSensitive = true);
-  
+
   void SetError(const nglString& rError); ///< Change the error message.
   int32 GetLine() const; ///< Return the current line number
-  int32 GetColumn() const; ///< Return the current column.
+  int32 GetColumn() const; ///< Return the current column (in bytes from the start of the line, 1 based).
   const nglString& GetErrorStr() const; ///< Return the error string stored in the parser.
-  
+
   void SetValidInSymbolStart(const nglString& rValidChars); ///< Set the characters that are valid as the first character of a symbol (usualy all latin letters + underscore).
   void SetValidInSymbol(const nglString& rValidChars); ///< Set the characters that are valid in a symbol (usualy all latin characters + underscore + latin numbers).
   void SetValidInValue(const nglString& rValidChars); ///< Set the characters that are valid in a value.
@@ -53,17 +64,74 @@ public:
   bool GetNumberDigit(uint8& res, nglChar c, uint32 Base) const; ///< Returns true if the given char is a valid number digit for the given base. In this case res contains the converted digit as a number.
 
 protected:
+  enum CharClass
+  {
+    eSymbolStart = 1 << 0,
+    eSymbol = 1 << 1,
+    eValue = 1 << 2,
+    eBlank = 1 << 3
+  };
+
+  bool Fill(uint32 Needed); ///< Make sure at least \a Needed bytes are available in the buffer unless the end of the stream is reached. Returns false if no byte at all is available.
+  bool NextMultiByteChar(); ///< Slow path of NextChar() for non ASCII chars
+  void CountLine(uint8 c); ///< Update the line tracking for a consumed \\r or \\n
+  bool ScanASCII(uint8 Class, std::vector<nglChar>* pAccumulator); ///< Consume the following bytes as long as they are ASCII chars of the given class(es), appending them to \a pAccumulator if not NULL, then load the next char with NextChar()
+  void SetClass(const nglString& rChars, uint8 Class, std::set<nglChar>& rNonASCII);
+  bool HasClass(nglChar c, uint8 Class, const std::set<nglChar>& rNonASCII) const;
+
+  struct State
+  {
+    uint32 mBufferPos;
+    int32 mLine;
+    int64 mLineStart;
+    bool mLastCR;
+  };
+  void SaveState(State& rState) const;
+  void RestoreState(const State& rState);
+
   nglIStream* mpStream;
   nglPath mSourcePath;
   nglChar mChar;
-  int32 mColumn;
   int32 mLine;
+  int64 mLineStart; ///< Offset of the start of the current line, the column is computed on demand from it
+  bool mLastCR; ///< The last consumed byte was a \\r, a following \\n doesn't start a new line
   bool mEnableCppComments;
   bool mError;
   nglString mErrorString;
+
+  std::vector<uint8> mBuffer;
+  uint32 mBufferPos;
+  uint32 mBufferSize;
+  int64 mBufferOffset; ///< Offset of mBuffer[0] from the start of the parsed data
+  bool mEndOfStream;
+  std::vector<nglChar> mAccumulator;
+
+  uint8 mASCIIClasses[128];
   std::set<nglChar> mValidInSymbolStart;
   std::set<nglChar> mValidInSymbol;
   std::set<nglChar> mValidInValue;
   std::set<nglChar> mLineCommentStarters;
   std::set<nglChar> mBlanks;
 };
+
+inline bool nuiParser::NextChar()
+{
+  if (mBufferPos >= mBufferSize && !Fill(1))
+  {
+    mChar = 0;
+    return false;
+  }
+
+  uint8 c = mBuffer[mBufferPos];
+  if (c & 0x80)
+    return NextMultiByteChar();
+
+  mBufferPos++;
+  mChar = c;
+  if (c == 0xa || c == 0xd)
+    CountLine(c);
+  else
+    mLastCR = false;
+  return true;
+}
+
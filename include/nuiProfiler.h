@@ -0,0 +1,116 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#pragma once
+
+#include "nui.h"
+#include "nglAtomic.h"
+#include "nglCriticalSection.h"
+
+// The profiling zones are compiled in unless _NUI_NO_PROFILER_ is defined, in which case the macros expand to nothing.
+#ifndef _NUI_NO_PROFILER_
+#define _NUI_PROFILER_
+#endif
+
+/// Frame profiler
+/*!
+The profiler records timed zones (see NUI_PROFILE_ZONE) and frame markers (see NUI_PROFILE_FRAME) while it is started.
+Each thread writes its events to its own ring buffer without locking, so a zone costs two reads of the clock and one
+write to memory, and the last events of each thread stay available when something goes wrong: start the profiler, wait
+for a stutter and export the trace. When the profiler is stopped a zone only tests a flag.
+
+The zone names must be string literals (or at least outlive the profiler) as only their address is recorded.
+
+Export() writes the Chrome trace event format, which can be loaded in chrome://tracing or in Perfetto.
+
+Setting the NUI_PROFILER_TRACE environment variable to a file path starts the profiler when the application starts and
+exports the trace to that file when it exits.
+*/
+class nuiProfiler
+{
+public:
+  typedef uint64 Ticks;
+
+  class Event
+  {
+  public:
+    const char* mpName; ///< NULL for a frame marker
+    Ticks mBegin;
+    Ticks mEnd;
+  };
+
+  static void Start(); ///< Start recording. The events that are still in the ring buffers are kept.
+  static void Stop();
+  static bool IsStarted()
+  {
+    return mStarted;
+  }
+  static void Clear(); ///< Drop the recorded events.
+
+  static void SetBufferSize(uint32 Events); ///< Size of the ring buffer of the threads that record their first event after the call (65536 events by default, rounded up to a power of two).
+  static uint32 GetBufferSize();
+
+  static void SetThreadName(const nglString& rName); ///< Name of the calling thread in the exported trace. nglThreads use their name by default.
+
+  static Ticks GetTicks(); ///< Current time in ticks of a monotonic clock.
+  static double GetTicksPerSecond();
+
+  static void AddZone(const char* pName, Ticks Begin, Ticks End); ///< Record a zone of the calling thread.
+  static void Frame(); ///< Record the start of a frame.
+  static uint32 GetFrameCount(); ///< Number of frame markers recorded since the start.
+
+  static bool Export(nglOStream& rStream); ///< Write the recorded events in the Chrome trace event format.
+  static bool Export(const nglPath& rPath);
+
+  static void Init(); ///< Called when the kernel starts, see NUI_PROFILER_TRACE.
+  static void Exit(); ///< Called when the kernel exits.
+  static void ExitThread(void* pThread); ///< Called when a thread that recorded events exits, its buffer is given to the next new thread. Not called on Windows, where the buffers are kept.
+
+private:
+  class Thread;
+  static Thread* GetThread();
+
+  static volatile bool mStarted;
+  static nglAtomic32 mFrames;
+  static nglCriticalSection mCS; ///< Guards mpThreads and the thread names
+  static std::vector<Thread*> mpThreads; ///< Never deleted: the events of a thread that exited can be exported until a new thread takes its buffer
+  static uint32 mThreadCount; ///< Threads that recorded events, gives their index in the trace
+  static uint32 mBufferSize;
+  static nglThread::ID mMainThreadID;
+};
+
+/// Record the time spent in a scope, see NUI_PROFILE_ZONE
+class nuiProfilerZone
+{
+public:
+  nuiProfilerZone(const char* pName)
+  : mpName(nuiProfiler::IsStarted() ? pName : NULL)
+  {
+    if (mpName)
+      mBegin = nuiProfiler::GetTicks();
+  }
+
+  ~nuiProfilerZone()
+  {
+    if (mpName)
+      nuiProfiler::AddZone(mpName, mBegin, nuiProfiler::GetTicks());
+  }
+
+private:
+  const char* mpName;
+  nuiProfiler::Ticks mBegin;
+};
+
+#ifdef _NUI_PROFILER_
+#define NUI_PROFILE_ZONE_NAME2(LINE) nuiProfilerZone##LINE
+#define NUI_PROFILE_ZONE_NAME(LINE) NUI_PROFILE_ZONE_NAME2(LINE)
+#define NUI_PROFILE_ZONE(NAME) nuiProfilerZone NUI_PROFILE_ZONE_NAME(__LINE__)(NAME) ///< Record the time spent from this point to the end of the scope.
+#define NUI_PROFILE_FRAME() nuiProfiler::Frame() ///< Mark the start of a frame.
+#else
+#define NUI_PROFILE_ZONE(NAME)
+#define NUI_PROFILE_FRAME()
+#endif
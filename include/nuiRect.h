@@ -216,7 +216,8 @@ public:
 
   }
 
-  void Transform(const nuiMatrix& rMatrix);
+  void Transform(const nuiMatrix& rMatrix); ///< Transform the top left and the bottom right corners (the result is not the bounding box of a rotated rectangle).
+  static void Transform(const nuiMatrix& rMatrix, const nuiRect* pIn, nuiRect* pOut, size_t Count); ///< Transform Count rectangles like Transform(). pIn and pOut can be the same array.
   bool Intersect(const nuiRect& rRect1, const nuiRect& rRect2);
   void Union (const nuiRect& rRect1, const nuiRect& rRect2);
   void Union (float X, float Y);
@@ -5,14 +5,35 @@
 class nglString;
 class regexp;
 
-class nuiRegExp
+/// Regular expression matcher
+/*!
+Supported syntax: ^ $ . [...] [^...] ( ) | * + ? \< \> (word boundaries), \1 to \9 (back references) and \ to quote
+the other characters.
+
+Patterns are parsed by Henry Spencer's compiler and can be run by two engines:
+ - a linear time engine that simulates the NFA of the compiled program, with a lazily built DFA to find out if there
+   is a match and a Pike VM to extract the sub expressions. Its cost is proportional to the length of the text times
+   the size of the pattern, whatever the pattern. Sub expressions are only computed when one of them is accessed.
+ - the original backtracking matcher, which can be exponential on some patterns but is the only one that handles back
+   references.
+Both engines give the same results: the leftmost match, alternatives and repetitions being tried in the order of the
+backtracking matcher (first alternative first, greedy repetitions).
+*/
+class NUI_API nuiRegExp
 {
 public:
   enum { NSUBEXP = 10 };
 
+  enum Engine
+  {
+    eAutomaticEngine = 0, ///< Linear time engine, backtracking only for the patterns that use back references (default).
+    eLinearEngine,        ///< Linear time engine only: patterns that use back references never match.
+    eBacktrackingEngine   ///< Backtracking engine only.
+  };
+
   nuiRegExp();
-  nuiRegExp(const nglChar* exp, bool iCase = false);
-  nuiRegExp(const nglString& exp, bool iCase = false);
+  nuiRegExp(const nglChar* exp, bool iCase = false, Engine engine = eAutomaticEngine);
+  nuiRegExp(const nglString& exp, bool iCase = false, Engine engine = eAutomaticEngine);
   nuiRegExp(const nuiRegExp &r );
   ~nuiRegExp();
   const nuiRegExp & operator=(const nuiRegExp& r);
@@ -20,7 +41,7 @@ public:
   bool Match(const nglChar* s);
   bool Match(const nglString& rString);
   int SubStrings() const;
-  
+
   const nglString operator[](uint32 i) const;
   int SubStart(uint32 i) const;
   int SubLength(uint32 i) const;
@@ -30,6 +51,12 @@ public:
   nglString GetErrorString() const;
   bool CompiledOK() const;
 
+  void SetEngine(Engine engine);
+  Engine GetEngine() const;
+  bool UsesBackReferences() const; ///< True if the pattern can only be run by the backtracking engine.
+  void SetCacheSize(uint32 MaxStates); ///< Maximum number of DFA states kept by the linear engine (default 2048). The cache is flushed when it is full.
+  uint32 GetCacheSize() const;
+
 #if defined( _RE_DEBUG )
   void Dump();
 #endif
@@ -38,6 +65,8 @@ private:
   nglString mString; /* used to return substring offsets only */
   mutable nglString m_szError;
   regexp * rc;
+  Engine mEngine;
+  uint32 mCacheSize;
 
   void ClearErrorString() const;
   int safeIndex( uint32 i ) const;
@@ -104,6 +104,9 @@ public:
   
   bool IsShape() const;
   void SetShape(bool set);
+
+  bool IsStatic() const; ///< Static arrays don't change once they are drawn, so the painters can keep them in GPU memory.
+  void SetStatic(bool set);
   
   uint32 GetSize() const;
   void Reserve(uint Count);
@@ -114,6 +117,9 @@ public:
   uint32 GetTotalSize() const;
   void FillBuffer(GLubyte* pBuffer) const;
 
+  void Transform(const nuiMatrix& rMatrix); ///< Apply rMatrix to the position of every vertex.
+  static void TransformVertices(const nuiMatrix& rMatrix, const Vertex* pIn, Vertex* pOut, size_t Count); ///< Copy Count vertices and apply rMatrix to their positions. pIn and pOut can be the same array.
+
   void SetVertex(float x, float y, float z = 0.0f);
   void SetVertex(const nuiVector& rVf);
   void SetVertex(const nuiVector3& rV3f);
@@ -145,6 +151,7 @@ public:
   void SetIndex(uint32 ArrayIndex, uint32 IndexInArray, uint32 VertexIndex);
 
   void GetBounds(float* bounds) const; ///< bounds must contain at least 6 floats to store the minums and maximums coordinates of this array
+  void SetBounds(const float* bounds); ///< Set the bounds of vertices that were written directly with GetVertices(), in the GetBounds() order
   
   nglString Dump() const;
 private:
@@ -32,7 +32,7 @@ public:
   bool Delete(uint32 Pos, uint32 NbSamples);  ///< Method that deletes a user-defined number of samples at a user-defined position \param Pos Position where delete samples \param NbSamples Number of samples to delete \retun True i succeeded
 
   nuiSample* Clone() const;  ///< Method that copies the nuiSample into another \return A Pointer to the copy of the nuiSample object
-  nuiSample* Clone(double SampleRate) const; ///< Method that copies the nuiSample into another whose nuiSample rate is user-defined \param SampleRate Value of the nuiSample Rate for the sample object copy \return A pointer to the copy of the nuiSample object
+  nuiSample* Clone(double SampleRate, nuiAudioSincResampler::Quality quality = nuiAudioSincResampler::eSincMedium) const; ///< Method that copies the nuiSample into another whose nuiSample rate is user-defined, with a nuiAudioSincResampler \param SampleRate Value of the nuiSample Rate for the sample object copy \param quality Quality of the resampling filter \return A pointer to the copy of the nuiSample object
   
   bool InterpolateChannel(nuiInterpolationMethod method, double& rPosition, uint8 Channel, double increment, float* pDest, uint64 DestSize, double multVolume = 1.0) const;
   bool InterpolateChannelAdd(nuiInterpolationMethod method, double& rPosition, uint8 Channel, double increment, float* pDest, uint64 DestSize, double multVolume = 1.0) const;
@@ -10,6 +10,7 @@
 #include "nui.h"
 
 class nuiNetworkHost;
+class nuiSocketPool;
 
 class nuiSocket
 {
@@ -20,7 +21,9 @@ public:
   typedef int SocketType;
 #endif
 
-  virtual ~nuiSocket();
+  typedef nuiFastDelegate1<nuiSocket&> EventDelegate;
+
+  virtual ~nuiSocket(); ///< The socket is removed from its nuiSocketPool, if any.
   
   SocketType GetSocket() const;
   
@@ -28,14 +31,43 @@ public:
   bool GetDistantHost(nuiNetworkHost& rHost) const;
 
   bool IsValid() const;
-  
+
+  bool SetNonBlocking(bool set); ///< In non blocking mode the calls that would block fail immediately (see nuiSocketPool).
+  bool IsNonBlocking() const;
+
+  /** @name Socket pool events */
+  //@{
+  void SetCanReadDelegate(const EventDelegate& rDelegate); ///< Called when data or a connection request is available.
+  void SetCanWriteDelegate(const EventDelegate& rDelegate); ///< Called when data can be sent again.
+  void SetReadClosedDelegate(const EventDelegate& rDelegate); ///< Called when the remote side stopped sending, or on error.
+  void SetWriteClosedDelegate(const EventDelegate& rDelegate); ///< Called when nothing can be sent anymore.
+
+  virtual void OnCanRead(); ///< Called by the nuiSocketPool, calls the delegate.
+  virtual void OnCanWrite();
+  virtual void OnReadClosed();
+  virtual void OnWriteClosed();
+  //@}
+
 protected:
+  friend class nuiSocketPool;
+
   nuiSocket(SocketType Socket = -1);
   bool Init(int domain, int type, int protocol);
   
   struct addrinfo* GetAddrInfo(const nuiNetworkHost& rHost) const;
   void DumpError(int err) const;
+  static bool WouldBlock(); ///< True if the last socket call failed because the socket is non blocking.
+  static bool Interrupted(); ///< True if the last socket call was interrupted by a signal and should be retried.
+  bool CallDelegate(const EventDelegate& rDelegate); ///< Return false if the socket was deleted by the delegate.
   
   SocketType mSocket;
+  bool mNonBlocking;
+  nuiSocketPool* mpPool;
+  bool* mpDeleted; ///< Set to true by the destructor, to detect the sockets deleted by their delegates
+
+  EventDelegate mReadDelegate;
+  EventDelegate mWriteDelegate;
+  EventDelegate mReadCloseDelegate;
+  EventDelegate mWriteCloseDelegate;
 };
 
@@ -0,0 +1,90 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#pragma once
+
+#include "nui.h"
+#include "nuiSocket.h"
+
+#if defined(_LINUX_)
+#define NUI_SOCKETPOOL_EPOLL
+#include <sys/epoll.h>
+#elif defined(_MACOSX_) || defined(_FREEBSD_)
+#define NUI_SOCKETPOOL_KQUEUE
+#include <sys/types.h>
+#include <sys/event.h>
+#endif
+
+/// Event loop for non blocking sockets
+/*!
+A nuiSocketPool waits for the readiness of many sockets at once (with epoll on Linux and kqueue on Mac OS X and iOS)
+and calls their event methods, so that a single thread can serve thousands of connections:
+ - OnCanRead() when data (or, for a nuiTCPServer, a connection request) is available. A nuiTCPClient reads all the
+   available data into its receive buffer before calling its CanRead delegate. A nuiTCPServer calls its CanRead delegate,
+   which should Accept() until it returns NULL.
+ - OnCanWrite() when the socket can send data again. A nuiTCPClient sends its pending buffered data (see
+   nuiTCPClient::BufferedSend()) before calling its CanWrite delegate.
+ - OnReadClosed() when the remote side is done sending, and OnWriteClosed() when the connection is broken.
+
+The sockets added to a pool are made non blocking. The events are dispatched by DispatchEvents(), which can either be
+pumped from the application loop or run in the pool's own thread with Start(). The delegates are called from the
+dispatching thread, and they may delete their socket or add and remove other ones. Sockets must not be deleted from
+another thread while the pool is dispatching events.
+
+The pool doesn't own the sockets: deleting a socket removes it from its pool, and deleting the pool detaches all its
+sockets.
+
+The pool is not available on Windows yet: Add() always fails there.
+*/
+class nuiSocketPool
+{
+public:
+  enum TriggerMode
+  {
+    eContinuous, ///< Level triggered: the events are dispatched as long as the socket is readable or writable.
+    eStateChange ///< Edge triggered: the events are dispatched once each time the socket becomes readable or writable (default).
+  };
+
+  nuiSocketPool();
+  virtual ~nuiSocketPool();
+
+  bool Add(nuiSocket* pSocket, TriggerMode Mode = eStateChange); ///< Start watching the socket. A socket can only belong to one pool.
+  bool Del(nuiSocket* pSocket); ///< Stop watching the socket.
+  uint32 GetSocketCount() const;
+
+  int32 DispatchEvents(int32 TimeOutMilliSec); ///< Wait for events for at most TimeOutMilliSec (-1 waits until an event or Wake(), 0 doesn't wait) and dispatch them. Return the number of events or -1 on error.
+  void Wake(); ///< Make the current or next call to DispatchEvents() return immediately. Can be called from any thread.
+
+  bool Start(); ///< Dispatch the events in a thread owned by the pool.
+  void Stop(); ///< Stop the thread started by Start() and wait for it to finish.
+  bool IsRunning() const;
+
+private:
+  void Run();
+  void Dispatch(nuiSocket* pSocket, bool CanRead, bool CanWrite, bool WriteClosed);
+  void InvalidatePendingEvents(nuiSocket* pSocket);
+
+  enum { MaxEvents = 256 };
+
+#if defined(NUI_SOCKETPOOL_EPOLL)
+  int mEPoll;
+  struct epoll_event mEvents[MaxEvents];
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+  int mQueue;
+  struct kevent mEvents[MaxEvents];
+#endif
+  int mWakePipe[2]; ///< Watched by the pool with the pool itself as user data
+  int32 mEventCount; ///< Number of events in mEvents being dispatched
+  int32 mCurrentEvent;
+
+  std::set<nuiSocket*> mSockets;
+  mutable nglCriticalSection mCS;
+
+  nglThread* mpThread;
+  volatile bool mStop;
+};
+
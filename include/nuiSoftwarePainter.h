@@ -53,6 +53,9 @@ protected:
   void DrawLine(const nuiRenderArray* pArray, int p1, int p2);
   void DrawTriangle(const nuiRenderArray* pArray, int p1, int p2, int p3);
   void DrawRectangle(const nuiRenderArray* pArray, int p1, int p2, int p3, int p4);
+
+  std::vector<nuiRenderArray::Vertex> mTransformedVertices;
+  const nuiRenderArray::Vertex* mpVertices; ///< Positions of the vertices of the array being drawn, in window coordinates
 };
 
 #endif //__nuiSoftwarePainter_h__
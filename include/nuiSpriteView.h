@@ -85,6 +85,7 @@ protected:
 class nuiSprite : public nuiObject
 {
   friend class nuiSpriteDef;
+  friend class nuiSpriteBatch;
   
 public:
   nuiSprite(const nglString& rSpriteDefName);
@@ -194,6 +195,87 @@ private:
 };
 
 
+/// Structure of arrays renderer for sprite trees
+/*!
+Gather() flattens the sprite trees in draw order (each sprite before its children) and copies their state in parallel
+arrays. Animate() and the transformations then run in tight loops on these arrays, and Draw() emits a single GL_TRIANGLES
+render array per run of consecutive sprites that share their texture atlas page and blend function, instead of one
+DrawImage per sprite. This works with any painter that supports nuiRenderArray (nuiGLPainter, nuiSoftwarePainter...).
+
+ - The sprites are drawn in the same order as with nuiSprite::Draw(). Sprites interleaved from different pages break the
+   runs, so put the sprites that share a page next to each other to get the fewest render arrays.
+ - Sprites that use other matrix nodes than their position, pivot and scale nodes are transformed with their full matrix,
+   flattened to the XY plane.
+ - The arrays only grow: once the biggest sprite count has been seen, drawing doesn't allocate more than one render array
+   per run.
+*/
+class nuiSpriteBatch
+{
+public:
+  nuiSpriteBatch();
+  virtual ~nuiSpriteBatch();
+
+  void Gather(const std::vector<nuiSprite*>& rSprites); ///< Copy the state of the sprite trees in the batch.
+  void Animate(float passedtime); ///< Advance the animations of the gathered sprites and write their frame times back.
+  void FireAnimEnd(); ///< Send the AnimEnd events of the sprites whose animation looped during the last Animate().
+  void Draw(nuiDrawContext* pContext); ///< Draw the gathered sprites.
+
+  uint32 GetSpriteCount() const;
+  uint32 GetBatchCount() const; ///< Number of render arrays sent by the last Draw().
+
+protected:
+  struct Run
+  {
+    nuiTexture* mpTexture; ///< Atlas page (the texture behind the proxies)
+    nuiBlendFunc mBlendFunc;
+    uint32 mCount;
+    uint32 mOffset; ///< First sprite of the run in mOrder
+  };
+
+  void Resize(uint32 count);
+  void Gather(nuiSprite* pSprite);
+  void UpdateTransforms();
+
+  uint32 mCount;
+  std::vector<nuiSprite*> mpSprites;
+  std::vector<nuiSprite*> mpStack;
+
+  // Animation:
+  std::vector<const nuiSpriteAnimation*> mpAnimations;
+  std::vector<const nuiSpriteFrame*> mpFrames;
+  std::vector<float> mFrame;
+  std::vector<float> mFrameCount;
+  std::vector<float> mFrameSpeed; ///< Sprite speed * animation FPS
+  std::vector<uint32> mEnded;
+
+  // Transformation, either from the sprite's position, pivot and scale or from its full matrix (mMatrix):
+  std::vector<uint8> mMatrix;
+  std::vector<float> mX;
+  std::vector<float> mY;
+  std::vector<float> mZ;
+  std::vector<float> mAngle;
+  std::vector<float> mPivotX;
+  std::vector<float> mPivotY;
+  std::vector<float> mScaleX;
+  std::vector<float> mScaleY;
+
+  // Resulting affine transformation: x' = mXX * x + mXY * y + mTX, y' = mYX * x + mYY * y + mTY
+  std::vector<float> mXX;
+  std::vector<float> mXY;
+  std::vector<float> mYX;
+  std::vector<float> mYY;
+  std::vector<float> mTX;
+  std::vector<float> mTY;
+
+  std::vector<uint32> mColor; ///< R, G, B, A bytes in nuiRenderArray::Vertex order
+  std::vector<nuiBlendFunc> mBlendFunc;
+
+  // Runs of sprites drawn with one render array:
+  std::vector<Run> mRuns;
+  std::vector<uint32> mOrder; ///< Sprites that have a texture, in draw order
+  uint32 mBatches;
+};
+
 class nuiSpriteView : public nuiSimpleContainer
 {
 public:
@@ -214,10 +296,16 @@ public:
   bool MouseClicked(const nglMouseInfo& rEvent);
   bool MouseUnclicked(const nglMouseInfo& rEvent);
   bool MouseMoved(const nglMouseInfo& rEvent);
+
+  void EnableBatching(bool Set); ///< Draw the sprites with a nuiSpriteBatch (default) instead of calling nuiSprite::Draw() on each of them.
+  bool IsBatchingEnabled() const;
+  const nuiSpriteBatch& GetBatch() const;
   
 protected:
   std::vector<nuiSprite*> mpSprites;
   double mLastTime;
+  bool mBatching;
+  nuiSpriteBatch mBatch;
 };
 
 
@@ -0,0 +1,85 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nglString.h"
+
+/// UTF-8 string
+/*!
+nuiString8 stores its text as zero terminated UTF-8 bytes, which is the encoding of most of the files, network
+protocols and libraries we deal with. Strings of up to InlineCapacity bytes are stored in the object itself and don't
+touch the heap. A nglString uses 4 bytes per character on most platforms, so a nuiString8 is also the cheapest way to
+keep large amounts of mostly ASCII text around.
+
+Lengths and indices are counted in bytes. The conversions to and from nglString are done in a single pass by the
+EncodeUTF8() and DecodeUTF8() functions, without going through nglStringConv.
+*/
+class NUI_API nuiString8
+{
+public:
+  enum { InlineCapacity = 15 }; ///< Number of bytes that fit in the object itself (not counting the terminating zero).
+
+  nuiString8();
+  nuiString8(const char* pUTF8); ///< pUTF8 must be UTF-8 encoded. NULL gives an empty string.
+  nuiString8(const char* pUTF8, uint32 Length);
+  explicit nuiString8(const nglString& rString);
+  explicit nuiString8(const nglChar* pString);
+  nuiString8(const nuiString8& rString);
+  ~nuiString8();
+
+  nuiString8& operator=(const nuiString8& rString);
+  nuiString8& operator=(const char* pUTF8);
+  nuiString8& operator=(const nglString& rString);
+
+  const char* GetChars() const; ///< Zero terminated UTF-8 text.
+  uint32 GetLength() const; ///< Length in bytes.
+  bool IsEmpty() const;
+  char operator[](uint32 Index) const;
+
+  void Clear(); ///< Empty the string, keeping its buffer.
+  void Reserve(uint32 Capacity);
+  uint32 GetCapacity() const;
+
+  nuiString8& Append(const char* pUTF8, uint32 Length);
+  nuiString8& Append(const char* pUTF8);
+  nuiString8& Append(const nuiString8& rString);
+  nuiString8& Append(char c);
+  nuiString8& Append(const nglString& rString);
+  nuiString8& operator+=(const nuiString8& rString);
+  nuiString8& operator+=(const char* pUTF8);
+  nuiString8& operator+=(char c);
+
+  nglString ToString() const; ///< Convert to a nglString.
+  bool ToString(nglString& rString) const; ///< Convert to a nglString, return false if the text was not valid UTF-8 (the invalid bytes are replaced by U+FFFD).
+
+  int32 Compare(const nuiString8& rString) const; ///< Byte wise comparison, which is also the code point order.
+  int32 Compare(const char* pUTF8) const;
+  bool operator==(const nuiString8& rString) const;
+  bool operator==(const char* pUTF8) const;
+  bool operator!=(const nuiString8& rString) const;
+  bool operator!=(const char* pUTF8) const;
+  bool operator<(const nuiString8& rString) const;
+
+  uint32 GetHash() const;
+
+  /** @name UTF-8 codec */
+  //@{
+  static uint32 GetUTF8Length(const nglChar* pString, uint32 Length); ///< Number of bytes needed to encode the given characters.
+  static char* EncodeUTF8(const nglChar* pString, uint32 Length, char* pTarget); ///< pTarget must have room for GetUTF8Length() bytes. Unpaired surrogates are encoded as U+FFFD. Return the end of the written bytes.
+  static bool DecodeUTF8(const char* pUTF8, uint32 Length, std::wstring& rString); ///< Replace the contents of rString. Return false if the text is not valid UTF-8, the invalid bytes being replaced by U+FFFD.
+  //@}
+
+private:
+  void Grow(uint32 Capacity);
+
+  char* mpData; ///< Points to mInline for short strings
+  uint32 mLength;
+  uint32 mCapacity;
+  char mInline[InlineCapacity + 1];
+};
+
@@ -30,10 +30,38 @@ public:
   bool CanWrite() const;
   
   bool Close();
+
+  /** @name Buffered I/O */
+  //@{
+  /*!
+  Used with non blocking sockets driven by a nuiSocketPool: OnCanRead() reads all the available data into the receive
+  buffer before calling the CanRead delegate, and OnCanWrite() sends the pending data before calling the CanWrite
+  delegate once the send buffer is empty.
+  */
+  bool BufferedSend(const uint8* pData, int len); ///< Send as much as possible now and keep the rest until the socket can write again.
+  bool BufferedSend(const std::vector<uint8>& rData);
+  uint32 GetBufferedSendSize() const; ///< Number of bytes waiting to be sent.
+
+  uint32 GetReceivedSize() const; ///< Number of bytes in the receive buffer.
+  const uint8* GetReceived() const; ///< Contents of the receive buffer.
+  void DiscardReceived(uint32 len); ///< Remove len bytes from the start of the receive buffer.
+  uint32 Read(uint8* pData, uint32 len); ///< Move up to len bytes from the receive buffer to pData, return the number of bytes moved.
+  //@}
+
+  virtual void OnCanRead();
+  virtual void OnCanWrite();
   
 protected:
   friend class nuiTCPServer;
   nuiTCPClient(int sock);
+  bool FlushSendBuffer();
+
   bool mConnected;
+  bool mReadClosed;
+
+  std::vector<uint8> mReceiveBuffer;
+  uint32 mReceiveOffset; ///< Start of the data not read yet in mReceiveBuffer
+  std::vector<uint8> mSendBuffer;
+  uint32 mSendOffset; ///< Start of the data not sent yet in mSendBuffer
 };
 
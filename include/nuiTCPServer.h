@@ -23,7 +23,7 @@ public:
   
   bool Listen(int backlog = 10);
   
-  nuiTCPClient* Accept();
+  nuiTCPClient* Accept(); ///< Return NULL if there is no pending connection. The new client is non blocking if the server is.
   
   bool Close();
 };
@@ -20,6 +20,13 @@ class nuiSurface;
 typedef std::map<nglString, nuiTexture*, nglString::LessFunctor> nuiTextureMap;
 typedef std::set<nuiTextureCache*> nuiTextureCacheSet;
 
+enum nuiAtlasPacking
+{
+  eAtlasPackingLegacy,         ///< Original TexturePacker heuristic.
+  eAtlasPackingMaxRects,       ///< MaxRects packing, sub textures are never rotated.
+  eAtlasPackingMaxRectsRotated ///< MaxRects packing, sub textures may be rotated to the right to fit better.
+};
+
 /// This class implements a basic image widget.
 class NUI_API nuiTexture : public nuiObject
 {
@@ -35,7 +42,9 @@ public:
   static nuiTexture* GetAATexture(); ///< Returns an antialiasing texture for use with AAPrimitives.cpp
   static nuiTexture* BindTexture(GLuint TextureID, GLenum Target); ///< Returns a texture that will use an existing OpenGL Texture.
   static nuiTexture* CreateTextureProxy(const nglString& rName, const nglString& rSourceTextureID, const nuiRect& rProxyRect, bool RotatedToTheRight); ///< Create a proxy texture that is at subtexture in an atlas.
-  static bool CreateAtlasFromPath(const nglPath& rPath, int32 MaxTextureSize, int32 ForceAtlasSize, bool Trim);
+  static bool CreateAtlasFromPath(const nglPath& rPath, int32 MaxTextureSize, int32 ForceAtlasSize, bool Trim, nuiAtlasPacking Packing = eAtlasPackingLegacy, const nglPath& rCachePath = nglPath());
+  /*!< Create an atlas texture from all the images found in \param rPath and a proxy texture for each of them. Images are decoded (and trimmed if \param Trim is true) on worker threads.
+       If \param rCachePath is not empty the resulting atlas is baked to that file and reloaded from it as long as the source images and the parameters stay the same. */
   
   static void ClearAll();
   static void ForceReloadAll(bool Rebind = false);
@@ -10,6 +10,13 @@
 #include "nui.h"
 
 
+/// Base class of the voices played by nuiAudioEngine
+/*!
+Process() is called from the audio thread. It never locks nor allocates once PrepareBuffers() has been called for the
+largest buffer it will get, which nuiAudioEngine does before starting to play the voice. The parameters (gain, pan,
+mute, loop, play) can be changed from any thread, and the fades and position changes are applied by the audio thread at
+the start of the next buffer.
+*/
 class nuiVoice : public nuiObject
 {
 public:   
@@ -19,6 +26,7 @@ public:
   virtual bool IsValid() const = 0;
   bool IsDone() const;
   
+  void PrepareBuffers(uint32 MaxSampleFrames); ///< Allocate the work buffers for up to MaxSampleFrames per call to Process(). Not real time safe.
   void Process(const std::vector<float*>& rOutput, uint32 SampleFrames);
   
   void Play();
@@ -60,6 +68,8 @@ protected:
   
   virtual void SetPositionInternal(int64 position);
   
+  void ApplyRequests(); ///< Apply the fades and position changes requested by the other threads (audio thread).
+  
   nuiSound* mpSound;
   
   nuiSampleInfo mInfo;
@@ -80,5 +90,20 @@ protected:
   uint32 mFadeOutPosition;
   uint32 mFadeOutLength;
   
-  nglCriticalSection mCs;
+  // Requests from the other threads: the value is written before the counter is incremented, the audio thread applies
+  // the value when the counter changes.
+  int64 mRequestedPosition;
+  nglAtomic32 mPositionRequests;
+  uint32 mAppliedPositionRequests;
+  bool mRequestedFadeIn;
+  uint32 mRequestedFadeLength;
+  nglAtomic32 mFadeRequests;
+  uint32 mAppliedFadeRequests;
+  
+  uint32 mBufferFrames;
+  std::vector<float> mBuffer; ///< Work buffers of all the channels
+  std::vector<float*> mBuffers;
+  std::vector<float*> mReadBuffers;
+  
+  nglCriticalSection mCs; ///< Serializes the requests, never taken by the audio thread
 };
\ No newline at end of file
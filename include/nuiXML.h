@@ -11,6 +11,7 @@
 //#include "nui.h"
 #include "nuiFlags.h"
 #include "nglString.h"
+#include "nuiString8.h"
 #include "nglIStream.h"
 #include "nglOStream.h"
 #include "nuiApplication.h"
@@ -104,6 +105,13 @@ public:
 
   const nglString& GetAttribute(const char* pName) const; ///< Return the value of the given attribute. If the attribute doesn't exists on this object the returned string will be empty.
 
+  // UTF-8 versions (the char* versions use the native encoding):
+  void SetName(const nuiString8& rName);
+  void SetValue(const nuiString8& rValue);
+  void SetAttribute(const nuiString8& rName, const nuiString8& rValue);
+  bool HasAttribute(const nuiString8& rName) const;
+  const nglString& GetAttribute(const nuiString8& rName) const;
+
 
 
 
@@ -147,6 +155,13 @@ protected:
   void* mpTag;
 private:
   nuiXMLNode(const nuiXMLNode& rOriginal);
+
+  int64 mMemoryBytes; ///< Memory accounted in eMemoryXML
+  int64 GetMemoryBytes() const; ///< Walks the whole node, only used to initialize mMemoryBytes
+  static int64 GetAttributeBytes(const nglString& rName, const nglString& rValue);
+  void UpdateMemoryStats(int64 Delta);
+  void StoreAttribute(const nglString& rName, const nglString& rValue); ///< Set the attribute and account for its size change only
+  void StoreNameAndValue(const nglString& rName, const nglString& rValue);
 };
 
 /// This class implements a very basic (but useful) XML parser/saver based on nglString. Is the basis of the xml widget tree loading/saving scheme.
@@ -184,7 +199,13 @@ typedef char nuiXML_Char;
 struct XML_ParserStruct;
 typedef struct XML_ParserStruct *XML_Parser;
 
-class nuiXMLParser ///< nui's SAX Parser
+/// nui's SAX Parser
+/*!
+The stream is read by chunks of BufferSize bytes straight into expat's buffer. Names, attributes and texts are UTF-8
+and are only valid during the call. Character data may be split in several calls to Characters().
+See nuiXMLReader for a pull API and nuiXMLDocument for a compact read only tree.
+*/
+class NUI_API nuiXMLParser
 {
 public:
   nuiXMLParser();
@@ -192,6 +213,7 @@ public:
   
   virtual bool Parse(nglIStream* pStream);
   void Stop();
+  nglString GetError() const; ///< Return a description of the last parsing error with its line and column.
 
   virtual void StartElement(const nuiXML_Char* name, const nuiXML_Char** atts);
   virtual void EndElement(const nuiXML_Char* name);
@@ -206,10 +228,11 @@ protected:
   static void ProcessingInstruction(void* pThis, const nuiXML_Char* target, const nuiXML_Char* data);
   static void Comment(void* pThis, const nuiXML_Char* data);
   
+  bool Feed(); ///< Parse the next chunk of the stream. Returns false on error, see GetError().
+
   nglIStream* mpStream;
   
-  //    static const uint32 BufferSize = 1024;
-  static const uint32 BufferSize = 4096;
+  static const uint32 BufferSize = 64 * 1024;
   
   XML_Parser mParser;
 };
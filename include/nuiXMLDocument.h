@@ -0,0 +1,115 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiXML.h"
+
+/// Read only XML tree stored in a memory arena
+/*!
+Unlike nuiXMLNode, the nodes, attributes and texts of a nuiXMLDocument are not allocated one by one but packed in a
+few big blocks owned by the document and released all at once with it. Element, attribute and processing instruction
+target names are interned: each distinct name is stored only once per document, so names can be compared by pointer
+with the result of nuiXMLDocument::GetName(). All the strings are zero terminated UTF-8.
+
+Texts made only of blanks are dropped unless requested. Comments and processing instructions outside of the root
+element are ignored.
+*/
+class NUI_API nuiXMLDocument
+{
+public:
+  class NUI_API Node
+  {
+  public:
+    enum Type
+    {
+      eElement,
+      eText,
+      eComment,
+      eProcessingInstruction
+    };
+
+    Type GetType() const;
+    bool IsElement() const;
+    bool IsText() const;
+
+    const char* GetName() const; ///< Interned name of an element or target of a processing instruction, empty for other nodes.
+    const char* GetText() const; ///< Text, comment or processing instruction data, empty for elements.
+    uint32 GetTextLength() const; ///< Length in bytes of GetText().
+    nglString GetValue() const; ///< Converted text of a text node, or concatenated texts of the children of an element.
+
+    uint32 GetAttributeCount() const;
+    const char* GetAttributeName(uint32 Index) const; ///< Interned name of the attribute with the given index.
+    const char* GetAttributeValue(uint32 Index) const;
+    const char* GetAttribute(const char* pName) const; ///< Return the value of the given attribute or NULL if it is not present.
+    bool HasAttribute(const char* pName) const;
+
+    const Node* GetParent() const;
+    const Node* GetFirstChild() const;
+    const Node* GetNextSibling() const;
+    uint32 GetChildrenCount() const;
+    const Node* GetChild(const char* pName) const; ///< Return the first child element with the given name or NULL.
+    const Node* GetNextSibling(const char* pName) const; ///< Return the next sibling element with the given name or NULL.
+
+    nuiXMLNode* CreateXMLNode(nuiXMLNode* pParent = NULL) const; ///< Build the equivalent nuiXMLNode tree, for the APIs that still need one (text and comment nodes become ##text and ##comment nodes).
+
+  private:
+    friend class nuiXMLDocument;
+    friend class nuiXMLDocumentBuilder;
+
+    Type mType;
+    uint32 mTextLength;
+    uint32 mAttributeCount;
+    uint32 mChildrenCount;
+    const char* mpName;
+    const char* mpText;
+    const char** mpAttributes; ///< Name and value pairs
+    const Node* mpParent;
+    const Node* mpFirstChild;
+    const Node* mpNextSibling;
+  };
+
+  nuiXMLDocument();
+  virtual ~nuiXMLDocument();
+
+  bool Load(nglIStream& rStream, bool KeepBlankText = false); ///< Replace the contents of the document with the one read from the stream.
+  void Clear(); ///< Release all the nodes.
+
+  const Node* GetRoot() const; ///< Return the root element, NULL if the document is empty.
+  const char* GetName(const char* pName) const; ///< Return the interned version of the given name or NULL if no node or attribute of the document uses it.
+
+  const nglString& GetError() const; ///< Description of the last loading error with its line and column.
+  size_t GetMemoryUsage() const; ///< Memory used by the nodes, strings and names table.
+
+private:
+  friend class nuiXMLDocumentBuilder;
+
+  nuiXMLDocument(const nuiXMLDocument& rDocument);
+  nuiXMLDocument& operator=(const nuiXMLDocument& rDocument);
+
+  void* Allocate(size_t Size);
+  const char* StoreString(const char* pString, size_t Length);
+  const char* Intern(const char* pName, size_t Length);
+  const char* FindName(const char* pName, size_t Length, uint32 Hash) const;
+
+  struct Block
+  {
+    uint8* mpData;
+    size_t mSize;
+  };
+
+  std::vector<Block> mBlocks;
+  uint8* mpCurrent;
+  size_t mAvailable;
+  size_t mUsage;
+
+  std::vector<const char*> mNames; ///< Open addressing hash table of the interned names
+  uint32 mNameCount;
+
+  const Node* mpRoot;
+  nglString mError;
+};
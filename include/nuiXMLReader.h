@@ -0,0 +1,106 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiXML.h"
+
+/// Pull parser reading an XML document from a stream
+/*!
+Instead of building a tree or receiving callbacks, the client asks for the events one by one with Next():
+\code
+nuiXMLReader reader(pStream);
+while (reader.Next() == nuiXMLReader::eStartElement)
+  ...
+\endcode
+The events are produced by expat, one chunk of the stream at a time, and queued in a single buffer that is reused
+for the whole document: reading never allocates per element. Names, attributes and texts are returned as zero
+terminated UTF-8 views that are only valid until the next call to Next() or SkipElement().
+
+Consecutive character data is merged into a single eText event, even when it spans several chunks.
+*/
+class NUI_API nuiXMLReader : protected nuiXMLParser
+{
+public:
+  enum Event
+  {
+    eNone = 0,               ///< Next() was not called yet
+    eStartElement,           ///< See GetName() and the attribute accessors
+    eEndElement,             ///< See GetName()
+    eText,                   ///< See GetText()
+    eComment,                ///< See GetText()
+    eProcessingInstruction,  ///< GetName() is the target and GetText() the data
+    eEndOfDocument,
+    eError                   ///< See GetError(). All the following calls to Next() return eError.
+  };
+
+  nuiXMLReader(nglIStream* pStream, bool SkipBlankText = true); ///< The stream is not owned. If \a SkipBlankText is true, texts made only of blanks are not reported.
+  virtual ~nuiXMLReader();
+
+  Event Next(); ///< Read the next event.
+  Event GetEvent() const; ///< Return the last event read by Next().
+  uint32 GetDepth() const; ///< Number of open elements. The element of an eStartElement or eEndElement event is counted.
+
+  bool SkipElement(); ///< After eStartElement, skip the contents of the element: the current event becomes its eEndElement. The skipped events are not even queued. Returns false on error.
+
+  const char* GetName() const; ///< Name of the current element or target of the processing instruction. Empty for other events.
+  uint32 GetNameLength() const; ///< Length in bytes of GetName().
+  const char* GetText() const; ///< Text, comment or processing instruction data. Empty for other events.
+  uint32 GetTextLength() const; ///< Length in bytes of GetText().
+
+  uint32 GetAttributeCount() const; ///< Number of attributes of the current element.
+  const char* GetAttributeName(uint32 Index) const;
+  const char* GetAttributeValue(uint32 Index) const;
+  uint32 GetAttributeValueLength(uint32 Index) const;
+  const char* GetAttribute(const char* pName) const; ///< Return the value of the given attribute of the current element or NULL if it is not present.
+
+  nglString GetError() const; ///< Description of the error with its line and column, empty if there was no error.
+
+protected:
+  virtual void StartElement(const nuiXML_Char* name, const nuiXML_Char** atts);
+  virtual void EndElement(const nuiXML_Char* name);
+  virtual void Characters(const nuiXML_Char* s, int len);
+  virtual void ProcessingInstruction(const nuiXML_Char* target, const nuiXML_Char* data);
+  virtual void Comment(const nuiXML_Char* data);
+
+  struct Record
+  {
+    Event mType;
+    uint32 mName; ///< Offset of the name in mData
+    uint32 mNameLength;
+    uint32 mText; ///< Offset of the text in mData
+    uint32 mTextLength;
+    uint32 mAttributes; ///< Index of the first attribute in mAttributes
+    uint32 mAttributeCount;
+  };
+
+  struct Attribute
+  {
+    uint32 mName;
+    uint32 mValue;
+    uint32 mValueLength;
+  };
+
+  uint32 Store(const char* pString, uint32 Length); ///< Append a zero terminated copy of the string to mData and return its offset.
+  Record& AddRecord(Event Type);
+  bool IsPending(uint32 Index) const; ///< The record is a text that may continue in the next chunk
+  bool IsBlank(const Record& rRecord) const;
+  void Compact(); ///< Drop the records that were already returned
+  bool Read(); ///< Parse the next chunk of the stream. Returns false and sets the eError event on failure.
+
+  std::vector<Record> mRecords;
+  std::vector<Attribute> mAttributes;
+  std::vector<char> mData;
+  uint32 mCurrent; ///< Index of the current event in mRecords
+  uint32 mNext; ///< Index of the next event to return in mRecords
+
+  Event mEvent;
+  uint32 mDepth;
+  uint32 mSkipLevel; ///< Elements left to close while skipping
+  bool mSkipBlankText;
+  bool mFinished;
+};
@@ -39,8 +39,9 @@ nglConsole::nglConsole(bool IsVisible)
   mFD = STDIN_FILENO;
   if (!isatty (mFD))
   {
+    // Not connected to a tty (tests, pipes): the interactive console is disabled. This is not logged, the log would
+    // output to this console while it is being created and create another one.
     mFlags = 0;
-    NGL_LOG(_T("console"), NGL_LOG_WARNING, _T("Warning: not connected to a tty, interactive console disabled\n"));
     return;
   }
   mFlags = nglEvent::Read | nglEvent::Error;
@@ -8,6 +8,14 @@
 #include "nui.h"
 #include "nglCPUInfo.h"
 
+#ifndef _WIN32_
+#include <unistd.h>
+#if (defined __GNUC__) && ((defined _NGL_X86_) || (defined _NGL_X64_))
+#include <cpuid.h>
+#define NGL_GCC_CPUID
+#endif
+#endif
+
 
 /* CPU family can be set at build time
  */
@@ -29,6 +37,8 @@ uint nglCPUInfo::mCount   = 0; // 0 CPU means we do not have any info on the cur
 bool nglCPUInfo::mMMX     = false;
 bool nglCPUInfo::mSSE     = false;
 bool nglCPUInfo::mSSE2    = false;
+bool nglCPUInfo::mSSSE3   = false;
+bool nglCPUInfo::mAVX2    = false;
 bool nglCPUInfo::m3DNow   = false;
 bool nglCPUInfo::mAltivec = false;
 
@@ -63,6 +73,18 @@ bool nglCPUInfo::HasSSE2()
   return mSSE2;
 }
 
+bool nglCPUInfo::HasSSSE3()
+{
+  FillCPUInfo();
+  return mSSSE3;
+}
+
+bool nglCPUInfo::HasAVX2()
+{
+  FillCPUInfo();
+  return mAVX2;
+}
+
 bool nglCPUInfo::Has3DNow()
 {
   FillCPUInfo();
@@ -102,10 +124,12 @@ nglString nglCPUInfo::Dump()
     text += _T(" x %d");
   }
 
-  buffer.Format(_T("%ls%ls%ls%ls%ls"),
+  buffer.Format(_T("%ls%ls%ls%ls%ls%ls%ls"),
     HasMMX()     ? _T(" MMX") : _T(""),
     HasSSE()     ? _T(" SSE") : _T(""),
     HasSSE2()    ? _T(" SSE2") : _T(""),
+    HasSSSE3()   ? _T(" SSSE3") : _T(""),
+    HasAVX2()    ? _T(" AVX2") : _T(""),
     Has3DNow()   ? _T(" 3DNow") : _T(""),
     HasAltivec() ? _T(" Altivec") : _T(""));
   if (buffer.GetLength())
@@ -120,5 +144,30 @@ nglString nglCPUInfo::Dump()
 #ifndef _WIN32_
 void nglCPUInfo::FillCPUInfo()
 {
+  if (mCount)
+    return;
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  mCount = (count > 0) ? count : 1;
+
+#ifdef NGL_GCC_CPUID
+  uint32 eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+  {
+    mMMX   = (edx >> 23) & 1;
+    mSSE   = (edx >> 25) & 1;
+    mSSE2  = (edx >> 26) & 1;
+    mSSSE3 = (ecx >> 9) & 1;
+
+    // AVX2 needs the OS to save the YMM registers (OSXSAVE + XCR0 bits 1 and 2):
+    bool osxsave = (ecx >> 27) & 1;
+    if (osxsave && __get_cpuid_max(0, NULL) >= 7)
+    {
+      uint32 xcr0, xcr0hi;
+      __asm__ volatile ("xgetbv" : "=a" (xcr0), "=d" (xcr0hi) : "c" (0));
+      __cpuid_count(7, 0, eax, ebx, ecx, edx);
+      mAVX2 = ((xcr0 & 6) == 6) && ((ebx >> 5) & 1);
+    }
+  }
+#endif
 }
 #endif // _WIN32_
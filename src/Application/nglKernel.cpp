@@ -15,6 +15,8 @@
 
 #include "nuiNativeResourceVolume.h"
 #include "nuiNotification.h"
+#include "nuiProfiler.h"
+#include "nuiMemoryTracker.h"
 
 #include "ucdata.h"
 
@@ -319,6 +321,8 @@ void nglKernel::CallOnInit()
   nuiTimer* pTimer = nuiAnimation::AcquireTimer();
   mKernelEventSink.Connect(pTimer->Tick, &nglKernel::ProcessMessages);
   mpNotificationManager = new nuiNotificationManager();
+  nuiProfiler::Init();
+  nuiMemoryTracker::Init();
   
   OnInit();
 }
@@ -327,6 +331,8 @@ void nglKernel::CallOnExit(int Code)
 {
   NGL_DEBUG( NGL_LOG(_T("kernel"), NGL_LOG_INFO, _T("Exit (code: %d)"), Code); )
   OnExit (Code);
+  nuiProfiler::Exit();
+  nuiMemoryTracker::Exit();
   nuiAnimation::ReleaseTimer();
 }
 
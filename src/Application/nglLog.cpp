@@ -10,6 +10,7 @@
 #include "nglKernel.h"
 #include "nglTime.h"
 #include "nglOStream.h"
+#include "nuiString8.h"
 
 const nglLog::StampFlags nglLog::NoStamp     = 0;
 const nglLog::StampFlags nglLog::TimeStamp   = 1 << 0;
@@ -181,6 +182,26 @@ void nglLog::Logv (const nglChar* pDomain, uint Level, const nglChar* pText, va_
   if (Level > dom->Level)
     return;
 
+  mOutputBuffer.Formatv(pText, Args);
+  Output(dom);
+}
+
+void nglLog::Log (const nglChar* pDomain, uint Level, const nuiString8& rText)
+{
+  Domain* dom = LookupDomain(pDomain);
+  if (!dom)
+    return;
+
+  // Filtered events don't pay for the conversion
+  if (Level > dom->Level)
+    return;
+
+  rText.ToString(mOutputBuffer);
+  Output(dom);
+}
+
+void nglLog::Output (Domain* dom)
+{
   // Update log item counter
   ngl_atomic_inc(dom->Count);
 
@@ -225,7 +246,6 @@ void nglLog::Logv (const nglChar* pDomain, uint Level, const nglChar* pText, va_
     mPrefix += mBody;
   }
 
-  mOutputBuffer.Formatv(pText, Args);
   mOutputBuffer.TrimRight(_T('\n'));
 
   if (mOutputBuffer.Find(_T('\n')) == -1)
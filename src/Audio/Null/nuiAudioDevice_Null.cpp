@@ -0,0 +1,323 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiAudioDevice_Null.h"
+#include "nuiAudioConvert.h"
+#include "nuiSampleWriter.h"
+
+#define API_NAME _T("Null")
+
+static const double gNullSampleRates[] = { 22050, 32000, 44100, 48000, 88200, 96000, 176400, 192000 };
+
+//class nuiAudioDevice_Null::Timings
+nuiAudioDevice_Null::Timings::Timings()
+: mBufferDuration(0),
+  mCallbacks(0),
+  mOverruns(0),
+  mTotalTime(0),
+  mMinTime(0),
+  mMaxTime(0),
+  mLateCallbacks(0),
+  mMaxLateness(0)
+{
+}
+
+double nuiAudioDevice_Null::Timings::GetAverageTime() const
+{
+  if (!mCallbacks)
+    return 0;
+  return mTotalTime / mCallbacks;
+}
+
+double nuiAudioDevice_Null::Timings::GetLoad() const
+{
+  if (mBufferDuration <= 0)
+    return 0;
+  return GetAverageTime() / mBufferDuration;
+}
+
+
+//class nuiAudioDevice_Null
+nuiAudioDevice_Null::nuiAudioDevice_Null(Mode mode, uint32 InputChannels, uint32 OutputChannels)
+: mMode(mode),
+  mSampleRate(0),
+  mBufferSize(0),
+  mpWriter(NULL),
+  mBitsPerSample(16),
+  mpThread(NULL),
+  mStop(false),
+  mOpen(false),
+  mRenderedFrames(0)
+{
+  mAPIName = API_NAME;
+  mName = (mode == eRealTime) ? _T("Null") : _T("Offline");
+  mManufacturer = _T("nui");
+  mIsPresent = true;
+
+  for (uint32 i = 0; i < sizeof(gNullSampleRates) / sizeof(gNullSampleRates[0]); i++)
+    mSampleRates.push_back(gNullSampleRates[i]);
+  for (uint32 size = 32; size <= 8192; size *= 2)
+    mBufferSizes.push_back(size);
+
+  for (uint32 i = 0; i < InputChannels; i++)
+  {
+    nglString name;
+    name.CFormat(_T("In %d"), i + 1);
+    mInputChannels.push_back(name);
+  }
+  for (uint32 i = 0; i < OutputChannels; i++)
+  {
+    nglString name;
+    name.CFormat(_T("Out %d"), i + 1);
+    mOutputChannels.push_back(name);
+  }
+}
+
+nuiAudioDevice_Null::~nuiAudioDevice_Null()
+{
+  Close();
+}
+
+nuiAudioDevice_Null::Mode nuiAudioDevice_Null::GetMode() const
+{
+  return mMode;
+}
+
+bool nuiAudioDevice_Null::IsOpen() const
+{
+  return mOpen;
+}
+
+void nuiAudioDevice_Null::SetWriter(nuiSampleWriter* pWriter, uint32 BitsPerSample)
+{
+  NGL_ASSERT(!mOpen);
+  mpWriter = pWriter;
+  mBitsPerSample = BitsPerSample;
+}
+
+bool nuiAudioDevice_Null::Open(std::vector<uint32>& rInputChannels, std::vector<uint32>& rOutputChannels, double SampleRate, uint32 BufferSize, nuiAudioProcessFn pProcessFunction)
+{
+  if (mOpen || SampleRate <= 0 || !BufferSize)
+    return false;
+
+  for (uint32 i = 0; i < rInputChannels.size(); i++)
+    if (rInputChannels[i] >= mInputChannels.size())
+      return false;
+  for (uint32 i = 0; i < rOutputChannels.size(); i++)
+    if (rOutputChannels[i] >= mOutputChannels.size())
+      return false;
+
+  mProcessFunction = pProcessFunction;
+  mSampleRate = SampleRate;
+  mBufferSize = BufferSize;
+  mRenderedFrames = 0;
+
+  // All the buffers are allocated here, the process loop doesn't allocate
+  const uint32 inputs = rInputChannels.size();
+  const uint32 outputs = rOutputChannels.size();
+  mInputSamples.clear();
+  mInputSamples.resize(inputs * BufferSize, 0.0f);
+  mOutputSamples.clear();
+  mOutputSamples.resize(outputs * BufferSize, 0.0f);
+  mInputBuffers.resize(inputs);
+  mOutputBuffers.resize(outputs);
+  for (uint32 i = 0; i < inputs; i++)
+    mInputBuffers[i] = &mInputSamples[i * BufferSize];
+  for (uint32 i = 0; i < outputs; i++)
+    mOutputBuffers[i] = &mOutputSamples[i * BufferSize];
+
+  if (mpWriter)
+  {
+    if (!outputs)
+      return false;
+
+    nuiSampleInfo info;
+    info.SetSampleRate(SampleRate);
+    info.SetChannels(outputs);
+    info.SetBitsPerSample(mBitsPerSample);
+    if (!mpWriter->WriteInfo(info))
+      return false;
+    mInterleaved.resize(outputs * BufferSize);
+  }
+
+  ResetTimings();
+  mOpen = true;
+
+  if (mMode == eRealTime)
+  {
+    mStop = false;
+    mpThread = new nglThreadDelegate(nuiMakeDelegate(this, &nuiAudioDevice_Null::Run), _T("nuiAudioDevice_Null"), nglThread::Highest);
+    if (!mpThread->Start())
+    {
+      delete mpThread;
+      mpThread = NULL;
+      mOpen = false;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool nuiAudioDevice_Null::Close()
+{
+  if (!mOpen)
+    return false;
+
+  if (mpThread)
+  {
+    mStop = true;
+    mpThread->Join();
+    delete mpThread;
+    mpThread = NULL;
+  }
+
+  if (mpWriter)
+    mpWriter->Finalize();
+
+  mOpen = false;
+  return true;
+}
+
+uint64 nuiAudioDevice_Null::Render(uint64 SampleFrames)
+{
+  NGL_ASSERT(mMode == eOffline);
+  if (!mOpen || mMode != eOffline)
+    return 0;
+
+  uint64 done = 0;
+  while (done < SampleFrames)
+  {
+    Process(0);
+    done += mBufferSize;
+  }
+  return done;
+}
+
+uint64 nuiAudioDevice_Null::GetRenderedFrames() const
+{
+  return mRenderedFrames;
+}
+
+nuiAudioDevice_Null::Timings nuiAudioDevice_Null::GetTimings() const
+{
+  nglCriticalSectionGuard guard(mTimingsCS);
+  return mTimings;
+}
+
+void nuiAudioDevice_Null::ResetTimings()
+{
+  nglCriticalSectionGuard guard(mTimingsCS);
+  mTimings = Timings();
+  if (mSampleRate > 0)
+    mTimings.mBufferDuration = mBufferSize / mSampleRate;
+}
+
+void nuiAudioDevice_Null::Process(double Lateness)
+{
+  nglTime start;
+  mProcessFunction(mInputBuffers, mOutputBuffers, mBufferSize);
+  double duration = nglTime() - start;
+
+  if (mpWriter)
+  {
+    nuiAudioConvert_DEfloatToINfloat(&mOutputBuffers[0], &mInterleaved[0], mOutputBuffers.size(), mBufferSize);
+    mpWriter->Write(&mInterleaved[0], mBufferSize, eSampleFloat32);
+  }
+  mRenderedFrames += mBufferSize;
+
+  nglCriticalSectionGuard guard(mTimingsCS);
+  Timings& rT(mTimings);
+  if (!rT.mCallbacks || duration < rT.mMinTime)
+    rT.mMinTime = duration;
+  rT.mMaxTime = MAX(rT.mMaxTime, duration);
+  rT.mTotalTime += duration;
+  rT.mCallbacks++;
+  if (duration > rT.mBufferDuration)
+    rT.mOverruns++;
+  if (Lateness > rT.mBufferDuration)
+    rT.mLateCallbacks++;
+  rT.mMaxLateness = MAX(rT.mMaxLateness, Lateness);
+}
+
+void nuiAudioDevice_Null::Run()
+{
+  const double period = mBufferSize / mSampleRate;
+  double due = nglTime();
+
+  while (!mStop)
+  {
+    double now = nglTime();
+    if (now < due)
+    {
+      nglThread::USleep((uint32)((due - now) * 1000000.0));
+      now = nglTime();
+    }
+
+    Process(now - due);
+    due += period;
+
+    // After a long stall (debugger, suspended process) start again from now instead of catching up
+    if (nglTime() - due > 8 * period)
+      due = nglTime();
+  }
+}
+
+
+//class nuiAudioDeviceAPI_Null
+nuiAudioDeviceAPI_Null::nuiAudioDeviceAPI_Null()
+{
+  mName = API_NAME;
+}
+
+nuiAudioDeviceAPI_Null::~nuiAudioDeviceAPI_Null()
+{
+}
+
+uint32 nuiAudioDeviceAPI_Null::GetDeviceCount() const
+{
+  return 2;
+}
+
+nuiAudioDevice* nuiAudioDeviceAPI_Null::GetDevice(uint32 index)
+{
+  if (index > 1)
+    return NULL;
+  return new nuiAudioDevice_Null(index ? nuiAudioDevice_Null::eOffline : nuiAudioDevice_Null::eRealTime);
+}
+
+nuiAudioDevice* nuiAudioDeviceAPI_Null::GetDevice(const nglString& rDeviceName)
+{
+  for (uint32 i = 0; i < GetDeviceCount(); i++)
+  {
+    if (rDeviceName == GetDeviceName(i))
+      return GetDevice(i);
+  }
+  return NULL;
+}
+
+nglString nuiAudioDeviceAPI_Null::GetDeviceName(uint32 index) const
+{
+  if (index == 0)
+    return _T("Null");
+  if (index == 1)
+    return _T("Offline");
+  return nglString::Null;
+}
+
+nuiAudioDevice* nuiAudioDeviceAPI_Null::GetDefaultOutputDevice()
+{
+  return GetDevice(0);
+}
+
+nuiAudioDevice* nuiAudioDeviceAPI_Null::GetDefaultInputDevice()
+{
+  return GetDevice(0);
+}
+
+nuiAudioDeviceAPI_Null NullAudioAPI;
@@ -8,15 +8,315 @@
 #include "nui.h"
 #include "nuiAudioConvert.h"
 
+#if (defined _NGL_X86_) || (defined _NGL_X64_)
+  #define NUI_AUDIO_SIMD
+  #include <xmmintrin.h>
+  #include <immintrin.h>
+  #ifdef __GNUC__
+    // The kernels are compiled for their instruction set regardless of the global flags, they are only called after a runtime check
+    #define NUI_TARGET_SSE   __attribute__((target("sse")))
+    #define NUI_TARGET_SSE2  __attribute__((target("sse2")))
+    #define NUI_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #define NUI_TARGET_AVX2  __attribute__((target("avx2")))
+  #else
+    #define NUI_TARGET_SSE
+    #define NUI_TARGET_SSE2
+    #define NUI_TARGET_SSSE3
+    #define NUI_TARGET_AVX2
+  #endif
+#endif
+
+//////////////////////////////////////
+// Conversion kernels
+// Like the mixing kernels, the SIMD versions convert as many samples as they can and return that count, the scalar loops
+// finish the buffers. The negative and the positive samples are scaled by different factors: the kernels select them with
+// a comparison mask, so that they give the same results as the scalar loops.
+#ifdef NUI_AUDIO_SIMD
+NUI_TARGET_SSE2 static inline __m128 nuiAudioConvert_Scale_SSE2(__m128 value, __m128 negative, __m128 positive)
+{
+  __m128 mask = _mm_cmplt_ps(value, _mm_setzero_ps());
+  return _mm_mul_ps(value, _mm_or_ps(_mm_and_ps(mask, negative), _mm_andnot_ps(mask, positive)));
+}
+
+NUI_TARGET_AVX2 static inline __m256 nuiAudioConvert_Scale_AVX2(__m256 value, __m256 negative, __m256 positive)
+{
+  return _mm256_mul_ps(value, _mm256_blendv_ps(positive, negative, _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_LT_OQ)));
+}
+
+// int16 -> float. Each block is loaded before being stored so the 16 bits buffer can be at the end of the float buffer.
+NUI_TARGET_SSE2 static uint64 nuiAudioConvert_Int16ToFloat_SSE2(const int16* pIn, float* pOut, uint64 Count, float Negative, float Positive)
+{
+  const __m128 negative = _mm_set1_ps(Negative);
+  const __m128 positive = _mm_set1_ps(Positive);
+  uint64 count = Count & ~(uint64)7;
+  for (uint64 i = 0; i < count; i += 8)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)(pIn + i));
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16));
+    _mm_storeu_ps(pOut + i, nuiAudioConvert_Scale_SSE2(lo, negative, positive));
+    _mm_storeu_ps(pOut + i + 4, nuiAudioConvert_Scale_SSE2(hi, negative, positive));
+  }
+  return count;
+}
+
+NUI_TARGET_AVX2 static uint64 nuiAudioConvert_Int16ToFloat_AVX2(const int16* pIn, float* pOut, uint64 Count, float Negative, float Positive)
+{
+  const __m256 negative = _mm256_set1_ps(Negative);
+  const __m256 positive = _mm256_set1_ps(Positive);
+  uint64 count = Count & ~(uint64)15;
+  for (uint64 i = 0; i < count; i += 16)
+  {
+    __m128i in0 = _mm_loadu_si128((const __m128i*)(pIn + i));
+    __m128i in1 = _mm_loadu_si128((const __m128i*)(pIn + i + 8));
+    __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(in0));
+    __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(in1));
+    _mm256_storeu_ps(pOut + i, nuiAudioConvert_Scale_AVX2(lo, negative, positive));
+    _mm256_storeu_ps(pOut + i + 8, nuiAudioConvert_Scale_AVX2(hi, negative, positive));
+  }
+  return count;
+}
+
+// One channel of interleaved stereo int16 -> float
+NUI_TARGET_SSE2 static uint32 nuiAudioConvert_StereoInt16ToFloat_SSE2(const int16* pIn, float* pOut, uint32 Channel, uint32 SampleFrames)
+{
+  const __m128 negative = _mm_set1_ps(1.0f / 32768.0f);
+  const __m128 positive = _mm_set1_ps(1.0f / 32767.0f);
+  uint32 count = SampleFrames & ~3;
+  for (uint32 i = 0; i < count; i += 4)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)(pIn + 2 * i));
+    if (!Channel)
+      in = _mm_slli_epi32(in, 16);
+    _mm_storeu_ps(pOut + i, nuiAudioConvert_Scale_SSE2(_mm_cvtepi32_ps(_mm_srai_epi32(in, 16)), negative, positive));
+  }
+  return count;
+}
+
+NUI_TARGET_AVX2 static uint32 nuiAudioConvert_StereoInt16ToFloat_AVX2(const int16* pIn, float* pOut, uint32 Channel, uint32 SampleFrames)
+{
+  const __m256 negative = _mm256_set1_ps(1.0f / 32768.0f);
+  const __m256 positive = _mm256_set1_ps(1.0f / 32767.0f);
+  uint32 count = SampleFrames & ~7;
+  for (uint32 i = 0; i < count; i += 8)
+  {
+    __m256i in = _mm256_loadu_si256((const __m256i*)(pIn + 2 * i));
+    if (!Channel)
+      in = _mm256_slli_epi32(in, 16);
+    _mm256_storeu_ps(pOut + i, nuiAudioConvert_Scale_AVX2(_mm256_cvtepi32_ps(_mm256_srai_epi32(in, 16)), negative, positive));
+  }
+  return count;
+}
+
+// float -> int16
+NUI_TARGET_SSE2 static uint64 nuiAudioConvert_FloatToInt16_SSE2(const float* pIn, int16* pOut, uint64 Count)
+{
+  const __m128 negative = _mm_set1_ps(32768.0f);
+  const __m128 positive = _mm_set1_ps(32767.0f);
+  const __m128 minimum = _mm_set1_ps(-1.0f);
+  const __m128 maximum = _mm_set1_ps(1.0f);
+  uint64 count = Count & ~(uint64)7;
+  for (uint64 i = 0; i < count; i += 8)
+  {
+    __m128 in0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pIn + i), minimum), maximum);
+    __m128 in1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pIn + i + 4), minimum), maximum);
+    __m128i out0 = _mm_cvttps_epi32(nuiAudioConvert_Scale_SSE2(in0, negative, positive));
+    __m128i out1 = _mm_cvttps_epi32(nuiAudioConvert_Scale_SSE2(in1, negative, positive));
+    _mm_storeu_si128((__m128i*)(pOut + i), _mm_packs_epi32(out0, out1));
+  }
+  return count;
+}
+
+NUI_TARGET_AVX2 static uint64 nuiAudioConvert_FloatToInt16_AVX2(const float* pIn, int16* pOut, uint64 Count)
+{
+  const __m256 negative = _mm256_set1_ps(32768.0f);
+  const __m256 positive = _mm256_set1_ps(32767.0f);
+  const __m256 minimum = _mm256_set1_ps(-1.0f);
+  const __m256 maximum = _mm256_set1_ps(1.0f);
+  uint64 count = Count & ~(uint64)15;
+  for (uint64 i = 0; i < count; i += 16)
+  {
+    __m256 in0 = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pIn + i), minimum), maximum);
+    __m256 in1 = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pIn + i + 8), minimum), maximum);
+    __m256i out0 = _mm256_cvttps_epi32(nuiAudioConvert_Scale_AVX2(in0, negative, positive));
+    __m256i out1 = _mm256_cvttps_epi32(nuiAudioConvert_Scale_AVX2(in1, negative, positive));
+    // packs works on each 128 bits lane: put the 64 bits quarters back in order
+    __m256i out = _mm256_permute4x64_epi64(_mm256_packs_epi32(out0, out1), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256((__m256i*)(pOut + i), out);
+  }
+  return count;
+}
+
+// 24 bits -> float. The bytes of 4 samples are moved to the upper 3 bytes of 4 int32 that are then shifted back with their
+// sign. A block reads 16 bytes for 12, so the kernels stop 2 samples before the end of the buffer.
+static const int8 gAudioConvert_24LE[16] = { -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 };
+static const int8 gAudioConvert_24BE[16] = { -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9 };
+static const int8 gAudioConvert_To24LE[16] = { 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 };
+static const int8 gAudioConvert_To24BE[16] = { 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 };
+
+NUI_TARGET_SSSE3 static uint64 nuiAudioConvert_24bitsToFloat_SSSE3(const uint8* pIn, float* pOut, uint64 Count, const int8* pShuffle)
+{
+  const __m128 negative = _mm_set1_ps(1.0f / 8388608.0f);
+  const __m128 positive = _mm_set1_ps(1.0f / 8388607.0f);
+  const __m128i shuffle = _mm_loadu_si128((const __m128i*)pShuffle);
+  uint64 i = 0;
+  for (; i + 6 <= Count; i += 4)
+  {
+    __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pIn + 3 * i)), shuffle);
+    _mm_storeu_ps(pOut + i, nuiAudioConvert_Scale_SSE2(_mm_cvtepi32_ps(_mm_srai_epi32(in, 8)), negative, positive));
+  }
+  return i;
+}
+
+NUI_TARGET_AVX2 static uint64 nuiAudioConvert_24bitsToFloat_AVX2(const uint8* pIn, float* pOut, uint64 Count, const int8* pShuffle)
+{
+  const __m256 negative = _mm256_set1_ps(1.0f / 8388608.0f);
+  const __m256 positive = _mm256_set1_ps(1.0f / 8388607.0f);
+  const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)pShuffle));
+  uint64 i = 0;
+  for (; i + 10 <= Count; i += 8)
+  {
+    __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(pIn + 3 * i))), _mm_loadu_si128((const __m128i*)(pIn + 3 * i + 12)), 1);
+    in = _mm256_shuffle_epi8(in, shuffle);
+    _mm256_storeu_ps(pOut + i, nuiAudioConvert_Scale_AVX2(_mm256_cvtepi32_ps(_mm256_srai_epi32(in, 8)), negative, positive));
+  }
+  return i;
+}
+
+// float -> 24 bits. A block writes 16 bytes for 12, the next one overwrites the 4 extra bytes.
+NUI_TARGET_SSSE3 static uint64 nuiAudioConvert_FloatTo24bits_SSSE3(const float* pIn, uint8* pOut, uint64 Count, const int8* pShuffle)
+{
+  const __m128 negative = _mm_set1_ps(8388608.0f);
+  const __m128 positive = _mm_set1_ps(8388607.0f);
+  const __m128 minimum = _mm_set1_ps(-1.0f);
+  const __m128 maximum = _mm_set1_ps(1.0f);
+  const __m128i shuffle = _mm_loadu_si128((const __m128i*)pShuffle);
+  uint64 i = 0;
+  for (; i + 6 <= Count; i += 4)
+  {
+    __m128 in = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pIn + i), minimum), maximum);
+    __m128i out = _mm_cvttps_epi32(nuiAudioConvert_Scale_SSE2(in, negative, positive));
+    _mm_storeu_si128((__m128i*)(pOut + 3 * i), _mm_shuffle_epi8(out, shuffle));
+  }
+  return i;
+}
+
+// int32 <-> float. The products are kept under 2^31 that doesn't fit in an int32.
+NUI_TARGET_SSE2 static uint64 nuiAudioConvert_Int32ToFloat_SSE2(const int32* pIn, float* pOut, uint64 Count)
+{
+  const __m128 negative = _mm_set1_ps(1.0f / 2147483648.0f);
+  const __m128 positive = _mm_set1_ps(1.0f / 2147483647.0f);
+  uint64 count = Count & ~(uint64)3;
+  for (uint64 i = 0; i < count; i += 4)
+  {
+    __m128 in = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(pIn + i)));
+    _mm_storeu_ps(pOut + i, nuiAudioConvert_Scale_SSE2(in, negative, positive));
+  }
+  return count;
+}
+
+NUI_TARGET_AVX2 static uint64 nuiAudioConvert_Int32ToFloat_AVX2(const int32* pIn, float* pOut, uint64 Count)
+{
+  const __m256 negative = _mm256_set1_ps(1.0f / 2147483648.0f);
+  const __m256 positive = _mm256_set1_ps(1.0f / 2147483647.0f);
+  uint64 count = Count & ~(uint64)7;
+  for (uint64 i = 0; i < count; i += 8)
+  {
+    __m256 in = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(pIn + i)));
+    _mm256_storeu_ps(pOut + i, nuiAudioConvert_Scale_AVX2(in, negative, positive));
+  }
+  return count;
+}
+
+NUI_TARGET_SSE2 static uint64 nuiAudioConvert_FloatToInt32_SSE2(const float* pIn, int32* pOut, uint64 Count)
+{
+  const __m128 negative = _mm_set1_ps(2147483648.0f);
+  const __m128 positive = _mm_set1_ps(2147483647.0f);
+  const __m128 minimum = _mm_set1_ps(-1.0f);
+  const __m128 maximum = _mm_set1_ps(1.0f);
+  const __m128 largest = _mm_set1_ps(2147483520.0f);
+  uint64 count = Count & ~(uint64)3;
+  for (uint64 i = 0; i < count; i += 4)
+  {
+    __m128 in = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pIn + i), minimum), maximum);
+    __m128 out = _mm_min_ps(nuiAudioConvert_Scale_SSE2(in, negative, positive), largest);
+    _mm_storeu_si128((__m128i*)(pOut + i), _mm_cvttps_epi32(out));
+  }
+  return count;
+}
+
+NUI_TARGET_AVX2 static uint64 nuiAudioConvert_FloatToInt32_AVX2(const float* pIn, int32* pOut, uint64 Count)
+{
+  const __m256 negative = _mm256_set1_ps(2147483648.0f);
+  const __m256 positive = _mm256_set1_ps(2147483647.0f);
+  const __m256 minimum = _mm256_set1_ps(-1.0f);
+  const __m256 maximum = _mm256_set1_ps(1.0f);
+  const __m256 largest = _mm256_set1_ps(2147483520.0f);
+  uint64 count = Count & ~(uint64)7;
+  for (uint64 i = 0; i < count; i += 8)
+  {
+    __m256 in = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pIn + i), minimum), maximum);
+    __m256 out = _mm256_min_ps(nuiAudioConvert_Scale_AVX2(in, negative, positive), largest);
+    _mm256_storeu_si256((__m256i*)(pOut + i), _mm256_cvttps_epi32(out));
+  }
+  return count;
+}
+
+// Stereo interleaving
+NUI_TARGET_SSE static uint32 nuiAudioConvert_DeinterleaveStereo_SSE(const float* pIn, float* pLeft, float* pRight, uint32 SampleFrames)
+{
+  uint32 count = SampleFrames & ~3;
+  for (uint32 i = 0; i < count; i += 4)
+  {
+    __m128 in0 = _mm_loadu_ps(pIn + 2 * i);
+    __m128 in1 = _mm_loadu_ps(pIn + 2 * i + 4);
+    _mm_storeu_ps(pLeft + i, _mm_shuffle_ps(in0, in1, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(pRight + i, _mm_shuffle_ps(in0, in1, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  return count;
+}
+
+NUI_TARGET_SSE static uint32 nuiAudioConvert_InterleaveStereo_SSE(const float* pLeft, const float* pRight, float* pOut, uint32 SampleFrames)
+{
+  uint32 count = SampleFrames & ~3;
+  for (uint32 i = 0; i < count; i += 4)
+  {
+    __m128 left = _mm_loadu_ps(pLeft + i);
+    __m128 right = _mm_loadu_ps(pRight + i);
+    _mm_storeu_ps(pOut + 2 * i, _mm_unpacklo_ps(left, right));
+    _mm_storeu_ps(pOut + 2 * i + 4, _mm_unpackhi_ps(left, right));
+  }
+  return count;
+}
+#endif
+
 
 void nuiAudioConvert_INint16ToDEfloat(const int16* input, float* output, uint32 curChannel, uint32 nbChannels, uint32 nbSampleFrames)
 {
   static const float mult1 = 1.0 / 32768.0f;
   static const float mult2 = 1.0 / 32767.0f;
-  uint32 j;
+  uint32 j = 0;
 
-  input += curChannel;
-  for (j = 0; j < nbSampleFrames; j++)
+#ifdef NUI_AUDIO_SIMD
+  if (nbChannels == 1)
+  {
+    if (nglCPUInfo::HasAVX2())
+      j = (uint32)nuiAudioConvert_Int16ToFloat_AVX2(input, output, nbSampleFrames, mult1, mult2);
+    else if (nglCPUInfo::HasSSE2())
+      j = (uint32)nuiAudioConvert_Int16ToFloat_SSE2(input, output, nbSampleFrames, mult1, mult2);
+  }
+  else if (nbChannels == 2)
+  {
+    if (nglCPUInfo::HasAVX2())
+      j = nuiAudioConvert_StereoInt16ToFloat_AVX2(input, output, curChannel, nbSampleFrames);
+    else if (nglCPUInfo::HasSSE2())
+      j = nuiAudioConvert_StereoInt16ToFloat_SSE2(input, output, curChannel, nbSampleFrames);
+  }
+  output += j;
+#endif
+
+  input += curChannel + j * nbChannels;
+  for (; j < nbSampleFrames; j++)
   {
     int16 in = *input;
 
@@ -35,10 +335,21 @@ void nuiAudioConvert_DEfloatToINint16(const float* input, int16* output, uint32
 {
   static const float mult1 = 32768.0f ;
   static const float mult2 = 32767.0f ;
-  uint32 j;
+  uint32 j = 0;
+
+#ifdef NUI_AUDIO_SIMD
+  if (nbChannels == 1)
+  {
+    if (nglCPUInfo::HasAVX2())
+      j = (uint32)nuiAudioConvert_FloatToInt16_AVX2(input, output, nbSampleFrames);
+    else if (nglCPUInfo::HasSSE2())
+      j = (uint32)nuiAudioConvert_FloatToInt16_SSE2(input, output, nbSampleFrames);
+  }
+  input += j;
+#endif
 
-  output += curChannel;
-  for (j=0; j < nbSampleFrames; j++)
+  output += curChannel + j * nbChannels;
+  for (; j < nbSampleFrames; j++)
   {
     float in = *input++;
     in = nuiClamp(in, -1.0f, 1.0f);
@@ -148,8 +459,14 @@ void nuiAudioConvert_16bitsBufferToFloat(float* pBuffer, uint64 SizeToRead)
   
   float Temp;
   
-  uint64 i;
-  for (i = 0; i< SizeToRead; i++)
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioConvert_Int16ToFloat_AVX2((int16*)pBuffer + SizeToRead, pBuffer, SizeToRead, mult1, mult2);
+  else if (nglCPUInfo::HasSSE2())
+    i = nuiAudioConvert_Int16ToFloat_SSE2((int16*)pBuffer + SizeToRead, pBuffer, SizeToRead, mult1, mult2);
+#endif
+  for (; i < SizeToRead; i++)
   {
     Temp = ((int16*)pBuffer)[ SizeToRead + i ];
     if (Temp < 0)
@@ -164,7 +481,14 @@ void nuiAudioConvert_FloatBufferTo16bits(float* pFloatBuffer, int16* pInt16Buffe
   static const float mult1 = 32768.0f;
   static const float mult2 = 32767.0f;
   float Temp;
-  for (uint64 i = 0; i< SizeToRead; i++)
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioConvert_FloatToInt16_AVX2(pFloatBuffer, pInt16Buffer, SizeToRead);
+  else if (nglCPUInfo::HasSSE2())
+    i = nuiAudioConvert_FloatToInt16_SSE2(pFloatBuffer, pInt16Buffer, SizeToRead);
+#endif
+  for (; i < SizeToRead; i++)
   {
     Temp = pFloatBuffer[i];
     Temp = nuiClamp(Temp, -1.0f, 1.0f);
@@ -207,6 +531,32 @@ float nuiAudioConvert_24bitsToFloatFromBigEndian(uint8* pBytesBuf)
   return 0.0;
 }
 
+void nuiAudioConvert_24bitsLittleEndianToFloat(const uint8* pInBuffer, float* pOutBuffer, uint64 SizeToRead)
+{
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioConvert_24bitsToFloat_AVX2(pInBuffer, pOutBuffer, SizeToRead, gAudioConvert_24LE);
+  else if (nglCPUInfo::HasSSSE3())
+    i = nuiAudioConvert_24bitsToFloat_SSSE3(pInBuffer, pOutBuffer, SizeToRead, gAudioConvert_24LE);
+#endif
+  for (; i < SizeToRead; i++)
+    pOutBuffer[i] = nuiAudioConvert_24bitsToFloatFromLittleEndian(const_cast<uint8*>(pInBuffer) + 3 * i);
+}
+
+void nuiAudioConvert_24bitsBigEndianToFloat(const uint8* pInBuffer, float* pOutBuffer, uint64 SizeToRead)
+{
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioConvert_24bitsToFloat_AVX2(pInBuffer, pOutBuffer, SizeToRead, gAudioConvert_24BE);
+  else if (nglCPUInfo::HasSSSE3())
+    i = nuiAudioConvert_24bitsToFloat_SSSE3(pInBuffer, pOutBuffer, SizeToRead, gAudioConvert_24BE);
+#endif
+  for (; i < SizeToRead; i++)
+    pOutBuffer[i] = nuiAudioConvert_24bitsToFloatFromBigEndian(const_cast<uint8*>(pInBuffer) + 3 * i);
+}
+
 //
 //nuiAudioConvert_FloatTo24bitsFromLittleEndian
 //
@@ -217,8 +567,12 @@ void nuiAudioConvert_FloatTo24bitsLittleEndian(float* pInBuffer, uint8* pOutBuff
   
   int32 TempInt32;
   
-  uint64 i;
-  for ( i = 0; i < SizeToRead; i++)
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasSSSE3())
+    i = nuiAudioConvert_FloatTo24bits_SSSE3(pInBuffer, pOutBuffer, SizeToRead, gAudioConvert_To24LE);
+#endif
+  for (; i < SizeToRead; i++)
   {
     float value = pInBuffer[i];
     value = nuiClamp(value, -1.0f, 1.0f);
@@ -249,8 +603,12 @@ void nuiAudioConvert_FloatTo24bitsBigEndian(float* pInBuffer, uint8* pOutBuffer,
   
   int32 TempInt32;
   
-  uint64 i;
-  for ( i = 0; i < SizeToRead; i++)
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasSSSE3())
+    i = nuiAudioConvert_FloatTo24bits_SSSE3(pInBuffer, pOutBuffer, SizeToRead, gAudioConvert_To24BE);
+#endif
+  for (; i < SizeToRead; i++)
   {
     float value = pInBuffer[i];
     value = nuiClamp(value, -1.0f, 1.0f);
@@ -277,15 +635,22 @@ void nuiAudioConvert_FloatTo32bits(float* pInBuffer, int32* pOutBuffer, uint64 S
 {
   static const float mult1 = 2147483648.0f ;
   static const float mult2 = 2147483647.0f ;
+  static const float largest = 2147483520.0f ; // 1.0f * mult2 rounds to 2^31, which is out of the int32 range
   
-  uint64 i;
-  for ( i = 0; i < SizeToRead; i++)
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioConvert_FloatToInt32_AVX2(pInBuffer, pOutBuffer, SizeToRead);
+  else if (nglCPUInfo::HasSSE2())
+    i = nuiAudioConvert_FloatToInt32_SSE2(pInBuffer, pOutBuffer, SizeToRead);
+#endif
+  for (; i < SizeToRead; i++)
   {
     float value = nuiClamp(pInBuffer[i], -1.0f, 1.0f);
     if (value < 0 )
       pOutBuffer[i] = ToZero(value * mult1);
     else
-      pOutBuffer[i] = ToZero(value * mult2);
+      pOutBuffer[i] = ToZero(MIN(value * mult2, largest));
   }  
 }
 
@@ -295,8 +660,14 @@ void nuiAudioConvert_32bitsToFloat(int32* pInBuffer, float* pOutBuffer, uint64 S
   static const float mult1 =  1.0 / 2147483648.0f ;
   static const float mult2 = 1.0 / 2147483647.0f ;
   
-  uint64 i;
-  for ( i = 0; i < SizeToRead; i++)
+  uint64 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioConvert_Int32ToFloat_AVX2(pInBuffer, pOutBuffer, SizeToRead);
+  else if (nglCPUInfo::HasSSE2())
+    i = nuiAudioConvert_Int32ToFloat_SSE2(pInBuffer, pOutBuffer, SizeToRead);
+#endif
+  for (; i < SizeToRead; i++)
   {
     if (pInBuffer[i] < 0)
       pOutBuffer[i] = pInBuffer[i] * mult1;
@@ -305,3 +676,145 @@ void nuiAudioConvert_32bitsToFloat(int32* pInBuffer, float* pOutBuffer, uint64 S
   }
 }
 
+
+void nuiAudioConvert_INfloatToDEfloat(const float* pInput, float* const* pOutputs, uint32 nbChannels, uint32 nbSampleFrames)
+{
+  uint32 j = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nbChannels == 2 && nglCPUInfo::HasSSE())
+    j = nuiAudioConvert_DeinterleaveStereo_SSE(pInput, pOutputs[0], pOutputs[1], nbSampleFrames);
+#endif
+  for (uint32 c = 0; c < nbChannels; c++)
+  {
+    const float* pIn = pInput + j * nbChannels + c;
+    float* pOut = pOutputs[c];
+    for (uint32 i = j; i < nbSampleFrames; i++, pIn += nbChannels)
+      pOut[i] = *pIn;
+  }
+}
+
+void nuiAudioConvert_DEfloatToINfloat(const float* const* pInputs, float* pOutput, uint32 nbChannels, uint32 nbSampleFrames)
+{
+  uint32 j = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nbChannels == 2 && nglCPUInfo::HasSSE())
+    j = nuiAudioConvert_InterleaveStereo_SSE(pInputs[0], pInputs[1], pOutput, nbSampleFrames);
+#endif
+  for (uint32 c = 0; c < nbChannels; c++)
+  {
+    const float* pIn = pInputs[c];
+    float* pOut = pOutput + j * nbChannels + c;
+    for (uint32 i = j; i < nbSampleFrames; i++, pOut += nbChannels)
+      *pOut = pIn[i];
+  }
+}
+
+
+//////////////////////////////////////
+// Mixing kernels
+// The SIMD versions process as many frames as they can and return that count, the scalar loop finishes the buffer.
+// The gain of each frame is computed as Gain + i * GainStep in all versions so that they give the same results.
+#ifdef NUI_AUDIO_SIMD
+NUI_TARGET_SSE static uint32 nuiAudioMix_AddRamp_SSE(float* pDst, const float* pSrc, float Gain, float GainStep, uint32 SampleFrames)
+{
+  const __m128 gain = _mm_set1_ps(Gain);
+  const __m128 step = _mm_set1_ps(GainStep);
+  const __m128 four = _mm_set1_ps(4.0f);
+  __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  uint32 count = SampleFrames & ~3;
+  for (uint32 i = 0; i < count; i += 4)
+  {
+    __m128 g = _mm_add_ps(gain, _mm_mul_ps(index, step));
+    _mm_storeu_ps(pDst + i, _mm_add_ps(_mm_loadu_ps(pDst + i), _mm_mul_ps(_mm_loadu_ps(pSrc + i), g)));
+    index = _mm_add_ps(index, four);
+  }
+  return count;
+}
+
+NUI_TARGET_AVX2 static uint32 nuiAudioMix_AddRamp_AVX2(float* pDst, const float* pSrc, float Gain, float GainStep, uint32 SampleFrames)
+{
+  const __m256 gain = _mm256_set1_ps(Gain);
+  const __m256 step = _mm256_set1_ps(GainStep);
+  const __m256 eight = _mm256_set1_ps(8.0f);
+  __m256 index = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+  uint32 count = SampleFrames & ~7;
+  for (uint32 i = 0; i < count; i += 8)
+  {
+    __m256 g = _mm256_add_ps(gain, _mm256_mul_ps(index, step));
+    _mm256_storeu_ps(pDst + i, _mm256_add_ps(_mm256_loadu_ps(pDst + i), _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), g)));
+    index = _mm256_add_ps(index, eight);
+  }
+  return count;
+}
+
+NUI_TARGET_SSE static uint32 nuiAudioMix_Add_SSE(float* pDst, const float* pSrc, float Gain, uint32 SampleFrames)
+{
+  const __m128 gain = _mm_set1_ps(Gain);
+  uint32 count = SampleFrames & ~3;
+  for (uint32 i = 0; i < count; i += 4)
+    _mm_storeu_ps(pDst + i, _mm_add_ps(_mm_loadu_ps(pDst + i), _mm_mul_ps(_mm_loadu_ps(pSrc + i), gain)));
+  return count;
+}
+
+NUI_TARGET_AVX2 static uint32 nuiAudioMix_Add_AVX2(float* pDst, const float* pSrc, float Gain, uint32 SampleFrames)
+{
+  const __m256 gain = _mm256_set1_ps(Gain);
+  uint32 count = SampleFrames & ~7;
+  for (uint32 i = 0; i < count; i += 8)
+    _mm256_storeu_ps(pDst + i, _mm256_add_ps(_mm256_loadu_ps(pDst + i), _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), gain)));
+  return count;
+}
+
+NUI_TARGET_SSE static uint32 nuiAudioMix_MultiplyRamp_SSE(float* pBuffer, float Gain, float GainStep, uint32 SampleFrames)
+{
+  const __m128 gain = _mm_set1_ps(Gain);
+  const __m128 step = _mm_set1_ps(GainStep);
+  const __m128 four = _mm_set1_ps(4.0f);
+  __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  uint32 count = SampleFrames & ~3;
+  for (uint32 i = 0; i < count; i += 4)
+  {
+    __m128 g = _mm_add_ps(gain, _mm_mul_ps(index, step));
+    _mm_storeu_ps(pBuffer + i, _mm_mul_ps(_mm_loadu_ps(pBuffer + i), g));
+    index = _mm_add_ps(index, four);
+  }
+  return count;
+}
+#endif
+
+void nuiAudioMix_Add(float* pDst, const float* pSrc, float Gain, uint32 SampleFrames)
+{
+  uint32 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioMix_Add_AVX2(pDst, pSrc, Gain, SampleFrames);
+  else if (nglCPUInfo::HasSSE())
+    i = nuiAudioMix_Add_SSE(pDst, pSrc, Gain, SampleFrames);
+#endif
+  for (; i < SampleFrames; i++)
+    pDst[i] += pSrc[i] * Gain;
+}
+
+void nuiAudioMix_AddRamp(float* pDst, const float* pSrc, float Gain, float GainStep, uint32 SampleFrames)
+{
+  uint32 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    i = nuiAudioMix_AddRamp_AVX2(pDst, pSrc, Gain, GainStep, SampleFrames);
+  else if (nglCPUInfo::HasSSE())
+    i = nuiAudioMix_AddRamp_SSE(pDst, pSrc, Gain, GainStep, SampleFrames);
+#endif
+  for (; i < SampleFrames; i++)
+    pDst[i] += pSrc[i] * (Gain + (float)i * GainStep);
+}
+
+void nuiAudioMix_MultiplyRamp(float* pBuffer, float Gain, float GainStep, uint32 SampleFrames)
+{
+  uint32 i = 0;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasSSE())
+    i = nuiAudioMix_MultiplyRamp_SSE(pBuffer, Gain, GainStep, SampleFrames);
+#endif
+  for (; i < SampleFrames; i++)
+    pBuffer[i] *= Gain + (float)i * GainStep;
+}
@@ -188,11 +188,15 @@ nuiAudioDevice* nuiAudioDeviceManager::GetDeviceWithNameAndAPI(const nglString&
 
 nuiAudioDevice* nuiAudioDeviceManager::GetDefaultOutputDevice()
 {
+  if (mAPIs.empty())
+    return NULL;
   return mAPIs.begin()->second->GetDefaultOutputDevice();
 }
 
 nuiAudioDevice* nuiAudioDeviceManager::GetDefaultInputDevice()
 {
+  if (mAPIs.empty())
+    return NULL;
   return mAPIs.begin()->second->GetDefaultInputDevice();
 }
 
@@ -237,8 +241,10 @@ void nuiAudioDeviceManager::RegisterAPIS()
   AudioUnitAPI.RegisterWithManager(*this);
 }
 #else
+#include "nuiAudioDevice_Null.h"
 void nuiAudioDeviceManager::RegisterAPIS()
 {
+  NullAudioAPI.RegisterWithManager(*this);
 }
 #endif
 
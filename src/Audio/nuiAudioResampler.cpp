@@ -0,0 +1,276 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiAudioResampler.h"
+
+#if (defined _NGL_X86_) || (defined _NGL_X64_)
+  #define NUI_AUDIO_SIMD
+  #include <xmmintrin.h>
+  #include <immintrin.h>
+  #ifdef __GNUC__
+    #define NUI_TARGET_SSE  __attribute__((target("sse")))
+    #define NUI_TARGET_AVX2 __attribute__((target("avx2")))
+  #else
+    #define NUI_TARGET_SSE
+    #define NUI_TARGET_AVX2
+  #endif
+#endif
+
+// Filter parameters of each quality: length of each side of the filter in output sample frames, stop band attenuation
+// (dB) and number of phases
+static const struct
+{
+  uint32 mHalfLength;
+  double mAttenuation;
+  uint32 mPhases;
+} gSincQualities[] =
+{
+  { 16, 80.0, 128 },
+  { 32, 100.0, 256 },
+  { 64, 120.0, 512 }
+};
+
+static double nuiBesselI0(double x)
+{
+  double sum = 1.0;
+  double term = 1.0;
+  double x2 = x * x * 0.25;
+  for (int k = 1; k < 64 && term > sum * 1e-17; k++)
+  {
+    term *= x2 / ((double)k * (double)k);
+    sum += term;
+  }
+  return sum;
+}
+
+// Filter kernels: the output sample is the dot product of the history with the two closest phases, interpolated linearly
+#ifdef NUI_AUDIO_SIMD
+NUI_TARGET_SSE static float nuiAudioSinc_Dot_SSE(const float* pX, const float* pRow0, const float* pRow1, float Fraction, uint32 Taps)
+{
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  for (uint32 i = 0; i < Taps; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(pX + i);
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(x, _mm_loadu_ps(pRow0 + i)));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(x, _mm_loadu_ps(pRow1 + i)));
+  }
+  __m128 sum = _mm_add_ps(sum0, _mm_mul_ps(_mm_sub_ps(sum1, sum0), _mm_set1_ps(Fraction)));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+NUI_TARGET_AVX2 static float nuiAudioSinc_Dot_AVX2(const float* pX, const float* pRow0, const float* pRow1, float Fraction, uint32 Taps)
+{
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  for (uint32 i = 0; i < Taps; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(pX + i);
+    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(x, _mm256_loadu_ps(pRow0 + i)));
+    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(x, _mm256_loadu_ps(pRow1 + i)));
+  }
+  __m256 sum8 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_sub_ps(sum1, sum0), _mm256_set1_ps(Fraction)));
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+#endif
+
+static float nuiAudioSinc_Dot(const float* pX, const float* pRow0, const float* pRow1, float Fraction, uint32 Taps)
+{
+  float sum0 = 0;
+  float sum1 = 0;
+  for (uint32 i = 0; i < Taps; i++)
+  {
+    sum0 += pX[i] * pRow0[i];
+    sum1 += pX[i] * pRow1[i];
+  }
+  return sum0 + (sum1 - sum0) * Fraction;
+}
+
+
+nuiAudioSincResampler::nuiAudioSincResampler(double InputRate, double OutputRate, Quality quality)
+: mInputRate(InputRate),
+  mOutputRate(OutputRate),
+  mStep(1),
+  mQuality(quality),
+  mTaps(0),
+  mPhases(0),
+  mHistoryStart(0),
+  mInputFrames(0),
+  mOutputFrames(0)
+{
+  Design();
+}
+
+nuiAudioSincResampler::~nuiAudioSincResampler()
+{
+}
+
+void nuiAudioSincResampler::SetRates(double InputRate, double OutputRate)
+{
+  mInputRate = InputRate;
+  mOutputRate = OutputRate;
+  Design();
+}
+
+double nuiAudioSincResampler::GetInputRate() const
+{
+  return mInputRate;
+}
+
+double nuiAudioSincResampler::GetOutputRate() const
+{
+  return mOutputRate;
+}
+
+void nuiAudioSincResampler::SetQuality(Quality quality)
+{
+  mQuality = quality;
+  Design();
+}
+
+nuiAudioSincResampler::Quality nuiAudioSincResampler::GetQuality() const
+{
+  return mQuality;
+}
+
+uint32 nuiAudioSincResampler::GetLatency() const
+{
+  return mTaps / 2;
+}
+
+uint32 nuiAudioSincResampler::GetMaxOutputFrames(uint32 InputFrames) const
+{
+  return (uint32)ceil(InputFrames / mStep) + 1;
+}
+
+void nuiAudioSincResampler::Design()
+{
+  NGL_ASSERT(mInputRate > 0 && mOutputRate > 0);
+  mStep = mInputRate / mOutputRate;
+
+  // The filter is designed in input sample frames. When downsampling it is stretched to cut at the output Nyquist frequency.
+  const double scale = MIN(1.0, mOutputRate / mInputRate);
+  const double halflength = gSincQualities[mQuality].mHalfLength;
+  const double attenuation = gSincQualities[mQuality].mAttenuation;
+  const double beta = 0.1102 * (attenuation - 8.7);
+  // Kaiser's estimation of the transition band of the window, centered under the Nyquist frequency
+  const double transition = (attenuation - 8.0) / (2.285 * M_PI * 2.0 * halflength);
+  const double cutoff = (1.0 - transition * 0.5) * scale;
+  const double width = halflength / scale;
+
+  mTaps = 2 * ((uint32)ceil(width) + 1);
+  mTaps = (mTaps + 7) & ~7;
+  mPhases = gSincQualities[mQuality].mPhases;
+
+  // Tap j of phase p is the kernel at the distance between the output and the input sample frame
+  const double i0beta = nuiBesselI0(beta);
+  const int32 center = mTaps / 2 - 1;
+  mFilter.resize((mPhases + 1) * mTaps);
+  for (uint32 p = 0; p <= mPhases; p++)
+  {
+    float* pRow = &mFilter[p * mTaps];
+    double sum = 0;
+    for (uint32 j = 0; j < mTaps; j++)
+    {
+      double x = (double)p / (double)mPhases + center - (int32)j;
+      double value = 0;
+      if (fabs(x) < width)
+      {
+        double r = x / width;
+        double window = nuiBesselI0(beta * sqrt(1.0 - r * r)) / i0beta;
+        double y = M_PI * cutoff * x;
+        value = cutoff * window * ((fabs(y) < 1e-9) ? 1.0 : sin(y) / y);
+      }
+      pRow[j] = (float)value;
+      sum += value;
+    }
+
+    // Unity gain at DC for each phase
+    for (uint32 j = 0; j < mTaps; j++)
+      pRow[j] = (float)(pRow[j] / sum);
+  }
+
+  Reset();
+}
+
+void nuiAudioSincResampler::Reset()
+{
+  // The stream is preceded by silence so that the first output sample frame is aligned with the first input one
+  mHistory.clear();
+  mHistory.resize(mTaps / 2 - 1, 0.0f);
+  mHistoryStart = 0;
+  mInputFrames = 0;
+  mOutputFrames = 0;
+}
+
+uint32 nuiAudioSincResampler::Resample(float* pOutput, uint64 MaxFrames)
+{
+  typedef float (*DotFunction)(const float*, const float*, const float*, float, uint32);
+  DotFunction pDot = nuiAudioSinc_Dot;
+#ifdef NUI_AUDIO_SIMD
+  if (nglCPUInfo::HasAVX2())
+    pDot = nuiAudioSinc_Dot_AVX2;
+  else if (nglCPUInfo::HasSSE())
+    pDot = nuiAudioSinc_Dot_SSE;
+#endif
+
+  const uint64 end = mHistoryStart + mHistory.size();
+  uint32 done = 0;
+  while (mOutputFrames < MaxFrames)
+  {
+    // The position is computed from the frame count so that the errors don't add up over long streams
+    double position = (double)mOutputFrames * mStep;
+    uint64 first = (uint64)position;
+    if (first + mTaps > end)
+      break;
+
+    double phase = (position - (double)first) * mPhases;
+    uint32 row = MIN((uint32)phase, mPhases - 1);
+    const float* pRow0 = &mFilter[row * mTaps];
+    pOutput[done++] = pDot(&mHistory[first - mHistoryStart], pRow0, pRow0 + mTaps, (float)(phase - row), mTaps);
+    mOutputFrames++;
+  }
+
+  // Drop the input that the next output sample frames don't need
+  uint64 first = (uint64)((double)mOutputFrames * mStep);
+  if (first > mHistoryStart)
+  {
+    uint64 drop = MIN(first, end) - mHistoryStart;
+    mHistory.erase(mHistory.begin(), mHistory.begin() + drop);
+    mHistoryStart += drop;
+  }
+
+  return done;
+}
+
+uint32 nuiAudioSincResampler::Process(const float* pInput, uint32 InputFrames, float* pOutput)
+{
+  mHistory.insert(mHistory.end(), pInput, pInput + InputFrames);
+  mInputFrames += InputFrames;
+  return Resample(pOutput, (uint64)-1);
+}
+
+uint32 nuiAudioSincResampler::Flush(float* pOutput)
+{
+  // Output the sample frames up to the end of the input, with silence after it
+  uint64 last = (uint64)ceil((double)mInputFrames / mStep);
+  while (last > 0 && (double)(last - 1) * mStep >= (double)mInputFrames)
+    last--;
+  while ((double)last * mStep < (double)mInputFrames)
+    last++;
+
+  mHistory.resize(mHistory.size() + mTaps / 2 + 1, 0.0f);
+  uint32 done = Resample(pOutput, last);
+  Reset();
+  return done;
+}
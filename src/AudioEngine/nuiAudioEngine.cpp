@@ -8,6 +8,7 @@
 
 #include "nui.h"
 #include "nuiAudioEngine.h"
+#include "nuiAudioConvert.h"
 
 //#define AUDIO_LOG
 //#define AUDIO_PROFILE
@@ -18,30 +19,66 @@
 nuiAudioEngine::nuiAudioEngine(double SampleRate, uint32 BufferSize, ChannelConfig inputConfig)
 : mSampleRate(SampleRate),
   mBufferSize(BufferSize),
+  mGain(1.f),
+  mMute(false),
+  mPan(0),
+  mPlaying(true),
+  mpOutAudioDevice(NULL),
+  mpInAudioDevice(NULL),
   mInputDelegateSet(false),
   mOutputDelegateSet(false),
+  mCs(_T("nuiAudioEngineCriticalSection")),
+  mCommands(QueueSize),
+  mFinishedVoices(QueueSize),
+  mMixFrames(0)
+{  
+  if (SetObjectClass(_T("nuiAudioEngine")))
+    InitAttributes();
+  
+  mVoices.reserve(MaxVoices);
+  AudioInit(inputConfig);
+}
+
+nuiAudioEngine::nuiAudioEngine(nuiAudioDevice* pOutputDevice, double SampleRate, uint32 BufferSize)
+: mSampleRate(SampleRate),
+  mBufferSize(BufferSize),
   mGain(1.f),
   mMute(false),
   mPan(0),
   mPlaying(true),
-  mCs(_T("nuiAudioEngineCriticalSection"))
+  mpOutAudioDevice(pOutputDevice),
+  mpInAudioDevice(NULL),
+  mInputDelegateSet(false),
+  mOutputDelegateSet(false),
+  mCs(_T("nuiAudioEngineCriticalSection")),
+  mCommands(QueueSize),
+  mFinishedVoices(QueueSize),
+  mMixFrames(0)
 {  
   if (SetObjectClass(_T("nuiAudioEngine")))
     InitAttributes();
   
-  mpOutAudioDevice = NULL;
-  mpInAudioDevice = NULL;
-  AudioInit(inputConfig);
+  mVoices.reserve(MaxVoices);
+  ActivateOutputDevice();
 }
 
 nuiAudioEngine::~nuiAudioEngine()
 {  
+  // Stop the audio thread before releasing the voices
   delete mpOutAudioDevice;
   delete mpInAudioDevice;
   
   for (uint32 i = 0; i < mVoices.size(); i++)
     mVoices[i]->Release();
   
+  while (mCommands.CanRead())
+  {
+    Command command = mCommands.Get();
+    if (command.mType == Command::eAddVoice)
+      command.mpVoice->Release();
+  }
+  
+  ReleaseFinishedVoices();
 }
 
 void nuiAudioEngine::InitAttributes()
@@ -81,6 +118,11 @@ void nuiAudioEngine::InitAttributes()
 bool nuiAudioEngine::AudioInit(ChannelConfig inputConfig)
 {
   mpOutAudioDevice = nuiAudioDeviceManager::Get().GetDefaultOutputDevice();
+  if (!mpOutAudioDevice)
+  {
+    NGL_OUT(_T("No audio output device\n"));
+    return false;
+  }
 
   NGL_OUT(_T("Default output: %ls\n"), mpOutAudioDevice->GetName().GetChars());
 
@@ -113,10 +155,14 @@ void nuiAudioEngine::DeactivateInputDevice()
 
 bool nuiAudioEngine::ActivateOutputDevice()
 {
+  if (!mpOutAudioDevice)
+    return false;
+  
   std::vector<uint32> InputChannels;
   std::vector<uint32> OutputChannels;
   OutputChannels.push_back(0);
   OutputChannels.push_back(1);
+  AllocateBuffers(OutputChannels.size(), mBufferSize);
   bool res = mpOutAudioDevice->Open(InputChannels, OutputChannels, mSampleRate, mBufferSize, nuiMakeDelegate(this, &nuiAudioEngine::ProcessAudioOutput));
   return res;
 }
@@ -174,106 +220,139 @@ void nuiAudioEngine::UnsetOutputProcessDelegate()
 }
 
 
-void nuiAudioEngine::ProcessAudioOutput(const std::vector<const float*>& rInput, const std::vector<float*>& rOutput, uint32 SampleFrames)
+void nuiAudioEngine::AllocateBuffers(uint32 Channels, uint32 SampleFrames)
 {
-#ifdef AUDIO_PROFILE
-  double beginTime = nglTime();
-  {
-#endif
-
-  std::vector<nuiVoice*> voicesToAdd;
-  std::vector<nuiVoice*> voicesToRemove;
-  mCs.Lock();
-  voicesToAdd = mAddVoicesQueue;
-  mAddVoicesQueue.clear();
+  // Make sure the CPU features used by the mix kernels are known before the audio thread needs them
+  nglCPUInfo::HasSSE();
   
-  voicesToRemove = mRemoveVoicesQueue;
-  mRemoveVoicesQueue.clear();
-  mCs.Unlock();
+  mMixFrames = SampleFrames;
+  mMixBuffer.resize(Channels * SampleFrames);
+  mMixBuffers.resize(Channels);
+  for (uint32 c = 0; c < Channels; c++)
+    mMixBuffers[c] = &mMixBuffer[c * SampleFrames];
+  mLastGains.resize(Channels, 0.f);
+}
+
+bool nuiAudioEngine::PostCommand(Command::Type type, nuiVoice* pVoice)
+{
+  nglCriticalSectionGuard guard(mCs);
+  if (!mCommands.CanWrite())
+    return false;
   
-  for (uint32 i = 0; i < voicesToRemove.size(); i++)
+  Command command;
+  command.mType = type;
+  command.mpVoice = pVoice;
+  mCommands.Put(command);
+  return true;
+}
+
+void nuiAudioEngine::ProcessCommands()
+{
+  // Each command may send a voice to the finished queue, so it is only taken when there is room there. The voice
+  // capacity only concerns the new voices: removals are always drained so that they can make room.
+  while (mCommands.CanRead() && mFinishedVoices.CanWrite())
   {
-    nuiVoice* pVoiceToRemove = voicesToRemove[i];
-    std::vector<nuiVoice*>::iterator it = mVoices.begin();
-    std::vector<nuiVoice*>::iterator end = mVoices.end();
-    while (it != end)
+    Command command = mCommands.Get();
+    if (command.mType == Command::eAddVoice)
+    {
+      if (mVoices.size() < MaxVoices)
+        mVoices.push_back(command.mpVoice);
+      else
+        mFinishedVoices.Put(command.mpVoice); // No room left: the voice is dropped without having been played
+    }
+    else
     {
-      nuiVoice* pCurrent = *it;
-      if (pCurrent == pVoiceToRemove)
+      for (uint32 i = 0; i < mVoices.size(); i++)
       {
-        mVoices.erase(it);
-        pCurrent->Release();
-        break;
+        if (mVoices[i] == command.mpVoice)
+        {
+          RemoveVoice(i);
+          break;
+        }
       }
-      ++it;
     }
   }
+}
+
+void nuiAudioEngine::RemoveVoice(uint32 index)
+{
+  // The voice is released by the other threads, the order of the voices doesn't matter
+  mFinishedVoices.Put(mVoices[index]);
+  mVoices[index] = mVoices.back();
+  mVoices.pop_back();
+}
+
+void nuiAudioEngine::ReleaseFinishedVoices()
+{
+  nglCriticalSectionGuard guard(mCs);
+  while (mFinishedVoices.CanRead())
+    mFinishedVoices.Get()->Release();
+}
+
+void nuiAudioEngine::Mix(const std::vector<float*>& rOutput, uint32 Offset, uint32 SampleFrames)
+{
+  uint32 channels = MIN(rOutput.size(), mMixBuffers.size());
+  for (uint32 c = 0; c < mMixBuffers.size(); c++)
+    memset(mMixBuffers[c], 0, SampleFrames * sizeof(float));
   
-  for (uint32 i = 0; i < voicesToAdd.size(); i++)
-    mVoices.push_back(voicesToAdd[i]);
+  for (uint32 i = 0 ; i < mVoices.size(); i++)
+    mVoices[i]->Process(mMixBuffers, SampleFrames);
   
-  uint32 channels = rOutput.size();
+  float gain = mMute ? 0.f : MAX(mGain, 0.f);
+  float pan = mPan;
+  pan = MIN(pan, 1.0);
+  pan = MAX(pan, -1.0);
+  float panLeft = MIN(1.0, 1.0 - pan);
+  float panRight = MIN(1.0, 1.0 + pan);
   for (uint32 c = 0; c < channels; c++)
   {
-    memset(&rOutput[c][0], 0, sizeof(float) * SampleFrames);
+    // Ramp the gain changes over the buffer to avoid clicks
+    float target = gain * (c == 0 ? panLeft : panRight);
+    float last = mLastGains[c];
+    if (target == last)
+      nuiAudioMix_Add(rOutput[c] + Offset, mMixBuffers[c], target, SampleFrames);
+    else
+      nuiAudioMix_AddRamp(rOutput[c] + Offset, mMixBuffers[c], last, (target - last) / (float)SampleFrames, SampleFrames);
+    mLastGains[c] = target;
   }
-    
-  
-  if (!mPlaying)
-    return;
+}
+
+void nuiAudioEngine::ProcessAudioOutput(const std::vector<const float*>& rInput, const std::vector<float*>& rOutput, uint32 SampleFrames)
+{
+#ifdef AUDIO_PROFILE
+  double beginTime = nglTime();
+  {
+#endif
+
+  ProcessCommands();
   
-  std::vector<float*> buffers;
+  uint32 channels = rOutput.size();
   for (uint32 c = 0; c < channels; c++)
   {
-    float* pBuffer = new float[SampleFrames];
-    memset(pBuffer, 0, SampleFrames * sizeof(float));
-    buffers.push_back(pBuffer);
+    memset(&rOutput[c][0], 0, sizeof(float) * SampleFrames);
   }
     
   
-  for (uint32 i = 0 ; i < mVoices.size(); i++)
-  {
-    nuiVoice* pVoice = mVoices[i];
-    pVoice->Process(buffers, SampleFrames);
-  }
-  
+  if (!mPlaying)
+    return;
   
-  if (!mMute && mGain > 0)
-  {
-    float pan = mPan;
-    pan = MIN(pan, 1.0);
-    pan = MAX(pan, -1.0);
-    float panLeft = MIN(1.0, 1.0 - pan);
-    float panRight = MIN(1.0, 1.0 + pan);
-    for (uint32 c = 0; c < channels; c++)
-    {
-      float* pDst = rOutput[c];
-      float* pSrc = buffers[c];
-      float mult = mGain * (c == 0 ? panLeft : panRight);
-      for (uint32 i = 0; i < SampleFrames; i++)
-        *pDst++ += (*pSrc++) * mult;
-    }
-  }
+  // The mix buffers have the size the device was opened with: larger buffers are mixed in several passes
+  for (uint32 done = 0; done < SampleFrames && mMixFrames; done += mMixFrames)
+    Mix(rOutput, done, MIN(mMixFrames, SampleFrames - done));
   
   if (mOutputDelegateSet)
     mOutputDelegate(rOutput, SampleFrames);
   
 
-  std::vector<nuiVoice*>::iterator it = mVoices.begin();
+  // Send the voices that are done and only owned by the engine back to be released
   uint32 index = 0;
-  while (it != mVoices.end())
+  while (index < mVoices.size())
   {
-    nuiVoice* pVoice = *it;
-    if (pVoice->IsDone() == pVoice->GetRefCount() == 1)
-    {
-      mVoices.erase(it);
-      it = mVoices.begin() + index;
-      pVoice->Release();
-      continue;
-    }
-      
-    ++it;
-    ++index;
+    nuiVoice* pVoice = mVoices[index];
+    if (pVoice->IsDone() && pVoice->GetRefCount() == 1 && mFinishedVoices.CanWrite())
+      RemoveVoice(index);
+    else
+      ++index;
   }
   
 #ifdef AUDIO_LOG
@@ -293,19 +372,12 @@ void nuiAudioEngine::ProcessAudioOutput(const std::vector<const float*>& rInput,
   }
 #endif
   
-  
-  for (uint32 c = 0; c < channels; c++)
-    delete[] buffers[c];
-
-    
 #ifdef AUDIO_PROFILE
     }
     double endTime = nglTime();
     double diff = endTime - beginTime;
     NGL_OUT(_T("AUDIO_PROFILE [%.2f] : %.3fms\n"), endTime, diff * 1000.f);
 #endif
-    
-   
 }
 
 void nuiAudioEngine::ProcessAudioInput(const std::vector<const float*>& rInput, const std::vector<float*>& rOutput, uint32 SampleFrames)
@@ -324,19 +396,25 @@ nuiVoice* nuiAudioEngine::PlaySound(const nglPath& path, nuiSound::Type type)
 
 nuiVoice* nuiAudioEngine::PlaySound(nuiSound* pSound)
 {
-  nuiVoice* pVoice = pSound->GetVoice();
+  ReleaseFinishedVoices();
   
-  nglCriticalSectionGuard guard(mCs);
+  nuiVoice* pVoice = pSound->GetVoice();
+  pVoice->PrepareBuffers(MAX(mMixFrames, mBufferSize));
   pVoice->Acquire();
-  mAddVoicesQueue.push_back(pVoice);
+  if (!PostCommand(Command::eAddVoice, pVoice))
+  {
+    pVoice->Release();
+    return NULL;
+  }
   return pVoice;
 }
 
 void nuiAudioEngine::StopSound(nuiVoice* pVoice)
 {
-  nglCriticalSectionGuard guard(mCs);
+  ReleaseFinishedVoices();
   
-  mRemoveVoicesQueue.push_back(pVoice);
+  if (!PostCommand(Command::eRemoveVoice, pVoice))
+    pVoice->Pause(); // The queue is full: at least make it silent
 }
 
 
@@ -0,0 +1,408 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "nuiAudioStreamer.h"
+
+//class nuiAudioStream
+nuiAudioStream::nuiAudioStream(nglIStream* pStream, nuiSampleReader* pReader, const nuiSampleInfo& rInfo, uint32 PrefetchFrames)
+: mpStream(pStream),
+  mpReader(pReader),
+  mChannels(rInfo.GetChannels()),
+  mSampleFrames(rInfo.GetSampleFrames()),
+  mBuffer(PrefetchFrames, sizeof(float), rInfo.GetChannels()),
+  mSourcePosition(0),
+  mServedSeekRequests(0),
+  mFramesSinceSeek(0),
+  mReadPosition(0),
+  mSkipFrames(0),
+  mSeekPosition(0),
+  mAppliedSeekRequests(0),
+  mSeekDone(true),
+  mRequestedSeekPosition(0),
+  mSeekRequests(0),
+  mSeekServed(0),
+  mSeekWriteIndex(0),
+  mLoop(false),
+  mUnderruns(0),
+  mUnderrunFrames(0)
+{
+  mWritePointers.resize(mChannels);
+  mpReader->SetPosition(0);
+  mFramesSinceSeek = GetPrefetchSize();
+}
+
+nuiAudioStream::~nuiAudioStream()
+{
+  delete mpReader;
+  delete mpStream;
+}
+
+uint32 nuiAudioStream::GetChannels() const
+{
+  return mChannels;
+}
+
+int64 nuiAudioStream::GetSampleFrames() const
+{
+  return mSampleFrames;
+}
+
+uint32 nuiAudioStream::GetPrefetchedFrames() const
+{
+  return mBuffer.GetReadable();
+}
+
+uint32 nuiAudioStream::GetPrefetchSize() const
+{
+  return mBuffer.GetSize() - 1;
+}
+
+uint32 nuiAudioStream::GetUnderruns() const
+{
+  return ngl_atomic_read(mUnderruns);
+}
+
+uint32 nuiAudioStream::GetUnderrunFrames() const
+{
+  return ngl_atomic_read(mUnderrunFrames);
+}
+
+void nuiAudioStream::SetLoop(bool Loop)
+{
+  mLoop = Loop;
+}
+
+uint32 nuiAudioStream::Preroll(uint32 SampleFrames)
+{
+  return Fill(SampleFrames);
+}
+
+void nuiAudioStream::Skip()
+{
+  while (mSkipFrames > 0)
+  {
+    uint32 todo = (uint32)MIN(mSkipFrames, (int64)mBuffer.GetReadableToEnd());
+    if (!todo)
+      return;
+
+    mSeekDone = true;
+    mBuffer.AdvanceReadIndex(todo);
+    mReadPosition += todo;
+    mSkipFrames -= todo;
+  }
+}
+
+uint32 nuiAudioStream::Read(const std::vector<float*>& rOutput, int64 Position, uint32 SampleFrames)
+{
+  if (Position >= mSampleFrames)
+    return 0;
+
+  uint32 todo = (uint32)MIN((int64)SampleFrames, mSampleFrames - Position);
+  uint32 channels = MIN((uint32)rOutput.size(), mChannels);
+
+  uint32 served = ngl_atomic_read(mSeekServed);
+  bool seeking = (served != ngl_atomic_read(mSeekRequests));
+  bool catchup = false;
+  if (!seeking && served != mAppliedSeekRequests)
+  {
+    // The streamer moved the reader: the samples it wrote before doing so are stale
+    ngl_atomic_barrier();
+    mBuffer.SetReadIndex(ngl_atomic_read(mSeekWriteIndex));
+    mReadPosition = mSeekPosition;
+    mSkipFrames = 0;
+    mAppliedSeekRequests = served;
+    catchup = true;
+  }
+
+  if (!seeking)
+  {
+    int64 expected = mReadPosition + mSkipFrames;
+    if (Position == 0 && expected == mSampleFrames && mLoop)
+    {
+      // Looping: the end of the file is followed by its beginning
+      mReadPosition -= mSampleFrames;
+      expected = 0;
+    }
+
+    int64 delta = Position - expected;
+    if (delta > 0 && (delta <= (int64)mBuffer.GetReadable() || (catchup && delta < (int64)mBuffer.GetSize())))
+    {
+      // The position is already prefetched, or the play cursor went on while the streamer was seeking: drop the samples
+      // in between as they arrive
+      mSkipFrames += delta;
+    }
+    else if (delta != 0)
+    {
+      // Drop what is prefetched right away to leave room for the new position
+      mBuffer.SetReadIndex(mBuffer.GetWriteIndex());
+      mSeekPosition = Position;
+      ngl_atomic_inc(mSeekRequests);
+      ngl_atomic_barrier();
+      mRequestedSeekPosition = Position;
+      ngl_atomic_barrier();
+      ngl_atomic_inc(mSeekRequests);
+      mSeekDone = false;
+      seeking = true;
+    }
+  }
+
+  uint32 done = 0;
+  if (!seeking)
+  {
+    Skip();
+
+    while (!mSkipFrames && done < todo)
+    {
+      uint32 count = MIN(todo - done, mBuffer.GetReadableToEnd());
+      if (!count)
+        break;
+
+      ngl_atomic_barrier();
+      for (uint32 c = 0; c < channels; c++)
+        memcpy(rOutput[c] + done, mBuffer.GetReadPointer(c), count * sizeof(float));
+      mBuffer.AdvanceReadIndex(count);
+      mReadPosition += count;
+      done += count;
+      mSeekDone = true;
+    }
+  }
+
+  if (done < todo)
+  {
+    for (uint32 c = 0; c < channels; c++)
+      memset(rOutput[c] + done, 0, (todo - done) * sizeof(float));
+
+    if (!seeking)
+    {
+      // Keep going in time, the missed samples will be dropped when they arrive
+      mSkipFrames += todo - done;
+    }
+
+    if (!seeking && mSeekDone)
+    {
+      ngl_atomic_inc(mUnderruns);
+      ngl_atomic_add(mUnderrunFrames, todo - done);
+      ngl_atomic_inc(nuiAudioStreamer::Instance.mUnderruns);
+      ngl_atomic_add(nuiAudioStreamer::Instance.mUnderrunFrames, todo - done);
+    }
+  }
+
+  return todo;
+}
+
+bool nuiAudioStream::HandleSeek()
+{
+  uint32 requests = ngl_atomic_read(mSeekRequests);
+  if (requests == mServedSeekRequests)
+    return true;
+  if (requests & 1)
+    return false; // The position is being written
+
+  ngl_atomic_barrier();
+  int64 position = mRequestedSeekPosition;
+  ngl_atomic_barrier();
+  if (ngl_atomic_read(mSeekRequests) != requests)
+    return false;
+
+  mpReader->SetPosition((uint32)position);
+  mSourcePosition = position;
+  ngl_atomic_set(mSeekWriteIndex, mBuffer.GetWriteIndex());
+  ngl_atomic_barrier();
+  mServedSeekRequests = requests;
+  mFramesSinceSeek = 0;
+  ngl_atomic_set(mSeekServed, requests);
+  return true;
+}
+
+bool nuiAudioStream::IsSeeking(uint32 ChunkFrames) const
+{
+  // Until the audio thread drops the stale samples there may be little room for the new ones
+  return ngl_atomic_read(mSeekRequests) != mServedSeekRequests || mFramesSinceSeek < ChunkFrames;
+}
+
+bool nuiAudioStream::NeedsData(uint32 MinFrames) const
+{
+  if (IsSeeking(MinFrames))
+    return true;
+
+  if (mSourcePosition >= mSampleFrames && !mLoop)
+    return false;
+
+  return mBuffer.GetWritable() >= MIN(MinFrames, GetPrefetchSize());
+}
+
+uint32 nuiAudioStream::Fill(uint32 MaxFrames)
+{
+  if (!HandleSeek())
+    return 0;
+
+  uint32 done = 0;
+  while (done < MaxFrames)
+  {
+    if (mSourcePosition >= mSampleFrames)
+    {
+      if (!mLoop)
+        break;
+
+      mpReader->SetPosition(0);
+      mSourcePosition = 0;
+    }
+
+    uint32 todo = MIN(MaxFrames - done, mBuffer.GetWritableToEnd());
+    todo = (uint32)MIN((int64)todo, mSampleFrames - mSourcePosition);
+    if (!todo)
+      break;
+
+    for (uint32 c = 0; c < mChannels; c++)
+      mWritePointers[c] = mBuffer.GetWritePointer(c);
+
+    uint32 read = mpReader->ReadDE(mWritePointers, todo, eSampleFloat32);
+    if (read < todo)
+    {
+      // The file is shorter than announced: pad it with silence to keep the stream in time
+      for (uint32 c = 0; c < mChannels; c++)
+        memset((float*)mWritePointers[c] + read, 0, (todo - read) * sizeof(float));
+    }
+
+    ngl_atomic_barrier();
+    mBuffer.AdvanceWriteIndex(todo);
+    mSourcePosition += todo;
+    done += todo;
+  }
+
+  mFramesSinceSeek += done;
+  return done;
+}
+
+
+//class nuiAudioStreamer
+nuiAudioStreamer nuiAudioStreamer::Instance;
+
+nuiAudioStreamer::nuiAudioStreamer()
+: mpThread(NULL),
+  mStop(false),
+  mPrefetchFrames(65536),
+  mChunkFrames(8192),
+  mUnderruns(0),
+  mUnderrunFrames(0)
+{
+}
+
+nuiAudioStreamer::~nuiAudioStreamer()
+{
+  Stop();
+}
+
+bool nuiAudioStreamer::Add(nuiAudioStream* pStream)
+{
+  nglCriticalSectionGuard guard(mCS);
+  if (!mStreams.insert(pStream).second)
+    return false;
+
+  if (!mpThread)
+  {
+    mStop = false;
+    mpThread = new nglThreadDelegate(nuiMakeDelegate(this, &nuiAudioStreamer::Run), _T("nuiAudioStreamer"));
+    mpThread->Start();
+  }
+
+  mWakeUp.Set();
+  return true;
+}
+
+void nuiAudioStreamer::Remove(nuiAudioStream* pStream)
+{
+  nglCriticalSectionGuard guard(mCS);
+  mStreams.erase(pStream);
+}
+
+uint32 nuiAudioStreamer::GetStreamCount() const
+{
+  nglCriticalSectionGuard guard(mCS);
+  return mStreams.size();
+}
+
+void nuiAudioStreamer::SetPrefetchFrames(uint32 Frames)
+{
+  mPrefetchFrames = Frames;
+}
+
+uint32 nuiAudioStreamer::GetPrefetchFrames() const
+{
+  return mPrefetchFrames;
+}
+
+void nuiAudioStreamer::SetChunkFrames(uint32 Frames)
+{
+  mChunkFrames = MAX(Frames, 1);
+}
+
+uint32 nuiAudioStreamer::GetChunkFrames() const
+{
+  return mChunkFrames;
+}
+
+uint32 nuiAudioStreamer::GetUnderruns() const
+{
+  return ngl_atomic_read(mUnderruns);
+}
+
+uint32 nuiAudioStreamer::GetUnderrunFrames() const
+{
+  return ngl_atomic_read(mUnderrunFrames);
+}
+
+void nuiAudioStreamer::Stop()
+{
+  if (!mpThread)
+    return;
+
+  mStop = true;
+  mWakeUp.Set();
+  mpThread->Join();
+  delete mpThread;
+  mpThread = NULL;
+}
+
+void nuiAudioStreamer::Run()
+{
+  std::vector<std::pair<uint32, nuiAudioStream*> > streams;
+
+  while (!mStop)
+  {
+    mWakeUp.Reset();
+    uint32 chunk = mChunkFrames;
+
+    // Serve the seeks and then the streams that are the closest to running out first
+    streams.clear();
+    {
+      nglCriticalSectionGuard guard(mCS);
+      for (std::set<nuiAudioStream*>::const_iterator it = mStreams.begin(); it != mStreams.end(); ++it)
+      {
+        nuiAudioStream* pStream = *it;
+        if (pStream->NeedsData(chunk))
+          streams.push_back(std::make_pair(pStream->IsSeeking(chunk) ? 0 : pStream->GetPrefetchedFrames(), pStream));
+      }
+    }
+    std::sort(streams.begin(), streams.end());
+
+    // Sort again after a few streams, a pass on hundreds of streams takes long enough for the others to run low
+    uint32 done = 0;
+    for (uint32 i = 0; i < streams.size() && i < 16 && !mStop; i++)
+    {
+      nglCriticalSectionGuard guard(mCS);
+      nuiAudioStream* pStream = streams[i].second;
+      if (mStreams.find(pStream) != mStreams.end())
+        done += pStream->Fill(chunk);
+    }
+
+    if (!done)
+      mWakeUp.Wait(5);
+  }
+}
+
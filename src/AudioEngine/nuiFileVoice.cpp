@@ -15,22 +15,24 @@
 nuiFileVoice::nuiFileVoice(nuiFileSound* pSound)
 : nuiVoice(pSound),
   mpFileSound(pSound),
-  mpStream(NULL),
-  mpReader(NULL)
+  mpStream(NULL)
 {
   Init();
 }
 
 nuiFileVoice::~nuiFileVoice()
 {
-  
+  if (mpStream)
+  {
+    nuiAudioStreamer::Instance.Remove(mpStream);
+    delete mpStream;
+  }
 }
 
 nuiFileVoice::nuiFileVoice(const nuiFileVoice& rVoice)
 : nuiVoice(rVoice),
   mpFileSound(NULL),
-  mpStream(NULL),
-  mpReader(NULL)
+  mpStream(NULL)
 {
   *this = rVoice;
 }
@@ -49,17 +51,17 @@ nuiFileVoice& nuiFileVoice::operator=(const nuiFileVoice& rVoice)
 
 bool nuiFileVoice::IsValid() const
 {
-  return mpSound && mpStream && mpReader;
+  return mpSound && mpStream;
 }
 
 bool nuiFileVoice::Init()
 {
   if (mpStream)
+  {
+    nuiAudioStreamer::Instance.Remove(mpStream);
     delete mpStream;
-  if (mpReader)
-    delete mpReader;
+  }
   mpStream = NULL;
-  mpReader = NULL;
   
   if (!mpSound)
     return false;
@@ -101,9 +103,12 @@ bool nuiFileVoice::Init()
     }
   }
   
-  mpStream = pStream;
-  mpReader = pReader;
   mInfo = info;
+  mpStream = new nuiAudioStream(pStream, pReader, info, nuiAudioStreamer::Instance.GetPrefetchFrames());
+  
+  // Pre-roll the beginning of the file so that the voice can start playing right away
+  mpStream->Preroll(nuiAudioStreamer::Instance.GetChunkFrames());
+  nuiAudioStreamer::Instance.Add(mpStream);
   NGL_OUT(_T("audio file loaded: %ls\n"), path.GetNodeName().GetChars());
   return true;
 }
@@ -120,20 +125,21 @@ uint32 nuiFileVoice::GetSampleFrames() const
 
 
 
+uint32 nuiFileVoice::GetUnderruns() const
+{
+  return mpStream ? mpStream->GetUnderruns() : 0;
+}
+
+uint32 nuiFileVoice::GetUnderrunFrames() const
+{
+  return mpStream ? mpStream->GetUnderrunFrames() : 0;
+}
+
 uint32 nuiFileVoice::ReadSamples(const std::vector<float*>& rOutput, int64 position, uint32 SampleFrames)
 {
   if (!IsValid())
     return 0;
   
-  if (position >= mInfo.GetSampleFrames())
-    return 0;
-  uint32 todo = MIN(SampleFrames, (int64)mInfo.GetSampleFrames() - position);
-  
-  std::vector<void*> temp;
-  for (uint32 i = 0; i < rOutput.size(); i++)
-    temp.push_back((void*)rOutput[i]);
-  
-  mpReader->SetPosition(position);
-  uint32 read = mpReader->ReadDE(temp, todo, eSampleFloat32);
-  return read;
-}
\ No newline at end of file
+  mpStream->SetLoop(mLoop);
+  return mpStream->Read(rOutput, position, SampleFrames);
+}
@@ -11,6 +11,7 @@
 #include "nuiWaveReader.h"
 #include "nuiAiffReader.h"
 #include "nuiAudioDecoder.h"
+#include "nuiAudioConvert.h"
 
 
 nuiVoice::nuiVoice(nuiSound* pSound)
@@ -27,7 +28,15 @@ nuiVoice::nuiVoice(nuiSound* pSound)
   mFadeInLength(0),
   mFadingOut(false),
   mFadeOutPosition(0),
-  mFadeOutLength(0)
+  mFadeOutLength(0),
+  mRequestedPosition(0),
+  mPositionRequests(0),
+  mAppliedPositionRequests(0),
+  mRequestedFadeIn(false),
+  mRequestedFadeLength(0),
+  mFadeRequests(0),
+  mAppliedFadeRequests(0),
+  mBufferFrames(0)
 {
   if (SetObjectClass(_T("nuiVoice")))
     InitAttributes();
@@ -37,7 +46,21 @@ nuiVoice::nuiVoice(nuiSound* pSound)
 }
 
 nuiVoice::nuiVoice(const nuiVoice& rVoice)
-: mpSound(NULL)
+: mpSound(NULL),
+  mFadingIn(false),
+  mFadeInPosition(0),
+  mFadeInLength(0),
+  mFadingOut(false),
+  mFadeOutPosition(0),
+  mFadeOutLength(0),
+  mRequestedPosition(0),
+  mPositionRequests(0),
+  mAppliedPositionRequests(0),
+  mRequestedFadeIn(false),
+  mRequestedFadeLength(0),
+  mFadeRequests(0),
+  mAppliedFadeRequests(0),
+  mBufferFrames(0)
 {
   *this = rVoice;
 }
@@ -119,9 +142,73 @@ bool nuiVoice::IsDone() const
   return mDone;
 }
 
+void nuiVoice::PrepareBuffers(uint32 MaxSampleFrames)
+{
+  uint32 channels = MAX(GetChannels(), 1);
+  if (MaxSampleFrames <= mBufferFrames && mBuffers.size() == channels)
+    return;
+  
+  mBufferFrames = MAX(MaxSampleFrames, mBufferFrames);
+  mBuffer.resize(channels * mBufferFrames);
+  mBuffers.resize(channels);
+  mReadBuffers.resize(channels);
+  for (uint32 c = 0; c < channels; c++)
+    mBuffers[c] = &mBuffer[c * mBufferFrames];
+}
+
+void nuiVoice::ApplyRequests()
+{
+  // The requests are written like a sequence lock: the counters are odd while the values are being changed
+  uint32 requests = ngl_atomic_read(mPositionRequests);
+  if (requests != mAppliedPositionRequests && !(requests & 1))
+  {
+    ngl_atomic_barrier();
+    int64 position = mRequestedPosition;
+    ngl_atomic_barrier();
+    if (ngl_atomic_read(mPositionRequests) == requests)
+    {
+      mAppliedPositionRequests = requests;
+      SetPositionInternal(position);
+      mPosition = position;
+    }
+  }
+  
+  requests = ngl_atomic_read(mFadeRequests);
+  if (requests != mAppliedFadeRequests && !(requests & 1))
+  {
+    ngl_atomic_barrier();
+    bool fadein = mRequestedFadeIn;
+    uint32 length = mRequestedFadeLength;
+    ngl_atomic_barrier();
+    if (ngl_atomic_read(mFadeRequests) == requests)
+    {
+      mAppliedFadeRequests = requests;
+      if (fadein)
+      {
+        mFadingIn = true;
+        mFadingOut = false;
+        mFadeInLength = length;
+        mFadeInPosition = 0;
+        mPlay = true;
+      }
+      else
+      {
+        mFadingOut = true;
+        mFadingIn = false;
+        mFadeOutLength = length;
+        mFadeOutPosition = 0;
+      }
+    }
+  }
+}
+
 void nuiVoice::Process(const std::vector<float*>& rOutput, uint32 SampleFrames)
 {
-  if (!mpSound || !mPlay || !IsValid())
+  if (!mpSound || !IsValid())
+    return;
+  
+  ApplyRequests();
+  if (!mPlay)
     return;
   
   uint32 outChannels = rOutput.size();
@@ -134,27 +221,20 @@ void nuiVoice::Process(const std::vector<float*>& rOutput, uint32 SampleFrames)
     NGL_ASSERT(0);
   }
   
-  // create temp buffers
-  std::vector<float*> buffers;
+  // Only allocates if the voice was not prepared for this buffer size
+  PrepareBuffers(SampleFrames);
   for (uint32 c = 0; c < inChannels; c++)
-  {
-    float* pTemp = new float[SampleFrames];
-    memset(pTemp, 0, SampleFrames * sizeof(float));
-    buffers.push_back(pTemp);
-  }
-  
-  nglCriticalSectionGuard guard(mCs);
+    memset(mBuffers[c], 0, SampleFrames * sizeof(float));
   
   // fill temp buffers with data from the reader
   uint32 done = 0;
   uint32 toread = SampleFrames;
   while (toread && !mDone)
   {    
-    std::vector<float*> temp;
     for (uint32 c = 0; c < inChannels; c++)
-      temp.push_back(buffers[c] + done);
+      mReadBuffers[c] = mBuffers[c] + done;
    
-    uint32 read = ReadSamples(temp, mPosition, toread);
+    uint32 read = ReadSamples(mReadBuffers, mPosition, toread);
     
     mPosition += read;
     done += read;
@@ -173,21 +253,9 @@ void nuiVoice::Process(const std::vector<float*>& rOutput, uint32 SampleFrames)
   if (mFadingIn)
   {
     uint32 todo = MIN(SampleFrames, mFadeInLength - mFadeInPosition);
-    
-    float* pFade = new float[todo];
-    float* pTempFade = pFade;
-    for (uint32 i = 0; i < todo; i++)
-      *pTempFade++ = (float)(mFadeInPosition + i) / (float)mFadeInLength;
-    
+    float step = 1.f / (float)mFadeInLength;
     for (uint32 c = 0; c < inChannels; c++)
-    {
-      float* pDst = buffers[c];
-      pTempFade = pFade;
-      for (uint32 i = 0; i < todo; i++)
-        *pDst++ *= *pTempFade++;
-    }
-    
-    delete[] pFade;
+      nuiAudioMix_MultiplyRamp(mBuffers[c], (float)mFadeInPosition * step, step, todo);
     
     mFadeInPosition += todo;
     if (mFadeInPosition == mFadeInLength)
@@ -199,21 +267,9 @@ void nuiVoice::Process(const std::vector<float*>& rOutput, uint32 SampleFrames)
   else if (mFadingOut)
   {
     uint32 todo = MIN(SampleFrames, mFadeOutLength - mFadeOutPosition);
-    
-    float* pFade = new float[todo];
-    float* pTempFade = pFade;
-    for (uint32 i = 0; i < todo; i++)
-      *pTempFade++ = 1.f - ((float)(mFadeOutPosition + i) / (float)mFadeOutLength);
-    
+    float step = 1.f / (float)mFadeOutLength;
     for (uint32 c = 0; c < inChannels; c++)
-    {
-      float* pDst = buffers[c];
-      pTempFade = pFade;
-      for (uint32 i = 0; i < todo; i++)
-        *pDst++ *= *pTempFade++;
-    }
-    
-    delete[] pFade;
+      nuiAudioMix_MultiplyRamp(mBuffers[c], 1.f - (float)mFadeOutPosition * step, -step, todo);
     
     mFadeOutPosition += todo;
     if (mFadeOutPosition == mFadeOutLength)
@@ -223,16 +279,12 @@ void nuiVoice::Process(const std::vector<float*>& rOutput, uint32 SampleFrames)
       mPlay = false;
       
       for (uint32 c = 0; c < inChannels; c++)
-      {
-        float* pDst = buffers[c];
-        for (uint32 i = todo; i < SampleFrames; i++)
-          pDst[i] = 0;
-      }
+        memset(mBuffers[c] + todo, 0, (SampleFrames - todo) * sizeof(float));
     }
   }
   
   
-  // copy temp buffers to output and apply gain
+  // mix the temp buffers to the output and apply gain
   if (!mMute && mGain > 0.f)
   {
     float pan = mPan;
@@ -243,16 +295,10 @@ void nuiVoice::Process(const std::vector<float*>& rOutput, uint32 SampleFrames)
     for (uint32 c= 0; c < outChannels; c++)
     {
       float mult = mGain * (c == 0 ? panLeft : panRight);
-      float* pSrc = (inChannels == outChannels) ? buffers[c] : buffers[0]; // mono input signal: use first channel
-      float* pDst = rOutput[c];
-      for (uint32 i = 0; i < SampleFrames; i++)
-        *pDst++ += (*pSrc++) * mult;
+      const float* pSrc = (inChannels == outChannels) ? mBuffers[c] : mBuffers[0]; // mono input signal: use first channel
+      nuiAudioMix_Add(rOutput[c], pSrc, mult, SampleFrames);
     }
   }
-  
-  for (uint32 c = 0; c < buffers.size(); c++)
-    delete[] buffers[c];
-  
 }
 
 void nuiVoice::Play()
@@ -281,13 +327,14 @@ void nuiVoice::FadeIn(uint32 length)
   if (mPlay)
     return;
   
+  // Applied by the audio thread, which starts playing the voice
   nglCriticalSectionGuard guard(mCs);
-  mFadingIn = true;
-  mFadingOut = false;
-  
-  mFadeInLength = length;
-  mFadeInPosition = 0;
-  mPlay = true;
+  ngl_atomic_inc(mFadeRequests);
+  ngl_atomic_barrier();
+  mRequestedFadeIn = true;
+  mRequestedFadeLength = length;
+  ngl_atomic_barrier();
+  ngl_atomic_inc(mFadeRequests);
 }
 
 void nuiVoice::FadeOut(uint32 length)
@@ -296,11 +343,12 @@ void nuiVoice::FadeOut(uint32 length)
     return;
   
   nglCriticalSectionGuard guard(mCs);
-  mFadingOut = true;
-  mFadingIn = false;
-  
-  mFadeOutLength = length;
-  mFadeOutPosition = 0;
+  ngl_atomic_inc(mFadeRequests);
+  ngl_atomic_barrier();
+  mRequestedFadeIn = false;
+  mRequestedFadeLength = length;
+  ngl_atomic_barrier();
+  ngl_atomic_inc(mFadeRequests);
 }
 
 void nuiVoice::SetLoop(bool loop)
@@ -321,9 +369,13 @@ int64 nuiVoice::GetPosition() const
 
 void nuiVoice::SetPosition(int64 position)
 {
+  // Applied by the audio thread at the start of the next buffer
   nglCriticalSectionGuard guard(mCs);
-  SetPositionInternal(position);
-  mPosition = position;
+  ngl_atomic_inc(mPositionRequests);
+  ngl_atomic_barrier();
+  mRequestedPosition = position;
+  ngl_atomic_barrier();
+  ngl_atomic_inc(mPositionRequests);
 }
 
 void nuiVoice::SetPositionInternal(int64 position)
@@ -0,0 +1,49 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot & Vincent Caron
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "nuiAudioDecoder.h"
+
+// There is no system decoder for the compressed formats on this platform: the decoder never initializes and only the
+// wave and aiff readers can open audio files.
+
+class nuiAudioDecoderPrivate
+{
+};
+
+//
+//
+// nuiAudioDecoder
+//
+//
+
+void nuiAudioDecoder::Clear()
+{
+  delete mpPrivate;
+  mpPrivate = NULL;
+}
+
+bool nuiAudioDecoder::CreateAudioDecoderPrivate()
+{
+  mpPrivate = NULL;
+  return false;
+}
+
+bool nuiAudioDecoder::ReadInfo()
+{
+  return false;
+}
+
+bool nuiAudioDecoder::Seek(uint64 SampleFrame)
+{
+  return false;
+}
+
+uint32 nuiAudioDecoder::ReadDE(std::vector<void*> buffers, uint32 sampleframes, nuiSampleBitFormat format)
+{
+  return 0;
+}
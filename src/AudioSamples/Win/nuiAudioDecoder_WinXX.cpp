@@ -434,10 +434,7 @@ uint32 SamplesQueue::ReadDeInterleavedFloat32(std::vector<float*>& rBuffers, uin
   }
   else if (mInputBytesPerSample == 3)
   {
-    for (uint32 i = 0; i < SamplesToRead; i++)
-    {
-      pFloatBuffer[i] = nuiAudioConvert_24bitsToFloatFromLittleEndian(&(mBuffer[3 * i]));
-    }
+    nuiAudioConvert_24bitsLittleEndianToFloat(&(mBuffer[0]), pFloatBuffer, SamplesToRead);
   }
   else if (mInputBytesPerSample == 4)
   {
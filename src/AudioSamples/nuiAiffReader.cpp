@@ -246,10 +246,7 @@ uint32 nuiAiffReader::ReadIN(void* pBuffer, uint32 SampleFrames, nuiSampleBitFor
           
           uint32 sizeRead = mrStream.ReadUInt8(pTempBuffer, SamplePointsToRead * 3);
           SampleFramesRead = sizeRead / channels / 3;
-          for (uint32 i = 0; i < sizeRead / 3; i++)
-          {
-            pTempFloat[i] = nuiAudioConvert_24bitsToFloatFromBigEndian(pTempBuffer + (3 * i));
-          }
+          nuiAudioConvert_24bitsBigEndianToFloat(pTempBuffer, pTempFloat, sizeRead / 3);
           
           delete[] pTempBuffer;
         }
@@ -7,6 +7,7 @@
 
 #include "nui.h"
 #include "nuiChunkSampleReader.h"
+#include "nuiAudioConvert.h"
 
 #define CHUNK_ID_BYTES 4
 #define CHUNK_SIZE_BYTES 4
@@ -189,16 +190,11 @@ uint32 nuiChunkSampleReader::ReadDE(std::vector<void*> buffers, uint32 samplefra
       }
       
       SampleFramesRead = ReadIN((void*)pFloatBuffer, sampleframes, format); //mPosition is incremented inside
-      for (uint32 s = 0; s < SampleFramesRead; s++)
-      {
-        for (uint32 c = 0; c < channels; c++)
-        {
-          float* pDest = (float*)buffers[c];
-          pDest[s] = pFloatBuffer[channels * s + c];
-        }
-      }
       if (deleteBuffer)
+      {
+        nuiAudioConvert_INfloatToDEfloat(pFloatBuffer, (float* const*)&buffers[0], channels, SampleFramesRead);
         delete[] pFloatBuffer;
+      }
     }
       break;
       
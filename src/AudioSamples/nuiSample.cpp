@@ -218,18 +218,31 @@ nuiSample* nuiSample::Clone() const
 //
 //Clone(double SampleRate) const
 //
-nuiSample* nuiSample::Clone(double SampleRate) const
+nuiSample* nuiSample::Clone(double SampleRate, nuiAudioSincResampler::Quality quality) const
 {
   nuiSample* pSample = new nuiSample(mInfos);
   pSample->mInfos.SetSampleRate(SampleRate);
   pSample->mInfos.SetSampleFrames((uint32)(mInfos.GetSampleFrames() / (mInfos.GetSampleRate()) * SampleRate));
   
+  const uint32 SampleFrames = (uint32)mInfos.GetSampleFrames();
+  const uint32 DestFrames = (uint32)pSample->mInfos.GetSampleFrames();
+  nuiAudioSincResampler resampler(mInfos.GetSampleRate(), SampleRate, quality);
+  std::vector<float> buffer(resampler.GetMaxOutputFrames(SampleFrames) + resampler.GetMaxOutputFrames(resampler.GetLatency()));
+  
   uint8 c;
   for (c = 0; c < mInfos.GetChannels(); c++)
   {
-    double position = 0;
-    pSample->mSamples[c].resize(pSample->mInfos.GetSampleFrames());
-    InterpolateChannel(eInterpolLinear, position, c, mInfos.GetSampleRate()/SampleRate, pSample->GetData(c), pSample->mInfos.GetSampleFrames());
+    uint32 done = 0;
+    if (SampleFrames)
+      done = resampler.Process(GetData(c), SampleFrames, &buffer[0]);
+    done += resampler.Flush(&buffer[done]);
+    
+    pSample->mSamples[c].resize(DestFrames);
+    done = MIN(done, DestFrames);
+    if (done)
+      memcpy(pSample->GetData(c), &buffer[0], done * sizeof(float));
+    if (done < DestFrames)
+      memset(pSample->GetData(c) + done, 0, (DestFrames - done) * sizeof(float));
   }  
   return pSample;
 }
@@ -194,10 +194,7 @@ uint32 nuiWaveReader::ReadIN(void* pBuffer, uint32 sampleframes, nuiSampleBitFor
           
           uint32 sizeRead = (uint32)mrStream.ReadUInt8(pTempBuffer, SamplePointsToRead * 3);
           SampleFramesRead = (sizeRead / channels) / 3;
-          for (uint64 i = 0; i < sizeRead / 3; i++)
-          {
-            pTempFloat[i] = nuiAudioConvert_24bitsToFloatFromLittleEndian(pTempBuffer + (3 * i));
-          }
+          nuiAudioConvert_24bitsLittleEndianToFloat(pTempBuffer, pTempFloat, sizeRead / 3);
           
           delete[] pTempBuffer;
         }
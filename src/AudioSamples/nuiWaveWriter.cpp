@@ -320,10 +320,10 @@ uint32 nuiWaveWriter::Write(const void* pBuffer, uint32 SampleFrames, nuiSampleB
         {
           float* pTempFloat = (float*)pBuffer;
           
-          int16* pInt16Buffer = new int16[SamplePointsToWrite];
-          nuiAudioConvert_FloatBufferTo16bits(pTempFloat, pInt16Buffer, SamplePointsToWrite);
+          std::vector<int16> Int16Buffer(SamplePointsToWrite);
+          nuiAudioConvert_FloatBufferTo16bits(pTempFloat, &Int16Buffer[0], SamplePointsToWrite);
           
-          SampleFramesWritten = (uint32)mrStream.WriteInt16(pInt16Buffer, SamplePointsToWrite) / mrSampleInfo.GetChannels();
+          SampleFramesWritten = (uint32)mrStream.WriteInt16(&Int16Buffer[0], SamplePointsToWrite) / mrSampleInfo.GetChannels();
         }
           break;
           
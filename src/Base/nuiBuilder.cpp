@@ -239,6 +239,15 @@ nuiCreateWidgetFn nuiBuilder::GetHandler(const nglString& ClassName) const
   return desc.GetHandler();
 }
 
+const nuiWidgetCreator* nuiBuilder::GetCreator(const nglString& rClassName) const
+{
+  nuiWidgetCreatorMap::const_iterator it = mCreatorMap.find(rClassName);
+  if (it == mCreatorMap.end())
+    return NULL;
+  
+  return it->second;
+}
+
 bool nuiBuilder::GetClassList(list<nuiWidgetDesc>& rClassNames) const
 {
   map<nglString, nuiWidgetDesc, nglString::LessFunctor>::const_iterator it;
@@ -250,6 +259,17 @@ bool nuiBuilder::GetClassList(list<nuiWidgetDesc>& rClassNames) const
   return true;
 }
 
+bool nuiBuilder::GetCreatorList(list<nglString>& rClassNames) const
+{
+  nuiWidgetCreatorMap::const_iterator it;
+  nuiWidgetCreatorMap::const_iterator end = mCreatorMap.end();
+
+  for (it = mCreatorMap.begin(); it != end; ++it)
+    rClassNames.push_back(it->first);
+
+  return true;
+}
+
 nuiWidget* nuiBuilder::CreateWidget(const nglString& rClassName) const
 {
   std::map<nglString, nglString> ParamDictionary;
@@ -288,44 +308,6 @@ nuiBuilder nuiBuilder::mBuilder;
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
-class nuiWidgetCreatorOperation
-{
-public:
-  enum Type
-  {
-    eAddChild,
-    eSetCell1,
-    eSetCell2,
-    eSetProperty,
-    eSetAttribute,
-  };
-  
-  nuiWidgetCreatorOperation(Type type, nuiWidgetCreator* pCreator, uint32 index1, uint32 index2)
-  {
-    mType = type;
-    mpCreator = pCreator;
-    mIndex1 = index1;
-    mIndex2 = index2;
-  }
-  
-  nuiWidgetCreatorOperation(Type type, const nglString& rName, const nglString& rValue, uint32 index1 = -1, uint32 index2 = -1)
-  {
-    mType = type;
-    mpCreator = NULL;
-    mIndex1 = index1;
-    mIndex2 = index2;
-    mName = rName;
-    mValue = rValue;
-  }
-  
-  Type mType;
-  nuiWidgetCreator* mpCreator;
-  uint32 mIndex1;
-  uint32 mIndex2;
-  nglString mName;
-  nglString mValue;
-};
-
 nuiWidgetCreator::nuiWidgetCreator(const nglString& rClassName, const nglString& rObjectName)
 {
   mClassName = rClassName;
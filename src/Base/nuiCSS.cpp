@@ -9,6 +9,7 @@
 #include "nuiCSS.h"
 #include "nglIStream.h"
 #include "nglOStream.h"
+#include "nuiParser.h"
 
 #include "nuiFrame.h"
 #include "nuiMetaDecoration.h"
@@ -97,40 +98,27 @@ void nuiCSSAction_SetProperty::ApplyAction(nuiObject* pObject)
  Action = UserRect, UserSize, UserPos, Font, Border, OverDraw, Decoration, Animation, Color
 */
 // Lexer:
-class cssLexer
+class cssLexer : public nuiParser
 {
 public:
   cssLexer(nglIStream* pStream, nuiCSS& rCSS, const nglPath& rSourcePath)
-  : mrCSS(rCSS)
+  : nuiParser(pStream, rSourcePath),
+    mrCSS(rCSS)
   {
-    mpStream = pStream;
-    mSourcePath = rSourcePath;
-    if (mSourcePath.IsLeaf())
-      mSourcePath = mSourcePath.GetParent();
-    mChar = _T(' ');
-    mColumn = 1;
-    mLine = 1;
+    // Mirror the CSS char classes in the parser's ASCII table so that symbols and values are scanned in bulk:
+    for (nglChar c = 1; c < 128; c++)
+    {
+      if (IsValidInSymbol(c))
+        mASCIIClasses[c] |= eSymbol;
+      if (IsValidInValue(c))
+        mASCIIClasses[c] |= eValue;
+    }
   }
   
   virtual ~cssLexer()
   {
   }
 
-  int32 GetLine() const
-  {
-    return mLine;
-  }
-  
-  int32 GetColumn() const
-  {
-    return mColumn;
-  }
-  
-  const nglString& GetErrorStr() const
-  {
-    return mErrorString;
-  }
-  
   bool Load()
   {
     uint8 start[16];
@@ -193,115 +181,9 @@ public:
   }
 
   
-  bool PeekChar()
-  {
-    nglFileOffset ofs = mpStream->GetPos();
-    bool res = GetChar();
-    mpStream->SetPos(ofs);
-    return res;
-  }
-  
   bool GetChar()
   {
-    nglChar previous = mChar;
-    // Parse an utf-8 char sequence:
-    uint8 c = 0;
-    if (1 != mpStream->ReadUInt8(&c, 1))
-    {
-      mChar = 0;
-      return false;
-    }
-    
-    if (!(c & 0x80))
-    {
-      mChar = c;
-    }
-    else
-    {
-      //  0xC0 // 2 bytes
-      //  0xE0 // 3
-      //  0xF0 // 4
-      //  0xF8 // 5
-      //  0xFC // 6
-      uint32 count = 0;
-      if ((c & 0xFC) == 0xFC)
-      {
-        mChar = c & (~0xFC);
-        count = 5;
-      }
-      else if ((c & 0xF8) == 0xF8)
-      {
-        mChar = c & (~0xF8);
-        count = 4;
-      }
-      else if ((c & 0xF0) == 0xF0)
-      {
-        mChar = c & (~0xF0);
-        count = 3;
-      }
-      else if ((c & 0xE0) == 0xE0)
-      {
-        mChar = c & (~0xE0);
-        count = 2;
-      }
-      else if ((c & 0xC0) == 0xC0)
-      {
-        mChar = c & (~0xC0);
-        count = 1;
-      }
-      
-      for (uint32 i = 0; i < count; i++)
-      {
-        if (1 != mpStream->ReadUInt8(&c, 1))
-          return false;
-        mChar <<= 6;
-        mChar |= c & 0x3F;
-      }
-    }
-    
-    if ((mChar == 0xa && previous != 0xd) || (mChar == 0xd && previous != 0xa) )
-    {
-      mColumn = 1;
-      mLine++;
-    }
-
-    //NGL_OUT(_T("%lc"), mChar);
-    
-    return true;
-  }
-  
-  inline bool IsBlank(nglChar c)
-  {
-    return (c==' ' || c == 0xa || c == 0xd || c == '\t');
-  }
-  
-  bool SkipBlank()
-  {
-    bool res = true;
-    while ((IsBlank(mChar) || mChar == '/') && res) 
-    {
-      if (mChar == '/') // Is this a comment?
-      {
-        res = PeekChar();
-        
-        if (!res)
-          return false;
-        
-        if (mChar == '/')
-        {
-          res = GetChar();
-          // Skip to the end of the line:
-          res = GetChar();
-          while (res && mChar != 0xa && mChar != 0xd)
-          {
-            res = GetChar();
-          }
-        }
-      }
-      
-      res = GetChar();
-    }
-    return res;
+    return NextChar();
   }
   
   bool GetQuoted(nglString& rResult)
@@ -354,10 +236,11 @@ public:
       return false;
     }
     
-    while (IsValidInSymbol(mChar))
+    while (mChar && IsValidInSymbol(mChar))
     {
       mAccumulator.push_back(mChar);
-      GetChar();
+      if (!ScanASCII(eSymbol, &mAccumulator))
+        break;
     }
 
     if (!mAccumulator.empty())
@@ -374,10 +257,11 @@ public:
       return false;
     }
     
+    uint8 classes = AllowBlank ? (eValue | eBlank) : eValue;
     while ((AllowBlank && IsBlank(mChar)) || IsValidInValue(mChar))
     {
       mAccumulator.push_back(mChar);
-      if (!GetChar())
+      if (!ScanASCII(classes, &mAccumulator))
       {
         rResult.Copy(&mAccumulator[0], mAccumulator.size());
         return true;
@@ -412,20 +296,7 @@ public:
   }
   
   
-  nglIStream* mpStream;
-  nglPath mSourcePath;
-  nglChar mChar;
-  int32 mColumn;
-  int32 mLine;
-  bool mError;
   nuiCSS& mrCSS;
-  nglString mErrorString;
-  
-  void SetError(const nglString& rError)
-  {
-    mErrorString = rError;
-    mError = true;
-  }
   
   bool IsValidInSymbol(nglChar c) const
   {
@@ -640,6 +511,8 @@ public:
     bool AutoTrim = false;
     int32 MaxTextureSize = 128;
     int32 AtlasSize = 1024;
+    nuiAtlasPacking Packing = eAtlasPackingLegacy;
+    nglPath CachePath;
     
     while (mChar != _T('}'))
     {
@@ -721,9 +594,22 @@ public:
       {
         AtlasSize = value.GetCInt();
       }
+      else if (symbol == _T("Packing"))
+      {
+        if (value == _T("MaxRects"))
+          Packing = eAtlasPackingMaxRects;
+        else if (value == _T("MaxRectsRotated"))
+          Packing = eAtlasPackingMaxRectsRotated;
+        else
+          Packing = eAtlasPackingLegacy;
+      }
+      else if (symbol == _T("Cache"))
+      {
+        CachePath = value;
+      }
       else if (symbol == _T("AutoScan"))
       {
-        nuiTexture::CreateAtlasFromPath(value, MaxTextureSize, AtlasSize, AutoTrim);
+        nuiTexture::CreateAtlasFromPath(value, MaxTextureSize, AtlasSize, AutoTrim, Packing, CachePath);
       }
     }
 
@@ -1985,7 +1871,6 @@ public:
   
   std::vector<nuiWidgetMatcher*> mMatchers;
   std::vector<nuiCSSAction*> mActions;
-  std::vector<nglChar> mAccumulator;
 };
 
 
@@ -2118,7 +2003,20 @@ bool nuiCSS::Load(nglIStream& rStream, const nglPath& rSourcePath)
   cache.resize(s);
   rStream.Read(&cache[0], s, 1);
   nglIMemory mem(&cache[0], s);
-  cssLexer lexer(&mem, *this, rSourcePath);
+  return Parse(mem, rSourcePath);
+}
+
+bool nuiCSS::Load(const nuiString8& rSource, const nglPath& rSourcePath)
+{
+  mErrorString.Wipe();
+  // The lexer reads the UTF-8 bytes in place:
+  nglIMemory mem(rSource.GetChars(), rSource.GetLength());
+  return Parse(mem, rSourcePath);
+}
+
+bool nuiCSS::Parse(nglIStream& rStream, const nglPath& rSourcePath)
+{
+  cssLexer lexer(&rStream, *this, rSourcePath);
   if (!lexer.Load())
   {
     mErrorString.CFormat(_T("Error line %d (%d): %ls"), lexer.GetLine(), lexer.GetColumn(), lexer.GetErrorStr().GetChars() );
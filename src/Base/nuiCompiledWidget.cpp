@@ -0,0 +1,1312 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiCompiledWidget.h"
+#include "nuiXML.h"
+#include "nuiBox.h"
+#include "nuiGrid.h"
+#include "nglIMemory.h"
+#include "nglOMemory.h"
+
+#define NUI_COMPILED_WIDGET_MARKER "nuiCompiledWidget1"
+
+// Maximum nesting of creators and XML elements, to stop on recursive class definitions:
+#define NUI_COMPILED_WIDGET_MAX_DEPTH 256
+
+//////////////////// Native encoding of the attribute values:
+static void nuiEncodeValue(bool Value, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eBool;
+  rValue.mInt = Value ? 1 : 0;
+}
+
+static void nuiEncodeValue(int32 Value, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eInt;
+  rValue.mInt = Value;
+}
+
+static void nuiEncodeValue(int64 Value, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eInt;
+  rValue.mInt = Value;
+}
+
+static void nuiEncodeValue(uint32 Value, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eUInt;
+  rValue.mUInt = Value;
+}
+
+static void nuiEncodeValue(uint64 Value, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eUInt;
+  rValue.mUInt = Value;
+}
+
+static void nuiEncodeValue(float Value, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eReal;
+  rValue.mReal = Value;
+}
+
+static void nuiEncodeValue(double Value, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eReal;
+  rValue.mReal = Value;
+}
+
+static void nuiEncodeValue(const nglString& rString, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eString;
+  rValue.mString = nuiCompiledWidget::InvalidIndex; // The compiler stores rText in its string table
+  rText = rString;
+}
+
+static void nuiEncodeValue(const nuiColor& rColor, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eVector;
+  rValue.mVector[0] = rColor.Red();
+  rValue.mVector[1] = rColor.Green();
+  rValue.mVector[2] = rColor.Blue();
+  rValue.mVector[3] = rColor.Alpha();
+}
+
+static void nuiEncodeValue(const nuiRect& rRect, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eVector;
+  rValue.mVector[0] = rRect.mLeft;
+  rValue.mVector[1] = rRect.mTop;
+  rValue.mVector[2] = rRect.mRight;
+  rValue.mVector[3] = rRect.mBottom;
+}
+
+static void nuiEncodeValue(const nuiBorder& rBorder, nuiCompiledWidget::Value& rValue, nglString& rText)
+{
+  rValue.mKind = nuiCompiledWidget::eVector;
+  rValue.mVector[0] = rBorder.Left();
+  rValue.mVector[1] = rBorder.Top();
+  rValue.mVector[2] = rBorder.Right();
+  rValue.mVector[3] = rBorder.Bottom();
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, bool& rResult)
+{
+  rResult = rValue.mInt != 0;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, int32& rResult)
+{
+  rResult = (int32)rValue.mInt;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, int64& rResult)
+{
+  rResult = rValue.mInt;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, uint32& rResult)
+{
+  rResult = (uint32)rValue.mUInt;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, uint64& rResult)
+{
+  rResult = rValue.mUInt;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, float& rResult)
+{
+  rResult = (float)rValue.mReal;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, double& rResult)
+{
+  rResult = rValue.mReal;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, nglString& rResult)
+{
+  rResult = rText;
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, nuiColor& rResult)
+{
+  rResult.SetRed(rValue.mVector[0]);
+  rResult.SetGreen(rValue.mVector[1]);
+  rResult.SetBlue(rValue.mVector[2]);
+  rResult.SetAlpha(rValue.mVector[3]);
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, nuiRect& rResult)
+{
+  rResult.mLeft = rValue.mVector[0];
+  rResult.mTop = rValue.mVector[1];
+  rResult.mRight = rValue.mVector[2];
+  rResult.mBottom = rValue.mVector[3];
+}
+
+static void nuiDecodeValue(const nuiCompiledWidget::Value& rValue, const nglString& rText, nuiBorder& rResult)
+{
+  rResult = nuiBorder((nuiSize)rValue.mVector[0], (nuiSize)rValue.mVector[1], (nuiSize)rValue.mVector[2], (nuiSize)rValue.mVector[3]);
+}
+
+//////////////////// Attribute handlers:
+class nuiCompiledAttributeHandler
+{
+public:
+  nuiCompiledAttributeHandler(uint32 Kind)
+  : mKind(Kind)
+  {
+  }
+
+  virtual ~nuiCompiledAttributeHandler()
+  {
+  }
+
+  uint32 GetKind() const
+  {
+    return mKind;
+  }
+
+  virtual bool Accept(const nuiAttributeBase* pAttribute) const = 0;
+  virtual bool Parse(const nuiAttributeBase* pAttribute, const nglString& rString, nuiCompiledWidget::Value& rValue, nglString& rText) const = 0;
+  virtual void Set(const nuiAttributeBase* pAttribute, void* pTarget, int32 Index0, int32 Index1, const nuiCompiledWidget::Value& rValue, const nglString& rText) const = 0;
+
+private:
+  uint32 mKind;
+};
+
+template <class AttributeClass, typename Contents>
+static void nuiSetAttributeValue(const AttributeClass* pAttribute, void* pTarget, int32 Index0, int32 Index1, const Contents& rValue)
+{
+  if (Index0 < 0)
+    pAttribute->Set(pTarget, rValue);
+  else if (Index1 < 0)
+    pAttribute->Set(pTarget, Index0, rValue);
+  else
+    pAttribute->Set(pTarget, Index0, Index1, rValue);
+}
+
+/// Handler for nuiAttribute<Contents> or nuiAttribute<const Contents&>
+template <class AttributeClass, typename Contents>
+class nuiCompiledAttributeHandlerT : public nuiCompiledAttributeHandler
+{
+public:
+  nuiCompiledAttributeHandlerT(uint32 Kind)
+  : nuiCompiledAttributeHandler(Kind)
+  {
+  }
+
+  virtual bool Accept(const nuiAttributeBase* pAttribute) const
+  {
+    return dynamic_cast<const AttributeClass*>(pAttribute) != NULL;
+  }
+
+  virtual bool Parse(const nuiAttributeBase* pAttribute, const nglString& rString, nuiCompiledWidget::Value& rValue, nglString& rText) const
+  {
+    Contents value;
+    if (!static_cast<const AttributeClass*>(pAttribute)->FromString(value, rString))
+      return false;
+    nuiEncodeValue(value, rValue, rText);
+    return true;
+  }
+
+  virtual void Set(const nuiAttributeBase* pAttribute, void* pTarget, int32 Index0, int32 Index1, const nuiCompiledWidget::Value& rValue, const nglString& rText) const
+  {
+    Contents value;
+    nuiDecodeValue(rValue, rText, value);
+    nuiSetAttributeValue(static_cast<const AttributeClass*>(pAttribute), pTarget, Index0, Index1, value);
+  }
+};
+
+/// Handler for the attributes of enum types, stored as integers
+template <typename Contents>
+class nuiCompiledEnumHandler : public nuiCompiledAttributeHandler
+{
+public:
+  nuiCompiledEnumHandler()
+  : nuiCompiledAttributeHandler(nuiCompiledWidget::eInt)
+  {
+  }
+
+  virtual bool Accept(const nuiAttributeBase* pAttribute) const
+  {
+    return dynamic_cast<const nuiAttribute<Contents>*>(pAttribute) != NULL;
+  }
+
+  virtual bool Parse(const nuiAttributeBase* pAttribute, const nglString& rString, nuiCompiledWidget::Value& rValue, nglString& rText) const
+  {
+    Contents value;
+    if (!static_cast<const nuiAttribute<Contents>*>(pAttribute)->FromString(value, rString))
+      return false;
+    rValue.mKind = nuiCompiledWidget::eInt;
+    rValue.mInt = (int64)value;
+    return true;
+  }
+
+  virtual void Set(const nuiAttributeBase* pAttribute, void* pTarget, int32 Index0, int32 Index1, const nuiCompiledWidget::Value& rValue, const nglString& rText) const
+  {
+    Contents value = (Contents)rValue.mInt;
+    nuiSetAttributeValue(static_cast<const nuiAttribute<Contents>*>(pAttribute), pTarget, Index0, Index1, value);
+  }
+};
+
+static const nuiCompiledAttributeHandler* nuiGetCompiledAttributeHandler(const nuiAttributeBase* pAttribute)
+{
+  static nuiCompiledAttributeHandlerT<nuiAttribute<bool>, bool> BoolHandler(nuiCompiledWidget::eBool);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<int32>, int32> Int32Handler(nuiCompiledWidget::eInt);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<int64>, int64> Int64Handler(nuiCompiledWidget::eInt);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<uint32>, uint32> UInt32Handler(nuiCompiledWidget::eUInt);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<uint64>, uint64> UInt64Handler(nuiCompiledWidget::eUInt);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<float>, float> FloatHandler(nuiCompiledWidget::eReal);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<double>, double> DoubleHandler(nuiCompiledWidget::eReal);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<nglString>, nglString> StringHandler(nuiCompiledWidget::eString);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<const nglString&>, nglString> StringRefHandler(nuiCompiledWidget::eString);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<nuiColor>, nuiColor> ColorHandler(nuiCompiledWidget::eVector);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<const nuiColor&>, nuiColor> ColorRefHandler(nuiCompiledWidget::eVector);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<nuiRect>, nuiRect> RectHandler(nuiCompiledWidget::eVector);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<const nuiRect&>, nuiRect> RectRefHandler(nuiCompiledWidget::eVector);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<nuiBorder>, nuiBorder> BorderHandler(nuiCompiledWidget::eVector);
+  static nuiCompiledAttributeHandlerT<nuiAttribute<const nuiBorder&>, nuiBorder> BorderRefHandler(nuiCompiledWidget::eVector);
+  static nuiCompiledEnumHandler<nuiPosition> PositionHandler;
+  static nuiCompiledEnumHandler<nuiOrientation> OrientationHandler;
+  static nuiCompiledEnumHandler<nuiDirection> DirectionHandler;
+  static nuiCompiledEnumHandler<nuiExpandMode> ExpandModeHandler;
+
+  static const nuiCompiledAttributeHandler* pHandlers[] =
+  {
+    &BoolHandler, &Int32Handler, &Int64Handler, &UInt32Handler, &UInt64Handler, &FloatHandler, &DoubleHandler,
+    &StringHandler, &StringRefHandler, &ColorHandler, &ColorRefHandler, &RectHandler, &RectRefHandler,
+    &BorderHandler, &BorderRefHandler, &PositionHandler, &OrientationHandler, &DirectionHandler, &ExpandModeHandler
+  };
+
+  for (uint32 i = 0; i < sizeof(pHandlers) / sizeof(pHandlers[0]); i++)
+  {
+    if (pHandlers[i]->Accept(pAttribute))
+      return pHandlers[i];
+  }
+  return NULL;
+}
+
+static bool nuiAttributeFromString(const nuiAttributeBase* pAttribute, void* pTarget, int32 Index0, int32 Index1, const nglString& rString)
+{
+  if (Index0 < 0)
+    return pAttribute->FromString(pTarget, rString);
+  if (Index1 < 0)
+    return pAttribute->FromString(pTarget, Index0, rString);
+  return pAttribute->FromString(pTarget, Index0, Index1, rString);
+}
+
+//////////////////// nuiCompiledWidget:
+nuiCompiledWidget::nuiCompiledWidget()
+: mpBuilder(NULL)
+{
+}
+
+nuiCompiledWidget::~nuiCompiledWidget()
+{
+}
+
+void nuiCompiledWidget::Clear()
+{
+  mStrings.clear();
+  mClasses.clear();
+  mAttributes.clear();
+  mNodes.clear();
+  mOperations.clear();
+  mDescriptions.clear();
+  ResetBindings();
+}
+
+void nuiCompiledWidget::ResetBindings()
+{
+  mpBuilder = NULL;
+  mHandlers.clear();
+  mHandlersResolved.clear();
+  mBindings.clear();
+}
+
+uint32 nuiCompiledWidget::GetDescriptionCount() const
+{
+  return (uint32)mDescriptions.size();
+}
+
+const nglString& nuiCompiledWidget::GetDescriptionName(uint32 Index) const
+{
+  if (Index >= mDescriptions.size())
+    return nglString::Null;
+  return mStrings[mDescriptions[Index].first];
+}
+
+int32 nuiCompiledWidget::FindDescription(const nglString& rName) const
+{
+  for (uint32 i = 0; i < mDescriptions.size(); i++)
+  {
+    if (mStrings[mDescriptions[i].first] == rName)
+      return i;
+  }
+  return -1;
+}
+
+nuiWidget* nuiCompiledWidget::Create(const nglString& rName, const nuiBuilder* pBuilder)
+{
+  int32 index = FindDescription(rName);
+  if (index < 0)
+    return NULL;
+  return Create((uint32)index, pBuilder);
+}
+
+nuiWidget* nuiCompiledWidget::Create(uint32 Index, const nuiBuilder* pBuilder)
+{
+  if (Index >= mDescriptions.size())
+    return NULL;
+
+  if (!pBuilder)
+    pBuilder = &nuiBuilder::Get();
+
+  if (pBuilder != mpBuilder)
+  {
+    mpBuilder = pBuilder;
+    mHandlers.assign(mClasses.size(), (nuiCreateWidgetFn)NULL);
+    mHandlersResolved.assign(mClasses.size(), false);
+  }
+  if (mBindings.size() != mAttributes.size())
+    mBindings.resize(mAttributes.size());
+
+  return CreateNode(mDescriptions[Index].second, pBuilder);
+}
+
+nuiWidget* nuiCompiledWidget::CreateNode(uint32 Index, const nuiBuilder* pBuilder)
+{
+  const Node& rNode(mNodes[Index]);
+  const nglString& rClass(mStrings[mClasses[rNode.mClass]]);
+
+  if (!mHandlersResolved[rNode.mClass])
+  {
+    mHandlers[rNode.mClass] = pBuilder->GetHandler(rClass);
+    mHandlersResolved[rNode.mClass] = true;
+  }
+
+  // Fall back to the builder for the classes that are not native anymore:
+  nuiCreateWidgetFn pHandler = mHandlers[rNode.mClass];
+  nuiWidget* pWidget = pHandler ? pHandler() : pBuilder->CreateWidget(rClass);
+  if (!pWidget)
+  {
+    NGL_LOG(_T("nuiCompiledWidget"), NGL_LOG_ERROR, _T("Error while creating a %ls\n"), rClass.GetChars());
+    return NULL;
+  }
+
+  if (rNode.mName != InvalidIndex)
+    pWidget->SetObjectName(mStrings[rNode.mName]);
+
+  nuiSimpleContainer* pContainer = NULL;
+  nuiBox* pBox = NULL;
+  nuiGrid* pGrid = NULL;
+  bool containers = false;
+
+  const Operation* pOperation = rNode.mOperationCount ? &mOperations[rNode.mFirstOperation] : NULL;
+  for (uint32 i = 0; i < rNode.mOperationCount; i++, pOperation++)
+  {
+    switch (pOperation->mType)
+    {
+      case eAddChild:
+      case eSetCell1:
+      case eSetCell2:
+        {
+          if (!containers)
+          {
+            pContainer = dynamic_cast<nuiSimpleContainer*>(pWidget);
+            pBox = dynamic_cast<nuiBox*>(pWidget);
+            pGrid = dynamic_cast<nuiGrid*>(pWidget);
+            containers = true;
+          }
+
+          nuiWidget* pChild = CreateNode(pOperation->mTarget, pBuilder);
+          if (!pChild)
+            break;
+
+          bool added = true;
+          if (pOperation->mType == eAddChild)
+          {
+            if (pBox)
+              pBox->AddCell(pChild);
+            else if (pContainer)
+              pContainer->AddChild(pChild);
+            else
+              added = false;
+          }
+          else if (pOperation->mType == eSetCell1)
+          {
+            if (pBox)
+              pBox->SetCell(pOperation->mIndex0, pChild);
+            else
+              added = false;
+          }
+          else
+          {
+            if (pGrid)
+              pGrid->SetCell(pOperation->mIndex0, pOperation->mIndex1, pChild);
+            else
+              added = false;
+          }
+
+          if (!added)
+          {
+            pChild->Acquire();
+            pChild->Release();
+          }
+        }
+        break;
+
+      case eSetProperty:
+        pWidget->SetProperty(mStrings[pOperation->mTarget], mStrings[pOperation->mValue.mString]);
+        break;
+
+      case eSetAttribute:
+        SetAttribute(pWidget, *pOperation);
+        break;
+
+      default:
+        NGL_ASSERT(0);
+        break;
+    }
+  }
+
+  return pWidget;
+}
+
+nuiCompiledWidget::Binding nuiCompiledWidget::GetBinding(nuiWidget* pWidget, uint32 AttributeId)
+{
+  int32 classIndex = pWidget->GetObjectClassNameIndex();
+  bool cached = !pWidget->HasInstanceAttributes();
+
+  std::vector<Binding>& rBindings(mBindings[AttributeId]);
+  if (cached)
+  {
+    for (uint32 i = 0; i < rBindings.size(); i++)
+    {
+      if (rBindings[i].mClassIndex == classIndex)
+        return rBindings[i];
+    }
+  }
+
+  Binding binding;
+  binding.mClassIndex = classIndex;
+  binding.mpAttribute = NULL;
+  binding.mpHandler = NULL;
+
+  nuiAttribBase attrib(pWidget->GetAttribute(mStrings[mAttributes[AttributeId]]));
+  if (attrib.IsValid() && attrib.CanSet())
+  {
+    binding.mpAttribute = attrib.GetAttribute();
+    binding.mpHandler = nuiGetCompiledAttributeHandler(binding.mpAttribute);
+  }
+
+  if (cached)
+    rBindings.push_back(binding);
+  return binding;
+}
+
+void nuiCompiledWidget::SetAttribute(nuiWidget* pWidget, const Operation& rOperation)
+{
+  Binding binding(GetBinding(pWidget, rOperation.mTarget));
+  if (!binding.mpAttribute)
+    return;
+
+  void* pTarget = static_cast<nuiObject*>(pWidget);
+  const Value& rValue(rOperation.mValue);
+
+  if (binding.mpHandler && binding.mpHandler->GetKind() == rValue.mKind)
+  {
+    binding.mpHandler->Set(binding.mpAttribute, pTarget, rOperation.mIndex0, rOperation.mIndex1, rValue,
+                           rValue.mKind == eString ? mStrings[rValue.mString] : nglString::Null);
+    return;
+  }
+
+  if (rValue.mKind == eText || rValue.mKind == eString)
+  {
+    nuiAttributeFromString(binding.mpAttribute, pTarget, rOperation.mIndex0, rOperation.mIndex1, mStrings[rValue.mString]);
+    return;
+  }
+
+  NGL_LOG(_T("nuiCompiledWidget"), NGL_LOG_ERROR, _T("The type of the attribute %ls of %ls has changed since it was compiled\n"),
+          mStrings[mAttributes[rOperation.mTarget]].GetChars(), pWidget->GetObjectClass().GetChars());
+}
+
+size_t nuiCompiledWidget::GetMemoryUsage() const
+{
+  size_t usage = sizeof(nuiCompiledWidget);
+  for (uint32 i = 0; i < mStrings.size(); i++)
+    usage += sizeof(nglString) + mStrings[i].GetLength() * sizeof(nglChar);
+  usage += mClasses.capacity() * sizeof(uint32);
+  usage += mAttributes.capacity() * sizeof(uint32);
+  usage += mNodes.capacity() * sizeof(Node);
+  usage += mOperations.capacity() * sizeof(Operation);
+  usage += mDescriptions.capacity() * sizeof(std::pair<uint32, uint32>);
+  usage += mHandlers.capacity() * sizeof(nuiCreateWidgetFn);
+  for (uint32 i = 0; i < mBindings.size(); i++)
+    usage += sizeof(std::vector<Binding>) + mBindings[i].capacity() * sizeof(Binding);
+  return usage;
+}
+
+//////////////////// File format:
+static bool nuiWriteIndices(nglOStream& rStream, const std::vector<uint32>& rIndices)
+{
+  uint32 count = (uint32)rIndices.size();
+  if (rStream.WriteUInt32(&count) != 1)
+    return false;
+  return !count || rStream.WriteUInt32(&rIndices[0], count) == count;
+}
+
+static bool nuiReadIndices(nglIStream& rStream, std::vector<uint32>& rIndices, uint32 Limit)
+{
+  uint32 count = 0;
+  if (rStream.ReadUInt32(&count) != 1)
+    return false;
+  rIndices.resize(count);
+  if (count && rStream.ReadUInt32(&rIndices[0], count) != count)
+    return false;
+  for (uint32 i = 0; i < count; i++)
+  {
+    if (rIndices[i] >= Limit)
+      return false;
+  }
+  return true;
+}
+
+static bool nuiWriteValue(nglOStream& rStream, const nuiCompiledWidget::Value& rValue)
+{
+  if (rStream.WriteUInt32(&rValue.mKind) != 1)
+    return false;
+
+  switch (rValue.mKind)
+  {
+    case nuiCompiledWidget::eNoValue:
+      return true;
+    case nuiCompiledWidget::eBool:
+    case nuiCompiledWidget::eInt:
+      return rStream.WriteInt64(&rValue.mInt) == 1;
+    case nuiCompiledWidget::eUInt:
+      return rStream.WriteUInt64(&rValue.mUInt) == 1;
+    case nuiCompiledWidget::eReal:
+      return rStream.WriteDouble(&rValue.mReal) == 1;
+    case nuiCompiledWidget::eVector:
+      return rStream.WriteFloat(rValue.mVector, 4) == 4;
+    case nuiCompiledWidget::eString:
+    case nuiCompiledWidget::eText:
+      return rStream.WriteUInt32(&rValue.mString) == 1;
+  }
+  return false;
+}
+
+static bool nuiReadValue(nglIStream& rStream, nuiCompiledWidget::Value& rValue, uint32 StringCount)
+{
+  if (rStream.ReadUInt32(&rValue.mKind) != 1)
+    return false;
+
+  switch (rValue.mKind)
+  {
+    case nuiCompiledWidget::eNoValue:
+      return true;
+    case nuiCompiledWidget::eBool:
+    case nuiCompiledWidget::eInt:
+      return rStream.ReadInt64(&rValue.mInt) == 1;
+    case nuiCompiledWidget::eUInt:
+      return rStream.ReadUInt64(&rValue.mUInt) == 1;
+    case nuiCompiledWidget::eReal:
+      return rStream.ReadDouble(&rValue.mReal) == 1;
+    case nuiCompiledWidget::eVector:
+      return rStream.ReadFloat(rValue.mVector, 4) == 4;
+    case nuiCompiledWidget::eString:
+    case nuiCompiledWidget::eText:
+      return rStream.ReadUInt32(&rValue.mString) == 1 && rValue.mString < StringCount;
+  }
+  return false;
+}
+
+bool nuiCompiledWidget::Save(nglOStream& rStream) const
+{
+  rStream.SetEndian(eEndianLittle);
+
+  int s = strlen(NUI_COMPILED_WIDGET_MARKER) + 1;
+  if (s != rStream.Write(NUI_COMPILED_WIDGET_MARKER, s, 1))
+    return false;
+
+  // Strings:
+  uint32 count = (uint32)mStrings.size();
+  if (rStream.WriteUInt32(&count) != 1)
+    return false;
+  for (uint32 i = 0; i < count; i++)
+  {
+    std::string str(mStrings[i].GetStdString(eUTF8));
+    uint32 length = (uint32)str.size();
+    if (rStream.WriteUInt32(&length) != 1)
+      return false;
+    if (length && rStream.Write(str.data(), length, 1) != length)
+      return false;
+  }
+
+  if (!nuiWriteIndices(rStream, mClasses) || !nuiWriteIndices(rStream, mAttributes))
+    return false;
+
+  // Nodes:
+  count = (uint32)mNodes.size();
+  if (rStream.WriteUInt32(&count) != 1)
+    return false;
+  for (uint32 i = 0; i < count; i++)
+  {
+    const Node& rNode(mNodes[i]);
+    uint32 fields[4] = { rNode.mClass, rNode.mName, rNode.mFirstOperation, rNode.mOperationCount };
+    if (rStream.WriteUInt32(fields, 4) != 4)
+      return false;
+  }
+
+  // Operations:
+  count = (uint32)mOperations.size();
+  if (rStream.WriteUInt32(&count) != 1)
+    return false;
+  for (uint32 i = 0; i < count; i++)
+  {
+    const Operation& rOperation(mOperations[i]);
+    uint32 fields[2] = { rOperation.mType, rOperation.mTarget };
+    int32 indices[2] = { rOperation.mIndex0, rOperation.mIndex1 };
+    if (rStream.WriteUInt32(fields, 2) != 2 || rStream.WriteInt32(indices, 2) != 2)
+      return false;
+    if (!nuiWriteValue(rStream, rOperation.mValue))
+      return false;
+  }
+
+  // Descriptions:
+  count = (uint32)mDescriptions.size();
+  if (rStream.WriteUInt32(&count) != 1)
+    return false;
+  for (uint32 i = 0; i < count; i++)
+  {
+    uint32 fields[2] = { mDescriptions[i].first, mDescriptions[i].second };
+    if (rStream.WriteUInt32(fields, 2) != 2)
+      return false;
+  }
+
+  return true;
+}
+
+bool nuiCompiledWidget::Load(nglIStream& rStream)
+{
+  Clear();
+  rStream.SetEndian(eEndianLittle);
+
+  int s = strlen(NUI_COMPILED_WIDGET_MARKER) + 1;
+  std::vector<char> marker(s);
+  if (s != rStream.Read(&marker[0], s, 1) || strcmp(NUI_COMPILED_WIDGET_MARKER, &marker[0]))
+    return false;
+
+  bool res = true;
+
+  // Strings:
+  uint32 count = 0;
+  res = res && rStream.ReadUInt32(&count) == 1;
+  std::vector<char> chars;
+  for (uint32 i = 0; res && i < count; i++)
+  {
+    uint32 length = 0;
+    res = rStream.ReadUInt32(&length) == 1;
+    if (res && length)
+    {
+      chars.resize(length);
+      res = rStream.Read(&chars[0], length, 1) == length;
+      if (res)
+        mStrings.push_back(nglString(&chars[0], length, eUTF8));
+    }
+    else if (res)
+    {
+      mStrings.push_back(nglString::Empty);
+    }
+  }
+
+  uint32 strings = (uint32)mStrings.size();
+  res = res && nuiReadIndices(rStream, mClasses, strings) && nuiReadIndices(rStream, mAttributes, strings);
+
+  // Nodes:
+  res = res && rStream.ReadUInt32(&count) == 1;
+  if (res)
+    mNodes.resize(count);
+  for (uint32 i = 0; res && i < count; i++)
+  {
+    uint32 fields[4];
+    res = rStream.ReadUInt32(fields, 4) == 4;
+    Node& rNode(mNodes[i]);
+    rNode.mClass = fields[0];
+    rNode.mName = fields[1];
+    rNode.mFirstOperation = fields[2];
+    rNode.mOperationCount = fields[3];
+    res = res && rNode.mClass < mClasses.size() && (rNode.mName == InvalidIndex || rNode.mName < strings);
+  }
+
+  // Operations:
+  res = res && rStream.ReadUInt32(&count) == 1;
+  if (res)
+    mOperations.resize(count);
+  for (uint32 i = 0; res && i < count; i++)
+  {
+    Operation& rOperation(mOperations[i]);
+    uint32 fields[2];
+    int32 indices[2];
+    res = rStream.ReadUInt32(fields, 2) == 2 && rStream.ReadInt32(indices, 2) == 2 && nuiReadValue(rStream, rOperation.mValue, strings);
+    rOperation.mType = fields[0];
+    rOperation.mTarget = fields[1];
+    rOperation.mIndex0 = indices[0];
+    rOperation.mIndex1 = indices[1];
+    if (!res)
+      break;
+
+    switch (rOperation.mType)
+    {
+      case eAddChild:
+      case eSetCell1:
+      case eSetCell2:
+        res = rOperation.mTarget < mNodes.size();
+        break;
+      case eSetProperty:
+        res = rOperation.mTarget < strings && rOperation.mValue.mKind == eText;
+        break;
+      case eSetAttribute:
+        res = rOperation.mTarget < mAttributes.size();
+        break;
+      default:
+        res = false;
+        break;
+    }
+  }
+
+  for (uint32 i = 0; res && i < mNodes.size(); i++)
+  {
+    const Node& rNode(mNodes[i]);
+    res = rNode.mFirstOperation <= mOperations.size() && rNode.mOperationCount <= mOperations.size() - rNode.mFirstOperation;
+    for (uint32 j = 0; res && j < rNode.mOperationCount; j++)
+    {
+      // Children always come before their parent so the descriptions can not loop:
+      const Operation& rOperation(mOperations[rNode.mFirstOperation + j]);
+      if (rOperation.mType <= eSetCell2)
+        res = rOperation.mTarget < i;
+    }
+  }
+
+  // Descriptions:
+  res = res && rStream.ReadUInt32(&count) == 1;
+  for (uint32 i = 0; res && i < count; i++)
+  {
+    uint32 fields[2];
+    res = rStream.ReadUInt32(fields, 2) == 2 && fields[0] < strings && fields[1] < mNodes.size();
+    if (res)
+      mDescriptions.push_back(std::make_pair(fields[0], fields[1]));
+  }
+
+  if (!res)
+    Clear();
+  return res;
+}
+
+//////////////////// nuiWidgetCompiler:
+nuiWidgetCompiler::nuiWidgetCompiler(const nuiBuilder* pBuilder)
+{
+  mpBuilder = pBuilder ? pBuilder : &nuiBuilder::Get();
+}
+
+nuiWidgetCompiler::~nuiWidgetCompiler()
+{
+  std::map<nglString, nuiWidget*, nglString::LessFunctor>::iterator it = mPrototypes.begin();
+  std::map<nglString, nuiWidget*, nglString::LessFunctor>::iterator end = mPrototypes.end();
+  while (it != end)
+  {
+    if (it->second)
+      it->second->Release();
+    ++it;
+  }
+}
+
+const nuiCompiledWidget& nuiWidgetCompiler::GetCompiledWidget() const
+{
+  return mResult;
+}
+
+bool nuiWidgetCompiler::Save(nglOStream& rStream) const
+{
+  return mResult.Save(rStream);
+}
+
+const nglString& nuiWidgetCompiler::GetError() const
+{
+  return mError;
+}
+
+bool nuiWidgetCompiler::AddCreator(const nglString& rName, const nuiWidgetCreator* pCreator)
+{
+  mError.Wipe();
+  PendingNode node;
+  Dictionary dictionary;
+  if (!CompileCreator(pCreator, dictionary, node, 0))
+    return false;
+
+  AddDescription(rName, Commit(node));
+  Source source = { pCreator, NULL };
+  mSources.push_back(source);
+  return true;
+}
+
+bool nuiWidgetCompiler::AddCreators()
+{
+  std::list<nglString> classes;
+  mpBuilder->GetCreatorList(classes);
+
+  bool res = true;
+  for (std::list<nglString>::const_iterator it = classes.begin(); it != classes.end(); ++it)
+    res &= AddCreator(*it, mpBuilder->GetCreator(*it));
+  return res;
+}
+
+bool nuiWidgetCompiler::AddXML(const nglString& rName, const nuiXMLNode* pNode)
+{
+  mError.Wipe();
+  PendingNode node;
+  if (!CompileXML(pNode, node, 0))
+    return false;
+
+  AddDescription(rName, Commit(node));
+  Source source = { NULL, pNode };
+  mSources.push_back(source);
+  return true;
+}
+
+bool nuiWidgetCompiler::IsCreatable(const nglString& rClass) const
+{
+  return mpBuilder->GetHandler(rClass) || mpBuilder->GetCreator(rClass);
+}
+
+bool nuiWidgetCompiler::CompileClass(const nglString& rClass, const Dictionary& rDictionary, PendingNode& rNode, uint32 Depth)
+{
+  if (mpBuilder->GetHandler(rClass))
+  {
+    rNode.mClass = rClass;
+    return GetPrototype(rClass) != NULL;
+  }
+
+  // Inline the creators, they only add operations to the widget of their own class:
+  const nuiWidgetCreator* pCreator = mpBuilder->GetCreator(rClass);
+  if (pCreator)
+    return CompileCreator(pCreator, rDictionary, rNode, Depth + 1);
+
+  mError.CFormat(_T("Unknown widget class %ls"), rClass.GetChars());
+  return false;
+}
+
+bool nuiWidgetCompiler::CompileCreator(const nuiWidgetCreator* pCreator, const Dictionary& rParentDictionary, PendingNode& rNode, uint32 Depth)
+{
+  if (Depth > NUI_COMPILED_WIDGET_MAX_DEPTH)
+  {
+    mError.CFormat(_T("The widget creator %ls is recursive"), pCreator->mClassName.GetChars());
+    return false;
+  }
+
+  // Same dictionary and look ups as nuiWidgetCreator::Create:
+  Dictionary dictionary(pCreator->mDefaultDictionary);
+  dictionary.insert(rParentDictionary.begin(), rParentDictionary.end());
+
+  nglString classname(pCreator->LookUp(dictionary, pCreator->mClassName));
+  nglString objectname(pCreator->LookUp(dictionary, pCreator->mObjectName));
+  if (!CompileClass(classname, dictionary, rNode, Depth))
+    return false;
+
+  if (!objectname.IsEmpty())
+  {
+    // The operations of an inlined creator run before this name is set:
+    if (rNode.mOperations.empty())
+      rNode.mName = objectname;
+    else
+      CompileAttribute(rNode, _T("Name"), objectname, -1, -1);
+  }
+
+  for (uint32 i = 0; i < pCreator->mOperations.size(); i++)
+  {
+    const nuiWidgetCreatorOperation& rOperation(pCreator->mOperations[i]);
+    switch (rOperation.mType)
+    {
+      case nuiWidgetCreatorOperation::eAddChild:
+      case nuiWidgetCreatorOperation::eSetCell1:
+      case nuiWidgetCreatorOperation::eSetCell2:
+        {
+          if (!rOperation.mpCreator)
+            break;
+
+          // A child that can't be created is skipped, as in nuiWidgetCreator::Create:
+          PendingNode child;
+          if (!CompileCreator(rOperation.mpCreator, dictionary, child, Depth + 1))
+          {
+            NGL_LOG(_T("nuiWidgetCompiler"), NGL_LOG_ERROR, _T("%ls\n"), mError.GetChars());
+            break;
+          }
+
+          nuiCompiledWidget::Operation operation;
+          operation.mType = nuiCompiledWidget::eAddChild;
+          if (rOperation.mType == nuiWidgetCreatorOperation::eSetCell1)
+            operation.mType = nuiCompiledWidget::eSetCell1;
+          else if (rOperation.mType == nuiWidgetCreatorOperation::eSetCell2)
+            operation.mType = nuiCompiledWidget::eSetCell2;
+          operation.mTarget = Commit(child);
+          operation.mIndex0 = rOperation.mIndex1;
+          operation.mIndex1 = rOperation.mIndex2;
+          operation.mValue.mKind = nuiCompiledWidget::eNoValue;
+          operation.mValue.mUInt = 0;
+          rNode.mOperations.push_back(operation);
+        }
+        break;
+
+      case nuiWidgetCreatorOperation::eSetProperty:
+        CompileProperty(rNode, pCreator->LookUp(dictionary, rOperation.mName), pCreator->LookUp(dictionary, rOperation.mValue));
+        break;
+
+      case nuiWidgetCreatorOperation::eSetAttribute:
+        CompileAttribute(rNode, pCreator->LookUp(dictionary, rOperation.mName), pCreator->LookUp(dictionary, rOperation.mValue),
+                         rOperation.mIndex1, rOperation.mIndex2);
+        break;
+    }
+  }
+
+  return true;
+}
+
+bool nuiWidgetCompiler::CompileXML(const nuiXMLNode* pNode, PendingNode& rNode, uint32 Depth)
+{
+  if (Depth > NUI_COMPILED_WIDGET_MAX_DEPTH)
+  {
+    mError = _T("The XML description is too deep");
+    return false;
+  }
+
+  Dictionary dictionary;
+  if (!CompileClass(pNode->GetName(), dictionary, rNode, Depth))
+    return false;
+
+  // nuiObject::Load:
+  CompileProperty(rNode, _T("xmlClass"), pNode->GetName());
+
+  // The attributes are loaded in the order of their names:
+  std::map<nglString, nglString> attributes;
+  for (uint i = 0; i < pNode->GetAttributeCount(); i++)
+    attributes[pNode->GetAttributeName(i)] = pNode->GetAttributeValue(i);
+  for (std::map<nglString, nglString>::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+    CompileAttribute(rNode, it->first, it->second, -1, -1);
+
+  // nuiWidget::Load:
+  uint count = pNode->GetChildrenCount();
+  for (uint i = 0; i < count; i++)
+  {
+    const nuiXMLNode* pChild = pNode->GetChild(i);
+    if (pChild->GetName() == _T("nuiPropertyBag"))
+    {
+      for (uint j = 0; j < pChild->GetAttributeCount(); j++)
+        CompileProperty(rNode, pChild->GetAttributeName(j), pChild->GetAttributeValue(j));
+    }
+  }
+
+  // nuiSimpleContainer::LoadChildren:
+  if (!dynamic_cast<nuiSimpleContainer*>(GetPrototype(rNode.mClass)))
+    return true;
+
+  for (uint i = 0; i < count; i++)
+  {
+    const nuiXMLNode* pChild = pNode->GetChild(i);
+    if (!IsCreatable(pChild->GetName()))
+    {
+      const nuiXMLNode* pText = pChild->GetChild(nglString(_T("##text")));
+      if (pText)
+        CompileProperty(rNode, pChild->GetName(), pText->GetValue());
+      continue;
+    }
+
+    PendingNode child;
+    if (!CompileXML(pChild, child, Depth + 1))
+      return false;
+
+    nuiCompiledWidget::Operation operation;
+    operation.mType = nuiCompiledWidget::eAddChild;
+    operation.mTarget = Commit(child);
+    operation.mIndex0 = -1;
+    operation.mIndex1 = -1;
+    operation.mValue.mKind = nuiCompiledWidget::eNoValue;
+    operation.mValue.mUInt = 0;
+    rNode.mOperations.push_back(operation);
+  }
+
+  return true;
+}
+
+void nuiWidgetCompiler::CompileAttribute(PendingNode& rNode, const nglString& rName, const nglString& rValue, int32 Index0, int32 Index1)
+{
+  // Attributes that the class doesn't have are ignored by the string path too:
+  nuiWidget* pPrototype = GetPrototype(rNode.mClass);
+  nuiAttribBase attrib(pPrototype->GetAttribute(rName));
+  if (!attrib.IsValid() || !attrib.CanSet())
+    return;
+
+  nuiCompiledWidget::Operation operation;
+  operation.mType = nuiCompiledWidget::eSetAttribute;
+  operation.mTarget = GetAttribute(rName);
+  operation.mIndex0 = Index0;
+  operation.mIndex1 = Index1;
+  operation.mValue.mUInt = 0;
+
+  const nuiAttributeBase* pAttribute = attrib.GetAttribute();
+  const nuiCompiledAttributeHandler* pHandler = nuiGetCompiledAttributeHandler(pAttribute);
+  uint32 dimension = Index0 < 0 ? 0 : (Index1 < 0 ? 1 : 2);
+  nglString text;
+
+  if (pHandler && dimension == pAttribute->GetDimension() && pHandler->Parse(pAttribute, rValue, operation.mValue, text))
+  {
+    if (operation.mValue.mKind == nuiCompiledWidget::eString)
+      operation.mValue.mString = GetString(text);
+  }
+  else
+  {
+    // Let FromString deal with it at run time:
+    operation.mValue.mKind = nuiCompiledWidget::eText;
+    operation.mValue.mString = GetString(rValue);
+  }
+
+  rNode.mOperations.push_back(operation);
+}
+
+void nuiWidgetCompiler::CompileProperty(PendingNode& rNode, const nglString& rName, const nglString& rValue)
+{
+  nuiCompiledWidget::Operation operation;
+  operation.mType = nuiCompiledWidget::eSetProperty;
+  operation.mTarget = GetString(rName);
+  operation.mIndex0 = -1;
+  operation.mIndex1 = -1;
+  operation.mValue.mUInt = 0;
+  operation.mValue.mKind = nuiCompiledWidget::eText;
+  operation.mValue.mString = GetString(rValue);
+  rNode.mOperations.push_back(operation);
+}
+
+uint32 nuiWidgetCompiler::Commit(const PendingNode& rNode)
+{
+  // The children were committed before their parent, which is what lets nuiCompiledWidget::Load reject loops:
+  nuiCompiledWidget::Node node;
+  node.mClass = GetClass(rNode.mClass);
+  node.mName = rNode.mName.IsEmpty() ? nuiCompiledWidget::InvalidIndex : GetString(rNode.mName);
+  node.mFirstOperation = (uint32)mResult.mOperations.size();
+  node.mOperationCount = (uint32)rNode.mOperations.size();
+  mResult.mOperations.insert(mResult.mOperations.end(), rNode.mOperations.begin(), rNode.mOperations.end());
+  mResult.mNodes.push_back(node);
+  return (uint32)mResult.mNodes.size() - 1;
+}
+
+void nuiWidgetCompiler::AddDescription(const nglString& rName, uint32 Node)
+{
+  mResult.mDescriptions.push_back(std::make_pair(GetString(rName), Node));
+  mResult.ResetBindings();
+}
+
+nuiWidget* nuiWidgetCompiler::GetPrototype(const nglString& rClass)
+{
+  std::map<nglString, nuiWidget*, nglString::LessFunctor>::const_iterator it = mPrototypes.find(rClass);
+  if (it != mPrototypes.end())
+    return it->second;
+
+  nuiWidget* pWidget = NULL;
+  nuiCreateWidgetFn pHandler = mpBuilder->GetHandler(rClass);
+  if (pHandler)
+    pWidget = pHandler();
+  if (pWidget)
+    pWidget->Acquire();
+  else
+    mError.CFormat(_T("Unable to create a %ls"), rClass.GetChars());
+
+  mPrototypes[rClass] = pWidget;
+  return pWidget;
+}
+
+uint32 nuiWidgetCompiler::GetString(const nglString& rString)
+{
+  std::map<nglString, uint32, nglString::LessFunctor>::const_iterator it = mStringIndex.find(rString);
+  if (it != mStringIndex.end())
+    return it->second;
+
+  uint32 index = (uint32)mResult.mStrings.size();
+  mResult.mStrings.push_back(rString);
+  mStringIndex[rString] = index;
+  return index;
+}
+
+uint32 nuiWidgetCompiler::GetClass(const nglString& rClass)
+{
+  std::map<nglString, uint32, nglString::LessFunctor>::const_iterator it = mClassIndex.find(rClass);
+  if (it != mClassIndex.end())
+    return it->second;
+
+  uint32 index = (uint32)mResult.mClasses.size();
+  mResult.mClasses.push_back(GetString(rClass));
+  mClassIndex[rClass] = index;
+  return index;
+}
+
+uint32 nuiWidgetCompiler::GetAttribute(const nglString& rName)
+{
+  std::map<nglString, uint32, nglString::LessFunctor>::const_iterator it = mAttributeIndex.find(rName);
+  if (it != mAttributeIndex.end())
+    return it->second;
+
+  uint32 index = (uint32)mResult.mAttributes.size();
+  mResult.mAttributes.push_back(GetString(rName));
+  mAttributeIndex[rName] = index;
+  return index;
+}
+
+bool nuiWidgetCompiler::Verify(nglString& rReport)
+{
+  rReport.Wipe();
+
+  // Go through the binary form:
+  nglOMemory output;
+  if (!mResult.Save(output))
+  {
+    rReport = _T("Unable to save the compiled descriptions\n");
+    return false;
+  }
+  nglIMemory input(output.GetBufferData(), output.GetSize());
+  nuiCompiledWidget compiled;
+  if (!compiled.Load(input))
+  {
+    rReport = _T("Unable to load the compiled descriptions back\n");
+    return false;
+  }
+
+  bool res = true;
+  for (uint32 i = 0; i < mSources.size(); i++)
+  {
+    const nglString& rName(compiled.GetDescriptionName(i));
+    nuiWidget* pReference = NULL;
+    if (mSources[i].mpCreator)
+      pReference = mSources[i].mpCreator->Create(mpBuilder);
+    else
+    {
+      pReference = mpBuilder->CreateWidget(mSources[i].mpNode->GetName());
+      if (pReference)
+        pReference->Load(mSources[i].mpNode);
+    }
+    nuiWidget* pCompiled = compiled.Create(i, mpBuilder);
+
+    if (!pReference || !pCompiled)
+    {
+      nglString line;
+      line.CFormat(_T("%ls: unable to create the widget from the %ls\n"), rName.GetChars(), pReference ? _T("compiled description") : _T("source"));
+      rReport += line;
+      res = false;
+    }
+    else
+    {
+      res &= Compare(pReference, pCompiled, rName, rReport);
+    }
+
+    if (pReference)
+    {
+      pReference->Acquire();
+      pReference->Release();
+    }
+    if (pCompiled)
+    {
+      pCompiled->Acquire();
+      pCompiled->Release();
+    }
+  }
+
+  return res;
+}
+
+bool nuiWidgetCompiler::Compare(nuiWidget* pReference, nuiWidget* pCompiled, const nglString& rPath, nglString& rReport) const
+{
+  nglString line;
+  if (pReference->GetObjectClass() != pCompiled->GetObjectClass())
+  {
+    line.CFormat(_T("%ls: class %ls instead of %ls\n"), rPath.GetChars(), pCompiled->GetObjectClass().GetChars(), pReference->GetObjectClass().GetChars());
+    rReport += line;
+    return false;
+  }
+
+  // nuiObject::Load sets the Name property after the address of the object, and the name too when the XML doesn't have one:
+  nglString address;
+  address.CFormat(_T("%p"), (nuiObject*)pReference);
+  bool compareNames = pReference->GetObjectName() != address;
+
+  bool res = true;
+  std::map<nglString, nuiAttribBase> attributes;
+  pReference->GetAttributes(attributes);
+  for (std::map<nglString, nuiAttribBase>::iterator it = attributes.begin(); it != attributes.end(); ++it)
+  {
+    nuiAttribBase& rAttrib(it->second);
+    if (!rAttrib.CanGet() || rAttrib.GetDimension() != 0 || (!compareNames && it->first == _T("Name")))
+      continue;
+
+    nuiAttribBase compiledAttrib(pCompiled->GetAttribute(it->first));
+    nglString expected;
+    nglString value;
+    rAttrib.ToString(expected);
+    if (compiledAttrib.IsValid())
+      compiledAttrib.ToString(value);
+
+    if (expected != value)
+    {
+      line.CFormat(_T("%ls: attribute %ls is '%ls' instead of '%ls'\n"), rPath.GetChars(), it->first.GetChars(), value.GetChars(), expected.GetChars());
+      rReport += line;
+      res = false;
+    }
+  }
+
+  std::list<nglString> properties;
+  pReference->GetProperties(properties);
+  pCompiled->GetProperties(properties);
+  properties.sort();
+  properties.unique();
+  for (std::list<nglString>::const_iterator it = properties.begin(); it != properties.end(); ++it)
+  {
+    if (*it == _T("Name") && (!compareNames || pReference->GetProperty(*it) == address))
+      continue;
+
+    const nglString& rExpected(pReference->GetProperty(*it));
+    const nglString& rValue(pCompiled->GetProperty(*it));
+    if (rExpected != rValue)
+    {
+      line.CFormat(_T("%ls: property %ls is '%ls' instead of '%ls'\n"), rPath.GetChars(), it->GetChars(), rValue.GetChars(), rExpected.GetChars());
+      rReport += line;
+      res = false;
+    }
+  }
+
+  nuiContainer* pReferenceContainer = dynamic_cast<nuiContainer*>(pReference);
+  nuiContainer* pCompiledContainer = dynamic_cast<nuiContainer*>(pCompiled);
+  if (!pReferenceContainer || !pCompiledContainer)
+    return res;
+
+  uint count = pReferenceContainer->GetChildrenCount();
+  if (count != pCompiledContainer->GetChildrenCount())
+  {
+    line.CFormat(_T("%ls: %d children instead of %d\n"), rPath.GetChars(), pCompiledContainer->GetChildrenCount(), count);
+    rReport += line;
+    return false;
+  }
+
+  for (uint i = 0; i < count; i++)
+  {
+    nglString path;
+    path.CFormat(_T("%ls/%d"), rPath.GetChars(), i);
+    res &= Compare(pReferenceContainer->GetChild(i), pCompiledContainer->GetChild(i), path, rReport);
+  }
+
+  return res;
+}
@@ -21,6 +21,7 @@
 #include "nglBitmapTools.h"
 
 #include "nuiFontManager.h"
+#include "nuiMemoryTracker.h"
 
 //#include "harfbuzz.h"
 
@@ -627,6 +628,7 @@ nuiFontBase::~nuiFontBase()
   {
     nuiTexture* pTexture = *it;
     NGL_OUT(_T("DestroyFontTexture: %p / %p\n"), this, pTexture);
+    NUI_MEMORY_REMOVE(eMemoryGlyphCaches, pTexture, (int64)pTexture->GetUnscaledWidth() * pTexture->GetUnscaledHeight());
     pTexture->Release();
   }
   mTextures.clear();
@@ -667,6 +669,7 @@ nuiTexture *nuiFontBase::AllocateTexture(int size)
 
   nuiTexture *pTexture = nuiTexture::GetTexture(ImageInfo, true);
   pTexture->SetRetainBuffer(true);
+  NUI_MEMORY_ADD(eMemoryGlyphCaches, pTexture, (int64)pTexture->GetUnscaledWidth() * pTexture->GetUnscaledHeight()); // 8 bits per pixel
 
   pTexture->SetEnvMode(GL_MODULATE);
 //  pTexture->SetMinFilter(GL_NEAREST);
@@ -1097,6 +1097,8 @@ void nuiFontManager::GetSystemFolders(std::map<nglString, nglPath>& rFolders)
 #elif (defined _LINUX_)
   int count = 0;
   Display* pDisplay = XOpenDisplay(NULL);
+  if (!pDisplay)
+    return; // No X server (headless tests and tools)
   char** pPathes = XGetFontPath(pDisplay, &count);
   for (uint i = 0; i < count; i++)
   {
@@ -1146,6 +1148,9 @@ void nuiFontManager::ScanFolders(bool rescanAllFolders /* = false */)
   return;
 #endif
   
+#if 0
+#ifndef _UIKIT_
+  // The context info needs a display, don't create it when there is no window to show
   nuiContextInfo ContextInfo(nuiContextInfo::StandardContext3D);
   nglWindowInfo Info;
   
@@ -1157,8 +1162,6 @@ void nuiFontManager::ScanFolders(bool rescanAllFolders /* = false */)
   Info.XPos = 0;
   Info.YPos = 0;
 
-#if 0
-#ifndef _UIKIT_
   gpWin = new nuiMainWindow(ContextInfo, Info);
   nuiVBox* pBox = new nuiVBox();
   pBox->SetPosition(nuiCenter);
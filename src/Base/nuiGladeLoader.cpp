@@ -8,25 +8,39 @@
 #include "nui.h"
 #include "nglIFile.h"
 #include "nuiXML.h"
+#include "nuiXMLDocument.h"
 #include "nuiApplication.h"
 
-bool NodeToAttribute(nuiXMLNode* pFrom, nuiXMLNode* pTo, nglChar* from, nglChar* to = NULL);
+// The glade file is only read to build the nui description: load it in a nuiXMLDocument rather than a nuiXML tree.
+typedef nuiXMLDocument::Node nuiGladeNode;
 
-bool NodeToAttribute(nuiXMLNode* pFrom, nuiXMLNode* pTo, nglChar* from, nglChar* to)
+static const nuiGladeNode* GetTextNode(const nuiGladeNode* pNode)
 {
-  nuiXMLNode* pNode = NULL;
+  for (const nuiGladeNode* pChild = pNode->GetFirstChild(); pChild; pChild = pChild->GetNextSibling())
+  {
+    if (pChild->IsText())
+      return pChild;
+  }
+  return NULL;
+}
+
+bool NodeToAttribute(const nuiGladeNode* pFrom, nuiXMLNode* pTo, const char* from, const char* to = NULL);
+
+bool NodeToAttribute(const nuiGladeNode* pFrom, nuiXMLNode* pTo, const char* from, const char* to)
+{
+  const nuiGladeNode* pNode = NULL;
   if (!from) 
     return false;
   if (!to) 
     to = from;
 
-  pNode = pFrom->GetChild(nglString(from));
+  pNode = pFrom->GetChild(from);
   if (pNode)
   {
-    nuiXMLNode* pTextNode = pNode->GetChild(nglString(_T("##text")));
+    const nuiGladeNode* pTextNode = GetTextNode(pNode);
     if (pTextNode)
     {
-      pTo->SetAttribute(nglString(to), pTextNode->GetValue());
+      pTo->SetAttribute(to, pTextNode->GetValue());
       return true;
     }
     else 
@@ -36,15 +50,15 @@ bool NodeToAttribute(nuiXMLNode* pFrom, nuiXMLNode* pTo, nglChar* from, nglChar*
     return false;
 }
 
-nglString GetNodeText(nuiXMLNode* pFrom, nglChar* from)
+nglString GetNodeText(const nuiGladeNode* pFrom, const char* from)
 {
   if (!from) 
     return _T("");
 
-  nuiXMLNode* pNode = pFrom->GetChild(nglString(from));
+  const nuiGladeNode* pNode = pFrom->GetChild(from);
   if (pNode)
   {
-    nuiXMLNode* pTextNode = pNode->GetChild(nglString(_T("##text")));
+    const nuiGladeNode* pTextNode = GetTextNode(pNode);
     if (pTextNode)
     {
       return pTextNode->GetValue();
@@ -53,28 +67,26 @@ nglString GetNodeText(nuiXMLNode* pFrom, nglChar* from)
   return nglString();
 }
 
-bool RecursiveGladeImport(nuiXMLNode* pFrom, nuiXMLNode* pTo)
+bool RecursiveGladeImport(const nuiGladeNode* pFrom, nuiXMLNode* pTo)
 {
   bool havechildren = true;
-  nglString Name;
   if (! pFrom || !pTo)
     return false;
 
-  Name = pFrom->GetName();
-  if (Name == _T("widget"))
+  if (pFrom->IsElement() && !strcmp(pFrom->GetName(), "widget"))
   {
-    nuiXMLNode* pNode = pFrom->GetChild(nglString(_T("class")));
+    const nuiGladeNode* pNode = pFrom->GetChild("class");
 
     if (pNode)
     {
-      nuiXMLNode* pTextNode = pNode->GetChild(nglString(_T("##text")));
+      const nuiGladeNode* pTextNode = GetTextNode(pNode);
       if (pTextNode)
       {
         if (pTextNode->GetValue() == nglString(_T("GtkWindow")) )
         {
           pTo->SetName( nglString(_T("nuiWindow")) );
           pTo->SetAttribute( _T("Visible"), _T("true"));
-          NodeToAttribute(pFrom, pTo, (nglChar*)_T("Title"));
+          NodeToAttribute(pFrom, pTo, "Title");
           havechildren = true;
         }
         else if (pTextNode->GetValue() == nglString(_T("GtkFixed")) )
@@ -100,7 +112,7 @@ bool RecursiveGladeImport(nuiXMLNode* pFrom, nuiXMLNode* pTo)
         else if (pTextNode->GetValue() == nglString(_T("GtkButton")) )
         {
           pTo->SetName( nglString(_T("nuiButton")) );
-          nglString label = GetNodeText(pFrom, (nglChar*)_T("label"));
+          nglString label = GetNodeText(pFrom, "label");
           if (label!= _T(""))
           {
             nuiXMLNode* pLabel = new nuiXMLNode(nglString(_T("nuiLabel")),pTo);
@@ -113,17 +125,17 @@ bool RecursiveGladeImport(nuiXMLNode* pFrom, nuiXMLNode* pTo)
         {
           pTo->SetName( nglString(_T("nuiLabel")) );
           nuiXMLNode* pText = new nuiXMLNode(nglString(_T("##text")),pTo);
-          pText->SetValue(GetNodeText(pFrom, (nglChar*)_T("label")));
+          pText->SetValue(GetNodeText(pFrom, "label"));
 
           havechildren = false;
         }
         else if (pTextNode->GetValue() == nglString(_T("GtkText")) )
         {
-          if (GetNodeText(pFrom, (nglChar*)_T("editable")) == nglString(_T("True")))
+          if (GetNodeText(pFrom, "editable") == nglString(_T("True")))
             pTo->SetName( nglString(_T("nuiEditText")) );
           else
             pTo->SetName( nglString(_T("nuiText")) );
-          nglString text = GetNodeText(pFrom, (nglChar*)_T("text"));
+          nglString text = GetNodeText(pFrom, "text");
           if (text!= _T(""))
           {
             nuiXMLNode* pText = new nuiXMLNode(nglString(_T("##text")),pTo);
@@ -140,30 +152,25 @@ bool RecursiveGladeImport(nuiXMLNode* pFrom, nuiXMLNode* pTo)
     else 
       return false;
 
-    if (!NodeToAttribute(pFrom, pTo, (nglChar*)_T("name")))
+    if (!NodeToAttribute(pFrom, pTo, "name"))
       return false;
 
-    NodeToAttribute(pFrom, pTo, (nglChar*)_T("x"),(nglChar*) _T("X"));
-    NodeToAttribute(pFrom, pTo, (nglChar*)_T("y"), (nglChar*)_T("Y"));
-    NodeToAttribute(pFrom, pTo, (nglChar*)_T("width"), (nglChar*)_T("Width"));
-    NodeToAttribute(pFrom, pTo, (nglChar*)_T("height"), (nglChar*)_T("Height"));
+    NodeToAttribute(pFrom, pTo, "x", "X");
+    NodeToAttribute(pFrom, pTo, "y", "Y");
+    NodeToAttribute(pFrom, pTo, "width", "Width");
+    NodeToAttribute(pFrom, pTo, "height", "Height");
 
 
     if (havechildren)
     {
-      uint i, count = pFrom->GetChildrenCount();
-      for (i=0; i<count; i++)
+      for (const nuiGladeNode* pFromNode = pFrom->GetChild("widget"); pFromNode; pFromNode = pFromNode->GetNextSibling("widget"))
       {
-        nuiXMLNode* pFromNode = pFrom->GetChild(i);
-        if (pFromNode->GetName() == nglString(_T("widget")))
+        nuiXMLNode* pToNode = new nuiXMLNode(nglString(_T("importing")), pTo);
+        if (!RecursiveGladeImport(pFromNode,pToNode))
         {
-          nuiXMLNode* pToNode = new nuiXMLNode(nglString(_T("importing")), pTo);
-          if (!RecursiveGladeImport(pFromNode,pToNode))
-          {
-            // If there was an error just kill the new node...
-            pTo->DelChild(pToNode);
-            delete pToNode;
-          }
+          // If there was an error just kill the new node...
+          pTo->DelChild(pToNode);
+          delete pToNode;
         }
       }
     }
@@ -175,33 +182,28 @@ bool RecursiveGladeImport(nuiXMLNode* pFrom, nuiXMLNode* pTo)
 
 nuiXML* ImportGladeXML(nglChar* xmlfile)
 {
-  nuiXML* pFrom = new nuiXML(nglString(_T("gladefile")));
+  nuiXMLDocument from;
   nuiXML* pTo   = new nuiXML(nglString(_T("NUI-Interface")));
   nglIFile fromfile(nglPath((char*)xmlfile));
-  if (pFrom->Load(fromfile))
+  if (from.Load(fromfile))
   {
-    if (pFrom->GetName()== _T("GTK-Interface"))
+    const nuiGladeNode* pFrom = from.GetRoot();
+    if (!strcmp(pFrom->GetName(), "GTK-Interface"))
     {
-      uint i, count = pFrom->GetChildrenCount();
-
-      for (i=0; i<count; i++)
+      for (const nuiGladeNode* pNode = pFrom->GetFirstChild(); pNode; pNode = pNode->GetNextSibling())
       {
-        nuiXMLNode* pNode = pFrom->GetChild(i);
         if (!RecursiveGladeImport(pNode,pTo))
         {
-          delete pFrom;
           delete pTo;
           return NULL;
         }
       }
 
-      delete pFrom;
       return pTo;
     }
     
   }
 
-  delete pFrom;
   delete pTo;
   return NULL;
 }
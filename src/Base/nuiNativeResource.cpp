@@ -294,6 +294,11 @@ int64 nuiNativeResource::Peek (void* pData, int64 WordCount, uint WordSize)
   return mpIStream->Peek(pData, WordCount, WordSize);
 }
 
+int64 nuiNativeResource::PeekBuffer (const void*& rpData)
+{
+  return mpIStream->PeekBuffer(rpData);
+}
+
 void nuiNativeResource::SetEndian(nglEndian Endian)
 {
   mpIStream->SetEndian(Endian);
@@ -616,6 +616,11 @@ nuiAttribBase nuiObject::GetAttribute(const nglString& rName) const
 }
 
 
+bool nuiObject::HasInstanceAttributes() const
+{
+  return !mInstanceAttributes.empty();
+}
+
 void nuiObject::AddAttribute(const nglString& rName, nuiAttributeBase* pAttribute)
 {
   CheckValid();
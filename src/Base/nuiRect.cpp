@@ -10,15 +10,40 @@
 
 void nuiRect::Transform(const nuiMatrix& rMatrix)
 {
-  nuiVector v1(mLeft,mTop,0),v2(mRight, mBottom,0);
-  v1 = rMatrix * v1;
-  v2 = rMatrix * v2;
-
-  mLeft   = v1[0];
-  mTop    = v1[1];
-  mRight  = v2[0];
-  mBottom = v2[1];
+  Transform(rMatrix, this, this, 1);
+}
 
+void nuiRect::Transform(const nuiMatrix& rMatrix, const nuiRect* pIn, nuiRect* pOut, size_t Count)
+{
+#if (defined NGL_MATRIX_SSE) && (defined NUI_USE_FLOATS)
+  // The members are stored as (left, right, top, bottom) so both corners are transformed at once:
+  // (left, right, left, right) * (M11, M11, M21, M21) + (top, bottom, top, bottom) * (M12, M12, M22, M22) + (M14, M14, M24, M24)
+  const __m128 c0 = _mm_loadu_ps(rMatrix.Array);
+  const __m128 c1 = _mm_loadu_ps(rMatrix.Array + 4);
+  const __m128 c3 = _mm_loadu_ps(rMatrix.Array + 12);
+  const __m128 x = NGL_SWIZZLE(c0, 0, 0, 1, 1);
+  const __m128 y = NGL_SWIZZLE(c1, 0, 0, 1, 1);
+  const __m128 t = NGL_SWIZZLE(c3, 0, 0, 1, 1);
+  for (size_t i = 0; i < Count; i++)
+  {
+    const __m128 rect = _mm_loadu_ps(&pIn[i].mLeft);
+    __m128 r = _mm_mul_ps(_mm_movelh_ps(rect, rect), x);
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_movehl_ps(rect, rect), y));
+    _mm_storeu_ps(&pOut[i].mLeft, _mm_add_ps(r, t));
+  }
+#else
+  for (size_t i = 0; i < Count; i++)
+  {
+    nuiVector v1(pIn[i].mLeft, pIn[i].mTop, 0), v2(pIn[i].mRight, pIn[i].mBottom, 0);
+    v1 = rMatrix * v1;
+    v2 = rMatrix * v2;
+
+    pOut[i].mLeft   = v1[0];
+    pOut[i].mTop    = v1[1];
+    pOut[i].mRight  = v2[0];
+    pOut[i].mBottom = v2[1];
+  }
+#endif
 }
 
 bool nuiRect::Intersect(const nuiRect& rRect1, const nuiRect& rRect2)
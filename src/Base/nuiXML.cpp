@@ -8,6 +8,7 @@
 #include "nui.h"
 #include "nuiXML.h"
 #include "nuiFlags.h"
+#include "nuiMemoryTracker.h"
 #define XML_STATIC
 #include "expat.h"
 
@@ -199,16 +200,9 @@ bool nuiXMLParser::Parse(nglIStream* pStream)
 {
   mpStream = pStream;
   
-  bool done = false;
-  do
+  for (;;)
   {
-    char pBuf[BufferSize];
-    nglSize size = mpStream->Read(pBuf, BufferSize, 1);
-    if (size == 0 && mpStream->GetState() != eStreamWait)
-      return false;
-    
-    XML_Status xmlStatus = XML_Parse(mParser, pBuf, size, mpStream->GetState() == eStreamEnd);
-    if (xmlStatus == XML_STATUS_ERROR)
+    if (!Feed())
       return false;
     
     XML_ParsingStatus parsingStatus;
@@ -216,8 +210,35 @@ bool nuiXMLParser::Parse(nglIStream* pStream)
     if (parsingStatus.parsing == XML_FINISHED)
       return true;
   }
-  while(!done);
-  return true;
+}
+
+bool nuiXMLParser::Feed()
+{
+  // Read straight into expat's buffer instead of going through an intermediate copy:
+  void* pBuf = XML_GetBuffer(mParser, BufferSize);
+  if (!pBuf)
+    return false;
+  
+  int64 size = mpStream->Read(pBuf, BufferSize, 1);
+  nglStreamState state = mpStream->GetState();
+  if (size < 0 || state == eStreamError)
+    return false;
+  
+  // A stream whose size is a multiple of BufferSize may only report its end on the following empty read:
+  bool last = (state == eStreamEnd) || (size == 0 && state != eStreamWait);
+  return XML_ParseBuffer(mParser, (int)size, last) != XML_STATUS_ERROR;
+}
+
+nglString nuiXMLParser::GetError() const
+{
+  XML_Error error = XML_GetErrorCode(mParser);
+  if (error == XML_ERROR_NONE)
+    return nglString::Null;
+  
+  nglString message(XML_ErrorString(error));
+  nglString str;
+  str.CFormat(_T("%ls (line %d, column %d)"), message.GetChars(), (int)XML_GetCurrentLineNumber(mParser), (int)XML_GetCurrentColumnNumber(mParser) + 1);
+  return str;
 }
 
 void nuiXMLParser::Stop()
@@ -285,18 +306,13 @@ public:
   virtual void ProcessingInstruction(const nuiXML_Char* target, const nuiXML_Char* data);
   virtual void Comment(const nuiXML_Char* data);
 protected:
-  
-  nglIStream* mpStream;
-  
-  //    static const uint32 BufferSize = 1024;
-  static const uint32 BufferSize = 4096;
+  void FlushText();
   
   nuiXML* mpRootNode;
   nuiXMLNode* mpCurrentNode;
   bool mIsRootNode;
   bool mIsTextNode;
-  
-  XML_Parser mParser;
+  std::string mText; ///< UTF-8 text of the current text node, converted once when the node is complete
 };
 
 nuiXMLBuilder::nuiXMLBuilder()
@@ -313,8 +329,24 @@ bool nuiXMLBuilder::Parse(nglIStream* pStream, nuiXML* pRoot)
   mpCurrentNode = pRoot;
   mIsRootNode = true;
   mIsTextNode = false;
+  mText.clear();
   
-  return nuiXMLParser::Parse(pStream);
+  bool res = nuiXMLParser::Parse(pStream);
+  FlushText();
+  return res;
+}
+
+void nuiXMLBuilder::FlushText()
+{
+  if (!mIsTextNode || mText.empty())
+    return;
+  
+  nglString text(mText.data(), (int)mText.size(), eUTF8);
+  if (mpCurrentNode->GetValue().IsEmpty())
+    mpCurrentNode->SetValue(text);
+  else
+    mpCurrentNode->SetValue(mpCurrentNode->GetValue() + text);
+  mText.clear();
 }
 
 void nuiXMLBuilder::StartElement(const XML_Char* name, const XML_Char** atts)
@@ -323,6 +355,7 @@ void nuiXMLBuilder::StartElement(const XML_Char* name, const XML_Char** atts)
   {
     if (mIsTextNode)
     {
+      FlushText();
       mpCurrentNode = mpCurrentNode->GetParent();
       mIsTextNode = false;
     }
@@ -347,6 +380,7 @@ void nuiXMLBuilder::EndElement(const XML_Char* name)
   {
     if (mIsTextNode)
     {
+      FlushText();
       mpCurrentNode = mpCurrentNode->GetParent();
       mIsTextNode = false;
     }
@@ -375,18 +409,21 @@ void nuiXMLBuilder::Characters(const XML_Char* s, int len)
       mIsTextNode = true;
       mIsRootNode = false;
     }
-    mpCurrentNode->SetValue(mpCurrentNode->GetValue() + nglString(s, len, eUTF8));
+    // expat splits the text at each line or entity: convert the whole run at once rather than piece by piece.
+    mText.append(s, len);
   }
 }
 
 void nuiXMLBuilder::ProcessingInstruction(const XML_Char* target, const XML_Char* data)
 {
+  FlushText();
   nuiXMLNode* pNode = new nuiXMLNode(_T("##comment"), mpCurrentNode);
   pNode->SetValue(nglString(target, eUTF8) + _T(" ") + nglString(data, eUTF8));
 }
 
 void nuiXMLBuilder::Comment(const XML_Char* data)
 {
+  FlushText();
   nuiXMLNode* pNode = new nuiXMLNode(_T("##comment"), mpCurrentNode);
   pNode->SetValue(nglString(data, eUTF8));
 }
@@ -398,6 +435,8 @@ nuiXMLNode::nuiXMLNode(const nglString& rName, nuiXMLNode* pParent)
   mName = rName;
   mpParent = pParent;
   mpTag = NULL;
+  mMemoryBytes = GetMemoryBytes();
+  NUI_MEMORY_ADD(eMemoryXML, this, mMemoryBytes);
   if (pParent)
     pParent->AddChild(this);
   
@@ -408,6 +447,8 @@ nuiXMLNode::nuiXMLNode(const char* pName, nuiXMLNode* pParent)
   mName = nglString(pName);
   mpParent = pParent;
   mpTag = NULL;
+  mMemoryBytes = GetMemoryBytes();
+  NUI_MEMORY_ADD(eMemoryXML, this, mMemoryBytes);
   if (pParent)
     pParent->AddChild(this);
   
@@ -416,6 +457,8 @@ nuiXMLNode::nuiXMLNode(const char* pName, nuiXMLNode* pParent)
 nuiXMLNode::nuiXMLNode(const nuiXMLNode& rOriginal)
 {
   // Private method: no copy constructor allowed!
+  mMemoryBytes = GetMemoryBytes();
+  NUI_MEMORY_ADD(eMemoryXML, this, mMemoryBytes);
 }
 
 nuiXMLNode::~nuiXMLNode()
@@ -425,6 +468,56 @@ nuiXMLNode::~nuiXMLNode()
   
   for (it = mpChildren.begin(); it!=end; ++it)
     delete (*it);
+
+  NUI_MEMORY_REMOVE(eMemoryXML, this, mMemoryBytes);
+}
+
+int64 nuiXMLNode::GetMemoryBytes() const
+{
+  int64 bytes = sizeof(nuiXMLNode) + (mName.GetLength() + mValue.GetLength()) * sizeof(nglChar);
+  nuiXMLAttributeList::const_iterator it = mAttributes.begin();
+  nuiXMLAttributeList::const_iterator end = mAttributes.end();
+  for (; it != end; ++it)
+    bytes += GetAttributeBytes(it->first, it->second);
+  return bytes;
+}
+
+int64 nuiXMLNode::GetAttributeBytes(const nglString& rName, const nglString& rValue)
+{
+  return sizeof(nuiXMLAttributeList::value_type) + (rName.GetLength() + rValue.GetLength()) * sizeof(nglChar);
+}
+
+void nuiXMLNode::UpdateMemoryStats(int64 Delta)
+{
+  if (!Delta)
+    return;
+  NUI_MEMORY_RESIZE(eMemoryXML, this, mMemoryBytes, mMemoryBytes + Delta);
+  mMemoryBytes += Delta;
+}
+
+void nuiXMLNode::StoreAttribute(const nglString& rName, const nglString& rValue)
+{
+  // Only account for the entry that changes, the other attributes keep their size:
+  nuiXMLAttributeList::iterator it = mAttributes.lower_bound(rName);
+  if (it == mAttributes.end() || mAttributes.key_comp()(rName, it->first))
+  {
+    mAttributes.insert(it, nuiXMLAttributeList::value_type(rName, rValue));
+    UpdateMemoryStats(GetAttributeBytes(rName, rValue));
+  }
+  else
+  {
+    int64 delta = ((int64)rValue.GetLength() - (int64)it->second.GetLength()) * sizeof(nglChar);
+    it->second = rValue;
+    UpdateMemoryStats(delta);
+  }
+}
+
+void nuiXMLNode::StoreNameAndValue(const nglString& rName, const nglString& rValue)
+{
+  int64 delta = ((int64)(rName.GetLength() + rValue.GetLength()) - (int64)(mName.GetLength() + mValue.GetLength())) * sizeof(nglChar);
+  mName = rName;
+  mValue = rValue;
+  UpdateMemoryStats(delta);
 }
 
 nuiXMLNode* nuiXMLNode::Clone(nuiXMLNode* pParent) const
@@ -433,6 +526,7 @@ nuiXMLNode* nuiXMLNode::Clone(nuiXMLNode* pParent) const
   
   pNode->mValue = mValue;
   pNode->mAttributes = mAttributes;
+  pNode->UpdateMemoryStats(mMemoryBytes - pNode->mMemoryBytes); // Same name, value and attributes as this node
   
   list<nuiXMLNode*>::const_iterator it;
   list<nuiXMLNode*>::const_iterator end = mpChildren.end();
@@ -450,12 +544,12 @@ const nglString& nuiXMLNode::GetName() const
 
 void nuiXMLNode::SetName(const nglString& rName)
 {
-  mName = rName;
+  StoreNameAndValue(rName, mValue);
 }
 
 void nuiXMLNode::SetName(const char* pName)
 {
-  mName = nglString(pName);
+  StoreNameAndValue(nglString(pName), mValue);
 }
 
 const nglString& nuiXMLNode::GetValue() const
@@ -465,16 +559,15 @@ const nglString& nuiXMLNode::GetValue() const
 
 void nuiXMLNode::SetValue(const nglString& rValue)
 {
-  mValue = rValue;
   if (mName.GetLeft(2) != _T("##"))
-    mName = _T("##") + mName;
+    StoreNameAndValue(_T("##") + mName, rValue);
+  else
+    StoreNameAndValue(mName, rValue);
 }
 
 void nuiXMLNode::SetValue(const char* pValue)
 {
-  mValue = nglString(pValue);
-  if (mName.GetLeft(2) != _T("##"))
-    mName = _T("##") + mName;
+  SetValue(nglString(pValue));
 }
 
 // Node attributes management:
@@ -488,13 +581,15 @@ const nglString& nuiXMLNode::GetAttribute (const nglString& rName) const
 
 void nuiXMLNode::SetAttribute (const nglString& rName, const nglString& rValue)
 {
-  mAttributes[rName] = rValue;
+  StoreAttribute(rName, rValue);
 }
 
 void nuiXMLNode::SetAttribute (const nglString& rName, const nglChar* pValue)
 {
   if (pValue)
-    mAttributes[rName] = pValue;
+  {
+    StoreAttribute(rName, nglString(pValue));
+  }
   else
     DelAttribute(rName);
 }
@@ -594,9 +689,12 @@ void nuiXMLNode::SetAttribute(const nglString& rName, nuiOrientation value)
 
 bool nuiXMLNode::DelAttribute(const nglString& rName)
 {    
-  bool res = HasAttribute(rName);
-  mAttributes.erase(rName);
-  return res;
+  nuiXMLAttributeList::iterator it = mAttributes.find(rName);
+  if (it == mAttributes.end())
+    return false;
+  UpdateMemoryStats(-GetAttributeBytes(it->first, it->second));
+  mAttributes.erase(it);
+  return true;
 }
 
 bool nuiXMLNode::HasAttribute(const nglString& rName) const
@@ -616,8 +714,7 @@ const nglString& nuiXMLNode::GetAttribute(const char* pName) const
 
 void nuiXMLNode::SetAttribute(const char* pName, const nglString& rValue)
 {
-  nglString name(pName);
-  mAttributes[name] = rValue;
+  StoreAttribute(nglString(pName), rValue);
 }
 
 void nuiXMLNode::SetAttribute (const char* pName, const char* pValue)
@@ -625,8 +722,7 @@ void nuiXMLNode::SetAttribute (const char* pName, const char* pValue)
   nglString name(pName);
   if (pValue)
   {
-    nglString value(pValue);
-    mAttributes[name] = value;
+    StoreAttribute(name, nglString(pValue));
   }
   else
     DelAttribute(name);
@@ -692,10 +788,7 @@ void nuiXMLNode::SetAttribute(const char* pName, nuiOrientation value)
 
 bool nuiXMLNode::DelAttribute (const char* pName)
 {    
-  nglString name;
-  bool res = HasAttribute(name);
-  mAttributes.erase(name);
-  return res;
+  return DelAttribute(nglString(pName));
 }
 
 bool nuiXMLNode::HasAttribute (const char* pName) const
@@ -703,6 +796,35 @@ bool nuiXMLNode::HasAttribute (const char* pName) const
   return mAttributes.find(nglString(pName)) != mAttributes.end();
 }
 
+///////////////////////////
+// UTF-8 versions
+void nuiXMLNode::SetName(const nuiString8& rName)
+{
+  StoreNameAndValue(rName.ToString(), mValue);
+}
+
+void nuiXMLNode::SetValue(const nuiString8& rValue)
+{
+  SetValue(rValue.ToString());
+}
+
+void nuiXMLNode::SetAttribute(const nuiString8& rName, const nuiString8& rValue)
+{
+  StoreAttribute(rName.ToString(), rValue.ToString());
+}
+
+bool nuiXMLNode::HasAttribute(const nuiString8& rName) const
+{
+  return mAttributes.find(rName.ToString()) != mAttributes.end();
+}
+
+const nglString& nuiXMLNode::GetAttribute(const nuiString8& rName) const
+{
+  nuiXMLAttributeList::const_iterator it = mAttributes.find(rName.ToString());
+  if (it == mAttributes.end())
+    return nglString::Null;
+  return (*it).second;
+}
 
 ///////////////////////////
 uint nuiXMLNode::GetAttributeCount () const
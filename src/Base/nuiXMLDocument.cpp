@@ -0,0 +1,563 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiXMLDocument.h"
+#define XML_STATIC
+#include "expat.h"
+
+// Smallest block of the arena. The blocks grow with the document so that big documents only need a few of them.
+#define NUI_XML_DOCUMENT_BLOCK_SIZE (64 * 1024)
+
+static uint32 nuiXMLHashName(const char* pName, size_t Length)
+{
+  // FNV-1a
+  uint32 hash = 2166136261U;
+  for (size_t i = 0; i < Length; i++)
+  {
+    hash ^= (uint8)pName[i];
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+static bool nuiXMLIsBlank(const std::string& rText)
+{
+  for (size_t i = 0; i < rText.size(); i++)
+  {
+    char c = rText[i];
+    if (c != ' ' && c != '\n' && c != '\t' && c != '\r')
+      return false;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class nuiXMLDocumentBuilder : public nuiXMLParser
+{
+public:
+  nuiXMLDocumentBuilder(nuiXMLDocument& rDocument, bool KeepBlankText);
+  virtual ~nuiXMLDocumentBuilder();
+
+  bool Build(nglIStream* pStream);
+
+  virtual void StartElement(const nuiXML_Char* name, const nuiXML_Char** atts);
+  virtual void EndElement(const nuiXML_Char* name);
+  virtual void Characters(const nuiXML_Char* s, int len);
+  virtual void ProcessingInstruction(const nuiXML_Char* target, const nuiXML_Char* data);
+  virtual void Comment(const nuiXML_Char* data);
+
+protected:
+  typedef nuiXMLDocument::Node Node;
+
+  Node* AddNode(Node::Type Type);
+  void FlushText();
+  void OutOfMemory();
+
+  nuiXMLDocument& mrDocument;
+  bool mKeepBlankText;
+  std::string mText; ///< Character data of the text node being read, expat reports it by pieces
+
+  struct OpenElement
+  {
+    Node* mpNode;
+    Node* mpLastChild;
+  };
+  std::vector<OpenElement> mStack;
+};
+
+nuiXMLDocumentBuilder::nuiXMLDocumentBuilder(nuiXMLDocument& rDocument, bool KeepBlankText)
+: mrDocument(rDocument), mKeepBlankText(KeepBlankText)
+{
+}
+
+nuiXMLDocumentBuilder::~nuiXMLDocumentBuilder()
+{
+}
+
+bool nuiXMLDocumentBuilder::Build(nglIStream* pStream)
+{
+  if (!Parse(pStream))
+  {
+    if (mrDocument.mError.IsEmpty())
+    {
+      mrDocument.mError = GetError();
+      if (mrDocument.mError.IsEmpty())
+        mrDocument.mError = _T("Read error");
+    }
+    return false;
+  }
+  return true;
+}
+
+nuiXMLDocument::Node* nuiXMLDocumentBuilder::AddNode(Node::Type Type)
+{
+  Node* pNode = (Node*)mrDocument.Allocate(sizeof(Node));
+  if (!pNode)
+    return NULL;
+
+  pNode->mType = Type;
+  pNode->mTextLength = 0;
+  pNode->mAttributeCount = 0;
+  pNode->mChildrenCount = 0;
+  pNode->mpName = "";
+  pNode->mpText = "";
+  pNode->mpAttributes = NULL;
+  pNode->mpParent = NULL;
+  pNode->mpFirstChild = NULL;
+  pNode->mpNextSibling = NULL;
+
+  if (mStack.empty())
+  {
+    mrDocument.mpRoot = pNode;
+    return pNode;
+  }
+
+  OpenElement& rParent(mStack.back());
+  pNode->mpParent = rParent.mpNode;
+  if (rParent.mpLastChild)
+    rParent.mpLastChild->mpNextSibling = pNode;
+  else
+    rParent.mpNode->mpFirstChild = pNode;
+  rParent.mpLastChild = pNode;
+  rParent.mpNode->mChildrenCount++;
+  return pNode;
+}
+
+void nuiXMLDocumentBuilder::FlushText()
+{
+  if (mText.empty())
+    return;
+
+  if (!mStack.empty() && (mKeepBlankText || !nuiXMLIsBlank(mText)))
+  {
+    Node* pNode = AddNode(Node::eText);
+    if (pNode)
+    {
+      pNode->mpText = mrDocument.StoreString(mText.data(), mText.size());
+      pNode->mTextLength = (uint32)mText.size();
+    }
+    if (!pNode || !pNode->mpText)
+      OutOfMemory();
+  }
+  mText.clear();
+}
+
+void nuiXMLDocumentBuilder::OutOfMemory()
+{
+  mrDocument.mError = _T("Out of memory");
+  Stop();
+}
+
+void nuiXMLDocumentBuilder::StartElement(const nuiXML_Char* name, const nuiXML_Char** atts)
+{
+  FlushText();
+  Node* pNode = AddNode(Node::eElement);
+  if (!pNode)
+  {
+    OutOfMemory();
+    return;
+  }
+  pNode->mpName = mrDocument.Intern(name, strlen(name));
+
+  uint32 count = 0;
+  while (atts[count * 2])
+    count++;
+  if (count)
+  {
+    const char** pAttributes = (const char**)mrDocument.Allocate(count * 2 * sizeof(const char*));
+    if (pAttributes)
+    {
+      for (uint32 i = 0; i < count * 2; i += 2)
+      {
+        pAttributes[i] = mrDocument.Intern(atts[i], strlen(atts[i]));
+        pAttributes[i + 1] = mrDocument.StoreString(atts[i + 1], strlen(atts[i + 1]));
+        if (!pAttributes[i] || !pAttributes[i + 1])
+          pAttributes = NULL;
+        if (!pAttributes)
+          break;
+      }
+    }
+    pNode->mpAttributes = pAttributes;
+    pNode->mAttributeCount = pAttributes ? count : 0;
+    if (!pAttributes)
+      OutOfMemory();
+  }
+  if (!pNode->mpName)
+    OutOfMemory();
+
+  OpenElement element;
+  element.mpNode = pNode;
+  element.mpLastChild = NULL;
+  mStack.push_back(element);
+}
+
+void nuiXMLDocumentBuilder::EndElement(const nuiXML_Char* name)
+{
+  FlushText();
+  if (!mStack.empty())
+    mStack.pop_back();
+}
+
+void nuiXMLDocumentBuilder::Characters(const nuiXML_Char* s, int len)
+{
+  mText.append(s, len);
+}
+
+void nuiXMLDocumentBuilder::ProcessingInstruction(const nuiXML_Char* target, const nuiXML_Char* data)
+{
+  FlushText();
+  if (mStack.empty())
+    return;
+
+  Node* pNode = AddNode(Node::eProcessingInstruction);
+  if (pNode)
+  {
+    pNode->mpName = mrDocument.Intern(target, strlen(target));
+    pNode->mTextLength = (uint32)strlen(data);
+    pNode->mpText = mrDocument.StoreString(data, pNode->mTextLength);
+  }
+  if (!pNode || !pNode->mpName || !pNode->mpText)
+    OutOfMemory();
+}
+
+void nuiXMLDocumentBuilder::Comment(const nuiXML_Char* data)
+{
+  FlushText();
+  if (mStack.empty())
+    return;
+
+  Node* pNode = AddNode(Node::eComment);
+  if (pNode)
+  {
+    pNode->mTextLength = (uint32)strlen(data);
+    pNode->mpText = mrDocument.StoreString(data, pNode->mTextLength);
+  }
+  if (!pNode || !pNode->mpText)
+    OutOfMemory();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// nuiXMLDocument::Node
+nuiXMLDocument::Node::Type nuiXMLDocument::Node::GetType() const
+{
+  return mType;
+}
+
+bool nuiXMLDocument::Node::IsElement() const
+{
+  return mType == eElement;
+}
+
+bool nuiXMLDocument::Node::IsText() const
+{
+  return mType == eText;
+}
+
+const char* nuiXMLDocument::Node::GetName() const
+{
+  return mpName;
+}
+
+const char* nuiXMLDocument::Node::GetText() const
+{
+  return mpText;
+}
+
+uint32 nuiXMLDocument::Node::GetTextLength() const
+{
+  return mTextLength;
+}
+
+nglString nuiXMLDocument::Node::GetValue() const
+{
+  if (mType != eElement)
+    return nglString(mpText, mTextLength, eUTF8);
+
+  std::string text;
+  for (const Node* pChild = mpFirstChild; pChild; pChild = pChild->mpNextSibling)
+  {
+    if (pChild->mType == eText)
+      text.append(pChild->mpText, pChild->mTextLength);
+  }
+  return nglString(text.data(), (int)text.size(), eUTF8);
+}
+
+uint32 nuiXMLDocument::Node::GetAttributeCount() const
+{
+  return mAttributeCount;
+}
+
+const char* nuiXMLDocument::Node::GetAttributeName(uint32 Index) const
+{
+  NGL_ASSERT(Index < mAttributeCount);
+  return mpAttributes[Index * 2];
+}
+
+const char* nuiXMLDocument::Node::GetAttributeValue(uint32 Index) const
+{
+  NGL_ASSERT(Index < mAttributeCount);
+  return mpAttributes[Index * 2 + 1];
+}
+
+const char* nuiXMLDocument::Node::GetAttribute(const char* pName) const
+{
+  for (uint32 i = 0; i < mAttributeCount * 2; i += 2)
+  {
+    if (mpAttributes[i] == pName || !strcmp(mpAttributes[i], pName))
+      return mpAttributes[i + 1];
+  }
+  return NULL;
+}
+
+bool nuiXMLDocument::Node::HasAttribute(const char* pName) const
+{
+  return GetAttribute(pName) != NULL;
+}
+
+const nuiXMLDocument::Node* nuiXMLDocument::Node::GetParent() const
+{
+  return mpParent;
+}
+
+const nuiXMLDocument::Node* nuiXMLDocument::Node::GetFirstChild() const
+{
+  return mpFirstChild;
+}
+
+const nuiXMLDocument::Node* nuiXMLDocument::Node::GetNextSibling() const
+{
+  return mpNextSibling;
+}
+
+uint32 nuiXMLDocument::Node::GetChildrenCount() const
+{
+  return mChildrenCount;
+}
+
+const nuiXMLDocument::Node* nuiXMLDocument::Node::GetChild(const char* pName) const
+{
+  for (const Node* pChild = mpFirstChild; pChild; pChild = pChild->mpNextSibling)
+  {
+    if (pChild->mType == eElement && (pChild->mpName == pName || !strcmp(pChild->mpName, pName)))
+      return pChild;
+  }
+  return NULL;
+}
+
+const nuiXMLDocument::Node* nuiXMLDocument::Node::GetNextSibling(const char* pName) const
+{
+  for (const Node* pSibling = mpNextSibling; pSibling; pSibling = pSibling->mpNextSibling)
+  {
+    if (pSibling->mType == eElement && (pSibling->mpName == pName || !strcmp(pSibling->mpName, pName)))
+      return pSibling;
+  }
+  return NULL;
+}
+
+nuiXMLNode* nuiXMLDocument::Node::CreateXMLNode(nuiXMLNode* pParent) const
+{
+  nuiXMLNode* pNode = NULL;
+  switch (mType)
+  {
+  case eElement:
+    pNode = new nuiXMLNode(nglString(mpName, eUTF8), pParent);
+    for (uint32 i = 0; i < mAttributeCount * 2; i += 2)
+      pNode->SetAttribute(nglString(mpAttributes[i], eUTF8), nglString(mpAttributes[i + 1], eUTF8));
+    for (const Node* pChild = mpFirstChild; pChild; pChild = pChild->mpNextSibling)
+      pChild->CreateXMLNode(pNode);
+    break;
+  case eText:
+    pNode = new nuiXMLNode(_T("##text"), pParent);
+    pNode->SetValue(nglString(mpText, mTextLength, eUTF8));
+    break;
+  case eComment:
+    pNode = new nuiXMLNode(_T("##comment"), pParent);
+    pNode->SetValue(nglString(mpText, mTextLength, eUTF8));
+    break;
+  case eProcessingInstruction:
+    pNode = new nuiXMLNode(_T("##comment"), pParent);
+    pNode->SetValue(nglString(mpName, eUTF8) + _T(" ") + nglString(mpText, mTextLength, eUTF8));
+    break;
+  }
+  return pNode;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// nuiXMLDocument
+nuiXMLDocument::nuiXMLDocument()
+: mpCurrent(NULL),
+  mAvailable(0),
+  mUsage(0),
+  mNameCount(0),
+  mpRoot(NULL)
+{
+}
+
+nuiXMLDocument::~nuiXMLDocument()
+{
+  Clear();
+}
+
+void nuiXMLDocument::Clear()
+{
+  for (uint32 i = 0; i < mBlocks.size(); i++)
+    free(mBlocks[i].mpData);
+  mBlocks.clear();
+  mpCurrent = NULL;
+  mAvailable = 0;
+  mUsage = 0;
+  std::vector<const char*>().swap(mNames);
+  mNameCount = 0;
+  mpRoot = NULL;
+  mError.Wipe();
+}
+
+bool nuiXMLDocument::Load(nglIStream& rStream, bool KeepBlankText)
+{
+  Clear();
+  nuiXMLDocumentBuilder builder(*this, KeepBlankText);
+  if (!builder.Build(&rStream))
+  {
+    mpRoot = NULL;
+    return false;
+  }
+  return true;
+}
+
+const nuiXMLDocument::Node* nuiXMLDocument::GetRoot() const
+{
+  return mpRoot;
+}
+
+const char* nuiXMLDocument::GetName(const char* pName) const
+{
+  size_t length = strlen(pName);
+  return FindName(pName, length, nuiXMLHashName(pName, length));
+}
+
+const nglString& nuiXMLDocument::GetError() const
+{
+  return mError;
+}
+
+size_t nuiXMLDocument::GetMemoryUsage() const
+{
+  return mUsage + mNames.capacity() * sizeof(const char*);
+}
+
+void* nuiXMLDocument::Allocate(size_t Size)
+{
+  Size = (Size + 7) & ~(size_t)7;
+
+  // StoreString packs the strings without padding, so realign the current position on 8 bytes first:
+  size_t padding = (8 - ((size_t)mpCurrent & 7)) & 7;
+  if (padding <= mAvailable)
+  {
+    mpCurrent += padding;
+    mAvailable -= padding;
+  }
+  else
+  {
+    mAvailable = 0;
+  }
+
+  if (Size > mAvailable)
+  {
+    Block block;
+    block.mSize = MAX(mUsage / 2, (size_t)NUI_XML_DOCUMENT_BLOCK_SIZE);
+    block.mSize = MAX(block.mSize, Size);
+    block.mpData = (uint8*)malloc(block.mSize);
+    if (!block.mpData)
+      return NULL;
+    mBlocks.push_back(block);
+    mUsage += block.mSize;
+    mpCurrent = block.mpData;
+    mAvailable = block.mSize;
+  }
+
+  void* pData = mpCurrent;
+  mpCurrent += Size;
+  mAvailable -= Size;
+  return pData;
+}
+
+const char* nuiXMLDocument::StoreString(const char* pString, size_t Length)
+{
+  if (!Length)
+    return "";
+
+  // Strings don't need the 8 bytes alignment of the nodes, pack them when they fit in the current block:
+  char* pCopy;
+  if (Length + 1 <= mAvailable)
+  {
+    pCopy = (char*)mpCurrent;
+    mpCurrent += Length + 1;
+    mAvailable -= Length + 1;
+  }
+  else
+  {
+    pCopy = (char*)Allocate(Length + 1);
+    if (!pCopy)
+      return NULL;
+  }
+  memcpy(pCopy, pString, Length);
+  pCopy[Length] = 0;
+  return pCopy;
+}
+
+const char* nuiXMLDocument::FindName(const char* pName, size_t Length, uint32 Hash) const
+{
+  if (mNames.empty())
+    return NULL;
+
+  uint32 mask = (uint32)mNames.size() - 1;
+  for (uint32 i = Hash & mask; mNames[i]; i = (i + 1) & mask)
+  {
+    const char* pCandidate = mNames[i];
+    if (!strncmp(pCandidate, pName, Length) && !pCandidate[Length])
+      return pCandidate;
+  }
+  return NULL;
+}
+
+const char* nuiXMLDocument::Intern(const char* pName, size_t Length)
+{
+  uint32 hash = nuiXMLHashName(pName, Length);
+  const char* pInterned = FindName(pName, Length, hash);
+  if (pInterned)
+    return pInterned;
+
+  // Keep the table at most half full:
+  if ((mNameCount + 1) * 2 > mNames.size())
+  {
+    std::vector<const char*> names(MAX((size_t)64, mNames.size() * 2), (const char*)NULL);
+    uint32 mask = (uint32)names.size() - 1;
+    for (uint32 i = 0; i < mNames.size(); i++)
+    {
+      if (!mNames[i])
+        continue;
+      uint32 j = nuiXMLHashName(mNames[i], strlen(mNames[i])) & mask;
+      while (names[j])
+        j = (j + 1) & mask;
+      names[j] = mNames[i];
+    }
+    mNames.swap(names);
+  }
+
+  pInterned = StoreString(pName, Length);
+  if (!pInterned)
+    return NULL;
+
+  uint32 mask = (uint32)mNames.size() - 1;
+  uint32 i = hash & mask;
+  while (mNames[i])
+    i = (i + 1) & mask;
+  mNames[i] = pInterned;
+  mNameCount++;
+  return pInterned;
+}
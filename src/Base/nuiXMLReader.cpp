@@ -0,0 +1,353 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiXMLReader.h"
+#define XML_STATIC
+#include "expat.h"
+
+nuiXMLReader::nuiXMLReader(nglIStream* pStream, bool SkipBlankText)
+: mCurrent(0),
+  mNext(0),
+  mEvent(eNone),
+  mDepth(0),
+  mSkipLevel(0),
+  mSkipBlankText(SkipBlankText),
+  mFinished(false)
+{
+  mpStream = pStream;
+}
+
+nuiXMLReader::~nuiXMLReader()
+{
+}
+
+nuiXMLReader::Event nuiXMLReader::Next()
+{
+  if (mEvent == eEndOfDocument || mEvent == eError)
+    return mEvent;
+  if (mEvent == eEndElement)
+    mDepth--;
+
+  for (;;)
+  {
+    if (mNext < mRecords.size() && !IsPending(mNext))
+    {
+      mCurrent = mNext++;
+      const Record& rRecord(mRecords[mCurrent]);
+      if (mSkipBlankText && rRecord.mType == eText && IsBlank(rRecord))
+        continue;
+
+      mEvent = rRecord.mType;
+      if (mEvent == eStartElement)
+        mDepth++;
+      return mEvent;
+    }
+
+    if (mFinished)
+    {
+      mEvent = eEndOfDocument;
+      return mEvent;
+    }
+
+    Compact();
+    if (!Read())
+      return mEvent;
+  }
+}
+
+bool nuiXMLReader::SkipElement()
+{
+  if (mEvent != eStartElement)
+    return mEvent != eError;
+
+  // Walk the events that are already queued:
+  uint32 level = 1;
+  while (mNext < mRecords.size())
+  {
+    Event type = mRecords[mNext++].mType;
+    if (type == eStartElement)
+    {
+      level++;
+    }
+    else if (type == eEndElement && !--level)
+    {
+      mCurrent = mNext - 1;
+      mEvent = eEndElement;
+      return true;
+    }
+  }
+
+  // Let expat parse the rest of the element without recording anything but its end:
+  mSkipLevel = level;
+  Compact();
+  while (mSkipLevel)
+  {
+    if (mFinished)
+    {
+      mEvent = eError;
+      return false;
+    }
+    if (!Read())
+      return false;
+  }
+
+  mCurrent = 0;
+  mNext = 1;
+  mEvent = eEndElement;
+  return true;
+}
+
+nuiXMLReader::Event nuiXMLReader::GetEvent() const
+{
+  return mEvent;
+}
+
+uint32 nuiXMLReader::GetDepth() const
+{
+  return mDepth;
+}
+
+const char* nuiXMLReader::GetName() const
+{
+  if (mEvent != eStartElement && mEvent != eEndElement && mEvent != eProcessingInstruction)
+    return "";
+  return &mData[mRecords[mCurrent].mName];
+}
+
+uint32 nuiXMLReader::GetNameLength() const
+{
+  if (mEvent != eStartElement && mEvent != eEndElement && mEvent != eProcessingInstruction)
+    return 0;
+  return mRecords[mCurrent].mNameLength;
+}
+
+const char* nuiXMLReader::GetText() const
+{
+  if (mEvent != eText && mEvent != eComment && mEvent != eProcessingInstruction)
+    return "";
+  return &mData[mRecords[mCurrent].mText];
+}
+
+uint32 nuiXMLReader::GetTextLength() const
+{
+  if (mEvent != eText && mEvent != eComment && mEvent != eProcessingInstruction)
+    return 0;
+  return mRecords[mCurrent].mTextLength;
+}
+
+uint32 nuiXMLReader::GetAttributeCount() const
+{
+  if (mEvent != eStartElement)
+    return 0;
+  return mRecords[mCurrent].mAttributeCount;
+}
+
+const char* nuiXMLReader::GetAttributeName(uint32 Index) const
+{
+  NGL_ASSERT(Index < GetAttributeCount());
+  return &mData[mAttributes[mRecords[mCurrent].mAttributes + Index].mName];
+}
+
+const char* nuiXMLReader::GetAttributeValue(uint32 Index) const
+{
+  NGL_ASSERT(Index < GetAttributeCount());
+  return &mData[mAttributes[mRecords[mCurrent].mAttributes + Index].mValue];
+}
+
+uint32 nuiXMLReader::GetAttributeValueLength(uint32 Index) const
+{
+  NGL_ASSERT(Index < GetAttributeCount());
+  return mAttributes[mRecords[mCurrent].mAttributes + Index].mValueLength;
+}
+
+const char* nuiXMLReader::GetAttribute(const char* pName) const
+{
+  uint32 count = GetAttributeCount();
+  for (uint32 i = 0; i < count; i++)
+  {
+    const Attribute& rAttribute(mAttributes[mRecords[mCurrent].mAttributes + i]);
+    if (!strcmp(&mData[rAttribute.mName], pName))
+      return &mData[rAttribute.mValue];
+  }
+  return NULL;
+}
+
+nglString nuiXMLReader::GetError() const
+{
+  if (mEvent != eError)
+    return nglString::Null;
+
+  nglString error(nuiXMLParser::GetError());
+  if (error.IsEmpty())
+    error = _T("Read error");
+  return error;
+}
+
+uint32 nuiXMLReader::Store(const char* pString, uint32 Length)
+{
+  uint32 offset = (uint32)mData.size();
+  mData.insert(mData.end(), pString, pString + Length);
+  mData.push_back(0);
+  return offset;
+}
+
+nuiXMLReader::Record& nuiXMLReader::AddRecord(Event Type)
+{
+  mRecords.push_back(Record());
+  Record& rRecord(mRecords.back());
+  rRecord.mType = Type;
+  rRecord.mName = 0;
+  rRecord.mNameLength = 0;
+  rRecord.mText = 0;
+  rRecord.mTextLength = 0;
+  rRecord.mAttributes = 0;
+  rRecord.mAttributeCount = 0;
+  return rRecord;
+}
+
+bool nuiXMLReader::IsPending(uint32 Index) const
+{
+  return !mFinished && Index + 1 == mRecords.size() && mRecords[Index].mType == eText;
+}
+
+bool nuiXMLReader::IsBlank(const Record& rRecord) const
+{
+  const char* pText = &mData[rRecord.mText];
+  for (uint32 i = 0; i < rRecord.mTextLength; i++)
+  {
+    char c = pText[i];
+    if (c != ' ' && c != '\n' && c != '\t' && c != '\r')
+      return false;
+  }
+  return true;
+}
+
+void nuiXMLReader::Compact()
+{
+  if (mNext < mRecords.size())
+  {
+    // Keep the pending text at the start of the buffers:
+    NGL_ASSERT(mNext + 1 == mRecords.size());
+    Record record(mRecords[mNext]);
+    memmove(&mData[0], &mData[record.mText], record.mTextLength + 1);
+    mData.resize(record.mTextLength + 1);
+    record.mText = 0;
+    mRecords.resize(1);
+    mRecords[0] = record;
+  }
+  else
+  {
+    mRecords.clear();
+    mData.clear();
+  }
+  mAttributes.clear();
+  mCurrent = 0;
+  mNext = 0;
+}
+
+bool nuiXMLReader::Read()
+{
+  if (!Feed())
+  {
+    mEvent = eError;
+    return false;
+  }
+
+  XML_ParsingStatus parsingStatus;
+  XML_GetParsingStatus(mParser, &parsingStatus);
+  mFinished = (parsingStatus.parsing == XML_FINISHED);
+  return true;
+}
+
+void nuiXMLReader::StartElement(const nuiXML_Char* name, const nuiXML_Char** atts)
+{
+  if (mSkipLevel)
+  {
+    mSkipLevel++;
+    return;
+  }
+
+  uint32 length = (uint32)strlen(name);
+  uint32 offset = Store(name, length);
+  Record& rRecord(AddRecord(eStartElement));
+  rRecord.mName = offset;
+  rRecord.mNameLength = length;
+  rRecord.mAttributes = (uint32)mAttributes.size();
+
+  for (uint32 i = 0; atts[i]; i += 2)
+  {
+    Attribute attribute;
+    attribute.mName = Store(atts[i], (uint32)strlen(atts[i]));
+    attribute.mValueLength = (uint32)strlen(atts[i + 1]);
+    attribute.mValue = Store(atts[i + 1], attribute.mValueLength);
+    mAttributes.push_back(attribute);
+  }
+  rRecord.mAttributeCount = (uint32)mAttributes.size() - rRecord.mAttributes;
+}
+
+void nuiXMLReader::EndElement(const nuiXML_Char* name)
+{
+  if (mSkipLevel && --mSkipLevel)
+    return;
+
+  uint32 length = (uint32)strlen(name);
+  uint32 offset = Store(name, length);
+  Record& rRecord(AddRecord(eEndElement));
+  rRecord.mName = offset;
+  rRecord.mNameLength = length;
+}
+
+void nuiXMLReader::Characters(const nuiXML_Char* s, int len)
+{
+  if (mSkipLevel)
+    return;
+
+  if (!mRecords.empty() && mRecords.back().mType == eText)
+  {
+    // Extend the last text, which is always the last string of mData:
+    Record& rRecord(mRecords.back());
+    mData.pop_back();
+    mData.insert(mData.end(), s, s + len);
+    mData.push_back(0);
+    rRecord.mTextLength += len;
+    return;
+  }
+
+  uint32 offset = Store(s, len);
+  Record& rRecord(AddRecord(eText));
+  rRecord.mText = offset;
+  rRecord.mTextLength = len;
+}
+
+void nuiXMLReader::ProcessingInstruction(const nuiXML_Char* target, const nuiXML_Char* data)
+{
+  if (mSkipLevel)
+    return;
+
+  uint32 nameLength = (uint32)strlen(target);
+  uint32 name = Store(target, nameLength);
+  uint32 textLength = (uint32)strlen(data);
+  uint32 text = Store(data, textLength);
+  Record& rRecord(AddRecord(eProcessingInstruction));
+  rRecord.mName = name;
+  rRecord.mNameLength = nameLength;
+  rRecord.mText = text;
+  rRecord.mTextLength = textLength;
+}
+
+void nuiXMLReader::Comment(const nuiXML_Char* data)
+{
+  if (mSkipLevel)
+    return;
+
+  uint32 length = (uint32)strlen(data);
+  uint32 offset = Store(data, length);
+  Record& rRecord(AddRecord(eComment));
+  rRecord.mText = offset;
+  rRecord.mTextLength = length;
+}
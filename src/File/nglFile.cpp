@@ -770,12 +770,28 @@ int64 nglFile::Write (const void* pData, int64 WordCount, uint WordSize)
 	return done;
 }
 
+void nglFile::SetAccessHint(nglFileAccess Access)
+{
+}
+
+const void* nglFile::Map(nglFileSize& rSize, nglFileAccess Access)
+{
+	// Not implemented yet, nglIFile falls back to buffered reads.
+	rSize = 0;
+	return NULL;
+}
+
+void nglFile::Unmap(const void* pData, nglFileSize Size)
+{
+}
 
 #endif // _WIN32_
 
 
 #if ((defined __APPLE__)||(defined _LINUX_))
 
+#include <sys/mman.h>
+
 /* Implemented in file/File_shr.cpp */
 extern const nglChar* File_mode(nglFileMode mode);
 extern const nglChar* File_endian(nglEndian endian);
@@ -977,4 +993,53 @@ int64 nglFile::Write (const void* pData, int64 WordCount, uint WordSize)
   return done;
 }
 
+void nglFile::SetAccessHint(nglFileAccess Access)
+{
+#if (defined _LINUX_) && (defined POSIX_FADV_SEQUENTIAL)
+  if (!IsOpen()) return;
+  int advice = POSIX_FADV_NORMAL;
+  switch (Access)
+  {
+    case eFileAccessNormal    : advice = POSIX_FADV_NORMAL; break;
+    case eFileAccessSequential: advice = POSIX_FADV_SEQUENTIAL; break;
+    case eFileAccessRandom    : advice = POSIX_FADV_RANDOM; break;
+    case eFileAccessWillNeed  : advice = POSIX_FADV_WILLNEED; break;
+  }
+  posix_fadvise(mFD, 0, 0, advice);
+#endif
+}
+
+const void* nglFile::Map(nglFileSize& rSize, nglFileAccess Access)
+{
+  rSize = 0;
+  if (!IsOpen()) return NULL;
+
+  nglFileSize size = GetSize();
+  if (size <= 0 || (nglFileSize)(size_t)size != size) // Empty file or too big for the address space
+    return NULL;
+
+  void* pData = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, mFD, 0);
+  if (pData == MAP_FAILED)
+    return NULL;
+
+  int advice = MADV_NORMAL;
+  switch (Access)
+  {
+    case eFileAccessNormal    : advice = MADV_NORMAL; break;
+    case eFileAccessSequential: advice = MADV_SEQUENTIAL; break;
+    case eFileAccessRandom    : advice = MADV_RANDOM; break;
+    case eFileAccessWillNeed  : advice = MADV_WILLNEED; break;
+  }
+  madvise(pData, (size_t)size, advice);
+
+  rSize = size;
+  return pData;
+}
+
+void nglFile::Unmap(const void* pData, nglFileSize Size)
+{
+  if (pData && Size > 0)
+    munmap(const_cast<void*>(pData), (size_t)Size);
+}
+
 #endif
@@ -11,6 +11,7 @@
 #include "nglVolume.h"
 #include "nglIFile.h"
 #include "nglIOFile.h"
+#include "nuiString8.h"
 
 #if (defined _UIKIT_) || (defined _COCOA_)
 #include "Cocoa/nglPath_Cocoa.h"
@@ -115,6 +116,13 @@ nglPath::nglPath (const nglString& rPathName)
 	InternalSetPath(rPathName.GetChars());
 }
 
+nglPath::nglPath (const nuiString8& rPathName)
+{
+	nglString temp;
+	rPathName.ToString(temp);
+	InternalSetPath(temp.GetChars());
+}
+
 nglPath::nglPath (nglPathBase Base)
 {
 	switch (Base)
@@ -979,6 +987,14 @@ const nglPath& nglPath::operator=(const nglString& rSource)
 	return *this;
 }
 
+const nglPath& nglPath::operator=(const nuiString8& rSource)
+{
+	nglString temp;
+	rSource.ToString(temp);
+	InternalSetPath(temp.GetChars());
+	return *this;
+}
+
 const nglPath& nglPath::operator=(const nglPath& rSource)
 {
 	mPathName = rSource.mPathName;
@@ -1575,7 +1591,7 @@ nglIStream* nglPath::OpenRead() const
       return pVolume->OpenRead(*this);
   }
   
-  nglIFile* pFile = new nglIFile(*this);
+  nglIFile* pFile = new nglIFile(*this, eIFileBuffered);
   if (pFile && !pFile->IsOpen())
   {
     delete pFile;
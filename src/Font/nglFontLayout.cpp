@@ -13,6 +13,7 @@
 #include "nglFontLayout.h"
 #include "nglFontBase.h"
 #include "nglMath.h"
+#include "nuiProfiler.h"
 
 extern float NUI_SCALE_FACTOR;
 extern float NUI_INV_SCALE_FACTOR;
@@ -86,6 +87,8 @@ int nglFontLayout::Layout (const nglString& rText, bool FinalizeLayout)
   if (len == 0)
     return 0;
 
+  NUI_PROFILE_ZONE("FontLayout");
+
   int indexes_max = len * 2 + 1; // Let's have extra space (eg. for composite glyphs)
   uint32* indexes = (uint32*) malloc(indexes_max * sizeof(uint32));
 
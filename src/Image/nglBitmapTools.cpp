@@ -8,6 +8,192 @@
 #include "nui.h"
 #include "nglBitmapTools.h"
 
+#include <math.h>
+
+#if (defined _NGL_X86_) || (defined _NGL_X64_)
+  #define NGL_BITMAP_SIMD
+  #include <emmintrin.h>
+  #include <tmmintrin.h>
+  #include <immintrin.h>
+  #ifdef __GNUC__
+    // Compile the kernels for their instruction set regardless of the global flags, they are only called after a runtime check
+    #define NGL_TARGET_SSE2  __attribute__((target("sse2")))
+    #define NGL_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #define NGL_TARGET_AVX2  __attribute__((target("avx2")))
+  #else
+    #define NGL_TARGET_SSE2
+    #define NGL_TARGET_SSSE3
+    #define NGL_TARGET_AVX2
+  #endif
+#endif
+
+static bool gBitmapSIMD = true;
+
+NGL_API void nglEnableBitmapSIMD(bool Enable)
+{
+  gBitmapSIMD = Enable;
+}
+
+NGL_API bool nglIsBitmapSIMDEnabled()
+{
+  return gBitmapSIMD;
+}
+
+#ifdef NGL_BITMAP_SIMD
+static inline bool UseSSE2()
+{
+  return gBitmapSIMD && nglCPUInfo::HasSSE2();
+}
+
+static inline bool UseSSSE3()
+{
+  return gBitmapSIMD && nglCPUInfo::HasSSSE3();
+}
+
+static inline bool UseAVX2()
+{
+  return gBitmapSIMD && nglCPUInfo::HasAVX2();
+}
+
+// All the kernels below process as many pixels as they can and return that count, the caller finishes the line with the scalar code.
+// They must give exactly the same results as the scalar versions, including the bytes the scalar code doesn't touch.
+
+NGL_TARGET_SSSE3 static int32 CopyLine24To32_SSSE3(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  // The scalar version leaves the destination alpha untouched:
+  const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+  const __m128i alpha = _mm_set1_epi32((int32)0xFF000000);
+  int32 i = 0;
+  for (; i + 6 <= PixelCount; i += 4) // A 16 bytes load needs 6 pixels worth of source
+  {
+    __m128i src = _mm_loadu_si128((const __m128i*)(pSrc + i * 3));
+    __m128i dst = _mm_loadu_si128((const __m128i*)(pDst + i * 4));
+    __m128i rgb = _mm_shuffle_epi8(src, shuffle);
+    _mm_storeu_si128((__m128i*)(pDst + i * 4), _mm_or_si128(rgb, _mm_and_si128(dst, alpha)));
+  }
+  return i;
+}
+
+NGL_TARGET_SSSE3 static int32 CopyLine24To32ARGB_SSSE3(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128);
+  const __m128i alpha = _mm_set1_epi32((int32)0xFF000000);
+  int32 i = 0;
+  for (; i + 6 <= PixelCount; i += 4)
+  {
+    __m128i src = _mm_loadu_si128((const __m128i*)(pSrc + i * 3));
+    _mm_storeu_si128((__m128i*)(pDst + i * 4), _mm_or_si128(_mm_shuffle_epi8(src, shuffle), alpha));
+  }
+  return i;
+}
+
+NGL_TARGET_SSSE3 static int32 CopyLine32To24_SSSE3(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128);
+  int32 i = 0;
+  for (; i + 6 <= PixelCount; i += 4) // Each 16 bytes store spills 4 bytes that the next iteration overwrites
+  {
+    __m128i src = _mm_loadu_si128((const __m128i*)(pSrc + i * 4));
+    _mm_storeu_si128((__m128i*)(pDst + i * 3), _mm_shuffle_epi8(src, shuffle));
+  }
+  return i;
+}
+
+NGL_TARGET_SSE2 static int32 SwapLine32_SSE2(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  const __m128i keep = _mm_set1_epi32((int32)0xFF00FF00);
+  const __m128i low = _mm_set1_epi32(0xFF);
+  int32 i = 0;
+  for (; i + 4 <= PixelCount; i += 4)
+  {
+    __m128i p = _mm_loadu_si128((const __m128i*)(pSrc + i * 4));
+    __m128i r = _mm_or_si128(_mm_and_si128(p, keep), _mm_and_si128(_mm_srli_epi32(p, 16), low));
+    r = _mm_or_si128(r, _mm_slli_epi32(_mm_and_si128(p, low), 16));
+    _mm_storeu_si128((__m128i*)(pDst + i * 4), r);
+  }
+  return i;
+}
+
+NGL_TARGET_AVX2 static int32 SwapLine32_AVX2(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  const __m256i keep = _mm256_set1_epi32((int32)0xFF00FF00);
+  const __m256i low = _mm256_set1_epi32(0xFF);
+  int32 i = 0;
+  for (; i + 8 <= PixelCount; i += 8)
+  {
+    __m256i p = _mm256_loadu_si256((const __m256i*)(pSrc + i * 4));
+    __m256i r = _mm256_or_si256(_mm256_and_si256(p, keep), _mm256_and_si256(_mm256_srli_epi32(p, 16), low));
+    r = _mm256_or_si256(r, _mm256_slli_epi32(_mm256_and_si256(p, low), 16));
+    _mm256_storeu_si256((__m256i*)(pDst + i * 4), r);
+  }
+  return i;
+}
+
+// x * a / 255 is computed exactly for 8 bits x and a as (p + 1 + ((p + 1) >> 8)) >> 8 with p = x * a.
+// AlphaShuffle selects the alpha word of each pixel: _MM_SHUFFLE(3,3,3,3) for RGBA, _MM_SHUFFLE(0,0,0,0) for ARGB.
+template <int AlphaShuffle, uint32 AlphaMask>
+NGL_TARGET_SSE2 static int32 PreMultLine32_SSE2(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i alpha = _mm_set1_epi32((int32)AlphaMask);
+  int32 i = 0;
+  for (; i + 4 <= PixelCount; i += 4)
+  {
+    __m128i src = _mm_loadu_si128((const __m128i*)(pSrc + i * 4));
+    __m128i lo = _mm_unpacklo_epi8(src, zero);
+    __m128i hi = _mm_unpackhi_epi8(src, zero);
+    __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, AlphaShuffle), AlphaShuffle);
+    __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, AlphaShuffle), AlphaShuffle);
+    lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), one);
+    hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), one);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    __m128i res = _mm_packus_epi16(lo, hi);
+    // The scalar version doesn't write the destination alpha:
+    __m128i dst = _mm_loadu_si128((const __m128i*)(pDst + i * 4));
+    _mm_storeu_si128((__m128i*)(pDst + i * 4), _mm_or_si128(_mm_andnot_si128(alpha, res), _mm_and_si128(alpha, dst)));
+  }
+  return i;
+}
+
+template <int AlphaShuffle, uint32 AlphaMask>
+NGL_TARGET_AVX2 static int32 PreMultLine32_AVX2(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi16(1);
+  const __m256i alpha = _mm256_set1_epi32((int32)AlphaMask);
+  int32 i = 0;
+  for (; i + 8 <= PixelCount; i += 8)
+  {
+    __m256i src = _mm256_loadu_si256((const __m256i*)(pSrc + i * 4));
+    __m256i lo = _mm256_unpacklo_epi8(src, zero);
+    __m256i hi = _mm256_unpackhi_epi8(src, zero);
+    __m256i alo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, AlphaShuffle), AlphaShuffle);
+    __m256i ahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, AlphaShuffle), AlphaShuffle);
+    lo = _mm256_add_epi16(_mm256_mullo_epi16(lo, alo), one);
+    hi = _mm256_add_epi16(_mm256_mullo_epi16(hi, ahi), one);
+    lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+    __m256i res = _mm256_packus_epi16(lo, hi); // unpack and pack both work per 128 bits lane so the pixel order is preserved
+    __m256i dst = _mm256_loadu_si256((const __m256i*)(pDst + i * 4));
+    _mm256_storeu_si256((__m256i*)(pDst + i * 4), _mm256_or_si256(_mm256_andnot_si256(alpha, res), _mm256_and_si256(alpha, dst)));
+  }
+  return i;
+}
+
+template <int AlphaShuffle, uint32 AlphaMask>
+static int32 PreMultLine32_SIMD(uint8* pDst, const uint8* pSrc, int32 PixelCount)
+{
+  if (UseAVX2())
+    return PreMultLine32_AVX2<AlphaShuffle, AlphaMask>(pDst, pSrc, PixelCount);
+  if (UseSSE2())
+    return PreMultLine32_SSE2<AlphaShuffle, AlphaMask>(pDst, pSrc, PixelCount);
+  return 0;
+}
+#endif // NGL_BITMAP_SIMD
+
+
 
 NGL_API void nglInvertLineSwap32 (char* pDst, char* pSrc, uint32 pixelcount)
 {
@@ -713,7 +899,16 @@ NGL_API void nglCopyLine24To32 (void* pDst, void* pSrc, int32 PixelCount, bool I
   else
   {
     uint8* pDest   = (uint8*) pDst;
-    for (i=0; i<PixelCount; i++)
+    i = 0;
+#ifdef NGL_BITMAP_SIMD
+    if (UseSSSE3())
+    {
+      i = CopyLine24To32_SSSE3(pDest, pSource, PixelCount);
+      pSource += i * 3;
+      pDest += i * 4;
+    }
+#endif
+    for (; i<PixelCount; i++)
     {
       *pDest++ = *pSource++;
       *pDest++ = *pSource++;
@@ -747,7 +942,12 @@ NGL_API void nglCopyLine24To32ARGB (void* pDst, void* pSrc, int32 PixelCount, bo
     uint8* pSource = (uint8*) pSrc;
     uint8* pDest   = (uint8*) pDst;
     //memcpy(pDst,pSrc,PixelCount*4);
-    for (int32 i=0; i<PixelCount; ++i)
+    int32 i = 0;
+#ifdef NGL_BITMAP_SIMD
+    if (UseSSSE3())
+      i = CopyLine24To32ARGB_SSSE3(pDest, pSource, PixelCount);
+#endif
+    for (; i<PixelCount; ++i)
     {
       pDest[i*4+0] = pSource[i*3+2];
       pDest[i*4+1] = pSource[i*3+1];
@@ -872,7 +1072,16 @@ NGL_API void nglCopyLine32To24 (void* pDst, void* pSrc, int32 PixelCount, bool I
   else
   {
     uint8* pDest   = (uint8*) pDst;
-    for (i=0; i<PixelCount; i++)
+    i = 0;
+#ifdef NGL_BITMAP_SIMD
+    if (UseSSSE3())
+    {
+      i = CopyLine32To24_SSSE3(pDest, pSource, PixelCount);
+      pSource += i * 4;
+      pDest += i * 3;
+    }
+#endif
+    for (; i<PixelCount; i++)
     {
       *pDest++ = *pSource++;
       *pDest++ = *pSource++;
@@ -933,7 +1142,14 @@ NGL_API void nglCopyLine32To32ARGB (void* pDst, void* pSrc, int32 PixelCount, bo
     uint8* pSource = (uint8*) pSrc;
     uint8* pDest   = (uint8*) pDst;
     //memcpy(pDst,pSrc,PixelCount*4);
-    for (int32 i=0; i<PixelCount; ++i)
+    int32 i = 0;
+#ifdef NGL_BITMAP_SIMD
+    if (UseAVX2())
+      i = SwapLine32_AVX2(pDest, pSource, PixelCount);
+    else if (UseSSE2())
+      i = SwapLine32_SSE2(pDest, pSource, PixelCount);
+#endif
+    for (; i<PixelCount; ++i)
     {
       pDest[i*4+0] = pSource[i*4+2];
       pDest[i*4+1] = pSource[i*4+1];
@@ -1189,7 +1405,11 @@ NGL_API void nglPreMultLine32RGBA(void* pDst, void* pSrc, int32 PixelCount)
 {
   uint8* pD = (uint8*)pDst;
   uint8* pS = (uint8*)pSrc;
-  for (int32 i = 0; i < PixelCount; i++)
+  int32 i = 0;
+#ifdef NGL_BITMAP_SIMD
+  i = PreMultLine32_SIMD<_MM_SHUFFLE(3, 3, 3, 3), 0xFF000000>(pD, pS, PixelCount);
+#endif
+  for (; i < PixelCount; i++)
   {
     const uint32 o = i * 4;
     const uint8 alpha = pS[o + 3];
@@ -1203,7 +1423,11 @@ NGL_API void nglPreMultLine32ARGB(void* pDst, void* pSrc, int32 PixelCount)
 {
   uint8* pD = (uint8*)pDst;
   uint8* pS = (uint8*)pSrc;
-  for (int32 i = 0; i < PixelCount; i++)
+  int32 i = 0;
+#ifdef NGL_BITMAP_SIMD
+  i = PreMultLine32_SIMD<_MM_SHUFFLE(0, 0, 0, 0), 0x000000FF>(pD, pS, PixelCount);
+#endif
+  for (; i < PixelCount; i++)
   {
     const uint32 o = i * 4;
     const uint8 alpha = pS[o + 0];
@@ -1215,17 +1439,41 @@ NGL_API void nglPreMultLine32ARGB(void* pDst, void* pSrc, int32 PixelCount)
 
 
 /// Unpremultiply Alpha:
+// There is no cheap exact SIMD division by a per pixel value, so all the (c * 255) / alpha results are tabulated instead.
+// The table keeps the 8 bits truncation of the original code for colors brighter than their alpha.
+// It is filled by a static initializer, before any thread can use it, so the readers never need to synchronize.
+static uint8 gUnPreMultTable[256 * 256];
+
+class nglUnPreMultTableInit
+{
+public:
+  nglUnPreMultTableInit()
+  {
+    for (uint32 a = 0; a < 256; a++)
+      for (uint32 c = 0; c < 256; c++)
+        gUnPreMultTable[(a << 8) + c] = a ? (uint8)((c * 255) / a) : (uint8)c;
+  }
+};
+static nglUnPreMultTableInit gUnPreMultTableInit;
+
+static inline const uint8* GetUnPreMultTable()
+{
+  return gUnPreMultTable;
+}
+
 NGL_API void nglUnPreMultLine16LumA(void* pDst, void* pSrc, int32 PixelCount)
 {
   uint8* pD = (uint8*)pDst;
   uint8* pS = (uint8*)pSrc;
+  const uint8* pTable = GetUnPreMultTable();
   for (int32 i = 0; i < PixelCount; i++)
   {
     const uint32 o = i * 2;
     const uint8 alpha = pS[o + 1];
     if (alpha)
     {
-      pD[o + 0] = (pS[o + 0] * 255) / alpha;
+      const uint8* pInv = pTable + (alpha << 8);
+      pD[o + 0] = pInv[pS[o + 0]];
     }
   }
 }
@@ -1234,13 +1482,15 @@ NGL_API void nglUnPreMultLine16ALum(void* pDst, void* pSrc, int32 PixelCount)
 {
   uint8* pD = (uint8*)pDst;
   uint8* pS = (uint8*)pSrc;
+  const uint8* pTable = GetUnPreMultTable();
   for (int32 i = 0; i < PixelCount; i++)
   {
     const uint32 o = i * 2;
     const uint8 alpha = pS[o + 0];
     if (alpha)
     {
-      pD[o + 1] = (pS[o + 1] * 255) / alpha;
+      const uint8* pInv = pTable + (alpha << 8);
+      pD[o + 1] = pInv[pS[o + 1]];
     }
   }
 }
@@ -1249,15 +1499,17 @@ NGL_API void nglUnPreMultLine32RGBA(void* pDst, void* pSrc, int32 PixelCount)
 {
   uint8* pD = (uint8*)pDst;
   uint8* pS = (uint8*)pSrc;
+  const uint8* pTable = GetUnPreMultTable();
   for (int32 i = 0; i < PixelCount; i++)
   {
     const uint32 o = i * 4;
     const uint8 alpha = pS[o + 3];
     if (alpha)
     {
-      pD[o + 0] = (pS[o + 0] * 255) / alpha;
-      pD[o + 1] = (pS[o + 1] * 255) / alpha;
-      pD[o + 2] = (pS[o + 2] * 255) / alpha;
+      const uint8* pInv = pTable + (alpha << 8);
+      pD[o + 0] = pInv[pS[o + 0]];
+      pD[o + 1] = pInv[pS[o + 1]];
+      pD[o + 2] = pInv[pS[o + 2]];
     }
   }
 }
@@ -1266,17 +1518,261 @@ NGL_API void nglUnPreMultLine32ARGB(void* pDst, void* pSrc, int32 PixelCount)
 {
   uint8* pD = (uint8*)pDst;
   uint8* pS = (uint8*)pSrc;
+  const uint8* pTable = GetUnPreMultTable();
   for (int32 i = 0; i < PixelCount; i++)
   {
     const uint32 o = i * 4;
     const uint8 alpha = pS[o + 0];
     if (alpha)
     {
-      pD[o + 1] = (pS[o + 1] * 255) / alpha;
-      pD[o + 2] = (pS[o + 2] * 255) / alpha;
-      pD[o + 3] = (pS[o + 3] * 255) / alpha;
+      const uint8* pInv = pTable + (alpha << 8);
+      pD[o + 1] = pInv[pS[o + 1]];
+      pD[o + 2] = pInv[pS[o + 2]];
+      pD[o + 3] = pInv[pS[o + 3]];
     }
   }
 }
 
 
+
+
+/// Separable resampling:
+// Weights are fixed point with NGL_SCALE_BITS fractional bits so that the scalar and SIMD paths give the exact same results.
+#define NGL_SCALE_BITS 14
+
+static double ScaleFilterBox(double x)
+{
+  return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+}
+
+static double ScaleFilterTriangle(double x)
+{
+  x = fabs(x);
+  return (x < 1.0) ? 1.0 - x : 0.0;
+}
+
+static double ScaleSinc(double x)
+{
+  if (x == 0.0)
+    return 1.0;
+  x *= M_PI;
+  return sin(x) / x;
+}
+
+static double ScaleFilterLanczos(double x)
+{
+  if (x <= -3.0 || x >= 3.0)
+    return 0.0;
+  return ScaleSinc(x) * ScaleSinc(x / 3.0);
+}
+
+class nglScaleContributions
+{
+public:
+  int32 mTaps; ///< Number of taps per destination pixel, always even so that SIMD code can process them by pairs.
+  std::vector<int32> mIndex; ///< mTaps source indices per destination pixel, clamped to the source size.
+  std::vector<int16> mWeight; ///< mTaps weights per destination pixel, they sum to 1 << NGL_SCALE_BITS.
+};
+
+static void ComputeScaleContributions(nglScaleContributions& rContrib, int32 SrcSize, int32 DstSize, nglImageFilter Filter)
+{
+  double (*pFilter)(double) = &ScaleFilterBox;
+  double support = 0.5;
+  switch (Filter)
+  {
+    case eImageFilterBilinear:
+      pFilter = &ScaleFilterTriangle;
+      support = 1.0;
+      break;
+    case eImageFilterLanczos:
+      pFilter = &ScaleFilterLanczos;
+      support = 3.0;
+      break;
+    default:
+      break;
+  }
+
+  const double scale = (double)SrcSize / (double)DstSize;
+  const double filterscale = MAX(scale, 1.0); // Widen the filter when down scaling
+  const double radius = support * filterscale;
+  int32 taps = (int32)ceil(radius) * 2 + 1;
+  taps += taps & 1;
+
+  rContrib.mTaps = taps;
+  rContrib.mIndex.resize(taps * DstSize);
+  rContrib.mWeight.resize(taps * DstSize);
+  std::vector<double> weights(taps);
+
+  for (int32 i = 0; i < DstSize; i++)
+  {
+    const double center = (i + 0.5) * scale;
+    const int32 left = (int32)floor(center - radius);
+    double total = 0;
+    for (int32 k = 0; k < taps; k++)
+    {
+      weights[k] = pFilter((left + k + 0.5 - center) / filterscale);
+      total += weights[k];
+    }
+
+    int32* pIndex = &rContrib.mIndex[i * taps];
+    int16* pWeight = &rContrib.mWeight[i * taps];
+    int32 sum = 0;
+    int32 biggest = 0;
+    for (int32 k = 0; k < taps; k++)
+    {
+      pIndex[k] = MIN(MAX(left + k, 0), SrcSize - 1);
+      pWeight[k] = (total != 0) ? (int16)floor(weights[k] / total * (1 << NGL_SCALE_BITS) + 0.5) : 0;
+      sum += pWeight[k];
+      if (abs(pWeight[k]) > abs(pWeight[biggest]))
+        biggest = k;
+    }
+
+    if (total == 0)
+    {
+      // Degenerated filter, fall back to the nearest pixel:
+      biggest = MIN(MAX((int32)(center - left), 0), taps - 1);
+    }
+
+    // Put the rounding error on the biggest weight so that flat areas stay flat:
+    pWeight[biggest] += (1 << NGL_SCALE_BITS) - sum;
+  }
+}
+
+static inline uint8 ScaleClamp(int32 Value)
+{
+  Value >>= NGL_SCALE_BITS;
+  return (Value < 0) ? 0 : ((Value > 255) ? 255 : Value);
+}
+
+static void ScaleLineH(uint8* pDst, const uint8* pSrc, int32 From, int32 DstWidth, int32 BytesPerPixel, const nglScaleContributions& rContrib)
+{
+  const int32 taps = rContrib.mTaps;
+  for (int32 x = From; x < DstWidth; x++)
+  {
+    const int32* pIndex = &rContrib.mIndex[x * taps];
+    const int16* pWeight = &rContrib.mWeight[x * taps];
+    for (int32 c = 0; c < BytesPerPixel; c++)
+    {
+      int32 acc = 1 << (NGL_SCALE_BITS - 1);
+      for (int32 k = 0; k < taps; k++)
+        acc += pWeight[k] * pSrc[pIndex[k] * BytesPerPixel + c];
+      pDst[x * BytesPerPixel + c] = ScaleClamp(acc);
+    }
+  }
+}
+
+static void ScaleLineV(uint8* pDst, const uint8* const* ppRows, int32 From, int32 LineSize, const int16* pWeight, int32 Taps)
+{
+  for (int32 b = From; b < LineSize; b++)
+  {
+    int32 acc = 1 << (NGL_SCALE_BITS - 1);
+    for (int32 k = 0; k < Taps; k++)
+      acc += pWeight[k] * ppRows[k][b];
+    pDst[b] = ScaleClamp(acc);
+  }
+}
+
+#ifdef NGL_BITMAP_SIMD
+static inline uint32 ScaleWeightPair(const int16* pWeight)
+{
+  return (uint32)(uint16)pWeight[0] | ((uint32)(uint16)pWeight[1] << 16);
+}
+
+NGL_TARGET_SSE2 static int32 ScaleLineH32_SSE2(uint8* pDst, const uint8* pSrc, int32 DstWidth, const nglScaleContributions& rContrib)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(1 << (NGL_SCALE_BITS - 1));
+  const int32 taps = rContrib.mTaps;
+  for (int32 x = 0; x < DstWidth; x++)
+  {
+    const int32* pIndex = &rContrib.mIndex[x * taps];
+    const int16* pWeight = &rContrib.mWeight[x * taps];
+    __m128i acc = round;
+    for (int32 k = 0; k < taps; k += 2)
+    {
+      // Interleave two source pixels as r0 r1 g0 g1 b0 b1 a0 a1 to multiply-add them with their weights in one go:
+      __m128i p0 = _mm_cvtsi32_si128(*(const int32*)(pSrc + pIndex[k] * 4));
+      __m128i p1 = _mm_cvtsi32_si128(*(const int32*)(pSrc + pIndex[k + 1] * 4));
+      __m128i p = _mm_unpacklo_epi8(_mm_unpacklo_epi8(p0, p1), zero);
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_set1_epi32(ScaleWeightPair(pWeight + k))));
+    }
+    __m128i res = _mm_packs_epi32(_mm_srai_epi32(acc, NGL_SCALE_BITS), zero);
+    *(int32*)(pDst + x * 4) = _mm_cvtsi128_si32(_mm_packus_epi16(res, zero));
+  }
+  return DstWidth;
+}
+
+NGL_TARGET_SSE2 static int32 ScaleLineV_SSE2(uint8* pDst, const uint8* const* ppRows, int32 LineSize, const int16* pWeight, int32 Taps)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(1 << (NGL_SCALE_BITS - 1));
+  int32 b = 0;
+  for (; b + 8 <= LineSize; b += 8)
+  {
+    __m128i acc0 = round;
+    __m128i acc1 = round;
+    for (int32 k = 0; k < Taps; k += 2)
+    {
+      __m128i r0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(ppRows[k] + b)), zero);
+      __m128i r1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(ppRows[k + 1] + b)), zero);
+      __m128i w = _mm_set1_epi32(ScaleWeightPair(pWeight + k));
+      acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(r0, r1), w));
+      acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(r0, r1), w));
+    }
+    __m128i res = _mm_packs_epi32(_mm_srai_epi32(acc0, NGL_SCALE_BITS), _mm_srai_epi32(acc1, NGL_SCALE_BITS));
+    _mm_storel_epi64((__m128i*)(pDst + b), _mm_packus_epi16(res, zero));
+  }
+  return b;
+}
+#endif // NGL_BITMAP_SIMD
+
+NGL_API bool nglScaleImage(void* pDst, int32 DstWidth, int32 DstHeight, const void* pSrc, int32 SrcWidth, int32 SrcHeight, int32 BytesPerPixel, nglImageFilter Filter)
+{
+  if (!pDst || !pSrc || DstWidth <= 0 || DstHeight <= 0 || SrcWidth <= 0 || SrcHeight <= 0)
+    return false;
+  if (BytesPerPixel < 1 || BytesPerPixel > 4 || Filter == eImageFilterDefault)
+    return false;
+
+  nglScaleContributions horizontal;
+  nglScaleContributions vertical;
+  ComputeScaleContributions(horizontal, SrcWidth, DstWidth, Filter);
+  ComputeScaleContributions(vertical, SrcHeight, DstHeight, Filter);
+
+  // Horizontal pass in a temporary image of DstWidth x SrcHeight:
+  const int32 linesize = DstWidth * BytesPerPixel;
+  std::vector<uint8> tmp(linesize * SrcHeight);
+  const uint8* pSource = (const uint8*)pSrc;
+  for (int32 y = 0; y < SrcHeight; y++)
+  {
+    uint8* pLine = &tmp[y * linesize];
+    const uint8* pSrcLine = pSource + y * SrcWidth * BytesPerPixel;
+    int32 done = 0;
+#ifdef NGL_BITMAP_SIMD
+    if (BytesPerPixel == 4 && UseSSE2())
+      done = ScaleLineH32_SSE2(pLine, pSrcLine, DstWidth, horizontal);
+#endif
+    ScaleLineH(pLine, pSrcLine, done, DstWidth, BytesPerPixel, horizontal);
+  }
+
+  // Vertical pass, each destination line is a weighted sum of whole temporary lines whatever the pixel format:
+  const int32 taps = vertical.mTaps;
+  std::vector<const uint8*> rows(taps);
+  uint8* pDest = (uint8*)pDst;
+  for (int32 y = 0; y < DstHeight; y++)
+  {
+    const int32* pIndex = &vertical.mIndex[y * taps];
+    const int16* pWeight = &vertical.mWeight[y * taps];
+    for (int32 k = 0; k < taps; k++)
+      rows[k] = &tmp[pIndex[k] * linesize];
+
+    uint8* pLine = pDest + y * linesize;
+    int32 done = 0;
+#ifdef NGL_BITMAP_SIMD
+    if (UseSSE2())
+      done = ScaleLineV_SSE2(pLine, &rows[0], linesize, pWeight, taps);
+#endif
+    ScaleLineV(pLine, &rows[0], done, linesize, pWeight, taps);
+  }
+
+  return true;
+}
@@ -177,49 +177,29 @@ vector<nglImageCodecInfo*> *nglImage::mpCodecInfos = NULL;
 nglImage::nglImage (nglIStream* pInput, nglImageCodec* pCodec)
 {
   StaticInit();
-  mpCodec = pCodec;
-  mOwnCodec = (pCodec == NULL);
-
-  if (!mpCodec)
-  {
-    uint32 count;
-    count = mpCodecInfos->size();
-    for (uint32 i=0; i<count && !mpCodec; i++)
-    {
-      if ((*mpCodecInfos)[i])
-      {
-        mpCodec = (*mpCodecInfos)[i]->CreateInstance(); // try to create a codec
-        if (mpCodec) // success?
-        {
-          if (!mpCodec->Probe(pInput)) // try to make the codec recognize the data.
-          { // :-(
-            delete mpCodec;
-            mpCodec = NULL;
-          }
-        }
-      }
-    }
-  }
-
-  if (mpCodec)
-  {
-    mpCodec->Init(this);
-    mpCodec->Feed(pInput);
-    if (mOwnCodec)
-    {
-      delete mpCodec;
-      mpCodec = NULL;
-      mOwnCodec = false;
-    }
-  }
+  Decode(pInput, nglString::Empty, pCodec, 0, 0, nglImagePartialDelegate());
+}
 
-  if (IsValid() && !mInfo.mPreMultAlpha)
-    PreMultiply();
+nglImage::nglImage (nglIStream* pInput, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial, nglImageCodec* pCodec)
+{
+  StaticInit();
+  Decode(pInput, nglString::Empty, pCodec, TargetWidth, TargetHeight, rPartial);
 }
 
 nglImage::nglImage (const nglPath& rPath, nglImageCodec* pCodec )
 {
   StaticInit();
+  Decode(rPath, pCodec, 0, 0, nglImagePartialDelegate());
+}
+
+nglImage::nglImage (const nglPath& rPath, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial, nglImageCodec* pCodec)
+{
+  StaticInit();
+  Decode(rPath, pCodec, TargetWidth, TargetHeight, rPartial);
+}
+
+void nglImage::Decode(const nglPath& rPath, nglImageCodec* pCodec, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial)
+{
   mpCodec = pCodec;
   mOwnCodec = (pCodec == NULL);
 
@@ -233,6 +213,16 @@ nglImage::nglImage (const nglPath& rPath, nglImageCodec* pCodec )
     return;
   }
 
+  Decode(pIFile, rPath.GetPathName(), pCodec, TargetWidth, TargetHeight, rPartial);
+  
+  delete pIFile;
+}
+
+void nglImage::Decode(nglIStream* pInput, const nglString& rFileName, nglImageCodec* pCodec, uint32 TargetWidth, uint32 TargetHeight, const nglImagePartialDelegate& rPartial)
+{
+  mpCodec = pCodec;
+  mOwnCodec = (pCodec == NULL);
+
   if (!mpCodec)
   {
     uint32 count;
@@ -244,7 +234,7 @@ nglImage::nglImage (const nglPath& rPath, nglImageCodec* pCodec )
         mpCodec = (*mpCodecInfos)[i]->CreateInstance(); // try to create a codec
         if (mpCodec) // success?
         {
-          if (!mpCodec->Probe(pIFile)) // try to make the codec recognize the data.
+          if (!mpCodec->Probe(pInput)) // try to make the codec recognize the data.
           { // :-(
             delete mpCodec;
             mpCodec = NULL;
@@ -254,10 +244,10 @@ nglImage::nglImage (const nglPath& rPath, nglImageCodec* pCodec )
     }
   }
 
-  if (!mpCodec) // If not codec was able to detect the image format we try to match the file with its extension.
+  if (!mpCodec && !rFileName.IsEmpty()) // If not codec was able to detect the image format we try to match the file with its extension.
   {
     uint32 count = mpCodecInfos->size();
-    nglString filename = rPath.GetPathName();
+    nglString filename = rFileName;
     for (uint32 i=0; i<count && !mpCodec; i++)
     {
       if ((*mpCodecInfos)[i])
@@ -275,7 +265,12 @@ nglImage::nglImage (const nglPath& rPath, nglImageCodec* pCodec )
   if (mpCodec)
   {
     mpCodec->Init(this);
-    mpCodec->Feed(pIFile);
+    // Only override the settings of a user supplied codec when asked to:
+    if (TargetWidth || TargetHeight)
+      mpCodec->SetTargetSize(TargetWidth, TargetHeight);
+    if (!rPartial.empty())
+      mpCodec->SetPartialDelegate(rPartial);
+    mpCodec->Feed(pInput);
     if (mOwnCodec)
     {
       delete mpCodec;
@@ -283,8 +278,6 @@ nglImage::nglImage (const nglPath& rPath, nglImageCodec* pCodec )
       mOwnCodec = false;
     }
   }
-  
-  delete pIFile;
 
   if (IsValid() && !mInfo.mPreMultAlpha)
     PreMultiply();
@@ -532,7 +525,21 @@ void ScaleRectAvg(uint8* pTarget, int32 TgtWidth, int32 TgtHeight,
 
 
 
-nglImage::nglImage(const nglImage& rImage, uint32 NewWidth, uint32 NewHeight)
+// nglScaleImage only handles images made of 8 bits channels. Palette indices can't be interpolated:
+static bool CanUseScaleImage(const nglImageInfo& rInfo, nglImageFilter Filter)
+{
+  if (Filter == eImageFilterDefault || rInfo.mBufferFormat != eImageFormatRaw)
+    return false;
+  if (rInfo.mPixelFormat == eImagePixelIndex)
+    return false;
+  if (rInfo.mBytesPerLine != rInfo.mWidth * rInfo.mBytesPerPixel)
+    return false;
+  if (rInfo.mBitDepth == 16)
+    return rInfo.mPixelFormat == eImagePixelLumA;
+  return rInfo.mBitDepth == 8 || rInfo.mBitDepth == 24 || rInfo.mBitDepth == 32;
+}
+
+nglImage::nglImage(const nglImage& rImage, uint32 NewWidth, uint32 NewHeight, nglImageFilter Filter)
 {
   StaticInit();
   mInfo.Copy(rImage.mInfo, false); // don't Clone image buffer
@@ -549,6 +556,10 @@ nglImage::nglImage(const nglImage& rImage, uint32 NewWidth, uint32 NewHeight)
   rImage.GetInfo(sourceInfo);
   
 //  (dh_pos, mInfo.mWidth * 3, mInfo.mHeight, sh_pos, sourceInfo.mWidth *3, sourceInfo.mHeight);
+
+  if (CanUseScaleImage(sourceInfo, Filter) &&
+      nglScaleImage(GetBuffer(), NewWidth, NewHeight, rImage.GetBuffer(), sourceInfo.mWidth, sourceInfo.mHeight, sourceInfo.mBytesPerPixel, Filter))
+    return;
   
   switch (mInfo.mBitDepth)
   {
@@ -749,7 +760,7 @@ bool nglImage::Save (const nglPath& filename, nglImageCodec* pCodec)
  * image process
  */
 
-nglImage* nglImage::Resize(uint32 width, uint32 height)
+nglImage* nglImage::Resize(uint32 width, uint32 height, nglImageFilter Filter)
 {
   // check
   if ((mInfo.mWidth <= 0)|| (mInfo.mHeight <= 0))
@@ -766,6 +777,10 @@ nglImage* nglImage::Resize(uint32 width, uint32 height)
 
   // build new image
   nglImage* pNew = new nglImage(newInfo, eTransfert);
+
+  if (CanUseScaleImage(mInfo, Filter) &&
+      nglScaleImage(pNew->GetBuffer(), newInfo.mWidth, newInfo.mHeight, GetBuffer(), mInfo.mWidth, mInfo.mHeight, mInfo.mBytesPerPixel, Filter))
+    return pNew;
   
   switch (mInfo.mBitDepth)
   {
@@ -38,10 +38,59 @@ bool nglImageCodecInfo::ExtensionMatch(nglString& rFileName)
 }
 
 ///////
+nglImageCodec::nglImageCodec()
+{
+  mpImage = NULL;
+  mTargetWidth = 0;
+  mTargetHeight = 0;
+}
+
 nglImageCodec::~nglImageCodec()
 {
 }
 
+void nglImageCodec::SetTargetSize(uint32 Width, uint32 Height)
+{
+  mTargetWidth = Width;
+  mTargetHeight = Height;
+}
+
+uint32 nglImageCodec::GetTargetWidth() const
+{
+  return mTargetWidth;
+}
+
+uint32 nglImageCodec::GetTargetHeight() const
+{
+  return mTargetHeight;
+}
+
+void nglImageCodec::SetPartialDelegate(const nglImagePartialDelegate& rDelegate)
+{
+  mPartialDelegate = rDelegate;
+}
+
+uint32 nglImageCodec::GetTargetReduction(uint32 Width, uint32 Height, uint32 MaxReduction) const
+{
+  if (!mTargetWidth && !mTargetHeight)
+    return 1;
+
+  uint32 reduction = MaxReduction;
+  if (mTargetWidth)
+    reduction = MIN(reduction, Width / mTargetWidth);
+  if (mTargetHeight)
+    reduction = MIN(reduction, Height / mTargetHeight);
+
+  return MAX(reduction, 1);
+}
+
+bool nglImageCodec::SendPartial(float Completion)
+{
+  if (!mpImage || !mPartialDelegate)
+    return true;
+  return mPartialDelegate(*mpImage, Completion);
+}
+
 bool nglImageCodec::Init(nglImage* pImage)      ///< Codec init is decoupled from construction
 {
   mpImage = pImage;
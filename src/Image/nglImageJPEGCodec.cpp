@@ -9,6 +9,8 @@
 // based on libjpeg
 // implemented by jerome blondon (jerome.blondon@wanadoo.fr)
 // !TODO : better load method
+// Decoding can be reduced at the IDCT level (see nglImageCodec::SetTargetSize) and can report
+// progressive scans to the partial delegate.
 
 #include "nui.h"
 #include NGL_CONFIG_H
@@ -61,6 +63,8 @@ public:
 private:
   bool ReadHeader(nglIStream* pIStream);
   bool ReadData();
+  bool ReadScanlines(bool SendPartials);
+  float GetStreamCompletion() const;
   
   enum jpegState
   {
@@ -75,11 +79,11 @@ private:
   struct jpeg_decompress_struct mCinfo;
   struct my_error_mgr mJerr;
   char* mpBuffer;
+  nglIStream* mpStream;
 private:
 };
 
 
-
 typedef struct my_error_mgr * my_error_ptr;
 void my_error_exit (j_common_ptr cinfo);
 
@@ -93,6 +97,7 @@ nglImageCodec* nglImageJPEGCodecInfo::CreateInstance()
 nglImageJPEGCodec::nglImageJPEGCodec()
 {
   mpBuffer = NULL;
+  mpStream = NULL;
   mLine = 0;
   mState = jpegReadHeader;
 }
@@ -142,8 +147,21 @@ bool nglImageJPEGCodec::ReadHeader(nglIStream* pIStream)
   mCinfo.do_block_smoothing = TRUE;
   mCinfo.do_fancy_upsampling = TRUE;
   
+  mpStream = pIStream;
   jpeg_istream_src(&mCinfo, pIStream);
   jpeg_read_header(&mCinfo, TRUE);
+
+  // Let the IDCT do the downscaling if we only need a reduced image (libjpeg supports 1/2, 1/4 and 1/8):
+  uint32 reduction = GetTargetReduction(mCinfo.image_width, mCinfo.image_height, 8);
+  uint32 denom = 1;
+  while (denom * 2 <= reduction)
+    denom *= 2;
+  mCinfo.scale_num = 1;
+  mCinfo.scale_denom = denom;
+
+  // Only pay for the extra output passes of progressive files if someone wants to see them:
+  mCinfo.buffered_image = (!mPartialDelegate.empty() && jpeg_has_multiple_scans(&mCinfo)) ? TRUE : FALSE;
+
   jpeg_start_decompress(&mCinfo);
 
   nglImageInfo info;
@@ -160,35 +178,81 @@ bool nglImageJPEGCodec::ReadHeader(nglIStream* pIStream)
   info.mWidth = mCinfo.output_width;
   mLineSize = info.mBytesPerLine;
 
-  return SendInfo(info);
+  if (!SendInfo(info))
+  {
+    jpeg_destroy_decompress(&mCinfo);
+    return false;
+  }
+  return true;
 }
 
-bool nglImageJPEGCodec::ReadData()
+float nglImageJPEGCodec::GetStreamCompletion() const
 {
-  unsigned char *buffer;
-  int row_stride;    /* physical row width in output buffer */
-  nglImageInfo info;
-  mpImage->GetInfo(info);
+  nglFileOffset pos = mpStream->GetPos();
+  nglFileSize left = mpStream->Available();
+  if (pos + left <= 0)
+    return 0;
+  return (float)pos / (float)(pos + left);
+}
 
-  row_stride = mCinfo.output_width * mCinfo.output_components;
-  buffer = new unsigned char[row_stride];
-  
-  while (mCinfo.output_scanline < mCinfo.output_height)  // !warning! can't work with progressive loading
+bool nglImageJPEGCodec::ReadScanlines(bool SendPartials)
+{
+  // Decode straight to the image buffer, no intermediate row copy:
+  const uint32 height = mCinfo.output_height;
+  const uint32 step = MAX(height / 16, 16);
+  mLine = 0;
+  while (mCinfo.output_scanline < height)
   {
-    jpeg_read_scanlines(&mCinfo, &buffer, 1);
-    memcpy((char *)mpBuffer, (const char*)buffer, row_stride);
+    JSAMPROW row = (JSAMPROW)(mpBuffer + mCinfo.output_scanline * mLineSize);
+    jpeg_read_scanlines(&mCinfo, &row, 1);
     mLine++;
-    mpBuffer += mLineSize;
-  }  
-  
-  mpBuffer -= mLineSize * (mpImage->GetHeight());
-  delete []buffer;
-  if(mCinfo.output_scanline >= mCinfo.output_height)
+
+    if (SendPartials && !(mLine % step) && mCinfo.output_scanline < height)
+    {
+      if (!SendPartial((float)mLine / (float)height))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool nglImageJPEGCodec::ReadData()
+{
+  if (setjmp(mJerr.setjmp_buffer)) 
+  {
+    jpeg_destroy_decompress(&mCinfo);
+    return false;
+  }
+
+  bool ok = true;
+  if (mCinfo.buffered_image)
   {
+    // Progressive JPEG: output a full (coarse) image after each input scan.
+    bool done = false;
+    while (ok && !done)
+    {
+      jpeg_start_output(&mCinfo, mCinfo.input_scan_number);
+      ok = ReadScanlines(false);
+      if (ok)
+      {
+        jpeg_finish_output(&mCinfo);
+        done = jpeg_input_complete(&mCinfo) ? true : false;
+        if (!done)
+          ok = SendPartial(GetStreamCompletion());
+      }
+    }
+  }
+  else
+  {
+    ok = ReadScanlines(!mPartialDelegate.empty());
+  }
+
+  if (ok)
     jpeg_finish_decompress(&mCinfo);
-    jpeg_destroy_decompress(&mCinfo); 
-  }  
-  return true;
+  else
+    jpeg_abort_decompress(&mCinfo);
+  jpeg_destroy_decompress(&mCinfo); 
+  return ok;
 }
 
 
@@ -197,7 +261,8 @@ bool nglImageJPEGCodec::Feed(nglIStream* pIStream)
   if(ReadHeader(pIStream))
   {
     mpBuffer = mpImage->GetBuffer(); // + mLineSize*(mpImage->GetHeight()-1);
-    ReadData();
+    if (!ReadData())
+      return false;
     if (!SendData((float)mLine/(float)mpImage->GetHeight()))
       return false;
   }
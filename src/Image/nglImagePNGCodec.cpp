@@ -40,8 +40,23 @@ private:
   friend void end_callback(png_structp png_ptr, png_infop info);
 
   void InfoCallback(png_structp png_ptr, png_infop info_ptr);
+  void RowCallback(png_bytep new_row, png_uint_32 row_num, int pass);
+  void EndCallback();
+
+  void AccumulateRow(const png_byte* pRow, uint32 Row); ///< Add a source row to the box filter accumulator, flush it to the image when a full block of rows is in
+  void FlushRow(uint32 Row); ///< Write the averaged accumulator to the given image row
+  void ReduceScratch(); ///< Box filter the whole full resolution scratch buffer to the image
 
   bool mStop;
+  uint32 mReduction;  ///< Integer reduction factor in both directions (1 = full size)
+  uint32 mSrcWidth;
+  uint32 mSrcHeight;
+  uint32 mChannels;
+  uint32 mAccumRows;
+  std::vector<uint32> mAccum;
+  png_byte* mpScratch; ///< Full resolution rows, only used for reduced interlaced images
+  int mPass;
+  uint32 mPartialStep;
 };
 
 nglImageCodec* nglImagePNGCodecInfo::CreateInstance()
@@ -56,6 +71,14 @@ nglImagePNGCodec::nglImagePNGCodec()
   png_ptr = NULL;
   info_ptr = NULL;
   mStop = false;
+  mReduction = 1;
+  mSrcWidth = 0;
+  mSrcHeight = 0;
+  mChannels = 0;
+  mAccumRows = 0;
+  mpScratch = NULL;
+  mPass = -1;
+  mPartialStep = 0;
 }
 
 nglImagePNGCodec::~nglImagePNGCodec()
@@ -64,6 +87,9 @@ nglImagePNGCodec::~nglImagePNGCodec()
     free (mpRowPointers);
   mpRowPointers = NULL;
 
+  free(mpScratch);
+  mpScratch = NULL;
+
   if (png_ptr && info_ptr)
     png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
   png_ptr = NULL;
@@ -115,11 +141,7 @@ data is complete */
 void row_callback(png_structp png_ptr, png_bytep new_row, png_uint_32 row_num, int pass) 
 {
   nglImagePNGCodec* pCodec = (nglImagePNGCodec*)(png_get_progressive_ptr(png_ptr));
-
-  char* buffer = pCodec->mpImage->GetBuffer();
-  uint size = pCodec->mpImage->GetBytesPerLine();
-  buffer += row_num * size;
-  png_progressive_combine_row(png_ptr, (png_byte*)buffer, new_row);
+  pCodec->RowCallback(new_row, row_num, pass);
 }
 
 void end_callback(png_structp png_ptr, png_infop info) 
@@ -134,7 +156,8 @@ void end_callback(png_structp png_ptr, png_infop info)
   Most people won't do much here, perhaps setting
   a flag that marks the image as finished.
   */
-//  nglImagePNGCodec* pCodec=(nglImagePNGCodec*)(png_get_progressive_ptr(png_ptr));
+  nglImagePNGCodec* pCodec=(nglImagePNGCodec*)(png_get_progressive_ptr(png_ptr));
+  pCodec->EndCallback();
 }
 
 /*  An example code fragment of how you would initialize the progressive reader in your application. */
@@ -234,24 +257,32 @@ void nglImagePNGCodec::InfoCallback(png_structp png_ptr, png_infop info_ptr)
 //  if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
 //      png_set_gray_to_rgb(png_ptr);
 
-  if (png_get_interlace_type(png_ptr,info_ptr) != PNG_INTERLACE_NONE)
+  bool interlaced = (png_get_interlace_type(png_ptr,info_ptr) != PNG_INTERLACE_NONE);
+  if (interlaced)
     png_set_interlace_handling(png_ptr);
 
+  mSrcWidth = png_get_image_width( png_ptr, info_ptr );
+  mSrcHeight = png_get_image_height( png_ptr, info_ptr );
+  mReduction = GetTargetReduction(mSrcWidth, mSrcHeight, MIN(mSrcWidth, mSrcHeight));
+  if (mReduction > 1)
+    png_set_strip_16(png_ptr); // The box filter works on 8 bits samples
+
   png_read_update_info(png_ptr, info_ptr);
   
-  imginfo.mWidth = png_get_image_width( png_ptr, info_ptr );
-  imginfo.mHeight = png_get_image_height( png_ptr, info_ptr );
+  mChannels = png_get_channels( png_ptr, info_ptr );
+  imginfo.mWidth = (mSrcWidth + mReduction - 1) / mReduction;
+  imginfo.mHeight = (mSrcHeight + mReduction - 1) / mReduction;
   imginfo.mBufferFormat = eImageFormatRaw;
-  if (png_get_channels( png_ptr, info_ptr )==1)
+  if (mChannels==1)
     imginfo.mPixelFormat = eImagePixelLum;
-  else if (png_get_channels( png_ptr, info_ptr )==2)
+  else if (mChannels==2)
     imginfo.mPixelFormat = eImagePixelLumA;
-  else if (png_get_channels( png_ptr, info_ptr )==3)
+  else if (mChannels==3)
     imginfo.mPixelFormat = eImagePixelRGB;
-  else if (png_get_channels( png_ptr, info_ptr )==4)
+  else if (mChannels==4)
     imginfo.mPixelFormat = eImagePixelRGBA;
 
-  imginfo.mBitDepth = png_get_bit_depth( png_ptr, info_ptr ) * png_get_channels( png_ptr, info_ptr );
+  imginfo.mBitDepth = png_get_bit_depth( png_ptr, info_ptr ) * mChannels;
   imginfo.mBytesPerPixel = imginfo.mBitDepth / 8;
   imginfo.mBytesPerLine = imginfo.mBytesPerPixel * imginfo.mWidth;
   
@@ -260,6 +291,17 @@ void nglImagePNGCodec::InfoCallback(png_structp png_ptr, png_infop info_ptr)
     mStop = true;
   }
 
+  if (mReduction > 1)
+  {
+    // Rows are reduced on the fly as they arrive, unless the image is interlaced: Adam7 passes
+    // refine rows that were already delivered so we need to keep the full resolution around.
+    mAccum.assign(imginfo.mWidth * mChannels, 0);
+    mAccumRows = 0;
+    if (interlaced)
+      mpScratch = (png_byte*)malloc(mSrcWidth * mSrcHeight * mChannels);
+  }
+  mPartialStep = MAX(imginfo.mHeight / 16, 16);
+
   mpRowPointers = (png_byte**) malloc(imginfo.mHeight * sizeof(png_byte*));
 
   uint i;
@@ -270,8 +312,143 @@ void nglImagePNGCodec::InfoCallback(png_structp png_ptr, png_infop info_ptr)
   png_start_read_image(png_ptr);
 }
 
+void nglImagePNGCodec::RowCallback(png_bytep new_row, png_uint_32 row_num, int pass)
+{
+  if (mStop || !mpImage->GetBuffer())
+    return;
+
+  if (pass != mPass)
+  {
+    // An Adam7 pass is complete, the image now holds a coarse version of the picture:
+    if (mPass >= 0)
+    {
+      if (mpScratch && !mPartialDelegate.empty())
+        ReduceScratch();
+      if (!SendPartial((float)pass / 7.0f))
+        mStop = true;
+    }
+    mPass = pass;
+  }
+
+  if (mReduction == 1)
+  {
+    char* buffer = mpImage->GetBuffer();
+    uint size = mpImage->GetBytesPerLine();
+    buffer += row_num * size;
+    png_progressive_combine_row(png_ptr, (png_byte*)buffer, new_row);
+  }
+  else if (mpScratch)
+  {
+    png_progressive_combine_row(png_ptr, mpScratch + row_num * mSrcWidth * mChannels, new_row);
+    return;
+  }
+  else if (new_row)
+  {
+    AccumulateRow(new_row, row_num);
+  }
+
+  // Non interlaced images: show the rows decoded so far from time to time.
+  if (mPass == 0 && !png_get_interlace_type(png_ptr, info_ptr) && !mPartialDelegate.empty())
+  {
+    uint32 row = (row_num + 1) / mReduction;
+    uint32 height = mpImage->GetHeight();
+    if (!((row_num + 1) % mReduction) && !(row % mPartialStep) && row < height)
+    {
+      if (!SendPartial((float)row / (float)height))
+        mStop = true;
+    }
+  }
+}
+
+void nglImagePNGCodec::EndCallback()
+{
+  if (mStop || !mpImage->GetBuffer())
+    return;
+  if (mpScratch)
+    ReduceScratch();
+  if (!SendData(1.0f))
+    mStop = true;
+}
+
+template <uint32 Channels>
+static void nglAccumulatePNGRow(uint32* pAccum, const png_byte* pRow, uint32 Width, uint32 Reduction)
+{
+  uint32 x = 0;
+  for (; x + Reduction <= Width; x += Reduction)
+  {
+    uint32 sum[Channels] = { 0 };
+    for (uint32 i = 0; i < Reduction; i++)
+    {
+      for (uint32 c = 0; c < Channels; c++)
+        sum[c] += pRow[c];
+      pRow += Channels;
+    }
+    for (uint32 c = 0; c < Channels; c++)
+      pAccum[c] += sum[c];
+    pAccum += Channels;
+  }
+
+  for (; x < Width; x++) // Last partial block
+  {
+    for (uint32 c = 0; c < Channels; c++)
+      pAccum[c] += pRow[c];
+    pRow += Channels;
+  }
+}
+
+void nglImagePNGCodec::AccumulateRow(const png_byte* pRow, uint32 Row)
+{
+  uint32* pAccum = &mAccum[0];
+  switch (mChannels)
+  {
+  case 1: nglAccumulatePNGRow<1>(pAccum, pRow, mSrcWidth, mReduction); break;
+  case 2: nglAccumulatePNGRow<2>(pAccum, pRow, mSrcWidth, mReduction); break;
+  case 3: nglAccumulatePNGRow<3>(pAccum, pRow, mSrcWidth, mReduction); break;
+  case 4: nglAccumulatePNGRow<4>(pAccum, pRow, mSrcWidth, mReduction); break;
+  }
+
+  mAccumRows++;
+  if (mAccumRows == mReduction || Row == mSrcHeight - 1)
+    FlushRow(Row / mReduction);
+}
+
+void nglImagePNGCodec::FlushRow(uint32 Row)
+{
+  const uint32 channels = mChannels;
+  const uint32 reduction = mReduction;
+  const uint32 width = mSrcWidth;
+  uint32* pAccum = &mAccum[0];
+  png_byte* pDst = (png_byte*)mpImage->GetBuffer() + Row * mpImage->GetBytesPerLine();
+
+  for (uint32 x = 0; x < width; x += reduction)
+  {
+    const uint32 count = MIN(reduction, width - x) * mAccumRows;
+    for (uint32 c = 0; c < channels; c++)
+    {
+      pDst[c] = (png_byte)((pAccum[c] + count / 2) / count);
+      pAccum[c] = 0;
+    }
+    pDst += channels;
+    pAccum += channels;
+  }
+
+  mAccumRows = 0;
+}
+
+void nglImagePNGCodec::ReduceScratch()
+{
+  const uint32 stride = mSrcWidth * mChannels;
+  mAccum.assign(mAccum.size(), 0);
+  mAccumRows = 0;
+  for (uint32 y = 0; y < mSrcHeight; y++)
+    AccumulateRow(mpScratch + y * stride, y);
+}
+
 bool nglImagePNGCodec::Feed(nglIStream* pIStream)
 {
+  if (!png_ptr && initialize_png_reader() != 0) // The codec was given by the user and Probe() was skipped
+    return false;
+
   char buffer[4096];
   nglFileSize size = MIN(pIStream->Available(), 4096);
   
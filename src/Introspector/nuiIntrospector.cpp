@@ -19,6 +19,7 @@
 #include "nuiTreeHandleDecoration.h"
 #include "nuiFontManager.h"
 #include "nuiObjectInspector.h"
+#include "nuiMemoryInspector.h"
 
 
 #define CELL_TOOLBAR 0
@@ -121,6 +122,14 @@ nuiWidget* nuiIntrospector::GetToolbar()
   mEventSink.Connect(pObjectsBtn->ButtonPressed, &nuiIntrospector::ShowObjectInspector);
   pBox->AddCell(pObjectsBtn);
   
+  nuiRadioButton* pMemoryBtn = new nuiRadioButton(_T("Memory"));
+  pMemoryBtn->SetColor(eNormalTextFg, textColor);
+  pMemoryBtn->SetColor(eSelectedTextFg, textColor);
+  pMemoryBtn->SetDecoration(nuiDecoration::Get(INTROSPECTOR_DECO_BUTTON), eDecorationBorder);
+  pMemoryBtn->SetBorders(0);
+  mEventSink.Connect(pMemoryBtn->ButtonPressed, &nuiIntrospector::ShowMemoryInspector);
+  pBox->AddCell(pMemoryBtn);
+  
   
   // for visual comfort :).... doesn't work..!!?!
 //  nuiSeparator* pSeparator2 = new nuiSeparator(nuiHorizontal);
@@ -180,6 +189,12 @@ void nuiIntrospector::ShowObjectInspector(const nuiEvent& rEvent)
   rEvent.Cancel();
 }
 
+void nuiIntrospector::ShowMemoryInspector(const nuiEvent& rEvent)
+{
+  SetCell(CELL_CLIENT, new nuiMemoryInspector()); 
+  rEvent.Cancel();
+}
+
 void nuiIntrospector::InitDecorations()
 {
   // window background
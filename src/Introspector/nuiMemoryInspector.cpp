@@ -0,0 +1,170 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+
+#include "nui.h"
+#include "nuiMemoryInspector.h"
+#include "nuiMemoryTracker.h"
+#include "nuiGrid.h"
+#include "nuiLabel.h"
+#include "nuiButton.h"
+#include "nuiToggleButton.h"
+#include "nuiIntrospector.h"
+
+#define MEMORY_COLUMNS 4
+
+static nglString FormatBytes(int64 Bytes)
+{
+  nglString str;
+  double bytes = (double)Bytes;
+  if (Bytes >= 1024 * 1024 || Bytes <= -1024 * 1024)
+    str.CFormat(_T("%.2f MB"), bytes / (1024 * 1024));
+  else if (Bytes >= 1024 || Bytes <= -1024)
+    str.CFormat(_T("%.1f KB"), bytes / 1024);
+  else
+    str.CFormat(_T("%d B"), (int32)Bytes);
+  return str;
+}
+
+nuiMemoryInspector::nuiMemoryInspector()
+: mSink(this), mpGrid(NULL), mpLeakTracking(NULL), mTagCount(0)
+{
+  SetObjectClass(_T("nuiMemoryInspector"));
+
+  // decoration
+  nuiDecoration* pDeco = nuiDecoration::Get(INTROSPECTOR_DECO_CLIENT_BKG);
+  if (pDeco)
+  {
+    SetDecoration(pDeco, eDecorationBorder);
+  }
+
+  Build();
+
+  mpTimer = new nuiTimer(0.5f);
+  mSink.Connect(mpTimer->Tick, &nuiMemoryInspector::Update);
+  mpTimer->Start();
+}
+
+nuiMemoryInspector::~nuiMemoryInspector()
+{
+  mpTimer->Stop();
+  delete mpTimer;
+}
+
+void nuiMemoryInspector::Build()
+{
+  Clear();
+  mpLabels.clear();
+  mTagCount = nuiMemoryTracker::GetTagCount();
+
+  nuiVBox* pBox = new nuiVBox(0);
+  pBox->SetExpand(nuiExpandShrinkAndGrow);
+  AddChild(pBox);
+
+  nuiHBox* pToolbar = new nuiHBox(0);
+  pBox->AddCell(pToolbar);
+
+  nuiButton* pReset = new nuiButton(_T("Reset peaks"));
+  mSink.Connect(pReset->Activated, &nuiMemoryInspector::OnResetPeaks);
+  pToolbar->AddCell(pReset);
+
+  mpLeakTracking = new nuiToggleButton(_T("Leak tracking"));
+  mpLeakTracking->SetPressed(nuiMemoryTracker::IsLeakTrackingEnabled());
+  mSink.Connect(mpLeakTracking->ButtonPressed, &nuiMemoryInspector::OnLeakTracking);
+  mSink.Connect(mpLeakTracking->ButtonDePressed, &nuiMemoryInspector::OnLeakTracking);
+  pToolbar->AddCell(mpLeakTracking);
+
+  nuiButton* pReport = new nuiButton(_T("Print report"));
+  mSink.Connect(pReport->Activated, &nuiMemoryInspector::OnPrintReport);
+  pToolbar->AddCell(pReport);
+
+  nuiScrollView* pScrollView = new nuiScrollView(false, true);
+  pBox->AddCell(pScrollView);
+  pBox->SetCellExpand(pBox->GetNbCells() - 1, nuiExpandShrinkAndGrow);
+
+  // One row per tag between the titles and the total:
+  mpGrid = new nuiGrid(MEMORY_COLUMNS, mTagCount + 2);
+  mpGrid->DisplayGridBorder(true, 1.0f);
+  mpGrid->SetColumnExpand(0, nuiExpandShrinkAndGrow);
+  pScrollView->AddChild(mpGrid);
+
+  const nglChar* pTitles[MEMORY_COLUMNS] = { _T("Tag"), _T("Bytes"), _T("Allocations"), _T("Peak") };
+  for (uint32 c = 0; c < MEMORY_COLUMNS; c++)
+  {
+    nuiLabel* pLabel = new nuiLabel(pTitles[c]);
+    pLabel->SetTextColor(INTROSPECTOR_COLOR_GRID_TITLE);
+    mpGrid->SetCell(c, 0, pLabel);
+  }
+
+  for (uint32 r = 0; r <= mTagCount; r++)
+  {
+    const char* pName = (r < mTagCount) ? nuiMemoryTracker::GetTagName(r) : "Total";
+    mpGrid->SetCell(0, r + 1, new nuiLabel(nglString(pName)));
+    for (uint32 c = 1; c < MEMORY_COLUMNS; c++)
+    {
+      nuiLabel* pLabel = new nuiLabel();
+      mpGrid->SetCell(c, r + 1, pLabel, nuiRight);
+      mpLabels.push_back(pLabel);
+    }
+  }
+
+  Update(nuiEvent());
+}
+
+void nuiMemoryInspector::Update(const nuiEvent& rEvent)
+{
+  if (mTagCount != nuiMemoryTracker::GetTagCount())
+  {
+    Build();
+    return;
+  }
+
+  nuiMemoryTracker::Stats total;
+  total.mBytes = 0;
+  total.mCount = 0;
+  total.mPeakBytes = 0;
+  nglString str;
+  for (uint32 i = 0; i <= mTagCount; i++)
+  {
+    nuiMemoryTracker::Stats stats;
+    if (i < mTagCount)
+    {
+      nuiMemoryTracker::GetStats(i, stats);
+      total.mBytes += stats.mBytes;
+      total.mCount += stats.mCount;
+      total.mPeakBytes += stats.mPeakBytes; // The sum of the peaks of the tags, not the peak of the sum
+    }
+    else
+    {
+      stats = total;
+    }
+
+    mpLabels[i * 3]->SetText(FormatBytes(stats.mBytes));
+    str.SetCInt(stats.mCount);
+    mpLabels[i * 3 + 1]->SetText(str);
+    mpLabels[i * 3 + 2]->SetText(FormatBytes(stats.mPeakBytes));
+  }
+}
+
+void nuiMemoryInspector::OnResetPeaks(const nuiEvent& rEvent)
+{
+  nuiMemoryTracker::ResetPeaks();
+  Update(rEvent);
+  rEvent.Cancel();
+}
+
+void nuiMemoryInspector::OnLeakTracking(const nuiEvent& rEvent)
+{
+  nuiMemoryTracker::EnableLeakTracking(mpLeakTracking->IsPressed());
+  rEvent.Cancel();
+}
+
+void nuiMemoryInspector::OnPrintReport(const nuiEvent& rEvent)
+{
+  NGL_OUT(_T("%ls"), nuiMemoryTracker::GetLeakReport().GetChars());
+  rEvent.Cancel();
+}
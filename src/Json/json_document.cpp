@@ -0,0 +1,469 @@
+#include "nui.h"
+#include "nglIMemory.h"
+#include "nuiJson/document.h"
+#include "nuiJson/stream_reader.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace nuiJson {
+
+static const Document::Node nullNode = Document::Node();
+
+// Smallest block of the arena. The blocks grow with the document so that big documents only need a few of them.
+static const size_t minimumBlockSize = 64 * 1024;
+
+
+// Class Document::Node
+// //////////////////////////////////////////////////////////////////
+
+ValueType
+Document::Node::type() const
+{
+   return type_;
+}
+
+
+bool
+Document::Node::isNull() const
+{
+   return type_ == nullValue;
+}
+
+
+bool
+Document::Node::isBool() const
+{
+   return type_ == booleanValue;
+}
+
+
+bool
+Document::Node::isInt() const
+{
+   return type_ == intValue;
+}
+
+
+bool
+Document::Node::isUInt() const
+{
+   return type_ == uintValue;
+}
+
+
+bool
+Document::Node::isIntegral() const
+{
+   return type_ == intValue  ||  type_ == uintValue  ||  type_ == booleanValue;
+}
+
+
+bool
+Document::Node::isDouble() const
+{
+   return type_ == realValue;
+}
+
+
+bool
+Document::Node::isNumeric() const
+{
+   return isIntegral()  ||  isDouble();
+}
+
+
+bool
+Document::Node::isString() const
+{
+   return type_ == stringValue;
+}
+
+
+bool
+Document::Node::isArray() const
+{
+   return type_ == arrayValue;
+}
+
+
+bool
+Document::Node::isObject() const
+{
+   return type_ == objectValue;
+}
+
+
+UInt
+Document::Node::size() const
+{
+   switch ( type_ )
+   {
+   case stringValue:
+   case arrayValue:
+   case objectValue:
+      return size_;
+   default:
+      return 0;
+   }
+}
+
+
+const Document::Node &
+Document::Node::operator[]( UInt index ) const
+{
+   if ( type_ != arrayValue  ||  index >= size_ )
+      return nullNode;
+   return value_.children_[index];
+}
+
+
+const Document::Node &
+Document::Node::operator[]( const char *key ) const
+{
+   const Node *node = find( key, key + strlen( key ) );
+   return node ? *node : nullNode;
+}
+
+
+const Document::Node &
+Document::Node::operator[]( const std::string &key ) const
+{
+   const Node *node = find( key.data(), key.data() + key.length() );
+   return node ? *node : nullNode;
+}
+
+
+const Document::Node *
+Document::Node::find( const char *begin, const char *end ) const
+{
+   if ( type_ != objectValue )
+      return 0;
+
+   UInt length = UInt( end - begin );
+   const Node *member = value_.children_;
+   for ( UInt index = 0; index < size_; ++index, member += 2 )
+   {
+      if ( member->size_ == length  &&  !memcmp( member->value_.string_, begin, length ) )
+         return member + 1;
+   }
+   return 0;
+}
+
+
+const Document::Node &
+Document::Node::memberName( UInt index ) const
+{
+   if ( type_ != objectValue  ||  index >= size_ )
+      return nullNode;
+   return value_.children_[index * 2];
+}
+
+
+const Document::Node &
+Document::Node::memberValue( UInt index ) const
+{
+   if ( type_ != objectValue  ||  index >= size_ )
+      return nullNode;
+   return value_.children_[index * 2 + 1];
+}
+
+
+const char *
+Document::Node::begin() const
+{
+   return type_ == stringValue ? value_.string_ : 0;
+}
+
+
+const char *
+Document::Node::end() const
+{
+   return type_ == stringValue ? value_.string_ + size_ : 0;
+}
+
+
+std::string
+Document::Node::asString() const
+{
+   switch ( type_ )
+   {
+   case stringValue:
+      return std::string( value_.string_, size_ );
+   case booleanValue:
+      return value_.bool_ ? "true" : "false";
+   default:
+      return "";
+   }
+}
+
+
+Int
+Document::Node::asInt() const
+{
+   switch ( type_ )
+   {
+   case intValue: return value_.int_;
+   case uintValue: return Int( value_.uint_ );
+   case realValue: return Int( value_.real_ );
+   case booleanValue: return value_.bool_ ? 1 : 0;
+   default: return 0;
+   }
+}
+
+
+UInt
+Document::Node::asUInt() const
+{
+   switch ( type_ )
+   {
+   case intValue: return UInt( value_.int_ );
+   case uintValue: return value_.uint_;
+   case realValue: return UInt( value_.real_ );
+   case booleanValue: return value_.bool_ ? 1 : 0;
+   default: return 0;
+   }
+}
+
+
+double
+Document::Node::asDouble() const
+{
+   switch ( type_ )
+   {
+   case intValue: return value_.int_;
+   case uintValue: return value_.uint_;
+   case realValue: return value_.real_;
+   case booleanValue: return value_.bool_ ? 1.0 : 0.0;
+   default: return 0.0;
+   }
+}
+
+
+bool
+Document::Node::asBool() const
+{
+   switch ( type_ )
+   {
+   case intValue: return value_.int_ != 0;
+   case uintValue: return value_.uint_ != 0;
+   case realValue: return value_.real_ != 0.0;
+   case booleanValue: return value_.bool_;
+   case stringValue:
+   case arrayValue:
+   case objectValue: return size_ != 0;
+   default: return false;
+   }
+}
+
+
+// Class Document
+// //////////////////////////////////////////////////////////////////
+
+Document::Document( const Features &features )
+   : features_( features )
+   , root_( nullNode )
+   , current_( 0 )
+   , available_( 0 )
+   , usage_( 0 )
+{
+}
+
+
+Document::~Document()
+{
+   clear();
+}
+
+
+void
+Document::clear()
+{
+   for ( size_t index = 0; index < blocks_.size(); ++index )
+      free( blocks_[index].data_ );
+   blocks_.clear();
+   std::vector<Node>().swap( stack_ );
+   current_ = 0;
+   available_ = 0;
+   usage_ = 0;
+   root_ = nullNode;
+   error_.clear();
+}
+
+
+void *
+Document::allocate( size_t size )
+{
+   size = ( size + 7 ) & ~size_t( 7 );
+   if ( size > available_ )
+   {
+      Block block;
+      block.size_ = usage_ / 2;
+      if ( block.size_ < minimumBlockSize )
+         block.size_ = minimumBlockSize;
+      if ( block.size_ < size )
+         block.size_ = size;
+      block.data_ = (char *)malloc( block.size_ );
+      if ( !block.data_ )
+         return 0;
+      blocks_.push_back( block );
+      usage_ += block.size_;
+      current_ = block.data_;
+      available_ = block.size_;
+   }
+
+   void *data = current_;
+   current_ += size;
+   available_ -= size;
+   return data;
+}
+
+
+const char *
+Document::storeString( const StreamReader &reader, UInt &length )
+{
+   length = UInt( reader.stringEnd_ - reader.stringBegin_ );
+
+   // Point into the source when it stays accessible:
+   if ( reader.inMemory_  &&  !reader.stringDecoded_ )
+      return reader.stringBegin_;
+
+   if ( !length )
+      return "";
+   char *string = (char *)allocate( length );
+   if ( string )
+      memcpy( string, reader.stringBegin_, length );
+   return string;
+}
+
+
+bool
+Document::parse( const char *begin, const char *end )
+{
+   nglIMemory memory( begin, end - begin );
+   return parse( &memory );
+}
+
+
+bool
+Document::parse( nglIStream *stream )
+{
+   clear();
+   StreamReader reader( stream, features_ );
+   bool result = build( reader );
+   std::vector<Node>().swap( stack_ );
+   return result;
+}
+
+
+bool
+Document::build( StreamReader &reader )
+{
+   // The nodes are pushed on stack_ as they are read. When a container ends, its children are moved
+   // from the top of the stack to a single arena allocation.
+   std::vector<size_t> containers;
+   for (;;)
+   {
+      Node node = nullNode;
+      switch ( reader.next() )
+      {
+      case StreamReader::eventObjectBegin:
+      case StreamReader::eventArrayBegin:
+         containers.push_back( stack_.size() );
+         continue;
+      case StreamReader::eventObjectEnd:
+      case StreamReader::eventArrayEnd:
+         {
+            size_t start = containers.back();
+            size_t count = stack_.size() - start;
+            containers.pop_back();
+
+            Node *children = 0;
+            if ( count )
+            {
+               children = (Node *)allocate( count * sizeof( Node ) );
+               if ( !children )
+               {
+                  error_ = "Out of memory.\n";
+                  return false;
+               }
+               memcpy( children, &stack_[start], count * sizeof( Node ) );
+               stack_.resize( start );
+            }
+
+            bool isObject = reader.event() == StreamReader::eventObjectEnd;
+            node.type_ = isObject ? objectValue : arrayValue;
+            node.size_ = UInt( isObject ? count / 2 : count );
+            node.value_.children_ = children;
+         }
+         break;
+      case StreamReader::eventKey:
+      case StreamReader::eventString:
+         node.type_ = stringValue;
+         node.value_.string_ = storeString( reader, node.size_ );
+         if ( !node.value_.string_ )
+         {
+            error_ = "Out of memory.\n";
+            return false;
+         }
+         break;
+      case StreamReader::eventNumber:
+         node.type_ = reader.getNumberType();
+         switch ( node.type_ )
+         {
+         case intValue: node.value_.int_ = reader.int_; break;
+         case uintValue: node.value_.uint_ = reader.uint_; break;
+         default: node.value_.real_ = reader.real_; break;
+         }
+         break;
+      case StreamReader::eventBoolean:
+         node.type_ = booleanValue;
+         node.value_.bool_ = reader.asBool();
+         break;
+      case StreamReader::eventNull:
+         break;
+      default:
+         error_ = reader.getFormatedErrorMessages();
+         return false;
+      }
+
+      if ( !containers.empty() )
+      {
+         stack_.push_back( node );
+         continue;
+      }
+
+      // The root value is complete, only blanks and comments may follow:
+      root_ = node;
+      if ( reader.next() != StreamReader::eventEndOfDocument )
+      {
+         error_ = reader.event() == StreamReader::eventError ? reader.getFormatedErrorMessages()
+                                                             : "Extra data after the end of the document.\n";
+         root_ = nullNode;
+         return false;
+      }
+      return true;
+   }
+}
+
+
+const Document::Node &
+Document::root() const
+{
+   return root_;
+}
+
+
+size_t
+Document::getMemoryUsage() const
+{
+   return usage_;
+}
+
+
+std::string
+Document::getFormatedErrorMessages() const
+{
+   return error_;
+}
+
+} // namespace nuiJson
@@ -0,0 +1,830 @@
+#include "nui.h"
+#include "nuiJson/stream_reader.h"
+#include "nuiJson/value.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace nuiJson {
+
+static inline bool
+isNumberChar( StreamReader::Char c )
+{
+   return ( c >= '0'  &&  c <= '9' )  ||  c == '-'  ||  c == '+'  ||  c == '.'  ||  c == 'e'  ||  c == 'E';
+}
+
+
+static void
+appendCodePoint( std::string &result, unsigned int cp )
+{
+   // based on description from http://en.wikipedia.org/wiki/UTF-8
+   if ( cp <= 0x7f )
+   {
+      result += static_cast<char>( cp );
+   }
+   else if ( cp <= 0x7FF )
+   {
+      result += static_cast<char>( 0xC0 | ( 0x1f & ( cp >> 6 ) ) );
+      result += static_cast<char>( 0x80 | ( 0x3f & cp ) );
+   }
+   else if ( cp <= 0xFFFF )
+   {
+      result += static_cast<char>( 0xE0 | ( 0xf & ( cp >> 12 ) ) );
+      result += static_cast<char>( 0x80 | ( 0x3f & ( cp >> 6 ) ) );
+      result += static_cast<char>( 0x80 | ( 0x3f & cp ) );
+   }
+   else if ( cp <= 0x10FFFF )
+   {
+      result += static_cast<char>( 0xF0 | ( 0x7 & ( cp >> 18 ) ) );
+      result += static_cast<char>( 0x80 | ( 0x3f & ( cp >> 12 ) ) );
+      result += static_cast<char>( 0x80 | ( 0x3f & ( cp >> 6 ) ) );
+      result += static_cast<char>( 0x80 | ( 0x3f & cp ) );
+   }
+}
+
+
+// Class ReaderHandler
+// //////////////////////////////////////////////////////////////////
+
+ReaderHandler::~ReaderHandler()
+{
+}
+
+
+// Class StreamReader
+// //////////////////////////////////////////////////////////////////
+
+StreamReader::StreamReader( nglIStream *stream,
+                            const Features &features,
+                            unsigned int bufferSize )
+   : stream_( stream )
+   , features_( features )
+   , window_( 0 )
+   , current_( 0 )
+   , end_( 0 )
+   , windowOffset_( 0 )
+   , peeked_( false )
+   , inMemory_( false )
+   , endOfStream_( stream == 0 )
+   , state_( stateStart )
+   , event_( eventNone )
+   , documents_( 0 )
+   , stringBegin_( 0 )
+   , stringEnd_( 0 )
+   , stringDecoded_( false )
+   , numberType_( intValue )
+   , int_( 0 )
+   , uint_( 0 )
+   , real_( 0 )
+   , bool_( false )
+   , line_( 1 )
+   , lineStart_( 0 )
+   , errorLine_( 0 )
+   , errorColumn_( 0 )
+{
+   if ( stream_ )
+   {
+      const void *data = 0;
+      int64 size = stream_->PeekBuffer( data );
+      if ( size > 0 )
+      {
+         window_ = current_ = (Location)data;
+         end_ = current_ + size;
+         peeked_ = true;
+         inMemory_ = ( (nglFileSize)size == stream_->Available() );
+      }
+      else
+      {
+         buffer_.resize( bufferSize > 16 ? bufferSize : 16 );
+      }
+   }
+}
+
+
+StreamReader::~StreamReader()
+{
+   // Leave the stream right after the parsed data when possible:
+   if ( peeked_ )
+      stream_->SetPos( current_ - window_, eStreamForward );
+}
+
+
+bool
+StreamReader::fill()
+{
+   if ( endOfStream_ )
+      return false;
+
+   windowOffset_ += end_ - window_;
+   if ( peeked_ )
+   {
+      stream_->SetPos( end_ - window_, eStreamForward );
+      peeked_ = false;
+
+      const void *data = 0;
+      int64 size = stream_->PeekBuffer( data );
+      if ( size > 0 )
+      {
+         window_ = current_ = (Location)data;
+         end_ = current_ + size;
+         peeked_ = true;
+         return true;
+      }
+      if ( buffer_.empty() )
+         buffer_.resize( 64 * 1024 );
+   }
+
+   int64 size = stream_->Read( &buffer_[0], buffer_.size(), 1 );
+   if ( size <= 0 )
+   {
+      endOfStream_ = true;
+      window_ = current_ = end_ = 0;
+      return false;
+   }
+   window_ = current_ = &buffer_[0];
+   end_ = current_ + size;
+   return true;
+}
+
+
+inline int
+StreamReader::peekChar()
+{
+   if ( current_ == end_  &&  !fill() )
+      return -1;
+   return (unsigned char)*current_;
+}
+
+
+inline int
+StreamReader::getChar()
+{
+   if ( current_ == end_  &&  !fill() )
+      return -1;
+   return (unsigned char)*current_++;
+}
+
+
+int
+StreamReader::skipSpaces()
+{
+   for (;;)
+   {
+      while ( current_ < end_ )
+      {
+         Char c = *current_;
+         if ( c == ' '  ||  c == '\t'  ||  c == '\r' )
+         {
+            ++current_;
+         }
+         else if ( c == '\n' )
+         {
+            ++current_;
+            ++line_;
+            lineStart_ = windowOffset_ + ( current_ - window_ );
+         }
+         else if ( c == '/'  &&  features_.allowComments_ )
+         {
+            ++current_;
+            if ( !skipComment() )
+               return -2;
+         }
+         else
+         {
+            return (unsigned char)c;
+         }
+      }
+      if ( !fill() )
+         return -1;
+   }
+}
+
+
+bool
+StreamReader::skipComment()
+{
+   int c = getChar();
+   if ( c == '*' )
+   {
+      int last = 0;
+      while ( ( c = getChar() ) >= 0 )
+      {
+         if ( c == '\n' )
+         {
+            ++line_;
+            lineStart_ = windowOffset_ + ( current_ - window_ );
+         }
+         else if ( c == '/'  &&  last == '*' )
+         {
+            return true;
+         }
+         last = c;
+      }
+      addError( "Unterminated comment." );
+      return false;
+   }
+   if ( c == '/' )
+   {
+      while ( ( c = peekChar() ) >= 0  &&  c != '\n' )
+         ++current_;
+      return true;
+   }
+   addError( "Syntax error: '/*' or '//' expected." );
+   return false;
+}
+
+
+bool
+StreamReader::match( const char *pattern, int length )
+{
+   if ( end_ - current_ >= length )
+   {
+      if ( memcmp( current_, pattern, length ) )
+         return false;
+      current_ += length;
+      return true;
+   }
+
+   for ( int index = 0; index < length; ++index )
+      if ( getChar() != (unsigned char)pattern[index] )
+         return false;
+   return true;
+}
+
+
+StreamReader::EventType
+StreamReader::next()
+{
+   if ( event_ == eventError )
+      return eventError;
+
+   for (;;)
+   {
+      int c = skipSpaces();
+      if ( c == -2 )
+         return eventError;
+
+      switch ( state_ )
+      {
+      case stateStart:
+         if ( c < 0 )
+         {
+            if ( !documents_ )
+               return addError( "Syntax error: value, object or array expected." );
+            return event_ = eventEndOfDocument;
+         }
+         return readValue( c );
+
+      case stateFirstValue:
+         if ( c == ']' )
+         {
+            ++current_;
+            containers_.pop_back();
+            state_ = containers_.empty() ? stateStart : stateNext;
+            if ( containers_.empty() )
+               ++documents_;
+            return event_ = eventArrayEnd;
+         }
+         // fall through
+      case stateValue:
+         if ( c < 0 )
+            return addError( "Syntax error: value, object or array expected." );
+         return readValue( c );
+
+      case stateFirstKey:
+         if ( c == '}' )
+         {
+            ++current_;
+            containers_.pop_back();
+            state_ = containers_.empty() ? stateStart : stateNext;
+            if ( containers_.empty() )
+               ++documents_;
+            return event_ = eventObjectEnd;
+         }
+         // fall through
+      case stateKey:
+         if ( c != '"' )
+            return addError( "Missing '}' or object member name" );
+         ++current_;
+         if ( !readString() )
+            return eventError;
+         state_ = stateColon;
+         return event_ = eventKey;
+
+      case stateColon:
+         if ( c != ':' )
+            return addError( "Missing ':' after object member name" );
+         ++current_;
+         state_ = stateValue;
+         break;
+
+      case stateNext:
+         {
+            bool isObject = containers_.back() == '{';
+            if ( c == ',' )
+            {
+               ++current_;
+               state_ = isObject ? stateKey : stateValue;
+               break;
+            }
+            if ( c != ( isObject ? '}' : ']' ) )
+               return addError( isObject ? "Missing ',' or '}' in object declaration"
+                                         : "Missing ',' or ']' in array declaration" );
+            ++current_;
+            containers_.pop_back();
+            if ( containers_.empty() )
+            {
+               state_ = stateStart;
+               ++documents_;
+            }
+            return event_ = isObject ? eventObjectEnd : eventArrayEnd;
+         }
+      }
+   }
+}
+
+
+StreamReader::EventType
+StreamReader::readValue( int c )
+{
+   bool root = containers_.empty();
+   if ( root  &&  features_.strictRoot_  &&  c != '{'  &&  c != '[' )
+      return addError( "A valid JSON document must be either an array or an object value." );
+
+   EventType event;
+   switch ( c )
+   {
+   case '{':
+      ++current_;
+      containers_.push_back( '{' );
+      state_ = stateFirstKey;
+      return event_ = eventObjectBegin;
+   case '[':
+      ++current_;
+      containers_.push_back( '[' );
+      state_ = stateFirstValue;
+      return event_ = eventArrayBegin;
+   case '"':
+      ++current_;
+      if ( !readString() )
+         return eventError;
+      event = eventString;
+      break;
+   case 't':
+      if ( !match( "true", 4 ) )
+         return addError( "Syntax error: value, object or array expected." );
+      bool_ = true;
+      event = eventBoolean;
+      break;
+   case 'f':
+      if ( !match( "false", 5 ) )
+         return addError( "Syntax error: value, object or array expected." );
+      bool_ = false;
+      event = eventBoolean;
+      break;
+   case 'n':
+      if ( !match( "null", 4 ) )
+         return addError( "Syntax error: value, object or array expected." );
+      event = eventNull;
+      break;
+   default:
+      if ( c != '-'  &&  ( c < '0'  ||  c > '9' ) )
+         return addError( "Syntax error: value, object or array expected." );
+      if ( !readNumber() )
+         return eventError;
+      event = eventNumber;
+      break;
+   }
+
+   if ( root )
+   {
+      state_ = stateStart;
+      ++documents_;
+   }
+   else
+   {
+      state_ = stateNext;
+   }
+   return event_ = event;
+}
+
+
+bool
+StreamReader::readString()
+{
+   // Fast path: the whole string is in the current chunk and has no escape sequence
+   Location begin = current_;
+   Location current = current_;
+   while ( current < end_  &&  *current != '"'  &&  *current != '\\' )
+      ++current;
+   if ( current < end_  &&  *current == '"' )
+   {
+      stringBegin_ = begin;
+      stringEnd_ = current;
+      stringDecoded_ = false;
+      current_ = current + 1;
+      return true;
+   }
+
+   decoded_.assign( begin, current );
+   current_ = current;
+   for (;;)
+   {
+      int c = getChar();
+      if ( c < 0 )
+      {
+         addError( "Missing '\"' at the end of the string" );
+         return false;
+      }
+      if ( c == '"' )
+         break;
+      if ( c == '\\' )
+      {
+         if ( !readEscape() )
+            return false;
+         continue;
+      }
+
+      decoded_ += (Char)c;
+      Location run = current_;
+      while ( current_ < end_  &&  *current_ != '"'  &&  *current_ != '\\' )
+         ++current_;
+      decoded_.append( run, current_ );
+   }
+
+   stringBegin_ = decoded_.data();
+   stringEnd_ = stringBegin_ + decoded_.size();
+   stringDecoded_ = true;
+   return true;
+}
+
+
+bool
+StreamReader::readEscape()
+{
+   int escape = getChar();
+   switch ( escape )
+   {
+   case '"': decoded_ += '"'; return true;
+   case '/': decoded_ += '/'; return true;
+   case '\\': decoded_ += '\\'; return true;
+   case 'b': decoded_ += '\b'; return true;
+   case 'f': decoded_ += '\f'; return true;
+   case 'n': decoded_ += '\n'; return true;
+   case 'r': decoded_ += '\r'; return true;
+   case 't': decoded_ += '\t'; return true;
+   case 'u':
+      break;
+   default:
+      addError( escape < 0 ? "Empty escape sequence in string" : "Bad escape sequence in string" );
+      return false;
+   }
+
+   unsigned int unicode = 0;
+   for ( int pair = 0; pair < 2; ++pair )
+   {
+      unsigned int value = 0;
+      for ( int index = 0; index < 4; ++index )
+      {
+         int c = getChar();
+         value *= 16;
+         if ( c >= '0'  &&  c <= '9' )
+            value += c - '0';
+         else if ( c >= 'a'  &&  c <= 'f' )
+            value += c - 'a' + 10;
+         else if ( c >= 'A'  &&  c <= 'F' )
+            value += c - 'A' + 10;
+         else
+         {
+            addError( "Bad unicode escape sequence in string: hexadecimal digit expected." );
+            return false;
+         }
+      }
+
+      if ( pair )
+      {
+         unicode = 0x10000 + ( ( unicode & 0x3FF ) << 10 ) + ( value & 0x3FF );
+         break;
+      }
+      unicode = value;
+      if ( unicode < 0xD800  ||  unicode > 0xDBFF )
+         break;
+
+      // surrogate pairs
+      if ( getChar() != '\\'  ||  getChar() != 'u' )
+      {
+         addError( "expecting another \\u token to begin the second half of a unicode surrogate pair" );
+         return false;
+      }
+   }
+
+   appendCodePoint( decoded_, unicode );
+   return true;
+}
+
+
+bool
+StreamReader::readNumber()
+{
+   Location begin = current_;
+   Location current = current_;
+   while ( current < end_  &&  isNumberChar( *current ) )
+      ++current;
+   if ( current < end_ )
+   {
+      current_ = current;
+      return decodeNumber( begin, current );
+   }
+
+   // The number goes on in the next chunk:
+   decoded_.assign( begin, current );
+   current_ = current;
+   int c;
+   while ( ( c = peekChar() ) >= 0  &&  isNumberChar( (Char)c ) )
+   {
+      decoded_ += (Char)c;
+      ++current_;
+   }
+   return decodeNumber( decoded_.c_str(), decoded_.c_str() + decoded_.size() );
+}
+
+
+bool
+StreamReader::decodeNumber( Location begin, Location end )
+{
+   Location current = begin;
+   bool isNegative = *current == '-';
+   if ( isNegative )
+      ++current;
+
+   bool isDouble = current == end;
+   UInt threshold = ( isNegative ? UInt( -Value::minInt ) : Value::maxUInt ) / 10;
+   UInt value = 0;
+   for ( ; current < end  &&  !isDouble; ++current )
+   {
+      Char c = *current;
+      if ( c < '0'  ||  c > '9'  ||  value >= threshold )
+         isDouble = true;
+      else
+         value = value * 10 + UInt( c - '0' );
+   }
+
+   if ( !isDouble )
+   {
+      if ( isNegative )
+      {
+         numberType_ = intValue;
+         int_ = -Int( value );
+      }
+      else if ( value <= UInt( Value::maxInt ) )
+      {
+         numberType_ = intValue;
+         int_ = Int( value );
+      }
+      else
+      {
+         numberType_ = uintValue;
+         uint_ = value;
+      }
+      return true;
+   }
+
+   // strtod() needs a terminated string, it could otherwise read past the chunk ("0x...", "-inf...")
+   const int bufferSize = 64;
+   int length = int( end - begin );
+   char buffer[bufferSize];
+   std::string longNumber;
+   const char *text = buffer;
+   if ( length < bufferSize )
+   {
+      memcpy( buffer, begin, length );
+      buffer[length] = 0;
+   }
+   else
+   {
+      longNumber.assign( begin, end );
+      text = longNumber.c_str();
+   }
+
+   char *parsed = 0;
+   real_ = strtod( text, &parsed );
+   if ( parsed != text + length )
+   {
+      addError( "'" + std::string( begin, end ) + "' is not a number." );
+      return false;
+   }
+   numberType_ = realValue;
+   return true;
+}
+
+
+StreamReader::EventType
+StreamReader::addError( const std::string &message )
+{
+   if ( event_ != eventError )
+   {
+      int64 offset = windowOffset_ + ( current_ - window_ );
+      error_ = message;
+      errorLine_ = line_;
+      errorColumn_ = int( offset - lineStart_ ) + 1;
+   }
+   return event_ = eventError;
+}
+
+
+StreamReader::EventType
+StreamReader::event() const
+{
+   return event_;
+}
+
+
+unsigned int
+StreamReader::depth() const
+{
+   return containers_.size();
+}
+
+
+void
+StreamReader::getString( Location &begin, Location &end ) const
+{
+   begin = stringBegin_;
+   end = stringEnd_;
+}
+
+
+std::string
+StreamReader::getString() const
+{
+   return std::string( stringBegin_, stringEnd_ );
+}
+
+
+ValueType
+StreamReader::getNumberType() const
+{
+   return numberType_;
+}
+
+
+Int
+StreamReader::asInt() const
+{
+   switch ( numberType_ )
+   {
+   case intValue: return int_;
+   case uintValue: return Int( uint_ );
+   default: return Int( real_ );
+   }
+}
+
+
+UInt
+StreamReader::asUInt() const
+{
+   switch ( numberType_ )
+   {
+   case intValue: return UInt( int_ );
+   case uintValue: return uint_;
+   default: return UInt( real_ );
+   }
+}
+
+
+double
+StreamReader::asDouble() const
+{
+   switch ( numberType_ )
+   {
+   case intValue: return int_;
+   case uintValue: return uint_;
+   default: return real_;
+   }
+}
+
+
+bool
+StreamReader::asBool() const
+{
+   return bool_;
+}
+
+
+bool
+StreamReader::skipValue()
+{
+   if ( event_ == eventKey )
+      next();
+
+   if ( event_ == eventObjectBegin  ||  event_ == eventArrayBegin )
+   {
+      unsigned int depth = containers_.size();
+      while ( containers_.size() >= depth )
+      {
+         if ( next() == eventError )
+            return false;
+      }
+   }
+   return event_ != eventError;
+}
+
+
+bool
+StreamReader::readValue( Value &value )
+{
+   switch ( event_ )
+   {
+   case eventObjectBegin:
+      value = Value( objectValue );
+      while ( next() == eventKey )
+      {
+         std::string name( stringBegin_, stringEnd_ );
+         next();
+         if ( !readValue( value[name] ) )
+            return false;
+      }
+      return event_ == eventObjectEnd;
+   case eventArrayBegin:
+      {
+         value = Value( arrayValue );
+         UInt index = 0;
+         while ( next() != eventArrayEnd )
+         {
+            if ( !readValue( value[index++] ) )
+               return false;
+         }
+         return true;
+      }
+   case eventString:
+      value = Value( stringBegin_, stringEnd_ );
+      return true;
+   case eventNumber:
+      switch ( numberType_ )
+      {
+      case intValue: value = int_; break;
+      case uintValue: value = uint_; break;
+      default: value = real_; break;
+      }
+      return true;
+   case eventBoolean:
+      value = bool_;
+      return true;
+   case eventNull:
+      value = Value();
+      return true;
+   default:
+      return false;
+   }
+}
+
+
+bool
+StreamReader::parse( ReaderHandler &handler )
+{
+   for (;;)
+   {
+      bool ok = true;
+      switch ( next() )
+      {
+      case eventObjectBegin: ok = handler.startObject(); break;
+      case eventObjectEnd: ok = handler.endObject(); break;
+      case eventArrayBegin: ok = handler.startArray(); break;
+      case eventArrayEnd: ok = handler.endArray(); break;
+      case eventKey: ok = handler.key( stringBegin_, stringEnd_ ); break;
+      case eventString: ok = handler.string( stringBegin_, stringEnd_ ); break;
+      case eventNumber:
+         switch ( numberType_ )
+         {
+         case intValue: ok = handler.intValue( int_ ); break;
+         case uintValue: ok = handler.uintValue( uint_ ); break;
+         default: ok = handler.realValue( real_ ); break;
+         }
+         break;
+      case eventBoolean: ok = handler.boolValue( bool_ ); break;
+      case eventNull: ok = handler.nullValue(); break;
+      case eventEndOfDocument: return true;
+      default: return false;
+      }
+
+      if ( !ok )
+      {
+         addError( "Parsing stopped by the handler." );
+         return false;
+      }
+   }
+}
+
+
+std::string
+StreamReader::getFormatedErrorMessages() const
+{
+   if ( event_ != eventError )
+      return "";
+
+   char location[64];
+   sprintf( location, "Line %d, Column %d", errorLine_, errorColumn_ );
+   return "* " + std::string( location ) + "\n  " + error_ + "\n";
+}
+
+} // namespace nuiJson
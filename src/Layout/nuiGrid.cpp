@@ -117,9 +117,9 @@ uint32 nuiGrid::GetRowDimensionRange(uint32 dimension) const
 
 bool nuiGrid::Load(const nuiXMLNode* pNode)
 {
-  nuiSimpleContainer::Load(pNode);
   mDefaultHSpacing = 0.0f;
   mDefaultVSpacing = 0.0f;
+  nuiSimpleContainer::Load(pNode);
   mNbColumns = nuiGetVal(pNode, _T("NbColumns"), 0);
   mNbRows = nuiGetVal(pNode, _T("NbRows"), 0);
 
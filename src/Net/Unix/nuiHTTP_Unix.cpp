@@ -21,114 +21,377 @@
 #include "nuiHTTP.h"
 
 #include <curl/curl.h>
+#include <sys/select.h>
 using namespace std;
-static size_t write_data(char *data, size_t size, size_t nmemb,
-                            nglString *buffer)
-{  
-  for(int i = 0; i < size*nmemb; i++)
+
+/*
+All the requests are run by one curl multi handle driven by a single I/O thread. The multi handle keeps a pool of open
+connections (and a DNS and TLS session cache) that is shared by all the transfers, so consecutive requests to the same
+server reuse the same keep-alive connection, and the easy handles are recycled between requests. The completion of a
+request is signaled from the I/O thread.
+*/
+
+typedef nuiFastDelegate1<nuiHTTPResponse*> nuiHTTPCompletionDelegate;
+
+class nuiHTTPTransfer
+{
+public:
+  nuiHTTPTransfer(nuiHTTPRequest* pRequest, const nuiHTTPCompletionDelegate& rCompletion)
+  : mpRequest(pRequest), mpStream(pRequest->GetOutputStream()), mpCache(NULL), mCompletion(rCompletion),
+    mpHandle(NULL), mpHeaders(NULL), mpResponse(NULL), mpCached(NULL)
+  {
+    if (!mpStream && pRequest->GetMethod() == _T("GET"))
+      mpCache = pRequest->GetCache();
+  }
+
+  ~nuiHTTPTransfer()
   {
-    if (data[i] > 0)
-      buffer->Append(nglChar(data[i]));
+    if (mpHeaders)
+      curl_slist_free_all(mpHeaders);
+    delete mpResponse;
+    delete mpCached;
   }
-  return size * nmemb;
+
+  nuiHTTPRequest* mpRequest;
+  nglOStream* mpStream;
+  nuiHTTPCache* mpCache;
+  nuiHTTPCompletionDelegate mCompletion;
+
+  CURL* mpHandle;
+  std::string mURL;
+  curl_slist* mpHeaders;
+  nuiHTTPResponse* mpResponse;
+  nuiHTTPResponse* mpCached;
+};
+
+class nuiHTTPEngine
+{
+public:
+  nuiHTTPEngine();
+  ~nuiHTTPEngine();
+
+  void Add(nuiHTTPTransfer* pTransfer); ///< Can be called from any thread. The engine owns the transfer.
+
+private:
+  enum
+  {
+    MaxIdleHandles = 16,
+    MaxConnections = 32,
+    MaxHostConnections = 8
+  };
+
+  void Run();
+  void Wake();
+  void StartTransfer(nuiHTTPTransfer* pTransfer);
+  void FinishTransfer(nuiHTTPTransfer* pTransfer, CURLcode Result);
+
+  static size_t OnHeader(char* pData, size_t Size, size_t Count, void* pUserData);
+  static size_t OnData(char* pData, size_t Size, size_t Count, void* pUserData);
+
+  CURLM* mpMulti;
+  std::list<nuiHTTPTransfer*> mPending; ///< Added by the client threads, started by the I/O thread
+  std::set<nuiHTTPTransfer*> mRunning;
+  std::vector<CURL*> mIdleHandles;
+  nglCriticalSection mCS;
+  nglThread* mpThread;
+  volatile bool mStop;
+};
+
+static nuiHTTPEngine gHTTPEngine;
+
+nuiHTTPEngine::nuiHTTPEngine()
+: mpMulti(NULL), mpThread(NULL), mStop(false)
+{
 }
 
+nuiHTTPEngine::~nuiHTTPEngine()
+{
+  if (mpThread)
+  {
+    mStop = true;
+    Wake();
+    mpThread->Join();
+    delete mpThread;
+  }
+
+  // The pending requests are abandoned
+  for (std::set<nuiHTTPTransfer*>::iterator it = mRunning.begin(); it != mRunning.end(); ++it)
+  {
+    curl_multi_remove_handle(mpMulti, (*it)->mpHandle);
+    curl_easy_cleanup((*it)->mpHandle);
+    delete *it;
+  }
+  for (std::list<nuiHTTPTransfer*>::iterator it = mPending.begin(); it != mPending.end(); ++it)
+    delete *it;
+  for (uint32 i = 0; i < mIdleHandles.size(); i++)
+    curl_easy_cleanup(mIdleHandles[i]);
+
+  if (mpMulti)
+    curl_multi_cleanup(mpMulti);
+}
+
+void nuiHTTPEngine::Add(nuiHTTPTransfer* pTransfer)
+{
+  {
+    nglCriticalSectionGuard guard(mCS);
+    mPending.push_back(pTransfer);
+
+    if (!mpThread)
+    {
+      curl_global_init(CURL_GLOBAL_ALL);
+      mpMulti = curl_multi_init();
+      curl_multi_setopt(mpMulti, CURLMOPT_MAXCONNECTS, (long)MaxConnections);
+#if LIBCURL_VERSION_NUM >= 0x071e00
+      curl_multi_setopt(mpMulti, CURLMOPT_MAX_HOST_CONNECTIONS, (long)MaxHostConnections);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+      curl_multi_setopt(mpMulti, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+#endif
+
+      mpThread = new nglThreadDelegate(nuiMakeDelegate(this, &nuiHTTPEngine::Run), _T("nuiHTTPEngine"));
+      mpThread->Start();
+      return;
+    }
+  }
+
+  Wake();
+}
+
+void nuiHTTPEngine::Wake()
+{
+#if LIBCURL_VERSION_NUM >= 0x074400
+  curl_multi_wakeup(mpMulti);
+#endif
+}
+
+void nuiHTTPEngine::Run()
+{
+  while (!mStop)
+  {
+    std::list<nuiHTTPTransfer*> pending;
+    {
+      nglCriticalSectionGuard guard(mCS);
+      pending.swap(mPending);
+    }
+    for (std::list<nuiHTTPTransfer*>::iterator it = pending.begin(); it != pending.end(); ++it)
+      StartTransfer(*it);
+
+    int running = 0;
+    curl_multi_perform(mpMulti, &running);
+
+    int count = 0;
+    CURLMsg* pMsg = NULL;
+    while ((pMsg = curl_multi_info_read(mpMulti, &count)))
+    {
+      if (pMsg->msg != CURLMSG_DONE)
+        continue;
+
+      nuiHTTPTransfer* pTransfer = NULL;
+      curl_easy_getinfo(pMsg->easy_handle, CURLINFO_PRIVATE, (char**)&pTransfer);
+      FinishTransfer(pTransfer, pMsg->data.result);
+    }
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+    curl_multi_poll(mpMulti, NULL, 0, 1000, NULL);
+#elif LIBCURL_VERSION_NUM >= 0x071c00
+    // Without curl_multi_wakeup() the new requests are picked up at the next time out
+    curl_multi_wait(mpMulti, NULL, 0, 50, NULL);
+#else
+    // Nor curl_multi_wait() before 7.28.0
+    fd_set readfds, writefds, errorfds;
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
+    FD_ZERO(&errorfds);
+    int maxfd = -1;
+    curl_multi_fdset(mpMulti, &readfds, &writefds, &errorfds, &maxfd);
+    timeval timeout = { 0, 50000 };
+    select(maxfd + 1, &readfds, &writefds, &errorfds, &timeout);
+#endif
+  }
+}
+
+void nuiHTTPEngine::StartTransfer(nuiHTTPTransfer* pTransfer)
+{
+  CURL* pHandle = NULL;
+  if (mIdleHandles.empty())
+  {
+    pHandle = curl_easy_init();
+  }
+  else
+  {
+    pHandle = mIdleHandles.back();
+    mIdleHandles.pop_back();
+    curl_easy_reset(pHandle);
+  }
+  pTransfer->mpHandle = pHandle;
+
+  nuiHTTPRequest* pRequest = pTransfer->mpRequest;
+  const nglString& rMethod(pRequest->GetMethod());
+  const std::vector<char>& rBody(pRequest->GetBody());
+  pTransfer->mURL = pRequest->GetURL().GetStdString(eUTF8);
+
+  nuiHTTPHeaderMap headers(pRequest->GetHeaders());
+  if (pTransfer->mpCache)
+  {
+    pTransfer->mpCached = pTransfer->mpCache->GetResponse(pRequest->GetURL());
+    if (pTransfer->mpCached)
+      nuiHTTPCache::AddValidators(*pTransfer->mpCached, headers);
+  }
+  if (!rBody.empty() && headers.find(_T("Expect")) == headers.end())
+    headers[_T("Expect")] = nglString::Empty; // Don't wait for a "100 Continue" before sending the body
+  for (nuiHTTPHeaderMap::const_iterator it = headers.begin(); it != headers.end(); ++it)
+  {
+    // "Name;" is how curl sends a header with an empty value, "Name:" would remove the header
+    nglString header(it->first);
+    header.Add(it->second.IsEmpty() ? _T(";") : _T(": ")).Add(it->second);
+    pTransfer->mpHeaders = curl_slist_append(pTransfer->mpHeaders, header.GetStdString(eUTF8).c_str());
+  }
+
+  curl_easy_setopt(pHandle, CURLOPT_URL, pTransfer->mURL.c_str());
+  curl_easy_setopt(pHandle, CURLOPT_PRIVATE, pTransfer);
+  curl_easy_setopt(pHandle, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(pHandle, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(pHandle, CURLOPT_MAXREDIRS, 16L);
+#if LIBCURL_VERSION_NUM >= 0x071506
+  curl_easy_setopt(pHandle, CURLOPT_ACCEPT_ENCODING, "");
+#endif
+#if LIBCURL_VERSION_NUM >= 0x071900
+  curl_easy_setopt(pHandle, CURLOPT_TCP_KEEPALIVE, 1L);
+#endif
+  curl_easy_setopt(pHandle, CURLOPT_HTTPHEADER, pTransfer->mpHeaders);
+  curl_easy_setopt(pHandle, CURLOPT_HEADERFUNCTION, &nuiHTTPEngine::OnHeader);
+  curl_easy_setopt(pHandle, CURLOPT_HEADERDATA, pTransfer);
+  curl_easy_setopt(pHandle, CURLOPT_WRITEFUNCTION, &nuiHTTPEngine::OnData);
+  curl_easy_setopt(pHandle, CURLOPT_WRITEDATA, pTransfer);
+
+  if (rMethod == _T("HEAD"))
+  {
+    curl_easy_setopt(pHandle, CURLOPT_NOBODY, 1L);
+  }
+  else if (rMethod != _T("GET"))
+  {
+    if (rMethod == _T("POST"))
+      curl_easy_setopt(pHandle, CURLOPT_POST, 1L);
+    else
+      curl_easy_setopt(pHandle, CURLOPT_CUSTOMREQUEST, rMethod.GetStdString(eUTF8).c_str());
+
+    // The request body is not copied: the request outlives the transfer.
+    curl_easy_setopt(pHandle, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)rBody.size());
+    curl_easy_setopt(pHandle, CURLOPT_POSTFIELDS, rBody.empty() ? "" : &rBody[0]);
+  }
+
+  mRunning.insert(pTransfer);
+  curl_multi_add_handle(mpMulti, pHandle);
+}
+
+void nuiHTTPEngine::FinishTransfer(nuiHTTPTransfer* pTransfer, CURLcode Result)
+{
+  CURL* pHandle = pTransfer->mpHandle;
+  curl_multi_remove_handle(mpMulti, pHandle);
+  mRunning.erase(pTransfer);
+
+  nuiHTTPResponse* pResponse = pTransfer->mpResponse;
+  pTransfer->mpResponse = NULL;
+
+  if (Result != CURLE_OK)
+  {
+    delete pResponse;
+    pResponse = new nuiHTTPResponse(0, nglString(curl_easy_strerror(Result)));
+  }
+  else if (!pResponse)
+  {
+    long code = 0;
+    curl_easy_getinfo(pHandle, CURLINFO_RESPONSE_CODE, &code);
+    pResponse = new nuiHTTPResponse((uint16)code, nglString::Empty);
+  }
+  else if (pTransfer->mpCache)
+  {
+    if (pResponse->GetStatusCode() == 304 && pTransfer->mpCached)
+    {
+      delete pResponse;
+      pResponse = pTransfer->mpCached;
+      pTransfer->mpCached = NULL;
+    }
+    else
+    {
+      pTransfer->mpCache->Store(pTransfer->mpRequest->GetURL(), *pResponse);
+    }
+  }
+
+  if (mIdleHandles.size() < MaxIdleHandles)
+    mIdleHandles.push_back(pHandle);
+  else
+    curl_easy_cleanup(pHandle);
+
+  pTransfer->mCompletion(pResponse);
+  delete pTransfer;
+}
+
+size_t nuiHTTPEngine::OnHeader(char* pData, size_t Size, size_t Count, void* pUserData)
+{
+  nuiHTTPTransfer* pTransfer = (nuiHTTPTransfer*)pUserData;
+  size_t length = Size * Count;
+  nglString line(pData, (int32)length, eISO8859_1);
+  line.Trim();
+
+  if (line.CompareLeft(_T("HTTP/")) == 0)
+  {
+    // Each response (redirections, 100 Continue and the final one) starts with a status line
+    delete pTransfer->mpResponse;
+    int32 pos = line.Find(' ');
+    uint16 code = (pos > 0) ? (uint16)line.Extract(pos + 1, 3).GetCInt() : 0;
+    pTransfer->mpResponse = new nuiHTTPResponse(code, line);
+  }
+  else if (pTransfer->mpResponse && !line.IsEmpty())
+  {
+    pTransfer->mpResponse->AddHeader(line);
+  }
+
+  return length;
+}
+
+size_t nuiHTTPEngine::OnData(char* pData, size_t Size, size_t Count, void* pUserData)
+{
+  nuiHTTPTransfer* pTransfer = (nuiHTTPTransfer*)pUserData;
+  size_t length = Size * Count;
+
+  if (pTransfer->mpStream)
+    return (size_t)pTransfer->mpStream->Write(pData, length, 1); // A short write aborts the transfer
+
+  if (!pTransfer->mpResponse)
+    pTransfer->mpResponse = new nuiHTTPResponse(0, nglString::Empty);
+  pTransfer->mpResponse->AppendBody(pData, length);
+  return length;
+}
+
+
+class nuiHTTPSyncRequest
+{
+public:
+  nuiHTTPSyncRequest()
+  : mpResponse(NULL)
+  {
+  }
+
+  void OnResponse(nuiHTTPResponse* pResponse)
+  {
+    mpResponse = pResponse;
+    mDone.Set();
+  }
+
+  nglSyncEvent mDone;
+  nuiHTTPResponse* mpResponse;
+};
 
 nuiHTTPResponse* nuiHTTPRequest::SendRequest()
 {
-  // parse address string
-  nglString url(mUrl);
-  nglString server, objectName;
-  nglString buffer;
-  nglString header;
-  uint port = 80;
-  CURLcode res;
-
-  NGL_OUT(_T("%s\n"), __FILE__);
-  
-  if (url.CompareLeft(_T("http://")) == 0)
-  {
-    url.DeleteLeft(7);
-  }
-
-  int32 pos = url.Find(':');
-  if (pos != -1)
-  {
-    server = url.Extract(0, pos);
-    port = url.Extract(pos).GetCInt();
-    pos = url.Find('/');
-    if (pos != -1)
-    {
-      objectName = url.Extract(pos);
-    }
-    else
-    {
-      objectName = nglString::Null;
-    }
-  }
-  else
-  {
-    pos = url.Find('/');
-    if (pos != -1)
-    {
-      server = url.Extract(0, pos);
-      objectName = url.Extract(pos);
-    }
-    else
-    {
-      server = url;
-      objectName = nglString::Null;
-    }
-  }
-
-  CURL *easyhandle = curl_easy_init();
-  if (mMethod == _T("POST"))
-  {
-    res = curl_easy_setopt(easyhandle, CURLOPT_URL, url.GetStdString().c_str());
-    res = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, objectName.GetStdString().c_str());
-  }
-  else if (mMethod == _T("GET"))
-  {
-    NGL_OUT(_T("url = %ls\n"), mUrl.GetChars());
-    res = curl_easy_setopt(easyhandle, CURLOPT_URL, mUrl.GetStdString().c_str());
-  }
-
-  curl_easy_setopt(easyhandle, CURLOPT_FOLLOWLOCATION, 1);
-  curl_easy_setopt(easyhandle, CURLOPT_WRITEFUNCTION, write_data);
-  curl_easy_setopt(easyhandle, CURLOPT_WRITEDATA, &buffer);
-  curl_easy_setopt(easyhandle, CURLOPT_WRITEHEADER, &header);
-  curl_easy_perform(easyhandle);
-
-  long statusCode = 0;
-  curl_easy_getinfo (easyhandle, CURLINFO_RESPONSE_CODE, &statusCode);
-  vector<nglString> headersVec;
-  header.Tokenize(headersVec, _T("\r\n"));
-
-  nglString statusLine;
-  
-  vector<nglString>::const_iterator it = headersVec.begin();
-  vector<nglString>::const_iterator end = headersVec.end();
-  if (it != end)
-  {
-    statusLine = *it;
-    ++it;
-  }
-
-  nuiHTTPResponse* pResponse = new nuiHTTPResponse((uint16) statusCode, statusLine);
-
-  for (; it != end; ++it)
-  {
-    pos = it->Find(_T(":"));
-    nglString fieldName(it->Extract(0, pos));
-    fieldName.Trim();
-    nglString fieldValue(it->Extract(pos+1));
-    fieldValue.Trim();
-    pResponse->AddHeader(fieldName, fieldValue);
-  }
-
-  //NGL_OUT(_T("body = %s\n"), buffer.GetStdString().c_str()); 
-  pResponse->SetBody(buffer.GetStdString().c_str(), buffer.GetLength());
-  
-  curl_easy_cleanup(easyhandle);
-  return pResponse;
+  nuiHTTPSyncRequest sync;
+  gHTTPEngine.Add(new nuiHTTPTransfer(this, nuiMakeDelegate(&sync, &nuiHTTPSyncRequest::OnResponse)));
+  sync.mDone.Wait();
+  return sync.mpResponse;
+}
+
+void nuiHTTPRequest::QueueRequest(nuiHTTPRequest_Thread* pThread)
+{
+  gHTTPEngine.Add(new nuiHTTPTransfer(this, nuiMakeDelegate(pThread, &nuiHTTPRequest_Thread::OnResponse)));
 }
@@ -8,6 +8,7 @@
 #include "nui.h"
 #include "nuiHTTP.h"
 #include "nuiCommand.h"
+#include "nuiString8.h"
 
 using namespace std;
 
@@ -50,7 +51,7 @@ bool nuiHTTPMessage::AddHeader(const nglString& rHeader)
     return false; // no ':' in string or ':' as 1st character, invalid header field
   }
   
-  nglString fieldName = rHeader.Extract(0, pos - 1);
+  nglString fieldName = rHeader.Extract(0, pos);
   fieldName.Trim();
   nglString fieldValue = rHeader.Extract(pos + 1);
   fieldValue.Trim();
@@ -61,8 +62,12 @@ bool nuiHTTPMessage::AddHeader(const nglString& rHeader)
 
 void nuiHTTPMessage::SetBody(const char* pBuffer, nglSize ByteCnt)
 {
-  mBody.resize(ByteCnt);
-  memcpy(&mBody[0], pBuffer, ByteCnt);
+  mBody.assign(pBuffer, pBuffer + ByteCnt);
+}
+
+void nuiHTTPMessage::AppendBody(const char* pBuffer, nglSize ByteCnt)
+{
+  mBody.insert(mBody.end(), pBuffer, pBuffer + ByteCnt);
 }
 
 const std::vector<char>& nuiHTTPMessage::GetBody() const
@@ -72,11 +77,13 @@ const std::vector<char>& nuiHTTPMessage::GetBody() const
 
 nglString nuiHTTPMessage::GetBodyStr() const
 {
+  if (mBody.empty())
+    return nglString::Empty;
   return nglString(&mBody[0], mBody.size(), eUTF8);
 }
 
 nuiHTTPRequest::nuiHTTPRequest(const nglString& rUrl, const nglString& rMethod)
-: mUrl(rUrl), mMethod(rMethod)
+: mUrl(rUrl), mMethod(rMethod), mpOutputStream(NULL), mpCache(NULL)
 {
   mMethod.ToUpper();
 }
@@ -100,6 +107,26 @@ const nglString& nuiHTTPRequest::GetMethod() const
   return mMethod;
 }
 
+void nuiHTTPRequest::SetOutputStream(nglOStream* pStream)
+{
+  mpOutputStream = pStream;
+}
+
+nglOStream* nuiHTTPRequest::GetOutputStream() const
+{
+  return mpOutputStream;
+}
+
+void nuiHTTPRequest::SetCache(nuiHTTPCache* pCache)
+{
+  mpCache = pCache;
+}
+
+nuiHTTPCache* nuiHTTPRequest::GetCache() const
+{
+  return mpCache;
+}
+
 
 nuiHTTPResponse::nuiHTTPResponse(uint16 StatusCode, const nglString& StatusLine)
 : mStatusCode(StatusCode), mStatusLine(StatusLine)
@@ -131,7 +158,11 @@ nuiHTTPRequest_Thread::nuiHTTPRequest_Thread(nuiHTTPRequest* pRequest, const nui
 : nuiCommand(_T("nuiHTTPRequest_Thread"), _T("HTTP Threaded Request Reply Command"), false, false, false),
   mpRequest(pRequest), mDelegate(rDelegate), mpResponse(NULL), mCancel(false)
 {
+#ifdef NUI_HTTP_IO_THREAD
+  mpRequest->QueueRequest(this);
+#else
   Start();
+#endif
 }
 
 nuiHTTPRequest_Thread::~nuiHTTPRequest_Thread()
@@ -142,11 +173,20 @@ nuiHTTPRequest_Thread::~nuiHTTPRequest_Thread()
 
 void nuiHTTPRequest_Thread::OnStart()
 {
-  mpResponse = mpRequest->SendRequest();
-  
+  OnResponse(mpRequest->SendRequest());
+}
+
+void nuiHTTPRequest_Thread::OnResponse(nuiHTTPResponse* pResponse)
+{
+  mpResponse = pResponse;
+
   if (mCancel)
   {
+#ifdef NUI_HTTP_IO_THREAD
+    delete this;
+#else
     SetAutoDelete(true);
+#endif
     return;
   }
   
@@ -167,3 +207,146 @@ bool nuiHTTPRequest_Thread::ExecuteDo()
   return true;
 }
 
+
+////////////////
+// nuiHTTPCache
+#define NUI_HTTP_CACHE_MAGIC "nuiHTTPCache 1"
+
+nuiHTTPCache::nuiHTTPCache(const nglPath& rFolder)
+: mFolder(rFolder)
+{
+  if (!mFolder.Exists())
+    mFolder.Create(true);
+}
+
+nuiHTTPCache::~nuiHTTPCache()
+{
+}
+
+const nglPath& nuiHTTPCache::GetFolder() const
+{
+  return mFolder;
+}
+
+nglPath nuiHTTPCache::GetPath(const nglString& rURL) const
+{
+  nglString name;
+  name.CFormat(_T("%08x.http"), nuiString8(rURL).GetHash());
+  return mFolder + name;
+}
+
+static bool nuiHTTPCacheReadLine(const std::vector<char>& rData, size_t& rPos, nglString& rLine)
+{
+  size_t end = rPos;
+  while (end < rData.size() && rData[end] != '\n')
+    end++;
+  if (end == rData.size())
+    return false;
+
+  rLine = (end > rPos) ? nglString(&rData[rPos], end - rPos, eUTF8) : nglString::Empty;
+  rPos = end + 1;
+  return true;
+}
+
+nuiHTTPResponse* nuiHTTPCache::GetResponse(const nglString& rURL) const
+{
+  std::vector<char> data;
+  {
+    nglCriticalSectionGuard guard(mCS);
+    nglIFile file(GetPath(rURL));
+    if (file.GetState() != eStreamReady)
+      return NULL;
+    data.resize(file.Available());
+    if (data.empty() || file.Read(&data[0], data.size(), 1) != (int64)data.size())
+      return NULL;
+  }
+
+  size_t pos = 0;
+  nglString magic, url, code, statusline;
+  if (!nuiHTTPCacheReadLine(data, pos, magic) || magic != nglString(NUI_HTTP_CACHE_MAGIC)
+   || !nuiHTTPCacheReadLine(data, pos, url) || url != rURL // Hash collision
+   || !nuiHTTPCacheReadLine(data, pos, code)
+   || !nuiHTTPCacheReadLine(data, pos, statusline))
+    return NULL;
+
+  nuiHTTPResponse* pResponse = new nuiHTTPResponse((uint16)code.GetCInt(), statusline);
+  nglString header;
+  while (nuiHTTPCacheReadLine(data, pos, header) && !header.IsEmpty())
+    pResponse->AddHeader(header);
+
+  if (pos < data.size())
+    pResponse->SetBody(&data[pos], data.size() - pos);
+  return pResponse;
+}
+
+bool nuiHTTPCache::Store(const nglString& rURL, const nuiHTTPResponse& rResponse)
+{
+  if (rResponse.GetStatusCode() != 200)
+    return false;
+
+  const nuiHTTPHeaderMap& rHeaders(rResponse.GetHeaders());
+  if (rHeaders.find(_T("ETag")) == rHeaders.end() && rHeaders.find(_T("Last-Modified")) == rHeaders.end())
+    return false;
+  nuiHTTPHeaderMap::const_iterator it = rHeaders.find(_T("Cache-Control"));
+  if (it != rHeaders.end() && it->second.Find(_T("no-store")) >= 0)
+    return false;
+
+  std::string data(NUI_HTTP_CACHE_MAGIC "\n");
+  data += rURL.GetStdString(eUTF8) + '\n';
+  data += nglString().Add(rResponse.GetStatusCode()).GetStdString(eUTF8) + '\n';
+  data += rResponse.GetStatusLine().GetStdString(eUTF8) + '\n';
+  for (it = rHeaders.begin(); it != rHeaders.end(); ++it)
+    data += (it->first + _T(": ") + it->second).GetStdString(eUTF8) + '\n';
+  data += '\n';
+
+  const std::vector<char>& rBody(rResponse.GetBody());
+  nglPath path(GetPath(rURL));
+  nglPath temp(path.GetPathName() + _T(".tmp"));
+
+  nglCriticalSectionGuard guard(mCS);
+  {
+    nglOFile file(temp, eOFileCreate);
+    if (!file.IsOpen())
+      return false;
+    if (file.Write(data.c_str(), data.size(), 1) != (int64)data.size()
+     || (!rBody.empty() && file.Write(&rBody[0], rBody.size(), 1) != (int64)rBody.size()))
+    {
+      file.Close();
+      temp.Delete();
+      return false;
+    }
+  }
+
+  // Readers never see a partially written entry
+  path.Delete();
+  return temp.Move(path);
+}
+
+bool nuiHTTPCache::Remove(const nglString& rURL)
+{
+  nglCriticalSectionGuard guard(mCS);
+  return GetPath(rURL).Delete();
+}
+
+void nuiHTTPCache::Clear()
+{
+  nglCriticalSectionGuard guard(mCS);
+  std::list<nglPath> children;
+  mFolder.GetChildren(children);
+  for (std::list<nglPath>::iterator it = children.begin(); it != children.end(); ++it)
+  {
+    if (it->GetExtension() == _T("http"))
+      it->Delete();
+  }
+}
+
+void nuiHTTPCache::AddValidators(const nuiHTTPResponse& rCached, nuiHTTPHeaderMap& rHeaders)
+{
+  const nuiHTTPHeaderMap& rCachedHeaders(rCached.GetHeaders());
+  nuiHTTPHeaderMap::const_iterator it = rCachedHeaders.find(_T("ETag"));
+  if (it != rCachedHeaders.end())
+    rHeaders[_T("If-None-Match")] = it->second;
+  it = rCachedHeaders.find(_T("Last-Modified"));
+  if (it != rCachedHeaders.end())
+    rHeaders[_T("If-Modified-Since")] = it->second;
+}
@@ -8,6 +8,7 @@
 #include "nui.h"
 #include "nuiSocket.h"
 #include "nuiNetworkHost.h"
+#include "nuiSocketPool.h"
 
 #ifdef WIN32
 #include <Ws2tcpip.h>
@@ -16,22 +17,33 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
+#include <fcntl.h>
 #endif
 
 
 nuiSocket::nuiSocket(nuiSocket::SocketType Socket)
-: mSocket(Socket)
+: mSocket(Socket), mNonBlocking(false), mpPool(NULL), mpDeleted(NULL)
 {
 }
 
 bool nuiSocket::Init(int domain, int type, int protocol)
 {
   mSocket = socket(domain, type, protocol);
-  return mSocket >= 0;
+  if (mSocket < 0)
+    return false;
+
+  if (mNonBlocking)
+    return SetNonBlocking(true);
+  return true;
 }
 
 nuiSocket::~nuiSocket()
 {
+  if (mpDeleted)
+    *mpDeleted = true;
+  if (mpPool)
+    mpPool->Del(this);
+
 #ifdef WIN32
   //DisconnectEx(mSocket, NULL, 0, 0);
   closesocket(mSocket);
@@ -77,6 +89,118 @@ bool nuiSocket::IsValid() const
   return mSocket != -1;
 }
 
+bool nuiSocket::SetNonBlocking(bool set)
+{
+  if (mSocket == -1)
+  {
+    // Applied when the socket is created
+    mNonBlocking = set;
+    return true;
+  }
+
+#ifdef WIN32
+  u_long mode = set ? 1 : 0;
+  if (ioctlsocket(mSocket, FIONBIO, &mode) != 0)
+    return false;
+#else
+  int flags = fcntl(mSocket, F_GETFL, 0);
+  if (flags < 0)
+    return false;
+  flags = set ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+  if (fcntl(mSocket, F_SETFL, flags) != 0)
+    return false;
+#endif
+
+  mNonBlocking = set;
+  return true;
+}
+
+bool nuiSocket::IsNonBlocking() const
+{
+  return mNonBlocking;
+}
+
+void nuiSocket::SetCanReadDelegate(const EventDelegate& rDelegate)
+{
+  mReadDelegate = rDelegate;
+}
+
+void nuiSocket::SetCanWriteDelegate(const EventDelegate& rDelegate)
+{
+  mWriteDelegate = rDelegate;
+}
+
+void nuiSocket::SetReadClosedDelegate(const EventDelegate& rDelegate)
+{
+  mReadCloseDelegate = rDelegate;
+}
+
+void nuiSocket::SetWriteClosedDelegate(const EventDelegate& rDelegate)
+{
+  mWriteCloseDelegate = rDelegate;
+}
+
+void nuiSocket::OnCanRead()
+{
+  CallDelegate(mReadDelegate);
+}
+
+void nuiSocket::OnCanWrite()
+{
+  CallDelegate(mWriteDelegate);
+}
+
+void nuiSocket::OnReadClosed()
+{
+  CallDelegate(mReadCloseDelegate);
+}
+
+void nuiSocket::OnWriteClosed()
+{
+  CallDelegate(mWriteCloseDelegate);
+}
+
+bool nuiSocket::CallDelegate(const EventDelegate& rDelegate)
+{
+  if (!rDelegate)
+    return true;
+
+  bool deleted = false;
+  bool* pPrevious = mpDeleted;
+  mpDeleted = &deleted;
+
+  rDelegate(*this);
+
+  if (deleted)
+  {
+    // Let the callers know too
+    if (pPrevious)
+      *pPrevious = true;
+    return false;
+  }
+
+  mpDeleted = pPrevious;
+  return true;
+}
+
+bool nuiSocket::WouldBlock()
+{
+#ifdef WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+bool nuiSocket::Interrupted()
+{
+#ifdef WIN32
+  return WSAGetLastError() == WSAEINTR;
+#else
+  return errno == EINTR;
+#endif
+}
+
 struct addrinfo* nuiSocket::GetAddrInfo(const nuiNetworkHost& rHost) const
 {
   return rHost.GetAddrInfo();
@@ -0,0 +1,274 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "nuiSocketPool.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#endif
+
+nuiSocketPool::nuiSocketPool()
+: mEventCount(0), mCurrentEvent(0), mpThread(NULL), mStop(false)
+{
+  mWakePipe[0] = mWakePipe[1] = -1;
+
+#if defined(NUI_SOCKETPOOL_EPOLL) || defined(NUI_SOCKETPOOL_KQUEUE)
+  if (pipe(mWakePipe) == 0)
+  {
+    fcntl(mWakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(mWakePipe[1], F_SETFL, O_NONBLOCK);
+  }
+#endif
+
+#if defined(NUI_SOCKETPOOL_EPOLL)
+  mEPoll = epoll_create(1024);
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = this;
+  epoll_ctl(mEPoll, EPOLL_CTL_ADD, mWakePipe[0], &ev);
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+  mQueue = kqueue();
+  struct kevent ev;
+  EV_SET(&ev, mWakePipe[0], EVFILT_READ, EV_ADD, 0, 0, this);
+  kevent(mQueue, &ev, 1, NULL, 0, NULL);
+#endif
+}
+
+nuiSocketPool::~nuiSocketPool()
+{
+  Stop();
+
+  nglCriticalSectionGuard guard(mCS);
+  for (std::set<nuiSocket*>::iterator it = mSockets.begin(); it != mSockets.end(); ++it)
+    (*it)->mpPool = NULL;
+  mSockets.clear();
+
+#if defined(NUI_SOCKETPOOL_EPOLL)
+  close(mEPoll);
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+  close(mQueue);
+#endif
+
+#ifndef WIN32
+  if (mWakePipe[0] != -1)
+  {
+    close(mWakePipe[0]);
+    close(mWakePipe[1]);
+  }
+#endif
+}
+
+bool nuiSocketPool::Add(nuiSocket* pSocket, TriggerMode Mode)
+{
+  if (!pSocket->IsValid() || pSocket->mpPool)
+    return false;
+
+  if (!pSocket->IsNonBlocking() && !pSocket->SetNonBlocking(true))
+    return false;
+
+#if defined(NUI_SOCKETPOOL_EPOLL)
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+  if (Mode == eStateChange)
+    ev.events |= EPOLLET;
+  ev.data.ptr = pSocket;
+  if (epoll_ctl(mEPoll, EPOLL_CTL_ADD, pSocket->GetSocket(), &ev) != 0)
+    return false;
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+  struct kevent ev[2];
+  uint16 flags = EV_ADD;
+  if (Mode == eStateChange)
+    flags |= EV_CLEAR;
+  EV_SET(&ev[0], pSocket->GetSocket(), EVFILT_READ, flags, 0, 0, pSocket);
+  EV_SET(&ev[1], pSocket->GetSocket(), EVFILT_WRITE, flags, 0, 0, pSocket);
+  if (kevent(mQueue, ev, 2, NULL, 0, NULL) != 0)
+    return false;
+#else
+  return false;
+#endif
+
+  nglCriticalSectionGuard guard(mCS);
+  pSocket->mpPool = this;
+  mSockets.insert(pSocket);
+  return true;
+}
+
+bool nuiSocketPool::Del(nuiSocket* pSocket)
+{
+  {
+    nglCriticalSectionGuard guard(mCS);
+    std::set<nuiSocket*>::iterator it = mSockets.find(pSocket);
+    if (it == mSockets.end())
+      return false;
+    mSockets.erase(it);
+    pSocket->mpPool = NULL;
+  }
+
+#if defined(NUI_SOCKETPOOL_EPOLL)
+  struct epoll_event ev; // Needed by old kernels
+  epoll_ctl(mEPoll, EPOLL_CTL_DEL, pSocket->GetSocket(), &ev);
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+  struct kevent ev[2];
+  EV_SET(&ev[0], pSocket->GetSocket(), EVFILT_READ, EV_DELETE, 0, 0, NULL);
+  EV_SET(&ev[1], pSocket->GetSocket(), EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+  kevent(mQueue, ev, 2, NULL, 0, NULL);
+#endif
+
+  InvalidatePendingEvents(pSocket);
+  return true;
+}
+
+uint32 nuiSocketPool::GetSocketCount() const
+{
+  nglCriticalSectionGuard guard(mCS);
+  return mSockets.size();
+}
+
+void nuiSocketPool::InvalidatePendingEvents(nuiSocket* pSocket)
+{
+  // The socket may be removed by the delegate of an event from the same batch: forget its other events.
+  for (int32 i = mCurrentEvent + 1; i < mEventCount; i++)
+  {
+#if defined(NUI_SOCKETPOOL_EPOLL)
+    if (mEvents[i].data.ptr == pSocket)
+      mEvents[i].data.ptr = NULL;
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+    if (mEvents[i].udata == (void*)pSocket)
+      mEvents[i].udata = NULL;
+#endif
+  }
+}
+
+void nuiSocketPool::Dispatch(nuiSocket* pSocket, bool CanRead, bool CanWrite, bool WriteClosed)
+{
+  bool deleted = false;
+  pSocket->mpDeleted = &deleted;
+
+  if (CanRead)
+    pSocket->OnCanRead();
+  if (!deleted && CanWrite)
+    pSocket->OnCanWrite();
+  if (!deleted && WriteClosed)
+    pSocket->OnWriteClosed();
+
+  if (!deleted)
+    pSocket->mpDeleted = NULL;
+}
+
+int32 nuiSocketPool::DispatchEvents(int32 TimeOutMilliSec)
+{
+#if defined(NUI_SOCKETPOOL_EPOLL)
+  int res = epoll_wait(mEPoll, mEvents, MaxEvents, TimeOutMilliSec);
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+  struct timespec timeout;
+  timeout.tv_sec = TimeOutMilliSec / 1000;
+  timeout.tv_nsec = (TimeOutMilliSec % 1000) * 1000000;
+  int res = kevent(mQueue, NULL, 0, mEvents, MaxEvents, (TimeOutMilliSec < 0) ? NULL : &timeout);
+#else
+  int res = -1;
+#endif
+
+  if (res < 0)
+    return (errno == EINTR) ? 0 : -1;
+
+  mEventCount = res;
+  for (mCurrentEvent = 0; mCurrentEvent < mEventCount; mCurrentEvent++)
+  {
+#if defined(NUI_SOCKETPOOL_EPOLL)
+    const struct epoll_event& rEvent(mEvents[mCurrentEvent]);
+    void* pData = rEvent.data.ptr;
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+    const struct kevent& rEvent(mEvents[mCurrentEvent]);
+    void* pData = rEvent.udata;
+#else
+    void* pData = NULL;
+#endif
+
+    if (!pData)
+      continue;
+
+    if (pData == this)
+    {
+      // Woken up: empty the pipe
+#ifndef WIN32
+      char buffer[64];
+      while (read(mWakePipe[0], buffer, sizeof(buffer)) > 0)
+        ;
+#endif
+      continue;
+    }
+
+    nuiSocket* pSocket = (nuiSocket*)pData;
+#if defined(NUI_SOCKETPOOL_EPOLL)
+    // Errors and hang ups are reported to the read handler, which finds out what happened when reading.
+    bool canread = (rEvent.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+    bool canwrite = (rEvent.events & EPOLLOUT) != 0;
+    bool writeclosed = (rEvent.events & (EPOLLHUP | EPOLLERR)) != 0;
+    Dispatch(pSocket, canread, canwrite, writeclosed);
+#elif defined(NUI_SOCKETPOOL_KQUEUE)
+    if (rEvent.filter == EVFILT_READ)
+      Dispatch(pSocket, true, false, false);
+    else if (rEvent.filter == EVFILT_WRITE)
+      Dispatch(pSocket, false, (rEvent.flags & EV_EOF) == 0, (rEvent.flags & EV_EOF) != 0);
+#endif
+  }
+
+  mEventCount = 0;
+  mCurrentEvent = 0;
+  return res;
+}
+
+void nuiSocketPool::Wake()
+{
+#ifndef WIN32
+  if (mWakePipe[1] != -1)
+  {
+    char c = 0;
+    write(mWakePipe[1], &c, 1);
+  }
+#endif
+}
+
+bool nuiSocketPool::Start()
+{
+  if (mpThread)
+    return false;
+
+  mStop = false;
+  mpThread = new nglThreadDelegate(nuiMakeDelegate(this, &nuiSocketPool::Run), _T("nuiSocketPool"));
+  return mpThread->Start();
+}
+
+void nuiSocketPool::Stop()
+{
+  if (!mpThread)
+    return;
+
+  mStop = true;
+  Wake();
+  mpThread->Join();
+  delete mpThread;
+  mpThread = NULL;
+}
+
+bool nuiSocketPool::IsRunning() const
+{
+  return mpThread != NULL;
+}
+
+void nuiSocketPool::Run()
+{
+  while (!mStop)
+  {
+    if (DispatchEvents(-1) < 0)
+      break;
+  }
+}
+
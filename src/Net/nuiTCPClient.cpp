@@ -8,6 +8,7 @@
 #include "nui.h"
 #include "nuiTCPClient.h"
 #include "nuiNetworkHost.h"
+#include "nuiSocketPool.h"
 
 #ifdef WIN32
 #include <WinSock2.h>
@@ -20,16 +21,26 @@
 #include <sys/ioctl.h>
 #endif
 
+// Don't get killed by SIGPIPE when the other side is gone:
+#ifdef MSG_NOSIGNAL
+#define NUI_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define NUI_SEND_FLAGS 0
+#endif
+
 
 nuiTCPClient::nuiTCPClient()
+: mReceiveOffset(0), mSendOffset(0)
 {
   mConnected = false;
+  mReadClosed = false;
 }
 
 nuiTCPClient::nuiTCPClient(int sock)
-: nuiSocket(sock)
+: nuiSocket(sock), mReceiveOffset(0), mSendOffset(0)
 {
   mConnected = true;
+  mReadClosed = false;
 }
 
 nuiTCPClient::~nuiTCPClient()
@@ -47,6 +58,12 @@ bool nuiTCPClient::Connect(const nuiNetworkHost& rHost)
 
   struct addrinfo* addr = nuiSocket::GetAddrInfo(rHost);
   int res = connect(mSocket, addr->ai_addr, addr->ai_addrlen);
+#ifdef WIN32
+  if (res && IsNonBlocking() && WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+  if (res && IsNonBlocking() && errno == EINPROGRESS)
+#endif
+    res = 0; // The socket will be writable once connected
   if (res)
     DumpError(errno);
   
@@ -70,6 +87,8 @@ bool nuiTCPClient::Connect(uint32 ipaddress, int16 port)
 
 bool nuiTCPClient::Send(const std::vector<uint8>& rData)
 {
+  if (rData.empty())
+    return true;
   return Send(&rData[0], rData.size());
 }
 
@@ -78,12 +97,19 @@ bool nuiTCPClient::Send(const uint8* pData, int len)
   if (!IsConnected())
     return false;
   
-#ifdef WIN32
-  send(mSocket, (const char*)pData, len, 0);
-#else
-  send(mSocket, pData, len, 0);
-#endif
-  return false;
+  while (len > 0)
+  {
+    int res = send(mSocket, (const char*)pData, len, NUI_SEND_FLAGS);
+    if (res < 0)
+    {
+      if (Interrupted())
+        continue;
+      return false;
+    }
+    pData += res;
+    len -= res;
+  }
+  return true;
 }
 
 
@@ -159,6 +185,8 @@ bool nuiTCPClient::Close()
   if (!IsConnected())
     return false;
 
+  if (mpPool)
+    mpPool->Del(this);
   
 #ifdef WIN32
   //DisconnectEx(mSocket, NULL, 0, 0);
@@ -168,6 +196,7 @@ bool nuiTCPClient::Close()
 #endif
   
   mSocket = -1;
+  mConnected = false;
   return true;
 }
 
@@ -196,4 +225,146 @@ bool nuiTCPClient::CanWrite() const
   return IsConnected();
 }
 
+// Buffered I/O:
+bool nuiTCPClient::BufferedSend(const std::vector<uint8>& rData)
+{
+  if (rData.empty())
+    return IsConnected();
+  return BufferedSend(&rData[0], rData.size());
+}
+
+bool nuiTCPClient::BufferedSend(const uint8* pData, int len)
+{
+  if (!IsConnected())
+    return false;
+
+  if (mSendOffset == mSendBuffer.size())
+  {
+    mSendBuffer.clear();
+    mSendOffset = 0;
+  }
+  mSendBuffer.insert(mSendBuffer.end(), pData, pData + len);
+  FlushSendBuffer();
+  return true;
+}
+
+uint32 nuiTCPClient::GetBufferedSendSize() const
+{
+  return mSendBuffer.size() - mSendOffset;
+}
+
+bool nuiTCPClient::FlushSendBuffer()
+{
+  while (mSendOffset < mSendBuffer.size())
+  {
+    int res = send(mSocket, (const char*)&mSendBuffer[mSendOffset], mSendBuffer.size() - mSendOffset, NUI_SEND_FLAGS);
+    if (res < 0)
+    {
+      if (Interrupted())
+        continue;
+#ifndef WIN32
+      if (!WouldBlock() && errno != ENOTCONN) // ENOTCONN: still connecting
+#else
+      if (!WouldBlock())
+#endif
+      {
+        // The pool will report the error, there is no point in keeping the data
+        mSendBuffer.clear();
+        mSendOffset = 0;
+      }
+      return false;
+    }
+    mSendOffset += res;
+  }
+
+  mSendBuffer.clear();
+  mSendOffset = 0;
+  return true;
+}
+
+uint32 nuiTCPClient::GetReceivedSize() const
+{
+  return mReceiveBuffer.size() - mReceiveOffset;
+}
+
+const uint8* nuiTCPClient::GetReceived() const
+{
+  if (mReceiveOffset == mReceiveBuffer.size())
+    return NULL;
+  return &mReceiveBuffer[mReceiveOffset];
+}
+
+void nuiTCPClient::DiscardReceived(uint32 len)
+{
+  mReceiveOffset += MIN(len, GetReceivedSize());
+  if (mReceiveOffset == mReceiveBuffer.size())
+  {
+    mReceiveBuffer.clear();
+    mReceiveOffset = 0;
+  }
+}
+
+uint32 nuiTCPClient::Read(uint8* pData, uint32 len)
+{
+  len = MIN(len, GetReceivedSize());
+  if (len)
+    memcpy(pData, &mReceiveBuffer[mReceiveOffset], len);
+  DiscardReceived(len);
+  return len;
+}
+
+void nuiTCPClient::OnCanRead()
+{
+  // An edge triggered pool only signals new data once: read until the socket is drained.
+  const uint32 ChunkSize = 16384;
+  bool received = false;
+  bool wasclosed = mReadClosed;
+  while (!mReadClosed)
+  {
+    if (mReceiveOffset > ChunkSize && mReceiveOffset * 2 > mReceiveBuffer.size())
+    {
+      // Compact the buffer
+      mReceiveBuffer.erase(mReceiveBuffer.begin(), mReceiveBuffer.begin() + mReceiveOffset);
+      mReceiveOffset = 0;
+    }
+
+    size_t size = mReceiveBuffer.size();
+    mReceiveBuffer.resize(size + ChunkSize);
+    int res = recv(mSocket, (char*)&mReceiveBuffer[size], ChunkSize, 0);
+    mReceiveBuffer.resize(size + MAX(res, 0));
+
+    if (res > 0)
+    {
+      received = true;
+    }
+    else if (res == 0)
+    {
+      mReadClosed = true;
+    }
+    else if (Interrupted())
+    {
+      continue;
+    }
+    else
+    {
+      if (!WouldBlock())
+        mReadClosed = true;
+      break;
+    }
+  }
+
+  if (received && !CallDelegate(mReadDelegate))
+    return;
+
+  if (mReadClosed && !wasclosed)
+    OnReadClosed();
+}
+
+void nuiTCPClient::OnCanWrite()
+{
+  if (!FlushSendBuffer())
+    return;
+  CallDelegate(mWriteDelegate);
+}
+
 
@@ -9,6 +9,7 @@
 #include "nuiNetworkHost.h"
 #include "nuiTCPServer.h"
 #include "nuiTCPClient.h"
+#include "nuiSocketPool.h"
 
 #ifdef WIN32
 #include <Ws2tcpip.h>
@@ -64,16 +65,25 @@ bool nuiTCPServer::Listen(int backlog)
 nuiTCPClient* nuiTCPServer::Accept()
 {
   int s = accept(mSocket, NULL, NULL);
+  if (s < 0)
+    return NULL; // No pending connection on a non blocking socket, or error
   nuiTCPClient* pClient = new nuiTCPClient(s);
+  if (IsNonBlocking())
+    pClient->SetNonBlocking(true);
   return pClient;
 }
 
 bool nuiTCPServer::Close()
 {
+  if (mpPool)
+    mpPool->Del(this);
+
 #ifdef WIN32
-  return 0 == closesocket(mSocket);
+  bool res = 0 == closesocket(mSocket);
 #else
-  return 0 == close(mSocket);
+  bool res = 0 == close(mSocket);
 #endif
+  mSocket = -1;
+  return res;
 }
 
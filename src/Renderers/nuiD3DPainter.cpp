@@ -921,6 +921,7 @@ void nuiD3DPainter::DrawArray(nuiRenderArray* pArray)
   //#define DRAW_PUP
 #ifdef DRAW_PUP
   hr = pDev->DrawPrimitiveUP(primtype, primitivecount, pData, stride);				//draw triangle ( NEW )
+  mDrawCalls++;
 #else
   // copy datas to the vertex buffer
   NuiD3DVertex* pVertices = NULL;
@@ -1022,9 +1023,12 @@ void nuiD3DPainter::DrawArray(nuiRenderArray* pArray)
   }
 
   hr = mpVB->Unlock();
+  mUploads++;
+  mUploadedBytes += (nSectionSize + 1) * sizeof(NuiD3DVertex);
   if (!pArray->GetIndexArrayCount())
   {
     hr = pDev->DrawPrimitive(primtype, mnCurrentVBOffset, primitivecount);
+    mDrawCalls++;
   }
   else
   {
@@ -1119,6 +1123,7 @@ void nuiD3DPainter::DrawArray(nuiRenderArray* pArray)
       hr = pIndices->Unlock();
       hr = pDev->SetIndices(pIndices);
       hr = pDev->DrawIndexedPrimitive(primtype, 0, 0, size, 0, primitivecount);
+      mDrawCalls++;
       pIndices->Release();
     }
     
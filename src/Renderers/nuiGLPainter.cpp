@@ -14,6 +14,8 @@
 #include "nglMatrix.h"
 #include "AAPrimitives.h"
 #include "nuiTexture.h"
+#include "nuiProfiler.h"
+#include "nuiMemoryTracker.h"
 
 float NUI_SCALE_FACTOR = 1.0f;
 float NUI_INV_SCALE_FACTOR = 1.0f / NUI_SCALE_FACTOR;
@@ -22,7 +24,8 @@ float NUI_INV_SCALE_FACTOR = 1.0f / NUI_SCALE_FACTOR;
 
 //#define NUI_RETURN_IF_RENDERING_DISABLED return;
 #define NUI_RETURN_IF_RENDERING_DISABLED
-//#define NUI_USE_GL_VERTEX_BUFFER
+#define NUI_STREAM_BUFFER_SIZE (1024 * 1024) // Bytes of the streaming vertex ring
+#define NUI_BATCH_MAX_VERTICES 16384 // Merged arrays are drawn once they reach this many vertices
 #define NUI_COMPLEX_SHAPE_THRESHOLD 6
 
 //#define NUI_USE_ANTIALIASING
@@ -44,6 +47,13 @@ float NUI_INV_SCALE_FACTOR = 1.0f / NUI_SCALE_FACTOR;
 #define glBindRenderbufferNUI         glBindRenderbufferOES
 #define glFramebufferTexture2DNUI     glFramebufferTexture2DOES
 
+#define glBindBufferNUI               glBindBuffer
+#define glGenBuffersNUI               glGenBuffers
+#define glDeleteBuffersNUI            glDeleteBuffers
+#define glBufferDataNUI               glBufferData
+#define glBufferSubDataNUI            glBufferSubData
+#define NUI_NO_MAP_BUFFER_RANGE
+
 #define GL_FRAMEBUFFER_NUI                                GL_FRAMEBUFFER_OES
 #define GL_RENDERBUFFER_NUI                               GL_RENDERBUFFER_OES
 #define GL_FRAMEBUFFER_BINDING_NUI                        GL_FRAMEBUFFER_BINDING_OES
@@ -79,6 +89,13 @@ float NUI_INV_SCALE_FACTOR = 1.0f / NUI_SCALE_FACTOR;
 #define glDeleteRenderbuffersNUI      glDeleteRenderbuffersEXT
 #define glBindRenderbufferNUI         glBindRenderbufferEXT
 #define glFramebufferTexture2DNUI     glFramebufferTexture2DEXT
+
+#define glBindBufferNUI               glBindBuffer
+#define glGenBuffersNUI               glGenBuffers
+#define glDeleteBuffersNUI            glDeleteBuffers
+#define glBufferDataNUI               glBufferData
+#define glBufferSubDataNUI            glBufferSubData
+#define NUI_NO_MAP_BUFFER_RANGE
 #else
 #define glCheckFramebufferStatusNUI   mpContext->glCheckFramebufferStatusEXT
 #define glFramebufferRenderbufferNUI  mpContext->glFramebufferRenderbufferEXT
@@ -90,6 +107,14 @@ float NUI_INV_SCALE_FACTOR = 1.0f / NUI_SCALE_FACTOR;
 #define glDeleteRenderbuffersNUI      mpContext->glDeleteRenderbuffersEXT
 #define glBindRenderbufferNUI         mpContext->glBindRenderbufferEXT
 #define glFramebufferTexture2DNUI     mpContext->glFramebufferTexture2DEXT
+
+#define glBindBufferNUI               mpContext->glBindBuffer
+#define glGenBuffersNUI               mpContext->glGenBuffers
+#define glDeleteBuffersNUI            mpContext->glDeleteBuffers
+#define glBufferDataNUI               mpContext->glBufferData
+#define glBufferSubDataNUI            mpContext->glBufferSubData
+#define glMapBufferRangeNUI           mpContext->glMapBufferRange
+#define glUnmapBufferNUI              mpContext->glUnmapBuffer
 #endif
 
 #define GL_FRAMEBUFFER_NUI                                GL_FRAMEBUFFER_EXT
@@ -229,6 +254,10 @@ nuiGLPainter::nuiGLPainter(nglContext* pContext, const nuiRect& rRect)
   mViewPort[1] = 0;
   mViewPort[2] = 0;
   mViewPort[3] = 0;
+  mUseVertexBuffers = false;
+  mUseMapBufferRange = false;
+  mStreamBuffer = 0;
+  mStreamOffset = 0;
   
   
   mpContext = pContext;
@@ -246,7 +275,7 @@ nuiGLPainter::nuiGLPainter(nglContext* pContext, const nuiRect& rRect)
     nuiCheckForGLErrors();
     mpContext->CheckExtension(_T("GL_VERSION_1_4"));
     nuiCheckForGLErrors();
-    mpContext->CheckExtension(_T("GL_VERSION_1_5"));
+    bool vbo = mpContext->CheckExtension(_T("GL_VERSION_1_5"));
     nuiCheckForGLErrors();
     mpContext->CheckExtension(_T("GL_VERSION_2_0"));
     nuiCheckForGLErrors();
@@ -257,6 +286,14 @@ nuiGLPainter::nuiGLPainter(nglContext* pContext, const nuiRect& rRect)
     
     mpContext->CheckExtension(_T("GL_ARB_framebuffer_object"));
     nuiCheckForGLErrors();
+
+#if defined(_OPENGL_ES_) || defined(_MACOSX_)
+    mUseVertexBuffers = true;
+#else
+    mUseVertexBuffers = vbo && mpContext->glGenBuffers;
+    mUseMapBufferRange = mUseVertexBuffers && mpContext->CheckExtension(_T("GL_ARB_map_buffer_range")) && mpContext->glMapBufferRange;
+    nuiCheckForGLErrors();
+#endif
     
     if (mpContext->CheckExtension(_T("GL_ARB_texture_non_power_of_two")))
     {
@@ -291,6 +328,24 @@ nuiGLPainter::nuiGLPainter(nglContext* pContext, const nuiRect& rRect)
 
 nuiGLPainter::~nuiGLPainter()
 {
+  if (mStreamBuffer || !mStaticBuffers.empty())
+  {
+    mpContext->BeginSession();
+    if (mStreamBuffer)
+      glDeleteBuffersNUI(1, &mStreamBuffer);
+
+    std::set<StaticBuffer*>::iterator it = mStaticBuffers.begin();
+    std::set<StaticBuffer*>::iterator end = mStaticBuffers.end();
+    for (; it != end; ++it)
+    {
+      StaticBuffer* pBuffer = *it;
+      pBuffer->mpArray->SetCacheHandle(NULL, NULL);
+      glDeleteBuffersNUI(1, &pBuffer->mBuffer);
+      delete pBuffer;
+    }
+    mStaticBuffers.clear();
+  }
+
   mActiveContexts--;
   if (mActiveContexts == 0)
     glAAExit();
@@ -298,6 +353,8 @@ nuiGLPainter::~nuiGLPainter()
 
 void nuiGLPainter::SetViewport()
 {
+  Flush();
+
   //GetAngle(), GetCurrentWidth(), GetCurrentHeight(), mProjectionViewportStack.top(), mProjectionMatrixStack.top());
   GLuint Angle = GetAngle();
   GLuint Width = GetCurrentWidth();
@@ -443,6 +500,7 @@ void nuiGLPainter::ApplyState(const nuiRenderState& rState, bool ForceApply)
   // blending
   if (ForceApply || mFinalState.mBlending != rState.mBlending)
   {
+    Flush();
     mFinalState.mBlending = rState.mBlending;
     if (mFinalState.mBlending)
     {
@@ -456,6 +514,7 @@ void nuiGLPainter::ApplyState(const nuiRenderState& rState, bool ForceApply)
   
   if (ForceApply || mFinalState.mBlendFunc != rState.mBlendFunc)
   {
+    Flush();
     mFinalState.mBlendFunc = rState.mBlendFunc;
     GLenum src, dst;
     nuiGetBlendFuncFactors(rState.mBlendFunc, src, dst);
@@ -465,6 +524,7 @@ void nuiGLPainter::ApplyState(const nuiRenderState& rState, bool ForceApply)
   
   if (ForceApply || mFinalState.mDepthTest != rState.mDepthTest)
   {
+    Flush();
     mFinalState.mDepthTest = rState.mDepthTest;
     if (mFinalState.mDepthTest)
       glEnable(GL_DEPTH_TEST);
@@ -474,6 +534,7 @@ void nuiGLPainter::ApplyState(const nuiRenderState& rState, bool ForceApply)
   
   if (ForceApply || mFinalState.mDepthWrite != rState.mDepthWrite)
   {
+    Flush();
     mFinalState.mDepthWrite = rState.mDepthWrite;
     glDepthMask(mFinalState.mDepthWrite);
   }
@@ -487,6 +548,7 @@ void nuiGLPainter::ApplyState(const nuiRenderState& rState, bool ForceApply)
   // Rendering buffers:
   if (ForceApply || mFinalState.mColorBuffer != rState.mColorBuffer)
   {
+    Flush();
     mFinalState.mColorBuffer = rState.mColorBuffer;
     GLboolean m = mFinalState.mColorBuffer ? GL_TRUE : GL_FALSE;
     glColorMask(m, m, m, m);
@@ -541,12 +603,14 @@ void nuiGLPainter::ApplyState(const nuiRenderState& rState, bool ForceApply)
     
     if (!mScissorOn || ForceApply)
     {
+      Flush();
       glEnable(GL_SCISSOR_TEST);
       mScissorOn = true;
     }
     
     if (mScissorX != x || mScissorY != y || mScissorW != w || mScissorH != h || ForceApply)
     {
+      Flush();
       mScissorX = x;
       mScissorY = y;
       mScissorW = w;
@@ -567,6 +631,7 @@ void nuiGLPainter::ApplyState(const nuiRenderState& rState, bool ForceApply)
   {
     if (mScissorOn || ForceApply)
     {
+      Flush();
       glDisable(GL_SCISSOR_TEST);
       mScissorOn = false;
     }
@@ -613,6 +678,7 @@ void nuiGLPainter::ApplyTexture(const nuiRenderState& rState, bool ForceApply)
   bool uptodate = (it == mTextures.end()) ? false : ( !it->second.mReload && it->second.mTexture >= 0 );
   if (ForceApply || (mFinalState.mpTexture != rState.mpTexture) || (mFinalState.mpTexture && !uptodate))
   { 
+    Flush();
     GLenum intarget = 0;
     GLenum outtarget = 0;
     
@@ -737,6 +803,7 @@ void nuiGLPainter::ApplyTexture(const nuiRenderState& rState, bool ForceApply)
   
   if (ForceApply || (mFinalState.mTexturing != rState.mTexturing))
   {
+    Flush();
     // Texture have not changed, but texturing may have been enabled / disabled
     mFinalState.mTexturing = rState.mTexturing;
     
@@ -773,6 +840,7 @@ void nuiGLPainter::ClearColor()
   mRenderOperations++;
   NUI_RETURN_IF_RENDERING_DISABLED;
   
+  Flush();
   glClearColor(mState.mClearColor.Red(),mState.mClearColor.Green(),mState.mClearColor.Blue(),mState.mClearColor.Alpha());
   glClear(GL_COLOR_BUFFER_BIT);
   nuiCheckForGLErrors();
@@ -977,15 +1045,108 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
   
   if (mMatrixChanged)
   {
+    Flush();
     nuiGLLoadMatrix(mMatrixStack.top().Array);
     mMatrixChanged = false;
   }
   
+  Batch batch;
+  batch.mMode = mode;
+  batch.mVertexArray = pArray->IsArrayEnabled(nuiRenderArray::eVertex);
+  batch.mColorArray = pArray->IsArrayEnabled(nuiRenderArray::eColor);
+  batch.mTexCoordArray = pArray->IsArrayEnabled(nuiRenderArray::eTexCoord);
+  batch.mTranslateHack = pArray->IsShape() || ((mode == GL_POINTS || mode == GL_LINES || mode == GL_LINE_LOOP || mode == GL_LINE_STRIP) && !pArray->Is3DMesh());
+  
+  if (!batch.mColorArray)
+  {
+    switch (mode)
+    {
+      case GL_POINTS:
+      case GL_LINES:
+      case GL_LINE_LOOP:
+      case GL_LINE_STRIP:
+        batch.mColor = mFinalState.mStrokeColor;
+        break;
+        
+      case GL_TRIANGLES:
+      case GL_TRIANGLE_STRIP:
+      case GL_TRIANGLE_FAN:
+#ifndef _OPENGL_ES_
+      case GL_QUADS:
+      case GL_QUAD_STRIP:
+      case GL_POLYGON:
+#endif
+        batch.mColor = mFinalState.mFillColor;
+        break;
+    }
+  }
+  
+  if (CanMerge(pArray))
+  {
+    // The pending arrays are drawn first if this one needs other GL calls:
+    if (!mBatchVertices.empty()
+        && (mBatch.mMode != batch.mMode
+            || mBatch.mColorArray != batch.mColorArray
+            || mBatch.mTexCoordArray != batch.mTexCoordArray
+            || mBatch.mTranslateHack != batch.mTranslateHack
+            || (!batch.mColorArray && !(mBatch.mColor == batch.mColor))
+            || mBatchVertices.size() + s > NUI_BATCH_MAX_VERTICES))
+    {
+      Flush();
+    }
+    
+    if (mBatchVertices.empty())
+      mBatch = batch;
+    const nuiRenderArray::Vertex* pVertices = &pArray->GetVertices()[0];
+    mBatchVertices.insert(mBatchVertices.end(), pVertices, pVertices + s);
+    pArray->Release();
+    return;
+  }
+  
+  Flush();
+  Draw(batch, &pArray->GetVertices()[0], s, pArray);
+  
+  pArray->Release();
+  nuiCheckForGLErrors();
+}
+
+bool nuiGLPainter::CanMerge(const nuiRenderArray* pArray) const
+{
+  if (!pArray->IsArrayEnabled(nuiRenderArray::eVertex) || pArray->GetIndexArrayCount())
+    return false;
+  if (pArray->IsStatic() && mUseVertexBuffers)
+    return false; // Drawn from its own vertex buffer
+  
+  // Only lists of whole independent primitives can be drawn together:
+  uint32 size = pArray->GetSize();
+  if (size > NUI_BATCH_MAX_VERTICES)
+    return false;
+  switch (pArray->GetMode())
+  {
+    case GL_POINTS:
+      return true;
+    case GL_LINES:
+      return !(size % 2);
+    case GL_TRIANGLES:
+      return !(size % 3);
+  }
+  return false;
+}
+
+void nuiGLPainter::Flush()
+{
+  if (mBatchVertices.empty())
+    return;
   
-  bool NeedTranslateHack = pArray->IsShape() || ((mode == GL_POINTS || mode == GL_LINES || mode == GL_LINE_LOOP || mode == GL_LINE_STRIP) && !pArray->Is3DMesh());
+  Draw(mBatch, &mBatchVertices[0], (uint32)mBatchVertices.size(), NULL);
+  mBatchVertices.clear();
+}
+
+void nuiGLPainter::Draw(const Batch& rBatch, const nuiRenderArray::Vertex* pVertices, uint32 Count, nuiRenderArray* pArray)
+{
   float hackX;
   float hackY;
-  if (NeedTranslateHack)
+  if (rBatch.mTranslateHack)
   {
     //    const float ratio=0.5f;
     const float ratio= NUI_INV_SCALE_FACTOR/2.f;
@@ -1034,12 +1195,32 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
   }
 #endif // NUI_USE_ANTIALIASING
   
-  if (pArray->IsArrayEnabled(nuiRenderArray::eVertex))
+  // The vertices come from the buffer of a static array, from the streaming ring, or from the client memory:
+  const GLubyte* pBase = (const GLubyte*)pVertices;
+  GLuint buffer = 0;
+  if (pArray && pArray->IsStatic())
+    buffer = GetStaticBuffer(pArray);
+  
+  if (buffer)
+  {
+    pBase = NULL;
+  }
+  else
+  {
+    int32 offset = StreamVertices(pVertices, Count);
+    if (offset >= 0)
+    {
+      buffer = mStreamBuffer;
+      pBase = (const GLubyte*)NULL + offset;
+    }
+  }
+  
+  if (rBatch.mVertexArray)
   {
     if (!mClientVertex)
       glEnableClientState(GL_VERTEX_ARRAY);
     mClientVertex = true;
-    glVertexPointer(3, GL_FLOAT, sizeof(nuiRenderArray::Vertex), &pArray->GetVertices()[0].mX);
+    glVertexPointer(3, GL_FLOAT, sizeof(nuiRenderArray::Vertex), pBase + offsetof(nuiRenderArray::Vertex, mX));
     nuiCheckForGLErrors();
   }
   else
@@ -1050,12 +1231,12 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
   }
   
   float r = mR, g = mG, b = mB, a = mA;
-  if (pArray->IsArrayEnabled(nuiRenderArray::eColor))
+  if (rBatch.mColorArray)
   {
     if (!mClientColor)
       glEnableClientState(GL_COLOR_ARRAY);
     mClientColor = true;
-    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(nuiRenderArray::Vertex), &pArray->GetVertices()[0].mR);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(nuiRenderArray::Vertex), pBase + offsetof(nuiRenderArray::Vertex, mR));
     nuiCheckForGLErrors();
   }
   else
@@ -1064,32 +1245,10 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
       glDisableClientState(GL_COLOR_ARRAY);
     mClientColor = false;
     
-    nuiColor c;
-    switch (pArray->GetMode())
-    {
-      case GL_POINTS:
-      case GL_LINES:
-      case GL_LINE_LOOP:
-      case GL_LINE_STRIP:
-        c = mFinalState.mStrokeColor;
-        break;
-        
-      case GL_TRIANGLES:
-      case GL_TRIANGLE_STRIP:
-      case GL_TRIANGLE_FAN:
-#ifndef _OPENGL_ES_
-      case GL_QUADS:
-      case GL_QUAD_STRIP:
-      case GL_POLYGON:
-#endif
-        c = mFinalState.mFillColor;
-        break;
-    }
-    
-    r = c.Red();
-    g = c.Green();
-    b = c.Blue();
-    a = c.Alpha();
+    r = rBatch.mColor.Red();
+    g = rBatch.mColor.Green();
+    b = rBatch.mColor.Blue();
+    a = rBatch.mColor.Alpha();
     nuiCheckForGLErrors();
   }
   
@@ -1102,12 +1261,12 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
     mA = a;
   }
   
-  if (pArray->IsArrayEnabled(nuiRenderArray::eTexCoord))
+  if (rBatch.mTexCoordArray)
   {
     if (!mClientTexCoord)
       glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     mClientTexCoord = true;
-    glTexCoordPointer(2, GL_FLOAT, sizeof(nuiRenderArray::Vertex), &pArray->GetVertices()[0].mTX);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(nuiRenderArray::Vertex), pBase + offsetof(nuiRenderArray::Vertex, mTX));
     nuiCheckForGLErrors();
   }
   else
@@ -1117,98 +1276,30 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
     mClientTexCoord = false;
   }
   
-  /*
-   if (pArray->IsArrayEnabled(nuiRenderArray::eNormal))
-   {
-   glEnableClientState(GL_NORMAL_ARRAY);
-   glNormalPointer(GL_FLOAT, sizeof(nuiRenderArray::Vertex)-12, &pArray->GetVertices()[0].mNX);
-   nuiCheckForGLErrors();
-   }
-   else
-   glDisableClientState(GL_NORMAL_ARRAY);
-   */
-  
-  /*
-   if (pArray->IsArrayEnabled(nuiRenderArray::eEdgeFlag))
-   {
-   glEnableClientState(GL_EDGE_FLAG_ARRAY);
-   glEdgeFlagPointer(sizeof(nuiRenderArray::Vertex), &pArray->GetVertices()[0].mEdgeFlag);
-   nuiCheckForGLErrors();
-   }
-   else
-   glDisableClientState(GL_EDGE_FLAG_ARRAY);
-   */
-  
   nuiCheckForGLErrors();
   
   if (mpSurface && mTwoPassBlend)
   {
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
-    uint32 arraycount = pArray->GetIndexArrayCount();
-    
-    if (!arraycount)
-    {
-      glDrawArrays(mode, 0, s);
-    }
-    else
-    {
-      for (uint32 i = 0; i < arraycount; i++)
-      {
-        nuiRenderArray::IndexArray& array(pArray->GetIndexArray(i));
-#ifdef _UIKIT_
-        glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_SHORT, &(array.mIndices[0]));
-#else
-        glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_INT, &(array.mIndices[0]));
-#endif
-      }
-    }
+    DrawPrimitives(rBatch.mMode, Count, pArray);
     nuiCheckForGLErrors();
     
     glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
     glBlendFunc(mSrcAlpha, mDstAlpha);
-    if (!arraycount)
-    {
-      glDrawArrays(mode, 0, s);
-    }
-    else
-    {
-      for (uint32 i = 0; i < arraycount; i++)
-      {
-        nuiRenderArray::IndexArray& array(pArray->GetIndexArray(i));
-#ifdef _UIKIT_
-        glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_SHORT, &(array.mIndices[0]));
-#else
-        glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_INT, &(array.mIndices[0]));
-#endif
-      }
-    }
+    DrawPrimitives(rBatch.mMode, Count, pArray);
     glBlendFunc(mSrcColor, mDstColor);
     nuiCheckForGLErrors();
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
   }
   else
   {
-    uint32 arraycount = pArray->GetIndexArrayCount();
-    
-    if (!arraycount)
-    {
-      glDrawArrays(mode, 0, s);
-    }
-    else
-    {
-      for (uint32 i = 0; i < arraycount; i++)
-      {
-        nuiRenderArray::IndexArray& array(pArray->GetIndexArray(i));
-#ifdef _UIKIT_
-        glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_SHORT, &(array.mIndices[0]));
-#else
-        glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_INT, &(array.mIndices[0]));
-#endif
-      }
-    }
+    DrawPrimitives(rBatch.mMode, Count, pArray);
     nuiCheckForGLErrors();
   }
   
+  // The code that still uses client arrays mustn't see the buffer:
+  if (buffer)
+    glBindBufferNUI(GL_ARRAY_BUFFER, 0);
   
 #ifdef NUI_USE_ANTIALIASING
   if (mFinalState.mAntialiasing)
@@ -1225,49 +1316,114 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
   else
 #endif // NUI_USE_ANTIALIASING
   {
-    //#TEST meeloo disabling AA texture
-    //     if (pArray->UseGLAATexture())
-    //     {
-    //       glMatrixMode(GL_TEXTURE);
-    //       glPopMatrix();
-    //       glMatrixMode(GL_MODELVIEW);
-    //       glPopMatrix();
-    // 
-    //       if (mFinalState.mpTexture && mFinalState.mTexturing)
-    //       {
-    //         if (mTextureTarget != GL_TEXTURE_2D)
-    //         {
-    //           glDisable(GL_TEXTURE_2D);
-    //           glEnable(mTextureTarget);
-    //         }
-    // 
-    //         UploadTexture(mFinalState.mpTexture);
-    //       }
-    //       else
-    //       {
-    //         glDisable(GL_TEXTURE_2D);
-    //       }
-    // 
-    //       if (!mFinalState.mBlending)
-    //         glDisable(GL_BLEND);
-    //       if (mFinalState.mBlendFunc != nuiBlendTransp)
-    //       {
-    //         GLenum src, dst;
-    //         nuiGetBlendFuncFactors(mFinalState.mBlendFunc, src, dst);
-    //         glBlendFunc(src, dst);
-    //       }
-    //       //ApplyTexture(mState, true);
-    //     }
-    //     else
-    
-    if (NeedTranslateHack)
+    if (rBatch.mTranslateHack)
       glTranslatef(-hackX, -hackY, 0);
   }
   
-  //glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+  nuiCheckForGLErrors();
+}
+
+void nuiGLPainter::DrawPrimitives(GLenum Mode, uint32 Count, nuiRenderArray* pArray)
+{
+  uint32 arraycount = pArray ? pArray->GetIndexArrayCount() : 0;
   
-  pArray->Release();
+  if (!arraycount)
+  {
+    glDrawArrays(Mode, 0, Count);
+    mDrawCalls++;
+    return;
+  }
+  
+  for (uint32 i = 0; i < arraycount; i++)
+  {
+    nuiRenderArray::IndexArray& array(pArray->GetIndexArray(i));
+#ifdef _UIKIT_
+    glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_SHORT, &(array.mIndices[0]));
+#else
+    glDrawElements(array.mMode, array.mIndices.size(), GL_UNSIGNED_INT, &(array.mIndices[0]));
+#endif
+    mDrawCalls++;
+  }
+}
+
+int32 nuiGLPainter::StreamVertices(const nuiRenderArray::Vertex* pVertices, uint32 Count)
+{
+  uint32 bytes = Count * sizeof(nuiRenderArray::Vertex);
+  if (!mUseVertexBuffers || bytes > NUI_STREAM_BUFFER_SIZE)
+    return -1;
+  
+  if (!mStreamBuffer)
+  {
+    glGenBuffersNUI(1, &mStreamBuffer);
+    mStreamOffset = NUI_STREAM_BUFFER_SIZE; // The storage is allocated below
+  }
+  glBindBufferNUI(GL_ARRAY_BUFFER, mStreamBuffer);
+  
+  if (mStreamOffset + bytes > NUI_STREAM_BUFFER_SIZE)
+  {
+    // Orphan the full ring: the driver gives it new storage while the draws that read the old one complete.
+    glBufferDataNUI(GL_ARRAY_BUFFER, NUI_STREAM_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+    mStreamOffset = 0;
+  }
+  
+  bool written = false;
+#ifndef NUI_NO_MAP_BUFFER_RANGE
+  if (mUseMapBufferRange)
+  {
+    // No pending draw reads the rest of the ring since it was orphaned, so there is no need to wait for the GPU:
+    void* pDest = glMapBufferRangeNUI(GL_ARRAY_BUFFER, mStreamOffset, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (pDest)
+    {
+      memcpy(pDest, pVertices, bytes);
+      written = (glUnmapBufferNUI(GL_ARRAY_BUFFER) == GL_TRUE);
+    }
+  }
+#endif
+  if (!written)
+    glBufferSubDataNUI(GL_ARRAY_BUFFER, mStreamOffset, bytes, pVertices);
   nuiCheckForGLErrors();
+  
+  int32 offset = mStreamOffset;
+  mStreamOffset += bytes;
+  mUploads++;
+  mUploadedBytes += bytes;
+  return offset;
+}
+
+GLuint nuiGLPainter::GetStaticBuffer(const nuiRenderArray* pArray)
+{
+  if (!mUseVertexBuffers)
+    return 0;
+  
+  StaticBuffer* pBuffer = (StaticBuffer*)pArray->GetCacheHandle(this);
+  if (pBuffer)
+  {
+    if (mStaticBuffers.find(pBuffer) == mStaticBuffers.end())
+      return 0; // The array is cached by an other painter
+  }
+  else
+  {
+    pBuffer = new StaticBuffer();
+    glGenBuffersNUI(1, &pBuffer->mBuffer);
+    pBuffer->mCount = 0;
+    pBuffer->mpArray = pArray;
+    mStaticBuffers.insert(pBuffer);
+    pArray->SetCacheHandle(this, pBuffer);
+  }
+  
+  glBindBufferNUI(GL_ARRAY_BUFFER, pBuffer->mBuffer);
+  uint32 count = pArray->GetSize();
+  if (pBuffer->mCount != count)
+  {
+    // First draw of the array, or its vertices were replaced:
+    uint32 bytes = count * sizeof(nuiRenderArray::Vertex);
+    glBufferDataNUI(GL_ARRAY_BUFFER, bytes, &pArray->GetVertices()[0], GL_STATIC_DRAW);
+    nuiCheckForGLErrors();
+    pBuffer->mCount = count;
+    mUploads++;
+    mUploadedBytes += bytes;
+  }
+  return pBuffer->mBuffer;
 }
 
 void nuiGLPainter::BeginSession()
@@ -1283,6 +1439,7 @@ void nuiGLPainter::EndSession()
 {
   // Bleh!
   NUI_RETURN_IF_RENDERING_DISABLED;
+  Flush();
   //printf("min = %d max = %d total in frame = %d total = %d\n", mins, maxs, totalinframe, total);
 }
 
@@ -1373,11 +1530,17 @@ void nuiGLPainter::PopProjectionMatrix()
 
 void nuiGLPainter::ReleaseCacheObject(void* pHandle)
 {
-  /* Not 64 bit-safe and 'dead code' as Meeloo said
-   GLuint array = (GLuint)pHandle;
-   mpContext->glDeleteBuffersARB(1, &array);
-   nuiCheckForGLErrors();
-   */
+  // Called by the static arrays that have a vertex buffer when they are destroyed:
+  std::set<StaticBuffer*>::iterator it = mStaticBuffers.find((StaticBuffer*)pHandle);
+  if (it == mStaticBuffers.end())
+    return;
+  
+  StaticBuffer* pBuffer = *it;
+  mpContext->BeginSession();
+  glDeleteBuffersNUI(1, &pBuffer->mBuffer);
+  nuiCheckForGLErrors();
+  mStaticBuffers.erase(it);
+  delete pBuffer;
 }
 
 uint32 nuiGLPainter::GetRectangleTextureSupport() const
@@ -1412,6 +1575,7 @@ nuiGLPainter::TextureInfo::TextureInfo()
 {
   mReload = false;
   mTexture = -1;
+  mBytes = 0;
 }
 
 void nuiGLPainter::CreateTexture(nuiTexture* pTexture)
@@ -1495,6 +1659,7 @@ void nuiGLPainter::UploadTexture(nuiTexture* pTexture)
     
     if (reload)
     {
+      NUI_PROFILE_ZONE("TextureUpload");
       glTexParameteri(target, GL_TEXTURE_MIN_FILTER, pTexture->GetMinFilter());
       nuiCheckForGLErrors();
       glTexParameteri(target, GL_TEXTURE_MAG_FILTER, pTexture->GetMagFilter());
@@ -1635,6 +1800,14 @@ void nuiGLPainter::UploadTexture(nuiTexture* pTexture)
           glTexImage2D(target, 0, internalPixelformat, (int)Width, (int)Height, 0, pixelformat, type, pBuffer);
         }
         nuiCheckForGLErrors();
+
+        if (firstload)
+        {
+          info.mBytes = (int64)Width * (int64)Height * (pImage ? pImage->GetPixelSize() : 4);
+          if (pTexture->GetAutoMipMap())
+            info.mBytes += info.mBytes / 3;
+          NUI_MEMORY_ADD(eMemoryTextures, pTexture, info.mBytes);
+        }
       }
       
       info.mReload = false;
@@ -1737,7 +1910,10 @@ void nuiGLPainter::DestroyTexture(nuiTexture* pTexture)
   //NGL_OUT(_T("nuiGLPainter::DestroyTexture 0x%x : '%ls' / %d\n"), pTexture, pTexture->GetSource().GetChars(), info.mTexture);
   
   mpContext->BeginSession();
+  Flush();
   glDeleteTextures(1, &info.mTexture);
+  if (info.mBytes)
+    NUI_MEMORY_REMOVE(eMemoryTextures, pTexture, info.mBytes);
   mTextures.erase(it);
 }
 
@@ -1752,8 +1928,12 @@ void nuiGLPainter::InvalidateTexture(nuiTexture* pTexture, bool ForceReload)
   info.mReload = true;
   if (!ForceReload && info.mTexture != -1)
   {
+    Flush();
     glDeleteTextures(1, &info.mTexture);
     info.mTexture = -1;
+    if (info.mBytes)
+      NUI_MEMORY_REMOVE(eMemoryTextures, pTexture, info.mBytes);
+    info.mBytes = 0;
   }
 }
 
@@ -1765,6 +1945,7 @@ nuiGLPainter::FramebufferInfo::FramebufferInfo()
   mTexture = 0;
   mDepthbuffer = 0;
   mStencilbuffer = 0;
+  mBytes = 0;
 }
 
 void nuiGLPainter::CreateSurface(nuiSurface* pSurface)
@@ -1781,6 +1962,7 @@ void nuiGLPainter::DestroySurface(nuiSurface* pSurface)
   }
   FramebufferInfo info = it->second;
   
+  Flush();
   NGL_ASSERT(info.mFramebuffer > 0);
   glDeleteFramebuffersNUI(1, &info.mFramebuffer);
   if (info.mRenderbuffer > 0)
@@ -1789,6 +1971,8 @@ void nuiGLPainter::DestroySurface(nuiSurface* pSurface)
     glDeleteRenderbuffersNUI(1, &info.mDepthbuffer);
   if (info.mStencilbuffer > 0)
     glDeleteRenderbuffersNUI(1, &info.mStencilbuffer);
+  if (info.mBytes)
+    NUI_MEMORY_REMOVE(eMemorySurfaces, pSurface, info.mBytes);
   
   mFramebuffers.erase(it);  
 }
@@ -1803,6 +1987,7 @@ void nuiGLPainter::SetSurface(nuiSurface* pSurface)
   if (mpSurface == pSurface)
     return;
   
+  Flush();
   if (pSurface)
     pSurface->Acquire();
   if (mpSurface)
@@ -1858,6 +2043,7 @@ void nuiGLPainter::SetSurface(nuiSurface* pSurface)
                                  GL_DEPTH_COMPONENT16,
                                  width, height);
         nuiCheckForGLErrors();
+        info.mBytes += (int64)width * height * 2;
         
         glBindRenderbufferNUI(GL_RENDERBUFFER_NUI, 0);
         nuiCheckForGLErrors();
@@ -1884,6 +2070,7 @@ void nuiGLPainter::SetSurface(nuiSurface* pSurface)
                                  GL_STENCIL_INDEX,
                                  width, height);
         nuiCheckForGLErrors();
+        info.mBytes += (int64)width * height;
         
         glBindRenderbufferNUI(GL_RENDERBUFFER_NUI, 0);
         nuiCheckForGLErrors();
@@ -1945,6 +2132,7 @@ void nuiGLPainter::SetSurface(nuiSurface* pSurface)
         
         glRenderbufferStorageNUI(GL_RENDERBUFFER_NUI, pixelformat, width, height);
         nuiCheckForGLErrors();
+        info.mBytes += (int64)width * height * 4;
         
         glFramebufferRenderbufferNUI(GL_FRAMEBUFFER_NUI,
                                      GL_COLOR_ATTACHMENT0_NUI,
@@ -1958,6 +2146,8 @@ void nuiGLPainter::SetSurface(nuiSurface* pSurface)
       CheckFramebufferStatus();
 #endif
       nuiCheckForGLErrors();
+      if (info.mBytes)
+        NUI_MEMORY_ADD(eMemorySurfaces, pSurface, info.mBytes);
       mFramebuffers[pSurface] = info;
     }
     else
@@ -8,6 +8,7 @@
 #include "nui.h"
 #include "nuiMetaPainter.h"
 #include "nuiDrawContext.h"
+#include "nuiMemoryTracker.h"
 
 // nuiMetaPainter:
 nuiMetaPainter::nuiMetaPainter(const nuiRect& rRect, nglContext* pContext) 
@@ -21,6 +22,8 @@ nuiMetaPainter::nuiMetaPainter(const nuiRect& rRect, nglContext* pContext)
   mNbOperations = 0;
   mDrawChildrenImmediat = false;
   mLastSize = -1;
+  mArrayBytes = 0;
+  mMemoryBytes = 0;
   
 #ifdef _DEBUG_
   mpDebugObjectRef = NULL;
@@ -30,6 +33,21 @@ nuiMetaPainter::nuiMetaPainter(const nuiRect& rRect, nglContext* pContext)
 nuiMetaPainter::~nuiMetaPainter()
 {
   Reset(NULL);
+  if (mMemoryBytes)
+    NUI_MEMORY_REMOVE(eMemoryRenderCaches, this, mMemoryBytes);
+}
+
+void nuiMetaPainter::UpdateMemoryStats()
+{
+  int64 bytes = mOperations.capacity() + mRenderStates.capacity() * sizeof(nuiRenderState) + mRenderArrays.capacity() * sizeof(nuiRenderArray*) + mArrayBytes;
+  if (bytes == mMemoryBytes)
+    return;
+
+  if (!mMemoryBytes)
+    NUI_MEMORY_ADD(eMemoryRenderCaches, this, bytes);
+  else
+    NUI_MEMORY_RESIZE(eMemoryRenderCaches, this, mMemoryBytes, bytes);
+  mMemoryBytes = bytes;
 }
 
 void nuiMetaPainter::StoreOpCode(OpCode code)
@@ -47,6 +65,7 @@ void nuiMetaPainter::StoreInt(int32 Val)
   uint pos = mOperations.size();
   mOperations.resize(pos + sizeof(Val));
   *(int32*)&(mOperations[pos]) = Val;
+  UpdateMemoryStats();
 }
 
 void nuiMetaPainter::StoreFloat(float Val)
@@ -58,6 +77,7 @@ void nuiMetaPainter::StoreFloat(float Val)
   uint pos = mOperations.size();
   mOperations.resize(pos + sizeof(Val));
   *(float*)&(mOperations[pos]) = Val;
+  UpdateMemoryStats();
 }
 
 void nuiMetaPainter::StoreFloat(double Val)
@@ -69,6 +89,7 @@ void nuiMetaPainter::StoreFloat(double Val)
   uint pos = mOperations.size();
   mOperations.resize(pos + sizeof(Val));
   *(double*)&(mOperations[pos]) = Val;
+  UpdateMemoryStats();
 }
 
 void nuiMetaPainter::StorePointer(void* pVal)
@@ -80,6 +101,7 @@ void nuiMetaPainter::StorePointer(void* pVal)
   uint pos = mOperations.size();
   mOperations.resize(pos + sizeof(void*));
   *(void**)&(mOperations[pos]) = pVal;
+  UpdateMemoryStats();
 }
 
 void nuiMetaPainter::StoreBuffer(const void* pBuffer, uint ElementSize, uint ElementCount)
@@ -91,6 +113,7 @@ void nuiMetaPainter::StoreBuffer(const void* pBuffer, uint ElementSize, uint Ele
   uint pos = mOperations.size();
   mOperations.resize(pos + size);
   memcpy(&mOperations[pos], pBuffer, size);
+  UpdateMemoryStats();
 }
 
 nuiMetaPainter::OpCode nuiMetaPainter::FetchOpCode() const
@@ -211,6 +234,8 @@ void nuiMetaPainter::DrawArray(nuiRenderArray* pRenderArray)
   //StorePointer(pRenderArray);
   StoreInt(mRenderArrays.size());
   mRenderArrays.push_back(pRenderArray);
+  mArrayBytes += pRenderArray->GetVertices().capacity() * sizeof(nuiRenderArray::Vertex);
+  UpdateMemoryStats();
 
   mNbDrawArray++;
   mRenderOperations++;
@@ -413,6 +438,8 @@ void nuiMetaPainter::Reset(nuiPainter const * pFrom)
   for (uint32 i = 0; i < mRenderArrays.size(); i++)
     mRenderArrays[i]->Release();
   mRenderArrays.clear();
+  mArrayBytes = 0;
+  UpdateMemoryStats();
   
   mpClippingStack = std::stack<nuiClipper>();
   mMatrixStack = std::stack<nglMatrixf>();
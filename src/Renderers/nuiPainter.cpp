@@ -151,11 +151,9 @@ void nuiPainter::PopClipping()
 
 void nuiPainter::Clip(const nuiRect& rRect)
 {
-  nuiVector p1(rRect.mLeft, rRect.mTop, 0.0f),p2(rRect.mRight, rRect.mBottom, 0.0f);
-  nuiMatrix m(GetMatrix());
-  p1 = m * p1;
-  p2 = m * p2;
-  nuiRect l(p1[0], p1[1], p2[0], p2[1], false);
+  nuiRect l(rRect);
+  l.Transform(GetMatrix());
+  l.Set(l.mLeft, l.mTop, l.mRight, l.mBottom, false);
   /*bool res = (unused)*/ mClip.Intersect(mClip,l);
 }
 
@@ -184,13 +182,10 @@ bool nuiPainter::GetClipRect(nuiRect& rRect, bool LocalRect) const
   if (LocalRect)
   {
     // Transform the rect with the inverse of the current matrix
-    nglMatrixf m(GetMatrix());
+    nuiMatrix m(GetMatrix());
     m.InvertHomogenous();
-    nglVectorf v1(rRect.Left(), rRect.Top(), 0, 1);
-    nglVectorf v2(rRect.Right(), rRect.Bottom(), 0, 1);
-    v1 = m * v1;
-    v2 = m * v2;
-    rRect.Set(v1[0], v1[1], v2[0], v2[1], false);
+    rRect.Transform(m);
+    rRect.Set(rRect.mLeft, rRect.mTop, rRect.mRight, rRect.mBottom, false);
   }
   return mClip.mEnabled;
 }
@@ -201,6 +196,9 @@ void nuiPainter::ResetStats()
   mRenderOperations = 0;
   mVertices = 0;
   mBatches = 0;
+  mDrawCalls = 0;
+  mUploads = 0;
+  mUploadedBytes = 0;
 }
 
 uint32 nuiPainter::GetRenderOperations() const
@@ -218,6 +216,21 @@ uint32 nuiPainter::GetBatches() const
   return mBatches;
 }
 
+uint32 nuiPainter::GetDrawCalls() const
+{
+  return mDrawCalls;
+}
+
+uint32 nuiPainter::GetUploads() const
+{
+  return mUploads;
+}
+
+uint32 nuiPainter::GetUploadedBytes() const
+{
+  return mUploadedBytes;
+}
+
 uint32 nuiPainter::GetClipStackSize() const
 {
   return mpClippingStack.size();
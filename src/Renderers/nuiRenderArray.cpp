@@ -162,6 +162,73 @@ void nuiRenderArray::FillBuffer(GLubyte* pBuffer) const
   memcpy(pBuffer, &mVertices[0], bytes);
 }
 
+void nuiRenderArray::Transform(const nuiMatrix& rMatrix)
+{
+  if (mVertices.empty())
+    return;
+  TransformVertices(rMatrix, &mVertices[0], &mVertices[0], mVertices.size());
+}
+
+void nuiRenderArray::TransformVertices(const nuiMatrix& rMatrix, const Vertex* pIn, Vertex* pOut, size_t Count)
+{
+#if (defined NGL_MATRIX_SSE) && (defined NUI_USE_FLOATS)
+  // Same computation as nglMatrix<float>::operator*(const nglVector<float>&) with W = 1. The colors and the texture
+  // coordinates that follow the position must not be overwritten, so X and Y are stored together and Z on its own.
+  const __m128 c0 = _mm_loadu_ps(rMatrix.Array);
+  const __m128 c1 = _mm_loadu_ps(rMatrix.Array + 4);
+  const __m128 c2 = _mm_loadu_ps(rMatrix.Array + 8);
+  const __m128 c3 = _mm_loadu_ps(rMatrix.Array + 12);
+  size_t i = 0;
+
+  if (rMatrix.Elt.M13 == 0 && rMatrix.Elt.M23 == 0 && rMatrix.Elt.M31 == 0 && rMatrix.Elt.M32 == 0 && rMatrix.Elt.M33 == 1 && rMatrix.Elt.M34 == 0)
+  {
+    // 2D transformation (the usual case for widgets): Z is left as is. Two vertices are 48 bytes, loaded in three
+    // registers as (X0 Y0 Z0 RGBA0) (TX0 TY0 X1 Y1) (Z1 RGBA1 TX1 TY1), and transformed at once.
+    const __m128 x = _mm_movelh_ps(c0, c0); // M11 M21 M11 M21
+    const __m128 y = _mm_movelh_ps(c1, c1); // M12 M22 M12 M22
+    const __m128 t = _mm_movelh_ps(c3, c3); // M14 M24 M14 M24
+    for (; i + 1 < Count; i += 2)
+    {
+      const float* pSource = &pIn[i].mX;
+      float* pDest = &pOut[i].mX;
+      const __m128 v0 = _mm_loadu_ps(pSource);
+      const __m128 v1 = _mm_loadu_ps(pSource + 4);
+      const __m128 v2 = _mm_loadu_ps(pSource + 8);
+      const __m128 position = _mm_shuffle_ps(v0, v1, NGL_SHUFFLE(0, 1, 2, 3));
+      __m128 r = _mm_mul_ps(NGL_SWIZZLE(position, 0, 0, 2, 2), x);
+      r = _mm_add_ps(r, _mm_mul_ps(NGL_SWIZZLE(position, 1, 1, 3, 3), y));
+      r = _mm_add_ps(r, t);
+      _mm_storeu_ps(pDest, _mm_shuffle_ps(r, v0, NGL_SHUFFLE(0, 1, 2, 3)));
+      _mm_storeu_ps(pDest + 4, _mm_shuffle_ps(v1, r, NGL_SHUFFLE(0, 1, 2, 3)));
+      _mm_storeu_ps(pDest + 8, v2);
+    }
+  }
+
+  for (; i < Count; i++)
+  {
+    Vertex& rVertex(pOut[i]);
+    rVertex = pIn[i];
+    __m128 r = _mm_mul_ps(c0, _mm_load1_ps(&rVertex.mX));
+    r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_load1_ps(&rVertex.mY)));
+    r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_load1_ps(&rVertex.mZ)));
+    r = _mm_add_ps(r, c3);
+    _mm_storel_pi((__m64*)&rVertex.mX, r);
+    _mm_store_ss(&rVertex.mZ, _mm_movehl_ps(r, r));
+  }
+#else
+  for (size_t i = 0; i < Count; i++)
+  {
+    Vertex& rVertex(pOut[i]);
+    rVertex = pIn[i];
+    nuiVector v(rVertex.mX, rVertex.mY, rVertex.mZ);
+    v = rMatrix * v;
+    rVertex.mX = v[0];
+    rVertex.mY = v[1];
+    rVertex.mZ = v[2];
+  }
+#endif
+}
+
 void nuiRenderArray::SetVertex(float x, float y, float z)
 {
   mCurrentVertex.mX = x;
@@ -257,6 +324,16 @@ void nuiRenderArray::SetShape(bool set)
   mShape = set;
 }
 
+bool nuiRenderArray::IsStatic() const
+{
+  return mStatic;
+}
+
+void nuiRenderArray::SetStatic(bool set)
+{
+  mStatic = set;
+}
+
 //////////////
 // Indexed accessors:
 void nuiRenderArray::SetVertex(uint32 index, float x, float y, float z)
@@ -400,6 +477,16 @@ void nuiRenderArray::GetBounds(float *pBounds) const
   pBounds[5] = mMaxZ;
 }
 
+void nuiRenderArray::SetBounds(const float *pBounds)
+{
+  mMinX = pBounds[0];
+  mMinY = pBounds[1];
+  mMinZ = pBounds[2];
+  mMaxX = pBounds[3];
+  mMaxY = pBounds[4];
+  mMaxZ = pBounds[5];
+}
+
 void nuiRenderArray::UpdateBounds(float x, float y, float z)
 {
   if (mVertices.empty())
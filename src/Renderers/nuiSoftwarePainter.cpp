@@ -109,7 +109,7 @@ Shark result:
 
 
 nuiSoftwarePainter::nuiSoftwarePainter(const nuiRect& rRect, nglContext* pContext)
-: nuiPainter(rRect, pContext)
+: nuiPainter(rRect, pContext), mpVertices(NULL)
 {
   mWidth = ToNearest(rRect.GetWidth());
   mHeight = ToNearest(rRect.GetHeight());
@@ -162,6 +162,26 @@ void nuiSoftwarePainter::DrawArray(nuiRenderArray* pArray)
     pArray->Release();
     return;
   }
+
+  const std::vector<nuiRenderArray::Vertex>& rVertices(pArray->GetVertices());
+  if (rVertices.empty())
+  {
+    pArray->Release();
+    return;
+  }
+
+  // Transform all the vertices in one go instead of once per primitive that uses them:
+  const nuiMatrix& rMatrix(mMatrixStack.top());
+  if (rMatrix.IsIdentity())
+  {
+    mpVertices = &rVertices[0];
+  }
+  else
+  {
+    mTransformedVertices.resize(rVertices.size());
+    nuiRenderArray::TransformVertices(rMatrix, &rVertices[0], &mTransformedVertices[0], rVertices.size());
+    mpVertices = &mTransformedVertices[0];
+  }
   
   switch (pArray->GetMode())
   {
@@ -361,17 +381,9 @@ void nuiSoftwarePainter::DrawLine(const nuiRenderArray* pArray, int p1, int p2)
   const float xbias = 0;
   const float ybias = 0;
 
-  float x1 = rVertices[p1].mX, y1 = rVertices[p1].mY;
-  float x2 = rVertices[p2].mX, y2 = rVertices[p2].mY;
-
-  nuiVector vec1(x1,y1, 0.0f);
-  nuiVector vec2(x2,y2, 0.0f);
-
-  vec1 = mMatrixStack.top() * vec1;
-  vec2 = mMatrixStack.top() * vec2;
-
-  x1 = vec1[0] + xbias; y1 = vec1[1] + ybias;
-  x2 = vec2[0] + xbias; y2 = vec2[1] + ybias;
+  // DrawArray transformed the positions:
+  float x1 = mpVertices[p1].mX + xbias, y1 = mpVertices[p1].mY + ybias;
+  float x2 = mpVertices[p2].mX + xbias, y2 = mpVertices[p2].mY + ybias;
 
   // Vertices Colors:
   nuiColor c1, c2;
@@ -547,21 +559,10 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
   // Coordinates:
   const std::vector<nuiRenderArray::Vertex>& rVertices(pArray->GetVertices());
 
-  float x1 = rVertices[p1].mX, y1 = rVertices[p1].mY;
-  float x2 = rVertices[p2].mX, y2 = rVertices[p2].mY;
-  float x3 = rVertices[p3].mX, y3 = rVertices[p3].mY;
-
-  nuiVector vec1(x1,y1, 0.0f);
-  nuiVector vec2(x2,y2, 0.0f);
-  nuiVector vec3(x3,y3, 0.0f);
-
-  vec1 = mMatrixStack.top() * vec1;
-  vec2 = mMatrixStack.top() * vec2;
-  vec3 = mMatrixStack.top() * vec3;
-
-  x1 = vec1[0]; y1 = vec1[1];
-  x2 = vec2[0]; y2 = vec2[1];
-  x3 = vec3[0]; y3 = vec3[1];
+  // DrawArray transformed the positions:
+  float x1 = mpVertices[p1].mX, y1 = mpVertices[p1].mY;
+  float x2 = mpVertices[p2].mX, y2 = mpVertices[p2].mY;
+  float x3 = mpVertices[p3].mX, y3 = mpVertices[p3].mY;
 
   // Vertice Colors:
   nuiColor c1, c2, c3;
@@ -776,25 +777,11 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
 //  if (!mState.mAntialiasing && !mState.mTexturing)
 //    bias = 0.5f;
 
-  float x1 = rVertices[p1].mX, y1 = rVertices[p1].mY;
-  float x2 = rVertices[p2].mX, y2 = rVertices[p2].mY;
-  float x3 = rVertices[p3].mX, y3 = rVertices[p3].mY;
-  float x4 = rVertices[p4].mX, y4 = rVertices[p4].mY;
-
-  nuiVector vec1(x1,y1, 0.0f);
-  nuiVector vec2(x2,y2, 0.0f);
-  nuiVector vec3(x3,y3, 0.0f);
-  nuiVector vec4(x4,y4, 0.0f);
-
-  vec1 = mMatrixStack.top() * vec1;
-  vec2 = mMatrixStack.top() * vec2;
-  vec3 = mMatrixStack.top() * vec3;
-  vec4 = mMatrixStack.top() * vec4;
-
-  x1 = vec1[0] + bias; y1 = vec1[1] + bias;
-  x2 = vec2[0] + bias; y2 = vec2[1] + bias;
-  x3 = vec3[0] + bias; y3 = vec3[1] + bias;
-  x4 = vec4[0] + bias; y4 = vec4[1] + bias;
+  // DrawArray transformed the positions:
+  float x1 = mpVertices[p1].mX + bias, y1 = mpVertices[p1].mY + bias;
+  float x2 = mpVertices[p2].mX + bias, y2 = mpVertices[p2].mY + bias;
+  float x3 = mpVertices[p3].mX + bias, y3 = mpVertices[p3].mY + bias;
+  float x4 = mpVertices[p4].mX + bias, y4 = mpVertices[p4].mY + bias;
 
   // Vertice Colors:
   nuiColor c1, c2, c3, c4;
@@ -194,11 +194,48 @@ nuiTexture* nuiTexture::CreateTextureProxy(const nglString& rName, const nglStri
 class AtlasElem
 {
 public:
+  AtlasElem()
+  : mpImage(NULL), mSourceHash(0), mOriginalWidth(0), mOriginalHeight(0)
+  {
+  }
+
   nglPath mPath;
   nglImage* mpImage;
+  uint64 mSourceHash;
+  int32 mOriginalWidth;
+  int32 mOriginalHeight;
 };
 
-static void GetAllImages(std::vector<AtlasElem>& rElements, const nglPath& rPath, int32 MaxTextureSize, int32 ForceAtlasSize, bool AutoTrim)
+static uint64 AtlasHash(uint64 Hash, const void* pData, size_t Size)
+{
+  // FNV-1a
+  const uint8* pBytes = (const uint8*)pData;
+  for (size_t i = 0; i < Size; i++)
+  {
+    Hash ^= pBytes[i];
+    Hash *= 0x100000001b3ULL;
+  }
+  return Hash;
+}
+
+static const uint64 AtlasHashSeed = 0xcbf29ce484222325ULL;
+
+static uint64 AtlasSourceHash(const nglPath& rPath)
+{
+  nglPathInfo info;
+  rPath.GetInfo(info);
+  std::string name(rPath.GetPathName().GetStdString());
+  uint64 size = info.Size;
+  double lastmod = info.LastMod;
+
+  uint64 hash = AtlasHashSeed;
+  hash = AtlasHash(hash, name.c_str(), name.size());
+  hash = AtlasHash(hash, &size, sizeof(size));
+  hash = AtlasHash(hash, &lastmod, sizeof(lastmod));
+  return hash;
+}
+
+static void GetAllImages(std::vector<AtlasElem>& rElements, const nglPath& rPath)
 {
   std::set<nglPath> childrenset;
   
@@ -245,90 +282,315 @@ static void GetAllImages(std::vector<AtlasElem>& rElements, const nglPath& rPath
       else
       {
         // Descend the path:
-        GetAllImages(rElements, *it, MaxTextureSize, ForceAtlasSize, AutoTrim);
+        GetAllImages(rElements, *it);
       }
 
       ++it;
     }
   }
 
-  // Now try to open the images:
+  // The images are decoded later, only remember where they are and how they looked like:
   std::set<nglPath>::iterator it = childrenset.begin();
   std::set<nglPath>::iterator end = childrenset.end();
   while (it != end)
   {
-    nglPath p(*it);
+    AtlasElem elem;
+    elem.mPath = *it;
+    elem.mSourceHash = AtlasSourceHash(*it);
+    rElements.push_back(elem);
 
+    ++it;
+  }
+}
+
+// Decodes (and optionally trims) the atlas images on as many threads as there are CPUs.
+class AtlasImageLoader
+{
+public:
+  AtlasImageLoader(std::vector<AtlasElem>& rElements, int32 MaxTextureSize, bool AutoTrim)
+  : mrElements(rElements), mMaxTextureSize(MaxTextureSize), mAutoTrim(AutoTrim), mNext(0)
+  {
+  }
+
+  void Load()
+  {
+    uint32 count = MIN(nglCPUInfo::GetCount(), (uint32)mrElements.size());
+    if (count <= 1)
+    {
+      Run();
+      return;
+    }
+
+    std::vector<nglThreadDelegate*> threads;
+    for (uint32 i = 0; i < count; i++)
+    {
+      nglThreadDelegate* pThread = new nglThreadDelegate(nuiMakeDelegate(this, &AtlasImageLoader::Run), _T("Atlas image loader"));
+      pThread->Start();
+      threads.push_back(pThread);
+    }
+
+    for (uint32 i = 0; i < count; i++)
+    {
+      threads[i]->Join();
+      delete threads[i];
+    }
+  }
+
+private:
+  void Run()
+  {
+    for (;;)
+    {
+      uint32 index;
+      {
+        nglCriticalSectionGuard guard(mCS);
+        if (mNext >= mrElements.size())
+          return;
+        index = mNext++;
+      }
+
+      LoadImage(mrElements[index]);
+    }
+  }
+
+  void LoadImage(AtlasElem& rElem)
+  {
     nglImageInfo info;
-    bool res = nglImage::GetImageInfo(info, p);
-    
-    // Try to load the image
-    if (res && info.mWidth <= MaxTextureSize && info.mHeight <= MaxTextureSize)
+    bool res = nglImage::GetImageInfo(info, rElem.mPath);
+    if (!res || info.mWidth > mMaxTextureSize || info.mHeight > mMaxTextureSize)
+      return;
+
+    nglImage* pImage = new nglImage(rElem.mPath);
+    rElem.mOriginalWidth = pImage->GetWidth();
+    rElem.mOriginalHeight = pImage->GetHeight();
+
+    if (mAutoTrim)
     {
-      nglImage* pImage = new nglImage(p);
-      
-      if (AutoTrim)
+      nglImagePixelFormat format = pImage->GetPixelFormat();
+
+      if (format == eImagePixelRGBA ||
+          format == eImagePixelAlpha ||
+          format == eImagePixelLumA)
       {
-        nglImagePixelFormat format = pImage->GetPixelFormat();
-        
-        if (format == eImagePixelRGBA ||
-            format == eImagePixelAlpha ||
-            format == eImagePixelLumA)
-        {
-          int32 x, y;
-          nglImage* pTrimmed = pImage->Trim(x, y);
-          
-          if (1)
-          {
-            int32 ow, oh, nw, nh;
-            ow = pImage->GetWidth();
-            oh = pImage->GetHeight();
-            nw = pTrimmed->GetWidth();
-            nh = pTrimmed->GetHeight();
-            float gain = (float)(ow*oh - nw*nh) / (float)(ow*oh);
-            NGL_OUT(_T("Trim %ls\n\t\t%d x %d -> %d x %d (%d pixels -> %2.2fpcf gained)\n"), p.GetChars(), ow, oh, nw, nh, ow*oh - nw*nh, 100.0 * gain);
-          }
-          
-          delete pImage;
-          pImage = pTrimmed;
-        }
+        int32 x, y;
+        nglImage* pTrimmed = pImage->Trim(x, y);
+        delete pImage;
+        pImage = pTrimmed;
       }
-      
-      AtlasElem elem;
-      elem.mPath = p;
-      elem.mpImage = pImage;
-      rElements.push_back(elem);
     }
 
-    ++it;
+    rElem.mpImage = pImage;
   }
+
+  std::vector<AtlasElem>& mrElements;
+  int32 mMaxTextureSize;
+  bool mAutoTrim;
+  nglCriticalSection mCS;
+  uint32 mNext;
+};
+
+// Baked atlas cache layout (stream native endianness):
+//   uint32 magic, uint32 version, uint64 parameters hash, uint32 source count
+//   per source: uint32 path length, UTF-8 path, uint64 source hash, uint32 used, int32 x, y, w, h, uint32 rotated
+//   uint32 width, uint32 height, width * height * 4 bytes of RGBA pixels
+#define NUI_ATLAS_CACHE_MAGIC 0x4e554941 // 'NUIA'
+#define NUI_ATLAS_CACHE_VERSION 1
+
+class AtlasCacheEntry
+{
+public:
+  bool mUsed;
+  int32 mX, mY, mW, mH;
+  bool mRotated;
+};
+
+static uint64 AtlasParamsHash(int32 MaxTextureSize, int32 ForceAtlasSize, bool AutoTrim, nuiAtlasPacking Packing)
+{
+  int32 params[] = { MaxTextureSize, ForceAtlasSize, AutoTrim ? 1 : 0, (int32)Packing };
+  return AtlasHash(AtlasHashSeed, params, sizeof(params));
+}
+
+static bool LoadAtlasCache(const nglPath& rCachePath, const nglPath& rPath, uint64 ParamsHash, const std::vector<AtlasElem>& rElements)
+{
+  std::vector<uint8> buffer;
+  {
+    nglIFile file(rCachePath);
+    if (file.GetState() != eStreamReady)
+      return false;
+    int64 size = file.Available();
+    if (size <= 0)
+      return false;
+    buffer.resize(size);
+    if (file.Read(&buffer[0], size, 1) != size)
+      return false;
+  }
+
+  nglIMemory mem(&buffer[0], buffer.size());
+
+  uint32 magic = 0, version = 0, count = 0;
+  uint64 params = 0;
+  mem.ReadUInt32(&magic);
+  mem.ReadUInt32(&version);
+  mem.ReadUInt64(&params);
+  mem.ReadUInt32(&count);
+  if (magic != NUI_ATLAS_CACHE_MAGIC || version != NUI_ATLAS_CACHE_VERSION || params != ParamsHash || count != rElements.size())
+    return false;
+
+  std::vector<AtlasCacheEntry> entries(count);
+  for (uint32 i = 0; i < count; i++)
+  {
+    uint32 len = 0;
+    mem.ReadUInt32(&len);
+    if (len > mem.Available())
+      return false;
+    mem.SetPos(len, eStreamForward); // The source hash already covers the path
+
+    uint64 hash = 0;
+    uint32 used = 0, rotated = 0;
+    AtlasCacheEntry& rEntry(entries[i]);
+    mem.ReadUInt64(&hash);
+    mem.ReadUInt32(&used);
+    mem.ReadInt32(&rEntry.mX);
+    mem.ReadInt32(&rEntry.mY);
+    mem.ReadInt32(&rEntry.mW);
+    mem.ReadInt32(&rEntry.mH);
+    if (mem.ReadUInt32(&rotated) != 1)
+      return false;
+    rEntry.mUsed = used != 0;
+    rEntry.mRotated = rotated != 0;
+
+    if (hash != rElements[i].mSourceHash)
+      return false; // This source was modified, the cache is stale
+  }
+
+  uint32 width = 0, height = 0;
+  mem.ReadUInt32(&width);
+  mem.ReadUInt32(&height);
+  if (!width || !height || mem.Available() < (int64)width * height * 4)
+    return false;
+
+  nglImageInfo info(width, height, 32);
+  info.AllocateBuffer();
+  mem.Read(info.mpBuffer, width * height * 4, 1);
+  nuiTexture* pAtlas = nuiTexture::GetTexture(info);
+  pAtlas->SetSource(rPath.GetPathName());
+
+  for (uint32 i = 0; i < count; i++)
+  {
+    const AtlasCacheEntry& rEntry(entries[i]);
+    if (rEntry.mUsed)
+      nuiTexture::CreateTextureProxy(rElements[i].mPath.GetPathName(), rPath.GetPathName(), nuiRect(rEntry.mX, rEntry.mY, rEntry.mW, rEntry.mH), rEntry.mRotated);
+  }
+
+  return true;
+}
+
+static bool SaveAtlasCache(const nglPath& rCachePath, uint64 ParamsHash, const std::vector<AtlasElem>& rElements, const std::vector<AtlasCacheEntry>& rEntries, const nglImage* pAtlas)
+{
+  nglOFile file(rCachePath, eOFileCreate);
+  if (file.GetState() != eStreamReady)
+    return false;
+
+  uint32 magic = NUI_ATLAS_CACHE_MAGIC;
+  uint32 version = NUI_ATLAS_CACHE_VERSION;
+  uint32 count = rElements.size();
+  file.WriteUInt32(&magic);
+  file.WriteUInt32(&version);
+  file.WriteUInt64(&ParamsHash);
+  file.WriteUInt32(&count);
+
+  for (uint32 i = 0; i < count; i++)
+  {
+    const AtlasCacheEntry& rEntry(rEntries[i]);
+    std::string name(rElements[i].mPath.GetPathName().GetStdString());
+    uint32 len = name.size();
+    uint32 used = rEntry.mUsed ? 1 : 0;
+    uint32 rotated = rEntry.mRotated ? 1 : 0;
+    file.WriteUInt32(&len);
+    file.Write(name.c_str(), len, 1);
+    file.WriteUInt64(&rElements[i].mSourceHash);
+    file.WriteUInt32(&used);
+    file.WriteInt32(&rEntry.mX);
+    file.WriteInt32(&rEntry.mY);
+    file.WriteInt32(&rEntry.mW);
+    file.WriteInt32(&rEntry.mH);
+    file.WriteUInt32(&rotated);
+  }
+
+  uint32 width = pAtlas->GetWidth();
+  uint32 height = pAtlas->GetHeight();
+  file.WriteUInt32(&width);
+  file.WriteUInt32(&height);
+  return file.Write(pAtlas->GetBuffer(), width * height * 4, 1) == width * height * 4;
 }
 
-bool nuiTexture::CreateAtlasFromPath(const nglPath& rPath, int32 MaxTextureSize, int32 ForceAtlasSize, bool AutoTrim)
+// Biggest atlas the MaxRects packer builds when no size is forced, before NUI_SCALE_FACTOR. The atlas is created before any GL
+// context so GL_MAX_TEXTURE_SIZE can't be queried: this is the smallest limit of the targeted GPUs.
+#define NUI_ATLAS_MAX_SIZE 2048
+
+bool nuiTexture::CreateAtlasFromPath(const nglPath& rPath, int32 MaxTextureSize, int32 ForceAtlasSize, bool AutoTrim, nuiAtlasPacking Packing, const nglPath& rCachePath)
 {
   //NGL_OUT(_T("nuiTexture::CreateAtlasFromPath(rPath = '%ls', MaxTextureSize = %d, ForceAtlasSize = %d, AutoTrim = '%ls')\n"), rPath.GetChars(), MaxTextureSize, ForceAtlasSize, YESNO(AutoTrim));
   MaxTextureSize *= NUI_SCALE_FACTOR;
   ForceAtlasSize *= NUI_SCALE_FACTOR;
+  // Only the legacy packer needs a placeholder texture to force the atlas width, the MaxRects one is given the size directly:
   int32 offset = 0;
-  if (ForceAtlasSize)
+  if (ForceAtlasSize && Packing == eAtlasPackingLegacy)
     offset = 1;
 
   App->GetLog().SetLevel(_T("StopWatch"), 100);
   nuiStopWatch watch(_T("Create atlas"));
   std::vector<AtlasElem> images;
   
-  GetAllImages(images, rPath, MaxTextureSize, ForceAtlasSize, AutoTrim);
+  GetAllImages(images, rPath);
+  watch.AddIntermediate(_T("Scanned images"));
+
+  bool UseCache = !rCachePath.GetPathName().IsEmpty();
+  uint64 ParamsHash = AtlasParamsHash(MaxTextureSize, ForceAtlasSize, AutoTrim, Packing);
+  if (UseCache && LoadAtlasCache(rCachePath, rPath, ParamsHash, images))
+  {
+    watch.AddIntermediate(_T("Loaded baked atlas"));
+    return true;
+  }
+
+  AtlasImageLoader loader(images, MaxTextureSize, AutoTrim);
+  loader.Load();
   watch.AddIntermediate(_T("Got all images"));
-  
-  TEXTURE_PACKER::TexturePacker* packer = TEXTURE_PACKER::createTexturePacker();
-  packer->setTextureCount(images.size() + offset);
 
-  if (ForceAtlasSize)
-    packer->addTexture(ForceAtlasSize - 2, 0); // -2 to account for the border padding
-  
+  // Only keep the images that could be loaded:
+  std::vector<uint32> loaded;
   for (uint32 i = 0; i < images.size(); i++)
   {
     const AtlasElem& rElem(images[i]);
+    if (!rElem.mpImage)
+      continue;
+
+    loaded.push_back(i);
+    if (AutoTrim)
+    {
+      int32 ow, oh, nw, nh;
+      ow = rElem.mOriginalWidth;
+      oh = rElem.mOriginalHeight;
+      nw = rElem.mpImage->GetWidth();
+      nh = rElem.mpImage->GetHeight();
+      float gain = (float)(ow*oh - nw*nh) / (float)(ow*oh);
+      NGL_OUT(_T("Trim %ls\n\t\t%d x %d -> %d x %d (%d pixels -> %2.2fpcf gained)\n"), rElem.mPath.GetChars(), ow, oh, nw, nh, ow*oh - nw*nh, 100.0 * gain);
+    }
+  }
+
+  TEXTURE_PACKER::TexturePacker* packer = NULL;
+  if (Packing == eAtlasPackingLegacy)
+    packer = TEXTURE_PACKER::createTexturePacker();
+  else
+    packer = TEXTURE_PACKER::createMaxRectsTexturePacker(Packing == eAtlasPackingMaxRectsRotated, ForceAtlasSize ? ForceAtlasSize : NUI_ATLAS_MAX_SIZE * NUI_SCALE_FACTOR);
+  packer->setTextureCount(loaded.size() + offset);
+
+  if (offset)
+    packer->addTexture(ForceAtlasSize - 2, 0); // -2 to account for the border padding
+  
+  for (uint32 i = 0; i < loaded.size(); i++)
+  {
+    const AtlasElem& rElem(images[loaded[i]]);
     packer->addTexture(rElem.mpImage->GetWidth(), rElem.mpImage->GetHeight());
   }
   
@@ -336,6 +598,19 @@ bool nuiTexture::CreateAtlasFromPath(const nglPath& rPath, int32 MaxTextureSize,
   int unused_area = packer->packTextures(width, height, true, true);
   watch.AddIntermediate(_T("Packed textures"));
 
+  if (unused_area < 0)
+  {
+    // The images will be loaded one by one instead:
+    NGL_OUT(_T("The images of '%ls' don't fit in one atlas, no atlas created\n"), rPath.GetChars());
+    TEXTURE_PACKER::releaseTexturePacker(packer);
+    for (uint32 i = 0; i < loaded.size(); i++)
+    {
+      delete images[loaded[i]].mpImage;
+      images[loaded[i]].mpImage = NULL;
+    }
+    return false;
+  }
+
   // Create image buffer:
   nglImageInfo info(width, height, 32);
   info.AllocateBuffer();
@@ -344,10 +619,18 @@ bool nuiTexture::CreateAtlasFromPath(const nglPath& rPath, int32 MaxTextureSize,
   nuiTexture* pAtlas = nuiTexture::GetTexture(info);
   pAtlas->SetSource(rPath.GetPathName());
   
+  std::vector<AtlasCacheEntry> entries(images.size());
+  for (uint32 i = 0; i < entries.size(); i++)
+  {
+    entries[i].mUsed = false;
+    entries[i].mX = entries[i].mY = entries[i].mW = entries[i].mH = 0;
+    entries[i].mRotated = false;
+  }
+
   // Finally, to retrieve the results, for each texture 0-(n-1) call 'getTextureLocation'.
-  for (uint32 i = 0; i < images.size(); i++)
+  for (uint32 i = 0; i < loaded.size(); i++)
   {
-    AtlasElem& rElem(images[i]);
+    AtlasElem& rElem(images[loaded[i]]);
     int x, y, w, h;
     bool rotated = packer->getTextureLocation(i + offset, x, y, w, h);
     if (rotated)
@@ -362,10 +645,22 @@ bool nuiTexture::CreateAtlasFromPath(const nglPath& rPath, int32 MaxTextureSize,
     nglCopyImage(pAtlas->GetImage()->GetBuffer(), x, y, width, height, info.mBitDepth, rElem.mpImage->GetBuffer(), rElem.mpImage->GetWidth(), rElem.mpImage->GetHeight(), rElem.mpImage->GetBitDepth(), false, false);
     nuiTexture* pTex = nuiTexture::CreateTextureProxy(rElem.mPath.GetPathName(), rPath.GetPathName(), nuiRect(x, y, w, h), rotated);
     delete rElem.mpImage;
+    rElem.mpImage = NULL;
+
+    AtlasCacheEntry& rEntry(entries[loaded[i]]);
+    rEntry.mUsed = true;
+    rEntry.mX = x;
+    rEntry.mY = y;
+    rEntry.mW = w;
+    rEntry.mH = h;
+    rEntry.mRotated = rotated;
   }
 
   TEXTURE_PACKER::releaseTexturePacker(packer);
 
+  if (UseCache && !SaveAtlasCache(rCachePath, ParamsHash, images, entries, pAtlas->GetImage()))
+    NGL_OUT(_T("Unable to bake atlas cache to '%ls'\n"), rCachePath.GetChars());
+
   watch.AddIntermediate(_T("Done"));
   return true;
 }
@@ -835,11 +835,329 @@ void nuiSprite::GetSpritesAtPoint(float x, float y, std::vector<nuiSprite*>& rSp
 }
 
 
+/////////////////////////////////////////////
+// class nuiSpriteBatch
+nuiSpriteBatch::nuiSpriteBatch()
+: mCount(0), mBatches(0)
+{
+}
+
+nuiSpriteBatch::~nuiSpriteBatch()
+{
+}
+
+uint32 nuiSpriteBatch::GetSpriteCount() const
+{
+  return mCount;
+}
+
+uint32 nuiSpriteBatch::GetBatchCount() const
+{
+  return mBatches;
+}
+
+void nuiSpriteBatch::Resize(uint32 count)
+{
+  mpSprites.resize(count);
+  mpAnimations.resize(count);
+  mpFrames.resize(count);
+  mFrame.resize(count);
+  mFrameCount.resize(count);
+  mFrameSpeed.resize(count);
+  mEnded.reserve(count);
+
+  mMatrix.resize(count);
+  mX.resize(count);
+  mY.resize(count);
+  mZ.resize(count);
+  mAngle.resize(count);
+  mPivotX.resize(count);
+  mPivotY.resize(count);
+  mScaleX.resize(count);
+  mScaleY.resize(count);
+
+  mXX.resize(count);
+  mXY.resize(count);
+  mYX.resize(count);
+  mYY.resize(count);
+  mTX.resize(count);
+  mTY.resize(count);
+
+  mColor.resize(count);
+  mBlendFunc.resize(count);
+
+  mOrder.resize(count);
+}
+
+void nuiSpriteBatch::Gather(const std::vector<nuiSprite*>& rSprites)
+{
+  mCount = 0;
+  mEnded.clear();
+  for (size_t i = 0; i < rSprites.size(); i++)
+  {
+    // Pre-order walk of the tree, like nuiSprite::Draw:
+    mpStack.push_back(rSprites[i]);
+    while (!mpStack.empty())
+    {
+      nuiSprite* pSprite = mpStack.back();
+      mpStack.pop_back();
+      Gather(pSprite);
+      for (size_t c = pSprite->mpChildren.size(); c > 0; c--)
+        mpStack.push_back(pSprite->mpChildren[c - 1]);
+    }
+  }
+}
+
+void nuiSpriteBatch::Gather(nuiSprite* pSprite)
+{
+  pSprite->CheckValid();
+  uint32 i = mCount++;
+  if (i >= mpSprites.size())
+    Resize(MAX(256, i * 2));
+
+  mpSprites[i] = pSprite;
+
+  const nuiSpriteAnimation* pAnim = pSprite->mpSpriteDef->GetAnimation(pSprite->mCurrentAnimation);
+  NGL_ASSERT(pAnim->GetFPS() != 0);
+  mpAnimations[i] = pAnim;
+  mFrame[i] = pSprite->mCurrentFrame;
+  mFrameCount[i] = (float)pAnim->GetFrameCount();
+  mFrameSpeed[i] = pSprite->mSpeed * pAnim->GetFPS();
+
+  const std::vector<nuiMatrixNode*>* pNodes = pSprite->mpMatrixNodes;
+  if (pNodes && pNodes->size() == 3
+      && pNodes->at(0) == pSprite->mpPosition && pNodes->at(1) == pSprite->mpPivot && pNodes->at(2) == pSprite->mpScale
+      && pSprite->mpPivot->GetAxis()[0] == 0 && pSprite->mpPivot->GetAxis()[1] == 0 && pSprite->mpPivot->GetAxis()[2] > 0)
+  {
+    // Default nodes: keep the parameters, the transformations are computed in UpdateTransforms()
+    const nglVectorf& rPosition(pSprite->mpPosition->GetVector());
+    const nglVectorf& rPivot(pSprite->mpPivot->GetPivot());
+    const nglVectorf& rScale(pSprite->mpScale->GetScaleVector());
+    mMatrix[i] = 0;
+    mX[i] = rPosition[0];
+    mY[i] = rPosition[1];
+    mZ[i] = rPosition[2] + rPivot[2];
+    mAngle[i] = pSprite->mpPivot->GetAngle();
+    mPivotX[i] = rPivot[0];
+    mPivotY[i] = rPivot[1];
+    mScaleX[i] = rScale[0];
+    mScaleY[i] = rScale[1];
+  }
+  else
+  {
+    nuiMatrix m;
+    if (pNodes)
+      pSprite->GetMatrix(m);
+    mMatrix[i] = 1;
+    mXX[i] = m.Elt.M11;
+    mXY[i] = m.Elt.M12;
+    mTX[i] = m.Elt.M14;
+    mYX[i] = m.Elt.M21;
+    mYY[i] = m.Elt.M22;
+    mTY[i] = m.Elt.M24;
+    mZ[i] = m.Elt.M34;
+  }
+
+  const nuiColor& rColor(pSprite->mColor);
+  uint8* pColor = (uint8*)&mColor[i];
+  pColor[0] = (uint8)ToBelow(rColor.Red() * 255.0f);
+  pColor[1] = (uint8)ToBelow(rColor.Green() * 255.0f);
+  pColor[2] = (uint8)ToBelow(rColor.Blue() * 255.0f);
+  pColor[3] = (uint8)ToBelow(rColor.Alpha() * 255.0f);
+
+  mBlendFunc[i] = pSprite->mBlendFunc;
+}
+
+void nuiSpriteBatch::Animate(float passedtime)
+{
+  const uint32 count = mCount;
+  for (uint32 i = 0; i < count; i++)
+  {
+    float frame = mFrame[i] + passedtime * mFrameSpeed[i];
+    const float framecount = mFrameCount[i];
+    if (frame >= framecount)
+    {
+      frame -= framecount;
+      if (frame >= framecount)
+        frame = fmodf(frame, framecount);
+      mEnded.push_back(i);
+    }
+    mFrame[i] = frame;
+  }
+
+  for (uint32 i = 0; i < count; i++)
+    mpSprites[i]->mCurrentFrame = mFrame[i];
+}
+
+void nuiSpriteBatch::FireAnimEnd()
+{
+  // The handlers may change or release any sprite:
+  for (size_t i = 0; i < mEnded.size(); i++)
+    mpSprites[mEnded[i]]->Acquire();
+  for (size_t i = 0; i < mEnded.size(); i++)
+    mpSprites[mEnded[i]]->AnimEnd();
+  for (size_t i = 0; i < mEnded.size(); i++)
+    mpSprites[mEnded[i]]->Release();
+  mEnded.clear();
+}
+
+void nuiSpriteBatch::UpdateTransforms()
+{
+  // Position * Pivot (rotation around Z, then pivot translation) * Scale:
+  const uint32 count = mCount;
+  for (uint32 i = 0; i < count; i++)
+  {
+    if (mMatrix[i])
+      continue;
+
+    float c = 1;
+    float s = 0;
+    if (mAngle[i] != 0)
+    {
+      const float a = (float)DEG2RAD(mAngle[i]);
+      c = cosf(a);
+      s = sinf(a);
+    }
+
+    mXX[i] = c * mScaleX[i];
+    mXY[i] = -s * mScaleY[i];
+    mYX[i] = s * mScaleX[i];
+    mYY[i] = c * mScaleY[i];
+    mTX[i] = mX[i] + c * mPivotX[i] - s * mPivotY[i];
+    mTY[i] = mY[i] + s * mPivotX[i] + c * mPivotY[i];
+  }
+}
+
+static inline void nuiSpriteBatch_SetVertex(nuiRenderArray::Vertex& rVertex, float x, float y, float z, uint32 color, float tx, float ty)
+{
+  rVertex.mX = x;
+  rVertex.mY = y;
+  rVertex.mZ = z;
+  memcpy(&rVertex.mR, &color, 4);
+  rVertex.mTX = tx;
+  rVertex.mTY = ty;
+}
+
+void nuiSpriteBatch::Draw(nuiDrawContext* pContext)
+{
+  mBatches = 0;
+  UpdateTransforms();
+
+  // Cut the sprites in runs of consecutive sprites that share their page and blend function. Runs are never merged
+  // across other sprites, so the draw order is the one of nuiSprite::Draw().
+  const uint32 count = mCount;
+  uint32 drawn = 0;
+  mRuns.clear();
+  for (uint32 i = 0; i < count; i++)
+  {
+    const nuiSpriteFrame* pFrame = mpAnimations[i]->GetFrame(ToBelow(mFrame[i]));
+    mpFrames[i] = pFrame;
+    nuiTexture* pTexture = pFrame->GetTexture();
+    if (!pTexture)
+      continue;
+
+    while (pTexture->GetProxyTexture())
+      pTexture = pTexture->GetProxyTexture();
+    if (mRuns.empty() || mRuns.back().mpTexture != pTexture || mRuns.back().mBlendFunc != mBlendFunc[i])
+    {
+      Run run;
+      run.mpTexture = pTexture;
+      run.mBlendFunc = mBlendFunc[i];
+      run.mCount = 0;
+      run.mOffset = drawn;
+      mRuns.push_back(run);
+    }
+    mRuns.back().mCount++;
+    mOrder[drawn++] = i;
+  }
+
+  bool texturing = pContext->GetState().mTexturing;
+  if (!texturing)
+    pContext->EnableTexturing(true);
+  pContext->EnableBlending(true);
+
+  for (size_t r = 0; r < mRuns.size(); r++)
+  {
+    const Run& rRun(mRuns[r]);
+
+    nuiRenderArray* pArray = new nuiRenderArray(GL_TRIANGLES);
+    pArray->EnableArray(nuiRenderArray::eVertex, true);
+    pArray->EnableArray(nuiRenderArray::eTexCoord, true);
+    pArray->EnableArray(nuiRenderArray::eColor, true);
+    pArray->Resize(rRun.mCount * 6);
+    nuiRenderArray::Vertex* pVertex = &pArray->GetVertices()[0];
+
+    float bounds[6];
+    bounds[0] = bounds[1] = bounds[2] = std::numeric_limits<float>::max();
+    bounds[3] = bounds[4] = bounds[5] = -std::numeric_limits<float>::max();
+
+    const uint32 end = rRun.mOffset + rRun.mCount;
+    for (uint32 o = rRun.mOffset; o < end; o++)
+    {
+      const uint32 i = mOrder[o];
+      const nuiSpriteFrame* pFrame = mpFrames[i];
+      const nuiRect& rRect(pFrame->GetRect());
+
+      // Same quad as nuiSprite::Draw: the frame rect moved by the handle
+      const float l = rRect.Left() - pFrame->GetHandleX();
+      const float t = rRect.Top() - pFrame->GetHandleY();
+      const float r = rRect.Right() - pFrame->GetHandleX();
+      const float b = rRect.Bottom() - pFrame->GetHandleY();
+
+      const float xx = mXX[i], xy = mXY[i], yx = mYX[i], yy = mYY[i];
+      const float x0 = xx * l + xy * t + mTX[i], y0 = yx * l + yy * t + mTY[i];
+      const float x1 = xx * r + xy * t + mTX[i], y1 = yx * r + yy * t + mTY[i];
+      const float x2 = xx * r + xy * b + mTX[i], y2 = yx * r + yy * b + mTY[i];
+      const float x3 = xx * l + xy * b + mTX[i], y3 = yx * l + yy * b + mTY[i];
+      const float z = mZ[i];
+
+      // Proxies may be rotated in their page, convert the four corners:
+      nuiTexture* pTexture = pFrame->GetTexture();
+      nuiSize tx0 = rRect.Left(), ty0 = rRect.Top();
+      nuiSize tx1 = rRect.Right(), ty1 = rRect.Top();
+      nuiSize tx2 = rRect.Right(), ty2 = rRect.Bottom();
+      nuiSize tx3 = rRect.Left(), ty3 = rRect.Bottom();
+      pTexture->ImageToTextureCoord(tx0, ty0);
+      pTexture->ImageToTextureCoord(tx1, ty1);
+      pTexture->ImageToTextureCoord(tx2, ty2);
+      pTexture->ImageToTextureCoord(tx3, ty3);
+
+      // The two triangles of the strip drawn by nuiDrawContext::DrawImageQuad:
+      const uint32 color = mColor[i];
+      nuiSpriteBatch_SetVertex(pVertex[0], x0, y0, z, color, tx0, ty0);
+      nuiSpriteBatch_SetVertex(pVertex[1], x1, y1, z, color, tx1, ty1);
+      nuiSpriteBatch_SetVertex(pVertex[2], x3, y3, z, color, tx3, ty3);
+      nuiSpriteBatch_SetVertex(pVertex[3], x3, y3, z, color, tx3, ty3);
+      nuiSpriteBatch_SetVertex(pVertex[4], x1, y1, z, color, tx1, ty1);
+      nuiSpriteBatch_SetVertex(pVertex[5], x2, y2, z, color, tx2, ty2);
+      pVertex += 6;
+
+      bounds[0] = MIN(bounds[0], MIN(MIN(x0, x1), MIN(x2, x3)));
+      bounds[1] = MIN(bounds[1], MIN(MIN(y0, y1), MIN(y2, y3)));
+      bounds[2] = MIN(bounds[2], z);
+      bounds[3] = MAX(bounds[3], MAX(MAX(x0, x1), MAX(x2, x3)));
+      bounds[4] = MAX(bounds[4], MAX(MAX(y0, y1), MAX(y2, y3)));
+      bounds[5] = MAX(bounds[5], z);
+    }
+    pArray->SetBounds(bounds);
+
+    pContext->SetTexture(rRun.mpTexture);
+    pContext->SetBlendFunc(rRun.mBlendFunc);
+    pContext->DrawArray(pArray);
+    mBatches++;
+  }
+
+  if (!texturing)
+    pContext->EnableTexturing(false);
+}
+
+
 /////////////////////////////////////////////
 // class nuiSpriteView : public nuiSimpleContainer
 nuiSpriteView::nuiSpriteView()
 {
   mLastTime = 0;
+  mBatching = true;
   if (SetObjectClass(_T("nuiSpriteView")))
   {
     // Init attributes
@@ -888,6 +1206,15 @@ bool nuiSpriteView::Draw(nuiDrawContext* pContext)
     t = now - mLastTime;
   mLastTime = now;
 
+  if (mBatching)
+  {
+    mBatch.Gather(mpSprites);
+    mBatch.Animate((float)t);
+    mBatch.Draw(pContext);
+    mBatch.FireAnimEnd();
+    return true;
+  }
+
   for (size_t i = 0; i < mpSprites.size(); i++)
   {
     mpSprites[i]->Animate((float)t);
@@ -898,6 +1225,21 @@ bool nuiSpriteView::Draw(nuiDrawContext* pContext)
   return true;
 }
 
+void nuiSpriteView::EnableBatching(bool Set)
+{
+  mBatching = Set;
+}
+
+bool nuiSpriteView::IsBatchingEnabled() const
+{
+  return mBatching;
+}
+
+const nuiSpriteBatch& nuiSpriteView::GetBatch() const
+{
+  return mBatch;
+}
+
 void nuiSpriteView::GetSpritesAtPoint(float x, float y, std::vector<nuiSprite*>& rSprites)
 {
   uint32 s = mpSprites.size();
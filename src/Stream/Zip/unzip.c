@@ -2161,4 +2161,28 @@ extern int ZEXPORT unzSetCurrentFile (unzFile file, voidp _file)
   return Z_OK;
 }
 
+/*
+ Create a new handle on an already opened zipfile, reading through its own filestream.
+ The central directory information is copied from the original handle so nothing is read from the file.
+ Each handle can then decompress a file independently of (and concurrently with) the others.
+ */
+extern unzFile ZEXPORT unzDuplicate (unzFile file, zlib_filefunc_def* pzlib_filefunc32_def, voidpf filestream)
+{
+  unz64_s* s;
+  unz64_s* d;
+  if (file==NULL || pzlib_filefunc32_def==NULL)
+    return NULL;
+  s=(unz64_s*)file;
 
+  d=(unz64_s*)ALLOC(sizeof(unz64_s));
+  if (d==NULL)
+    return NULL;
+
+  *d=*s;
+  fill_zlib_filefunc64_32_def_from_filefunc32(&d->z_filefunc,pzlib_filefunc32_def);
+  d->is64bitOpenFunction = 0;
+  d->filestream = filestream;
+  d->pfile_in_zip_read = NULL;
+  d->encrypted = 0;
+  return (unzFile)d;
+}
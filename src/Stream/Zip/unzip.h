@@ -440,6 +440,14 @@ extern voidp ZEXPORT unzGetCurrentFile (unzFile file);
 extern int ZEXPORT unzSetCurrentFile (unzFile file,
                                       voidp _file);
 
+/*
+ Create a new handle on an opened zipfile that reads through \a filestream, without parsing the central directory again.
+ Close it with unzClose (which closes \a filestream).
+ */
+extern unzFile ZEXPORT unzDuplicate (unzFile file,
+                                     zlib_filefunc_def* pzlib_filefunc_def,
+                                     voidpf filestream);
+
   
 #ifdef __cplusplus
 }
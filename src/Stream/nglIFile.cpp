@@ -7,6 +7,7 @@
 
 #include "nui.h"
 
+#define NGL_IFILE_BUFFER_SIZE (256 * 1024)
 
 /*
 * Life cycle
@@ -16,6 +17,18 @@ nglIFile::nglIFile (nglFile* pFile, bool OwnFile)
 {
   mpFile = pFile;
   mOwnFile = OwnFile;
+
+  mMode = eIFileDirect;
+  mAccess = eFileAccessNormal;
+  mSize = 0;
+  mpMap = NULL;
+  mMapSize = 0;
+  mMapPos = 0;
+  mpBuffer = NULL;
+  mBufferSize = 0;
+  mBufferFill = 0;
+  mBufferPos = 0;
+  mBufferStart = 0;
 }
 
 nglIFile::nglIFile (const nglPath& rPath, bool OpenNow)
@@ -27,10 +40,49 @@ nglIFile::nglIFile (const nglPath& rPath, bool OpenNow)
     mpFile = NULL;
   }
   mOwnFile = true;
+
+  mMode = eIFileDirect;
+  mAccess = eFileAccessNormal;
+  mSize = 0;
+  mpMap = NULL;
+  mMapSize = 0;
+  mMapPos = 0;
+  mpBuffer = NULL;
+  mBufferSize = 0;
+  mBufferFill = 0;
+  mBufferPos = 0;
+  mBufferStart = 0;
+}
+
+nglIFile::nglIFile (const nglPath& rPath, nglIFileMode Mode, nglFileAccess Access)
+{
+  mpFile = new nglFile (rPath, eFileRead, true);
+  if ((!mpFile) || !mpFile->IsOpen())
+  {
+    delete mpFile;
+    mpFile = NULL;
+  }
+  mOwnFile = true;
+
+  mMode = eIFileDirect;
+  mAccess = Access;
+  mSize = 0;
+  mpMap = NULL;
+  mMapSize = 0;
+  mMapPos = 0;
+  mpBuffer = NULL;
+  mBufferSize = 0;
+  mBufferFill = 0;
+  mBufferPos = 0;
+  mBufferStart = 0;
+
+  if (mpFile)
+    SetMode(Mode, Access);
 }
 
 nglIFile::~nglIFile()
 {
+  Release();
   if (mOwnFile && (mpFile)) delete mpFile;
 }
 
@@ -42,6 +94,102 @@ nglFile* nglIFile::GetFile() const
   return mpFile; 
 }
 
+/*
+* Read strategy
+*/
+
+bool nglIFile::SetMode(nglIFileMode Mode, nglFileAccess Access)
+{
+  mAccess = Access;
+  if (!mpFile || !mpFile->IsOpen())
+  {
+    // Applied by Open()
+    mMode = Mode;
+    return true;
+  }
+
+  nglFileOffset pos = GetPos();
+  Release();
+
+  mMode = eIFileDirect;
+  mSize = mpFile->GetSize();
+
+  if (Mode == eIFileMapped)
+  {
+    mpMap = (const char*)mpFile->Map(mMapSize, Access);
+    if (mpMap)
+    {
+      mMode = eIFileMapped;
+      mMapPos = MIN(pos, mMapSize);
+      return true;
+    }
+    // Can't map this one (empty or special file, no mmap on this platform...), use a buffer instead:
+  }
+
+  mpFile->SetAccessHint(Access);
+
+  if (Mode == eIFileDirect)
+    return true;
+
+  // Don't waste a big buffer on small files
+  mBufferSize = NGL_IFILE_BUFFER_SIZE;
+  if (mSize > 0 && mSize < mBufferSize)
+    mBufferSize = mSize;
+  mpBuffer = (char*)malloc((size_t)mBufferSize);
+  if (!mpBuffer)
+  {
+    mBufferSize = 0;
+    return false;
+  }
+  mBufferStart = pos;
+  mBufferFill = 0;
+  mBufferPos = 0;
+  mMode = eIFileBuffered;
+
+  return (Mode == eIFileBuffered);
+}
+
+nglIFileMode nglIFile::GetMode() const
+{
+  return mMode;
+}
+
+const char* nglIFile::GetMappedData() const
+{
+  return mpMap;
+}
+
+nglFileSize nglIFile::GetMappedSize() const
+{
+  return mMapSize;
+}
+
+void nglIFile::Release()
+{
+  if (!mpMap && !mpBuffer)
+    return;
+
+  nglFileOffset pos = GetPos();
+
+  if (mpMap)
+    nglFile::Unmap(mpMap, mMapSize);
+  mpMap = NULL;
+  mMapSize = 0;
+  mMapPos = 0;
+
+  if (mpBuffer)
+    free(mpBuffer);
+  mpBuffer = NULL;
+  mBufferSize = 0;
+  mBufferFill = 0;
+  mBufferPos = 0;
+  mBufferStart = 0;
+
+  // Keep the file in sync with the stream
+  if (mpFile && mpFile->IsOpen())
+    mpFile->SetPos(pos);
+}
+
 /*
 * Status/error
 */
@@ -49,7 +197,11 @@ nglFile* nglIFile::GetFile() const
 bool nglIFile::Open()
 {
   if (!mpFile) return eStreamNone;
-  return mpFile->Open();
+  if (!mpFile->Open())
+    return false;
+  if (mMode != eIFileDirect)
+    SetMode(mMode, mAccess);
+  return true;
 }
 
 
@@ -64,6 +216,7 @@ bool nglIFile::IsOpen() const
 
 void nglIFile::Close()
 {
+  Release();
   if (mpFile) mpFile->Close();
 }
 
@@ -71,6 +224,19 @@ nglStreamState nglIFile::GetState() const
 {
   if (!mpFile) return eStreamNone;
   if (!mpFile->IsOpen()) return eStreamError;
+
+  switch (mMode)
+  {
+  case eIFileMapped:
+    return (mMapPos >= mMapSize) ? eStreamEnd : eStreamReady;
+  case eIFileBuffered:
+    if (mBufferPos < mBufferFill) return eStreamReady;
+    if (mSize > 0) return (GetPos() >= mSize) ? eStreamEnd : eStreamReady;
+    break;
+  case eIFileDirect:
+    break;
+  }
+
   if (mpFile->IsEOF()) return eStreamEnd;
   return eStreamReady;
 }
@@ -81,12 +247,55 @@ nglStreamState nglIFile::GetState() const
 
 nglFileOffset nglIFile::GetPos() const
 {
+  switch (mMode)
+  {
+  case eIFileMapped:
+    return mMapPos;
+  case eIFileBuffered:
+    return mBufferStart + mBufferPos;
+  case eIFileDirect:
+    break;
+  }
   return (mpFile) ? mpFile->GetPos() : 0;
 }
 
 nglFileOffset nglIFile::SetPos (nglFileOffset Where, nglStreamWhence Whence)
 {
   if (mpFile == NULL) return false;
+
+  if (mMode != eIFileDirect)
+  {
+    nglFileOffset pos = GetPos();
+    nglFileSize size = (mMode == eIFileMapped) ? mMapSize : mSize;
+    switch (Whence)
+    {
+    case eStreamFromStart: pos = Where; break;
+    case eStreamForward  : pos += Where; break;
+    case eStreamRewind   : pos -= Where; break;
+    case eStreamFromEnd  : pos = size - Where; break;
+    }
+    if (pos < 0) pos = 0;
+
+    if (mMode == eIFileMapped)
+    {
+      mMapPos = MIN(pos, mMapSize);
+      return mMapPos;
+    }
+
+    if (pos >= mBufferStart && pos <= mBufferStart + mBufferFill)
+    {
+      // Still in the buffer, no need to bother the file
+      mBufferPos = pos - mBufferStart;
+    }
+    else
+    {
+      mBufferStart = mpFile->SetPos(pos, eFileFromStart);
+      mBufferFill = 0;
+      mBufferPos = 0;
+    }
+    return GetPos();
+  }
+
   switch (Whence)
   {
   case eStreamFromStart: return mpFile->SetPos (Where, eFileFromStart);
@@ -102,6 +311,18 @@ nglFileSize nglIFile::Available (uint WordSize)
   if (WordSize == 0) return 0;
 
   nglFileSize size,pos;
+  switch (mMode)
+  {
+  case eIFileMapped:
+    return (mMapSize - mMapPos) / WordSize;
+  case eIFileBuffered:
+    pos = GetPos();
+    size = (mSize > 0) ? mSize : mpFile->GetSize();
+    return (size > pos) ? (size - pos) / WordSize : (mBufferFill - mBufferPos) / WordSize;
+  case eIFileDirect:
+    break;
+  }
+
   pos = mpFile->GetPos();
   size = mpFile->GetSize();
   return (size-pos) / WordSize;
@@ -112,12 +333,123 @@ nglFileSize nglIFile::Available (uint WordSize)
 * Input method
 */
 
+int64 nglIFile::ReadBuffered(void* pData, int64 Size)
+{
+  char* pDst = (char*)pData;
+  int64 done = 0;
+
+  while (Size > 0)
+  {
+    int64 avail = mBufferFill - mBufferPos;
+    if (avail > 0)
+    {
+      int64 count = MIN(avail, Size);
+      memcpy(pDst, mpBuffer + mBufferPos, (size_t)count);
+      mBufferPos += count;
+      pDst += count;
+      done += count;
+      Size -= count;
+      continue;
+    }
+
+    // The buffer is empty, refill it (or bypass it for big reads)
+    mBufferStart += mBufferFill;
+    mBufferFill = 0;
+    mBufferPos = 0;
+
+    int64 res;
+    if (Size >= mBufferSize)
+    {
+      res = mpFile->Read(pDst, Size, 1);
+      if (res <= 0)
+        break;
+      mBufferStart += res;
+      pDst += res;
+      done += res;
+      Size -= res;
+    }
+    else
+    {
+      res = mpFile->Read(mpBuffer, mBufferSize, 1);
+      if (res <= 0)
+        break;
+      mBufferFill = res;
+    }
+  }
+
+  return done;
+}
+
 int64 nglIFile::Read (void* pData, int64 WordCount, uint WordSize)
 {
   if (!mpFile) return 0;
 
-  mpFile->SetEndian(mEndian); // Truely inelegant hack, but somehow still efficient
-  return mpFile->Read (pData, WordCount, WordSize);
+  if (mMode == eIFileDirect)
+  {
+    mpFile->SetEndian(mEndian); // Truely inelegant hack, but somehow still efficient
+    return mpFile->Read (pData, WordCount, WordSize);
+  }
+
+  if ((pData == NULL) || (WordCount <= 0) || (WordSize == 0)) return 0;
+
+  if (mMode == eIFileMapped)
+  {
+    int64 left = (mMapSize - mMapPos) / WordSize;
+    if (WordCount > left) WordCount = left;
+    int64 byte_cnt = WordCount * WordSize;
+    memcpy (pData, mpMap + mMapPos, (size_t)byte_cnt);
+    mMapPos += byte_cnt;
+  }
+  else
+  {
+    int64 done = ReadBuffered(pData, WordCount * WordSize);
+    int64 rest = done % WordSize;
+    if (rest != 0) SetPos (rest, eStreamRewind); // Don't eat incomplete words
+    WordCount = done / WordSize;
+  }
+
+  if (mEndian != eEndianNative)
+  {
+    switch (WordSize)
+    {
+    case 2: bswap_16_s ((uint16*)pData, (size_t)WordCount); break;
+    case 4: bswap_32_s ((uint32*)pData, (size_t)WordCount); break;
+    case 8: bswap_64_s ((uint64*)pData, (size_t)WordCount); break;
+    }
+  }
+  return WordCount;
+}
+
+int64 nglIFile::PeekBuffer (const void*& rpData)
+{
+  rpData = NULL;
+  if (!mpFile) return 0;
+
+  switch (mMode)
+  {
+  case eIFileMapped:
+    if (mMapPos >= mMapSize) return 0;
+    rpData = mpMap + mMapPos;
+    return mMapSize - mMapPos;
+
+  case eIFileBuffered:
+    if (mBufferPos >= mBufferFill)
+    {
+      mBufferStart += mBufferFill;
+      mBufferFill = 0;
+      mBufferPos = 0;
+      int64 res = mpFile->Read(mpBuffer, mBufferSize, 1);
+      if (res <= 0)
+        return 0;
+      mBufferFill = res;
+    }
+    rpData = mpBuffer + mBufferPos;
+    return mBufferFill - mBufferPos;
+
+  case eIFileDirect:
+    break;
+  }
+  return 0;
 }
 
 void nglIFile::SetEndian(nglEndian Endian)
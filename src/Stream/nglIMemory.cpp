@@ -89,3 +89,11 @@ int64 nglIMemory::Read (void* pData, int64 WordCount, uint WordSize)
   }
   return WordCount;
 }
+
+int64 nglIMemory::PeekBuffer (const void*& rpData)
+{
+  rpData = NULL;
+  if ((mpBuffer == NULL) || (mOffset >= mSize)) return 0;
+  rpData = mpBuffer + mOffset;
+  return mSize - mOffset;
+}
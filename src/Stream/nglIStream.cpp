@@ -70,6 +70,10 @@ int64 nglIStream::ReadLine (nglString& rLine, nglTextFormat* pFormat)
   if (pFormat)
     *pFormat = eTextNone;
   
+  const void* pWindow = NULL;
+  if (PeekBuffer(pWindow) > 0)
+    return ReadLineFromBuffer(rLine, pFormat);
+
   std::vector<char> buffer;
   
   nglTextFormat format = eTextNone;
@@ -132,6 +136,107 @@ int64 nglIStream::ReadLine (nglString& rLine, nglTextFormat* pFormat)
 }
 
 
+int64 nglIStream::ReadLineFromBuffer (nglString& rLine, nglTextFormat* pFormat)
+{
+  // Scan whole windows of the stream's own buffer instead of pulling the bytes one at a time.
+  // The line only gets copied when it spans several windows.
+  int64 bytes_total = 0;
+  nglTextFormat format = eTextNone;
+  std::vector<char> buffer;
+  const char* pLine = NULL;
+  int64 line_size = 0;
+
+  const void* pWindow = NULL;
+  int64 size = PeekBuffer(pWindow);
+  while (size > 0)
+  {
+    const char* pStart = (const char*)pWindow;
+    const char* pEnd = pStart + size;
+    const char* pCur = pStart;
+
+    // Only the line endings and '\0' are below 14:
+    while (pCur < pEnd && ((uint8)*pCur > '\r' || (*pCur != '\n' && *pCur != '\r' && *pCur != '\0')))
+      pCur++;
+
+    int64 count = pCur - pStart;
+    if (pCur == pEnd)
+    {
+      // No line ending in this window, keep what we have and get the next one
+      buffer.insert(buffer.end(), pStart, pEnd);
+      SetPos(count, eStreamForward);
+      bytes_total += count;
+      size = PeekBuffer(pWindow);
+      continue;
+    }
+
+    char c = *pCur;
+    if (buffer.empty())
+    {
+      pLine = pStart;
+      line_size = count;
+    }
+    else
+    {
+      buffer.insert(buffer.end(), pStart, pCur);
+    }
+
+    if (c == '\r' && pCur + 1 == pEnd)
+    {
+      // The '\r' ends the window, the '\n' may be in the next one
+      if (pLine)
+      {
+        buffer.assign(pLine, pLine + line_size);
+        pLine = NULL;
+      }
+      SetPos(count + 1, eStreamForward);
+      bytes_total += count + 1;
+      format = eTextMac;
+      size = PeekBuffer(pWindow);
+      if (size > 0 && *(const char*)pWindow == '\n')
+      {
+        SetPos(1, eStreamForward);
+        bytes_total++;
+        format = eTextDOS;
+      }
+      break;
+    }
+
+    int64 eaten = count + 1;
+    if (c == '\0')
+      format = eTextZero;
+    else if (c == '\n')
+      format = eTextUnix;
+    else if (pCur[1] == '\n')
+    {
+      format = eTextDOS;
+      eaten++;
+    }
+    else
+      format = eTextMac;
+
+    if (pLine)
+      rLine.Import(pLine, (int32)line_size, mTextEncoding); // Import before SetPos() invalidates the window
+    SetPos(eaten, eStreamForward);
+    bytes_total += eaten;
+    pLine = NULL;
+    break;
+  }
+
+  if (pFormat)
+    *pFormat = format;
+
+  if (!buffer.empty())
+    rLine.Import(&buffer[0], (int32)buffer.size(), mTextEncoding);
+
+  return bytes_total;
+}
+
+int64 nglIStream::PeekBuffer (const void*& rpData)
+{
+  rpData = NULL;
+  return 0;
+}
+
 // FIXME: optimize ! At least add line-ending weighting
 int64 nglIStream::ReadText(nglString& rLine, nglTextFormat* pFormat)
 {
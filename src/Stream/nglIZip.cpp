@@ -11,21 +11,108 @@
 #include "nglIStream.h"
 #include "nglIZip.h"
 #include "nglZipFS.h"
+#include "zlib.h"
 
+#define NGL_ZIP_WINDOW_SIZE 32768
+#define NGL_ZIP_INPUT_SIZE 16384
 
+
+// nglZipSeekIndex
+nglZipSeekIndex::nglZipSeekIndex(uint32 Span)
+: mSpan(Span)
+{
+}
+
+nglZipSeekIndex::~nglZipSeekIndex()
+{
+  for (uint32 i = 0; i < mCheckpoints.size(); i++)
+    delete mCheckpoints[i];
+}
+
+const nglZipSeekIndex::Checkpoint* nglZipSeekIndex::Find(nglFileOffset Position)
+{
+  nglCriticalSectionGuard guard(mLock);
+  uint32 low = 0;
+  uint32 high = mCheckpoints.size();
+  while (low < high)
+  {
+    uint32 mid = (low + high) / 2;
+    if (mCheckpoints[mid]->mOut <= Position)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low ? mCheckpoints[low - 1] : NULL;
+}
+
+bool nglZipSeekIndex::IsNeeded(nglFileOffset Position)
+{
+  nglCriticalSectionGuard guard(mLock);
+  nglFileOffset last = mCheckpoints.empty() ? 0 : mCheckpoints.back()->mOut;
+  return Position >= last + mSpan;
+}
+
+void nglZipSeekIndex::Add(Checkpoint* pCheckpoint)
+{
+  nglCriticalSectionGuard guard(mLock);
+  nglFileOffset last = mCheckpoints.empty() ? 0 : mCheckpoints.back()->mOut;
+  if (pCheckpoint->mOut < last + mSpan)
+  {
+    delete pCheckpoint;
+    return;
+  }
+  mCheckpoints.push_back(pCheckpoint);
+}
+
+
+// Raw inflate state of a deflated entry. All the output goes through mWindow, so the
+// last 32 KB are at hand when a checkpoint is taken.
+class nglZipInflater
+{
+public:
+  nglZipInflater()
+  : mInputPos(0), mWindowPos(0), mWindowFill(0)
+  {
+    memset(&mStream, 0, sizeof(mStream));
+    mValid = (inflateInit2(&mStream, -MAX_WBITS) == Z_OK);
+  }
+
+  ~nglZipInflater()
+  {
+    if (mValid)
+      inflateEnd(&mStream);
+  }
+
+  z_stream mStream;
+  bool mValid;
+  nglFileOffset mInputPos; ///< Offset in the entry data of the next compressed byte to feed
+  uint32 mWindowPos;       ///< Next write position in mWindow (circular)
+  uint32 mWindowFill;
+  uint8 mInput[NGL_ZIP_INPUT_SIZE];
+  uint8 mWindow[NGL_ZIP_WINDOW_SIZE];
+};
+
+
+// nglIZip
 nglIZip::~nglIZip()
 {
-  mpZip->Close(mpUnzip);
+  delete mpInflater;
 }
 
 nglStreamState nglIZip::GetState() const
 {
-  return mpZip->GetState(mpUnzip);
+  if (mError)
+    return eStreamError;
+
+  if (mPosition >= mSize)
+    return eStreamEnd;
+  
+  return eStreamReady;
 }
 
 nglFileOffset nglIZip::GetPos() const
 {
-  return mpZip->GetPos(mpUnzip);
+  return mPosition;
 }
 
 nglFileOffset nglIZip::SetPos (nglFileOffset Where, nglStreamWhence Whence)
@@ -58,7 +145,7 @@ nglFileOffset nglIZip::SetPos (nglFileOffset Where, nglStreamWhence Whence)
     return 0;
   }
 
-  nglFileOffset NewPos = mpZip->SetPos(mpUnzip, Pos, this);
+  nglFileOffset NewPos = Seek(Pos);
 
   if (NewPos == Pos)
     return Where;
@@ -81,21 +168,251 @@ nglFileSize nglIZip::Available (uint WordSize)
 
 int64 nglIZip::Read (void* pData, int64 WordCount, uint WordSize)
 {
-  return mpZip->Read(mpUnzip, pData, WordCount, WordSize, mEndian);
+  if (WordCount <= 0 || mError || mPosition >= (nglFileOffset)mSize)
+    return 0;
+
+  nglSize size = (nglSize)MIN((nglFileSize)(WordCount * WordSize), (nglFileSize)(mSize - mPosition));
+  nglSize done = 0;
+  if (mpInflater)
+  {
+    done = Inflate((uint8*)pData, size);
+  }
+  else if (mpZip->mpData)
+  {
+    memcpy(pData, mpZip->mpData + mDataOffset + mPosition, size);
+    done = size;
+    mPosition += done;
+  }
+  else
+  {
+    done = mpZip->ReadRaw(mDataOffset + mPosition, pData, size);
+    mPosition += done;
+    if (done < size)
+      mError = true;
+  }
+
+  done /= WordSize;
+
+  if ((done > 0) && (mEndian != eEndianNative))
+  {
+    switch (WordSize)
+    {
+      case 2: bswap_16_s ((uint16*)pData, done); break;
+      case 4: bswap_32_s ((uint32*)pData, done); break;
+      case 8: bswap_64_s ((uint64*)pData, done); break;
+    }
+  }
+
+  return done;
+}
+
+int64 nglIZip::PeekBuffer (const void*& rpData)
+{
+  if (mpInflater || !mpZip->mpData || mError || mPosition >= (nglFileOffset)mSize)
+    return 0;
+
+  rpData = mpZip->mpData + mDataOffset + mPosition;
+  return mSize - mPosition;
 }
 
-nglIZip::nglIZip(nglZipFS* pZip, void* pUnzip, nglSize size, int NumOfFile,int PosInZipDirectory)
+bool nglIZip::IsCompressed() const
 {
-  //printf("new zip %p\n", pUnzip);
-  mpZip = pZip;
-  mpUnzip = pUnzip;
-  mSize = size;
-  mNumOfFile = NumOfFile;
-  mPosInZipDirectory = PosInZipDirectory;
+  return mpInflater != NULL;
 }
 
-void nglIZip::SetRef(void* pUnzip)
+nglFileOffset nglIZip::Seek(nglFileOffset Where)
 {
-  //printf("set zip %p (old: %p)\n", pUnzip, mpUnzip);
-  mpUnzip = pUnzip;
+  if (Where < 0)
+    Where = 0;
+  if (Where > (nglFileOffset)mSize)
+    Where = mSize;
+
+  if (!mpInflater)
+  {
+    // Stored entry: just move the read position
+    mPosition = Where;
+    return mPosition;
+  }
+
+  if (Where == mPosition)
+    return mPosition;
+
+  const nglZipSeekIndex::Checkpoint* pCheckpoint = mpSeekIndex ? mpSeekIndex->Find(Where) : NULL;
+  if (Where < mPosition || mError)
+  {
+    // Go back to the closest checkpoint, or to the start of the entry:
+    if (!Restart(pCheckpoint))
+      return mPosition;
+  }
+  else if (pCheckpoint && pCheckpoint->mOut > mPosition)
+  {
+    // Jump over the data between the current position and the checkpoint:
+    if (!Restart(pCheckpoint))
+      return mPosition;
+  }
+
+  Inflate(NULL, Where - mPosition);
+  return mPosition;
+}
+
+nglSize nglIZip::Inflate(uint8* pData, nglSize Size)
+{
+  z_stream& rStream(mpInflater->mStream);
+  nglSize done = 0;
+
+  while (done < Size && !mError)
+  {
+    if (!rStream.avail_in)
+    {
+      nglFileSize remaining = mCompressedSize - mpInflater->mInputPos;
+      if (!remaining)
+      {
+        // Truncated entry
+        mError = true;
+        break;
+      }
+
+      if (mpZip->mpData)
+      {
+        // Feed the inflater straight from the archive data
+        uInt count = (uInt)MIN(remaining, (nglFileSize)(1 << 30));
+        rStream.next_in = (Bytef*)(mpZip->mpData + mDataOffset + mpInflater->mInputPos);
+        rStream.avail_in = count;
+        mpInflater->mInputPos += count;
+      }
+      else
+      {
+        nglSize count = mpZip->ReadRaw(mDataOffset + mpInflater->mInputPos, mpInflater->mInput, (nglSize)MIN(remaining, (nglFileSize)NGL_ZIP_INPUT_SIZE));
+        if (!count)
+        {
+          mError = true;
+          break;
+        }
+        rStream.next_in = mpInflater->mInput;
+        rStream.avail_in = (uInt)count;
+        mpInflater->mInputPos += count;
+      }
+    }
+
+    uint8* pOut = mpInflater->mWindow + mpInflater->mWindowPos;
+    uInt todo = (uInt)MIN((nglSize)(NGL_ZIP_WINDOW_SIZE - mpInflater->mWindowPos), Size - done);
+    rStream.next_out = pOut;
+    rStream.avail_out = todo;
+
+    // Z_BLOCK stops at the deflate block boundaries, where checkpoints can be taken:
+    int res = inflate(&rStream, Z_BLOCK);
+    if (res != Z_OK && res != Z_STREAM_END && !(res == Z_BUF_ERROR && !rStream.avail_in))
+    {
+      mError = true;
+      break;
+    }
+
+    uInt count = todo - rStream.avail_out;
+    if (pData)
+      memcpy(pData + done, pOut, count);
+    mpInflater->mWindowPos = (mpInflater->mWindowPos + count) & (NGL_ZIP_WINDOW_SIZE - 1);
+    mpInflater->mWindowFill = MIN(mpInflater->mWindowFill + count, NGL_ZIP_WINDOW_SIZE);
+    done += count;
+    mPosition += count;
+
+    if (res == Z_STREAM_END)
+    {
+      if (done < Size)
+        mError = true;
+      break;
+    }
+
+    if (mpSeekIndex && (rStream.data_type & 128) && !(rStream.data_type & 64) && mpSeekIndex->IsNeeded(mPosition))
+      AddCheckpoint();
+  }
+
+  return done;
+}
+
+bool nglIZip::Restart(const nglZipSeekIndex::Checkpoint* pCheckpoint)
+{
+  z_stream& rStream(mpInflater->mStream);
+  mError = !mpInflater->mValid || inflateReset(&rStream) != Z_OK;
+  if (mError)
+    return false;
+
+  rStream.next_in = NULL;
+  rStream.avail_in = 0;
+
+  if (!pCheckpoint)
+  {
+    mpInflater->mInputPos = 0;
+    mpInflater->mWindowPos = 0;
+    mpInflater->mWindowFill = 0;
+    mPosition = 0;
+    return true;
+  }
+
+  mpInflater->mInputPos = pCheckpoint->mIn;
+  if (pCheckpoint->mBits)
+  {
+    // The block starts in the middle of the previous byte:
+    uint8 byte = 0;
+    mError = mpZip->ReadRaw(mDataOffset + pCheckpoint->mIn - 1, &byte, 1) != 1
+          || inflatePrime(&rStream, pCheckpoint->mBits, byte >> (8 - pCheckpoint->mBits)) != Z_OK;
+  }
+
+  uint32 size = pCheckpoint->mWindow.size();
+  if (!mError && size)
+  {
+    mError = inflateSetDictionary(&rStream, &pCheckpoint->mWindow[0], size) != Z_OK;
+    memcpy(mpInflater->mWindow, &pCheckpoint->mWindow[0], size);
+  }
+  if (mError)
+    return false;
+
+  mpInflater->mWindowPos = size & (NGL_ZIP_WINDOW_SIZE - 1);
+  mpInflater->mWindowFill = size;
+  mPosition = pCheckpoint->mOut;
+  return true;
+}
+
+void nglIZip::AddCheckpoint()
+{
+  const z_stream& rStream(mpInflater->mStream);
+  nglZipSeekIndex::Checkpoint* pCheckpoint = new nglZipSeekIndex::Checkpoint;
+  pCheckpoint->mOut = mPosition;
+  pCheckpoint->mIn = mpInflater->mInputPos - rStream.avail_in;
+  pCheckpoint->mBits = rStream.data_type & 7;
+
+  // Unroll the circular window:
+  uint32 fill = mpInflater->mWindowFill;
+  uint32 pos = mpInflater->mWindowPos;
+  pCheckpoint->mWindow.resize(fill);
+  if (fill < NGL_ZIP_WINDOW_SIZE)
+  {
+    if (fill)
+      memcpy(&pCheckpoint->mWindow[0], mpInflater->mWindow, fill);
+  }
+  else
+  {
+    memcpy(&pCheckpoint->mWindow[0], mpInflater->mWindow + pos, NGL_ZIP_WINDOW_SIZE - pos);
+    memcpy(&pCheckpoint->mWindow[NGL_ZIP_WINDOW_SIZE - pos], mpInflater->mWindow, pos);
+  }
+
+  mpSeekIndex->Add(pCheckpoint);
+}
+
+nglIZip::nglIZip(nglZipFS* pZip, nglSize Size, nglFileOffset DataOffset, nglSize CompressedSize, bool Compressed, nglZipSeekIndex* pSeekIndex)
+{
+  mpZip = pZip;
+  mSize = Size;
+  mDataOffset = DataOffset;
+  mCompressedSize = CompressedSize;
+  mPosition = 0;
+  mpInflater = NULL;
+  mpSeekIndex = NULL;
+  mError = false;
+
+  if (Compressed)
+  {
+    mpInflater = new nglZipInflater();
+    mError = !mpInflater->mValid;
+    mpSeekIndex = pSeekIndex;
+  }
 }
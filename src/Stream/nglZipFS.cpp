@@ -10,6 +10,7 @@
 #include "nglZipFS.h"
 #include "nglIOStream.h"
 #include "nglIZip.h"
+#include "nglIFile.h"
 #include "unzip.h"
 #include "zip.h"
 
@@ -159,6 +160,79 @@ int ZCALLBACK zError(voidpf opaque, voidpf stream)
 }
 
 
+// Private view of the archive: each unzip handle reads through its own cursor so the handles never fight
+// over the position of the shared stream.
+class nglZipCursor
+{
+public:
+  nglZipCursor(nglZipFS* pZipFS)
+  : mpZipFS(pZipFS), mPosition(0)
+  {
+  }
+
+  uLong Read(void* pBuffer, uLong Size)
+  {
+    nglSize res = mpZipFS->ReadRaw(mPosition, pBuffer, Size);
+    mPosition += res;
+    return (uLong)res;
+  }
+
+  nglFileSize GetSize() const
+  {
+    return mpZipFS->mDataSize;
+  }
+
+  nglZipFS* mpZipFS;
+  nglFileOffset mPosition;
+};
+
+voidpf ZCALLBACK zCursorOpen(voidpf opaque, const char* filename, int mode)
+{
+  return NULL;
+}
+
+uLong ZCALLBACK zCursorRead(voidpf opaque, voidpf stream, void* buf, uLong size)
+{
+  return ((nglZipCursor*)stream)->Read(buf, size);
+}
+
+long ZCALLBACK zCursorTell(voidpf opaque, voidpf stream)
+{
+  return (long)((nglZipCursor*)stream)->mPosition;
+}
+
+long ZCALLBACK zCursorSeek(voidpf opaque, voidpf stream, uLong offset, int origin)
+{
+  nglZipCursor* pCursor = (nglZipCursor*)stream;
+  switch (origin)
+  {
+  case ZLIB_FILEFUNC_SEEK_CUR:
+    pCursor->mPosition += offset;
+    break;
+  case ZLIB_FILEFUNC_SEEK_SET:
+    pCursor->mPosition = offset;
+    break;
+  case ZLIB_FILEFUNC_SEEK_END:
+    pCursor->mPosition = pCursor->GetSize() + offset;
+    break;
+  default:
+    return -1;
+  }
+  return 0;
+}
+
+int ZCALLBACK zCursorClose(voidpf opaque, voidpf stream)
+{
+  delete (nglZipCursor*)stream;
+  return 0;
+}
+
+int ZCALLBACK zCursorError(voidpf opaque, voidpf stream)
+{
+  return 0;
+}
+
+
 class nglZipPrivate
 {
 public:
@@ -182,7 +256,7 @@ private:
 
 nglZipFS::nglZipFS(const nglString& rVolumeName, nglIStream* pStream, bool Own)
 : nglVolume(rVolumeName, nglString::Empty, nglString::Empty, nglPathVolume::ReadOnly, nglPathVolume::eTypeZip),
-  mRoot(_T(""), 0, 0, 0, false), mpFileFuncDef(NULL)
+  mRoot(_T(""), _T(""), 0, 0, 0, 0, false), mIndexCount(0), mpData(NULL), mDataSize(0), mSeekIndexSpan(1 << 20), mpFileFuncDef(NULL), mpCursorFuncDef(NULL)
 {
   mpStream = pStream;
   mOwnStream = Own;
@@ -197,9 +271,23 @@ nglZipFS::nglZipFS(const nglString& rVolumeName, nglIStream* pStream, bool Own)
 
 nglZipFS::nglZipFS(const nglPath& rPath)
 : nglVolume(nglPath(rPath.GetNodeName()).GetRemovedExtension(), nglString::Empty, nglString::Empty, nglPathVolume::ReadOnly, nglPathVolume::eTypeZip),
-  mRoot(_T(""), 0, 0, 0, false), mpFileFuncDef(NULL)
+  mRoot(_T(""), _T(""), 0, 0, 0, 0, false), mIndexCount(0), mpData(NULL), mDataSize(0), mSeekIndexSpan(1 << 20), mpFileFuncDef(NULL), mpCursorFuncDef(NULL)
 {
-  mpStream = rPath.OpenRead();
+  if (rPath.GetVolumeName().IsEmpty())
+  {
+    // Map local archives: the streams then decompress straight from memory, without locking
+    nglIFile* pFile = new nglIFile(rPath, eIFileMapped, eFileAccessRandom);
+    if (!pFile->IsOpen())
+    {
+      delete pFile;
+      pFile = NULL;
+    }
+    mpStream = pFile;
+  }
+  else
+  {
+    mpStream = rPath.OpenRead();
+  }
   mOwnStream = true;
   SetValid(mpStream != NULL);
 
@@ -218,6 +306,7 @@ nglZipFS::~nglZipFS()
     delete mpStream;
   
   delete mpFileFuncDef;
+  delete mpCursorFuncDef;
 }
 
 bool nglZipFS::Open()
@@ -232,6 +321,16 @@ bool nglZipFS::Open()
   mpFileFuncDef->zclose_file = &::zClose;
   mpFileFuncDef->zerror_file = &::zError;
 
+  mpCursorFuncDef = new zlib_filefunc_def;
+  mpCursorFuncDef->opaque = this;
+  mpCursorFuncDef->zopen_file  = &::zCursorOpen;
+  mpCursorFuncDef->zread_file  = &::zCursorRead;
+  mpCursorFuncDef->zwrite_file = NULL;
+  mpCursorFuncDef->ztell_file  = &::zCursorTell;
+  mpCursorFuncDef->zseek_file  = &::zCursorSeek;
+  mpCursorFuncDef->zclose_file = &::zCursorClose;
+  mpCursorFuncDef->zerror_file = &::zCursorError;
+
 	if (mpStream == NULL || mpPrivate == NULL || !IsValid())
 		return false;
 	
@@ -240,7 +339,34 @@ bool nglZipFS::Open()
   if (mpPrivate->mZip == NULL)
     return false;
 
-  return BuildIndex();
+  if (!BuildIndex())
+    return false;
+
+  // From now on the archive is only read through ReadRaw(). If it lives in memory, read it directly:
+  mpStream->SetPos(0, eStreamFromStart);
+  mDataSize = mpStream->Available();
+  const void* pData = NULL;
+  if (mDataSize > 0 && mpStream->PeekBuffer(pData) == (int64)mDataSize)
+    mpData = (const uint8*)pData;
+
+  return true;
+}
+
+nglSize nglZipFS::ReadRaw(nglFileOffset Position, void* pData, nglSize Size)
+{
+  if (mpData)
+  {
+    if (Position >= mDataSize)
+      return 0;
+    nglSize count = MIN(Size, (nglSize)(mDataSize - Position));
+    memcpy(pData, mpData + Position, count);
+    return count;
+  }
+
+  nglCriticalSectionGuard guard(mStreamLock);
+  mpStream->SetPos(Position, eStreamFromStart);
+  int64 res = mpStream->Read(pData, Size, 1);
+  return (res > 0) ? (nglSize)res : 0;
 }
 
 bool nglZipFS::BuildIndex()
@@ -255,6 +381,9 @@ bool nglZipFS::BuildIndex()
   if (UNZ_OK != unzGoToFirstFile(Zip))
     return false;
 
+  mIndex.clear();
+  mIndexCount = 0;
+
   do 
   {
     unz_file_info file_info;
@@ -267,30 +396,39 @@ bool nglZipFS::BuildIndex()
     if (UNZ_OK != unzGetFilePos(Zip, &file_pos))
       return false;
 
-    uint len = strlen(filename);
-    bool IsDir = (filename[len-1] == '\\') || (filename[len-1] == '/');
-    std::list<nglPath> List;
-
-    nglZipPath::Decompose(filename, List);
-
-    std::list<nglPath>::iterator it;
-    std::list<nglPath>::iterator end = List.end();
+    nglString path(filename);
+    path.Replace(_T('\\'), _T('/'));
+    int32 len = path.GetLength();
+    bool IsDir = len && (path[len - 1] == _T('/'));
+    while (len && path[len - 1] == _T('/'))
+      len--;
 
+    // Walk down the path, creating the missing nodes:
     Node* pPath = &mRoot;
-
-    int i = List.size();
-    for (it = List.begin(); it != end; ++it)
+    int32 start = 0;
+    while (start < len)
     {
-      nglString name = (*it).GetPathName();
-      Node* pChild = pPath->Find(name);
+      int32 end = path.Find(_T('/'), start);
+      if (end < 0 || end > len)
+        end = len;
+      if (end == start)
+      {
+        start++;
+        continue;
+      }
+
+      const nglChar* pChars = path.GetChars();
+      uint32 hash = HashPath(pChars, end);
+      Node* pChild = FindNode(pChars, end, hash);
       if (!pChild)
       {
-        //printf("zipfile: %ls\n", name.GetChars());
-        pChild = new Node(name, file_info.uncompressed_size, file_pos.pos_in_zip_directory, file_pos.num_of_file, i == 1 && !IsDir);
+        //printf("zipfile: %ls\n", path.GetLeft(end).GetChars());
+        pChild = new Node(path.Extract(start, end - start), path.GetLeft(end), hash, file_info.uncompressed_size, file_pos.pos_in_zip_directory, file_pos.num_of_file, end == len && !IsDir);
         pPath->AddChild(pChild);
+        AddToIndex(pChild);
       }
       pPath = pChild;
-      i--;
+      start = end + 1;
     }
   }
   while (UNZ_OK == (res = unzGoToNextFile(Zip)));
@@ -300,6 +438,75 @@ bool nglZipFS::BuildIndex()
   return false;
 }
 
+uint32 nglZipFS::HashPath(const nglChar* pPath, uint32 Length)
+{
+  // FNV-1a
+  uint32 hash = 2166136261U;
+  for (uint32 i = 0; i < Length; i++)
+  {
+    hash ^= (uint32)pPath[i];
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+void nglZipFS::AddToIndex(Node* pNode)
+{
+  // Keep the load factor under 1/2:
+  if ((mIndexCount + 1) * 2 > mIndex.size())
+  {
+    std::vector<Node*> old;
+    old.swap(mIndex);
+    mIndex.resize(MAX(old.size() * 2, 64), NULL);
+    mIndexCount = 0;
+    for (uint32 i = 0; i < old.size(); i++)
+      if (old[i])
+        AddToIndex(old[i]);
+  }
+
+  uint32 mask = mIndex.size() - 1;
+  uint32 i = pNode->mHash & mask;
+  while (mIndex[i])
+    i = (i + 1) & mask;
+  mIndex[i] = pNode;
+  mIndexCount++;
+}
+
+nglZipFS::Node* nglZipFS::FindNode(const nglChar* pPath, uint32 Length, uint32 Hash) const
+{
+  if (mIndex.empty())
+    return NULL;
+
+  uint32 mask = mIndex.size() - 1;
+  for (uint32 i = Hash & mask; mIndex[i]; i = (i + 1) & mask)
+  {
+    const Node* pNode = mIndex[i];
+    if (pNode->mHash == Hash && pNode->mPath.GetLength() == (int32)Length && !memcmp(pNode->mPath.GetChars(), pPath, Length * sizeof(nglChar)))
+      return (Node*)pNode;
+  }
+  return NULL;
+}
+
+nglZipFS::Node* nglZipFS::FindNode(const nglString& rPath) const
+{
+  const nglChar* pPath = rPath.GetChars();
+  int32 len = rPath.GetLength();
+  if (!pPath)
+    return (Node*)&mRoot;
+
+  while (len && *pPath == _T('/'))
+  {
+    pPath++;
+    len--;
+  }
+  while (len && pPath[len - 1] == _T('/'))
+    len--;
+  if (!len || (len == 1 && *pPath == _T('.')))
+    return (Node*)&mRoot;
+
+  return FindNode(pPath, len, HashPath(pPath, len));
+}
+
 
 bool nglZipFS::CanWrite() const
 {
@@ -313,7 +520,7 @@ bool nglZipFS::CanRead() const
 
 bool nglZipFS::GetInfo (const nglZipPath& rPath, nglPathInfo& rInfo) const
 {
-  Node* pChild = mRoot.Find(rPath); 
+  Node* pChild = FindNode(rPath.GetPathName()); 
 
   rInfo.Exists = pChild != NULL;
   rInfo.CanRead = CanRead() && rInfo.Exists;
@@ -327,7 +534,7 @@ bool nglZipFS::GetInfo (const nglZipPath& rPath, nglPathInfo& rInfo) const
 
 int nglZipFS::GetChildren(const nglZipPath& rPath, std::list<nglZipPath>& rList) const
 {
-  Node* pNode = mRoot.Find(rPath);
+  Node* pNode = FindNode(rPath.GetPathName());
   if (!pNode)
     return 0;
 
@@ -349,123 +556,80 @@ int nglZipFS::GetChildren(const nglZipPath& rPath, std::list<nglZipPath>& rList)
 
 nglIZip* nglZipFS::GetStream(const nglZipPath& rPath)
 {
-  Node* pNode = mRoot.Find(rPath);
+  Node* pNode = FindNode(rPath.GetPathName());
   if (!pNode)
     return NULL;
   if (!pNode->mIsLeaf)
     return NULL;
 
-  unz_file_pos file_pos;
-  file_pos.num_of_file = pNode->mNumOfFile;
-  file_pos.pos_in_zip_directory = pNode->mPosInZipDirectory;
-
-  if (unzGoToFilePos(mpPrivate->mZip, &file_pos) != UNZ_OK)
-    return NULL;
-
-  if (unzOpenCurrentFile(mpPrivate->mZip) != UNZ_OK)
-    return NULL;
-
-  void* pUnzip = unzGetCurrentFile(mpPrivate->mZip);
-
-  if (!pUnzip)
-    return NULL;
-
-  return new nglIZip(this, pUnzip, pNode->mSize, pNode->mNumOfFile, pNode->mPosInZipDirectory);
+  return OpenNode(pNode);
 }
 
-// Direct File Operations:
-bool nglZipFS::Close(void* pUnzip) 
+nglIZip* nglZipFS::OpenNode(Node* pNode)
 {
-  if (pUnzip == NULL)
-    return false;
-
-  //printf("zip close %p\n", pUnzip);
-  unzSetCurrentFile(mpPrivate->mZip, pUnzip);
-  return UNZ_CRCERROR != unzCloseCurrentFile(mpPrivate->mZip);
-}
-
-nglStreamState nglZipFS::GetState(void* pUnzip) const
-{
-  if (pUnzip == NULL)
-    return eStreamError;
+  nglCriticalSectionGuard guard(mNodeLock);
+  if (pNode->mDataOffset < 0 && !LocateNode(pNode))
+    return NULL;
 
-  unzSetCurrentFile(mpPrivate->mZip, pUnzip);
-  if (unzeof(mpPrivate->mZip))
-    return eStreamEnd;
-  
-  return eStreamReady;
-}
+  if (pNode->mCompressed && !pNode->mpSeekIndex && mSeekIndexSpan && pNode->mSize > mSeekIndexSpan)
+    pNode->mpSeekIndex = new nglZipSeekIndex(mSeekIndexSpan);
 
-nglFileOffset nglZipFS::GetPos(void* pUnzip) const
-{
-  unzSetCurrentFile(mpPrivate->mZip, pUnzip);
-  return unztell(mpPrivate->mZip);
+  return new nglIZip(this, pNode->mSize, pNode->mDataOffset, pNode->mCompressedSize, pNode->mCompressed, pNode->mpSeekIndex);
 }
 
-nglFileOffset nglZipFS::SetPos (void* pUnzip, nglFileOffset Where, nglIZip* pFile)
+bool nglZipFS::LocateNode(Node* pNode)
 {
-  unzSetCurrentFile(mpPrivate->mZip, pUnzip);
-  char dummy[1024];
-  nglFileOffset Pos = GetPos(pUnzip);
-
-  if (Where < Pos)
+  // Use a private unzip handle sharing the central directory read at mount time:
+  nglZipCursor* pCursor = new nglZipCursor(this);
+  unzFile pUnzip = unzDuplicate(mpPrivate->mZip, mpCursorFuncDef, pCursor);
+  if (!pUnzip)
   {
-    unzCloseCurrentFile(mpPrivate->mZip);
-
-    unz_file_pos file_pos;
-    file_pos.num_of_file = pFile->mNumOfFile;
-    file_pos.pos_in_zip_directory = pFile->mPosInZipDirectory;
-    unzGoToFilePos(mpPrivate->mZip, &file_pos);
+    delete pCursor;
+    return false;
+  }
 
-    if (unzOpenCurrentFile(mpPrivate->mZip) != UNZ_OK)
-      return 0;
+  unz_file_pos file_pos;
+  file_pos.num_of_file = pNode->mNumOfFile;
+  file_pos.pos_in_zip_directory = pNode->mPosInZipDirectory;
 
-    pUnzip = unzGetCurrentFile(mpPrivate->mZip);
-    pFile->SetRef(pUnzip);
-    Pos = 0;
+  unz_file_info file_info;
+  int method = 0;
+  bool res = unzGoToFilePos(pUnzip, &file_pos) == UNZ_OK
+          && unzGetCurrentFileInfo(pUnzip, &file_info, NULL, 0, NULL, 0, NULL, 0) == UNZ_OK
+          && !(file_info.flag & 1) // Encrypted entries are not supported
+          && unzOpenCurrentFile2(pUnzip, &method, NULL, 1) == UNZ_OK; // Raw: only parse the local header
 
-    if (!pUnzip)
-      return 0;
+  if (res)
+  {
+    res = (method == 0 || method == Z_DEFLATED);
+    pNode->mDataOffset = unzGetCurrentFileZStreamPos64(pUnzip);
+    pNode->mCompressedSize = file_info.compressed_size;
+    pNode->mCompressed = (method == Z_DEFLATED);
+    unzCloseCurrentFile(pUnzip);
   }
+  unzClose(pUnzip); // Deletes the cursor
 
-  Where -= Pos;
-  while (Where > 0)
+  if (!res || pNode->mDataOffset + pNode->mCompressedSize > mDataSize)
   {
-    nglFileOffset size = MIN(Where, 1024);
-    nglSize res = Read(pUnzip, dummy, (long)size, 1, eEndianNative);
-
-    if (res <= 0) // An Error occured
-      return GetPos(pUnzip);
-
-    Where -= res;
+    pNode->mDataOffset = -1;
+    return false;
   }
-
-  return GetPos(pUnzip);
+  return true;
 }
 
-
-nglSize nglZipFS::Read (void* pUnzip, void* pData, nglSize WordCount, uint WordSize, nglEndian nglEndian)
+void nglZipFS::SetSeekIndexSpan(uint32 Span)
 {
-  if (unzSetCurrentFile(mpPrivate->mZip, pUnzip) != UNZ_OK)
-    return 0;
-  nglSize done = unzReadCurrentFile(mpPrivate->mZip, pData, WordCount * WordSize);
-  done /= WordSize;
-
-  if ((done > 0) && (nglEndian != eEndianNative))
-  {
-    switch (WordSize)
-    {
-      case 2: bswap_16_s ((uint16*)pData, done); break;
-      case 4: bswap_32_s ((uint32*)pData, done); break;
-      case 8: bswap_64_s ((uint64*)pData, done); break;
-    }
-  }
+  nglCriticalSectionGuard guard(mNodeLock);
+  mSeekIndexSpan = Span;
+}
 
-  return done;
+uint32 nglZipFS::GetSeekIndexSpan() const
+{
+  return mSeekIndexSpan;
 }
 
 
-nglZipFS::Node::Node(const nglString& rPath, uint Size, uint Pos, uint Num, bool IsLeaf)
+nglZipFS::Node::Node(const nglString& rName, const nglString& rPath, uint32 Hash, uint Size, uint Pos, uint Num, bool IsLeaf)
 {
   mIsLeaf = IsLeaf;
 
@@ -473,11 +637,20 @@ nglZipFS::Node::Node(const nglString& rPath, uint Size, uint Pos, uint Num, bool
   mPosInZipDirectory = Pos;
   mNumOfFile = Num;
 
-  mName = rPath;
+  mName = rName;
+  mPath = rPath;
+  mHash = Hash;
+
+  mDataOffset = -1;
+  mCompressedSize = 0;
+  mCompressed = false;
+  mpSeekIndex = NULL;
 }
 
 nglZipFS::Node::~Node()
 {
+  delete mpSeekIndex;
+
   std::list<nglZipFS::Node*>::iterator it;
   std::list<nglZipFS::Node*>::iterator end = mpChildren.end();
   for (it = mpChildren.begin(); it != end; ++it)
@@ -487,38 +660,6 @@ nglZipFS::Node::~Node()
   }
 }
 
-nglZipFS::Node* nglZipFS::Node::Find(const nglPath& rPath) const
-{
-  if (rPath.GetPathName() == _T("") || rPath.GetPathName() == _T(".")  || rPath.GetPathName() == _T("/"))
-    return (nglZipFS::Node*)this;
-  std::list<nglPath> elems;
-  nglZipPath::Decompose(rPath, elems);
-  std::list<nglPath>::iterator it;
-  std::list<nglPath>::iterator end = elems.end();
-
-  Node* pChild = NULL; 
-  const Node* pRoot = this; 
-  for (it = elems.begin(); it != end && pRoot != NULL; ++it)
-  {
-    pChild = pRoot->Find((*it).GetPathName());
-    pRoot = pChild;
-  }
-
-  return pChild;
-}
-
-nglZipFS::Node* nglZipFS::Node::Find(const nglString& path) const
-{
-  if (path == _T("") || path == _T(".")  || path == _T("/"))
-    return (nglZipFS::Node*)this;
-  std::list<nglZipFS::Node*>::const_iterator it;
-  std::list<nglZipFS::Node*>::const_iterator end = mpChildren.end();
-  for (it = mpChildren.begin(); it != end; ++it)
-    if ((*it)->mName == path)
-      return *it;
-  return NULL;
-}
-
 bool nglZipFS::Node::AddChild(nglZipFS::Node* pPath)
 {
   mpChildren.push_back(pPath);
@@ -531,9 +672,7 @@ bool nglZipFS::GetPathInfo(const nglPath& rPath, nglPathInfo& rInfo)
   nglString p(rPath.GetVolumeLessPath());
   p.TrimLeft(_T('/'));
   //wprintf(_T("trimed path '%ls'\n"), p.GetChars());
-  nglPath path(p);
-
-  Node* pChild = mRoot.Find(path); 
+  Node* pChild = FindNode(p); 
 
   rInfo.Exists = pChild != NULL;
   rInfo.CanRead = rInfo.Exists;
@@ -565,29 +704,13 @@ nglIStream* nglZipFS::OpenRead(const nglPath& rPath)
   nglString p(rPath.GetVolumeLessPath());
   p.TrimLeft(_T('/'));
   //wprintf(_T("trimed path '%ls'\n"), p.GetChars());
-  nglPath path(p);
-  Node* pNode = mRoot.Find(path);
+  Node* pNode = FindNode(p);
   if (!pNode)
     return NULL;
   if (!pNode->mIsLeaf)
     return NULL;
 
-  unz_file_pos file_pos;
-  file_pos.num_of_file = pNode->mNumOfFile;
-  file_pos.pos_in_zip_directory = pNode->mPosInZipDirectory;
-
-  if (unzGoToFilePos(mpPrivate->mZip, &file_pos) != UNZ_OK)
-    return NULL;
-
-  if (unzOpenCurrentFile(mpPrivate->mZip) != UNZ_OK)
-    return NULL;
-
-  void* pUnzip = unzGetCurrentFile(mpPrivate->mZip);
-
-  if (!pUnzip)
-    return NULL;
-
-  return new nglIZip(this, pUnzip, pNode->mSize, pNode->mNumOfFile, pNode->mPosInZipDirectory);
+  return OpenNode(pNode);
 }
 
 nglIOStream* nglZipFS::OpenWrite(const nglPath& rPath, bool OverWrite)
@@ -600,8 +723,7 @@ bool nglZipFS::GetChildren(const nglPath& rPath, std::list<nglPath>& rChildren)
   nglString p(rPath.GetVolumeLessPath());
   p.TrimLeft(_T('/'));
   //wprintf(_T("trimed path '%ls'\n"), p.GetChars());
-  nglPath path(p);
-  Node* pNode = mRoot.Find(path);
+  Node* pNode = FindNode(p);
   if (!pNode)
     return 0;
 
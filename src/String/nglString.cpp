@@ -10,6 +10,7 @@ licence: see nui3/LICENCE.TXT
 #pragma warning(disable : 4996)
 
 #include "nglUTFStringConv.h"
+#include "nuiString8.h"
 #include "ucdata.h"
 
 #ifdef WINCE
@@ -614,6 +615,19 @@ const nglChar* nglString::GetChars() const
 
 std::string nglString::GetStdString(const nglTextEncoding Encoding) const
 {
+  if (Encoding == eUTF8)
+  {
+    // Direct encoding, without the intermediate buffer of Export
+    std::string tmp;
+    uint32 len = nuiString8::GetUTF8Length(&mString[0], (uint32)mString.size());
+    if (len)
+    {
+      tmp.resize(len);
+      nuiString8::EncodeUTF8(&mString[0], (uint32)mString.size(), &tmp[0]);
+    }
+    return tmp;
+  }
+
   char* pTemp = Export(Encoding);
   std::string tmp(pTemp);
   free(pTemp);
@@ -646,6 +660,17 @@ return strdup(psz);
 
 char* nglString::Export (const nglTextEncoding Encoding) const
 {
+  if (Encoding == eUTF8)
+  {
+    uint32 len = nuiString8::GetUTF8Length(&mString[0], (uint32)mString.size());
+    char* buffer = (char*) malloc(len + 1);
+    if (!buffer)
+      return NULL;
+    char* end = nuiString8::EncodeUTF8(&mString[0], (uint32)mString.size(), buffer);
+    *end = '\0';
+    return buffer;
+  }
+
   nglStringConv* pConv = nglString::GetStringConv(nglEncodingPair(eEncodingInternal, Encoding)); // From=internal -> To=user 'Encoding'
 
   if (pConv->GetState() != eStringConv_OK)
@@ -868,6 +893,10 @@ int32 nglString::Import(const char* pBuffer, const nglTextEncoding Encoding)
   int32 offset = 0;
   int32 len = (int32)strlen(pBuffer);
 
+  // Valid UTF-8 is decoded directly, the converter handles the errors
+  if (Encoding == eUTF8 && nuiString8::DecodeUTF8(pBuffer, len, mString))
+    return 0;
+
   return Import(offset, pBuffer, len, Encoding);
 }
 
@@ -879,6 +908,9 @@ int32 nglString::Import (const char* pBuffer, int32 ByteCount, const nglTextEnco
   mIsNull = false;
   int32 offset = 0;
 
+  if (Encoding == eUTF8 && ByteCount >= 0 && nuiString8::DecodeUTF8(pBuffer, ByteCount, mString))
+    return 0;
+
   return Import(offset, pBuffer, ByteCount, Encoding);
 }
 
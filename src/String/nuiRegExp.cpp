@@ -133,7 +133,8 @@ enum {
   WORDZ = 13,   //  no    Match "" at nonwordchar, where prev is word
   OPEN  = 20,   //  no    Sub-RE starts here.
             //      OPEN+1 is number 1, etc.
-  CLOSE = 30    //  no    Analogous to OPEN.
+  CLOSE = 30,   //  no    Analogous to OPEN.
+  REF   = 40    //  no    Match the text of a sub-RE, REF+1 is \1, etc.
 };
 
 // Opcode notes:
@@ -155,6 +156,10 @@ enum {
 //    and to minimize recursive plunges.
 //
 // OPEN,CLOSE ...are numbered at compile time.
+//
+// REF    Back reference: matches the same text as the last match of the
+//    given sub-RE, which must have been opened before.  Only the
+//    backtracking matcher runs programs with REF nodes.
 
 // A node is one char of opcode followed by two chars of "next" pointer.
 // "Next" pointers are stored as two 8-bit pieces, high order first.  The
@@ -175,7 +180,8 @@ enum
   REGERR_TO_BIG, REGERR_TO_MANY_PAREN, REGERR_UNTERMINATED_PAREN, REGERR_UNMATCHED_PAREN,
   REGERR_INTERNAL_ERROR_JUNK, REGERR_OP_COULD_BE_EMPTY, REGERR_NESTED_OP, REGERR_INVALID_RANGE,
   REGERR_UNMATCHED_BRACE, REGERR_INTERNAL_UNEXPECTED_CHAR, REGERR_OP_FOLLOWS_NOTHING,
-  REGERR_TRAILING_ESC, REGERR_INTERNAL_STRSCSPN, REGERR_NO_REGEXP
+  REGERR_TRAILING_ESC, REGERR_INTERNAL_STRSCSPN, REGERR_NO_REGEXP, REGERR_INVALID_BACKREF,
+  REGERR_BACKREF_NEEDS_BACKTRACKING
 };
 
 struct regErr
@@ -207,6 +213,8 @@ struct regErr
   { REGERR_TRAILING_ESC,        _T( "trailing \\" ) },
   { REGERR_INTERNAL_STRSCSPN,     _T( "internal error: strcspn 0" ) },
   { REGERR_NO_REGEXP,         _T( "NULL regexp" ) },
+  { REGERR_INVALID_BACKREF,     _T( "back reference to an unknown ()" ) },
+  { REGERR_BACKREF_NEEDS_BACKTRACKING, _T( "back references need the backtracking engine" ) },
   { REGERR_SENTINEL_VALUE,      _T( "Unknown error") }              // must be last value
 };
 
@@ -301,6 +309,8 @@ public:
 // The internal interface to the regexp, wrapping the compilation as well as the
 // execution of the regexp (matching)
 
+class CRegLinearProgram;
+
 class regexp : public CRegProgramAccessor
 {
   friend class CRegExecutor;
@@ -318,6 +328,12 @@ class regexp : public CRegProgramAccessor
   bool status;
   int count;      // used by nuiRegExp to manage the reference counting of regexps
   int numSubs;
+
+  CRegLinearProgram* mpLinear; // Built on first use, NULL if the program has back references
+  bool mLinearCompiled;
+  const nglChar* mpSubject;    // Text of the last match, when its sub expressions are not computed yet
+  uint32 mSubjectLength;
+  bool mCapturesPending;
 public:
   
   regexp( const nglChar* exp, bool iCase );
@@ -327,12 +343,17 @@ public:
   void ignoreCase( const nglChar* in, nglChar* out );
   
   bool regcomp( const nglChar* exp );
-  bool regexec( const nglChar* string );
-  bool Status() const { return status; }
+  bool regexec( const nglChar* string, nuiRegExp::Engine engine, uint32 cacheSize );
+  bool GetStatus() const { return status; }
+
+  CRegLinearProgram* GetLinearProgram();
+  void ResolveCaptures();
+  void UpdateSubCount( bool matched );
 
   nglString GetReplaceString( const nglChar* sReplaceExp ) const;
 
   regexp * getCopy();
+  regexp * getCopy( const nglChar* pOldText, const nglChar* pNewText ); ///< Copy whose sub expressions point in pNewText, at the offsets they have in pOldText.
 
 #ifdef _RE_DEBUG
   void  regdump();
@@ -344,6 +365,137 @@ public:
 #endif
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// Linear time engine
+//
+// The compiled program is translated to a list of NFA instructions: one per
+// node, EXACTLY nodes giving one instruction per character and STAR and PLUS
+// nodes being expanded to loops around their operand.  BRANCH nodes become
+// SPLIT instructions whose first choice is the one regmatch() tries first.
+// The NFA is then run in two ways:
+//
+// Search() only tells if there is a match.  It walks a DFA whose states are
+// the sets of instructions waiting for the next character (plus what the
+// assertions need to know about the previous one).  The states and their
+// transitions are built the first time they are needed and kept in a cache
+// that is flushed when it holds too many states.  The transitions are indexed
+// by character classes: the characters that the program does not tell apart
+// share the same class.
+//
+// Match() is a Pike VM: the threads are kept in the order in which
+// regmatch() would try them, each one with its own copy of the sub
+// expression positions, so that the first thread reaching END gives the same
+// match as the backtracking matcher.
+//
+// Both run in a time proportional to the length of the text times the number
+// of instructions.  Programs with back references can't be translated.
+
+static inline bool IsWordChar( nglChar c )
+{
+  return ((uint32)c < 256 && isalnum((int)c)) || c == '_';
+}
+
+class CRegLinearProgram : public CRegProgramAccessor
+{
+public:
+  CRegLinearProgram();
+
+  bool Compile( nglChar* program );
+  int Search( const nglChar* string, uint32 length, uint32 maxStates ); // 1 if there is a match, 0 if not, -1 if the DFA cache thrashes
+  bool Match( const nglChar* string, uint32 length, int32* captures ); // captures receives 2 * NSUBEXP positions, -1 if not set
+
+private:
+  enum
+  {
+    I_MATCH, I_CHAR, I_ANY, I_ANYOF, I_ANYBUT, I_SPLIT, I_JUMP, I_SAVE, I_ASSERT
+  };
+
+  struct Instruction
+  {
+    int32 mOp;
+    int32 mArg;         // Character, set, capture slot or asserted opcode
+    int32 mNext;
+    int32 mAlternative; // Second choice of a SPLIT
+  };
+
+  struct Context
+  {
+    bool mAtStart;
+    bool mAtEnd;
+    bool mPreviousWord;
+    bool mNextWord;
+  };
+
+  struct ThreadList
+  {
+    std::vector<int32> mThreads;
+    std::vector<int32> mCaptures; // 2 * NSUBEXP per thread
+    std::vector<uint32> mMarks;
+    uint32 mGeneration;
+  };
+
+  enum
+  {
+    STATE_UNKNOWN = -1,
+    STATE_MATCH = -2
+  };
+
+  enum
+  {
+    FLAG_AT_START = 1,
+    FLAG_PREVIOUS_WORD = 2
+  };
+
+  // Translation:
+  int32 Emit( int32 op, int32 arg );
+  int32 EmitSimple( nglChar* node );
+  int32 AddSet( const nglChar* chars );
+  int32 Translate( nglChar* node );
+  void BuildClasses();
+  void GetSignature( nglChar c, bool other, std::vector<bool>& rSignature ) const;
+  inline uint32 GetClass( nglChar c ) const;
+
+  // Execution:
+  bool Consumes( const Instruction& rInstruction, nglChar c ) const;
+  bool Check( int32 op, const Context& rContext ) const;
+  void GetContext( const nglChar* string, uint32 length, uint32 position, Context& rContext ) const;
+
+  // DFA:
+  bool Closure( const std::vector<int32>& rState, const Context& rContext, std::vector<int32>& rConsumers );
+  int32 AddState( const std::vector<int32>& rState );
+  int32 ComputeTransition( int32 state, nglChar c );
+  bool MatchesAtEnd( int32 state );
+  void FlushStates();
+
+  // Pike VM:
+  void ClearThreads( ThreadList& rList );
+  void AddThread( ThreadList& rList, int32 pc, int32* captures, const nglChar* string, uint32 length, uint32 position );
+
+  std::vector<Instruction> mInstructions;
+  std::vector<std::vector<nglChar> > mSets; // Sorted
+  int32 mStart;
+  bool mHasBackReferences;
+  bool mHasWordAssertions;
+  bool mCorrupted;
+  std::map<nglChar*, int32> mNodes;
+
+  uint32 mClassCount;
+  uint32 mLowClasses[256];
+  std::map<nglChar, uint32> mHighClasses;
+  uint32 mOtherClass; // Characters above 255 that the program doesn't use
+
+  std::vector<std::vector<int32> > mStates; // Pending instructions then flags
+  std::map<std::vector<int32>, int32> mStateIndex;
+  std::vector<int32> mTransitions; // mClassCount per state
+  std::vector<int8> mEndMatches;   // Per state, -1 if not computed yet
+  std::vector<uint32> mMarks;
+  uint32 mGeneration;
+  std::vector<int32> mStack;
+  std::vector<int32> mConsumers;
+
+  ThreadList mLists[2];
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // Compile / Validate the regular expression - ADT
 
@@ -489,12 +641,17 @@ CRegCompiler::CRegCompiler( const nglChar* parse, nglChar* prog )
 ///////////////////////////////////////////////////////////////////////////////
 
 regexp::regexp( const nglChar* exp, bool iCase )
-  : regstart(0),
+  : m_programSize(0),
+  regstart(0),
   reganch(0),
   regmust(0),
   regmlen(0),
   program(0),
-  m_programSize(0)
+  mpLinear(NULL),
+  mLinearCompiled(false),
+  mpSubject(NULL),
+  mSubjectLength(0),
+  mCapturesPending(false)
 {
 #if _DEBUG
   m_originalPattern = exp;    // keep a version of the pattern for debugging
@@ -518,12 +675,17 @@ regexp::regexp( const nglChar* exp, bool iCase )
 }
 
 regexp::regexp( const regexp & orig )
-  : regstart(orig.regstart),
+  : m_programSize(orig.m_programSize),
+  regstart(orig.regstart),
   reganch(orig.reganch),
+  regmust(0),
   regmlen(orig.regmlen),
-  m_programSize(orig.m_programSize),
   numSubs(orig.numSubs),
-  regmust(0)
+  mpLinear(NULL),
+  mLinearCompiled(false),
+  mpSubject(NULL),
+  mSubjectLength(0),
+  mCapturesPending(false)
 {
 #if _DEBUG
   m_originalPattern = orig.m_originalPattern;
@@ -536,7 +698,7 @@ regexp::regexp( const regexp & orig )
   if ( orig.regmust )
     regmust = program + ( orig.regmust - orig.program );
 
-  for ( int i = nuiRegExp::NSUBEXP; i > 0; i--)
+  for ( int i = 0; i < nuiRegExp::NSUBEXP; i++)
   {
     startp[i] = orig.startp[i];
     endp[i] = orig.endp[i];
@@ -545,6 +707,7 @@ regexp::regexp( const regexp & orig )
 
 regexp::~regexp()
 {
+  delete mpLinear;
   delete [] program;
 }
 
@@ -639,6 +802,18 @@ regexp * regexp::getCopy()
   return new regexp( *this );
 }
 
+regexp * regexp::getCopy( const nglChar* pOldText, const nglChar* pNewText )
+{
+  ResolveCaptures();
+  regexp* pCopy = new regexp( *this );
+  for ( int i = 0; i < nuiRegExp::NSUBEXP; i++ )
+  {
+    pCopy->startp[i] = startp[i] ? (nglChar*)pNewText + ( startp[i] - pOldText ) : NULL;
+    pCopy->endp[i] = endp[i] ? (nglChar*)pNewText + ( endp[i] - pOldText ) : NULL;
+  }
+  return pCopy;
+}
+
 // reg - regular expression, i.e. main body or parenthesized thing
 //
 // Caller must absorb opening parenthesis.
@@ -943,7 +1118,19 @@ nglChar* CRegCompilerBase::regatom(int * flagp)
         case '>':
           ret = regnode(WORDZ);
           break;
-        /* FIXME: Someday handle \1, \2, ... */
+        case '1': case '2': case '3':
+        case '4': case '5': case '6':
+        case '7': case '8': case '9':
+        {
+          const int no = regparse[-1] - '0';
+          if (no >= regnpar)
+          {
+            regerror( REGERR_INVALID_BACKREF );
+            return NULL;
+          }
+          ret = regnode(REF+no);
+          break;
+        }
         default:
           /* Handle general quoted chars in exact-match routine */
           goto de_fault;
@@ -1009,7 +1196,9 @@ nglChar* CRegCompilerBase::regatom(int * flagp)
           case '\0':
           case '<':
           case '>':
-          /* FIXME: Someday handle \1, \2, ... */
+          case '1': case '2': case '3':
+          case '4': case '5': case '6':
+          case '7': case '8': case '9':
             goto done; /* Not quoted */
           default:
             /* Backup point is \, scan               * point is after it. */
@@ -1039,7 +1228,7 @@ nglChar* CRegCompilerBase::regatom(int * flagp)
 
 class CRegExecutor : public CRegProgramAccessor
 {
-  friend bool regexp::regexec( const nglChar* str );
+  friend bool regexp::regexec( const nglChar* str, nuiRegExp::Engine engine, uint32 cacheSize );
 
   nglChar* reginput;    // String-input pointer. 
   nglChar* regbol;      // Beginning of input, for ^ check. 
@@ -1069,7 +1258,7 @@ int regnarrate = 0;
 
 // regexec - match a regexp against a string
 
-bool regexp::regexec( const nglChar* str )
+bool regexp::regexec( const nglChar* str, nuiRegExp::Engine engine, uint32 cacheSize )
 {
   nglChar* string = (nglChar*)str;  // avert const poisoning 
 
@@ -1087,10 +1276,50 @@ bool regexp::regexec( const nglChar* str )
     return false;
   }
 
+  mCapturesPending = false;
+
   // If there is a "must appear" string, look for it. 
   if ( regmust != NULL && wcsstr( string, regmust ) == NULL )
     return false;
 
+  if ( engine != nuiRegExp::eBacktrackingEngine )
+  {
+    CRegLinearProgram* pLinear = GetLinearProgram();
+    if ( pLinear )
+    {
+      for ( int i = 0; i < nuiRegExp::NSUBEXP; i++ )
+        startp[i] = endp[i] = NULL;
+
+      const uint32 length = (uint32)wcslen( string );
+      const int found = pLinear->Search( string, length, cacheSize );
+      if ( found < 0 )
+      {
+        // The DFA cache thrashes on this text: simulate the NFA directly.
+        int32 captures[2 * nuiRegExp::NSUBEXP];
+        if ( !pLinear->Match( string, length, captures ) )
+          return false;
+        for ( int i = 0; i < nuiRegExp::NSUBEXP; i++ )
+        {
+          startp[i] = captures[2 * i] < 0 ? NULL : string + captures[2 * i];
+          endp[i] = captures[2 * i + 1] < 0 ? NULL : string + captures[2 * i + 1];
+        }
+        return true;
+      }
+
+      // The sub expressions are only computed if they are asked for:
+      mpSubject = string;
+      mSubjectLength = length;
+      mCapturesPending = ( found != 0 );
+      return mCapturesPending;
+    }
+
+    if ( engine == nuiRegExp::eLinearEngine )
+    {
+      regerror( REGERR_BACKREF_NEEDS_BACKTRACKING );
+      return false;
+    }
+  }
+
   CRegExecutor executor( this, string );
 
   // Simplest case:  anchored match need be tried only once. 
@@ -1184,16 +1413,15 @@ bool CRegExecutor::regmatch( nglChar* prog )
         break;
       case WORDA:
         /* Must be looking at a letter, digit, or _ */
-        if ((!isalnum(*reginput)) && *reginput != '_')
+        if (!IsWordChar(*reginput))
           return(0);
         /* Prev must be BOL or nonword */
-        if (reginput > regbol &&
-          (isalnum(reginput[-1]) || reginput[-1] == '_'))
+        if (reginput > regbol && IsWordChar(reginput[-1]))
           return(0);
         break;
       case WORDZ:
         /* Must be looking at non letter, digit, or _ */
-        if (isalnum(*reginput) || *reginput == '_')
+        if (IsWordChar(*reginput))
           return(0);
         /* We don't care what the previous char was */
         break;
@@ -1237,21 +1465,16 @@ bool CRegExecutor::regmatch( nglChar* prog )
       case OPEN+4: case OPEN+5: case OPEN+6:
       case OPEN+7: case OPEN+8: case OPEN+9:
       {
+        // Set startp on the way in so that back references can see
+        // it, the last invocation of the same parentheses wins.
         const int no = OP(scan) - OPEN;
-        nglChar* const input = reginput;
+        nglChar* const save = regstartp[no];
 
+        regstartp[no] = reginput;
         if (regmatch(next))
-        {
-          // Don't set startp if some later
-          // invocation of the same parentheses
-          // already has.
-           
-          if (regstartp[no] == NULL)
-            regstartp[no] = input;
           return true;
-        }
-        else
-          return false;
+        regstartp[no] = save;
+        return false;
         break;
       }
       case CLOSE+1: case CLOSE+2: case CLOSE+3:
@@ -1259,20 +1482,30 @@ bool CRegExecutor::regmatch( nglChar* prog )
       case CLOSE+7: case CLOSE+8: case CLOSE+9:
       {
         const int no = OP(scan) - CLOSE;
-        nglChar* const input = reginput;
+        nglChar* const save = regendp[no];
 
+        regendp[no] = reginput;
         if (regmatch(next))
-        {
-          // Don't set endp if some later
-          // invocation of the same parentheses
-          // already has.
-           
-          if (regendp[no] == NULL)
-            regendp[no] = input;
           return true;
-        }
-        else
+        regendp[no] = save;
+        return false;
+        break;
+      }
+      case REF+1: case REF+2: case REF+3:
+      case REF+4: case REF+5: case REF+6:
+      case REF+7: case REF+8: case REF+9:
+      {
+        const int no = OP(scan) - REF;
+        nglChar* const start = regstartp[no];
+        nglChar* const end = regendp[no];
+
+        // The sub-RE must have been matched completely.
+        if (start == NULL || end == NULL || end < start)
           return false;
+        const size_t len = end - start;
+        if (wcsncmp(start, reginput, len) != 0)
+          return false;
+        reginput += len;
         break;
       }
       case BRANCH:
@@ -1364,6 +1597,601 @@ size_t CRegExecutor::regrepeat( nglChar* node )
   // NOTREACHED 
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Linear time engine
+
+CRegLinearProgram::CRegLinearProgram()
+  : mStart(0),
+  mHasBackReferences(false),
+  mHasWordAssertions(false),
+  mCorrupted(false),
+  mClassCount(0),
+  mOtherClass(0),
+  mGeneration(0)
+{
+  mLists[0].mGeneration = 0;
+  mLists[1].mGeneration = 0;
+}
+
+bool CRegLinearProgram::Compile( nglChar* program )
+{
+  mStart = Translate( program + 1 );
+  mNodes.clear();
+  if ( mHasBackReferences || mCorrupted )
+    return false;
+
+  BuildClasses();
+  mMarks.resize( mInstructions.size(), 0 );
+  for ( int i = 0; i < 2; i++ )
+    mLists[i].mMarks.resize( mInstructions.size(), 0 );
+  return true;
+}
+
+int32 CRegLinearProgram::Emit( int32 op, int32 arg )
+{
+  Instruction instruction;
+  instruction.mOp = op;
+  instruction.mArg = arg;
+  instruction.mNext = 0;
+  instruction.mAlternative = 0;
+  mInstructions.push_back( instruction );
+  return (int32)mInstructions.size() - 1;
+}
+
+int32 CRegLinearProgram::AddSet( const nglChar* chars )
+{
+  std::vector<nglChar> set( chars, chars + wcslen( chars ) );
+  std::sort( set.begin(), set.end() );
+  set.erase( std::unique( set.begin(), set.end() ), set.end() );
+  mSets.push_back( set );
+  return (int32)mSets.size() - 1;
+}
+
+// EmitSimple - the one character operand of a STAR or PLUS node
+int32 CRegLinearProgram::EmitSimple( nglChar* node )
+{
+  switch ( OP(node) )
+  {
+    case ANY:
+      return Emit( I_ANY, 0 );
+    case EXACTLY:
+      return Emit( I_CHAR, *OPERAND(node) );
+    case ANYOF:
+      return Emit( I_ANYOF, AddSet( OPERAND(node) ) );
+    case ANYBUT:
+      return Emit( I_ANYBUT, AddSet( OPERAND(node) ) );
+  }
+  mCorrupted = true;
+  return Emit( I_MATCH, 0 );
+}
+
+// Translate - return the first instruction of the given node, translating
+// it and the nodes that follow it if it wasn't done yet.
+int32 CRegLinearProgram::Translate( nglChar* node )
+{
+  if ( node == NULL )
+  {
+    mCorrupted = true;
+    return Emit( I_MATCH, 0 );
+  }
+
+  std::map<nglChar*, int32>::const_iterator it = mNodes.find( node );
+  if ( it != mNodes.end() )
+    return it->second;
+
+  nglChar* const next = regnext( node );
+  const int op = OP(node);
+  int32 index;
+  int32 target;
+
+  switch ( op )
+  {
+    case END:
+      index = Emit( I_MATCH, 0 );
+      mNodes[node] = index;
+      return index;
+    case BOL:
+    case EOL:
+    case WORDA:
+    case WORDZ:
+      mHasWordAssertions |= ( op == WORDA || op == WORDZ );
+      index = Emit( I_ASSERT, op );
+      break;
+    case ANY:
+    case ANYOF:
+    case ANYBUT:
+      index = EmitSimple( node );
+      break;
+    case EXACTLY:
+    {
+      const nglChar* const opnd = OPERAND(node);
+      const int32 len = (int32)wcslen( opnd );
+      if ( len == 0 )
+      {
+        index = Emit( I_JUMP, 0 );
+        break;
+      }
+      index = (int32)mInstructions.size();
+      for ( int32 i = 0; i < len; i++ )
+        mInstructions[Emit( I_CHAR, opnd[i] )].mNext = index + i + 1;
+      mNodes[node] = index;
+      target = Translate( next );
+      mInstructions[index + len - 1].mNext = target;
+      return index;
+    }
+    case NOTHING:
+    case BACK:
+      index = Emit( I_JUMP, 0 );
+      break;
+    case BRANCH:
+      if ( OP(next) != BRANCH ) // No choice.
+      {
+        index = Emit( I_JUMP, 0 );
+        mNodes[node] = index;
+        target = Translate( OPERAND(node) );
+        mInstructions[index].mNext = target;
+        return index;
+      }
+      index = Emit( I_SPLIT, 0 );
+      mNodes[node] = index;
+      target = Translate( OPERAND(node) );
+      mInstructions[index].mNext = target;
+      target = Translate( next );
+      mInstructions[index].mAlternative = target;
+      return index;
+    case STAR:
+    {
+      // Greedy: try one more repetition first.
+      index = Emit( I_SPLIT, 0 );
+      mNodes[node] = index;
+      const int32 body = EmitSimple( OPERAND(node) );
+      mInstructions[body].mNext = index;
+      mInstructions[index].mNext = body;
+      target = Translate( next );
+      mInstructions[index].mAlternative = target;
+      return index;
+    }
+    case PLUS:
+    {
+      index = EmitSimple( OPERAND(node) );
+      mNodes[node] = index;
+      const int32 loop = Emit( I_SPLIT, 0 );
+      mInstructions[index].mNext = loop;
+      mInstructions[loop].mNext = index;
+      target = Translate( next );
+      mInstructions[loop].mAlternative = target;
+      return index;
+    }
+    default:
+      if ( op > OPEN && op < OPEN + nuiRegExp::NSUBEXP )
+        index = Emit( I_SAVE, 2 * ( op - OPEN ) );
+      else if ( op > CLOSE && op < CLOSE + nuiRegExp::NSUBEXP )
+        index = Emit( I_SAVE, 2 * ( op - CLOSE ) + 1 );
+      else
+      {
+        if ( op > REF && op < REF + nuiRegExp::NSUBEXP )
+          mHasBackReferences = true;
+        else
+          mCorrupted = true;
+        index = Emit( I_MATCH, 0 );
+        mNodes[node] = index;
+        return index;
+      }
+      break;
+  }
+
+  // Simple node followed by the next one:
+  mNodes[node] = index;
+  target = Translate( next );
+  mInstructions[index].mNext = target;
+  return index;
+}
+
+// GetSignature - what the instructions of the program tell about a character
+void CRegLinearProgram::GetSignature( nglChar c, bool other, std::vector<bool>& rSignature ) const
+{
+  rSignature.clear();
+  for ( size_t i = 0; i < mInstructions.size(); i++ )
+    if ( mInstructions[i].mOp == I_CHAR )
+      rSignature.push_back( !other && c == (nglChar)mInstructions[i].mArg );
+  for ( size_t i = 0; i < mSets.size(); i++ )
+    rSignature.push_back( !other && std::binary_search( mSets[i].begin(), mSets[i].end(), c ) );
+  if ( mHasWordAssertions )
+    rSignature.push_back( !other && IsWordChar( c ) );
+}
+
+void CRegLinearProgram::BuildClasses()
+{
+  std::map<std::vector<bool>, uint32> classes;
+  std::vector<bool> signature;
+
+  for ( uint32 c = 0; c < 256; c++ )
+  {
+    GetSignature( (nglChar)c, false, signature );
+    std::map<std::vector<bool>, uint32>::iterator it = classes.find( signature );
+    if ( it == classes.end() )
+      it = classes.insert( std::make_pair( signature, (uint32)classes.size() ) ).first;
+    mLowClasses[c] = it->second;
+  }
+
+  // The characters above 255 that appear in the program:
+  std::vector<nglChar> high;
+  for ( size_t i = 0; i < mInstructions.size(); i++ )
+    if ( mInstructions[i].mOp == I_CHAR && (uint32)mInstructions[i].mArg >= 256 )
+      high.push_back( (nglChar)mInstructions[i].mArg );
+  for ( size_t i = 0; i < mSets.size(); i++ )
+    for ( size_t j = 0; j < mSets[i].size(); j++ )
+      if ( (uint32)mSets[i][j] >= 256 )
+        high.push_back( mSets[i][j] );
+
+  for ( size_t i = 0; i < high.size(); i++ )
+  {
+    GetSignature( high[i], false, signature );
+    std::map<std::vector<bool>, uint32>::iterator it = classes.find( signature );
+    if ( it == classes.end() )
+      it = classes.insert( std::make_pair( signature, (uint32)classes.size() ) ).first;
+    mHighClasses[high[i]] = it->second;
+  }
+
+  GetSignature( 0, true, signature );
+  std::map<std::vector<bool>, uint32>::iterator it = classes.find( signature );
+  if ( it == classes.end() )
+    it = classes.insert( std::make_pair( signature, (uint32)classes.size() ) ).first;
+  mOtherClass = it->second;
+
+  mClassCount = (uint32)classes.size();
+}
+
+inline uint32 CRegLinearProgram::GetClass( nglChar c ) const
+{
+  if ( (uint32)c < 256 )
+    return mLowClasses[(uint32)c];
+  std::map<nglChar, uint32>::const_iterator it = mHighClasses.find( c );
+  return it == mHighClasses.end() ? mOtherClass : it->second;
+}
+
+bool CRegLinearProgram::Consumes( const Instruction& rInstruction, nglChar c ) const
+{
+  switch ( rInstruction.mOp )
+  {
+    case I_CHAR:
+      return c == (nglChar)rInstruction.mArg;
+    case I_ANY:
+      return true;
+    case I_ANYOF:
+      return std::binary_search( mSets[rInstruction.mArg].begin(), mSets[rInstruction.mArg].end(), c );
+    case I_ANYBUT:
+      return !std::binary_search( mSets[rInstruction.mArg].begin(), mSets[rInstruction.mArg].end(), c );
+  }
+  return false;
+}
+
+bool CRegLinearProgram::Check( int32 op, const Context& rContext ) const
+{
+  switch ( op )
+  {
+    case BOL:
+      return rContext.mAtStart;
+    case EOL:
+      return rContext.mAtEnd;
+    case WORDA:
+      return rContext.mNextWord && !rContext.mPreviousWord;
+    case WORDZ:
+      return !rContext.mNextWord;
+  }
+  return false;
+}
+
+void CRegLinearProgram::GetContext( const nglChar* string, uint32 length, uint32 position, Context& rContext ) const
+{
+  rContext.mAtStart = ( position == 0 );
+  rContext.mAtEnd = ( position == length );
+  rContext.mPreviousWord = position > 0 && IsWordChar( string[position - 1] );
+  rContext.mNextWord = position < length && IsWordChar( string[position] );
+}
+
+// Closure - follow the instructions that don't consume characters from the
+// given state, return true if END is reached.
+bool CRegLinearProgram::Closure( const std::vector<int32>& rState, const Context& rContext, std::vector<int32>& rConsumers )
+{
+  bool matched = false;
+
+  rConsumers.clear();
+  if ( !++mGeneration )
+  {
+    std::fill( mMarks.begin(), mMarks.end(), 0 );
+    mGeneration = 1;
+  }
+
+  mStack.assign( rState.begin(), rState.end() - 1 );
+  while ( !mStack.empty() )
+  {
+    const int32 pc = mStack.back();
+    mStack.pop_back();
+    if ( mMarks[pc] == mGeneration )
+      continue;
+    mMarks[pc] = mGeneration;
+
+    const Instruction& rInstruction = mInstructions[pc];
+    switch ( rInstruction.mOp )
+    {
+      case I_MATCH:
+        matched = true;
+        break;
+      case I_JUMP:
+      case I_SAVE:
+        mStack.push_back( rInstruction.mNext );
+        break;
+      case I_SPLIT:
+        mStack.push_back( rInstruction.mAlternative );
+        mStack.push_back( rInstruction.mNext );
+        break;
+      case I_ASSERT:
+        if ( Check( rInstruction.mArg, rContext ) )
+          mStack.push_back( rInstruction.mNext );
+        break;
+      default:
+        rConsumers.push_back( pc );
+        break;
+    }
+  }
+
+  return matched;
+}
+
+int32 CRegLinearProgram::AddState( const std::vector<int32>& rState )
+{
+  std::map<std::vector<int32>, int32>::const_iterator it = mStateIndex.find( rState );
+  if ( it != mStateIndex.end() )
+    return it->second;
+
+  const int32 state = (int32)mStates.size();
+  mStates.push_back( rState );
+  mStateIndex[rState] = state;
+  mTransitions.resize( mTransitions.size() + mClassCount, STATE_UNKNOWN );
+  mEndMatches.push_back( -1 );
+  return state;
+}
+
+void CRegLinearProgram::FlushStates()
+{
+  mStates.clear();
+  mStateIndex.clear();
+  mTransitions.clear();
+  mEndMatches.clear();
+}
+
+int32 CRegLinearProgram::ComputeTransition( int32 state, nglChar c )
+{
+  const int32 flags = mStates[state].back();
+  Context context;
+  context.mAtStart = ( flags & FLAG_AT_START ) != 0;
+  context.mAtEnd = false;
+  context.mPreviousWord = ( flags & FLAG_PREVIOUS_WORD ) != 0;
+  context.mNextWord = IsWordChar( c );
+
+  if ( Closure( mStates[state], context, mConsumers ) )
+    return STATE_MATCH;
+
+  // A new match attempt starts at each character:
+  std::vector<int32> next;
+  next.reserve( mConsumers.size() + 2 );
+  for ( size_t i = 0; i < mConsumers.size(); i++ )
+  {
+    const Instruction& rInstruction = mInstructions[mConsumers[i]];
+    if ( Consumes( rInstruction, c ) )
+      next.push_back( rInstruction.mNext );
+  }
+  next.push_back( mStart );
+  std::sort( next.begin(), next.end() );
+  next.erase( std::unique( next.begin(), next.end() ), next.end() );
+  next.push_back( ( mHasWordAssertions && context.mNextWord ) ? FLAG_PREVIOUS_WORD : 0 );
+
+  return AddState( next );
+}
+
+bool CRegLinearProgram::MatchesAtEnd( int32 state )
+{
+  if ( mEndMatches[state] < 0 )
+  {
+    const int32 flags = mStates[state].back();
+    Context context;
+    context.mAtStart = ( flags & FLAG_AT_START ) != 0;
+    context.mAtEnd = true;
+    context.mPreviousWord = ( flags & FLAG_PREVIOUS_WORD ) != 0;
+    context.mNextWord = false;
+    mEndMatches[state] = Closure( mStates[state], context, mConsumers ) ? 1 : 0;
+  }
+  return mEndMatches[state] != 0;
+}
+
+int CRegLinearProgram::Search( const nglChar* string, uint32 length, uint32 maxStates )
+{
+  if ( maxStates < 16 )
+    maxStates = 16;
+
+  std::vector<int32> initial;
+  initial.push_back( mStart );
+  initial.push_back( FLAG_AT_START );
+  int32 state = AddState( initial );
+
+  uint32 flushes = 0;
+  uint32 lastFlush = 0;
+  for ( uint32 i = 0; i < length; i++ )
+  {
+    const uint32 cls = GetClass( string[i] );
+    int32 next = mTransitions[state * mClassCount + cls];
+    if ( next == STATE_UNKNOWN )
+    {
+      if ( mStates.size() >= maxStates )
+      {
+        // Give up if the cache doesn't last long enough to be worth it:
+        if ( flushes && i - lastFlush < 10 * maxStates )
+          return -1;
+        flushes++;
+        lastFlush = i;
+
+        const std::vector<int32> current( mStates[state] );
+        FlushStates();
+        state = AddState( current );
+      }
+      next = ComputeTransition( state, string[i] );
+      mTransitions[state * mClassCount + cls] = next;
+    }
+    if ( next == STATE_MATCH )
+      return 1;
+    state = next;
+  }
+
+  return MatchesAtEnd( state ) ? 1 : 0;
+}
+
+void CRegLinearProgram::ClearThreads( ThreadList& rList )
+{
+  rList.mThreads.clear();
+  rList.mCaptures.clear();
+  if ( !++rList.mGeneration )
+  {
+    std::fill( rList.mMarks.begin(), rList.mMarks.end(), 0 );
+    rList.mGeneration = 1;
+  }
+}
+
+// AddThread - add the threads reachable from pc without consuming a
+// character, in the order in which regmatch() would try them.
+void CRegLinearProgram::AddThread( ThreadList& rList, int32 pc, int32* captures, const nglChar* string, uint32 length, uint32 position )
+{
+  if ( rList.mMarks[pc] == rList.mGeneration )
+    return; // A thread with a higher priority already got there.
+  rList.mMarks[pc] = rList.mGeneration;
+
+  const Instruction& rInstruction = mInstructions[pc];
+  switch ( rInstruction.mOp )
+  {
+    case I_JUMP:
+      AddThread( rList, rInstruction.mNext, captures, string, length, position );
+      break;
+    case I_SPLIT:
+      AddThread( rList, rInstruction.mNext, captures, string, length, position );
+      AddThread( rList, rInstruction.mAlternative, captures, string, length, position );
+      break;
+    case I_SAVE:
+    {
+      const int32 save = captures[rInstruction.mArg];
+      captures[rInstruction.mArg] = (int32)position;
+      AddThread( rList, rInstruction.mNext, captures, string, length, position );
+      captures[rInstruction.mArg] = save;
+      break;
+    }
+    case I_ASSERT:
+    {
+      Context context;
+      GetContext( string, length, position, context );
+      if ( Check( rInstruction.mArg, context ) )
+        AddThread( rList, rInstruction.mNext, captures, string, length, position );
+      break;
+    }
+    default:
+      rList.mThreads.push_back( pc );
+      rList.mCaptures.insert( rList.mCaptures.end(), captures, captures + 2 * nuiRegExp::NSUBEXP );
+      break;
+  }
+}
+
+bool CRegLinearProgram::Match( const nglChar* string, uint32 length, int32* captures )
+{
+  const uint32 slots = 2 * nuiRegExp::NSUBEXP;
+  int32 start[2 * nuiRegExp::NSUBEXP];
+  ThreadList* pCurrent = &mLists[0];
+  ThreadList* pNext = &mLists[1];
+  bool matched = false;
+
+  ClearThreads( *pCurrent );
+  for ( uint32 position = 0; ; position++ )
+  {
+    // Until a match is found, a new attempt starts at each position, with
+    // a lower priority than the ones that started before.
+    if ( !matched )
+    {
+      for ( uint32 i = 0; i < slots; i++ )
+        start[i] = -1;
+      start[0] = (int32)position;
+      AddThread( *pCurrent, mStart, start, string, length, position );
+    }
+
+    ClearThreads( *pNext );
+    const nglChar c = position < length ? string[position] : 0;
+    for ( size_t t = 0; t < pCurrent->mThreads.size(); t++ )
+    {
+      const Instruction& rInstruction = mInstructions[pCurrent->mThreads[t]];
+      int32* const pCaptures = &pCurrent->mCaptures[t * slots];
+      if ( rInstruction.mOp == I_MATCH )
+      {
+        // The threads with a lower priority are dropped.
+        matched = true;
+        memcpy( captures, pCaptures, slots * sizeof( int32 ) );
+        captures[1] = (int32)position;
+        break;
+      }
+      if ( position < length && Consumes( rInstruction, c ) )
+        AddThread( *pNext, rInstruction.mNext, pCaptures, string, length, position + 1 );
+    }
+
+    std::swap( pCurrent, pNext );
+    if ( position == length || ( matched && pCurrent->mThreads.empty() ) )
+      break;
+  }
+
+  return matched;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CRegLinearProgram* regexp::GetLinearProgram()
+{
+  if ( !mLinearCompiled )
+  {
+    mLinearCompiled = true;
+    if ( status && program )
+    {
+      mpLinear = new CRegLinearProgram();
+      if ( !mpLinear->Compile( program ) )
+      {
+        delete mpLinear;
+        mpLinear = NULL;
+      }
+    }
+  }
+  return mpLinear;
+}
+
+// ResolveCaptures - compute the sub expressions of a match found by the DFA
+void regexp::ResolveCaptures()
+{
+  if ( !mCapturesPending )
+    return;
+  mCapturesPending = false;
+
+  int32 captures[2 * nuiRegExp::NSUBEXP];
+  bool matched = mpLinear->Match( mpSubject, mSubjectLength, captures );
+  NGL_ASSERT( matched );
+  for ( int i = 0; i < nuiRegExp::NSUBEXP; i++ )
+  {
+    startp[i] = ( !matched || captures[2 * i] < 0 ) ? NULL : (nglChar*)mpSubject + captures[2 * i];
+    endp[i] = ( !matched || captures[2 * i + 1] < 0 ) ? NULL : (nglChar*)mpSubject + captures[2 * i + 1];
+  }
+  UpdateSubCount( matched );
+}
+
+void regexp::UpdateSubCount( bool matched )
+{
+  int i = 0;
+  if ( matched )
+    for ( i = 0; i < nuiRegExp::NSUBEXP && startp[i] ; i++ )
+      ;
+  numSubs = i - 1;
+}
+
 #ifdef _RE_DEBUG
 
 // regdump - dump a regexp onto stdout in vaguely comprehensible form
@@ -1434,6 +2262,12 @@ nglChar* CRegProgramAccessor::regprop( nglChar* op )
   OUTPUT( PLUS );
   OUTPUT( WORDA );
   OUTPUT( WORDZ );
+  case REF+1: case REF+2: case REF+3:
+  case REF+4: case REF+5: case REF+6:
+  case REF+7: case REF+8: case REF+9:
+    _stprintf(buf+wcslen(buf), _T( "REF%d" ), OP(op)-REF);
+    p = NULL;
+    break;
   case OPEN+1: case OPEN+2: case OPEN+3:
   case OPEN+4: case OPEN+5: case OPEN+6:
   case OPEN+7: case OPEN+8: case OPEN+9:
@@ -1459,31 +2293,47 @@ nglChar* CRegProgramAccessor::regprop( nglChar* op )
 ///////////////////////////////////////////////////////////////////////////////
 
 nuiRegExp::nuiRegExp()
-  : rc(0),
-  mpString(NULL)
+  : mpString(NULL),
+  rc(0),
+  mEngine(eAutomaticEngine),
+  mCacheSize(2048)
 {
 }
 
-nuiRegExp::nuiRegExp( const nglChar* exp, bool iCase )
-  : rc( new regexp( exp, iCase ) ),
-  mpString(NULL)
+nuiRegExp::nuiRegExp( const nglChar* exp, bool iCase, Engine engine )
+  : mpString(NULL),
+  rc( new regexp( exp, iCase ) ),
+  mEngine(engine),
+  mCacheSize(2048)
 {
 }
 
-nuiRegExp::nuiRegExp( const nglString& exp, bool iCase )
-  : rc( new regexp( exp.GetChars(), iCase ) ),
-  mpString(NULL)
+nuiRegExp::nuiRegExp( const nglString& exp, bool iCase, Engine engine )
+  : mpString(NULL),
+  rc( new regexp( exp.GetChars(), iCase ) ),
+  mEngine(engine),
+  mCacheSize(2048)
 {
 }
 
 nuiRegExp::nuiRegExp( const nuiRegExp &r )
-  : rc( r.rc ),
-  m_szError(r.m_szError),
+  : mpString(NULL),
   mString(r.mString),
-  mpString(mString.GetChars())
+  m_szError(r.m_szError),
+  rc( r.rc ),
+  mEngine(r.mEngine),
+  mCacheSize(r.mCacheSize)
 {
+  // mpString is declared before mString, it can only point to the copy once it is constructed:
+  mpString = r.mpString ? mString.GetChars() : NULL;
   if ( rc )
-    rc->count++;
+  {
+    // The sub expressions of the last match point to the text of r, ours must point to our copy of it:
+    if ( r.mpString )
+      rc = r.rc->getCopy( r.mpString, mpString );
+    else
+      rc->count++;
+  }
 }
 
 const nuiRegExp & nuiRegExp::operator=( const nuiRegExp & r )
@@ -1493,13 +2343,21 @@ const nuiRegExp & nuiRegExp::operator=( const nuiRegExp & r )
     if ( rc && rc->count-- == 0 )
       delete rc;
 
+    mString = r.mString;
+    mpString = r.mpString ? mString.GetChars() : NULL;
+
     rc = r.rc;
     if ( rc )
-      rc->count++;
+    {
+      if ( r.mpString )
+        rc = r.rc->getCopy( r.mpString, mpString );
+      else
+        rc->count++;
+    }
 
-    mString = r.mString;
-    mpString = mString.GetChars();
     m_szError = r.m_szError;
+    mEngine = r.mEngine;
+    mCacheSize = r.mCacheSize;
   } 
   return *this;
 }
@@ -1531,12 +2389,9 @@ bool nuiRegExp::Match( const nglChar* s )
       rc = rc->getCopy();
     }
 
-    ret = rc->regexec( s );
-    int i = 0;
-    if ( ret )
-      for ( i = 0; i < nuiRegExp::NSUBEXP && rc->startp[i] ; i++ )
-        ;
-    rc->numSubs = i - 1;
+    ret = rc->regexec( mpString, mEngine, mCacheSize );
+    if ( !rc->mCapturesPending )
+      rc->UpdateSubCount( ret );
   }
   else
     m_szError = CRegErrorHandler::FindErr( REGERR_NO_REGEXP );
@@ -1547,7 +2402,10 @@ nglString nuiRegExp::GetReplaceString( const nglChar* source ) const
 {
   ClearErrorString();
   if ( rc )
+  {
+    rc->ResolveCaptures();
     return rc->GetReplaceString( source );
+  }
   else
     m_szError = CRegErrorHandler::FindErr( REGERR_NO_REGEXP );
   return _T( "" );
@@ -1558,7 +2416,10 @@ int nuiRegExp::SubStrings() const
   ClearErrorString();
   int ret = -1;
   if ( rc )
+  {
+    rc->ResolveCaptures();
     ret = rc->numSubs;
+  }
   else
     m_szError = CRegErrorHandler::FindErr( REGERR_NO_REGEXP );
   return ret;
@@ -1569,7 +2430,10 @@ int nuiRegExp::SubStart( uint32 i ) const
   ClearErrorString();
   int ret = -1;
   if ( rc )
+  {
+    rc->ResolveCaptures();
     ret = rc->startp[safeIndex(i)] - mpString;
+  }
   else
     m_szError = CRegErrorHandler::FindErr( REGERR_NO_REGEXP );
   return ret;
@@ -1581,6 +2445,7 @@ int nuiRegExp::SubLength( uint32 i ) const
   int ret = -1;
   if ( rc )
   {
+    rc->ResolveCaptures();
     i = safeIndex(i);
     ret = rc->endp[i] - rc->startp[i];
   }
@@ -1591,7 +2456,32 @@ int nuiRegExp::SubLength( uint32 i ) const
 
 bool nuiRegExp::CompiledOK() const
 {
-  return rc ? rc->Status() : false;
+  return rc ? rc->GetStatus() : false;
+}
+
+void nuiRegExp::SetEngine( Engine engine )
+{
+  mEngine = engine;
+}
+
+nuiRegExp::Engine nuiRegExp::GetEngine() const
+{
+  return mEngine;
+}
+
+bool nuiRegExp::UsesBackReferences() const
+{
+  return rc && rc->GetStatus() && !rc->GetLinearProgram();
+}
+
+void nuiRegExp::SetCacheSize( uint32 MaxStates )
+{
+  mCacheSize = MaxStates;
+}
+
+uint32 nuiRegExp::GetCacheSize() const
+{
+  return mCacheSize;
 }
 
 #ifdef _RE_DEBUG
@@ -1608,7 +2498,7 @@ void nuiRegExp::Dump()
 
 int nuiRegExp::safeIndex( uint32 i ) const
 {
-  return i < nuiRegExp::NSUBEXP ? i : nuiRegExp::NSUBEXP;
+  return i < nuiRegExp::NSUBEXP ? i : nuiRegExp::NSUBEXP - 1;
 }
 
 const nglString nuiRegExp::operator[]( uint32 i ) const
@@ -1617,13 +2507,11 @@ const nglString nuiRegExp::operator[]( uint32 i ) const
   NGL_ASSERT( rc );
   if ( rc )
   {
-    nglString buffer;
     int len = SubLength(i);
-//    nglChar* szbuf = buffer.GetBufferSetLength( len );
-//    memcpy( szbuf, rc->startp[i], len * sizeof(nglChar) );
-//    buffer.ReleaseBuffer();
-    buffer.Import((const char*)rc->startp[i], len, eEncodingInternal);
-    return buffer;
+    i = safeIndex(i);
+    if ( len <= 0 || !rc->startp[i] )
+      return nglString::Empty;
+    return nglString( std::wstring( rc->startp[i], len ) );
   }
   else
   {
@@ -1708,6 +2596,8 @@ nglString regexp::GetReplaceString( const nglChar* sReplaceExp ) const
   }
 
   nglString szReplace;
+  if (!replacelen)
+    return szReplace;
   std::vector<nglChar> tempbuf;
   tempbuf.resize(replacelen);
   buf = &tempbuf[0];
@@ -1747,7 +2637,7 @@ nglString regexp::GetReplaceString( const nglChar* sReplaceExp ) const
   }
 
   //szReplace.ReleaseBuffer( replacelen );
-  szReplace.Import((const char*)buf, replacelen, eEncodingInternal);
+  szReplace = std::wstring(&tempbuf[0], replacelen);
   return szReplace;
 }
 
@@ -0,0 +1,463 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiString8.h"
+
+nuiString8::nuiString8()
+: mpData(mInline), mLength(0), mCapacity(InlineCapacity)
+{
+  mInline[0] = 0;
+}
+
+nuiString8::nuiString8(const char* pUTF8)
+: mpData(mInline), mLength(0), mCapacity(InlineCapacity)
+{
+  mInline[0] = 0;
+  if (pUTF8)
+    Append(pUTF8, (uint32)strlen(pUTF8));
+}
+
+nuiString8::nuiString8(const char* pUTF8, uint32 Length)
+: mpData(mInline), mLength(0), mCapacity(InlineCapacity)
+{
+  mInline[0] = 0;
+  if (pUTF8)
+    Append(pUTF8, Length);
+}
+
+nuiString8::nuiString8(const nglString& rString)
+: mpData(mInline), mLength(0), mCapacity(InlineCapacity)
+{
+  mInline[0] = 0;
+  Append(rString);
+}
+
+nuiString8::nuiString8(const nglChar* pString)
+: mpData(mInline), mLength(0), mCapacity(InlineCapacity)
+{
+  mInline[0] = 0;
+  if (!pString)
+    return;
+  uint32 len = (uint32)wcslen(pString);
+  Grow(GetUTF8Length(pString, len));
+  mLength = (uint32)(EncodeUTF8(pString, len, mpData) - mpData);
+  mpData[mLength] = 0;
+}
+
+nuiString8::nuiString8(const nuiString8& rString)
+: mpData(mInline), mLength(0), mCapacity(InlineCapacity)
+{
+  mInline[0] = 0;
+  Append(rString.mpData, rString.mLength);
+}
+
+nuiString8::~nuiString8()
+{
+  if (mpData != mInline)
+    free(mpData);
+}
+
+nuiString8& nuiString8::operator=(const nuiString8& rString)
+{
+  if (&rString == this)
+    return *this;
+  mLength = 0;
+  return Append(rString.mpData, rString.mLength);
+}
+
+nuiString8& nuiString8::operator=(const char* pUTF8)
+{
+  if (pUTF8 >= mpData && pUTF8 <= mpData + mLength)
+  {
+    // Assigning a part of ourself
+    uint32 len = (uint32)strlen(pUTF8);
+    memmove(mpData, pUTF8, len + 1);
+    mLength = len;
+    return *this;
+  }
+
+  mLength = 0;
+  mpData[0] = 0;
+  if (pUTF8)
+    Append(pUTF8, (uint32)strlen(pUTF8));
+  return *this;
+}
+
+nuiString8& nuiString8::operator=(const nglString& rString)
+{
+  mLength = 0;
+  return Append(rString);
+}
+
+const char* nuiString8::GetChars() const
+{
+  return mpData;
+}
+
+uint32 nuiString8::GetLength() const
+{
+  return mLength;
+}
+
+bool nuiString8::IsEmpty() const
+{
+  return mLength == 0;
+}
+
+char nuiString8::operator[](uint32 Index) const
+{
+  NGL_ASSERT(Index <= mLength);
+  return mpData[Index];
+}
+
+void nuiString8::Clear()
+{
+  mLength = 0;
+  mpData[0] = 0;
+}
+
+void nuiString8::Reserve(uint32 Capacity)
+{
+  Grow(Capacity);
+}
+
+uint32 nuiString8::GetCapacity() const
+{
+  return mCapacity;
+}
+
+void nuiString8::Grow(uint32 Capacity)
+{
+  if (Capacity <= mCapacity)
+    return;
+
+  uint32 newcapacity = mCapacity * 2;
+  if (newcapacity < Capacity)
+    newcapacity = Capacity;
+
+  if (mpData == mInline)
+  {
+    char* pData = (char*)malloc(newcapacity + 1);
+    memcpy(pData, mInline, mLength + 1);
+    mpData = pData;
+  }
+  else
+  {
+    mpData = (char*)realloc(mpData, newcapacity + 1);
+  }
+  mCapacity = newcapacity;
+}
+
+nuiString8& nuiString8::Append(const char* pUTF8, uint32 Length)
+{
+  if (pUTF8 >= mpData && pUTF8 <= mpData + mLength)
+  {
+    // Appending a part of ourself: the buffer may move
+    uint32 offset = (uint32)(pUTF8 - mpData);
+    Grow(mLength + Length);
+    pUTF8 = mpData + offset;
+  }
+  else
+  {
+    Grow(mLength + Length);
+  }
+
+  memmove(mpData + mLength, pUTF8, Length);
+  mLength += Length;
+  mpData[mLength] = 0;
+  return *this;
+}
+
+nuiString8& nuiString8::Append(const char* pUTF8)
+{
+  if (!pUTF8)
+    return *this;
+  return Append(pUTF8, (uint32)strlen(pUTF8));
+}
+
+nuiString8& nuiString8::Append(const nuiString8& rString)
+{
+  return Append(rString.mpData, rString.mLength);
+}
+
+nuiString8& nuiString8::Append(char c)
+{
+  Grow(mLength + 1);
+  mpData[mLength++] = c;
+  mpData[mLength] = 0;
+  return *this;
+}
+
+nuiString8& nuiString8::Append(const nglString& rString)
+{
+  const nglChar* pString = rString.GetChars();
+  uint32 len = rString.GetLength();
+  Grow(mLength + GetUTF8Length(pString, len));
+  mLength = (uint32)(EncodeUTF8(pString, len, mpData + mLength) - mpData);
+  mpData[mLength] = 0;
+  return *this;
+}
+
+nuiString8& nuiString8::operator+=(const nuiString8& rString)
+{
+  return Append(rString);
+}
+
+nuiString8& nuiString8::operator+=(const char* pUTF8)
+{
+  return Append(pUTF8);
+}
+
+nuiString8& nuiString8::operator+=(char c)
+{
+  return Append(c);
+}
+
+nglString nuiString8::ToString() const
+{
+  nglString str;
+  ToString(str);
+  return str;
+}
+
+bool nuiString8::ToString(nglString& rString) const
+{
+  std::wstring str;
+  bool res = DecodeUTF8(mpData, mLength, str);
+  rString = nglString(str);
+  return res;
+}
+
+int32 nuiString8::Compare(const nuiString8& rString) const
+{
+  uint32 len = MIN(mLength, rString.mLength);
+  int res = memcmp(mpData, rString.mpData, len);
+  if (res)
+    return res < 0 ? -1 : 1;
+  if (mLength == rString.mLength)
+    return 0;
+  return mLength < rString.mLength ? -1 : 1;
+}
+
+int32 nuiString8::Compare(const char* pUTF8) const
+{
+  int res = strcmp(mpData, pUTF8 ? pUTF8 : "");
+  if (res)
+    return res < 0 ? -1 : 1;
+  return 0;
+}
+
+bool nuiString8::operator==(const nuiString8& rString) const
+{
+  return mLength == rString.mLength && !memcmp(mpData, rString.mpData, mLength);
+}
+
+bool nuiString8::operator==(const char* pUTF8) const
+{
+  return Compare(pUTF8) == 0;
+}
+
+bool nuiString8::operator!=(const nuiString8& rString) const
+{
+  return !(*this == rString);
+}
+
+bool nuiString8::operator!=(const char* pUTF8) const
+{
+  return Compare(pUTF8) != 0;
+}
+
+bool nuiString8::operator<(const nuiString8& rString) const
+{
+  return Compare(rString) < 0;
+}
+
+uint32 nuiString8::GetHash() const
+{
+  // FNV-1a
+  uint32 hash = 2166136261U;
+  for (uint32 i = 0; i < mLength; i++)
+  {
+    hash ^= (uint8)mpData[i];
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+// UTF-8 codec:
+#define NUI_REPLACEMENT_CHAR 0xfffd
+
+static inline bool IsHighSurrogate(uint32 c)
+{
+  return c >= 0xd800 && c <= 0xdbff;
+}
+
+static inline bool IsLowSurrogate(uint32 c)
+{
+  return c >= 0xdc00 && c <= 0xdfff;
+}
+
+// Return the code point starting at pString[rIndex] and advance rIndex past it. nglChar is UTF-16 on Windows and
+// UTF-32 elsewhere, unpaired surrogates and out of range values give U+FFFD.
+static inline uint32 ReadCodePoint(const nglChar* pString, uint32 Length, uint32& rIndex)
+{
+  uint32 c = (uint32)pString[rIndex++];
+  if (c < 0xd800)
+    return c;
+
+  if (sizeof(nglChar) == 2 && IsHighSurrogate(c) && rIndex < Length && IsLowSurrogate((uint16)pString[rIndex]))
+  {
+    uint32 low = (uint16)pString[rIndex++];
+    return 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+  }
+
+  if (c <= 0xdfff || c > 0x10ffff)
+    return NUI_REPLACEMENT_CHAR;
+  return c;
+}
+
+uint32 nuiString8::GetUTF8Length(const nglChar* pString, uint32 Length)
+{
+  uint32 bytes = 0;
+  uint32 i = 0;
+  while (i < Length)
+  {
+    uint32 c = ReadCodePoint(pString, Length, i);
+    if (c < 0x80)
+      bytes += 1;
+    else if (c < 0x800)
+      bytes += 2;
+    else if (c < 0x10000)
+      bytes += 3;
+    else
+      bytes += 4;
+  }
+  return bytes;
+}
+
+char* nuiString8::EncodeUTF8(const nglChar* pString, uint32 Length, char* pTarget)
+{
+  uint8* pOut = (uint8*)pTarget;
+  uint32 i = 0;
+  while (i < Length)
+  {
+    // ASCII runs are the common case
+    while (i < Length && (uint32)pString[i] < 0x80)
+      *pOut++ = (uint8)pString[i++];
+    if (i == Length)
+      break;
+
+    uint32 c = ReadCodePoint(pString, Length, i);
+    if (c < 0x80)
+    {
+      *pOut++ = (uint8)c;
+    }
+    else if (c < 0x800)
+    {
+      *pOut++ = (uint8)(0xc0 | (c >> 6));
+      *pOut++ = (uint8)(0x80 | (c & 0x3f));
+    }
+    else if (c < 0x10000)
+    {
+      *pOut++ = (uint8)(0xe0 | (c >> 12));
+      *pOut++ = (uint8)(0x80 | ((c >> 6) & 0x3f));
+      *pOut++ = (uint8)(0x80 | (c & 0x3f));
+    }
+    else
+    {
+      *pOut++ = (uint8)(0xf0 | (c >> 18));
+      *pOut++ = (uint8)(0x80 | ((c >> 12) & 0x3f));
+      *pOut++ = (uint8)(0x80 | ((c >> 6) & 0x3f));
+      *pOut++ = (uint8)(0x80 | (c & 0x3f));
+    }
+  }
+  return (char*)pOut;
+}
+
+static inline void AppendCodePoint(std::wstring& rString, uint32 c)
+{
+  if (sizeof(nglChar) == 2 && c >= 0x10000)
+  {
+    c -= 0x10000;
+    rString.push_back((nglChar)(0xd800 + (c >> 10)));
+    rString.push_back((nglChar)(0xdc00 + (c & 0x3ff)));
+  }
+  else
+  {
+    rString.push_back((nglChar)c);
+  }
+}
+
+bool nuiString8::DecodeUTF8(const char* pUTF8, uint32 Length, std::wstring& rString)
+{
+  const uint8* pIn = (const uint8*)pUTF8;
+  const uint8* pEnd = pIn + Length;
+  bool valid = true;
+
+  rString.clear();
+  rString.reserve(Length); // There are never more characters than bytes
+
+  while (pIn < pEnd)
+  {
+    // ASCII runs are the common case
+    while (pIn < pEnd && *pIn < 0x80)
+      rString.push_back((nglChar)*pIn++);
+    if (pIn == pEnd)
+      break;
+
+    uint32 c = *pIn;
+    uint32 count;
+    uint32 min;
+    if (c >= 0xc2 && c <= 0xdf)
+    {
+      count = 1;
+      min = 0x80;
+      c &= 0x1f;
+    }
+    else if (c >= 0xe0 && c <= 0xef)
+    {
+      count = 2;
+      min = 0x800;
+      c &= 0x0f;
+    }
+    else if (c >= 0xf0 && c <= 0xf4)
+    {
+      count = 3;
+      min = 0x10000;
+      c &= 0x07;
+    }
+    else
+    {
+      // Continuation byte without a lead byte, overlong lead byte or out of range
+      valid = false;
+      rString.push_back(NUI_REPLACEMENT_CHAR);
+      pIn++;
+      continue;
+    }
+
+    const uint8* pSeq = pIn + 1;
+    uint32 i;
+    for (i = 0; i < count && pSeq < pEnd && (*pSeq & 0xc0) == 0x80; i++)
+      c = (c << 6) | (*pSeq++ & 0x3f);
+
+    if (i < count || c < min || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+    {
+      // Truncated sequence, overlong form, surrogate or out of range
+      valid = false;
+      rString.push_back(NUI_REPLACEMENT_CHAR);
+      pIn = pSeq; // Skip the lead byte and the continuation bytes that were consumed
+      continue;
+    }
+
+    AppendCodePoint(rString, c);
+    pIn = pSeq;
+  }
+
+  return valid;
+}
+
@@ -45,6 +45,20 @@ nuiLabel::nuiLabel(const nglString& Text, nuiFont* pFont, bool AlreadyAcquired)
   SetFont(pFont, AlreadyAcquired);
 }
 
+nuiLabel::nuiLabel(const nuiString8& Text, nuiTheme::FontStyle FontStyle)
+  : nuiWidget(),
+    mLabelSink(this)
+{
+  InitDefaultValues();
+
+  if (SetObjectClass(_T("nuiLabel")))
+    InitAttributes();
+
+  InitProperties();
+
+  SetFont(FontStyle);
+  SetText(Text.ToString());
+}
 
 nuiLabel::nuiLabel(const nglString& Text, const nglString& rObjectName, nuiTheme::FontStyle FontStyle)
 : nuiWidget(rObjectName), mLabelSink(this)
@@ -504,6 +518,11 @@ nuiRect nuiLabel::GetLayoutRect()
   return mIdealLayoutRect;
 }
 
+void nuiLabel::SetUTF8Text(const nuiString8& Text)
+{
+  SetText(Text.ToString());
+}
+
 void nuiLabel::SetText(const nglString& Text)
 {
   if (GetToolTip() == mText) // Reset the tooltip shown when text is truncated as it's maybe no more usefull
@@ -647,16 +647,366 @@ namespace TEXTURE_PACKER
   };
   
   
+  // MaxRects packer (see Jukka Jylanki, "A Thousand Ways to Pack the Bin").
+  // The free space is kept as a list of maximal (possibly overlapping) rectangles. Textures are placed
+  // biggest first with the bottom-left rule, which keeps the atlas as short as possible for a given width.
+  // As the atlas width is not known in advance, a few candidate widths are tried and the one giving the
+  // most compact result wins. The atlas never grows past maxSize x maxSize: packTextures returns -1 when the
+  // textures don't fit in it.
+  class FreeRect
+  {
+  public:
+    FreeRect(int x,int y,int wid,int hit)
+    {
+      mX = x;
+      mY = y;
+      mWidth = wid;
+      mHeight = hit;
+    }
+
+    bool contains(const FreeRect &r) const
+    {
+      return r.mX >= mX && r.mY >= mY && r.mX + r.mWidth <= mX + mWidth && r.mY + r.mHeight <= mY + mHeight;
+    }
+
+    int mX;
+    int mY;
+    int mWidth;
+    int mHeight;
+  };
+
+  class MaxRectsTexturePacker : public TexturePacker
+  {
+  public:
+    MaxRectsTexturePacker(bool allowRotation, int maxSize)
+    {
+      mAllowRotation = allowRotation;
+      mMaxSize = maxSize;
+      mTextureCount = 0;
+      mTextureIndex = 0;
+      mTextures = 0;
+    }
+
+    virtual ~MaxRectsTexturePacker(void)
+    {
+      reset();
+    }
+
+    void reset(void)
+    {
+      delete []mTextures;
+      mTextures = 0;
+      mTextureCount = 0;
+      mTextureIndex = 0;
+    }
+
+    virtual int getTextureCount(void)
+    {
+      return mTextureIndex;
+    }
+
+    virtual void setTextureCount(int tcount)
+    {
+      reset();
+      mTextureCount = tcount;
+      mTextures = new Texture[tcount];
+    }
+
+    virtual void addTexture(int wid,int hit)
+    {
+      assert( mTextureIndex < mTextureCount );
+      if ( mTextureIndex < mTextureCount )
+      {
+        mTextures[mTextureIndex].set(wid,hit);
+        mTextureIndex++;
+      }
+    }
+
+    virtual bool wouldTextureFit(int wid, int hit,
+                                 bool forcePowerOfTwo,bool onePixelBorder,
+                                 int max_wid, int max_hit)
+    {
+      MaxRectsTexturePacker tp(mAllowRotation, mMaxSize);
+      tp.setTextureCount(getTextureCount() + 1);
+      for (int i = 0; i < getTextureCount(); i++)
+        tp.addTexture(mTextures[i].mWidth, mTextures[i].mHeight);
+      tp.addTexture(wid, hit);
+
+      int new_width = 0, new_height = 0;
+      if ( tp.packTextures(new_width, new_height, forcePowerOfTwo, onePixelBorder) < 0 )
+        return false;
+      return (new_width <= max_wid && new_height <= max_hit);
+    }
+
+    virtual int packTextures(int &width,int &height,bool forcePowerOfTwo,bool onePixelBorder)
+    {
+      width = 0;
+      height = 0;
+      int count = getTextureCount();
+      if ( !count )
+        return 0;
+
+      int border = onePixelBorder ? 2 : 0;
+      int maxSize = forcePowerOfTwo ? prevPow2(mMaxSize) : mMaxSize;
+      int minWidth = 0;
+      int totalArea = 0;
+      for (int i = 0; i < count; i++)
+      {
+        const Texture &t = mTextures[i];
+        int w = t.mWidth + border;
+        int h = t.mHeight + border;
+        if ( w > minWidth )
+          minWidth = w;
+        totalArea += w * h;
+      }
+      if ( minWidth > maxSize )
+        return -1;
+
+      // Place the biggest textures first:
+      std::vector<int> order(count);
+      for (int i = 0; i < count; i++)
+        order[i] = i;
+      std::sort(order.begin(), order.end(), BiggerFirst(mTextures));
+
+      // Candidate atlas widths, the widest one is the last chance to fit textures that are too tall for the others:
+      std::vector<int> widths;
+      if ( forcePowerOfTwo )
+      {
+        int w = nextPow2(minWidth);
+        int maxWidth = std::min(maxSize, nextPow2(std::max(minWidth, (int)sqrt((double)totalArea))) * 2);
+        for (; w <= maxWidth; w *= 2)
+          widths.push_back(w);
+        if ( widths.back() < maxSize )
+          widths.push_back(maxSize);
+      }
+      else
+      {
+        static const double factors[] = { 1.0, 1.1, 1.25, 1.5, 2.0 };
+        double side = sqrt((double)totalArea);
+        widths.push_back(minWidth);
+        for (size_t i = 0; i < sizeof(factors) / sizeof(factors[0]); i++)
+        {
+          int w = (int)ceil(side * factors[i]);
+          if ( w > minWidth && w < maxSize && std::find(widths.begin(), widths.end(), w) == widths.end() )
+            widths.push_back(w);
+        }
+        if ( widths.back() < maxSize )
+          widths.push_back(maxSize);
+      }
+
+      int bestSide = 0x7FFFFFFF;
+      int bestArea = 0x7FFFFFFF;
+      int bestWidth = 0;
+      int bestHeight = 0;
+      std::vector<Texture> best;
+      for (size_t i = 0; i < widths.size(); i++)
+      {
+        int w = widths[i];
+        int h = packStrip(w, maxSize, border, order);
+        if ( h < 0 )
+          continue;
+        if ( forcePowerOfTwo )
+          h = nextPow2(h);
+        // Textures are limited by their biggest side, so favor square-ish atlases, then the smallest area:
+        int side = std::max(w, h);
+        if ( side < bestSide || (side == bestSide && w * h < bestArea) )
+        {
+          bestSide = side;
+          bestArea = w * h;
+          bestWidth = w;
+          bestHeight = h;
+          best.assign(mTextures, mTextures + count);
+        }
+      }
+
+      if ( best.empty() )
+        return -1;
+
+      std::copy(best.begin(), best.end(), mTextures);
+      width = bestWidth;
+      height = bestHeight;
+
+      int used = 0;
+      for (int i = 0; i < count; i++)
+        used += mTextures[i].mArea;
+      return (width * height) - used;
+    }
+
+    virtual bool getTextureLocation(int index,int &x,int &y,int &wid,int &hit)
+    {
+      x = y = wid = hit = 0;
+      assert( index < mTextureCount );
+      if ( index >= mTextureCount )
+        return false;
+
+      const Texture &t = mTextures[index];
+      x = t.mX;
+      y = t.mY;
+      wid = t.mFlipped ? t.mHeight : t.mWidth;
+      hit = t.mFlipped ? t.mWidth : t.mHeight;
+      return t.mFlipped;
+    }
+
+  private:
+    class BiggerFirst
+    {
+    public:
+      BiggerFirst(const Texture *textures) : mTextures(textures) {}
+      bool operator()(int a, int b) const
+      {
+        const Texture &ta = mTextures[a];
+        const Texture &tb = mTextures[b];
+        if ( ta.mLongestEdge != tb.mLongestEdge )
+          return ta.mLongestEdge > tb.mLongestEdge;
+        if ( ta.mArea != tb.mArea )
+          return ta.mArea > tb.mArea;
+        return a < b;
+      }
+      const Texture *mTextures;
+    };
+
+    static int nextPow2(int v)
+    {
+      int p = 1;
+      while ( p < v )
+        p = p*2;
+      return p;
+    }
+
+    static int prevPow2(int v)
+    {
+      int p = 1;
+      while ( p * 2 <= v )
+        p = p*2;
+      return p;
+    }
+
+    // Pack all the textures in a strip of the given size, returns the height actually used or -1 if they don't fit.
+    int packStrip(int width, int maxHeight, int border, const std::vector<int> &order)
+    {
+      mFree.clear();
+      mFree.push_back(FreeRect(0, 0, width, maxHeight));
+      int used = 0;
+
+      for (size_t i = 0; i < order.size(); i++)
+      {
+        Texture &t = mTextures[order[i]];
+        int w = t.mWidth + border;
+        int h = t.mHeight + border;
+
+        int bestY = 0x7FFFFFFF;
+        int bestX = 0x7FFFFFFF;
+        int bestW = 0;
+        int bestH = 0;
+        bool flipped = false;
+
+        for (size_t j = 0; j < mFree.size(); j++)
+        {
+          const FreeRect &f = mFree[j];
+          if ( w <= f.mWidth && h <= f.mHeight )
+          {
+            int top = f.mY + h;
+            if ( top < bestY || (top == bestY && f.mX < bestX) )
+            {
+              bestY = top;
+              bestX = f.mX;
+              bestW = w;
+              bestH = h;
+              flipped = false;
+            }
+          }
+          if ( mAllowRotation && w != h && h <= f.mWidth && w <= f.mHeight )
+          {
+            int top = f.mY + w;
+            if ( top < bestY || (top == bestY && f.mX < bestX) )
+            {
+              bestY = top;
+              bestX = f.mX;
+              bestW = h;
+              bestH = w;
+              flipped = true;
+            }
+          }
+        }
+
+        if ( !bestW )
+          return -1;
+        FreeRect placed(bestX, bestY - bestH, bestW, bestH);
+        t.place(placed.mX + border / 2, placed.mY + border / 2, flipped);
+        if ( bestY > used )
+          used = bestY;
+
+        splitFreeRects(placed);
+      }
+
+      return used;
+    }
+
+    void splitFreeRects(const FreeRect &used)
+    {
+      std::vector<FreeRect> created;
+      size_t i = 0;
+      while ( i < mFree.size() )
+      {
+        FreeRect f = mFree[i];
+        if ( used.mX >= f.mX + f.mWidth || used.mX + used.mWidth <= f.mX ||
+             used.mY >= f.mY + f.mHeight || used.mY + used.mHeight <= f.mY )
+        {
+          i++;
+          continue;
+        }
+
+        if ( used.mX > f.mX )
+          created.push_back(FreeRect(f.mX, f.mY, used.mX - f.mX, f.mHeight));
+        if ( used.mX + used.mWidth < f.mX + f.mWidth )
+          created.push_back(FreeRect(used.mX + used.mWidth, f.mY, f.mX + f.mWidth - used.mX - used.mWidth, f.mHeight));
+        if ( used.mY > f.mY )
+          created.push_back(FreeRect(f.mX, f.mY, f.mWidth, used.mY - f.mY));
+        if ( used.mY + used.mHeight < f.mY + f.mHeight )
+          created.push_back(FreeRect(f.mX, used.mY + used.mHeight, f.mWidth, f.mY + f.mHeight - used.mY - used.mHeight));
+
+        mFree[i] = mFree.back();
+        mFree.pop_back();
+      }
+
+      // The remaining free rects were maximal before, so only the newly created ones need pruning:
+      for (size_t n = 0; n < created.size(); n++)
+      {
+        const FreeRect &c = created[n];
+        bool redundant = false;
+        for (size_t j = 0; j < mFree.size() && !redundant; j++)
+          redundant = mFree[j].contains(c);
+        for (size_t j = 0; j < created.size() && !redundant; j++)
+          redundant = j != n && created[j].contains(c) && (!c.contains(created[j]) || j < n);
+        if ( !redundant )
+          mFree.push_back(c);
+      }
+    }
+
+    bool     mAllowRotation;
+    int      mMaxSize;
+    int      mTextureIndex;
+    int      mTextureCount;
+    Texture *mTextures;
+    std::vector<FreeRect> mFree;
+  };
+
+
   TexturePacker * createTexturePacker(void)
   {
     MyTexturePacker *m = new MyTexturePacker;
     return static_cast< TexturePacker *>(m);
   }
+
+  TexturePacker * createMaxRectsTexturePacker(bool allowRotation, int maxSize)
+  {
+    MaxRectsTexturePacker *m = new MaxRectsTexturePacker(allowRotation, maxSize);
+    return static_cast< TexturePacker *>(m);
+  }
   
   void            releaseTexturePacker(TexturePacker *tp)
   {
-    MyTexturePacker *m = static_cast< MyTexturePacker *>(tp);
-    delete m;
+    delete tp;
   }
   
 }; // end of namepsace
@@ -83,6 +83,7 @@ namespace TEXTURE_PACKER
   class TexturePacker
   {
   public:
+    virtual ~TexturePacker(void) {}
     virtual int   getTextureCount(void) = 0;
     virtual void  setTextureCount(int tcount) = 0; // number of textures to consider..
     virtual void  addTexture(int wid,int hit) = 0; // add textures 0 - n
@@ -99,6 +100,7 @@ namespace TEXTURE_PACKER
   
   
   TexturePacker * createTexturePacker(void);
+  TexturePacker * createMaxRectsTexturePacker(bool allowRotation, int maxSize); // MaxRects (bottom-left rule) packer, tries several atlas widths and keeps the most compact result. packTextures returns -1 if the textures don't fit in a maxSize x maxSize atlas.
   void            releaseTexturePacker(TexturePacker *tp);
   
 }; // end the texture packer namespace
@@ -8,11 +8,272 @@
 #include "nui.h"
 #include "nuiCSV.h"
 
-#define NUICSV_SEPARATION_TAG _T("<nuicsv/>")
 #define NUICSV_COMMENT_TAG _T("<nuicsv_comment/>")
 
 
 
+#define NUICSV_READER_BUFFER_SIZE (64 * 1024)
+
+
+nuiCSVReader::nuiCSVReader(nglIStream* pStream, char Separator, char Quote)
+: mpStream(pStream),
+  mSeparator(Separator),
+  mQuote(Quote),
+  mCommentTag('#'),
+  mTrimSpaces(false),
+  mCommentsEnabled(false),
+  mInputPos(0),
+  mInputSize(0),
+  mComment(false),
+  mLine(1),
+  mRowLine(1)
+{
+  mEncoding = mpStream ? mpStream->GetTextEncoding() : eUTF8;
+  mInput.resize(NUICSV_READER_BUFFER_SIZE);
+
+  // Skip the UTF-8 BOM written by some spreadsheet exporters
+  if (mEncoding == eUTF8 && mpStream)
+  {
+    uint8 bom[3];
+    if (mpStream->Peek(bom, 3, 1) == 3 && bom[0] == 0xEF && bom[1] == 0xBB && bom[2] == 0xBF)
+      mpStream->SetPos(3, eStreamForward);
+  }
+}
+
+nuiCSVReader::~nuiCSVReader()
+{
+}
+
+void nuiCSVReader::SetTrimSpaces(bool Set)
+{
+  mTrimSpaces = Set;
+}
+
+void nuiCSVReader::EnableComments(bool Set, char CommentTag)
+{
+  mCommentsEnabled = Set;
+  mCommentTag = CommentTag;
+}
+
+bool nuiCSVReader::Fill()
+{
+  mInputPos = 0;
+  mInputSize = 0;
+  if (!mpStream)
+    return false;
+
+  int64 read = mpStream->Read(&mInput[0], mInput.size(), 1);
+  if (read > 0)
+    mInputSize = (size_t)read;
+  return mInputSize > 0;
+}
+
+int nuiCSVReader::PeekChar()
+{
+  if (mInputPos >= mInputSize && !Fill())
+    return -1;
+  return (uint8)mInput[mInputPos];
+}
+
+void nuiCSVReader::ReadLineEnding()
+{
+  int c = PeekChar();
+  if (c == '\r')
+  {
+    mInputPos++;
+    if (PeekChar() == '\n')
+      mInputPos++;
+    mLine++;
+  }
+  else if (c == '\n')
+  {
+    mInputPos++;
+    mLine++;
+  }
+}
+
+void nuiCSVReader::TrimCell(size_t Start)
+{
+  size_t end = mRow.size();
+  while (end > Start && (mRow[end - 1] == ' ' || mRow[end - 1] == '\t'))
+    end--;
+  mRow.resize(end);
+}
+
+bool nuiCSVReader::ReadRow()
+{
+  mRow.clear();
+  mCells.clear();
+  mComment = false;
+
+  if (!mError.IsEmpty())
+    return false;
+  if (PeekChar() < 0)
+    return false;
+
+  mRowLine = mLine;
+  mCells.push_back(0);
+
+  if (mCommentsEnabled && mInput[mInputPos] == mCommentTag)
+  {
+    mComment = true;
+    mInputPos++;
+    for (;;)
+    {
+      size_t start = mInputPos;
+      while (mInputPos < mInputSize && mInput[mInputPos] != '\n' && mInput[mInputPos] != '\r')
+        mInputPos++;
+      mRow.insert(mRow.end(), mInput.begin() + start, mInput.begin() + mInputPos);
+      if (mInputPos < mInputSize || !Fill())
+        break;
+    }
+    ReadLineEnding();
+    return true;
+  }
+
+  for (;;)
+  {
+    int c = PeekChar();
+    if (mTrimSpaces)
+    {
+      while (c == ' ' || c == '\t')
+      {
+        mInputPos++;
+        c = PeekChar();
+      }
+    }
+
+    size_t keep = mRow.size();
+    if (c == (uint8)mQuote)
+    {
+      // Quoted cell: copy the runs between the quotes, a doubled quote is an escaped quote
+      mInputPos++;
+      for (;;)
+      {
+        if (mInputPos >= mInputSize && !Fill())
+        {
+          mError.CFormat(_T("nuiCSVReader: unterminated quoted cell starting on line %d"), mRowLine);
+          return false;
+        }
+
+        const char* pStart = &mInput[mInputPos];
+        const char* pQuote = (const char*)memchr(pStart, mQuote, mInputSize - mInputPos);
+        const char* pEnd = pQuote ? pQuote : pStart + (mInputSize - mInputPos);
+        for (const char* p = pStart; p < pEnd; p++)
+        {
+          if (*p == '\n' || (*p == '\r' && (p + 1 == pEnd || p[1] != '\n')))
+            mLine++;
+        }
+        mRow.insert(mRow.end(), pStart, pEnd);
+        mInputPos += pEnd - pStart;
+
+        if (!pQuote)
+          continue;
+
+        mInputPos++;
+        if (PeekChar() != (uint8)mQuote)
+          break;
+        mRow.push_back(mQuote);
+        mInputPos++;
+      }
+      keep = mRow.size();
+    }
+
+    // Unquoted cell, or garbage after a closing quote which is kept as is
+    for (;;)
+    {
+      size_t start = mInputPos;
+      while (mInputPos < mInputSize)
+      {
+        char ch = mInput[mInputPos];
+        if (ch == mSeparator || ch == '\n' || ch == '\r')
+          break;
+        mInputPos++;
+      }
+      mRow.insert(mRow.end(), mInput.begin() + start, mInput.begin() + mInputPos);
+      if (mInputPos < mInputSize || !Fill())
+        break;
+    }
+
+    if (mTrimSpaces)
+      TrimCell(keep);
+
+    if (PeekChar() == (uint8)mSeparator)
+    {
+      mInputPos++;
+      mCells.push_back(mRow.size());
+      continue;
+    }
+
+    ReadLineEnding();
+    return true;
+  }
+}
+
+int64 nuiCSVReader::ReadRows(const RowDelegate& rDelegate)
+{
+  int64 count = 0;
+  while (ReadRow())
+  {
+    count++;
+    if (rDelegate && !rDelegate(*this))
+      break;
+  }
+  return count;
+}
+
+uint32 nuiCSVReader::GetCellCount() const
+{
+  return mCells.size();
+}
+
+const char* nuiCSVReader::GetCell(uint32 Index, uint32& rLength) const
+{
+  if (Index >= mCells.size())
+  {
+    rLength = 0;
+    return NULL;
+  }
+
+  uint32 start = mCells[Index];
+  uint32 end = (Index + 1 < mCells.size()) ? mCells[Index + 1] : mRow.size();
+  rLength = end - start;
+  return mRow.empty() ? "" : &mRow[0] + start;
+}
+
+nglString nuiCSVReader::GetCellString(uint32 Index) const
+{
+  uint32 length;
+  const char* pCell = GetCell(Index, length);
+  if (!pCell || !length)
+    return nglString::Empty;
+  return nglString(pCell, length, mEncoding);
+}
+
+void nuiCSVReader::GetRow(std::vector<nglString>& rCells) const
+{
+  rCells.resize(mCells.size());
+  for (uint32 i = 0; i < mCells.size(); i++)
+    rCells[i] = GetCellString(i);
+}
+
+bool nuiCSVReader::IsComment() const
+{
+  return mComment;
+}
+
+uint32 nuiCSVReader::GetLineNumber() const
+{
+  return mRowLine;
+}
+
+const nglString& nuiCSVReader::GetError() const
+{
+  return mError;
+}
+
+
+
 nuiCSV::nuiCSV(nglChar separationChar)
 {
   mSeparationChar = separationChar;
@@ -44,6 +305,12 @@ bool nuiCSV::Load(nglIStream* pStream, bool CheckNbColumns)
   }
   
   
+  if (mSeparationChar > 0x7f || (mCommentsEnabled && mCommentTag > 0x7f))
+  {
+    NGL_OUT(_T("nuiCSV::Load error : the separation and comment chars must be ASCII!\n"));
+    return false;
+  }
+  
   pStream->SetTextFormat(eTextDOS);
   pStream->SetTextEncoding(eUTF8);
 
@@ -51,84 +318,31 @@ bool nuiCSV::Load(nglIStream* pStream, bool CheckNbColumns)
   // reset the document
   mDocument.clear();
 
+  nuiCSVReader reader(pStream, (char)mSeparationChar);
+  reader.SetTrimSpaces(true);
+  reader.EnableComments(mCommentsEnabled, (char)mCommentTag);
 
-  nglString line;
-  nglString separationString(mSeparationChar);
   std::vector<nglString> tokens;
-  uint32 numlines = 0;
   uint32 numcols = 0;
 
-
-  // for each line from input stream
-  while (pStream->ReadLine(line, NULL))
+  // for each row from input stream
+  while (reader.ReadRow())
   {
-    //NGL_OUT(_T("%3d ReadLine: %ls\n"), numlines, line.GetChars());
-    numlines++;
-    
     // first, handle the comment lines, if the comment option has been enabled
-    if (mCommentsEnabled && (line.GetChar(0) == mCommentTag))
+    if (reader.IsComment())
     {
-      line.DeleteLeft(1);
-      InsertComment(line);
+      InsertComment(reader.GetCellString(0));
       continue;
     }
     
-    // now, handle the usual text lines : 
-    //
-    // first of all, look for the separation chars that would be between ["..."] : they are not separation chars, they're part of the text
-    // => replace'em with a special tag, in order to let the tokenization process correctly
-    int32 pos1=0;
-    int32 pos2,pos3,tmppos;
-    while ((pos2 = line.Find(_T('\"'), pos1)) >= 0)
-    {
-    
-      // if it's a double '""', it'a part of the text, don't do anything
-      if (line.GetChar(pos2+1) == _T('\"'))
-      {
-        pos1 = pos2+1;
-        continue;
-      }
-      
-      // it'a single '"'. look for the closing occurence
-      pos3 = line.Find(_T('\"'), pos2+1);
-      if (pos3 < 0)
-      {
-        NGL_OUT(_T("nuiCSV syntax error : a '\"' char is missing on line %d!\n"), numlines);
-        return false;
-      }
-      // but don't be fooled by the double '""' (it's a part from the text)
-      while (line.GetChar(pos3+1) == _T('\"'))
-      {
-        pos3 = line.Find(_T('\"'), pos3+1);
-      }
-      if (pos3 < 0)
-      {
-        NGL_OUT(_T("nuiCSV syntax error : a '\"' char is missing on line %d!\n"), numlines);
-        return false;
-      }
-      
-      
-      // now [pos2 - pos3] matches '" ... "'. look for the separation chars inside this range and replace'em with the special tag
-      while ((tmppos = line.Find(mSeparationChar, pos2, pos3)) >= 0)
-      {
-        line.Replace(tmppos, 1, NUICSV_SEPARATION_TAG);
-        pos3 += nglString(NUICSV_SEPARATION_TAG).GetLength();
-        pos2 = tmppos;
-      }
-      
-      // offset for the next cycle
-      pos1 = pos3+1;
-    }
-    
-    
-    //
-    // ok, we can now tokenize the line, without making mistakes
-    //
-    tokens.clear();
-    line.Tokenize(tokens, mSeparationChar, true);
-    
+    // skip the blank lines
+    uint32 length;
+    if (reader.GetCellCount() == 1 && reader.GetCell(0, length) && !length)
+      continue;
+
     // check number of columns
-    uint32 nbcols = tokens.size();
+    uint32 nbcols = reader.GetCellCount();
+    uint32 numlines = reader.GetLineNumber();
     if (CheckNbColumns)
     {
       if (nbcols < numcols)
@@ -147,37 +361,16 @@ bool nuiCSV::Load(nglIStream* pStream, bool CheckNbColumns)
       }
     }
     
-    // for all columns,
-    // remove useless whitespaces,
-    // remove '"' from begin and end, unless it's a double '""'
-    for (uint i=0; i < nbcols; i++)
-    {
-      tokens[i].Trim();
-      //uint32 length = strlen(tokens[i].GetStdString().c_str());
-      uint32 length = tokens[i].GetLength();
-      if ((tokens[i].GetChar(0) == _T('\"')) && (tokens[i].GetChar(1) != _T('\"')))
-      {
-        if ((tokens[i].GetChar(length-1) == _T('\"')) && (tokens[i].GetChar(length-2) != _T('\"')))
-        {
-          tokens[i].DeleteLeft(1);
-          tokens[i].DeleteRight(1);
-        }
-      }
-      
-      // finally, replace all double '""' by single '"'
-      tokens[i].Replace(_T("\"\""), _T("\""));
-      
-      // and replace nuicsv special tag by the separation char (once again, here, it's not a separation char, it's a part from the text)
-      tokens[i].Replace(NUICSV_SEPARATION_TAG, separationString);
-    }   
-    
     // now we can add this line to the document
+    reader.GetRow(tokens);
     InsertLine(tokens);
-    
-    if (pStream->GetState() != eStreamReady)
-      return true;
   }
    
+  if (!reader.GetError().IsEmpty())
+  {
+    NGL_OUT(_T("nuiCSV syntax error : %ls!\n"), reader.GetError().GetChars());
+    return false;
+  }
   
   return true;
 }
@@ -0,0 +1,309 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "nuiMemoryTracker.h"
+
+#ifndef _WIN32_
+#include <pthread.h>
+#endif
+
+#define NUI_MEMORY_REPORT_ENV "NUI_MEMORY_REPORT"
+
+// The pending counters of a thread are merged with the totals once they reach these values:
+#define NUI_MEMORY_FLUSH_BYTES (64 * 1024)
+#define NUI_MEMORY_FLUSH_COUNT 256
+
+//class nuiMemoryTracker::Thread
+/// Changes that a thread didn't merge with the totals yet. Only its thread writes to it.
+class nuiMemoryTracker::Thread
+{
+public:
+  Thread()
+  {
+    for (uint32 i = 0; i < NUI_MEMORY_MAX_TAGS; i++)
+    {
+      mPendingBytes[i] = 0;
+      mPendingCount[i] = 0;
+    }
+  }
+
+  volatile int32 mPendingBytes[NUI_MEMORY_MAX_TAGS];
+  volatile int32 mPendingCount[NUI_MEMORY_MAX_TAGS];
+};
+
+
+//class nuiMemoryTracker
+nglCriticalSection nuiMemoryTracker::mCS(_T("nuiMemoryTracker"));
+std::vector<nuiMemoryTracker::Thread*> nuiMemoryTracker::mpThreads;
+const char* nuiMemoryTracker::mpTagNames[NUI_MEMORY_MAX_TAGS] = { "Textures", "Surfaces", "Glyph caches", "Render caches", "XML" };
+uint32 nuiMemoryTracker::mTagCount = eMemoryUserTag;
+nuiMemoryTracker::Stats nuiMemoryTracker::mStats[NUI_MEMORY_MAX_TAGS];
+volatile bool nuiMemoryTracker::mLeakTracking = false;
+std::map<std::pair<uint32, const void*>, nuiMemoryTracker::Allocation> nuiMemoryTracker::mAllocations;
+
+#ifdef _WIN32_
+static DWORD gMemoryTrackerTLS = TlsAlloc();
+#else
+static pthread_key_t gMemoryTrackerTLS;
+static pthread_once_t gMemoryTrackerTLSOnce = PTHREAD_ONCE_INIT;
+
+static void CreateMemoryTrackerTLS()
+{
+  pthread_key_create(&gMemoryTrackerTLS, NULL);
+}
+#endif
+
+nuiMemoryTracker::Thread* nuiMemoryTracker::GetThread()
+{
+#ifdef _WIN32_
+  Thread* pThread = (Thread*)TlsGetValue(gMemoryTrackerTLS);
+#else
+  pthread_once(&gMemoryTrackerTLSOnce, CreateMemoryTrackerTLS);
+  Thread* pThread = (Thread*)pthread_getspecific(gMemoryTrackerTLS);
+#endif
+  if (pThread)
+    return pThread;
+
+  pThread = new Thread();
+  {
+    nglCriticalSectionGuard guard(mCS);
+    mpThreads.push_back(pThread);
+  }
+
+#ifdef _WIN32_
+  TlsSetValue(gMemoryTrackerTLS, pThread);
+#else
+  pthread_setspecific(gMemoryTrackerTLS, pThread);
+#endif
+  return pThread;
+}
+
+uint32 nuiMemoryTracker::RegisterTag(const char* pName)
+{
+  nglCriticalSectionGuard guard(mCS);
+  if (mTagCount == NUI_MEMORY_MAX_TAGS)
+  {
+    NGL_ASSERT(!"Too many memory tags");
+    return NUI_MEMORY_MAX_TAGS;
+  }
+  mpTagNames[mTagCount] = pName;
+  return mTagCount++;
+}
+
+uint32 nuiMemoryTracker::GetTagCount()
+{
+  return mTagCount;
+}
+
+const char* nuiMemoryTracker::GetTagName(uint32 Tag)
+{
+  if (Tag >= mTagCount)
+    return NULL;
+  return mpTagNames[Tag];
+}
+
+void nuiMemoryTracker::Account(uint32 Tag, int64 Bytes, int32 Count)
+{
+  if (Tag >= NUI_MEMORY_MAX_TAGS)
+    return;
+
+  Thread* pThread = GetThread();
+  int64 bytes = pThread->mPendingBytes[Tag] + Bytes;
+  int32 count = pThread->mPendingCount[Tag] + Count;
+  if (bytes < NUI_MEMORY_FLUSH_BYTES && bytes > -NUI_MEMORY_FLUSH_BYTES && count < NUI_MEMORY_FLUSH_COUNT && count > -NUI_MEMORY_FLUSH_COUNT)
+  {
+    pThread->mPendingBytes[Tag] = (int32)bytes;
+    pThread->mPendingCount[Tag] = count;
+    return;
+  }
+
+  nglCriticalSectionGuard guard(mCS);
+  Stats& rStats(mStats[Tag]);
+  rStats.mBytes += bytes;
+  rStats.mCount += count;
+  rStats.mPeakBytes = MAX(rStats.mPeakBytes, rStats.mBytes);
+  pThread->mPendingBytes[Tag] = 0;
+  pThread->mPendingCount[Tag] = 0;
+}
+
+void nuiMemoryTracker::Add(uint32 Tag, const void* pPointer, int64 Bytes, const char* pSite)
+{
+  Account(Tag, Bytes, 1);
+
+  if (mLeakTracking)
+  {
+    nglCriticalSectionGuard guard(mCS);
+    Allocation& rAllocation(mAllocations[std::make_pair(Tag, pPointer)]);
+    rAllocation.mBytes = Bytes;
+    rAllocation.mpSite = pSite;
+  }
+}
+
+void nuiMemoryTracker::Resize(uint32 Tag, const void* pPointer, int64 OldBytes, int64 NewBytes)
+{
+  Account(Tag, NewBytes - OldBytes, 0);
+
+  if (mLeakTracking)
+  {
+    nglCriticalSectionGuard guard(mCS);
+    std::map<std::pair<uint32, const void*>, Allocation>::iterator it = mAllocations.find(std::make_pair(Tag, pPointer));
+    if (it != mAllocations.end())
+      it->second.mBytes = NewBytes;
+  }
+}
+
+void nuiMemoryTracker::Remove(uint32 Tag, const void* pPointer, int64 Bytes)
+{
+  Account(Tag, -Bytes, -1);
+
+  if (mLeakTracking)
+  {
+    nglCriticalSectionGuard guard(mCS);
+    mAllocations.erase(std::make_pair(Tag, pPointer));
+  }
+}
+
+void nuiMemoryTracker::GetStats(uint32 Tag, Stats& rStats)
+{
+  rStats.mBytes = 0;
+  rStats.mCount = 0;
+  rStats.mPeakBytes = 0;
+  if (Tag >= NUI_MEMORY_MAX_TAGS)
+    return;
+
+  nglCriticalSectionGuard guard(mCS);
+  rStats = mStats[Tag];
+  for (size_t i = 0; i < mpThreads.size(); i++)
+  {
+    rStats.mBytes += mpThreads[i]->mPendingBytes[Tag];
+    rStats.mCount += mpThreads[i]->mPendingCount[Tag];
+  }
+  rStats.mPeakBytes = MAX(rStats.mPeakBytes, rStats.mBytes);
+  mStats[Tag].mPeakBytes = rStats.mPeakBytes;
+}
+
+void nuiMemoryTracker::ResetPeaks()
+{
+  nglCriticalSectionGuard guard(mCS);
+  for (uint32 i = 0; i < NUI_MEMORY_MAX_TAGS; i++)
+  {
+    Stats stats;
+    GetStats(i, stats);
+    mStats[i].mPeakBytes = stats.mBytes;
+  }
+}
+
+void nuiMemoryTracker::EnableLeakTracking(bool Set)
+{
+  nglCriticalSectionGuard guard(mCS);
+  mLeakTracking = Set;
+  if (!Set)
+    mAllocations.clear();
+}
+
+bool nuiMemoryTracker::IsLeakTrackingEnabled()
+{
+  return mLeakTracking;
+}
+
+class nuiMemorySite
+{
+public:
+  uint32 mTag;
+  const char* mpSite;
+  int64 mBytes;
+  int64 mCount;
+
+  bool operator<(const nuiMemorySite& rSite) const
+  {
+    if (mTag != rSite.mTag)
+      return mTag < rSite.mTag;
+    return mBytes > rSite.mBytes;
+  }
+};
+
+nglString nuiMemoryTracker::GetLeakReport()
+{
+  nglCriticalSectionGuard guard(mCS);
+  nglString report;
+  nglString line;
+
+  report.Add(_T("Memory by tag (bytes / allocations / peak bytes):\n"));
+  for (uint32 i = 0; i < mTagCount; i++)
+  {
+    Stats stats;
+    GetStats(i, stats);
+    line.CFormat(_T("  %-16ls %12lld %8lld %12lld\n"), nglString(mpTagNames[i]).GetChars(), stats.mBytes, stats.mCount, stats.mPeakBytes);
+    report.Add(line);
+  }
+
+  if (!mLeakTracking)
+    return report;
+
+  // Group the allocations that are still alive by tag and site, the largest sites first:
+  std::map<std::pair<uint32, const char*>, size_t> indices;
+  std::vector<nuiMemorySite> sites;
+  std::map<std::pair<uint32, const void*>, Allocation>::const_iterator it = mAllocations.begin();
+  std::map<std::pair<uint32, const void*>, Allocation>::const_iterator end = mAllocations.end();
+  for (; it != end; ++it)
+  {
+    std::pair<uint32, const char*> key(it->first.first, it->second.mpSite);
+    std::map<std::pair<uint32, const char*>, size_t>::iterator index = indices.find(key);
+    if (index == indices.end())
+    {
+      nuiMemorySite site;
+      site.mTag = key.first;
+      site.mpSite = key.second;
+      site.mBytes = 0;
+      site.mCount = 0;
+      index = indices.insert(std::make_pair(key, sites.size())).first;
+      sites.push_back(site);
+    }
+    sites[index->second].mBytes += it->second.mBytes;
+    sites[index->second].mCount++;
+  }
+  std::sort(sites.begin(), sites.end());
+
+  line.CFormat(_T("Allocations still alive (%d sites):\n"), (int32)sites.size());
+  report.Add(line);
+  for (size_t i = 0; i < sites.size(); i++)
+  {
+    const nuiMemorySite& rSite(sites[i]);
+    nglString site(rSite.mpSite ? rSite.mpSite : "unknown site");
+    line.CFormat(_T("  %-16ls %12lld bytes in %6lld allocations at %ls\n"), nglString(mpTagNames[rSite.mTag]).GetChars(), rSite.mBytes, rSite.mCount, site.GetChars());
+    report.Add(line);
+  }
+
+  return report;
+}
+
+void nuiMemoryTracker::Init()
+{
+  if (getenv(NUI_MEMORY_REPORT_ENV))
+    EnableLeakTracking(true);
+}
+
+void nuiMemoryTracker::Exit()
+{
+  const char* pPath = getenv(NUI_MEMORY_REPORT_ENV);
+  if (!pPath || !*pPath)
+    return;
+
+  nglString report(GetLeakReport());
+  if (!strcmp(pPath, "-"))
+  {
+    NGL_OUT(_T("%ls"), report.GetChars());
+    return;
+  }
+
+  nglPath path((nglString(pPath)));
+  nglOFile file(path, eOFileCreate);
+  std::string text(report.GetStdString());
+  if (!file.IsOpen() || file.Write(text.c_str(), (int64)text.size(), 1) != (int64)text.size())
+    NGL_LOG(_T("nuiMemoryTracker"), NGL_LOG_ERROR, _T("Unable to write the memory report to '%ls'\n"), path.GetPathName().GetChars());
+}
@@ -18,8 +18,18 @@ nuiParser::nuiParser(nglIStream* pStream, const nglPath& rSourcePath)
   if (mSourcePath.IsLeaf())
     mSourcePath = mSourcePath.GetParent();
   mChar = _T(' ');
-  mColumn = 1;
   mLine = 1;
+  mLineStart = 0;
+  mLastCR = false;
+  mEnableCppComments = true;
+  mError = false;
+
+  mBuffer.resize(NUI_PARSER_BUFFER_SIZE);
+  mBufferPos = 0;
+  mBufferSize = 0;
+  mBufferOffset = 0;
+  mEndOfStream = false;
+  memset(mASCIIClasses, 0, sizeof(mASCIIClasses));
   
   SetValidInValue(_T("!@#$%<>*?'+-&~|[]{}\().,"));
   SetValidInSymbolStart(_T("abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_"));
@@ -27,6 +37,10 @@ nuiParser::nuiParser(nglIStream* pStream, const nglPath& rSourcePath)
   SetValidInBlank(_T(" \t\r\n"));
 }
 
+nuiParser::~nuiParser()
+{
+}
+
 int32 nuiParser::GetLine() const
 {
   return mLine;
@@ -34,7 +48,7 @@ int32 nuiParser::GetLine() const
 
 int32 nuiParser::GetColumn() const
 {
-  return mColumn;
+  return (int32)(mBufferOffset + mBufferPos - mLineStart);
 }
 
 const nglString& nuiParser::GetErrorStr() const
@@ -42,98 +56,149 @@ const nglString& nuiParser::GetErrorStr() const
   return mErrorString;
 }
 
+bool nuiParser::Fill(uint32 Needed)
+{
+  uint32 available = mBufferSize - mBufferPos;
+  if (available >= Needed || mEndOfStream)
+    return available > 0;
+
+  // Move the unread bytes to the front of the buffer and read the next chunk after them:
+  if (mBufferPos)
+  {
+    if (available)
+      memmove(&mBuffer[0], &mBuffer[mBufferPos], available);
+    mBufferOffset += mBufferPos;
+    mBufferPos = 0;
+    mBufferSize = available;
+  }
+  
+  if (mBuffer.size() < Needed)
+    mBuffer.resize(Needed);
+  
+  while (mBufferSize < Needed && !mEndOfStream)
+  {
+    int64 read = mpStream->Read(&mBuffer[mBufferSize], mBuffer.size() - mBufferSize, 1);
+    if (read <= 0)
+      mEndOfStream = true;
+    else
+      mBufferSize += (uint32)read;
+  }
+  
+  return mBufferSize > 0;
+}
+
+void nuiParser::SaveState(State& rState) const
+{
+  rState.mBufferPos = mBufferPos;
+  rState.mLine = mLine;
+  rState.mLineStart = mLineStart;
+  rState.mLastCR = mLastCR;
+}
+
+void nuiParser::RestoreState(const State& rState)
+{
+  mBufferPos = rState.mBufferPos;
+  mLine = rState.mLine;
+  mLineStart = rState.mLineStart;
+  mLastCR = rState.mLastCR;
+}
+
 bool nuiParser::PeekChar()
 {
-  nglFileOffset ofs = mpStream->GetPos();
+  // Make sure the buffer won't move while peeking:
+  Fill(6);
+  State state;
+  SaveState(state);
   bool res = NextChar();
-  mpStream->SetPos(ofs);
+  RestoreState(state);
   return res;
 }
 
 bool nuiParser::PeekString(uint32 len, nglString& rResult)
 {
-  nglFileOffset ofs = mpStream->GetPos();
+  Fill(len * 6);
+  State state;
+  SaveState(state);
+  nglChar c = mChar;
   rResult.Wipe();
   while (len && NextChar())
   {
     rResult.Add(GetChar());
     len--;
   }
-  mpStream->SetPos(ofs);
+  RestoreState(state);
+  mChar = c;
   return !len;
 }
 
 
 bool nuiParser::IsDone() const
 {
-  return mpStream->GetState() != eStreamReady;
+  return (mBufferPos >= mBufferSize) && (mEndOfStream || mpStream->GetState() != eStreamReady);
 }
 
-bool nuiParser::NextChar()
+void nuiParser::CountLine(uint8 c)
+{
+  // \r\n is a single line break:
+  if (c != 0xa || !mLastCR)
+    mLine++;
+  mLastCR = (c == 0xd);
+  mLineStart = mBufferOffset + mBufferPos;
+}
+
+bool nuiParser::NextMultiByteChar()
 {
-  nglChar previous = mChar;
   // Parse an utf-8 char sequence:
-  uint8 c = 0;
-  if (1 != mpStream->ReadUInt8(&c, 1))
+  Fill(6);
+  uint8 c = mBuffer[mBufferPos++];
+  mLastCR = false;
+
+  //  0xC0 // 2 bytes
+  //  0xE0 // 3
+  //  0xF0 // 4
+  //  0xF8 // 5
+  //  0xFC // 6
+  uint32 count = 0;
+  if ((c & 0xFE) == 0xFC)
   {
-    mChar = 0;
-    return false;
+    mChar = c & 0x01;
+    count = 5;
   }
-  if (!(c & 0x80))
+  else if ((c & 0xFC) == 0xF8)
   {
-    mChar = c;
+    mChar = c & 0x03;
+    count = 4;
+  }
+  else if ((c & 0xF8) == 0xF0)
+  {
+    mChar = c & 0x07;
+    count = 3;
+  }
+  else if ((c & 0xF0) == 0xE0)
+  {
+    mChar = c & 0x0F;
+    count = 2;
+  }
+  else if ((c & 0xE0) == 0xC0)
+  {
+    mChar = c & 0x1F;
+    count = 1;
   }
   else
   {
-    //  0xC0 // 2 bytes
-    //  0xE0 // 3
-    //  0xF0 // 4
-    //  0xF8 // 5
-    //  0xFC // 6
-    uint32 count = 0;
-    if (c & 0xFC == 0xFC)
-    {
-      mChar = c & ~0xFC;
-      count = 5;
-    }
-    else if (c & 0xF8 == 0xF8)
-    {
-      mChar = c & ~0xF8;
-      count = 4;
-    }
-    else if (c & 0xF0 == 0xF0)
-    {
-      mChar = c & ~0xF0;
-      count = 3;
-    }
-    else if (c & 0xE0 == 0xE0)
-    {
-      mChar = c & ~0xE0;
-      count = 2;
-    }
-    else if (c & 0xC0 == 0xC0)
-    {
-      mChar = c & ~0xC0;
-      count = 1;
-    }
-    
-    for (uint32 i = 0; i < count; i++)
-    {
-      if (1 != mpStream->ReadUInt8(&c, 1))
-        return false;
-      mChar <<= 6;
-      mChar |= c & 0x3F;
-    }
+    // Stray continuation byte, keep it as is
+    mChar = c;
   }
   
-  if ((mChar == 0xa && previous != 0xd) || (mChar == 0xd && previous != 0xa) )
+  for (uint32 i = 0; i < count; i++)
   {
-    mColumn = 1;
-    mLine++;
+    if (mBufferPos >= mBufferSize)
+      return false;
+    c = mBuffer[mBufferPos++];
+    mChar <<= 6;
+    mChar |= c & 0x3F;
   }
   
-  //wprintf(_T("%lc"), mChar);
-  
   return true;
 }
 
@@ -142,9 +207,43 @@ nglChar nuiParser::GetChar() const
   return mChar;
 }
 
+bool nuiParser::ScanASCII(uint8 Class, std::vector<nglChar>* pAccumulator)
+{
+  for (;;)
+  {
+    uint32 pos = mBufferPos;
+    uint32 size = mBufferSize;
+    const uint8* pBuffer = &mBuffer[0];
+    while (pos < size)
+    {
+      uint8 c = pBuffer[pos];
+      if ((c & 0x80) || !(mASCIIClasses[c] & Class))
+        break;
+      pos++;
+      if (pAccumulator)
+        pAccumulator->push_back(c);
+      if (c == 0xa || c == 0xd)
+      {
+        mBufferPos = pos;
+        CountLine(c);
+      }
+      else
+      {
+        mLastCR = false;
+      }
+    }
+    mBufferPos = pos;
+    
+    if (pos < size || !Fill(1))
+      break;
+  }
+  
+  return NextChar();
+}
+
 bool nuiParser::IsBlank(nglChar c) const
 {
-  return mBlanks.find(c) != mBlanks.end();
+  return HasClass(c, eBlank, mBlanks);
 }
 
 bool nuiParser::SkipBlank()
@@ -163,93 +262,119 @@ bool nuiParser::SkipBlank()
       {
         res = NextChar();
         // Skip to the end of the line:
-        res = NextChar();
-        while (res && mChar != 0xa && mChar != 0xd)
-        {
-          res = NextChar();
-        }
+        res = SkipToNextLine();
       }
+      
+      res = NextChar();
+    }
+    else
+    {
+      // Consume the blank run and load the next char:
+      res = ScanASCII(eBlank, NULL);
     }
-    
-    res = NextChar();
   }
   return res;
 }
 
 bool nuiParser::SkipToNextLine()
 {
-  bool res = NextChar();
-  if (!res)
-    return false;
-  // Skip to the end of the line:
-  while (res && mChar != 0xa && mChar != 0xd)
-    res = NextChar();
-  return res;
+  // Skip to the end of the line, the line break itself is the new current char:
+  for (;;)
+  {
+    uint32 pos = mBufferPos;
+    while (pos < mBufferSize)
+    {
+      uint8 c = mBuffer[pos];
+      if (c == 0xa || c == 0xd)
+      {
+        if (pos != mBufferPos)
+          mLastCR = false;
+        mBufferPos = pos;
+        return NextChar();
+      }
+      pos++;
+    }
+    mBufferPos = pos;
+    mLastCR = false;
+    
+    if (!Fill(1))
+    {
+      mChar = 0;
+      return false;
+    }
+  }
 }
 
 
 bool nuiParser::GetQuoted(nglString& rResult)
 {
+  mAccumulator.clear();
+  rResult.Nullify();
   if (!SkipBlank())
     return false;
   
   if (mChar != _T('\"'))
     return false;
   
-  while (GetChar() && mChar != _T('\"'))
+  while (NextChar() && mChar != _T('\"'))
   {
     if (mChar == _T('\\'))
     {
-      if (!GetChar())
-        return false;
-      
-      if (mChar != _T('\"'))
+      if (!NextChar() || mChar != _T('\"'))
+      {
+        if (!mAccumulator.empty())
+          rResult.Copy(&mAccumulator[0], mAccumulator.size());
         return false;
-      
+      }
     }
     
-    rResult.Add(mChar);
+    mAccumulator.push_back(mChar);
   }
   
   NextChar();
+  if (!mAccumulator.empty())
+    rResult.Copy(&mAccumulator[0], mAccumulator.size());
   return true;
 }
 
 bool nuiParser::GetSymbol(nglString& rResult)
 {
+  mAccumulator.clear();
   rResult.Nullify();
   if (!SkipBlank())
     return false;
   
   if (!IsValidInSymbolStart(mChar))
     return false;
-  rResult.Add(mChar);
-  
-  if (!NextChar())
-    return false;
-  
-  while (IsValidInSymbol(mChar))
+
+  bool res = true;
+  while (res && IsValidInSymbol(mChar))
   {
-    rResult.Add(mChar);
-    if (!NextChar())
-      return false;
+    mAccumulator.push_back(mChar);
+    res = ScanASCII(eSymbol, &mAccumulator);
   }
   
-  return !rResult.IsEmpty();
+  rResult.Copy(&mAccumulator[0], mAccumulator.size());
+  return res;
 }
 
 bool nuiParser::GetValue(nglString& rResult, bool AllowBlank)
 {
+  mAccumulator.clear();
   rResult.Nullify();
   if (!SkipBlank())
     return false;
   
+  uint8 classes = AllowBlank ? (eValue | eBlank) : eValue;
   while ((AllowBlank && IsBlank(mChar)) || IsValidInValue(mChar))
   {
-    rResult.Add(mChar);
-    NextChar();
+    mAccumulator.push_back(mChar);
+    if (!ScanASCII(classes, &mAccumulator))
+      break;
   }
   
+  if (!mAccumulator.empty())
+    rResult.Copy(&mAccumulator[0], mAccumulator.size());
   return true;
 }
 
@@ -271,63 +396,55 @@ bool nuiParser::GetFloat(double& rResult)
 {
   bool neg = false;
   double value = 0;
-  //  bool dotfound = false;
+  bool res = true;
   
-  if (mChar == '-')
+  if (mChar == '-' || mChar == '+')
   {
-    neg = true;
+    neg = (mChar == '-');
     if (!NextChar())
       return false;
   }
   
   uint8 c = 0;
-  if (!GetNumberDigit(c, mChar, 10))
-    return false;
-  while (mChar && c <= 9)
+  bool digits = false;
+  while (res && GetNumberDigit(c, mChar, 10))
   {
     value = value * 10 + c;
-    if (!NextChar())
-      return false;
-    if (!GetNumberDigit(c, mChar, 10))
-      return false;
+    digits = true;
+    res = NextChar();
   }
   
   // Read decimal dot:
-  if (mChar == '.')
+  if (res && mChar == '.')
   {
-    if (!NextChar())
-      return false;
     double count = 1, v = 0;
-    if (!GetNumberDigit(c, mChar, 10))
-      return false;
-    while (mChar && c <= 9) // Read decimal part:
+    res = NextChar();
+    while (res && GetNumberDigit(c, mChar, 10)) // Read decimal part:
     {
       v = v * 10 + c;
       count *= 10;
-      if (!NextChar())
-        return false;
-      if (!GetNumberDigit(c, mChar, 10))
-        return false;
+      digits = true;
+      res = NextChar();
     }
     
-    if (count)
-    {
-      value += v / count;
-    }
+    value += v / count;
   }
   
-  if (mChar == 'e' || mChar == 'E')
+  if (!digits)
+    return false;
+  
+  if (res && (mChar == 'e' || mChar == 'E'))
   {
     if (!NextChar())
       return false;
-    int32 exponent;
+    int64 exponent;
     if (!GetInteger(exponent, 10))
       return false;
-    value *= pow(10.0, exponent);
+    value *= pow(10.0, (double)exponent);
   }
   
-  return neg ? -value : value;
-  
+  rResult = neg ? -value : value;
+  return true;
 }
 
 
@@ -358,21 +475,20 @@ bool nuiParser::GetInteger(uint32& rResult, uint8 Base)
 
 bool nuiParser::GetInteger(uint64& rResult, uint8 Base)
 {
-  uint64 old = 0;
   rResult = 0;
   uint8 digit = 0;
+  if (!GetNumberDigit(digit, mChar, Base))
+    return false;
   
+  const uint64 max = (uint64)-1;
   while (GetNumberDigit(digit, mChar, Base))
   {
-    rResult *= Base;
-    old = rResult;
-    rResult += digit;
-    
-    if ((rResult - digit) != old)
+    if (rResult > (max - digit) / Base) // Overflow
       return false;
+    rResult = rResult * Base + digit;
     
     if (!NextChar())
-      return false;
+      break;
   }
   return true;
 }
@@ -403,70 +519,81 @@ bool nuiParser::GetInteger(int32& rResult, uint8 Base)
 
 bool nuiParser::GetInteger(int64& rResult, uint8 Base)
 {
-  int64 old = 0;
-  rResult = 0;
-  uint8 digit = 0;
   bool neg = false;
-  if (mChar == '-')
+  if (mChar == '-' || mChar == '+')
   {
-    neg = true;
-    NextChar();
-  }
-  
-  while (GetNumberDigit(digit, mChar, Base))
-  {
-    rResult *= Base;
-    rResult += digit;
-    
-    if ((rResult - digit) != (old * Base))
+    neg = (mChar == '-');
+    if (!NextChar())
       return false;
   }
   
-  if (neg)
-    rResult = -rResult;
+  uint64 r = 0;
+  if (!GetInteger(r, Base))
+    return false;
+  
+  if (r > (neg ? (1ULL << 63) : ((1ULL << 63) - 1)))
+    return false;
+  
+  rResult = neg ? -(int64)r : (int64)r;
   return true;
 }
 
 
+void nuiParser::SetClass(const nglString& rChars, uint8 Class, std::set<nglChar>& rNonASCII)
+{
+  for (uint32 i = 0; i < rChars.GetLength(); i++)
+  {
+    nglChar c = rChars[i];
+    if (c < 128)
+      mASCIIClasses[c] |= Class;
+    else
+      rNonASCII.insert(c);
+  }
+}
+
+bool nuiParser::HasClass(nglChar c, uint8 Class, const std::set<nglChar>& rNonASCII) const
+{
+  if (c < 128)
+    return (mASCIIClasses[c] & Class) != 0;
+  return rNonASCII.find(c) != rNonASCII.end();
+}
+
+// The ASCII table is cumulative (a symbol start char is also valid in a symbol and in a value), the non ASCII sets are not.
 void nuiParser::SetValidInSymbolStart(const nglString& rValidChars)
 {
-  for (uint32 i = 0; i < rValidChars.GetLength(); i++)
-    mValidInSymbolStart.insert(rValidChars[i]);
+  SetClass(rValidChars, eSymbolStart | eSymbol | eValue, mValidInSymbolStart);
 }
 
 void nuiParser::SetValidInSymbol(const nglString& rValidChars)
 {
-  for (uint32 i = 0; i < rValidChars.GetLength(); i++)
-    mValidInSymbol.insert(rValidChars[i]);
+  SetClass(rValidChars, eSymbol | eValue, mValidInSymbol);
 }
 
 void nuiParser::SetValidInValue(const nglString& rValidChars)
 {
-  for (uint32 i = 0; i < rValidChars.GetLength(); i++)
-    mValidInValue.insert(rValidChars[i]);
+  SetClass(rValidChars, eValue, mValidInValue);
 }
 
 bool nuiParser::IsValidInValue(nglChar c) const
 {
-  if (mValidInValue.find(c) != mValidInValue.end())
+  if (HasClass(c, eValue, mValidInValue))
     return true;
   return IsValidInSymbol(c);
 }
 
 void nuiParser::SetValidInBlank(const nglString& rValidChars)
 {
-  for (uint32 i = 0; i < rValidChars.GetLength(); i++)
-    mBlanks.insert(rValidChars[i]);
+  SetClass(rValidChars, eBlank, mBlanks);
 }
 
 bool nuiParser::IsValidInSymbolStart(nglChar c) const
 {
-  return (mValidInSymbolStart.find(c) != mValidInSymbolStart.end());
+  return HasClass(c, eSymbolStart, mValidInSymbolStart);
 }
 
 bool nuiParser::IsValidInSymbol(nglChar c) const
 {
-  if (mValidInSymbol.find(c) != mValidInSymbol.end())
+  if (HasClass(c, eSymbol, mValidInSymbol))
     return true;
   return IsValidInSymbolStart(c);
 }
@@ -491,6 +618,8 @@ bool nuiParser::GetNumberDigit(uint8& res, nglChar c, uint32 Base) const
     c -= 'A';
     c += 10;
   }
+  else
+    return false;
   res = c;
   return res < Base;
 }
@@ -0,0 +1,404 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "nuiProfiler.h"
+
+#if (defined __APPLE__)
+#include <mach/mach_time.h>
+#include <pthread.h>
+#elif (!defined _WIN32_)
+#include <time.h>
+#include <pthread.h>
+#endif
+
+#define NUI_PROFILER_ENV "NUI_PROFILER_TRACE"
+
+//class nuiProfiler::Thread
+/// Ring buffer of the events of one thread. Only its thread writes to it.
+class nuiProfiler::Thread
+{
+public:
+  Thread(uint32 Size, uint32 Index, const nglString& rDefaultName)
+  : mEvents(Size),
+    mMask(Size - 1),
+    mWrite(0),
+    mFirst(0),
+    mIndex(Index),
+    mExited(false)
+  {
+    SetDefaultName(rDefaultName);
+  }
+
+  /// Give the buffer of a thread that exited to the calling thread. The events of the previous thread are dropped.
+  void Reuse(uint32 Size, uint32 Index, const nglString& rDefaultName)
+  {
+    if (mEvents.size() != Size)
+    {
+      std::vector<Event> events(Size);
+      mEvents.swap(events);
+      mMask = Size - 1;
+    }
+    Clear();
+    mIndex = Index;
+    mExited = false;
+    SetDefaultName(rDefaultName);
+  }
+
+  void SetDefaultName(const nglString& rDefaultName)
+  {
+    nglThread* pThread = nglThread::GetCurThread();
+    if (pThread && !pThread->GetName().IsEmpty())
+      mName = pThread->GetName();
+    else
+      mName = rDefaultName;
+  }
+
+  void Add(const char* pName, Ticks Begin, Ticks End)
+  {
+    uint32 write = ngl_atomic_read(mWrite);
+    Event& rEvent(mEvents[write & mMask]);
+    rEvent.mpName = pName;
+    rEvent.mBegin = Begin;
+    rEvent.mEnd = End;
+    // Publish the event once it is complete:
+    ngl_atomic_barrier();
+    ngl_atomic_set(mWrite, write + 1);
+  }
+
+  /// Copy the events that are in the buffer. The thread can go on writing in the mean time.
+  void Read(std::vector<Event>& rEvents) const
+  {
+    uint32 size = mMask + 1;
+    uint32 end = ngl_atomic_read(mWrite);
+    uint32 first = ngl_atomic_read(mFirst);
+    if (end - first > size)
+      first = end - size;
+    ngl_atomic_barrier();
+
+    size_t start = rEvents.size();
+    for (uint32 i = first; i != end; i++)
+      rEvents.push_back(mEvents[i & mMask]);
+
+    // Drop the events that were overwritten while they were copied:
+    ngl_atomic_barrier();
+    uint32 after = ngl_atomic_read(mWrite);
+    if (after - first > size)
+    {
+      uint32 lost = MIN(after - first - size, end - first);
+      rEvents.erase(rEvents.begin() + start, rEvents.begin() + start + lost);
+    }
+  }
+
+  void Clear()
+  {
+    ngl_atomic_set(mFirst, ngl_atomic_read(mWrite));
+  }
+
+  std::vector<Event> mEvents;
+  uint32 mMask;
+  nglAtomic32 mWrite; ///< Number of events written since the thread started to record (wraps)
+  nglAtomic32 mFirst; ///< Index of the first event that wasn't cleared
+  uint32 mIndex;
+  nglString mName;
+  bool mExited; ///< The thread is gone, the buffer can be given to a new thread
+};
+
+
+//class nuiProfiler
+volatile bool nuiProfiler::mStarted = false;
+nglAtomic32 nuiProfiler::mFrames = 0;
+
+nglCriticalSection nuiProfiler::mCS(_T("nuiProfiler"));
+std::vector<nuiProfiler::Thread*> nuiProfiler::mpThreads;
+uint32 nuiProfiler::mThreadCount = 0;
+uint32 nuiProfiler::mBufferSize = 65536;
+nglThread::ID nuiProfiler::mMainThreadID = 0;
+
+#ifdef _WIN32_
+static DWORD gProfilerTLS = TlsAlloc();
+#else
+static pthread_key_t gProfilerTLS;
+static pthread_once_t gProfilerTLSOnce = PTHREAD_ONCE_INIT;
+
+static void CreateProfilerTLS()
+{
+  pthread_key_create(&gProfilerTLS, nuiProfiler::ExitThread);
+}
+#endif
+
+void nuiProfiler::ExitThread(void* pThread)
+{
+  nglCriticalSectionGuard guard(mCS);
+  ((Thread*)pThread)->mExited = true;
+}
+
+nuiProfiler::Thread* nuiProfiler::GetThread()
+{
+#ifdef _WIN32_
+  Thread* pThread = (Thread*)TlsGetValue(gProfilerTLS);
+#else
+  pthread_once(&gProfilerTLSOnce, CreateProfilerTLS);
+  Thread* pThread = (Thread*)pthread_getspecific(gProfilerTLS);
+#endif
+  if (pThread)
+    return pThread;
+
+  // First event of this thread:
+  {
+    nglCriticalSectionGuard guard(mCS);
+    uint32 index = ++mThreadCount;
+    nglString name;
+    if (nglThread::GetCurThreadID() == mMainThreadID)
+      name = _T("Main");
+    else
+      name.Format(_T("Thread %d"), index);
+
+    // Take the buffer of a thread that exited if there is one, so that short lived threads don't pile up buffers:
+    for (size_t i = 0; i < mpThreads.size() && !pThread; i++)
+    {
+      if (mpThreads[i]->mExited)
+      {
+        pThread = mpThreads[i];
+        pThread->Reuse(mBufferSize, index, name);
+      }
+    }
+
+    if (!pThread)
+    {
+      pThread = new Thread(mBufferSize, index, name);
+      mpThreads.push_back(pThread);
+    }
+  }
+
+#ifdef _WIN32_
+  TlsSetValue(gProfilerTLS, pThread);
+#else
+  pthread_setspecific(gProfilerTLS, pThread);
+#endif
+  return pThread;
+}
+
+void nuiProfiler::Start()
+{
+  mStarted = true;
+}
+
+void nuiProfiler::Stop()
+{
+  mStarted = false;
+}
+
+void nuiProfiler::Clear()
+{
+  nglCriticalSectionGuard guard(mCS);
+  for (size_t i = 0; i < mpThreads.size(); i++)
+    mpThreads[i]->Clear();
+  ngl_atomic_set(mFrames, 0);
+}
+
+void nuiProfiler::SetBufferSize(uint32 Events)
+{
+  uint32 size = 16;
+  while (size < Events && size < (1U << 31))
+    size <<= 1;
+
+  nglCriticalSectionGuard guard(mCS);
+  mBufferSize = size;
+}
+
+uint32 nuiProfiler::GetBufferSize()
+{
+  return mBufferSize;
+}
+
+void nuiProfiler::SetThreadName(const nglString& rName)
+{
+  Thread* pThread = GetThread();
+  nglCriticalSectionGuard guard(mCS);
+  pThread->mName = rName;
+}
+
+nuiProfiler::Ticks nuiProfiler::GetTicks()
+{
+#if (defined _WIN32_)
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  return counter.QuadPart;
+#elif (defined __APPLE__)
+  return mach_absolute_time();
+#else
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (Ticks)time.tv_sec * 1000000000 + time.tv_nsec;
+#endif
+}
+
+double nuiProfiler::GetTicksPerSecond()
+{
+#if (defined _WIN32_)
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  return (double)frequency.QuadPart;
+#elif (defined __APPLE__)
+  mach_timebase_info_data_t info;
+  mach_timebase_info(&info);
+  return 1000000000.0 * info.denom / info.numer;
+#else
+  return 1000000000.0;
+#endif
+}
+
+void nuiProfiler::AddZone(const char* pName, Ticks Begin, Ticks End)
+{
+  GetThread()->Add(pName, Begin, End);
+}
+
+void nuiProfiler::Frame()
+{
+  if (!mStarted)
+    return;
+
+  // A frame marker has no name and the frame number instead of an end time
+  ngl_atomic_inc(mFrames);
+  GetThread()->Add(NULL, GetTicks(), ngl_atomic_read(mFrames));
+}
+
+uint32 nuiProfiler::GetFrameCount()
+{
+  return ngl_atomic_read(mFrames);
+}
+
+static void AppendJsonString(std::string& rOutput, const char* pString)
+{
+  rOutput += '"';
+  for (const char* p = pString; *p; p++)
+  {
+    char c = *p;
+    if (c == '"' || c == '\\')
+    {
+      rOutput += '\\';
+      rOutput += c;
+    }
+    else if ((uint8)c < 0x20)
+    {
+      char buffer[8];
+      sprintf(buffer, "\\u%04x", (uint32)(uint8)c);
+      rOutput += buffer;
+    }
+    else
+    {
+      rOutput += c;
+    }
+  }
+  rOutput += '"';
+}
+
+bool nuiProfiler::Export(nglOStream& rStream)
+{
+  std::vector<std::pair<Thread*, std::vector<Event> > > threads;
+  {
+    nglCriticalSectionGuard guard(mCS);
+    threads.resize(mpThreads.size());
+    for (size_t i = 0; i < mpThreads.size(); i++)
+    {
+      threads[i].first = mpThreads[i];
+      mpThreads[i]->Read(threads[i].second);
+    }
+  }
+
+  // The time stamps are relative to the first event
+  Ticks origin = 0;
+  bool first = true;
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    const std::vector<Event>& rEvents(threads[i].second);
+    for (size_t e = 0; e < rEvents.size(); e++)
+    {
+      if (first || rEvents[e].mBegin < origin)
+        origin = rEvents[e].mBegin;
+      first = false;
+    }
+  }
+  double scale = 1000000.0 / GetTicksPerSecond();
+
+  std::string output("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  char buffer[256];
+  bool separator = false;
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    Thread* pThread = threads[i].first;
+    const std::vector<Event>& rEvents(threads[i].second);
+
+    if (separator)
+      output += ",\n";
+    separator = true;
+    sprintf(buffer, "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", pThread->mIndex);
+    output += buffer;
+    {
+      nglCriticalSectionGuard guard(mCS);
+      AppendJsonString(output, pThread->mName.GetStdString().c_str());
+    }
+    output += "}}";
+
+    for (size_t e = 0; e < rEvents.size(); e++)
+    {
+      const Event& rEvent(rEvents[e]);
+      double begin = (rEvent.mBegin - origin) * scale;
+      output += ",\n";
+      if (rEvent.mpName)
+      {
+        output += "{\"ph\":\"X\",\"cat\":\"nui\",\"name\":";
+        AppendJsonString(output, rEvent.mpName);
+        sprintf(buffer, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pThread->mIndex, begin, (rEvent.mEnd - rEvent.mBegin) * scale);
+      }
+      else
+      {
+        sprintf(buffer, "{\"ph\":\"i\",\"s\":\"g\",\"cat\":\"frame\",\"name\":\"Frame %u\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", (uint32)rEvent.mEnd, pThread->mIndex, begin);
+      }
+      output += buffer;
+
+      // Don't keep the whole trace in memory
+      if (output.size() > 65536)
+      {
+        if (rStream.Write(output.c_str(), (int64)output.size(), 1) != (int64)output.size())
+          return false;
+        output.clear();
+      }
+    }
+  }
+  output += "\n]}\n";
+
+  return rStream.Write(output.c_str(), (int64)output.size(), 1) == (int64)output.size();
+}
+
+bool nuiProfiler::Export(const nglPath& rPath)
+{
+  nglOFile file(rPath, eOFileCreate);
+  if (!file.IsOpen())
+    return false;
+  return Export(file);
+}
+
+void nuiProfiler::Init()
+{
+  mMainThreadID = nglThread::GetCurThreadID();
+  if (getenv(NUI_PROFILER_ENV))
+    Start();
+}
+
+void nuiProfiler::Exit()
+{
+  const char* pPath = getenv(NUI_PROFILER_ENV);
+  if (!pPath || !*pPath)
+    return;
+
+  Stop();
+  nglPath path((nglString(pPath)));
+  if (!Export(path))
+    NGL_LOG(_T("nuiProfiler"), NGL_LOG_ERROR, _T("Unable to write the trace to '%ls'\n"), path.GetPathName().GetChars());
+}
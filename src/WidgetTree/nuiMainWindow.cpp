@@ -19,6 +19,7 @@
 #include "nuiIntrospector.h"
 #include "nuiSoftwarePainter.h"
 #include "nuiStopWatch.h"
+#include "nuiProfiler.h"
 
 //#define STUPID
 //#define STUPIDBASE
@@ -306,18 +307,24 @@ void nuiMainWindow::Paint()
   if (!IsPaintEnabled())
     return;
   
+  NUI_PROFILE_FRAME();
+  NUI_PROFILE_ZONE("Paint");
+
   mLastEventTime = nglTime();
   //nuiStopWatch watch(_T("nuiMainWindow::Paint"));
-  do 
   {
+    NUI_PROFILE_ZONE("Layout");
+    do 
+    {
 
-    FillTrash();
-    
-    GetIdealRect();
-    SetLayout(nuiRect(0, 0, mpNGLWindow->GetWidth(), mpNGLWindow->GetHeight()));
-    
-    EmptyTrash();
-  } while (IsTrashFull());
+      FillTrash();
+      
+      GetIdealRect();
+      SetLayout(nuiRect(0, 0, mpNGLWindow->GetWidth(), mpNGLWindow->GetHeight()));
+      
+      EmptyTrash();
+    } while (IsTrashFull());
+  }
 
   if (!mInvalidatePosted)
   {
@@ -358,7 +365,10 @@ void nuiMainWindow::Paint()
   if (!IsMatrixIdentity())
     pContext->MultMatrix(GetMatrix());
   mLastRendering = nglTime();
-  DrawTree(pContext);
+  {
+    NUI_PROFILE_ZONE("DrawTree");
+    DrawTree(pContext);
+  }
 
   if (mDisplayMouseOverObject)
     DBG_DisplayMouseOverObject();
@@ -385,6 +395,7 @@ void nuiMainWindow::Paint()
     pContext->DrawRect(r, eStrokeAndFillShape);
   }
 
+  NUI_PROFILE_ZONE("Present");
   pContext->StopRendering();
   EmptyTrash();
 
@@ -414,7 +425,7 @@ void nuiMainWindow::Paint()
   uint32 rops = pContext->GetPainter()->GetRenderOperations();
   uint32 verts = pContext->GetPainter()->GetVertices();
   uint32 batches = pContext->GetPainter()->GetBatches();
-  //printf("Frame stats | RenderOps: %d | Vertices %d | Batches %d\n", rops, verts, batches);
+  //printf("Frame stats | RenderOps: %d | Vertices %d | Batches %d | Draw calls %d | Uploaded bytes %d\n", rops, verts, batches, pContext->GetPainter()->GetDrawCalls(), pContext->GetPainter()->GetUploadedBytes());
   
   //Invalidate();
   
@@ -13,6 +13,7 @@
 #include "nuiNotification.h"
 #include "nuiCSS.h"
 #include "nuiStopWatch.h"
+#include "nuiProfiler.h"
 #include "nuiModalContainer.h"
 #include <iterator>
 
@@ -828,6 +829,7 @@ void nuiTopLevel::CallTextCompositionIndexToPoint(int32 CursorPosition, float& x
 bool nuiTopLevel::CallTextInput (const nglString& rUnicodeText)
 {
   CheckValid();
+  NUI_PROFILE_ZONE("TextInput");
   if (mpFocus && mpFocus->IsEnabled())
   {
     if (mpFocus->DispatchTextInput(rUnicodeText))
@@ -986,6 +988,7 @@ nuiWidgetPtr GetPreviousFocussableWidget(nuiWidgetPtr pWidget)
 bool nuiTopLevel::CallKeyDown (const nglKeyEvent& rEvent)
 {
   CheckValid();
+  NUI_PROFILE_ZONE("KeyDown");
   if (mpFocus)
   {
     if (mpFocus->IsEnabled())
@@ -1038,6 +1041,7 @@ bool nuiTopLevel::CallKeyDown (const nglKeyEvent& rEvent)
 bool nuiTopLevel::CallKeyUp (const nglKeyEvent& rEvent)
 {
   CheckValid();
+  NUI_PROFILE_ZONE("KeyUp");
   if (mpFocus && mpFocus->IsEnabled())
   {
     if (mpFocus->DispatchKeyUp(rEvent, mHotKeyMask))
@@ -1057,6 +1061,7 @@ bool nuiTopLevel::CallKeyUp (const nglKeyEvent& rEvent)
 bool nuiTopLevel::CallMouseClick (nglMouseInfo& rInfo)
 {
   CheckValid();
+  NUI_PROFILE_ZONE("MouseClick");
   
   mMouseClickedEvents[rInfo.TouchId] = rInfo;
   
@@ -1179,6 +1184,7 @@ void nuiTopLevel::DispatchKeyboardFocus(const nuiWidgetList& rWidgets)
 bool nuiTopLevel::CallMouseUnclick(nglMouseInfo& rInfo)
 {
   CheckValid();
+  NUI_PROFILE_ZONE("MouseUnclick");
 //  NGL_TOUCHES_DEBUG( NGL_OUT(_T("nuiTopLevel::CallMouseUnclick X:%d Y:%d\n"), rInfo.X, rInfo.Y) );
 
   // Update counterpart:
@@ -1309,6 +1315,7 @@ void nuiTopLevel::UpdateHoverList(nglMouseInfo& rInfo)
 bool nuiTopLevel::CallMouseMove (nglMouseInfo& rInfo)
 {
   CheckValid();
+  NUI_PROFILE_ZONE("MouseMove");
 NGL_TOUCHES_DEBUG( NGL_OUT(_T("nuiTopLevel::CallMouseMove X:%d Y:%d\n"), rInfo.X, rInfo.Y) );
 
   // Update counterpart:
@@ -2067,6 +2074,10 @@ void nuiTopLevel::ApplyWidgetCSS(nuiWidget* pWidget, bool Recursive, uint32 Matc
 void nuiTopLevel::UpdateWidgetsCSS()
 {
   CheckValid();
+  if (mCSSWidgets.empty())
+    return;
+
+  NUI_PROFILE_ZONE("CSS");
   std::map<nuiWidgetPtr, uint32>::iterator it = mCSSWidgets.begin();
   std::map<nuiWidgetPtr, uint32>::iterator end = mCSSWidgets.end();
   
@@ -2092,6 +2103,7 @@ void nuiTopLevel::SetCSS(nuiCSS* pCSS)
   
   if (mpCSS)
   {
+    NUI_PROFILE_ZONE("CSS");
     ResetCSSPass();
     ApplyWidgetCSS(this, true, NUI_WIDGET_MATCHTAG_ALL);
   }
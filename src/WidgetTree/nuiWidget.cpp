@@ -24,6 +24,7 @@
 #include "nuiTask.h"
 #include "nuiMatrixNode.h"
 #include "nuiCSS.h"
+#include "nuiProfiler.h"
 
 //const bool gGlobalUseRenderCache = false;
 const bool gGlobalUseRenderCache = true;
@@ -155,6 +156,7 @@ void nuiWidget::InitDefaultValues()
   mSurfaceColor = nuiColor(255, 255, 255, 255);
   mSurfaceBlendFunc = nuiBlendTransp;  
   mDecorationMode = eDecorationOverdraw;
+  mFocusDecorationMode = eDecorationOverdraw;
   mHotKeyMask = -1;
   mClickThru = true;
   mInSetRect = false;
@@ -169,15 +171,16 @@ void nuiWidget::InitDefaultValues()
 
 bool nuiWidget::Load(const nuiXMLNode* pNode)
 {
+  // Reset the widget before its attributes are loaded from the XML, not after:
+  Init();
+  mpTheme = NULL;
+
   nuiObject::Load(pNode);
 #ifdef NUI_WIDGET_STATS
   wcount++;
   maxwcount = MAX(wcount, maxwcount);
   NGL_OUT(_T("max widgets: %d (total %d)\n", maxwcount, wcount));
 #endif
-  
-  Init();
-  mpTheme = NULL;
 
   nglString str = pNode->Dump(0);
   // Retrieve the size of the widget from the XML description (ignored if not present):
@@ -512,10 +515,10 @@ void nuiWidget::InitAttributes()
                 nuiMakeDelegate(this, &nuiWidget::GetSurfaceMatrix),
                 nuiMakeDelegate(this, &nuiWidget::SetSurfaceMatrix)));
   
-  AddAttribute(new nuiAttribute<const nuiMatrix&>
+  AddAttribute(new nuiAttribute<nuiMatrix>
                (nglString(_T("Matrix")), nuiUnitMatrix,
                 nuiMakeDelegate(this, &nuiWidget::_GetMatrix),
-                nuiMakeDelegate(this, &nuiWidget::SetMatrix)));
+                nuiMakeDelegate(this, &nuiWidget::_SetMatrix)));
   
   AddAttribute(new nuiAttribute<nuiBlendFunc>
                (nglString(_T("SurfaceBlendFunc")), nuiUnitCustom,
@@ -880,16 +883,7 @@ void nuiWidget::LocalToGlobal(nuiRect& rRect) const
 {
   CheckValid();
   if (!IsMatrixIdentity())
-  {
-    nuiVector vec1(rRect.mLeft,rRect.mTop,0);
-    nuiVector vec2(rRect.mRight,rRect.mBottom,0);
-    vec1 = GetMatrix() * vec1;
-    vec2 = GetMatrix() * vec2;
-    rRect.mLeft   = vec1[0];
-    rRect.mTop    = vec1[1];
-    rRect.mRight  = vec2[0];
-    rRect.mBottom = vec2[1];
-  }
+    rRect.Transform(GetMatrix());
 
   rRect.Move(mRect.mLeft, mRect.mTop);
 
@@ -953,14 +947,7 @@ void nuiWidget::GlobalToLocal(nuiRect& rRect) const
     nuiMatrix mat;
     GetMatrix(mat);
     mat.InvertHomogenous();
-    nuiVector vec1(rRect.mLeft,rRect.mTop,0);
-    nuiVector vec2(rRect.mRight,rRect.mBottom,0);
-    vec1 = mat * vec1;
-    vec2 = mat * vec2;
-    rRect.mLeft   = vec1[0];
-    rRect.mTop    = vec1[1];
-    rRect.mRight  = vec2[0];
-    rRect.mBottom = vec2[1];
+    rRect.Transform(mat);
   }
 }
 
@@ -1415,6 +1402,8 @@ bool nuiWidget::DrawWidget(nuiDrawContext* pContext)
   if (!IsVisible())
     return false;
 
+  NUI_PROFILE_ZONE("DrawWidget");
+
   //NGL_ASSERT(!mNeedLayout);
   //if (mNeedLayout)
   // printf("need layout bug on 0x%X [%ls - %ls]\n", this, GetObjectClass().GetChars(), GetObjectName().GetChars());
@@ -3962,12 +3951,16 @@ nuiMatrix nuiWidget::GetMatrix() const
   return m;
 }
 
-const nuiMatrix& nuiWidget::_GetMatrix() const
+nuiMatrix nuiWidget::_GetMatrix() const
 {
-  CheckValid();
   return GetMatrix();
 }
 
+void nuiWidget::_SetMatrix(nuiMatrix Matrix)
+{
+  SetMatrix(Matrix);
+}
+
 void nuiWidget::SetMatrix(const nuiMatrix& rMatrix)
 {
   CheckValid();
@@ -0,0 +1,275 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Benchmark.h"
+#include "nuiAudioEngine.h"
+#include "nuiAudioDevice_Null.h"
+#include "nuiSoundManager.h"
+#include "nuiSynthSound.h"
+#include "nuiVoice.h"
+#include "nuiAudioConvert.h"
+#include "nuiAudioResampler.h"
+
+#define BENCHMARK_SAMPLE_RATE 44100
+
+/// Mix one second of many looping synth voices through the offline null device
+class AudioMixBenchmark : public Benchmark
+{
+public:
+  AudioMixBenchmark(const char* pName, uint32 Voices)
+  : Benchmark(pName, 20), mVoices(Voices), mpDevice(NULL), mpEngine(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    mpDevice = new nuiAudioDevice_Null(nuiAudioDevice_Null::eOffline);
+    mpEngine = new nuiAudioEngine(mpDevice, BENCHMARK_SAMPLE_RATE, 512);
+    if (!mpDevice->IsOpen())
+      return false;
+
+    BenchmarkRandom random(12);
+    for (uint32 i = 0; i < mVoices; i++)
+    {
+      nuiSynthSound* pSound = nuiSoundManager::Instance.GetSynthSound();
+      pSound->SetSampleRate(BENCHMARK_SAMPLE_RATE);
+      pSound->SetFreq(55.0f + random.Next(2000));
+      pSound->SetType((nuiSynthSound::SignalType)(i % nuiSynthSound::eLastType));
+      pSound->Acquire();
+      mpSounds.push_back(pSound);
+
+      nuiVoice* pVoice = mpEngine->PlaySound(pSound);
+      if (!pVoice)
+        return false;
+      pVoice->SetLoop(true);
+      pVoice->SetGain(1.0f / mVoices);
+      pVoice->SetPan(random.NextFloat() * 2 - 1);
+    }
+
+    // Let the engine pick the voices up
+    mpDevice->Render(512);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    mpDevice->Render(BENCHMARK_SAMPLE_RATE);
+  }
+
+  virtual void TearDown()
+  {
+    // The engine owns the device and the voices
+    delete mpEngine;
+    mpEngine = NULL;
+    mpDevice = NULL;
+    for (size_t i = 0; i < mpSounds.size(); i++)
+      mpSounds[i]->Release();
+    mpSounds.clear();
+  }
+
+protected:
+  uint32 mVoices;
+  nuiAudioDevice_Null* mpDevice;
+  nuiAudioEngine* mpEngine;
+  std::vector<nuiSynthSound*> mpSounds;
+};
+
+static AudioMixBenchmark gAudioMix16Benchmark("audio.mix_16_voices", 16);
+static AudioMixBenchmark gAudioMix256Benchmark("audio.mix_256_voices", 256);
+
+/// Interleaved int16 to de-interleaved float and back, for ten seconds of stereo
+class AudioConvertBenchmark : public Benchmark
+{
+public:
+  AudioConvertBenchmark()
+  : Benchmark("audio.convert_int16", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    const uint32 frames = BENCHMARK_SAMPLE_RATE * 10;
+    BenchmarkRandom random(13);
+    mInterleaved.resize(frames * 2);
+    for (size_t i = 0; i < mInterleaved.size(); i++)
+      mInterleaved[i] = (int16)(random.Next(65536) - 32768);
+    mLeft.resize(frames);
+    mRight.resize(frames);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    uint32 frames = (uint32)mLeft.size();
+    nuiAudioConvert_INint16ToDEfloat(&mInterleaved[0], &mLeft[0], 0, 2, frames);
+    nuiAudioConvert_INint16ToDEfloat(&mInterleaved[0], &mRight[0], 1, 2, frames);
+    nuiAudioConvert_DEfloatToINint16(&mLeft[0], &mInterleaved[0], 0, 2, frames);
+    nuiAudioConvert_DEfloatToINint16(&mRight[0], &mInterleaved[0], 1, 2, frames);
+  }
+
+  virtual void TearDown()
+  {
+    mInterleaved.clear();
+    mLeft.clear();
+    mRight.clear();
+  }
+
+protected:
+  std::vector<int16> mInterleaved;
+  std::vector<float> mLeft;
+  std::vector<float> mRight;
+};
+
+static AudioConvertBenchmark gAudioConvertBenchmark;
+
+/// One buffer converter of nuiAudioConvert on ten seconds of stereo samples
+class AudioFormatBenchmark : public Benchmark
+{
+public:
+  enum Format
+  {
+    e16bitsToFloat,
+    eFloatTo16bits,
+    e24bitsToFloat,
+    eFloatTo24bits,
+    e32bitsToFloat,
+    eFloatTo32bits,
+    eDeinterleave
+  };
+
+  AudioFormatBenchmark(const char* pName, Format format)
+  : Benchmark(pName, 20), mFormat(format)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    const uint32 samples = BENCHMARK_SAMPLE_RATE * 10 * 2;
+    BenchmarkRandom random(14);
+    mFloats.resize(samples);
+    for (uint32 i = 0; i < samples; i++)
+      mFloats[i] = random.NextFloat() * 2 - 1;
+    mInt16.resize(samples);
+    for (uint32 i = 0; i < samples; i++)
+      mInt16[i] = (int16)(random.Next(65536) - 32768);
+    mInt32.resize(samples);
+    for (uint32 i = 0; i < samples; i++)
+      mInt32[i] = (int32)(random.Next() << 1);
+    mBytes.resize(samples * 3);
+    for (size_t i = 0; i < mBytes.size(); i++)
+      mBytes[i] = (uint8)random.Next(256);
+    mOutput.resize(samples);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    const uint32 samples = (uint32)mFloats.size();
+    switch (mFormat)
+    {
+      case e16bitsToFloat:
+        // In place: the int16 samples are copied to the second half of the float buffer
+        memcpy((int16*)&mOutput[0] + samples, &mInt16[0], samples * sizeof(int16));
+        nuiAudioConvert_16bitsBufferToFloat(&mOutput[0], samples);
+        break;
+      case eFloatTo16bits:
+        nuiAudioConvert_FloatBufferTo16bits(&mFloats[0], &mInt16[0], samples);
+        break;
+      case e24bitsToFloat:
+        nuiAudioConvert_24bitsLittleEndianToFloat(&mBytes[0], &mOutput[0], samples);
+        break;
+      case eFloatTo24bits:
+        nuiAudioConvert_FloatTo24bitsLittleEndian(&mFloats[0], &mBytes[0], samples);
+        break;
+      case e32bitsToFloat:
+        nuiAudioConvert_32bitsToFloat(&mInt32[0], &mOutput[0], samples);
+        break;
+      case eFloatTo32bits:
+        nuiAudioConvert_FloatTo32bits(&mFloats[0], &mInt32[0], samples);
+        break;
+      case eDeinterleave:
+      {
+        float* pOutputs[2] = { &mOutput[0], &mOutput[samples / 2] };
+        nuiAudioConvert_INfloatToDEfloat(&mFloats[0], pOutputs, 2, samples / 2);
+        break;
+      }
+    }
+  }
+
+  virtual void TearDown()
+  {
+    mFloats.clear();
+    mInt16.clear();
+    mInt32.clear();
+    mBytes.clear();
+    mOutput.clear();
+  }
+
+protected:
+  Format mFormat;
+  std::vector<float> mFloats;
+  std::vector<int16> mInt16;
+  std::vector<int32> mInt32;
+  std::vector<uint8> mBytes;
+  std::vector<float> mOutput;
+};
+
+static AudioFormatBenchmark gAudio16bitsToFloatBenchmark("audio.convert_16bits_to_float", AudioFormatBenchmark::e16bitsToFloat);
+static AudioFormatBenchmark gAudioFloatTo16bitsBenchmark("audio.convert_float_to_16bits", AudioFormatBenchmark::eFloatTo16bits);
+static AudioFormatBenchmark gAudio24bitsToFloatBenchmark("audio.convert_24bits_to_float", AudioFormatBenchmark::e24bitsToFloat);
+static AudioFormatBenchmark gAudioFloatTo24bitsBenchmark("audio.convert_float_to_24bits", AudioFormatBenchmark::eFloatTo24bits);
+static AudioFormatBenchmark gAudio32bitsToFloatBenchmark("audio.convert_32bits_to_float", AudioFormatBenchmark::e32bitsToFloat);
+static AudioFormatBenchmark gAudioFloatTo32bitsBenchmark("audio.convert_float_to_32bits", AudioFormatBenchmark::eFloatTo32bits);
+static AudioFormatBenchmark gAudioDeinterleaveBenchmark("audio.deinterleave_float", AudioFormatBenchmark::eDeinterleave);
+
+/// Ten seconds of a mono signal from 44.1 kHz to 48 kHz with the windowed-sinc resampler
+class AudioResampleBenchmark : public Benchmark
+{
+public:
+  AudioResampleBenchmark(const char* pName, nuiAudioSincResampler::Quality quality)
+  : Benchmark(pName, 10), mQuality(quality), mpResampler(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    mpResampler = new nuiAudioSincResampler(BENCHMARK_SAMPLE_RATE, 48000, mQuality);
+    const uint32 frames = BENCHMARK_SAMPLE_RATE * 10;
+    mInput.resize(frames);
+    for (uint32 i = 0; i < frames; i++)
+      mInput[i] = (float)(sin(i * 2 * M_PI * 1000 / BENCHMARK_SAMPLE_RATE) * .5 + sin(i * 2 * M_PI * 15000 / BENCHMARK_SAMPLE_RATE) * .25);
+    mOutput.resize(mpResampler->GetMaxOutputFrames(4096));
+    return true;
+  }
+
+  virtual void Run()
+  {
+    mpResampler->Reset();
+    const uint32 frames = (uint32)mInput.size();
+    for (uint32 i = 0; i < frames; i += 4096)
+      mpResampler->Process(&mInput[i], MIN(4096, frames - i), &mOutput[0]);
+  }
+
+  virtual void TearDown()
+  {
+    delete mpResampler;
+    mpResampler = NULL;
+    mInput.clear();
+    mOutput.clear();
+  }
+
+protected:
+  nuiAudioSincResampler::Quality mQuality;
+  nuiAudioSincResampler* mpResampler;
+  std::vector<float> mInput;
+  std::vector<float> mOutput;
+};
+
+static AudioResampleBenchmark gAudioResampleFastBenchmark("audio.resample_sinc_fast", nuiAudioSincResampler::eSincFast);
+static AudioResampleBenchmark gAudioResampleMediumBenchmark("audio.resample_sinc_medium", nuiAudioSincResampler::eSincMedium);
+static AudioResampleBenchmark gAudioResampleBestBenchmark("audio.resample_sinc_best", nuiAudioSincResampler::eSincBest);
@@ -0,0 +1,254 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Benchmark.h"
+#include "nuiJson.h"
+
+//class Benchmark
+static std::vector<Benchmark*>& GetRegisteredBenchmarks()
+{
+  // Function static: the scenarios register themselves during the static initialization of the other files
+  static std::vector<Benchmark*> benchmarks;
+  return benchmarks;
+}
+
+static bool CompareBenchmarks(const Benchmark* pA, const Benchmark* pB)
+{
+  return strcmp(pA->GetName(), pB->GetName()) < 0;
+}
+
+Benchmark::Benchmark(const char* pName, uint32 Iterations)
+: mpName(pName), mIterations(Iterations)
+{
+  GetRegisteredBenchmarks().push_back(this);
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+bool Benchmark::Setup()
+{
+  return true;
+}
+
+void Benchmark::TearDown()
+{
+}
+
+const char* Benchmark::GetName() const
+{
+  return mpName;
+}
+
+uint32 Benchmark::GetIterations() const
+{
+  return mIterations;
+}
+
+const std::vector<Benchmark*>& Benchmark::GetBenchmarks()
+{
+  std::vector<Benchmark*>& rBenchmarks(GetRegisteredBenchmarks());
+  std::sort(rBenchmarks.begin(), rBenchmarks.end(), CompareBenchmarks);
+  return rBenchmarks;
+}
+
+
+//class BenchmarkResult
+BenchmarkResult::BenchmarkResult()
+: mSkipped(false),
+  mIterations(0),
+  mMedian(0),
+  mP95(0),
+  mMin(0),
+  mMax(0),
+  mMean(0),
+  mHasBaseline(false),
+  mBaselineMedian(0),
+  mChange(0),
+  mRegression(false)
+{
+}
+
+void BenchmarkResult::SetSamples(std::vector<double>& rSamples)
+{
+  mIterations = (uint32)rSamples.size();
+  if (rSamples.empty())
+    return;
+
+  std::sort(rSamples.begin(), rSamples.end());
+  size_t count = rSamples.size();
+  mMin = rSamples.front();
+  mMax = rSamples.back();
+  if (count & 1)
+    mMedian = rSamples[count / 2];
+  else
+    mMedian = (rSamples[count / 2 - 1] + rSamples[count / 2]) * 0.5;
+
+  // Nearest rank:
+  size_t rank = (size_t)ceil(0.95 * count);
+  mP95 = rSamples[MAX(rank, (size_t)1) - 1];
+
+  double sum = 0;
+  for (size_t i = 0; i < count; i++)
+    sum += rSamples[i];
+  mMean = sum / count;
+}
+
+
+//class BenchmarkRandom
+BenchmarkRandom::BenchmarkRandom(uint32 Seed)
+: mState(Seed)
+{
+}
+
+uint32 BenchmarkRandom::Next()
+{
+  mState = mState * 1103515245 + 12345;
+  return (mState >> 1) & 0x7fffffff;
+}
+
+uint32 BenchmarkRandom::Next(uint32 Max)
+{
+  return Max ? (uint32)(((uint64)Next() * Max) >> 31) : 0;
+}
+
+float BenchmarkRandom::NextFloat()
+{
+  return (float)Next() / 2147483648.0f;
+}
+
+
+//Runner
+double BenchmarkRun(Benchmark* pBenchmark, uint32 Iterations, BenchmarkResult& rResult)
+{
+  rResult.mName = pBenchmark->GetName();
+  nglTime start;
+  if (!pBenchmark->Setup())
+  {
+    rResult.mSkipped = true;
+    pBenchmark->TearDown();
+    return 0;
+  }
+
+  // Warm up the caches and the lazy initializations:
+  for (uint32 i = 0; i < 2; i++)
+    pBenchmark->Run();
+
+  std::vector<double> samples;
+  samples.reserve(Iterations);
+  for (uint32 i = 0; i < Iterations; i++)
+  {
+    nglTime before;
+    pBenchmark->Run();
+    nglTime after;
+    samples.push_back((after - before) * 1000.0);
+  }
+
+  pBenchmark->TearDown();
+  rResult.SetSamples(samples);
+  return nglTime() - start;
+}
+
+bool BenchmarkWriteResults(const std::vector<BenchmarkResult>& rResults, const nglString& rOutput)
+{
+  nuiJson::Value root(nuiJson::objectValue);
+  root["version"] = 1;
+
+  nuiJson::Value& rBenchmarks(root["benchmarks"]);
+  rBenchmarks = nuiJson::Value(nuiJson::arrayValue);
+  for (size_t i = 0; i < rResults.size(); i++)
+  {
+    const BenchmarkResult& rResult(rResults[i]);
+    nuiJson::Value benchmark(nuiJson::objectValue);
+    benchmark["name"] = rResult.mName.GetStdString();
+    if (rResult.mSkipped)
+    {
+      benchmark["skipped"] = true;
+    }
+    else
+    {
+      benchmark["iterations"] = rResult.mIterations;
+      benchmark["median_ms"] = rResult.mMedian;
+      benchmark["p95_ms"] = rResult.mP95;
+      benchmark["min_ms"] = rResult.mMin;
+      benchmark["max_ms"] = rResult.mMax;
+      benchmark["mean_ms"] = rResult.mMean;
+      if (rResult.mHasBaseline)
+      {
+        benchmark["baseline_median_ms"] = rResult.mBaselineMedian;
+        benchmark["change_percent"] = rResult.mChange;
+        benchmark["regression"] = rResult.mRegression;
+      }
+    }
+    rBenchmarks.append(benchmark);
+  }
+
+  nuiJson::StyledWriter writer;
+  std::string json = writer.write(root);
+
+  if (rOutput.IsEmpty())
+  {
+    fwrite(json.c_str(), 1, json.size(), stdout);
+    fflush(stdout);
+    return true;
+  }
+
+  nglOFile file(nglPath(rOutput), eOFileCreate);
+  if (!file.IsOpen())
+    return false;
+  return file.Write(json.c_str(), (int64)json.size(), 1) == 1;
+}
+
+bool BenchmarkCompare(std::vector<BenchmarkResult>& rResults, const nglPath& rBaseline, double Threshold)
+{
+  nglIStream* pStream = rBaseline.OpenRead();
+  if (!pStream)
+  {
+    fprintf(stderr, "Unable to open the baseline '%s'\n", rBaseline.GetPathName().GetStdString().c_str());
+    return false;
+  }
+
+  std::string json;
+  json.resize((size_t)pStream->Available());
+  if (!json.empty())
+    pStream->Read(&json[0], (int64)json.size(), 1);
+  delete pStream;
+
+  nuiJson::Reader reader;
+  nuiJson::Value root;
+  if (!reader.parse(json, root, false))
+  {
+    fprintf(stderr, "Unable to parse the baseline '%s': %s\n", rBaseline.GetPathName().GetStdString().c_str(), reader.getFormatedErrorMessages().c_str());
+    return false;
+  }
+
+  std::map<std::string, double> medians;
+  const nuiJson::Value& rBenchmarks(root["benchmarks"]);
+  for (nuiJson::Value::UInt i = 0; i < rBenchmarks.size(); i++)
+  {
+    const nuiJson::Value& rBenchmark(rBenchmarks[i]);
+    if (rBenchmark.isMember("median_ms"))
+      medians[rBenchmark["name"].asString()] = rBenchmark["median_ms"].asDouble();
+  }
+
+  for (size_t i = 0; i < rResults.size(); i++)
+  {
+    BenchmarkResult& rResult(rResults[i]);
+    std::map<std::string, double>::const_iterator it = medians.find(rResult.mName.GetStdString());
+    if (rResult.mSkipped || it == medians.end() || it->second <= 0)
+      continue;
+
+    rResult.mHasBaseline = true;
+    rResult.mBaselineMedian = it->second;
+    rResult.mChange = (rResult.mMedian - it->second) * 100.0 / it->second;
+    rResult.mRegression = rResult.mChange > Threshold;
+  }
+
+  return true;
+}
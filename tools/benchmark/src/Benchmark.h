@@ -0,0 +1,79 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#pragma once
+
+#include "nui.h"
+
+/// Base class of the scenarios of the benchmark tool
+/*!
+Each scenario is a static object that registers itself. The runner calls Setup() once (a scenario that returns false is
+reported as skipped, for instance when no font is available), then Run() a few times to warm the caches up, then Run()
+again for each measured iteration, and TearDown() at the end. Only Run() is timed, so it must not depend on anything but
+the state prepared by Setup() to keep the timings deterministic.
+*/
+class Benchmark
+{
+public:
+  Benchmark(const char* pName, uint32 Iterations);
+  virtual ~Benchmark();
+
+  virtual bool Setup();
+  virtual void Run() = 0;
+  virtual void TearDown();
+
+  const char* GetName() const;
+  uint32 GetIterations() const;
+
+  static const std::vector<Benchmark*>& GetBenchmarks(); ///< All the registered scenarios, sorted by name.
+
+private:
+  const char* mpName;
+  uint32 mIterations;
+};
+
+/// Timings of one scenario, in milliseconds
+class BenchmarkResult
+{
+public:
+  BenchmarkResult();
+
+  void SetSamples(std::vector<double>& rSamples); ///< Sorts the samples and computes the statistics.
+
+  nglString mName;
+  bool mSkipped;
+  uint32 mIterations;
+  double mMedian;
+  double mP95;
+  double mMin;
+  double mMax;
+  double mMean;
+
+  // Comparison with a baseline:
+  bool mHasBaseline;
+  double mBaselineMedian;
+  double mChange; ///< Relative change of the median, in percent
+  bool mRegression;
+};
+
+/// Deterministic pseudo random numbers for the generated data sets (LCG, independent of the C library)
+class BenchmarkRandom
+{
+public:
+  BenchmarkRandom(uint32 Seed = 1);
+
+  uint32 Next(); ///< 31 bits
+  uint32 Next(uint32 Max); ///< [0, Max)
+  float NextFloat(); ///< [0, 1)
+
+private:
+  uint32 mState;
+};
+
+double BenchmarkRun(Benchmark* pBenchmark, uint32 Iterations, BenchmarkResult& rResult); ///< Returns the total time spent in the scenario, in seconds.
+bool BenchmarkWriteResults(const std::vector<BenchmarkResult>& rResults, const nglString& rOutput); ///< Write the JSON report to rOutput, or to the standard output if it is empty.
+bool BenchmarkCompare(std::vector<BenchmarkResult>& rResults, const nglPath& rBaseline, double Threshold); ///< Compare the medians with a previous JSON report. Threshold is in percent.
@@ -0,0 +1,146 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Benchmark.h"
+#include "nglBitmapTools.h"
+
+#define BITMAP_WIDTH 1024
+#define BITMAP_HEIGHT 768
+
+// Each kernel of nglBitmapTools that has SSE2/SSSE3/AVX2 code paths is timed twice: with the dispatch of nglCPUInfo
+// (bitmap.*_simd) and with the scalar code forced by nglEnableBitmapSIMD(false) (bitmap.*_scalar). The nuitest_bitmap_tools
+// test checks that both give the same results.
+
+typedef void (*BitmapLineFn)(void* pDst, void* pSrc, int32 PixelCount);
+
+class BitmapLineBenchmark : public Benchmark
+{
+public:
+  BitmapLineBenchmark(const char* pName, nglCopyLineFn pCopy, BitmapLineFn pLine, int32 DstBytes, int32 SrcBytes, bool SIMD)
+  : Benchmark(pName, 20),
+    mpCopy(pCopy),
+    mpLine(pLine),
+    mDstBytes(DstBytes),
+    mSrcBytes(SrcBytes),
+    mSIMD(SIMD)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    // The generic copies are not exported, nglGetCopyLineFn gives them:
+    if (!mpCopy && !mpLine)
+      mpCopy = nglGetCopyLineFn(mDstBytes * 8, mSrcBytes * 8);
+    if (!mpCopy && !mpLine)
+      return false;
+
+    // Premultiplied like pixels, so that the unpremultiplication sees valid alphas:
+    BenchmarkRandom random(21);
+    mSource.resize(BITMAP_WIDTH * BITMAP_HEIGHT * mSrcBytes);
+    for (size_t i = 0; i + 3 < mSource.size(); i += 4)
+    {
+      uint8 alpha = (uint8)random.Next(256);
+      mSource[i] = alpha;
+      for (uint32 c = 1; c < 4; c++)
+        mSource[i + c] = (uint8)(random.Next(256) * alpha / 255);
+    }
+    mTarget.resize(BITMAP_WIDTH * BITMAP_HEIGHT * mDstBytes);
+
+    nglEnableBitmapSIMD(mSIMD);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    for (int32 y = 0; y < BITMAP_HEIGHT; y++)
+    {
+      void* pSrc = &mSource[y * BITMAP_WIDTH * mSrcBytes];
+      void* pDst = &mTarget[y * BITMAP_WIDTH * mDstBytes];
+      if (mpCopy)
+        mpCopy(pDst, pSrc, BITMAP_WIDTH, false);
+      else
+        mpLine(pDst, pSrc, BITMAP_WIDTH);
+    }
+  }
+
+  virtual void TearDown()
+  {
+    nglEnableBitmapSIMD(true);
+    mSource.clear();
+    mTarget.clear();
+  }
+
+protected:
+  nglCopyLineFn mpCopy;
+  BitmapLineFn mpLine;
+  int32 mDstBytes;
+  int32 mSrcBytes;
+  bool mSIMD;
+  std::vector<uint8> mSource;
+  std::vector<uint8> mTarget;
+};
+
+#define BITMAP_COPY_BENCHMARK(VAR, NAME, FN, DST, SRC) \
+  static BitmapLineBenchmark g##VAR##SIMDBenchmark("bitmap." NAME "_simd", FN, NULL, DST, SRC, true); \
+  static BitmapLineBenchmark g##VAR##ScalarBenchmark("bitmap." NAME "_scalar", FN, NULL, DST, SRC, false);
+#define BITMAP_LINE_BENCHMARK(VAR, NAME, FN, DST, SRC) \
+  static BitmapLineBenchmark g##VAR##SIMDBenchmark("bitmap." NAME "_simd", NULL, FN, DST, SRC, true); \
+  static BitmapLineBenchmark g##VAR##ScalarBenchmark("bitmap." NAME "_scalar", NULL, FN, DST, SRC, false);
+
+BITMAP_COPY_BENCHMARK(Copy24To32, "copy_24_to_32", NULL, 4, 3)
+BITMAP_COPY_BENCHMARK(Copy32To24, "copy_32_to_24", NULL, 3, 4)
+BITMAP_COPY_BENCHMARK(Copy24To32ARGB, "copy_24_to_32argb", &nglCopyLine24To32ARGB, 4, 3)
+BITMAP_COPY_BENCHMARK(Copy32To32ARGB, "copy_32_to_32argb", &nglCopyLine32To32ARGB, 4, 4)
+BITMAP_LINE_BENCHMARK(PreMultRGBA, "premult_rgba", &nglPreMultLine32RGBA, 4, 4)
+BITMAP_LINE_BENCHMARK(PreMultARGB, "premult_argb", &nglPreMultLine32ARGB, 4, 4)
+BITMAP_LINE_BENCHMARK(UnPreMultRGBA, "unpremult_rgba", &nglUnPreMultLine32RGBA, 4, 4)
+BITMAP_LINE_BENCHMARK(UnPreMultARGB, "unpremult_argb", &nglUnPreMultLine32ARGB, 4, 4)
+
+/// nglScaleImage with the bilinear filter, the image.resize_* scenarios only time the SIMD code
+class BitmapScaleBenchmark : public Benchmark
+{
+public:
+  BitmapScaleBenchmark(const char* pName, bool SIMD)
+  : Benchmark(pName, 10),
+    mSIMD(SIMD)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    BenchmarkRandom random(22);
+    mSource.resize(BITMAP_WIDTH * BITMAP_HEIGHT * 4);
+    for (size_t i = 0; i < mSource.size(); i++)
+      mSource[i] = (uint8)random.Next(256);
+    mTarget.resize(1600 * 1200 * 4);
+
+    nglEnableBitmapSIMD(mSIMD);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    nglScaleImage(&mTarget[0], 600, 450, &mSource[0], BITMAP_WIDTH, BITMAP_HEIGHT, 4, eImageFilterBilinear);
+    nglScaleImage(&mTarget[0], 1600, 1200, &mSource[0], BITMAP_WIDTH, BITMAP_HEIGHT, 4, eImageFilterBilinear);
+  }
+
+  virtual void TearDown()
+  {
+    nglEnableBitmapSIMD(true);
+    mSource.clear();
+    mTarget.clear();
+  }
+
+protected:
+  bool mSIMD;
+  std::vector<uint8> mSource;
+  std::vector<uint8> mTarget;
+};
+
+static BitmapScaleBenchmark gBitmapScaleSIMDBenchmark("bitmap.scale_bilinear_simd", true);
+static BitmapScaleBenchmark gBitmapScaleScalarBenchmark("bitmap.scale_bilinear_scalar", false);
@@ -0,0 +1,543 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Benchmark.h"
+#include "nuiXML.h"
+#include "nuiXMLDocument.h"
+#include "nuiJson.h"
+#include "nglIMemory.h"
+#include "nglZipFS.h"
+#include "nuiRegExp.h"
+#include "zlib.h"
+
+//XML
+static void CreateXML(std::string& rXML)
+{
+  BenchmarkRandom random(7);
+  char buffer[512];
+  rXML = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<library name=\"benchmark\">\n";
+  for (uint32 i = 0; i < 2000; i++)
+  {
+    sprintf(buffer, "  <book id=\"%u\" year=\"%u\" price=\"%u.%02u\" available=\"%s\">\n", i, 1900 + random.Next(120), random.Next(100), random.Next(100), random.Next(2) ? "true" : "false");
+    rXML += buffer;
+    sprintf(buffer, "    <title>Title number %u &amp; volume %u</title>\n    <author first=\"Author%u\" last=\"Name%u\"/>\n", random.Next(100000), random.Next(10), random.Next(1000), random.Next(1000));
+    rXML += buffer;
+    rXML += "    <summary>Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.</summary>\n";
+    uint32 tags = random.Next(6);
+    for (uint32 t = 0; t < tags; t++)
+    {
+      sprintf(buffer, "    <tag weight=\"%u\">tag%u</tag>\n", random.Next(10), random.Next(50));
+      rXML += buffer;
+    }
+    rXML += "  </book>\n";
+  }
+  rXML += "</library>\n";
+}
+
+class XMLBenchmark : public Benchmark
+{
+public:
+  XMLBenchmark()
+  : Benchmark("xml.parse_tree", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateXML(mXML);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    nglIMemory memory(mXML.c_str(), (int64)mXML.size());
+    nuiXML xml;
+    xml.Load(memory);
+  }
+
+  virtual void TearDown()
+  {
+    mXML.clear();
+  }
+
+protected:
+  std::string mXML;
+};
+
+static XMLBenchmark gXMLBenchmark;
+
+class XMLDocumentBenchmark : public Benchmark
+{
+public:
+  XMLDocumentBenchmark()
+  : Benchmark("xml.parse_document", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateXML(mXML);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    nglIMemory memory(mXML.c_str(), (int64)mXML.size());
+    nuiXMLDocument document;
+    document.Load(memory);
+  }
+
+  virtual void TearDown()
+  {
+    mXML.clear();
+  }
+
+protected:
+  std::string mXML;
+};
+
+static XMLDocumentBenchmark gXMLDocumentBenchmark;
+
+
+//JSON
+static void CreateJson(std::string& rJson)
+{
+  BenchmarkRandom random(8);
+  char buffer[512];
+  rJson = "{\n  \"name\": \"benchmark\",\n  \"items\": [\n";
+  for (uint32 i = 0; i < 5000; i++)
+  {
+    sprintf(buffer, "    {\"id\": %u, \"value\": %u.%03u, \"enabled\": %s, \"label\": \"Item \\\"%u\\\" \\u00e9t\\u00e9\", \"tags\": [\"a%u\", \"b%u\", null], \"position\": {\"x\": %d, \"y\": %d}}%s\n",
+      i, random.Next(10000), random.Next(1000), random.Next(2) ? "true" : "false", random.Next(100000), random.Next(100), random.Next(100), (int)random.Next(2000) - 1000, (int)random.Next(2000) - 1000, i < 4999 ? "," : "");
+    rJson += buffer;
+  }
+  rJson += "  ]\n}\n";
+}
+
+class JsonReaderBenchmark : public Benchmark
+{
+public:
+  JsonReaderBenchmark()
+  : Benchmark("json.parse_value", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateJson(mJson);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    nuiJson::Reader reader;
+    nuiJson::Value root;
+    reader.parse(mJson, root, false);
+  }
+
+  virtual void TearDown()
+  {
+    mJson.clear();
+  }
+
+protected:
+  std::string mJson;
+};
+
+static JsonReaderBenchmark gJsonReaderBenchmark;
+
+class JsonDocumentBenchmark : public Benchmark
+{
+public:
+  JsonDocumentBenchmark()
+  : Benchmark("json.parse_document", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateJson(mJson);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    nuiJson::Document document;
+    document.parse(mJson.c_str(), mJson.c_str() + mJson.size());
+  }
+
+  virtual void TearDown()
+  {
+    mJson.clear();
+  }
+
+protected:
+  std::string mJson;
+};
+
+static JsonDocumentBenchmark gJsonDocumentBenchmark;
+
+
+//Images
+class ImageResizeBenchmark : public Benchmark
+{
+public:
+  ImageResizeBenchmark(const char* pName, nglImageFilter Filter)
+  : Benchmark(pName, 20), mFilter(Filter), mpImage(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    nglImageInfo info(1024, 768, 32);
+    info.AllocateBuffer();
+    BenchmarkRandom random(9);
+    uint32* pPixels = (uint32*)info.mpBuffer;
+    for (uint32 y = 0; y < info.mHeight; y++)
+      for (uint32 x = 0; x < info.mWidth; x++)
+        pPixels[y * info.mWidth + x] = ((x * 255 / info.mWidth) << 16) | ((y * 255 / info.mHeight) << 8) | (random.Next(256)) | 0xff000000;
+
+    mpImage = new nglImage(info, eClone);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    // A down scaling by a non integer ratio, then an up scaling
+    delete mpImage->Resize(600, 450, mFilter);
+    delete mpImage->Resize(1600, 1200, mFilter);
+  }
+
+  virtual void TearDown()
+  {
+    delete mpImage;
+    mpImage = NULL;
+  }
+
+protected:
+  nglImageFilter mFilter;
+  nglImage* mpImage;
+};
+
+static ImageResizeBenchmark gImageResizeDefaultBenchmark("image.resize_default", eImageFilterDefault);
+static ImageResizeBenchmark gImageResizeBoxBenchmark("image.resize_box", eImageFilterBox);
+static ImageResizeBenchmark gImageResizeBilinearBenchmark("image.resize_bilinear", eImageFilterBilinear);
+static ImageResizeBenchmark gImageResizeLanczosBenchmark("image.resize_lanczos", eImageFilterLanczos);
+
+
+//Zip
+/// Minimal in memory zip archive writer (stored and raw deflated entries, no zip64)
+class ZipArchiveWriter
+{
+public:
+  void AddFile(const char* pName, const std::vector<uint8>& rData, bool Deflate)
+  {
+    Entry entry;
+    entry.mName = pName;
+    entry.mSize = (uint32)rData.size();
+    entry.mCRC = crc32(crc32(0, NULL, 0), rData.empty() ? NULL : &rData[0], (uInt)rData.size());
+    entry.mOffset = (uint32)mData.size();
+    entry.mMethod = Deflate ? Z_DEFLATED : 0;
+
+    std::vector<uint8> compressed;
+    if (Deflate)
+    {
+      z_stream stream;
+      memset(&stream, 0, sizeof(stream));
+      deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+      compressed.resize(deflateBound(&stream, (uLong)rData.size()));
+      stream.next_in = rData.empty() ? NULL : (Bytef*)&rData[0];
+      stream.avail_in = (uInt)rData.size();
+      stream.next_out = &compressed[0];
+      stream.avail_out = (uInt)compressed.size();
+      deflate(&stream, Z_FINISH);
+      compressed.resize(stream.total_out);
+      deflateEnd(&stream);
+    }
+    const std::vector<uint8>& rStored(Deflate ? compressed : rData);
+    entry.mCompressedSize = (uint32)rStored.size();
+
+    Write32(0x04034b50);
+    Write16(20); // Version needed
+    Write16(0); // Flags
+    Write16(entry.mMethod);
+    Write32(0); // Time and date
+    Write32(entry.mCRC);
+    Write32(entry.mCompressedSize);
+    Write32(entry.mSize);
+    Write16((uint16)entry.mName.size());
+    Write16(0); // Extra field
+    mData.insert(mData.end(), entry.mName.begin(), entry.mName.end());
+    mData.insert(mData.end(), rStored.begin(), rStored.end());
+
+    mEntries.push_back(entry);
+  }
+
+  void Finish(std::vector<uint8>& rArchive)
+  {
+    uint32 directory = (uint32)mData.size();
+    for (size_t i = 0; i < mEntries.size(); i++)
+    {
+      const Entry& rEntry(mEntries[i]);
+      Write32(0x02014b50);
+      Write16(20); // Version made by
+      Write16(20); // Version needed
+      Write16(0); // Flags
+      Write16(rEntry.mMethod);
+      Write32(0); // Time and date
+      Write32(rEntry.mCRC);
+      Write32(rEntry.mCompressedSize);
+      Write32(rEntry.mSize);
+      Write16((uint16)rEntry.mName.size());
+      Write16(0); // Extra field
+      Write16(0); // Comment
+      Write16(0); // Disk
+      Write16(0); // Internal attributes
+      Write32(0); // External attributes
+      Write32(rEntry.mOffset);
+      mData.insert(mData.end(), rEntry.mName.begin(), rEntry.mName.end());
+    }
+    uint32 size = (uint32)mData.size() - directory;
+
+    Write32(0x06054b50);
+    Write16(0); // Disk
+    Write16(0); // Disk of the central directory
+    Write16((uint16)mEntries.size());
+    Write16((uint16)mEntries.size());
+    Write32(size);
+    Write32(directory);
+    Write16(0); // Comment
+
+    rArchive.swap(mData);
+    mData.clear();
+    mEntries.clear();
+  }
+
+private:
+  struct Entry
+  {
+    std::string mName;
+    uint32 mSize;
+    uint32 mCompressedSize;
+    uint32 mCRC;
+    uint32 mOffset;
+    uint16 mMethod;
+  };
+
+  void Write16(uint16 value)
+  {
+    mData.push_back(value & 0xff);
+    mData.push_back(value >> 8);
+  }
+
+  void Write32(uint32 value)
+  {
+    Write16(value & 0xffff);
+    Write16(value >> 16);
+  }
+
+  std::vector<uint8> mData;
+  std::vector<Entry> mEntries;
+};
+
+/// Base class of the scenarios that read from an archive in memory
+class ZipBenchmark : public Benchmark
+{
+public:
+  ZipBenchmark(const char* pName, uint32 Iterations)
+  : Benchmark(pName, Iterations), mpZip(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    // Text files that compress well, a few stored binary files and a large deflated file
+    BenchmarkRandom random(10);
+    ZipArchiveWriter writer;
+    std::vector<uint8> data;
+    char name[64];
+    for (uint32 i = 0; i < 200; i++)
+    {
+      data.clear();
+      uint32 lines = 32 + random.Next(96);
+      for (uint32 l = 0; l < lines; l++)
+      {
+        char line[128];
+        int len = sprintf(line, "line %u of file %u: value=%u\n", l, i, random.Next(1000));
+        data.insert(data.end(), line, line + len);
+      }
+      sprintf(name, "text/file%u.txt", i);
+      writer.AddFile(name, data, true);
+    }
+
+    for (uint32 i = 0; i < 20; i++)
+    {
+      data.resize(16384);
+      for (size_t b = 0; b < data.size(); b++)
+        data[b] = (uint8)random.Next(256);
+      sprintf(name, "binary/file%u.bin", i);
+      writer.AddFile(name, data, false);
+    }
+
+    data.resize(8 << 20);
+    for (size_t b = 0; b < data.size(); b++)
+      data[b] = (uint8)((b >> 7) ^ random.Next(4));
+    writer.AddFile("large.bin", data, true);
+
+    writer.Finish(mArchive);
+    mpZip = new nglZipFS(nglString(GetName()), new nglIMemory(&mArchive[0], (int64)mArchive.size()), true);
+    if (!mpZip->Open())
+      return false;
+
+    nglString path;
+    for (uint32 i = 0; i < 200; i++)
+    {
+      path.Format(_T("/text/file%d.txt"), i);
+      mPaths.push_back(nglPath(path));
+      if (i < 20)
+      {
+        path.Format(_T("/binary/file%d.bin"), i);
+        mPaths.push_back(nglPath(path));
+      }
+    }
+    mBuffer.resize(1 << 16);
+    return true;
+  }
+
+  virtual void TearDown()
+  {
+    delete mpZip;
+    mpZip = NULL;
+    mArchive.clear();
+    mPaths.clear();
+  }
+
+protected:
+  nglZipFS* mpZip;
+  std::vector<uint8> mArchive;
+  std::vector<nglPath> mPaths;
+  std::vector<uint8> mBuffer;
+};
+
+class ZipFilesBenchmark : public ZipBenchmark
+{
+public:
+  ZipFilesBenchmark()
+  : ZipBenchmark("zip.read_files", 20)
+  {
+  }
+
+  virtual void Run()
+  {
+    for (size_t i = 0; i < mPaths.size(); i++)
+    {
+      nglIStream* pStream = mpZip->OpenRead(mPaths[i]);
+      if (!pStream)
+        continue;
+      while (pStream->Read(&mBuffer[0], (int64)mBuffer.size(), 1) > 0)
+        ;
+      delete pStream;
+    }
+  }
+};
+
+static ZipFilesBenchmark gZipFilesBenchmark;
+
+class ZipLargeFileBenchmark : public ZipBenchmark
+{
+public:
+  ZipLargeFileBenchmark()
+  : ZipBenchmark("zip.read_large", 10)
+  {
+  }
+
+  virtual void Run()
+  {
+    nglIStream* pStream = mpZip->OpenRead(nglPath(_T("/large.bin")));
+    if (!pStream)
+      return;
+    while (pStream->Read(&mBuffer[0], (int64)mBuffer.size(), 1) > 0)
+      ;
+    delete pStream;
+  }
+};
+
+static ZipLargeFileBenchmark gZipLargeFileBenchmark;
+
+class ZipSeekBenchmark : public ZipBenchmark
+{
+public:
+  ZipSeekBenchmark()
+  : ZipBenchmark("zip.seek_large", 10)
+  {
+  }
+
+  virtual void Run()
+  {
+    nglIStream* pStream = mpZip->OpenRead(nglPath(_T("/large.bin")));
+    if (!pStream)
+      return;
+    BenchmarkRandom random(11);
+    for (uint32 i = 0; i < 64; i++)
+    {
+      pStream->SetPos(random.Next((8 << 20) - 4096));
+      pStream->Read(&mBuffer[0], 4096, 1);
+    }
+    delete pStream;
+  }
+};
+
+static ZipSeekBenchmark gZipSeekBenchmark;
+
+
+//Regular expressions
+/// Search 4 MB of log lines that don't match the pattern, so the whole text is scanned
+class RegExpBenchmark : public Benchmark
+{
+public:
+  RegExpBenchmark(const char* pName, const char* pPattern)
+  : Benchmark(pName, 10), mpPattern(pPattern), mpRegExp(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    BenchmarkRandom random(15);
+    char buffer[256];
+    while (mText.GetLength() < 4 * 1024 * 1024)
+    {
+      sprintf(buffer, "2026-10-18 12:%02u:%02u INFO nuiWidget: layout pass took %u ms for %u widgets\n", random.Next(60), random.Next(60), random.Next(50), random.Next(10000));
+      mText.Add(buffer);
+    }
+
+    mpRegExp = new nuiRegExp(nglString(mpPattern));
+    return mpRegExp->CompiledOK();
+  }
+
+  virtual void Run()
+  {
+    mpRegExp->Match(mText);
+  }
+
+  virtual void TearDown()
+  {
+    delete mpRegExp;
+    mpRegExp = NULL;
+    mText.Wipe();
+  }
+
+protected:
+  const char* mpPattern;
+  nuiRegExp* mpRegExp;
+  nglString mText;
+};
+
+static RegExpBenchmark gRegExpLiteralBenchmark("regexp.literal", "ERROR.*timeout");
+static RegExpBenchmark gRegExpClassesBenchmark("regexp.classes", "[0-9]+ ms for [0-9]+ gadgets");
+static RegExpBenchmark gRegExpWordsBenchmark("regexp.words", "\\<layout\\>.*\\<frame\\>");
+static RegExpBenchmark gRegExpGroupsBenchmark("regexp.groups", "(.*)(.*)(.*)(.*)(.*)[QZ]");
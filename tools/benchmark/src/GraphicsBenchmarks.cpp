@@ -0,0 +1,329 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Benchmark.h"
+#include "nuiDrawContext.h"
+#include "nuiGradient.h"
+#include "nuiSpriteView.h"
+
+#define BENCHMARK_WIDTH 1024
+#define BENCHMARK_HEIGHT 768
+
+/// Base class of the scenarios that render with nuiSoftwarePainter in an offscreen buffer
+class PainterBenchmark : public Benchmark
+{
+public:
+  PainterBenchmark(const char* pName, uint32 Iterations)
+  : Benchmark(pName, Iterations), mpContext(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    // The software painter must exist before the textures are created so that they keep their pixels
+    mRect.Set(0, 0, BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+    mpContext = nuiDrawContext::CreateDrawContext(mRect, eSoftware, NULL);
+    return mpContext != NULL;
+  }
+
+  virtual void Run()
+  {
+    mpContext->StartRendering();
+    mpContext->Set2DProjectionMatrix(mRect);
+    mpContext->ResetState();
+    mpContext->SetClearColor(nuiColor(0, 0, 0, 255));
+    mpContext->Clear();
+    Render();
+    mpContext->StopRendering();
+  }
+
+  virtual void TearDown()
+  {
+    delete mpContext;
+    mpContext = NULL;
+  }
+
+protected:
+  virtual void Render() = 0;
+
+  nuiRect mRect;
+  nuiDrawContext* mpContext;
+};
+
+class FillRectsBenchmark : public PainterBenchmark
+{
+public:
+  FillRectsBenchmark()
+  : PainterBenchmark("painter.fill_rects", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    if (!PainterBenchmark::Setup())
+      return false;
+
+    BenchmarkRandom random(1);
+    mRects.resize(2000);
+    mColors.resize(mRects.size());
+    for (size_t i = 0; i < mRects.size(); i++)
+    {
+      float w = 8 + random.Next(120);
+      float h = 8 + random.Next(120);
+      mRects[i].Set((float)random.Next(BENCHMARK_WIDTH) - w * .5f, (float)random.Next(BENCHMARK_HEIGHT) - h * .5f, w, h);
+      mColors[i] = nuiColor(random.NextFloat(), random.NextFloat(), random.NextFloat(), .25f + random.NextFloat() * .75f);
+    }
+    return true;
+  }
+
+protected:
+  virtual void Render()
+  {
+    mpContext->EnableBlending(true);
+    mpContext->SetBlendFunc(nuiBlendTransp);
+    for (size_t i = 0; i < mRects.size(); i++)
+    {
+      mpContext->SetFillColor(mColors[i]);
+      mpContext->DrawRect(mRects[i], eFillShape);
+    }
+  }
+
+  std::vector<nuiRect> mRects;
+  std::vector<nuiColor> mColors;
+};
+
+static FillRectsBenchmark gFillRectsBenchmark;
+
+class GradientsBenchmark : public PainterBenchmark
+{
+public:
+  GradientsBenchmark()
+  : PainterBenchmark("painter.gradients", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    if (!PainterBenchmark::Setup())
+      return false;
+
+    BenchmarkRandom random(2);
+    mRects.resize(200);
+    for (size_t i = 0; i < mRects.size(); i++)
+      mRects[i].Set((float)random.Next(BENCHMARK_WIDTH - 128), (float)random.Next(BENCHMARK_HEIGHT - 128), 32.0f + random.Next(96), 32.0f + random.Next(96));
+
+    mGradient.AddStop(nuiColor(1.0f, 0.2f, 0.2f, 1.0f), 0);
+    mGradient.AddStop(nuiColor(0.2f, 1.0f, 0.2f, 0.5f), .5f);
+    mGradient.AddStop(nuiColor(0.2f, 0.2f, 1.0f, 1.0f), 1);
+    return true;
+  }
+
+protected:
+  virtual void Render()
+  {
+    mpContext->EnableBlending(true);
+    mpContext->SetBlendFunc(nuiBlendTransp);
+    for (size_t i = 0; i < mRects.size(); i++)
+    {
+      const nuiRect& rRect(mRects[i]);
+      if (i & 1)
+        mpContext->DrawGradient(mGradient, rRect, rRect.Left(), rRect.Top(), rRect.Left(), rRect.Bottom());
+      else
+        mpContext->DrawGradient(mGradient, rRect, rRect.Left(), rRect.Top(), rRect.Right(), rRect.Bottom());
+    }
+  }
+
+  std::vector<nuiRect> mRects;
+  nuiGradient mGradient;
+};
+
+static GradientsBenchmark gGradientsBenchmark;
+
+class TextBenchmark : public PainterBenchmark
+{
+public:
+  TextBenchmark()
+  : PainterBenchmark("painter.text", 20), mpFont(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    if (!PainterBenchmark::Setup())
+      return false;
+
+    mpFont = nuiFont::GetFont(12);
+    if (!mpFont)
+      return false;
+
+    BenchmarkRandom random(3);
+    const char* pWords[] = { "nui", "widget", "layout", "render", "glyph", "texture", "sprite", "audio", "The", "quick", "brown", "fox", "jumps", "over", "the", "lazy", "dog", "0123456789" };
+    const uint32 words = sizeof(pWords) / sizeof(pWords[0]);
+    mLines.resize(60);
+    for (size_t i = 0; i < mLines.size(); i++)
+    {
+      nglString& rLine(mLines[i]);
+      for (uint32 w = 0; w < 12; w++)
+      {
+        if (w)
+          rLine.Add(' ');
+        rLine.Add(pWords[random.Next(words)]);
+      }
+    }
+    return true;
+  }
+
+  virtual void TearDown()
+  {
+    PainterBenchmark::TearDown();
+    if (mpFont)
+      mpFont->Release();
+    mpFont = NULL;
+    mLines.clear();
+  }
+
+protected:
+  virtual void Render()
+  {
+    mpContext->SetFont(mpFont);
+    mpContext->SetTextColor(nuiColor(255, 255, 255));
+    for (size_t i = 0; i < mLines.size(); i++)
+      mpContext->DrawText(4, 12.0f * (i + 1), mLines[i]);
+  }
+
+  nuiFont* mpFont;
+  std::vector<nglString> mLines;
+};
+
+static TextBenchmark gTextBenchmark;
+
+/// Animated sprites from a two page atlas, drawn with nuiSpriteBatch or one at a time
+/*!
+The sprites either pick their page and blend function at random, which gives nuiSpriteBatch runs of a few sprites, or
+are grouped by page and blend function, which lets it draw them with four render arrays.
+*/
+class SpritesBenchmark : public PainterBenchmark
+{
+public:
+  SpritesBenchmark(const char* pName, bool Batch, bool Grouped)
+  : PainterBenchmark(pName, 20), mBatch(Batch), mGrouped(Grouped), mpDef(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    if (!PainterBenchmark::Setup())
+      return false;
+
+    nglString prefix(GetName());
+    mpDef = new nuiSpriteDef(prefix);
+    mpDef->Acquire();
+
+    for (uint32 page = 0; page < 2; page++)
+    {
+      nglImageInfo info(256, 256, 32);
+      info.AllocateBuffer();
+      uint32* pPixels = (uint32*)info.mpBuffer;
+      for (uint32 y = 0; y < 256; y++)
+        for (uint32 x = 0; x < 256; x++)
+          pPixels[y * 256 + x] = ((x ^ y) & 8) ? 0xffffffff : (page ? 0x80ff8040 : 0x804080ff);
+
+      nglString name;
+      name.Format(_T("%ls.page%d"), prefix.GetChars(), page);
+      nuiTexture* pAtlas = nuiTexture::GetTexture(info, true);
+      pAtlas->SetSource(name);
+      mpAtlas.push_back(pAtlas);
+
+      nuiSpriteAnimation* pAnim = new nuiSpriteAnimation();
+      pAnim->SetFPS(30);
+      for (uint32 i = 0; i < 16; i++)
+      {
+        nuiRect rect((float)(i % 4) * 64, (float)(i / 4) * 64, 64.0f, 64.0f);
+        nglString proxy;
+        proxy.Format(_T("%ls.frame%d"), name.GetChars(), i);
+        nuiTexture* pProxy = nuiTexture::CreateTextureProxy(proxy, name, rect, false);
+        nuiSpriteFrame* pFrame = new nuiSpriteFrame();
+        pFrame->SetTexture(pProxy, nuiRect(0.0f, 0.0f, 64.0f, 64.0f));
+        pFrame->SetHandle(32, 32);
+        pAnim->AddFrame(pFrame);
+      }
+      mpDef->AddAnimation(pAnim);
+    }
+
+    BenchmarkRandom random(4);
+    mpSprites.resize(5000);
+    for (size_t i = 0; i < mpSprites.size(); i++)
+    {
+      nuiSprite* pSprite = new nuiSprite(mpDef);
+      pSprite->Acquire();
+      uint32 page = random.Next(2);
+      bool add = !(i % 3);
+      if (mGrouped)
+      {
+        page = (i * 2) / mpSprites.size();
+        add = ((i * 4) / mpSprites.size()) & 1;
+      }
+      pSprite->SetAnimation(page);
+      pSprite->SetFrameTime(random.NextFloat() * 16);
+      pSprite->SetPosition((float)random.Next(BENCHMARK_WIDTH), (float)random.Next(BENCHMARK_HEIGHT));
+      if (i & 1)
+        pSprite->SetAngle(random.NextFloat() * 360);
+      if (add)
+        pSprite->SetBlendFunc(nuiBlendTranspAdd);
+      mpSprites[i] = pSprite;
+    }
+
+    return true;
+  }
+
+  virtual void TearDown()
+  {
+    for (size_t i = 0; i < mpSprites.size(); i++)
+      mpSprites[i]->Release();
+    mpSprites.clear();
+    if (mpDef)
+      mpDef->Release();
+    mpDef = NULL;
+    for (size_t i = 0; i < mpAtlas.size(); i++)
+      mpAtlas[i]->Release();
+    mpAtlas.clear();
+    PainterBenchmark::TearDown();
+  }
+
+protected:
+  virtual void Render()
+  {
+    // A fixed time step keeps the animations deterministic
+    const float step = 1.0f / 60.0f;
+    if (mBatch)
+    {
+      mSpriteBatch.Gather(mpSprites);
+      mSpriteBatch.Animate(step);
+      mSpriteBatch.Draw(mpContext);
+      mSpriteBatch.FireAnimEnd();
+      return;
+    }
+
+    for (size_t i = 0; i < mpSprites.size(); i++)
+    {
+      mpSprites[i]->Animate(step);
+      mpSprites[i]->Draw(mpContext);
+    }
+  }
+
+  bool mBatch;
+  bool mGrouped;
+  nuiSpriteDef* mpDef;
+  std::vector<nuiTexture*> mpAtlas;
+  std::vector<nuiSprite*> mpSprites;
+  nuiSpriteBatch mSpriteBatch;
+};
+
+static SpritesBenchmark gSpritesBenchmark("painter.sprites", false, false);
+static SpritesBenchmark gSpritesBatchBenchmark("painter.sprites_batch", true, false);
+static SpritesBenchmark gSpritesBatchGroupedBenchmark("painter.sprites_batch_grouped", true, true);
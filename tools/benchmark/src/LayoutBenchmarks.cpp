@@ -0,0 +1,270 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Benchmark.h"
+#include "nuiVBox.h"
+#include "nuiHBox.h"
+#include "nuiLabel.h"
+#include "nuiCSS.h"
+#include "nuiString8.h"
+#include "nuiFontBase.h"
+
+/// A vertical box of horizontal boxes of labels, without a top level
+class WidgetTree
+{
+public:
+  WidgetTree()
+  : mpRoot(NULL)
+  {
+  }
+
+  ~WidgetTree()
+  {
+    Clear();
+  }
+
+  void Create(uint32 Rows, uint32 Columns)
+  {
+    Clear();
+    BenchmarkRandom random(5);
+    nuiVBox* pRoot = new nuiVBox(0);
+    pRoot->SetObjectName(_T("Root"));
+    mpWidgets.push_back(pRoot);
+    for (uint32 r = 0; r < Rows; r++)
+    {
+      nuiHBox* pRow = new nuiHBox(0);
+      nglString name;
+      name.Format(_T("Row%d"), r);
+      pRow->SetObjectName(name);
+      pRoot->AddCell(pRow);
+      mpWidgets.push_back(pRow);
+      for (uint32 c = 0; c < Columns; c++)
+      {
+        nglString text;
+        text.Format(_T("Label %d x %d"), r, random.Next(100000));
+        nuiLabel* pLabel = new nuiLabel(text);
+        name.Format(_T("Label%d"), random.Next(256));
+        pLabel->SetObjectName(name);
+        pRow->AddCell(pLabel);
+        mpWidgets.push_back(pLabel);
+      }
+    }
+    mpRoot = pRoot;
+  }
+
+  void Clear()
+  {
+    delete mpRoot;
+    mpRoot = NULL;
+    mpWidgets.clear();
+  }
+
+  nuiWidget* mpRoot;
+  std::vector<nuiWidget*> mpWidgets; ///< All the widgets of the tree, parents first
+};
+
+/// Compute the ideal sizes and the layout of the whole tree, at alternating widths
+class LayoutBenchmark : public Benchmark
+{
+public:
+  LayoutBenchmark()
+  : Benchmark("layout.widget_tree", 20), mpFont(NULL), mWide(false)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    // The labels need the default font to measure their text
+    mpFont = nuiFont::GetFont(12);
+    if (!mpFont)
+      return false;
+
+    mTree.Create(100, 50);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    // Invalidate every widget so that the whole tree is measured again:
+    for (size_t i = 0; i < mTree.mpWidgets.size(); i++)
+      mTree.mpWidgets[i]->InvalidateLayout();
+
+    mWide = !mWide;
+    nuiRect rect(mTree.mpRoot->GetIdealRect());
+    if (mWide)
+      rect.SetWidth(rect.GetWidth() * 2);
+    mTree.mpRoot->SetLayout(rect);
+  }
+
+  virtual void TearDown()
+  {
+    mTree.Clear();
+    if (mpFont)
+      mpFont->Release();
+    mpFont = NULL;
+  }
+
+protected:
+  nuiFont* mpFont;
+  WidgetTree mTree;
+  bool mWide;
+};
+
+static LayoutBenchmark gLayoutBenchmark;
+
+/// A style sheet with class rules and many name rules
+static void CreateStyleSheet(std::string& rCSS)
+{
+  rCSS = "nuiLabel!\n{\n  TextColor: white;\n  BorderLeft: 2;\n  BorderRight: 2;\n}\n\n";
+  rCSS += "nuiHBox!\n{\n  BorderTop: 1;\n  BorderBottom: 1;\n}\n\n";
+  rCSS += "\"Root\"!\n{\n  BorderLeft: 10;\n  BorderRight: 10;\n}\n\n";
+
+  char buffer[256];
+  for (uint32 i = 0; i < 256; i++)
+  {
+    sprintf(buffer, "\"Label%u\"!\n{\n  TextColor: rgb(%u,%u,%u);\n  BorderTop: %u;\n}\n\n", i, i, 255 - i, (i * 7) & 255, i & 3);
+    rCSS += buffer;
+  }
+  for (uint32 i = 0; i < 100; i++)
+  {
+    sprintf(buffer, "\"Row%u\"!\n{\n  BorderLeft: %u;\n}\n\n", i, i & 7);
+    rCSS += buffer;
+  }
+  rCSS += "// blank ending line following\n\n";
+}
+
+class CSSParseBenchmark : public Benchmark
+{
+public:
+  CSSParseBenchmark()
+  : Benchmark("css.parse", 50)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateStyleSheet(mSource);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    nuiCSS css;
+    css.Load(nuiString8(mSource.c_str()));
+  }
+
+protected:
+  std::string mSource;
+};
+
+static CSSParseBenchmark gCSSParseBenchmark;
+
+/// Match and apply the style sheet to every widget of a large tree, as nuiTopLevel does
+class CSSApplyBenchmark : public Benchmark
+{
+public:
+  CSSApplyBenchmark()
+  : Benchmark("css.apply", 20), mpFont(NULL), mpCSS(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    mpFont = nuiFont::GetFont(12);
+    if (!mpFont)
+      return false;
+
+    std::string source;
+    CreateStyleSheet(source);
+    mpCSS = new nuiCSS();
+    if (!mpCSS->Load(nuiString8(source.c_str())))
+      return false;
+
+    mTree.Create(100, 50);
+    return true;
+  }
+
+  virtual void Run()
+  {
+    for (size_t i = 0; i < mTree.mpWidgets.size(); i++)
+      mpCSS->ApplyRules(mTree.mpWidgets[i], NUI_WIDGET_MATCHTAG_ALL);
+  }
+
+  virtual void TearDown()
+  {
+    mTree.Clear();
+    delete mpCSS;
+    mpCSS = NULL;
+    if (mpFont)
+      mpFont->Release();
+    mpFont = NULL;
+  }
+
+protected:
+  nuiFont* mpFont;
+  nuiCSS* mpCSS;
+  WidgetTree mTree;
+};
+
+static CSSApplyBenchmark gCSSApplyBenchmark;
+
+/// Shape paragraphs of text with the default font
+class FontLayoutBenchmark : public Benchmark
+{
+public:
+  FontLayoutBenchmark()
+  : Benchmark("text.font_layout", 50), mpFont(NULL)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    mpFont = nuiFont::GetFont(14);
+    if (!mpFont)
+      return false;
+
+    BenchmarkRandom random(6);
+    const char* pWords[] = { "Lorem", "ipsum", "dolor", "sit", "amet,", "consectetur", "adipiscing", "elit.", "Sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore", "et", "dolore", "magna", "aliqua.", "AVWATo", "fi", "1234,56" };
+    const uint32 words = sizeof(pWords) / sizeof(pWords[0]);
+    mParagraphs.resize(50);
+    for (size_t i = 0; i < mParagraphs.size(); i++)
+    {
+      nglString& rText(mParagraphs[i]);
+      for (uint32 w = 0; w < 80; w++)
+      {
+        if (w)
+          rText.Add(' ');
+        rText.Add(pWords[random.Next(words)]);
+      }
+    }
+    return true;
+  }
+
+  virtual void Run()
+  {
+    for (size_t i = 0; i < mParagraphs.size(); i++)
+    {
+      nuiFontLayout layout(*mpFont, 0, 0, nuiHorizontal);
+      layout.Layout(mParagraphs[i]);
+    }
+  }
+
+  virtual void TearDown()
+  {
+    if (mpFont)
+      mpFont->Release();
+    mpFont = NULL;
+    mParagraphs.clear();
+  }
+
+protected:
+  nuiFont* mpFont;
+  std::vector<nglString> mParagraphs;
+};
+
+static FontLayoutBenchmark gFontLayoutBenchmark;
@@ -0,0 +1,253 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Benchmark.h"
+#include "nuiRenderArray.h"
+
+#define MATRIX_COUNT 256
+#define VERTEX_COUNT 20000
+#define RECT_COUNT 10000
+
+// The results of the float matrixes, that have SSE versions on x86, are checked against the generic template with
+// doubles before the scenarios are timed. A scenario that gives wrong results is reported as skipped; the nuitest_matrix
+// test covers the same code paths and fails on them.
+#define MATRIX_TOLERANCE 1e-3
+
+static nglMatrixd ToDouble(const nglMatrixf& rMatrix)
+{
+  nglMatrixd matrix;
+  for (uint32 i = 0; i < 16; i++)
+    matrix.Array[i] = rMatrix.Array[i];
+  return matrix;
+}
+
+static bool CheckValue(const char* pName, double Value, double Expected)
+{
+  if (fabs(Value - Expected) <= MATRIX_TOLERANCE * MAX(1.0, fabs(Expected)))
+    return true;
+  NGL_OUT(_T("%ls: %f instead of %f\n"), nglString(pName).GetChars(), Value, Expected);
+  return false;
+}
+
+static void CreateMatrixes(std::vector<nglMatrixf>& rMatrixes, uint32 Seed)
+{
+  BenchmarkRandom random(Seed);
+  rMatrixes.resize(MATRIX_COUNT);
+  for (size_t i = 0; i < rMatrixes.size(); i++)
+  {
+    // Widget like transformations, with a few arbitrary matrixes:
+    nglMatrixf& rMatrix(rMatrixes[i]);
+    if (i % 8)
+    {
+      rMatrix.SetRotation(random.NextFloat() * 360, 0, 0, 1);
+      rMatrix.Translate(random.NextFloat() * 1000, random.NextFloat() * 1000, 0);
+      rMatrix.Scale(.5f + random.NextFloat(), .5f + random.NextFloat(), 1);
+    }
+    else
+    {
+      for (uint32 j = 0; j < 16; j++)
+        rMatrix.Array[j] = random.NextFloat() * 2 - 1;
+      rMatrix.Array[0] += 4;
+      rMatrix.Array[5] += 4;
+      rMatrix.Array[10] += 4;
+      rMatrix.Array[15] += 4;
+    }
+  }
+}
+
+class MatrixBenchmark : public Benchmark
+{
+public:
+  MatrixBenchmark()
+  : Benchmark("matrix.multiply_invert", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateMatrixes(mMatrixes, 11);
+    mResults.resize(mMatrixes.size());
+
+    for (size_t i = 0; i < mMatrixes.size(); i++)
+    {
+      const nglMatrixf& rA(mMatrixes[i]);
+      const nglMatrixf& rB(mMatrixes[(i + 1) % mMatrixes.size()]);
+      nglMatrixf product(rA * rB);
+      nglMatrixf inverse(rA);
+      inverse.Invert();
+      nglVectorf vector(rB.Array[0], rB.Array[1], rB.Array[2], 1);
+      vector = rA * vector;
+
+      nglMatrixd productd(ToDouble(rA) * ToDouble(rB));
+      nglMatrixd inversed(ToDouble(rA));
+      inversed.Invert();
+      nglVectord vectord(rB.Array[0], rB.Array[1], rB.Array[2], 1);
+      vectord = ToDouble(rA) * vectord;
+
+      for (uint32 j = 0; j < 16; j++)
+      {
+        if (!CheckValue("multiply", product.Array[j], productd.Array[j]) || !CheckValue("invert", inverse.Array[j], inversed.Array[j]))
+          return false;
+      }
+      for (uint32 j = 0; j < 4; j++)
+      {
+        if (!CheckValue("transform", vector[j], vectord[j]))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  virtual void Run()
+  {
+    for (uint32 pass = 0; pass < 100; pass++)
+    {
+      for (size_t i = 0; i < mMatrixes.size(); i++)
+      {
+        nglMatrixf& rResult(mResults[i]);
+        rResult = mMatrixes[i];
+        rResult *= mMatrixes[(i + pass) % mMatrixes.size()];
+        rResult.Invert();
+      }
+    }
+  }
+
+  virtual void TearDown()
+  {
+    mMatrixes.clear();
+    mResults.clear();
+  }
+
+protected:
+  std::vector<nglMatrixf> mMatrixes;
+  std::vector<nglMatrixf> mResults;
+};
+
+static MatrixBenchmark gMatrixBenchmark;
+
+class TransformVerticesBenchmark : public Benchmark
+{
+public:
+  TransformVerticesBenchmark()
+  : Benchmark("matrix.transform_vertices", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateMatrixes(mMatrixes, 12);
+    BenchmarkRandom random(13);
+    mVertices.resize(VERTEX_COUNT);
+    for (size_t i = 0; i < mVertices.size(); i++)
+    {
+      nuiRenderArray::Vertex& rVertex(mVertices[i]);
+      rVertex.mX = random.NextFloat() * 1000;
+      rVertex.mY = random.NextFloat() * 1000;
+      rVertex.mZ = 0;
+      rVertex.mR = rVertex.mG = rVertex.mB = rVertex.mA = (GLubyte)random.Next(256);
+      rVertex.mTX = random.NextFloat();
+      rVertex.mTY = random.NextFloat();
+    }
+    mTransformed.resize(mVertices.size());
+
+    for (size_t m = 0; m < mMatrixes.size(); m++)
+    {
+      nuiRenderArray::TransformVertices(mMatrixes[m], &mVertices[0], &mTransformed[0], 64);
+      nglMatrixd matrix(ToDouble(mMatrixes[m]));
+      for (size_t i = 0; i < 64; i++)
+      {
+        nglVectord vector(mVertices[i].mX, mVertices[i].mY, mVertices[i].mZ);
+        vector = matrix * vector;
+        if (!CheckValue("vertex x", mTransformed[i].mX, vector[0]) || !CheckValue("vertex y", mTransformed[i].mY, vector[1]) || !CheckValue("vertex z", mTransformed[i].mZ, vector[2]))
+          return false;
+        if (mTransformed[i].mA != mVertices[i].mA || mTransformed[i].mTX != mVertices[i].mTX || mTransformed[i].mTY != mVertices[i].mTY)
+        {
+          NGL_OUT(_T("vertex attributes changed\n"));
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  virtual void Run()
+  {
+    for (size_t m = 0; m < 32; m++)
+      nuiRenderArray::TransformVertices(mMatrixes[m], &mVertices[0], &mTransformed[0], mVertices.size());
+  }
+
+  virtual void TearDown()
+  {
+    mMatrixes.clear();
+    mVertices.clear();
+    mTransformed.clear();
+  }
+
+protected:
+  std::vector<nglMatrixf> mMatrixes;
+  std::vector<nuiRenderArray::Vertex> mVertices;
+  std::vector<nuiRenderArray::Vertex> mTransformed;
+};
+
+static TransformVerticesBenchmark gTransformVerticesBenchmark;
+
+class TransformRectsBenchmark : public Benchmark
+{
+public:
+  TransformRectsBenchmark()
+  : Benchmark("matrix.transform_rects", 20)
+  {
+  }
+
+  virtual bool Setup()
+  {
+    CreateMatrixes(mMatrixes, 14);
+    BenchmarkRandom random(15);
+    mRects.resize(RECT_COUNT);
+    for (size_t i = 0; i < mRects.size(); i++)
+      mRects[i].Set(random.NextFloat() * 1000, random.NextFloat() * 1000, random.NextFloat() * 200, random.NextFloat() * 200);
+    mTransformed.resize(mRects.size());
+
+    for (size_t m = 0; m < mMatrixes.size(); m++)
+    {
+      nuiRect::Transform(mMatrixes[m], &mRects[0], &mTransformed[0], 64);
+      nglMatrixd matrix(ToDouble(mMatrixes[m]));
+      for (size_t i = 0; i < 64; i++)
+      {
+        nglVectord topleft(mRects[i].mLeft, mRects[i].mTop, 0);
+        nglVectord bottomright(mRects[i].mRight, mRects[i].mBottom, 0);
+        topleft = matrix * topleft;
+        bottomright = matrix * bottomright;
+        if (!CheckValue("rect left", mTransformed[i].mLeft, topleft[0]) || !CheckValue("rect top", mTransformed[i].mTop, topleft[1])
+         || !CheckValue("rect right", mTransformed[i].mRight, bottomright[0]) || !CheckValue("rect bottom", mTransformed[i].mBottom, bottomright[1]))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  virtual void Run()
+  {
+    for (size_t m = 0; m < 32; m++)
+      nuiRect::Transform(mMatrixes[m], &mRects[0], &mTransformed[0], mRects.size());
+  }
+
+  virtual void TearDown()
+  {
+    mMatrixes.clear();
+    mRects.clear();
+    mTransformed.clear();
+  }
+
+protected:
+  std::vector<nglMatrixf> mMatrixes;
+  std::vector<nuiRect> mRects;
+  std::vector<nuiRect> mTransformed;
+};
+
+static TransformRectsBenchmark gTransformRectsBenchmark;
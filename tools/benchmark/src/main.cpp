@@ -0,0 +1,128 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "Benchmark.h"
+
+static void Usage()
+{
+  fprintf(stderr,
+    "usage: nuibenchmark [options]\n"
+    "  --list                 list the scenarios\n"
+    "  --filter <text>        only run the scenarios whose name contains text (can be repeated)\n"
+    "  --iterations <count>   measured iterations per scenario (default: each scenario's own count)\n"
+    "  --output <file>        write the JSON report to file instead of the standard output\n"
+    "  --baseline <file>      compare the medians with a previous JSON report\n"
+    "  --threshold <percent>  slow down of the median reported as a regression (default: 10)\n"
+    "\n"
+    "With --baseline the exit code is 2 when at least one scenario regressed.\n");
+}
+
+static bool Match(const Benchmark* pBenchmark, const std::vector<nglString>& rFilters)
+{
+  if (rFilters.empty())
+    return true;
+
+  nglString name(pBenchmark->GetName());
+  for (size_t i = 0; i < rFilters.size(); i++)
+  {
+    if (name.Find(rFilters[i]) >= 0)
+      return true;
+  }
+  return false;
+}
+
+int main(int argc, char** argv)
+{
+  bool list = false;
+  uint32 iterations = 0;
+  double threshold = 10;
+  nglString output;
+  nglString baseline;
+  std::vector<nglString> filters;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char* pArg = argv[i];
+    bool hasvalue = (i + 1) < argc;
+    if (!strcmp(pArg, "--list"))
+      list = true;
+    else if (!strcmp(pArg, "--filter") && hasvalue)
+      filters.push_back(nglString(argv[++i]));
+    else if (!strcmp(pArg, "--iterations") && hasvalue)
+      iterations = atoi(argv[++i]);
+    else if (!strcmp(pArg, "--output") && hasvalue)
+      output = argv[++i];
+    else if (!strcmp(pArg, "--baseline") && hasvalue)
+      baseline = argv[++i];
+    else if (!strcmp(pArg, "--threshold") && hasvalue)
+      threshold = atof(argv[++i]);
+    else
+    {
+      Usage();
+      return 1;
+    }
+  }
+
+  const std::vector<Benchmark*>& rBenchmarks(Benchmark::GetBenchmarks());
+  if (list)
+  {
+    for (size_t i = 0; i < rBenchmarks.size(); i++)
+      printf("%s\n", rBenchmarks[i]->GetName());
+    return 0;
+  }
+
+  // No window and no GL context: nuiInit only sets up a manual kernel
+  nuiInit(NULL);
+
+  std::vector<BenchmarkResult> results;
+  for (size_t i = 0; i < rBenchmarks.size(); i++)
+  {
+    Benchmark* pBenchmark = rBenchmarks[i];
+    if (!Match(pBenchmark, filters))
+      continue;
+
+    results.push_back(BenchmarkResult());
+    BenchmarkResult& rResult(results.back());
+    double duration = BenchmarkRun(pBenchmark, iterations ? iterations : pBenchmark->GetIterations(), rResult);
+    if (rResult.mSkipped)
+      fprintf(stderr, "%-32s skipped\n", pBenchmark->GetName());
+    else
+      fprintf(stderr, "%-32s median %9.3f ms  p95 %9.3f ms  (%.1f s)\n", pBenchmark->GetName(), rResult.mMedian, rResult.mP95, duration);
+  }
+
+  int res = 0;
+  if (!baseline.IsEmpty())
+  {
+    if (!BenchmarkCompare(results, nglPath(baseline), threshold))
+    {
+      res = 1;
+    }
+    else
+    {
+      for (size_t i = 0; i < results.size(); i++)
+      {
+        const BenchmarkResult& rResult(results[i]);
+        if (!rResult.mHasBaseline)
+          continue;
+        fprintf(stderr, "%-32s %+7.1f%%%s\n", rResult.mName.GetStdString().c_str(), rResult.mChange, rResult.mRegression ? "  REGRESSION" : "");
+        if (rResult.mRegression)
+          res = 2;
+      }
+    }
+  }
+
+  if (!BenchmarkWriteResults(results, output))
+  {
+    fprintf(stderr, "Unable to write '%s'\n", output.GetStdString().c_str());
+    res = 1;
+  }
+
+  nuiUninit();
+  return res;
+}
@@ -0,0 +1,283 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Checks that the SIMD sample format converters give the same bits as the scalar formulas on random buffers of random
+// lengths, and measures the signal to noise ratio and the alias rejection of nuiAudioSincResampler.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiAudioConvert.h"
+#include "nuiAudioResampler.h"
+#include "Test.h"
+
+static uint32 gSeed = 1;
+
+static uint32 Random(uint32 Max)
+{
+  gSeed = gSeed * 1103515245 + 12345;
+  return (gSeed >> 8) % Max;
+}
+
+static float RandomFloat(float Min, float Max)
+{
+  return Min + (Max - Min) * (float)Random(1 << 20) / (float)(1 << 20);
+}
+
+// Scalar references:
+static float Int16ToFloat(int16 Sample)
+{
+  float value = Sample;
+  return Sample < 0 ? value * (float)(1.0 / 32768.0f) : value * (float)(1.0 / 32767.0f);
+}
+
+static int16 FloatToInt16(float Sample)
+{
+  float value = nuiClamp(Sample, -1.0f, 1.0f);
+  return value < 0 ? (int16)(int32)(value * 32768.f) : (int16)(int32)(value * 32767.f);
+}
+
+static int32 FloatToInt24(float Sample)
+{
+  float value = nuiClamp(Sample, -1.0f, 1.0f);
+  return Sample < 0 ? (int32)(value * 8388608.f) : (int32)(value * 8388607.f);
+}
+
+static float Int32ToFloat(int32 Sample)
+{
+  return Sample < 0 ? Sample * (float)(1.0 / 2147483648.0f) : Sample * (float)(1.0 / 2147483647.0f);
+}
+
+static int32 FloatToInt32(float Sample)
+{
+  float value = nuiClamp(Sample, -1.0f, 1.0f);
+  return value < 0 ? (int32)(value * 2147483648.f) : (int32)MIN(value * 2147483647.f, 2147483520.f);
+}
+
+#define CHECK_SAMPLES(CONDITION, NAME) \
+  for (uint32 i = 0; i < Count; i++) \
+  { \
+    if (!(CONDITION)) \
+    { \
+      TestFail("%s: sample %u of %u differs from the scalar code", NAME, i, Count); \
+      break; \
+    } \
+  }
+
+static void CheckConverters(uint32 Count)
+{
+  // Buffers have at least one element so that &v[0] is valid:
+  const uint32 size = Count + 1;
+
+  std::vector<int16> int16s(size);
+  for (uint32 i = 0; i < Count; i++)
+    int16s[i] = (int16)((int32)Random(65536) - 32768);
+  if (Count > 2)
+  {
+    int16s[0] = -32768;
+    int16s[1] = 32767;
+  }
+
+  std::vector<float> floats(size);
+  for (uint32 i = 0; i < Count; i++)
+    floats[i] = RandomFloat(-1.2f, 1.2f); // Out of range samples are clipped
+  if (Count > 2)
+  {
+    floats[0] = 1.0f;
+    floats[1] = -1.0f;
+  }
+
+  // 16 bits to float in place: the int16 samples are in the second half of the buffer
+  {
+    std::vector<float> buffer(size);
+    memcpy((int16*)&buffer[0] + Count, &int16s[0], Count * sizeof(int16));
+    nuiAudioConvert_16bitsBufferToFloat(&buffer[0], Count);
+    CHECK_SAMPLES(buffer[i] == Int16ToFloat(int16s[i]), "16 bits to float");
+  }
+
+  {
+    std::vector<float> input(floats);
+    std::vector<int16> output(size);
+    nuiAudioConvert_FloatBufferTo16bits(&input[0], &output[0], Count);
+    CHECK_SAMPLES(output[i] == FloatToInt16(floats[i]), "float to 16 bits");
+  }
+
+  // 24 bits, with a guard byte to catch overruns:
+  {
+    std::vector<uint8> bytes(Count * 3 + 1);
+    for (size_t i = 0; i < bytes.size(); i++)
+      bytes[i] = (uint8)Random(256);
+    std::vector<float> output(size);
+    nuiAudioConvert_24bitsLittleEndianToFloat(&bytes[0], &output[0], Count);
+    CHECK_SAMPLES(output[i] == nuiAudioConvert_24bitsToFloatFromLittleEndian(&bytes[i * 3]), "24 bits little endian to float");
+    nuiAudioConvert_24bitsBigEndianToFloat(&bytes[0], &output[0], Count);
+    CHECK_SAMPLES(output[i] == nuiAudioConvert_24bitsToFloatFromBigEndian(&bytes[i * 3]), "24 bits big endian to float");
+
+    std::vector<float> input(floats);
+    bytes.assign(Count * 3 + 1, 0xAB);
+    nuiAudioConvert_FloatTo24bitsLittleEndian(&input[0], &bytes[0], Count);
+    CHECK_SAMPLES(bytes[i * 3] == (uint8)FloatToInt24(floats[i]) && bytes[i * 3 + 1] == (uint8)(FloatToInt24(floats[i]) >> 8) && bytes[i * 3 + 2] == (uint8)(FloatToInt24(floats[i]) >> 16), "float to 24 bits little endian");
+    TEST_CHECK(bytes[Count * 3] == 0xAB);
+    nuiAudioConvert_FloatTo24bitsBigEndian(&input[0], &bytes[0], Count);
+    CHECK_SAMPLES(bytes[i * 3 + 2] == (uint8)FloatToInt24(floats[i]) && bytes[i * 3 + 1] == (uint8)(FloatToInt24(floats[i]) >> 8) && bytes[i * 3] == (uint8)(FloatToInt24(floats[i]) >> 16), "float to 24 bits big endian");
+    TEST_CHECK(bytes[Count * 3] == 0xAB);
+  }
+
+  // 32 bits:
+  {
+    std::vector<int32> int32s(size);
+    for (uint32 i = 0; i < Count; i++)
+      int32s[i] = (int32)((Random(65536) << 16) | Random(65536));
+    std::vector<float> output(size);
+    nuiAudioConvert_32bitsToFloat(&int32s[0], &output[0], Count);
+    CHECK_SAMPLES(output[i] == Int32ToFloat(int32s[i]), "32 bits to float");
+
+    std::vector<float> input(floats);
+    nuiAudioConvert_FloatTo32bits(&input[0], &int32s[0], Count);
+    CHECK_SAMPLES(int32s[i] == FloatToInt32(floats[i]), "float to 32 bits");
+  }
+
+  // Interleaving:
+  for (uint32 channels = 1; channels <= 3; channels++)
+  {
+    std::vector<float> interleaved(size * channels);
+    for (size_t i = 0; i < interleaved.size(); i++)
+      interleaved[i] = (float)i;
+    std::vector<std::vector<float> > planes(channels, std::vector<float>(size));
+    std::vector<float*> outputs(channels);
+    for (uint32 c = 0; c < channels; c++)
+      outputs[c] = &planes[c][0];
+
+    nuiAudioConvert_INfloatToDEfloat(&interleaved[0], &outputs[0], channels, Count);
+    for (uint32 c = 0; c < channels; c++)
+      CHECK_SAMPLES(planes[c][i] == interleaved[i * channels + c], "float deinterleaving");
+
+    std::vector<float> back(size * channels);
+    nuiAudioConvert_DEfloatToINfloat(&outputs[0], &back[0], channels, Count);
+    CHECK_SAMPLES(back[i] == interleaved[i], "float interleaving");
+
+    std::vector<int16> interleaved16(size * channels);
+    for (size_t i = 0; i < interleaved16.size(); i++)
+      interleaved16[i] = (int16)((int32)Random(65536) - 32768);
+    for (uint32 c = 0; c < channels; c++)
+    {
+      std::vector<float> plane(size);
+      nuiAudioConvert_INint16ToDEfloat(&interleaved16[0], &plane[0], c, channels, Count);
+      CHECK_SAMPLES(plane[i] == Int16ToFloat(interleaved16[i * channels + c]), "interleaved int16 to float");
+
+      std::vector<int16> back16(size * channels, 0);
+      nuiAudioConvert_DEfloatToINint16(&plane[0], &back16[0], c, channels, Count);
+      CHECK_SAMPLES(back16[i * channels + c] == FloatToInt16(plane[i]), "float to interleaved int16");
+    }
+  }
+}
+
+/// Resample a sine wave in random blocks and return the signal to noise ratio of the result, in dB
+static double MeasureSNR(double InputRate, double OutputRate, double Frequency, nuiAudioSincResampler::Quality quality)
+{
+  nuiAudioSincResampler resampler(InputRate, OutputRate, quality);
+  const uint32 frames = (uint32)InputRate * 2;
+  std::vector<float> input(frames);
+  for (uint32 i = 0; i < frames; i++)
+    input[i] = (float)(0.9 * sin(2 * M_PI * Frequency * i / InputRate));
+
+  std::vector<float> output(resampler.GetMaxOutputFrames(frames) + resampler.GetMaxOutputFrames(resampler.GetLatency()));
+  uint32 done = 0;
+  uint32 position = 0;
+  while (position < frames)
+  {
+    uint32 block = 1 + Random(1000);
+    block = MIN(block, frames - position);
+    uint32 written = resampler.Process(&input[position], block, &output[done]);
+    TEST_CHECK(written <= resampler.GetMaxOutputFrames(block));
+    done += written;
+    position += block;
+  }
+  done += resampler.Flush(&output[done]);
+  TEST_CHECK(done == (uint32)ceil(frames * OutputRate / InputRate));
+
+  // Compare the middle of the output with the ideal sine, away from the edges of the stream:
+  double signal = 0;
+  double noise = 0;
+  for (uint32 i = done / 10; i < done * 9 / 10; i++)
+  {
+    double expected = 0.9 * sin(2 * M_PI * Frequency * i / OutputRate);
+    signal += expected * expected;
+    noise += (output[i] - expected) * (output[i] - expected);
+  }
+  return 10 * log10(signal / noise);
+}
+
+/// Resample a tone above the output Nyquist frequency and return its level after the conversion, in dB
+static double MeasureAlias(double InputRate, double OutputRate, double Frequency, nuiAudioSincResampler::Quality quality)
+{
+  nuiAudioSincResampler resampler(InputRate, OutputRate, quality);
+  const uint32 frames = (uint32)InputRate * 2;
+  std::vector<float> input(frames);
+  for (uint32 i = 0; i < frames; i++)
+    input[i] = (float)sin(2 * M_PI * Frequency * i / InputRate);
+
+  std::vector<float> output(resampler.GetMaxOutputFrames(frames));
+  uint32 done = resampler.Process(&input[0], frames, &output[0]);
+  double power = 0;
+  for (uint32 i = done / 4; i < done; i++)
+    power += output[i] * output[i];
+  power /= done - done / 4;
+  return 10 * log10(power / 0.5);
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  printf("SSE2 %d, SSSE3 %d, AVX2 %d\n", nglCPUInfo::HasSSE2(), nglCPUInfo::HasSSSE3(), nglCPUInfo::HasAVX2());
+
+  // Every length from 0 to 64 covers the ends of the vector loops, then random lengths:
+  for (uint32 i = 0; i <= 64; i++)
+    CheckConverters(i);
+  for (uint32 i = 0; i < 100; i++)
+    CheckConverters(i * 7 + Random(50));
+
+  const char* pQualities[] = { "fast", "medium", "best" };
+
+  // Minimum signal to noise ratios of a sine wave for each quality: the values measured when the resampler was written,
+  // less 1 dB.
+  struct SNRCase
+  {
+    double mInputRate;
+    double mOutputRate;
+    double mFrequency;
+    double mMinimum[3];
+  };
+  const SNRCase snr[] =
+  {
+    { 44100, 48000, 1000, { 84, 114, 130 } },
+    { 96000, 44100, 12000, { 79, 121, 134 } }
+  };
+  for (uint32 c = 0; c < sizeof(snr) / sizeof(snr[0]); c++)
+  {
+    for (uint32 q = 0; q < 3; q++)
+    {
+      double value = MeasureSNR(snr[c].mInputRate, snr[c].mOutputRate, snr[c].mFrequency, (nuiAudioSincResampler::Quality)q);
+      printf("%s %.0f -> %.0f Hz, %.0f Hz sine: SNR %.1f dB\n", pQualities[q], snr[c].mInputRate, snr[c].mOutputRate, snr[c].mFrequency, value);
+      if (!(value >= snr[c].mMinimum[q]))
+        TestFail("%s %.0f -> %.0f Hz: SNR %.1f dB, expected at least %.0f dB", pQualities[q], snr[c].mInputRate, snr[c].mOutputRate, value, snr[c].mMinimum[q]);
+    }
+  }
+
+  // A 23.5 kHz tone must disappear when going from 48 kHz to 44.1 kHz:
+  const double minimumRejection[] = { 94, 102, 124 };
+  for (uint32 q = 0; q < 3; q++)
+  {
+    double value = MeasureAlias(48000, 44100, 23500, (nuiAudioSincResampler::Quality)q);
+    printf("%s 48000 -> 44100 Hz, 23500 Hz sine: %.1f dB\n", pQualities[q], value);
+    if (!(-value >= minimumRejection[q]))
+      TestFail("%s: the alias is attenuated by %.1f dB, expected at least %.0f dB", pQualities[q], -value, minimumRejection[q]);
+  }
+
+  nuiUninit();
+  return TestResult();
+}
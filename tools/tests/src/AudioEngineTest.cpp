@@ -0,0 +1,263 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Renders nuiAudioEngine offline with nuiAudioDevice_Null and fails if its audio callback allocates memory or takes a
+// lock. The allocator and the pthread locks of the C library are interposed (Linux, glibc): the hooks only count the
+// calls made while the engine's process function runs.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiAudioEngine.h"
+#include "nuiAudioDevice_Null.h"
+#include "nuiSynthSound.h"
+#include "Test.h"
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+static __thread bool gInCallback = false;
+static uint32 gAllocations = 0;
+static uint32 gLocks = 0;
+
+extern "C"
+{
+  void* __libc_malloc(size_t Size);
+  void* __libc_calloc(size_t Count, size_t Size);
+  void* __libc_realloc(void* pPointer, size_t Size);
+  void* __libc_memalign(size_t Alignment, size_t Size);
+  void __libc_free(void* pPointer);
+
+  void* malloc(size_t Size)
+  {
+    if (gInCallback)
+      gAllocations++;
+    return __libc_malloc(Size);
+  }
+
+  void* calloc(size_t Count, size_t Size)
+  {
+    if (gInCallback)
+      gAllocations++;
+    return __libc_calloc(Count, Size);
+  }
+
+  void* realloc(void* pPointer, size_t Size)
+  {
+    if (gInCallback)
+      gAllocations++;
+    return __libc_realloc(pPointer, Size);
+  }
+
+  void* memalign(size_t Alignment, size_t Size)
+  {
+    if (gInCallback)
+      gAllocations++;
+    return __libc_memalign(Alignment, Size);
+  }
+
+  int posix_memalign(void** ppPointer, size_t Alignment, size_t Size)
+  {
+    if (gInCallback)
+      gAllocations++;
+    *ppPointer = __libc_memalign(Alignment, Size);
+    return *ppPointer ? 0 : ENOMEM;
+  }
+
+  void free(void* pPointer)
+  {
+    if (gInCallback && pPointer)
+      gAllocations++;
+    __libc_free(pPointer);
+  }
+}
+
+// The real lock functions are looked up on first use: the C library doesn't call them through the interposed symbols.
+typedef int (*MutexFunction)(pthread_mutex_t*);
+typedef int (*RWLockFunction)(pthread_rwlock_t*);
+typedef int (*SemaphoreFunction)(sem_t*);
+static MutexFunction gpMutexLock = NULL;
+static MutexFunction gpMutexTryLock = NULL;
+static RWLockFunction gpReadLock = NULL;
+static RWLockFunction gpWriteLock = NULL;
+static SemaphoreFunction gpSemWait = NULL;
+
+#define TEST_REAL_FUNCTION(POINTER, TYPE, NAME) \
+  if (!POINTER) \
+    POINTER = (TYPE)dlsym(RTLD_NEXT, NAME);
+
+extern "C"
+{
+  int pthread_mutex_lock(pthread_mutex_t* pMutex)
+  {
+    if (gInCallback)
+      gLocks++;
+    TEST_REAL_FUNCTION(gpMutexLock, MutexFunction, "pthread_mutex_lock");
+    return gpMutexLock(pMutex);
+  }
+
+  int pthread_mutex_trylock(pthread_mutex_t* pMutex)
+  {
+    if (gInCallback)
+      gLocks++;
+    TEST_REAL_FUNCTION(gpMutexTryLock, MutexFunction, "pthread_mutex_trylock");
+    return gpMutexTryLock(pMutex);
+  }
+
+  int pthread_rwlock_rdlock(pthread_rwlock_t* pLock)
+  {
+    if (gInCallback)
+      gLocks++;
+    TEST_REAL_FUNCTION(gpReadLock, RWLockFunction, "pthread_rwlock_rdlock");
+    return gpReadLock(pLock);
+  }
+
+  int pthread_rwlock_wrlock(pthread_rwlock_t* pLock)
+  {
+    if (gInCallback)
+      gLocks++;
+    TEST_REAL_FUNCTION(gpWriteLock, RWLockFunction, "pthread_rwlock_wrlock");
+    return gpWriteLock(pLock);
+  }
+
+  int sem_wait(sem_t* pSemaphore)
+  {
+    if (gInCallback)
+      gLocks++;
+    TEST_REAL_FUNCTION(gpSemWait, SemaphoreFunction, "sem_wait");
+    return gpSemWait(pSemaphore);
+  }
+}
+
+/// Null device that flags the calls to its client's process function
+class CheckedDevice : public nuiAudioDevice_Null
+{
+public:
+  CheckedDevice()
+  : nuiAudioDevice_Null(eOffline), mCallbacks(0)
+  {
+  }
+
+  virtual bool Open(std::vector<uint32>& rInputChannels, std::vector<uint32>& rOutputChannels, double SampleRate, uint32 BufferSize, nuiAudioProcessFn pProcessFunction)
+  {
+    mClientFunction = pProcessFunction;
+    return nuiAudioDevice_Null::Open(rInputChannels, rOutputChannels, SampleRate, BufferSize, nuiMakeDelegate(this, &CheckedDevice::Process));
+  }
+
+  uint32 GetCallbacks() const
+  {
+    return mCallbacks;
+  }
+
+private:
+  void Process(const std::vector<const float*>& rInput, const std::vector<float*>& rOutput, uint32 SampleFrames)
+  {
+    mCallbacks++;
+    gInCallback = true;
+    mClientFunction(rInput, rOutput, SampleFrames);
+    gInCallback = false;
+  }
+
+  nuiAudioProcessFn mClientFunction;
+  uint32 mCallbacks;
+};
+
+class TestSynthSound : public nuiSynthSound
+{
+public:
+  TestSynthSound()
+  : nuiSynthSound(44100, 0.05)
+  {
+    SetFreq(440);
+  }
+};
+
+#define TEST_SAMPLE_RATE 44100
+#define TEST_BUFFER_SIZE 512
+
+static bool CheckCallbacks(const char* pStep)
+{
+  bool ok = true;
+  if (gAllocations)
+  {
+    TestFail("%s: %u allocations in the audio callback", pStep, gAllocations);
+    ok = false;
+  }
+  if (gLocks)
+  {
+    TestFail("%s: %u locks taken in the audio callback", pStep, gLocks);
+    ok = false;
+  }
+  gAllocations = 0;
+  gLocks = 0;
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  CheckedDevice* pDevice = new CheckedDevice();
+  nuiAudioEngine* pEngine = new nuiAudioEngine(pDevice, TEST_SAMPLE_RATE, TEST_BUFFER_SIZE);
+  nuiSynthSound* pSound = new TestSynthSound();
+  pSound->Acquire();
+
+  // A few voices:
+  std::vector<nuiVoice*> voices;
+  for (uint32 i = 0; i < 16; i++)
+  {
+    nuiVoice* pVoice = pEngine->PlaySound(pSound);
+    pVoice->Acquire(); // Keep the stopped voices alive until the end
+    voices.push_back(pVoice);
+  }
+  pDevice->Render(TEST_SAMPLE_RATE);
+  TEST_CHECK(pDevice->GetCallbacks() > 0);
+  CheckCallbacks("16 voices");
+
+  // More voices than the engine can play: the extra ones are dropped by the audio thread.
+  const uint32 count = 1200;
+  for (uint32 i = 0; i < count; i++)
+  {
+    nuiVoice* pVoice = pEngine->PlaySound(pSound);
+    if (pVoice)
+    {
+      pVoice->Acquire();
+      voices.push_back(pVoice);
+    }
+    if (!(i % 256))
+      pDevice->Render(TEST_BUFFER_SIZE);
+  }
+  pDevice->Render(TEST_BUFFER_SIZE * 4);
+  CheckCallbacks("full engine");
+
+  // Stopping them must drain the queue even though the engine was full:
+  for (size_t i = 0; i < voices.size(); i++)
+  {
+    pEngine->StopSound(voices[i]);
+    if (!(i % 256))
+      pDevice->Render(TEST_BUFFER_SIZE);
+  }
+  pDevice->Render(TEST_BUFFER_SIZE * 4);
+  CheckCallbacks("stopped voices");
+
+  uint32 started = 0;
+  for (uint32 i = 0; i < 64; i++)
+  {
+    if (pEngine->PlaySound(pSound))
+      started++;
+  }
+  TEST_CHECK(started == 64);
+  pDevice->Render(TEST_SAMPLE_RATE);
+  CheckCallbacks("restarted voices");
+
+  delete pEngine;
+  for (size_t i = 0; i < voices.size(); i++)
+    voices[i]->Release();
+  pSound->Release();
+
+  nuiUninit();
+  return TestResult();
+}
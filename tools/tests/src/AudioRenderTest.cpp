@@ -0,0 +1,121 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Renders a mix offline with nuiAudioDevice_Null to a WAV file, then reads the file back and checks its format and
+// length.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiAudioEngine.h"
+#include "nuiAudioDevice_Null.h"
+#include "nuiSynthSound.h"
+#include "nuiWaveWriter.h"
+#include "nuiWaveReader.h"
+#include "Test.h"
+
+class TestSynthSound : public nuiSynthSound
+{
+public:
+  TestSynthSound(float Frequency)
+  : nuiSynthSound(44100, 1)
+  {
+    SetFreq(Frequency);
+  }
+};
+
+static bool Render(const nglPath& rPath, double SampleRate, uint32 BufferSize, uint32 BitsPerSample, uint64 SampleFrames, uint64& rRendered)
+{
+  nglOFile file(rPath, eOFileCreate);
+  if (!TEST_CHECK(file.IsOpen()))
+    return false;
+
+  nuiWaveWriter writer(file);
+  nuiAudioDevice_Null* pDevice = new nuiAudioDevice_Null(nuiAudioDevice_Null::eOffline);
+  pDevice->SetWriter(&writer, BitsPerSample);
+  nuiAudioEngine* pEngine = new nuiAudioEngine(pDevice, SampleRate, BufferSize);
+  if (!TEST_CHECK(pDevice->IsOpen()))
+  {
+    delete pEngine;
+    return false;
+  }
+
+  const float frequencies[] = { 220, 330, 440, 550 };
+  std::vector<nuiSynthSound*> sounds;
+  for (uint32 i = 0; i < 4; i++)
+  {
+    nuiSynthSound* pSound = new TestSynthSound(frequencies[i]);
+    pSound->Acquire();
+    pSound->SetGain(0.2f);
+    pEngine->PlaySound(pSound);
+    sounds.push_back(pSound);
+  }
+
+  rRendered = pDevice->Render(SampleFrames);
+  TEST_CHECK(rRendered == pDevice->GetRenderedFrames());
+  TEST_CHECK(pDevice->GetTimings().mCallbacks == rRendered / BufferSize);
+
+  delete pEngine; // Closes the device, which finalizes the file
+  for (size_t i = 0; i < sounds.size(); i++)
+    sounds[i]->Release();
+  return true;
+}
+
+static void Check(double SampleRate, uint32 BufferSize, uint32 BitsPerSample, uint64 SampleFrames)
+{
+  nglPath path(ePathTemp);
+  path += nglPath(_T("nuitest_audio_render.wav"));
+
+  uint64 rendered = 0;
+  if (!Render(path, SampleRate, BufferSize, BitsPerSample, SampleFrames, rendered))
+    return;
+
+  // Whole buffers are rendered:
+  const uint64 expected = ((SampleFrames + BufferSize - 1) / BufferSize) * BufferSize;
+  if (rendered != expected)
+    TestFail("%.0f Hz, %u frame buffers: rendered %llu sample frames, expected %llu", SampleRate, BufferSize, (unsigned long long)rendered, (unsigned long long)expected);
+
+  {
+    nglIFile file(path);
+    if (TEST_CHECK(file.GetState() == eStreamReady))
+    {
+      nuiWaveReader reader(file);
+      nuiSampleInfo info;
+      if (TEST_CHECK(reader.GetInfo(info)))
+      {
+        TEST_CHECK(info.GetChannels() == 2);
+        TEST_CHECK(info.GetSampleRate() == SampleRate);
+        TEST_CHECK(info.GetBitsPerSample() == BitsPerSample);
+        if (info.GetSampleFrames() != rendered)
+          TestFail("%.0f Hz: the file has %llu sample frames, %llu were rendered", SampleRate, (unsigned long long)info.GetSampleFrames(), (unsigned long long)rendered);
+
+        // The voices must be audible and the mix must not clip:
+        std::vector<float> samples((size_t)info.GetSampleFrames() * info.GetChannels());
+        uint32 read = samples.empty() ? 0 : reader.ReadIN(&samples[0], (uint32)info.GetSampleFrames(), eSampleFloat32);
+        TEST_CHECK(read == info.GetSampleFrames());
+        float peak = 0;
+        for (size_t i = 0; i < samples.size(); i++)
+          peak = MAX(peak, fabsf(samples[i]));
+        if (peak < 0.05f || peak > 1.0f)
+          TestFail("%.0f Hz: peak %f out of range", SampleRate, peak);
+      }
+    }
+  }
+
+  path.Delete();
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  Check(44100, 512, 16, 44100 * 2);
+  Check(48000, 256, 16, 48000);
+  Check(22050, 1000, 16, 12345);
+
+  nuiUninit();
+  return TestResult();
+}
@@ -0,0 +1,199 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Plays looping nuiAudioStreams from the callback of a real time nuiAudioDevice_Null and checks that every sample they
+// return is the sample of the file at the position that was asked for, and that they don't underrun unless they seek.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiAudioStreamer.h"
+#include "nuiAudioDevice_Null.h"
+#include "nuiWaveWriter.h"
+#include "nuiWaveReader.h"
+#include "Test.h"
+
+#define TEST_SAMPLE_RATE 44100
+#define TEST_BUFFER_SIZE 256
+#define TEST_FILE_FRAMES 100000
+
+/// Write a stereo file in which each sample frame is different from the ones around it.
+static bool WriteTestFile(const nglPath& rPath)
+{
+  nglOFile file(rPath, eOFileCreate);
+  if (!file.IsOpen())
+    return false;
+
+  nuiWaveWriter writer(file);
+  nuiSampleInfo info;
+  info.SetSampleRate(TEST_SAMPLE_RATE);
+  info.SetChannels(2);
+  info.SetBitsPerSample(16);
+  if (!writer.WriteInfo(info))
+    return false;
+
+  std::vector<int16> samples(TEST_FILE_FRAMES * 2);
+  for (uint32 i = 0; i < TEST_FILE_FRAMES; i++)
+  {
+    samples[i * 2 + 0] = (int16)((i % 32767) + 1);
+    samples[i * 2 + 1] = (int16)-(int16)(((i * 7) % 32767) + 1);
+  }
+  if (writer.Write(&samples[0], TEST_FILE_FRAMES, eSampleInt16) != TEST_FILE_FRAMES)
+    return false;
+  return writer.Finalize();
+}
+
+/// Reads the streams in the audio callback of the device
+class StreamPlayer
+{
+public:
+  StreamPlayer(const std::vector<nuiAudioStream*>& rStreams, const std::vector<float>& rReference, bool Seek)
+  : mStreams(rStreams),
+    mPositions(rStreams.size(), 0),
+    mBuffers(2),
+    mrReference(rReference),
+    mSeek(Seek),
+    mCallbacks(0),
+    mMismatches(0),
+    mSilentFrames(0),
+    mSeeks(0)
+  {
+  }
+
+  void Process(const std::vector<const float*>& rInput, const std::vector<float*>& rOutput, uint32 SampleFrames)
+  {
+    const int64 length = (int64)mrReference.size() / 2;
+    for (size_t s = 0; s < mStreams.size(); s++)
+    {
+      // Jump somewhere else from time to time:
+      if (mSeek && !((mCallbacks + s) % 97))
+      {
+        mPositions[s] = (mPositions[s] * 7 + 12345 * (s + 1)) % length;
+        mSeeks++;
+      }
+
+      uint32 done = 0;
+      while (done < SampleFrames)
+      {
+        std::vector<float*>& rBuffers(mBuffers);
+        rBuffers[0] = rOutput[0] + done;
+        rBuffers[1] = rOutput[1] + done;
+        uint32 read = mStreams[s]->Read(rBuffers, mPositions[s], SampleFrames - done);
+        if (!read)
+        {
+          mPositions[s] = 0; // Loop
+          continue;
+        }
+
+        for (uint32 i = 0; i < read; i++)
+        {
+          const float left = rBuffers[0][i];
+          const float right = rBuffers[1][i];
+          if (left == 0 && right == 0)
+          {
+            mSilentFrames++; // Seeking or underrun, counted by the stream
+            continue;
+          }
+          const int64 position = mPositions[s] + i;
+          if (left != mrReference[position * 2] || right != mrReference[position * 2 + 1])
+            mMismatches++;
+        }
+        mPositions[s] += read;
+        done += read;
+      }
+    }
+    mCallbacks++;
+  }
+
+  std::vector<nuiAudioStream*> mStreams;
+  std::vector<int64> mPositions;
+  std::vector<float*> mBuffers;
+  const std::vector<float>& mrReference;
+  bool mSeek;
+  uint32 mCallbacks;
+  uint32 mMismatches;
+  uint32 mSilentFrames;
+  uint32 mSeeks;
+};
+
+static void Play(const nglPath& rPath, const std::vector<float>& rReference, uint32 StreamCount, bool Seek)
+{
+  std::vector<nuiAudioStream*> streams;
+  for (uint32 i = 0; i < StreamCount; i++)
+  {
+    nglIStream* pStream = new nglIFile(rPath);
+    nuiWaveReader* pReader = new nuiWaveReader(*pStream);
+    nuiSampleInfo info;
+    if (!TEST_CHECK(pReader->GetInfo(info)))
+    {
+      delete pReader;
+      delete pStream;
+      break;
+    }
+    nuiAudioStream* pAudioStream = new nuiAudioStream(pStream, pReader, info, nuiAudioStreamer::Instance.GetPrefetchFrames());
+    pAudioStream->Preroll(nuiAudioStreamer::Instance.GetChunkFrames());
+    pAudioStream->SetLoop(true);
+    nuiAudioStreamer::Instance.Add(pAudioStream);
+    streams.push_back(pAudioStream);
+  }
+
+  uint32 underruns = nuiAudioStreamer::Instance.GetUnderruns();
+  StreamPlayer player(streams, rReference, Seek);
+  {
+    nuiAudioDevice_Null device(nuiAudioDevice_Null::eRealTime, 0, 2);
+    std::vector<uint32> inputs;
+    std::vector<uint32> outputs;
+    outputs.push_back(0);
+    outputs.push_back(1);
+    if (TEST_CHECK(device.Open(inputs, outputs, TEST_SAMPLE_RATE, TEST_BUFFER_SIZE, nuiMakeDelegate(&player, &StreamPlayer::Process))))
+    {
+      nglThread::MsSleep(3000);
+      device.Close();
+    }
+  }
+  underruns = nuiAudioStreamer::Instance.GetUnderruns() - underruns;
+
+  printf("%u streams%s: %u callbacks, %u seeks, %u silent frames, %u underruns\n", StreamCount, Seek ? " with seeks" : "", player.mCallbacks, player.mSeeks, player.mSilentFrames, underruns);
+  TEST_CHECK(player.mCallbacks > 0);
+  if (player.mMismatches)
+    TestFail("%u streams%s: %u sample frames don't match the file", StreamCount, Seek ? " with seeks" : "", player.mMismatches);
+  // Without seeks the prefetching must keep up, and only an underrun can produce silence:
+  if (!Seek && (underruns || player.mSilentFrames))
+    TestFail("%u streams: %u underruns, %u silent frames", StreamCount, underruns, player.mSilentFrames);
+
+  for (size_t i = 0; i < streams.size(); i++)
+  {
+    nuiAudioStreamer::Instance.Remove(streams[i]);
+    delete streams[i];
+  }
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  nglPath path(ePathTemp);
+  path += nglPath(_T("nuitest_audio_streamer.wav"));
+  if (TEST_CHECK(WriteTestFile(path)))
+  {
+    // Decode the whole file once to know what the streams must return:
+    std::vector<float> reference(TEST_FILE_FRAMES * 2);
+    {
+      nglIFile file(path);
+      nuiWaveReader reader(file);
+      nuiSampleInfo info;
+      TEST_CHECK(reader.GetInfo(info) && info.GetSampleFrames() == TEST_FILE_FRAMES);
+      TEST_CHECK(reader.ReadIN(&reference[0], TEST_FILE_FRAMES, eSampleFloat32) == TEST_FILE_FRAMES);
+    }
+
+    Play(path, reference, 64, false);
+    Play(path, reference, 64, true);
+  }
+  path.Delete();
+
+  nuiUninit();
+  return TestResult();
+}
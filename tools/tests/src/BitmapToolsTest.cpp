@@ -0,0 +1,177 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Runs the line copies, the premultiplication and nglScaleImage of nglBitmapTools with and without their SIMD code
+// paths on random pixels and fails if the results differ by a single byte. Palette images must not be filtered.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nglBitmapTools.h"
+#include "Test.h"
+
+static uint32 gSeed = 1;
+
+static uint32 Random(uint32 Max)
+{
+  gSeed = gSeed * 1103515245 + 12345;
+  return (gSeed >> 8) % Max;
+}
+
+static void Fill(std::vector<uint8>& rBuffer)
+{
+  for (size_t i = 0; i < rBuffer.size(); i++)
+    rBuffer[i] = (uint8)Random(256);
+}
+
+/// Compare the outputs of the SIMD and scalar paths. The destinations start with the same random bytes, so the bytes that
+/// a function must leave alone are checked too.
+static void Same(const std::vector<uint8>& rSIMD, const std::vector<uint8>& rScalar, const char* pName, int32 Count)
+{
+  size_t i = 0;
+  while (i < rSIMD.size() && rSIMD[i] == rScalar[i])
+    i++;
+  if (!TEST_CHECK(i == rSIMD.size()))
+    fprintf(stderr, "%s, %d pixels: byte %u differs from the scalar code (%u instead of %u)\n", pName, Count, (uint32)i, rSIMD[i], rScalar[i]);
+}
+
+typedef void (*LineFn)(void* pDst, void* pSrc, int32 PixelCount);
+
+class LineFunction
+{
+public:
+  const char* mpName;
+  nglCopyLineFn mpCopy;
+  LineFn mpLine;
+  int32 mDstBytes;
+  int32 mSrcBytes;
+};
+
+#define COPY_LINE(NAME, DST, SRC) { #NAME, &NAME, NULL, DST, SRC }
+#define LINE(NAME, DST, SRC) { #NAME, NULL, &NAME, DST, SRC }
+#define GENERIC_COPY_LINE(NAME, DST, SRC) { #NAME, NULL, NULL, DST, SRC } ///< Not exported, given by nglGetCopyLineFn
+
+// The functions that have SIMD paths. Only the copies that are not mirrored have one.
+static const LineFunction gLineFunctions[] =
+{
+  GENERIC_COPY_LINE(nglCopyLine24To32, 4, 3),
+  GENERIC_COPY_LINE(nglCopyLine32To24, 3, 4),
+  COPY_LINE(nglCopyLine24To32ARGB, 4, 3),
+  COPY_LINE(nglCopyLine32To32ARGB, 4, 4),
+  LINE(nglPreMultLine32RGBA, 4, 4),
+  LINE(nglPreMultLine32ARGB, 4, 4),
+  LINE(nglUnPreMultLine32RGBA, 4, 4),
+  LINE(nglUnPreMultLine32ARGB, 4, 4)
+};
+
+static void CheckLine(const LineFunction& rFunction, int32 Count)
+{
+  nglCopyLineFn pCopy = rFunction.mpCopy;
+  if (!pCopy && !rFunction.mpLine)
+    pCopy = nglGetCopyLineFn(rFunction.mDstBytes * 8, rFunction.mSrcBytes * 8);
+
+  std::vector<uint8> src(Count * rFunction.mSrcBytes + 1);
+  Fill(src);
+  std::vector<uint8> simd(Count * rFunction.mDstBytes + 16);
+  Fill(simd);
+  std::vector<uint8> scalar(simd);
+
+  nglEnableBitmapSIMD(true);
+  if (pCopy)
+    pCopy(&simd[0], &src[0], Count, false);
+  else
+    rFunction.mpLine(&simd[0], &src[0], Count);
+
+  nglEnableBitmapSIMD(false);
+  if (pCopy)
+    pCopy(&scalar[0], &src[0], Count, false);
+  else
+    rFunction.mpLine(&scalar[0], &src[0], Count);
+
+  Same(simd, scalar, rFunction.mpName, Count);
+  nglEnableBitmapSIMD(true);
+}
+
+static void CheckScale(int32 SrcWidth, int32 SrcHeight, int32 DstWidth, int32 DstHeight)
+{
+  const char* pFilters[] = { "box", "bilinear", "Lanczos" };
+  const nglImageFilter filters[] = { eImageFilterBox, eImageFilterBilinear, eImageFilterLanczos };
+  for (int32 bpp = 1; bpp <= 4; bpp++)
+  {
+    std::vector<uint8> src(SrcWidth * SrcHeight * bpp);
+    Fill(src);
+    for (uint32 f = 0; f < 3; f++)
+    {
+      std::vector<uint8> simd(DstWidth * DstHeight * bpp, 0);
+      std::vector<uint8> scalar(simd);
+
+      nglEnableBitmapSIMD(true);
+      bool ok = nglScaleImage(&simd[0], DstWidth, DstHeight, &src[0], SrcWidth, SrcHeight, bpp, filters[f]);
+      nglEnableBitmapSIMD(false);
+      ok = nglScaleImage(&scalar[0], DstWidth, DstHeight, &src[0], SrcWidth, SrcHeight, bpp, filters[f]) && ok;
+      nglEnableBitmapSIMD(true);
+
+      if (!TEST_CHECK(ok))
+        continue;
+      char name[128];
+      sprintf(name, "nglScaleImage %s %dx%d -> %dx%d, %d bytes per pixel", pFilters[f], SrcWidth, SrcHeight, DstWidth, DstHeight, bpp);
+      Same(simd, scalar, name, DstWidth * DstHeight);
+    }
+  }
+}
+
+// Palette indices can't be interpolated: a palette image must be resized the same way with every filter.
+static void CheckPalette(int32 SrcWidth, int32 SrcHeight, int32 DstWidth, int32 DstHeight)
+{
+  nglImageInfo info(SrcWidth, SrcHeight, 8);
+  info.mPixelFormat = eImagePixelIndex;
+  for (int32 i = 0; i < SrcWidth * SrcHeight; i++)
+    info.mpBuffer[i] = (char)Random(256);
+  nglImage image(info);
+
+  const nglImageFilter filters[] = { eImageFilterBox, eImageFilterBilinear, eImageFilterLanczos };
+  nglImage reference(image, DstWidth, DstHeight, eImageFilterDefault);
+  for (uint32 f = 0; f < 3; f++)
+  {
+    nglImage scaled(image, DstWidth, DstHeight, filters[f]);
+    TEST_CHECK(!memcmp(scaled.GetBuffer(), reference.GetBuffer(), DstWidth * DstHeight));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  printf("SSE2 %d, SSSE3 %d, AVX2 %d\n", nglCPUInfo::HasSSE2(), nglCPUInfo::HasSSSE3(), nglCPUInfo::HasAVX2());
+
+  // Every length up to 70 pixels covers the ends of the vector loops, then a few longer lines:
+  for (int32 count = 1; count <= 70; count++)
+  {
+    for (uint32 i = 0; i < sizeof(gLineFunctions) / sizeof(gLineFunctions[0]); i++)
+      CheckLine(gLineFunctions[i], count);
+  }
+  for (uint32 i = 0; i < 20; i++)
+  {
+    int32 count = 71 + Random(2000);
+    for (uint32 f = 0; f < sizeof(gLineFunctions) / sizeof(gLineFunctions[0]); f++)
+      CheckLine(gLineFunctions[f], count);
+  }
+
+  // Down and up scaling, with odd sizes:
+  CheckScale(640, 480, 128, 96);
+  CheckScale(333, 211, 97, 53);
+  CheckScale(17, 9, 64, 37);
+  CheckScale(100, 100, 100, 100);
+  CheckScale(1, 1, 5, 3);
+  for (uint32 i = 0; i < 10; i++)
+    CheckScale(1 + Random(300), 1 + Random(300), 1 + Random(300), 1 + Random(300));
+
+  CheckPalette(640, 480, 128, 96);
+  CheckPalette(17, 9, 64, 37);
+
+  nuiUninit();
+  return TestResult();
+}
@@ -0,0 +1,277 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Sends nuiHTTPRequests to a minimal keep-alive HTTP server running in the thread of a nuiSocketPool and fails if a
+// response has the wrong status or body, if the connections are not reused, or if the cache doesn't revalidate.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiHTTP.h"
+#include "nuiTCPClient.h"
+#include "nuiTCPServer.h"
+#include "nuiSocketPool.h"
+#include "Test.h"
+
+#include <sys/socket.h>
+
+#define TEST_PORT 31339
+#define TEST_THREADS 16
+
+class HTTPServer
+{
+public:
+  HTTPServer(nuiSocketPool& rPool)
+  : mrPool(rPool), mConnections(0), mRequests(0), mNotModified(0)
+  {
+    mBinary.resize(256 * 1024);
+    for (uint32 i = 0; i < mBinary.size(); i++)
+      mBinary[i] = (uint8)(i * 7 + (i >> 8));
+  }
+
+  void OnConnection(nuiSocket& rSocket)
+  {
+    nuiTCPServer& rServer((nuiTCPServer&)rSocket);
+    nuiTCPClient* pClient;
+    while ((pClient = rServer.Accept()))
+    {
+      ngl_atomic_inc(mConnections);
+      pClient->SetCanReadDelegate(nuiMakeDelegate(this, &HTTPServer::OnRead));
+      pClient->SetReadClosedDelegate(nuiMakeDelegate(this, &HTTPServer::OnClosed));
+      mrPool.Add(pClient);
+    }
+  }
+
+  void OnRead(nuiSocket& rSocket)
+  {
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    for (;;)
+    {
+      // Wait for a complete request
+      std::string request((const char*)rClient.GetReceived(), rClient.GetReceivedSize());
+      size_t end = request.find("\r\n\r\n");
+      if (end == std::string::npos)
+        return;
+      std::string headers(request.substr(0, end + 2));
+      size_t length = 0;
+      size_t pos = headers.find("Content-Length: ");
+      if (pos != std::string::npos)
+        length = atoi(headers.c_str() + pos + 16);
+      if (request.size() < end + 4 + length)
+        return;
+      std::string body(request.substr(end + 4, length));
+      rClient.DiscardReceived(end + 4 + length);
+      ngl_atomic_inc(mRequests);
+
+      std::string path(headers.substr(headers.find(' ') + 1));
+      path = path.substr(0, path.find(' '));
+
+      if (path == "/binary")
+      {
+        Reply(rClient, "200 OK", "", (const char*)&mBinary[0], mBinary.size());
+      }
+      else if (path == "/echo")
+      {
+        Reply(rClient, "200 OK", "", body.c_str(), body.size());
+      }
+      else if (path == "/cached")
+      {
+        if (headers.find("If-None-Match: \"v1\"\r\n") != std::string::npos)
+        {
+          ngl_atomic_inc(mNotModified);
+          Reply(rClient, "304 Not Modified", "ETag: \"v1\"\r\n", "", 0);
+        }
+        else
+        {
+          const char* pBody = "cached contents";
+          Reply(rClient, "200 OK", "ETag: \"v1\"\r\n", pBody, strlen(pBody));
+        }
+      }
+      else
+      {
+        Reply(rClient, "404 Not Found", "", "", 0);
+      }
+    }
+  }
+
+  void Reply(nuiTCPClient& rClient, const char* pStatus, const char* pHeaders, const char* pBody, size_t Length)
+  {
+    nglString header;
+    header.CFormat("HTTP/1.1 %s\r\n%sContent-Length: %d\r\n\r\n", pStatus, pHeaders, (int)Length);
+    std::string str(header.GetStdString());
+    str.append(pBody, Length);
+    rClient.BufferedSend((const uint8*)str.c_str(), str.size());
+  }
+
+  void OnClosed(nuiSocket& rSocket)
+  {
+    delete &rSocket;
+  }
+
+  nuiSocketPool& mrPool;
+  std::vector<uint8> mBinary;
+  nglAtomic32 mConnections;
+  nglAtomic32 mRequests;
+  nglAtomic32 mNotModified;
+};
+
+/// Posts binary bodies from several threads at once
+class EchoWorkers
+{
+public:
+  EchoWorkers(const nglString& rRoot, uint32 RequestCount)
+  : mRoot(rRoot), mRequestCount(RequestCount), mErrors(0)
+  {
+  }
+
+  void Run()
+  {
+    const char body[] = "binary\0body\r\n\r\nwith a blank line";
+    for (uint32 i = 0; i < mRequestCount; i++)
+    {
+      nuiHTTPRequest request(mRoot + _T("/echo"), _T("POST"));
+      request.SetBody(body, sizeof(body));
+      nuiHTTPResponse* pResponse = request.SendRequest();
+      const std::vector<char>& rBody(pResponse->GetBody());
+      if (pResponse->GetStatusCode() != 200 || rBody.size() != sizeof(body) || memcmp(&rBody[0], body, sizeof(body)))
+        ngl_atomic_inc(mErrors);
+      delete pResponse;
+    }
+  }
+
+  nglString mRoot;
+  uint32 mRequestCount;
+  nglAtomic32 mErrors;
+};
+
+static void LoopbackTest(uint32 RequestCount, int16 Port)
+{
+  nuiSocketPool serverpool;
+  HTTPServer http(serverpool);
+  nuiTCPServer server;
+  server.SetNonBlocking(true);
+  if (!server.Bind(_T("127.0.0.1"), Port) || !server.Listen(SOMAXCONN))
+  {
+    TestFail("unable to open the server on port %d", Port);
+    return;
+  }
+  server.SetCanReadDelegate(nuiMakeDelegate(&http, &HTTPServer::OnConnection));
+  if (!serverpool.Add(&server))
+  {
+    TestFail("unable to add the server to the socket pool");
+    return;
+  }
+  serverpool.Start();
+
+  nglString root;
+  root.CFormat(_T("http://127.0.0.1:%d"), Port);
+
+  // Binary bodies over a single keep-alive connection
+  uint32 errors = 0;
+  double start = nglTime();
+  for (uint32 i = 0; i < RequestCount; i++)
+  {
+    nuiHTTPRequest request(root + _T("/binary"));
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    const std::vector<char>& rBody(pResponse->GetBody());
+    if (pResponse->GetStatusCode() != 200 || rBody.size() != http.mBinary.size() || memcmp(&rBody[0], &http.mBinary[0], rBody.size()))
+      errors++;
+    delete pResponse;
+  }
+  double time = nglTime() - start;
+  printf("%u requests of %u bytes in %.3f s over %d connection(s)\n", RequestCount, (uint32)http.mBinary.size(), time, (int)ngl_atomic_read(http.mConnections));
+  if (errors)
+    TestFail("%u of the %u binary responses are wrong", errors, RequestCount);
+  if (ngl_atomic_read(http.mConnections) != 1)
+    TestFail("%u sequential requests used %d connections instead of one", RequestCount, (int)ngl_atomic_read(http.mConnections));
+
+  // Request body and streamed response
+  nglPath path(ePathTemp);
+  path += nglPath(_T("nuitest_http.bin"));
+  {
+    nuiHTTPRequest request(root + _T("/echo"), _T("POST"));
+    request.SetBody((const char*)&http.mBinary[0], http.mBinary.size());
+    nglOFile file(path, eOFileCreate);
+    request.SetOutputStream(&file);
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    TEST_CHECK(pResponse->GetStatusCode() == 200);
+    TEST_CHECK(pResponse->GetBody().empty());
+    TEST_CHECK(file.GetPos() == (nglFileOffset)http.mBinary.size());
+    delete pResponse;
+  }
+  {
+    nglIFile file(path);
+    std::vector<uint8> data(http.mBinary.size() + 1);
+    TEST_CHECK(file.Read(&data[0], data.size(), 1) == (nglFileSize)http.mBinary.size() && !memcmp(&data[0], &http.mBinary[0], http.mBinary.size()));
+  }
+  path.Delete();
+
+  // Revalidation of cached responses
+  nglPath cachepath(ePathTemp);
+  cachepath += nglPath(_T("nuitest_http_cache"));
+  nuiHTTPCache cache(cachepath);
+  cache.Clear();
+  for (uint32 i = 0; i < 3; i++)
+  {
+    nuiHTTPRequest request(root + _T("/cached"));
+    request.SetCache(&cache);
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    if (!TEST_CHECK(pResponse->GetStatusCode() == 200 && pResponse->GetBodyStr() == _T("cached contents")))
+      fprintf(stderr, "cached request %u: %d '%ls'\n", i, pResponse->GetStatusCode(), pResponse->GetStatusLine().GetChars());
+    delete pResponse;
+  }
+  cache.Clear();
+  if (ngl_atomic_read(http.mNotModified) != 2)
+    TestFail("%d of the 2 cached responses were revalidated", (int)ngl_atomic_read(http.mNotModified));
+
+  // Unknown path
+  {
+    nuiHTTPRequest request(root + _T("/missing"));
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    TEST_CHECK(pResponse->GetStatusCode() == 404);
+    delete pResponse;
+  }
+
+  // Concurrent requests
+  {
+    EchoWorkers workers(root, RequestCount / 2);
+    std::vector<nglThread*> threads;
+    start = nglTime();
+    for (uint32 i = 0; i < TEST_THREADS; i++)
+    {
+      threads.push_back(new nglThreadDelegate(nuiMakeDelegate(&workers, &EchoWorkers::Run)));
+      threads.back()->Start();
+    }
+    for (uint32 i = 0; i < threads.size(); i++)
+    {
+      threads[i]->Join();
+      delete threads[i];
+    }
+    printf("%u concurrent requests from %d threads in %.3f s\n", TEST_THREADS * workers.mRequestCount, TEST_THREADS, (double)(nglTime() - start));
+    if (ngl_atomic_read(workers.mErrors))
+      TestFail("%d of the %u concurrent responses are wrong", (int)ngl_atomic_read(workers.mErrors), TEST_THREADS * workers.mRequestCount);
+  }
+
+  serverpool.Stop();
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  LoopbackTest(200, TEST_PORT);
+
+  // A refused connection gives a response without a status code instead of hanging:
+  {
+    nuiHTTPRequest request(nglString(_T("http://127.0.0.1:1/")));
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    TEST_CHECK(pResponse && pResponse->GetStatusCode() == 0);
+    delete pResponse;
+  }
+
+  nuiUninit();
+  return TestResult();
+}
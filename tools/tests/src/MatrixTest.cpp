@@ -0,0 +1,219 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Checks the float matrix products and inversion, which have SSE versions on x86, and the batched vertex and rectangle
+// transformations against the generic nglMatrix template with doubles, and fails on the first wrong element.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiRenderArray.h"
+#include "Test.h"
+
+#define MATRIX_TOLERANCE 1e-3
+
+static uint32 gSeed = 1;
+
+static uint32 Random(uint32 Max)
+{
+  gSeed = gSeed * 1103515245 + 12345;
+  return (gSeed >> 8) % Max;
+}
+
+static float RandomFloat(float Min, float Max)
+{
+  return Min + (Max - Min) * (float)Random(1 << 20) / (float)(1 << 20);
+}
+
+static nglMatrixd ToDouble(const nglMatrixf& rMatrix)
+{
+  nglMatrixd matrix;
+  for (uint32 i = 0; i < 16; i++)
+    matrix.Array[i] = rMatrix.Array[i];
+  return matrix;
+}
+
+static bool Near(const char* pName, uint32 Index, double Value, double Expected)
+{
+  if (fabs(Value - Expected) <= MATRIX_TOLERANCE * MAX(1.0, fabs(Expected)))
+    return TEST_CHECK(true);
+  TestFail("%s, element %u: %f instead of %f", pName, Index, Value, Expected);
+  return false;
+}
+
+/// Widget like 2D transformations, which have their own code paths, or arbitrary well conditioned matrixes
+static nglMatrixf RandomMatrix()
+{
+  nglMatrixf matrix;
+  if (Random(4))
+  {
+    matrix.SetRotation(RandomFloat(0, 360), 0, 0, 1);
+    matrix.Translate(RandomFloat(-1000, 1000), RandomFloat(-1000, 1000), 0);
+    matrix.Scale(RandomFloat(.5f, 2), RandomFloat(.5f, 2), 1);
+  }
+  else
+  {
+    for (uint32 i = 0; i < 16; i++)
+      matrix.Array[i] = RandomFloat(-1, 1);
+    for (uint32 i = 0; i < 16; i += 5)
+      matrix.Array[i] += 4;
+  }
+  return matrix;
+}
+
+static void CheckMatrix(const char* pName, const nglMatrixf& rMatrix, const nglMatrixd& rExpected)
+{
+  for (uint32 i = 0; i < 16; i++)
+  {
+    if (!Near(pName, i, rMatrix.Array[i], rExpected.Array[i]))
+      return;
+  }
+}
+
+static void CheckProducts(const nglMatrixf& rA, const nglMatrixf& rB)
+{
+  const nglMatrixd a(ToDouble(rA));
+  const nglMatrixd b(ToDouble(rB));
+
+  CheckMatrix("A * B", rA * rB, a * b);
+  nglMatrixf product(rA);
+  product *= rB;
+  CheckMatrix("A *= B", product, a * b);
+
+  nglVectorf vector(rB.Array[0], rB.Array[1], rB.Array[2], rB.Array[3]);
+  nglVectord vectord(rB.Array[0], rB.Array[1], rB.Array[2], rB.Array[3]);
+  vector = rA * vector;
+  vectord = a * vectord;
+  for (uint32 i = 0; i < 4; i++)
+    Near("A * v", i, vector[i], vectord[i]);
+
+  nglMatrixf inverse(rA);
+  inverse.Invert();
+  nglMatrixd inversed(a);
+  inversed.Invert();
+  CheckMatrix("inverse", inverse, inversed);
+  CheckMatrix("A * inverse", rA * inverse, nglMatrixd());
+}
+
+static void CheckVertices(const nglMatrixf& rMatrix, size_t Count, bool InPlace)
+{
+  // One more vertex that must not be touched:
+  std::vector<nuiRenderArray::Vertex> vertices(Count + 1);
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    nuiRenderArray::Vertex& rVertex(vertices[i]);
+    rVertex.mX = RandomFloat(-1000, 1000);
+    rVertex.mY = RandomFloat(-1000, 1000);
+    rVertex.mZ = RandomFloat(-1, 1);
+    rVertex.mR = (GLubyte)Random(256);
+    rVertex.mG = (GLubyte)Random(256);
+    rVertex.mB = (GLubyte)Random(256);
+    rVertex.mA = (GLubyte)Random(256);
+    rVertex.mTX = RandomFloat(0, 1);
+    rVertex.mTY = RandomFloat(0, 1);
+  }
+  std::vector<nuiRenderArray::Vertex> transformed(vertices);
+  if (InPlace)
+    nuiRenderArray::TransformVertices(rMatrix, &transformed[0], &transformed[0], Count);
+  else
+    nuiRenderArray::TransformVertices(rMatrix, &vertices[0], &transformed[0], Count);
+
+  const nglMatrixd matrix(ToDouble(rMatrix));
+  for (size_t i = 0; i < Count; i++)
+  {
+    const nuiRenderArray::Vertex& rIn(vertices[i]);
+    const nuiRenderArray::Vertex& rOut(transformed[i]);
+    nglVectord vector(rIn.mX, rIn.mY, rIn.mZ);
+    vector = matrix * vector;
+    if (!Near("vertex x", (uint32)i, rOut.mX, vector[0]) || !Near("vertex y", (uint32)i, rOut.mY, vector[1]) || !Near("vertex z", (uint32)i, rOut.mZ, vector[2]))
+      return;
+    if (!TEST_CHECK(rOut.mR == rIn.mR && rOut.mG == rIn.mG && rOut.mB == rIn.mB && rOut.mA == rIn.mA && rOut.mTX == rIn.mTX && rOut.mTY == rIn.mTY))
+      return;
+  }
+  TEST_CHECK(!memcmp(&transformed[Count], &vertices[Count], sizeof(nuiRenderArray::Vertex)));
+}
+
+static void CheckRects(const nglMatrixf& rMatrix, size_t Count, bool InPlace)
+{
+  std::vector<nuiRect> rects(Count + 1);
+  for (size_t i = 0; i < rects.size(); i++)
+    rects[i].Set(RandomFloat(-1000, 1000), RandomFloat(-1000, 1000), RandomFloat(0, 200), RandomFloat(0, 200));
+  std::vector<nuiRect> transformed(rects);
+  if (InPlace)
+    nuiRect::Transform(rMatrix, &transformed[0], &transformed[0], Count);
+  else
+    nuiRect::Transform(rMatrix, &rects[0], &transformed[0], Count);
+
+  const nglMatrixd matrix(ToDouble(rMatrix));
+  for (size_t i = 0; i < Count; i++)
+  {
+    nglVectord topleft(rects[i].mLeft, rects[i].mTop, 0);
+    nglVectord bottomright(rects[i].mRight, rects[i].mBottom, 0);
+    topleft = matrix * topleft;
+    bottomright = matrix * bottomright;
+    if (!Near("rect left", (uint32)i, transformed[i].mLeft, topleft[0]) || !Near("rect top", (uint32)i, transformed[i].mTop, topleft[1])
+     || !Near("rect right", (uint32)i, transformed[i].mRight, bottomright[0]) || !Near("rect bottom", (uint32)i, transformed[i].mBottom, bottomright[1]))
+      return;
+  }
+  TEST_CHECK(transformed[Count] == rects[Count]);
+
+  // The single rectangle version must agree with the batch:
+  if (Count)
+  {
+    nuiRect rect(rects[0]);
+    rect.Transform(rMatrix);
+    TEST_CHECK(rect == transformed[0]);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+#ifdef NGL_MATRIX_SSE
+  printf("SSE matrixes\n");
+#else
+  printf("Generic matrixes\n");
+#endif
+
+  for (uint32 i = 0; i < 10000; i++)
+    CheckProducts(RandomMatrix(), RandomMatrix());
+
+  // The identity inverts to itself exactly, and a singular matrix is left as it is:
+  {
+    nglMatrixf identity;
+    identity.Invert();
+    TEST_CHECK(identity == nglMatrixf());
+
+    nglMatrixf singular;
+    singular.Nullify();
+    singular.Array[0] = 1;
+    nglMatrixf inverse(singular);
+    inverse.Invert();
+    TEST_CHECK(inverse == singular);
+  }
+
+  // Every count up to 20 covers the ends of the batch loops:
+  for (size_t count = 0; count <= 20; count++)
+  {
+    for (uint32 inplace = 0; inplace < 2; inplace++)
+    {
+      nglMatrixf matrix(RandomMatrix());
+      CheckVertices(matrix, count, inplace != 0);
+      CheckRects(matrix, count, inplace != 0);
+    }
+  }
+  for (uint32 i = 0; i < 100; i++)
+  {
+    nglMatrixf matrix(RandomMatrix());
+    size_t count = 21 + Random(2000);
+    CheckVertices(matrix, count, (i & 1) != 0);
+    CheckRects(matrix, count, (i & 1) != 0);
+  }
+
+  nuiUninit();
+  return TestResult();
+}
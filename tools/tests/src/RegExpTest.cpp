@@ -0,0 +1,186 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Matches fixed and random patterns with the backtracking and the linear engines of nuiRegExp and fails if they don't
+// agree on the match, on the sub expressions or on the replace strings.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiRegExp.h"
+#include "Test.h"
+
+static uint32 gSeed = 1;
+
+static uint32 Random(uint32 Max)
+{
+  gSeed = gSeed * 1103515245 + 12345;
+  return (gSeed >> 8) % Max;
+}
+
+/// Describe the sub expressions of a match, to compare the engines and to report the differences
+static nglString Describe(nuiRegExp& rRegExp, bool Matched)
+{
+  if (!Matched)
+    return nglString(_T("no match"));
+
+  nglString result;
+  for (int i = 0; i <= rRegExp.SubStrings() && i < nuiRegExp::NSUBEXP; i++)
+  {
+    nglString sub;
+    sub.Format(_T("%d:%d,%d "), i, rRegExp.SubStart(i), rRegExp.SubLength(i));
+    result += sub;
+  }
+  result += rRegExp.GetReplaceString(_T("<&|\\1|\\2>"));
+  return result;
+}
+
+static void Compare(const nglString& rPattern, const nglString& rText, bool IgnoreCase)
+{
+  nuiRegExp backtracking(rPattern, IgnoreCase, nuiRegExp::eBacktrackingEngine);
+  nuiRegExp linear(rPattern, IgnoreCase, nuiRegExp::eLinearEngine);
+  if (backtracking.CompiledOK() != linear.CompiledOK())
+  {
+    TestFail("'%ls': compiled by one engine only", rPattern.GetChars());
+    return;
+  }
+  if (!backtracking.CompiledOK())
+    return;
+
+  // A tiny state cache forces the linear engine to flush it and to fall back to its Pike VM:
+  nuiRegExp flushing(rPattern, IgnoreCase, nuiRegExp::eLinearEngine);
+  flushing.SetCacheSize(4);
+  // The copies must match like the originals:
+  nuiRegExp copy(backtracking);
+  copy.SetEngine(nuiRegExp::eAutomaticEngine);
+
+  const bool matched = backtracking.Match(rText);
+  const nglString expected(Describe(backtracking, matched));
+
+  // Copies made after the match must give the same sub expressions without matching again:
+  {
+    nuiRegExp matchedCopy(backtracking);
+    nuiRegExp assigned(_T("x"));
+    assigned.Match(_T("xx"));
+    assigned = backtracking;
+    nglString result(Describe(matchedCopy, matched));
+    if (!TEST_CHECK(result == expected))
+      fprintf(stderr, "'%ls' on '%ls': the match gives '%ls', its copy gives '%ls'\n", rPattern.GetChars(), rText.GetChars(), expected.GetChars(), result.GetChars());
+    result = Describe(assigned, matched);
+    if (!TEST_CHECK(result == expected))
+      fprintf(stderr, "'%ls' on '%ls': the match gives '%ls', its assigned copy gives '%ls'\n", rPattern.GetChars(), rText.GetChars(), expected.GetChars(), result.GetChars());
+  }
+  nuiRegExp* pEngines[] = { &linear, &flushing, &copy };
+  const char* pNames[] = { "linear", "linear with 4 states", "copy" };
+  for (uint32 i = 0; i < 3; i++)
+  {
+    nglString result(Describe(*pEngines[i], pEngines[i]->Match(rText)));
+    if (!TEST_CHECK(result == expected))
+      fprintf(stderr, "'%ls' on '%ls'%s: backtracking gives '%ls', %s gives '%ls'\n", rPattern.GetChars(), rText.GetChars(), IgnoreCase ? " ignoring case" : "", expected.GetChars(), pNames[i], result.GetChars());
+  }
+}
+
+static nglString RandomPattern(uint32 Depth)
+{
+  static const char* pAtoms[] = { "a", "b", "c", ".", "[ab]", "[^a]", "ab", "\\<", "\\>", "^", "$", "[a-c]", "x", "A" };
+  nglString pattern;
+  const uint32 count = 1 + Random(4);
+  for (uint32 i = 0; i < count; i++)
+  {
+    nglString atom;
+    if (Random(10) < 2 && Depth < 3)
+    {
+      atom = _T("(");
+      atom += RandomPattern(Depth + 1);
+      if (Random(2))
+      {
+        atom += _T("|");
+        atom += RandomPattern(Depth + 1);
+      }
+      atom += _T(")");
+    }
+    else
+    {
+      atom = nglString(pAtoms[Random(sizeof(pAtoms) / sizeof(pAtoms[0]))]);
+    }
+
+    switch (Random(6))
+    {
+      case 0: atom += _T("*"); break;
+      case 1: atom += _T("+"); break;
+      case 2: atom += _T("?"); break;
+    }
+    pattern += atom;
+  }
+  return pattern;
+}
+
+/// Short texts: the backtracking engine is exponential on some of the random patterns
+static nglString RandomText()
+{
+  static const char* pChars = "abcxA _";
+  nglString text;
+  const uint32 length = Random(4) ? Random(12) : Random(24);
+  for (uint32 i = 0; i < length; i++)
+    text.Append((nglChar)pChars[Random(7)]);
+  return text;
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  const char* pFixed[][2] =
+  {
+    { "abc", "xxabcxx" }, { "a(b|c)d", "acd" }, { "(a*)b", "aaab" }, { "(a|ab)(c|bcd)(d*)", "abcd" },
+    { "^foo", "foobar" }, { "^foo", "xfoo" }, { "bar$", "foobar" }, { "\\<is\\>", "this is it" },
+    { "(a+)(b+)?", "aaa" }, { "((a)|b)+", "ab" }, { "(a(b)?)+", "aba" }, { "[0-9]+\\.[0-9]*", "v 12.5x" },
+    { "x(y|z)*w", "xyzzyw" }, { "(foo|foobar)baz", "foobarbaz" }, { "", "abc" }, { "a?", "" },
+    { "(.*)-(.*)", "ab-cd-ef" }, { "[^ ]+$", "one two three" }, { "\\(", "f(x)" }, { "a\\.b", "a.b" },
+    { "(.*)(.*)(.*)(.*)(.*)[QZ]", "a line of text without the letters" }, { "(.*)(.*)(.*)(.*)(.*)[QZ]", "one Z" }
+  };
+  for (uint32 i = 0; i < sizeof(pFixed) / sizeof(pFixed[0]); i++)
+  {
+    Compare(nglString(pFixed[i][0]), nglString(pFixed[i][1]), false);
+    Compare(nglString(pFixed[i][0]), nglString(pFixed[i][1]), true);
+  }
+
+  for (uint32 i = 0; i < 4000; i++)
+  {
+    nglString pattern(RandomPattern(0));
+    for (uint32 j = 0; j < 5; j++)
+      Compare(pattern, RandomText(), !(i % 7));
+  }
+
+  // Back references are only run by the backtracking engine:
+  {
+    nuiRegExp automatic(_T("(a+)b\\1"));
+    TEST_CHECK(automatic.UsesBackReferences());
+    TEST_CHECK(automatic.Match(_T("xaabaa")) && automatic[0] == _T("aabaa") && automatic[1] == _T("aa"));
+    TEST_CHECK(!automatic.Match(_T("aabba")));
+    nuiRegExp linear(_T("(a+)b\\1"), false, nuiRegExp::eLinearEngine);
+    TEST_CHECK(!linear.Match(_T("xaabaa")));
+    nuiRegExp invalid(_T("\\1(a)"));
+    TEST_CHECK(!invalid.CompiledOK());
+  }
+
+  // A long text must not take the linear engine more than linear time. The backtracking engine needs seconds for this on
+  // a single line of 60 characters.
+  {
+    nglString text;
+    while (text.GetLength() < 1024 * 1024)
+      text.Add("2026-10-18 12:34:56 INFO nuiWidget: layout pass took 3 ms for 1234 widgets\n");
+    nuiRegExp regexp(_T("(.*)(.*)(.*)(.*)(.*)[QZ]"));
+    nglTime start;
+    TEST_CHECK(!regexp.Match(text));
+    double duration = nglTime() - start;
+    printf("(.*)(.*)(.*)(.*)(.*)[QZ] on %d characters: %.3f s\n", text.GetLength(), duration);
+    TEST_CHECK(duration < 5.0);
+  }
+
+  nuiUninit();
+  return TestResult();
+}
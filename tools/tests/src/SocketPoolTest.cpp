@@ -0,0 +1,194 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Connects thousands of non blocking clients to an echo server running in the thread of a nuiSocketPool and fails if a
+// connection is not echoed back in time or if an echoed message differs from the one that was sent.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiTCPClient.h"
+#include "nuiTCPServer.h"
+#include "nuiSocketPool.h"
+#include "Test.h"
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#define TEST_PORT 31338
+#define TEST_TIMEOUT 60
+
+class EchoServer
+{
+public:
+  EchoServer(nuiSocketPool& rPool)
+  : mrPool(rPool), mClosed(0)
+  {
+  }
+
+  void OnConnection(nuiSocket& rSocket)
+  {
+    // Edge triggered: accept all the pending connections
+    nuiTCPServer& rServer((nuiTCPServer&)rSocket);
+    nuiTCPClient* pClient;
+    while ((pClient = rServer.Accept()))
+    {
+      pClient->SetCanReadDelegate(nuiMakeDelegate(this, &EchoServer::OnRead));
+      pClient->SetReadClosedDelegate(nuiMakeDelegate(this, &EchoServer::OnClosed));
+      mrPool.Add(pClient);
+    }
+  }
+
+  void OnRead(nuiSocket& rSocket)
+  {
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    rClient.BufferedSend(rClient.GetReceived(), rClient.GetReceivedSize());
+    rClient.DiscardReceived(rClient.GetReceivedSize());
+  }
+
+  void OnClosed(nuiSocket& rSocket)
+  {
+    ngl_atomic_inc(mClosed);
+    delete &rSocket;
+  }
+
+  nuiSocketPool& mrPool;
+  nglAtomic32 mClosed;
+};
+
+class EchoClients
+{
+public:
+  EchoClients(uint32 MessageSize)
+  : mMessageSize(MessageSize), mEchoed(0), mErrors(0)
+  {
+  }
+
+  void OnCanWrite(nuiSocket& rSocket)
+  {
+    // Called once connected, and each time the send buffer gets empty
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    if (!mSent.insert(&rClient).second)
+      return;
+
+    std::vector<uint8> message(mMessageSize);
+    for (uint32 i = 0; i < mMessageSize; i++)
+      message[i] = (uint8)(i + rClient.GetSocket());
+    rClient.BufferedSend(message);
+  }
+
+  void OnCanRead(nuiSocket& rSocket)
+  {
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    if (rClient.GetReceivedSize() < mMessageSize)
+      return;
+
+    const uint8* pData = rClient.GetReceived();
+    for (uint32 i = 0; i < mMessageSize; i++)
+    {
+      if (pData[i] != (uint8)(i + rClient.GetSocket()))
+      {
+        mErrors++;
+        break;
+      }
+    }
+    mEchoed++;
+    rClient.Close();
+  }
+
+  uint32 mMessageSize;
+  uint32 mEchoed;
+  uint32 mErrors;
+  std::set<nuiTCPClient*> mSent;
+};
+
+static void LoopbackTest(uint32 ConnectionCount, uint32 MessageSize, int16 Port)
+{
+  nuiSocketPool serverpool;
+  EchoServer echo(serverpool);
+  nuiTCPServer server;
+  server.SetNonBlocking(true);
+  if (!server.Bind(_T("127.0.0.1"), Port) || !server.Listen(SOMAXCONN))
+  {
+    TestFail("unable to open the server on port %d", Port);
+    return;
+  }
+  server.SetCanReadDelegate(nuiMakeDelegate(&echo, &EchoServer::OnConnection));
+  if (!serverpool.Add(&server))
+  {
+    TestFail("unable to add the server to the socket pool");
+    return;
+  }
+  serverpool.Start();
+
+  nuiSocketPool clientpool;
+  EchoClients clients(MessageSize);
+  std::vector<nuiTCPClient*> sockets;
+  double start = nglTime();
+  for (uint32 i = 0; i < ConnectionCount; i++)
+  {
+    nuiTCPClient* pClient = new nuiTCPClient();
+    pClient->SetNonBlocking(true);
+    if (!pClient->Connect(_T("127.0.0.1"), Port))
+    {
+      delete pClient;
+      break;
+    }
+    pClient->SetCanWriteDelegate(nuiMakeDelegate(&clients, &EchoClients::OnCanWrite));
+    pClient->SetCanReadDelegate(nuiMakeDelegate(&clients, &EchoClients::OnCanRead));
+    TEST_CHECK(clientpool.Add(pClient));
+    sockets.push_back(pClient);
+
+    // Don't let the backlog overflow
+    clientpool.DispatchEvents(0);
+  }
+
+  while (clients.mEchoed < sockets.size() && nglTime() - start < TEST_TIMEOUT)
+    clientpool.DispatchEvents(100);
+  double time = nglTime() - start;
+
+  while (ngl_atomic_read(echo.mClosed) < clients.mEchoed && nglTime() - start < TEST_TIMEOUT)
+    nglThread::MsSleep(10);
+  serverpool.Stop();
+
+  printf("%u/%u connections echoed %u bytes in %.3f s (%u errors), %d closed by the server\n",
+         clients.mEchoed, ConnectionCount, MessageSize, time, clients.mErrors, (int)ngl_atomic_read(echo.mClosed));
+
+  if (sockets.size() != ConnectionCount)
+    TestFail("%u bytes: only %u of the %u connections could be opened", MessageSize, (uint32)sockets.size(), ConnectionCount);
+  if (clients.mEchoed != sockets.size())
+    TestFail("%u bytes: %u of the %u connections were not echoed in %d s", MessageSize, (uint32)sockets.size() - clients.mEchoed, (uint32)sockets.size(), TEST_TIMEOUT);
+  if (clients.mErrors)
+    TestFail("%u bytes: %u echoed messages differ from the ones that were sent", MessageSize, clients.mErrors);
+  if ((uint32)ngl_atomic_read(echo.mClosed) != clients.mEchoed)
+    TestFail("%u bytes: the server saw %d of the %u connections closing", MessageSize, (int)ngl_atomic_read(echo.mClosed), clients.mEchoed);
+
+  for (uint32 i = 0; i < sockets.size(); i++)
+    delete sockets[i];
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  // Each connection uses two descriptors in this process
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+  {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+  uint32 connections = 2000;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+    connections = MIN(connections, (uint32)(limit.rlim_cur / 2) - 32);
+
+  // Many small messages, then fewer messages that don't fit in the socket buffers:
+  LoopbackTest(connections, 1000, TEST_PORT);
+  LoopbackTest(connections / 20, 1024 * 1024, TEST_PORT + 1);
+
+  nuiUninit();
+  return TestResult();
+}
@@ -0,0 +1,47 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#include "nui.h"
+#include "Test.h"
+#include <stdarg.h>
+
+static uint32 gChecks = 0;
+static uint32 gFailures = 0;
+
+bool TestCheck(bool Condition, const char* pExpression, const char* pFile, int Line)
+{
+  gChecks++;
+  if (!Condition)
+  {
+    gFailures++;
+    fprintf(stderr, "%s:%d: check failed: %s\n", pFile, Line, pExpression);
+  }
+  return Condition;
+}
+
+void TestFail(const char* pFormat, ...)
+{
+  gChecks++;
+  gFailures++;
+  va_list args;
+  va_start(args, pFormat);
+  fprintf(stderr, "failed: ");
+  vfprintf(stderr, pFormat, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+}
+
+int TestResult()
+{
+  if (gFailures)
+  {
+    fprintf(stderr, "%u of %u checks failed\n", gFailures, gChecks);
+    return 1;
+  }
+  fprintf(stderr, "%u checks passed\n", gChecks);
+  return 0;
+}
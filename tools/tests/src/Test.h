@@ -0,0 +1,21 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+#pragma once
+
+#include "nui.h"
+
+/// Checks shared by the test programs
+/*!
+Each test is an executable registered with add_test(): it runs its checks, prints the ones that failed and returns the
+value of TestResult() from main, which is non zero when at least one check failed.
+*/
+bool TestCheck(bool Condition, const char* pExpression, const char* pFile, int Line); ///< Count the check, print it if it failed, and return Condition.
+void TestFail(const char* pFormat, ...); ///< Report a failure with a formatted message.
+int TestResult(); ///< Print a summary, returns 0 if all the checks passed and 1 otherwise.
+
+#define TEST_CHECK(CONDITION) TestCheck((CONDITION), #CONDITION, __FILE__, __LINE__)
@@ -0,0 +1,187 @@
+/*
+ NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+ Copyright (C) 2002-2003 Sebastien Metrot
+
+ licence: see nui3/LICENCE.TXT
+ */
+
+// Compiles sample CSS widget creators and XML widget descriptions with nuiWidgetCompiler and fails if
+// nuiWidgetCompiler::Verify() finds a difference between the compiled widgets and the ones of the string based path.
+// Also checks the by value Matrix attribute of nuiWidget.
+
+#include "nui.h"
+#include "nuiInit.h"
+#include "nuiCSS.h"
+#include "nuiCompiledWidget.h"
+#include "Test.h"
+
+static const char* gpCSS =
+"+nuiSimpleContainer TestPanel\n"
+"{\n"
+"  UserWidth: 320;\n"
+"  UserHeight: 240;\n"
+"  Borders: 4;\n"
+"  Visible: true;\n"
+"  Alpha: 0.75;\n"
+"  Tooltip = \"A panel\";\n"
+"  +nuiVBox column\n"
+"  {\n"
+"    Position: Left;\n"
+"    Spacing: 3;\n"
+"    Expand: Grow;\n"
+"    +nuiHBox row1 { Position: Top; Enabled: false; }\n"
+"    +nuiHBox row2 { Position: Fill; BorderLeft: 10; BorderTop: 2.5; }\n"
+"  }\n"
+"  +nuiGrid grid\n"
+"  {\n"
+"    HorizontalSpacing: 2;\n"
+"    VerticalSpacing: 1;\n"
+"    DecorationMode: ClientOnly;\n"
+"  }\n"
+"}\n"
+"\n"
+"+nuiHBox TestToolbar(spacing: \"5\"; name: \"toolbarButton\")\n"
+"{\n"
+"  Spacing: spacing;\n"
+"  +nuiSimpleContainer name { MinWidth: 32; MaxWidth: 64; }\n"
+"  +TestPanel panel;\n"
+"}\n";
+
+static const char* gpXML[][2] =
+{
+  {
+    "TestXMLBox",
+    "<nuiVBox Name=\"box\" Spacing=\"4\" Position=\"Center\" UserWidth=\"100\" Enabled=\"false\">\n"
+    "  <nuiHBox Name=\"child1\" BorderLeft=\"1\" BorderRight=\"2\"/>\n"
+    "  <nuiSimpleContainer Name=\"child2\" Alpha=\"0.5\" Visible=\"false\">\n"
+    "    <nuiSimpleContainer Name=\"grandchild\" UserRect=\"{1 2 30 40}\"/>\n"
+    "  </nuiSimpleContainer>\n"
+    "</nuiVBox>\n"
+  },
+  {
+    "TestXMLProperties",
+    "<nuiSimpleContainer Name=\"properties\" MinHeight=\"12\">\n"
+    "  <nuiPropertyBag Tooltip=\"Some help\" Custom=\"value\"/>\n"
+    "  <Description>A container with properties</Description>\n"
+    "  <nuiGrid Name=\"grid\" HorizontalSpacing=\"3\"/>\n"
+    "</nuiSimpleContainer>\n"
+  }
+};
+
+/// A class that reads its own XML and that the compiler can't reproduce, to check that Verify() reports the differences.
+class TestOwnLoad : public nuiSimpleContainer
+{
+public:
+  TestOwnLoad()
+  {
+    SetObjectClass(_T("TestOwnLoad"));
+  }
+
+  virtual bool Load(const nuiXMLNode* pNode)
+  {
+    bool res = nuiSimpleContainer::Load(pNode);
+    SetProperty(_T("Loaded"), _T("yes"));
+    return res;
+  }
+};
+
+static bool LoadXML(nuiXML& rXML, const char* pSource)
+{
+  nglIMemory memory(pSource, strlen(pSource));
+  return rXML.Load(memory);
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+
+  nuiCSS css;
+  {
+    nglIMemory memory(gpCSS, strlen(gpCSS));
+    if (!TEST_CHECK(css.Load(memory)))
+      fprintf(stderr, "%ls\n", css.GetErrorString().GetChars());
+  }
+
+  // Creators and XML compiled together, saved and loaded back:
+  {
+    nuiWidgetCompiler compiler;
+    TEST_CHECK(compiler.AddCreators());
+
+    std::vector<nuiXML*> nodes;
+    for (uint32 i = 0; i < sizeof(gpXML) / sizeof(gpXML[0]); i++)
+    {
+      nuiXML* pXML = new nuiXML();
+      nodes.push_back(pXML);
+      if (!TEST_CHECK(LoadXML(*pXML, gpXML[i][1])))
+        continue;
+      if (!TEST_CHECK(compiler.AddXML(nglString(gpXML[i][0]), pXML)))
+        fprintf(stderr, "%s: %ls\n", gpXML[i][0], compiler.GetError().GetChars());
+    }
+
+    const nuiCompiledWidget& rCompiled(compiler.GetCompiledWidget());
+    TEST_CHECK(rCompiled.FindDescription(_T("TestPanel")) >= 0);
+    TEST_CHECK(rCompiled.FindDescription(_T("TestToolbar")) >= 0);
+    TEST_CHECK(rCompiled.FindDescription(_T("TestXMLBox")) >= 0);
+    TEST_CHECK(rCompiled.FindDescription(_T("TestXMLProperties")) >= 0);
+    printf("%u descriptions compiled, %u bytes\n", rCompiled.GetDescriptionCount(), (uint32)rCompiled.GetMemoryUsage());
+
+    nglString report;
+    if (!TEST_CHECK(compiler.Verify(report)))
+      fprintf(stderr, "%ls", report.GetChars());
+
+    // Create the descriptions twice from a loaded copy, the second time from the resolved bindings:
+    nglOMemory output;
+    TEST_CHECK(compiler.Save(output));
+    nglIMemory input(output.GetBufferData(), output.GetSize());
+    nuiCompiledWidget loaded;
+    if (TEST_CHECK(loaded.Load(input)) && TEST_CHECK(loaded.GetDescriptionCount() == rCompiled.GetDescriptionCount()))
+    {
+      for (uint32 pass = 0; pass < 2; pass++)
+      {
+        for (uint32 i = 0; i < loaded.GetDescriptionCount(); i++)
+        {
+          nuiWidget* pWidget = loaded.Create(i);
+          if (!TEST_CHECK(pWidget))
+            continue;
+          pWidget->Acquire();
+          pWidget->Release();
+        }
+      }
+    }
+
+    for (uint32 i = 0; i < nodes.size(); i++)
+      delete nodes[i];
+  }
+
+  // Verify() must fail when the compiled widgets differ:
+  {
+    NUI_ADD_WIDGET_CREATOR(TestOwnLoad, "Container");
+    nuiXML xml;
+    nuiWidgetCompiler compiler;
+    if (TEST_CHECK(LoadXML(xml, "<TestOwnLoad Name=\"own\" UserWidth=\"10\"/>")) && TEST_CHECK(compiler.AddXML(_T("TestOwnLoad"), &xml)))
+    {
+      nglString report;
+      TEST_CHECK(!compiler.Verify(report));
+      TEST_CHECK(report.Contains(_T("property Loaded")) > 0);
+    }
+  }
+
+  // The Matrix attribute is read and written by value:
+  {
+    nuiSimpleContainer* pWidget = new nuiSimpleContainer();
+    pWidget->Acquire();
+    nuiAttrib<nuiMatrix> attrib(pWidget->GetAttribute(_T("Matrix")));
+    if (TEST_CHECK(attrib.IsValid()))
+    {
+      nuiMatrix matrix;
+      matrix.SetTranslation(5, 7, 0);
+      attrib.Set(matrix);
+      TEST_CHECK(!memcmp(pWidget->GetMatrix().Array, matrix.Array, sizeof(matrix.Array)));
+      TEST_CHECK(!memcmp(attrib.Get().Array, matrix.Array, sizeof(matrix.Array)));
+    }
+    pWidget->Release();
+  }
+
+  nuiUninit();
+  return TestResult();
+}
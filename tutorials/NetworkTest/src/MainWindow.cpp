@@ -15,6 +15,13 @@
 #include "nuiSocket.h"
 #include "nuiTCPClient.h"
 #include "nuiTCPServer.h"
+#include "nuiSocketPool.h"
+#include "nuiHTTP.h"
+
+#ifndef WIN32
+#include <sys/resource.h>
+#include <sys/socket.h>
+#endif
 
 // Network classes:
 
@@ -51,26 +58,331 @@ public:
   bool Close();
 };
 
-class nuiTCPSocketPool
+// Loopback test of nuiSocketPool: an echo server running in the pool's thread and thousands of concurrent clients
+// pumped from the calling thread.
+
+class EchoServer
 {
 public:
-  nuiTCPSocketPool();
+  EchoServer(nuiSocketPool& rPool)
+  : mrPool(rPool), mClosed(0)
+  {
+  }
 
-  void AddServer(nuiTCPServer* pServer);
-  void DelServer(nuiTCPServer* pServer);
-  
-  void WaitForEvent(double waittime = -1);
-  
-//  virtual bool OnConnectionRequest(nuiTCPServer* pServer, nuiTCPClient* pClient);
-//  virtual bool OnDataAvailable(nuiTCPClient* pClient);
-//  virtual bool OnDataAvailable(nuiUDPClient* pClient);
-//  virtual bool OnDataNeeded(nuiTCPClient* pClient);
-//  virtual bool OnError(nuiTCPServer* pClient);
-//  virtual bool OnError(nuiTCPClient* pClient);
-//  virtual bool OnError(nuiUDPServer* pClient);
-//  virtual bool OnError(nuiUDPClient* pClient);
+  void OnConnection(nuiSocket& rSocket)
+  {
+    // Edge triggered: accept all the pending connections
+    nuiTCPServer& rServer((nuiTCPServer&)rSocket);
+    nuiTCPClient* pClient;
+    while ((pClient = rServer.Accept()))
+    {
+      pClient->SetCanReadDelegate(nuiMakeDelegate(this, &EchoServer::OnRead));
+      pClient->SetReadClosedDelegate(nuiMakeDelegate(this, &EchoServer::OnClosed));
+      mrPool.Add(pClient);
+    }
+  }
+
+  void OnRead(nuiSocket& rSocket)
+  {
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    rClient.BufferedSend(rClient.GetReceived(), rClient.GetReceivedSize());
+    rClient.DiscardReceived(rClient.GetReceivedSize());
+  }
+
+  void OnClosed(nuiSocket& rSocket)
+  {
+    ngl_atomic_inc(mClosed);
+    delete &rSocket;
+  }
+
+  nuiSocketPool& mrPool;
+  nglAtomic32 mClosed;
+};
+
+class EchoClients
+{
+public:
+  EchoClients(uint32 MessageSize)
+  : mMessageSize(MessageSize), mEchoed(0), mErrors(0)
+  {
+  }
+
+  void OnCanWrite(nuiSocket& rSocket)
+  {
+    // Called once connected, and each time the send buffer gets empty
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    if (!mSent.insert(&rClient).second)
+      return;
+
+    std::vector<uint8> message(mMessageSize);
+    for (uint32 i = 0; i < mMessageSize; i++)
+      message[i] = (uint8)(i + rClient.GetSocket());
+    rClient.BufferedSend(message);
+  }
+
+  void OnCanRead(nuiSocket& rSocket)
+  {
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    if (rClient.GetReceivedSize() < mMessageSize)
+      return;
+
+    const uint8* pData = rClient.GetReceived();
+    for (uint32 i = 0; i < mMessageSize; i++)
+    {
+      if (pData[i] != (uint8)(i + rClient.GetSocket()))
+      {
+        mErrors++;
+        break;
+      }
+    }
+    mEchoed++;
+    rClient.Close();
+  }
+
+  uint32 mMessageSize;
+  uint32 mEchoed;
+  uint32 mErrors;
+  std::set<nuiTCPClient*> mSent;
+};
+
+static void LoopbackTest(uint32 ConnectionCount, uint32 MessageSize, int16 Port)
+{
+#ifndef WIN32
+  // Each connection uses two descriptors in this process
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+  {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+#endif
+
+  nuiSocketPool serverpool;
+  EchoServer echo(serverpool);
+  nuiTCPServer server;
+  server.SetNonBlocking(true);
+  if (!server.Bind(_T("127.0.0.1"), Port) || !server.Listen(SOMAXCONN))
+  {
+    NGL_OUT(_T("Loopback test: unable to open the server\n"));
+    return;
+  }
+  server.SetCanReadDelegate(nuiMakeDelegate(&echo, &EchoServer::OnConnection));
+  if (!serverpool.Add(&server))
+  {
+    NGL_OUT(_T("Loopback test: socket pools are not available on this platform\n"));
+    return;
+  }
+  serverpool.Start();
+
+  nuiSocketPool clientpool;
+  EchoClients clients(MessageSize);
+  std::vector<nuiTCPClient*> sockets;
+  double start = nglTime();
+  for (uint32 i = 0; i < ConnectionCount; i++)
+  {
+    nuiTCPClient* pClient = new nuiTCPClient();
+    pClient->SetNonBlocking(true);
+    if (!pClient->Connect(_T("127.0.0.1"), Port))
+    {
+      delete pClient;
+      break;
+    }
+    pClient->SetCanWriteDelegate(nuiMakeDelegate(&clients, &EchoClients::OnCanWrite));
+    pClient->SetCanReadDelegate(nuiMakeDelegate(&clients, &EchoClients::OnCanRead));
+    clientpool.Add(pClient);
+    sockets.push_back(pClient);
+
+    // Don't let the backlog overflow
+    clientpool.DispatchEvents(0);
+  }
+
+  while (clients.mEchoed < sockets.size() && nglTime() - start < 60)
+    clientpool.DispatchEvents(100);
+  double time = nglTime() - start;
+
+  while (ngl_atomic_read(echo.mClosed) < clients.mEchoed && nglTime() - start < 60)
+    nglThread::MsSleep(10);
+  serverpool.Stop();
+
+  NGL_OUT(_T("Loopback test: %d/%d connections echoed %d bytes in %.3f s (%d errors), %d closed by the server\n"),
+          clients.mEchoed, ConnectionCount, MessageSize, time, clients.mErrors, ngl_atomic_read(echo.mClosed));
+
+  for (uint32 i = 0; i < sockets.size(); i++)
+    delete sockets[i];
+}
+
+// Loopback test of the HTTP client: a minimal keep-alive HTTP server running in a nuiSocketPool thread.
+
+class HTTPServer
+{
+public:
+  HTTPServer(nuiSocketPool& rPool)
+  : mrPool(rPool), mConnections(0), mRequests(0), mNotModified(0)
+  {
+    mBinary.resize(256 * 1024);
+    for (uint32 i = 0; i < mBinary.size(); i++)
+      mBinary[i] = (uint8)(i * 7 + (i >> 8));
+  }
+
+  void OnConnection(nuiSocket& rSocket)
+  {
+    nuiTCPServer& rServer((nuiTCPServer&)rSocket);
+    nuiTCPClient* pClient;
+    while ((pClient = rServer.Accept()))
+    {
+      ngl_atomic_inc(mConnections);
+      pClient->SetCanReadDelegate(nuiMakeDelegate(this, &HTTPServer::OnRead));
+      pClient->SetReadClosedDelegate(nuiMakeDelegate(this, &HTTPServer::OnClosed));
+      mrPool.Add(pClient);
+    }
+  }
+
+  void OnRead(nuiSocket& rSocket)
+  {
+    nuiTCPClient& rClient((nuiTCPClient&)rSocket);
+    for (;;)
+    {
+      // Wait for a complete request
+      std::string request((const char*)rClient.GetReceived(), rClient.GetReceivedSize());
+      size_t end = request.find("\r\n\r\n");
+      if (end == std::string::npos)
+        return;
+      std::string headers(request.substr(0, end + 2));
+      size_t length = 0;
+      size_t pos = headers.find("Content-Length: ");
+      if (pos != std::string::npos)
+        length = atoi(headers.c_str() + pos + 16);
+      if (request.size() < end + 4 + length)
+        return;
+      std::string body(request.substr(end + 4, length));
+      rClient.DiscardReceived(end + 4 + length);
+      ngl_atomic_inc(mRequests);
+
+      std::string path(headers.substr(headers.find(' ') + 1));
+      path = path.substr(0, path.find(' '));
+
+      if (path == "/binary")
+      {
+        Reply(rClient, "200 OK", "", (const char*)&mBinary[0], mBinary.size());
+      }
+      else if (path == "/echo")
+      {
+        Reply(rClient, "200 OK", "", body.c_str(), body.size());
+      }
+      else if (path == "/cached")
+      {
+        if (headers.find("If-None-Match: \"v1\"\r\n") != std::string::npos)
+        {
+          ngl_atomic_inc(mNotModified);
+          Reply(rClient, "304 Not Modified", "ETag: \"v1\"\r\n", "", 0);
+        }
+        else
+        {
+          const char* pBody = "cached contents";
+          Reply(rClient, "200 OK", "ETag: \"v1\"\r\n", pBody, strlen(pBody));
+        }
+      }
+      else
+      {
+        Reply(rClient, "404 Not Found", "", "", 0);
+      }
+    }
+  }
+
+  void Reply(nuiTCPClient& rClient, const char* pStatus, const char* pHeaders, const char* pBody, size_t Length)
+  {
+    nglString header;
+    header.CFormat("HTTP/1.1 %s\r\n%sContent-Length: %d\r\n\r\n", pStatus, pHeaders, (int)Length);
+    std::string str(header.GetStdString());
+    str.append(pBody, Length);
+    rClient.BufferedSend((const uint8*)str.c_str(), str.size());
+  }
+
+  void OnClosed(nuiSocket& rSocket)
+  {
+    delete &rSocket;
+  }
+
+  nuiSocketPool& mrPool;
+  std::vector<uint8> mBinary;
+  nglAtomic32 mConnections;
+  nglAtomic32 mRequests;
+  nglAtomic32 mNotModified;
 };
 
+static void HTTPLoopbackTest(uint32 RequestCount, int16 Port)
+{
+  nuiSocketPool serverpool;
+  HTTPServer http(serverpool);
+  nuiTCPServer server;
+  server.SetNonBlocking(true);
+  if (!server.Bind(_T("127.0.0.1"), Port) || !server.Listen(SOMAXCONN))
+  {
+    NGL_OUT(_T("HTTP loopback test: unable to open the server\n"));
+    return;
+  }
+  server.SetCanReadDelegate(nuiMakeDelegate(&http, &HTTPServer::OnConnection));
+  if (!serverpool.Add(&server))
+  {
+    NGL_OUT(_T("HTTP loopback test: socket pools are not available on this platform\n"));
+    return;
+  }
+  serverpool.Start();
+
+  nglString root;
+  root.CFormat(_T("http://127.0.0.1:%d"), Port);
+  uint32 errors = 0;
+
+  // Binary bodies over a single keep-alive connection
+  double start = nglTime();
+  for (uint32 i = 0; i < RequestCount; i++)
+  {
+    nuiHTTPRequest request(root + _T("/binary"));
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    const std::vector<char>& rBody(pResponse->GetBody());
+    if (pResponse->GetStatusCode() != 200 || rBody.size() != http.mBinary.size() || memcmp(&rBody[0], &http.mBinary[0], rBody.size()))
+      errors++;
+    delete pResponse;
+  }
+  double time = nglTime() - start;
+
+  // Request body and streamed response
+  nglPath path(ePathTemp);
+  path += nglPath(_T("nuiHTTPLoopbackTest.bin"));
+  {
+    nuiHTTPRequest request(root + _T("/echo"), _T("POST"));
+    request.SetBody((const char*)&http.mBinary[0], http.mBinary.size());
+    nglOFile file(path, eOFileCreate);
+    request.SetOutputStream(&file);
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    if (pResponse->GetStatusCode() != 200 || !pResponse->GetBody().empty() || file.GetPos() != (nglFileOffset)http.mBinary.size())
+      errors++;
+    delete pResponse;
+  }
+  path.Delete();
+
+  // Revalidation of cached responses
+  nglPath cachepath(ePathTemp);
+  cachepath += nglPath(_T("nuiHTTPLoopbackCache"));
+  nuiHTTPCache cache(cachepath);
+  cache.Clear();
+  for (uint32 i = 0; i < 3; i++)
+  {
+    nuiHTTPRequest request(root + _T("/cached"));
+    request.SetCache(&cache);
+    nuiHTTPResponse* pResponse = request.SendRequest();
+    if (pResponse->GetStatusCode() != 200 || pResponse->GetBodyStr() != _T("cached contents"))
+      errors++;
+    delete pResponse;
+  }
+  cache.Clear();
+
+  NGL_OUT(_T("HTTP loopback test: %d requests of %d bytes in %.3f s over %d connection(s), %d revalidated from the cache (%d errors)\n"),
+          RequestCount, (int)http.mBinary.size(), time, ngl_atomic_read(http.mConnections), ngl_atomic_read(http.mNotModified), errors);
+
+  serverpool.Stop();
+}
+
 // MainWindow:
 
 MainWindow::MainWindow(const nglContextInfo& rContextInfo, const nglWindowInfo& rInfo, bool ShowFPS, const nglContext* pShared )
@@ -133,6 +445,10 @@ void MainWindow::OnCreation()
     NGL_OUT(_T("Got %d bytes\n\n"), buffer.size());
   }
   
+  ////////// Socket pool Test:
+  LoopbackTest(5000, 1000, 31338);
+  HTTPLoopbackTest(200, 31339);
+
   ////////// Server Test:
   nuiTCPServer server;
   if (server.Bind(0, 31337))
@@ -45,6 +45,7 @@ void Application::OnInit()
   bool DebugObject = false;
   bool DebugInfo = false;
   bool ShowFPS = false;
+  bool Benchmark = false;
   
   
   nuiRenderer Renderer = eOpenGL;
@@ -86,6 +87,7 @@ void Application::OnInit()
     else if (!arg.Compare(_T("--fullscreen")) || !arg.Compare(_T("-f"))) IsFullScreen = true;
     else if (!arg.Compare(_T("--debugobject")) || !arg.Compare(_T("-d"))) DebugObject = true;
     else if (!arg.Compare(_T("--debuginfo")) || !arg.Compare(_T("-i"))) DebugInfo = true;
+    else if (!arg.Compare(_T("--benchmark")) || !arg.Compare(_T("-b"))) Benchmark = true;
     else if (!arg.Compare(_T("--renderer")) || !arg.Compare(_T("-r"))) 
     {
       arg = GetArg(i+1);
@@ -146,6 +148,9 @@ void Application::OnInit()
   mpMainWindow->DBG_SetMouseOverInfo(DebugInfo);
   mpMainWindow->DBG_SetMouseOverObject(DebugObject);
   mpMainWindow->SetState(nglWindow::eShow);
+
+  if (Benchmark)
+    mpMainWindow->StartBenchmark();
   
 }
 
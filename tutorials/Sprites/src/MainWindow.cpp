@@ -25,6 +25,7 @@ MainWindow::MainWindow(const nglContextInfo& rContextInfo, const nglWindowInfo&
 #endif
   
   mpSpriteView = NULL;
+  mBenchmark = false;
   
 #ifdef NUI_IPHONE
   LoadCSS(_T("rsrc:/css/style-iPhone.css"));
@@ -51,7 +52,15 @@ void MainWindow::OnCreation()
   // iPod 2G   : 50
   // iPhone 3GS:
   // iPhone 4  : 120
-  for (int32 i = 0; i < 120; i++)
+  SetSpriteCount(120);
+}
+
+void MainWindow::SetSpriteCount(uint32 count)
+{
+  while (mpSpriteView->GetSpriteCount() > count)
+    mpSpriteView->DelSprite(mpSpriteView->GetSprites().back());
+
+  while (mpSpriteView->GetSpriteCount() < count)
   {
     nuiSprite* pSprite = new nuiSprite(_T("Gizmo"));
     int32 x, y;
@@ -64,7 +73,93 @@ void MainWindow::OnCreation()
     pSprite->SetSpeed(speed);
     mpSpriteView->AddSprite(pSprite);
   }
+}
+
+void MainWindow::StartBenchmark()
+{
+  srand(0);
+  mBenchmark = true;
+  mBatchedResult = 0;
+  mLowCount = 0;
+  mHighCount = 0;
+  mpSpriteView->EnableBatching(true);
+  StartBenchmarkStep(256);
+}
+
+void MainWindow::StartBenchmarkStep(uint32 count)
+{
+  SetSpriteCount(count);
+  mWarmingUp = true;
+  mStepStart = nglTime();
+  mStepFrames = 0;
+}
+
+bool MainWindow::Draw(nuiDrawContext* pContext)
+{
+  bool res = nuiMainWindow::Draw(pContext);
+  if (mBenchmark)
+    BenchmarkFrame();
+  return res;
+}
+
+void MainWindow::BenchmarkFrame()
+{
+  double now = nglTime();
+  double elapsed = now - mStepStart;
+  mStepFrames++;
+
+  // Skip the frames that follow the sprite creation:
+  if (mWarmingUp)
+  {
+    if (elapsed >= 0.5)
+    {
+      mWarmingUp = false;
+      mStepStart = now;
+      mStepFrames = 0;
+    }
+    return;
+  }
+
+  if (elapsed < 2.0)
+    return;
+
+  const char* pPath = mpSpriteView->IsBatchingEnabled() ? "batched" : "per sprite";
+  const char* pRenderer = (GetRenderer() == eSoftware) ? "software" : "OpenGL";
+  uint32 count = mpSpriteView->GetSpriteCount();
+  double fps = mStepFrames / elapsed;
+  NGL_OUT(_T("%s %s: %d sprites, %.1f FPS (%d render arrays)\n"), pRenderer, pPath, count, fps, mpSpriteView->GetBatch().GetBatchCount());
+
+  // Allow for the timer jitter around 60 FPS:
+  if (fps >= 59)
+    mLowCount = count;
+  else
+    mHighCount = count;
+
+  if (!mHighCount)
+  {
+    StartBenchmarkStep(count * 2);
+    return;
+  }
+
+  if (mHighCount - mLowCount > MAX(mLowCount / 32, 16))
+  {
+    StartBenchmarkStep((mLowCount + mHighCount) / 2);
+    return;
+  }
+
+  NGL_OUT(_T("%s %s path: below 60 FPS from %d sprites\n"), pRenderer, pPath, mHighCount);
+  if (mpSpriteView->IsBatchingEnabled())
+  {
+    mBatchedResult = mHighCount;
+    mLowCount = 0;
+    mHighCount = 0;
+    mpSpriteView->EnableBatching(false);
+    StartBenchmarkStep(64);
+    return;
+  }
 
+  NGL_OUT(_T("%s renderer: %d sprites batched, %d sprites drawn one by one\n"), pRenderer, mBatchedResult, mHighCount);
+  mBenchmark = false;
 }
 
 
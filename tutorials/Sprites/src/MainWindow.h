@@ -23,16 +23,31 @@ public:
   void OnClose();
   
   bool MouseMoved(const nglMouseInfo& rInfo);
+  bool Draw(nuiDrawContext* pContext);
+
+  void StartBenchmark(); ///< Search the sprite count at which the batched and then the per sprite paths drop below 60 FPS.
 protected:
   
 private:
   
   bool LoadCSS(const nglPath& rPath);
+  void SetSpriteCount(uint32 count);
+  void StartBenchmarkStep(uint32 count);
+  void BenchmarkFrame();
   
   nuiEventSink<MainWindow> mEventSink;
   
   nuiSpriteDef* mpSpriteDef;
   nuiSpriteView* mpSpriteView;
   std::vector<nuiSprite*> mSprites;
+
+  // Benchmark:
+  bool mBenchmark;
+  bool mWarmingUp;
+  double mStepStart;
+  uint32 mStepFrames;
+  uint32 mLowCount; ///< Highest sprite count that ran at 60 FPS
+  uint32 mHighCount; ///< Lowest sprite count that didn't, 0 if none yet
+  uint32 mBatchedResult;
 };
 